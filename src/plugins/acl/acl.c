@@ -39,6 +39,7 @@
 
 #include "fa_node.h"
 #include "public_inlines.h"
+#include "dtree_lookup.h"
 
 acl_main_t acl_main;
 
@@ -2580,6 +2581,11 @@ acl_set_aclplugin_fn (vlib_main_t * vm,
       am->use_hash_acl_matching = (val != 0);
       goto done;
     }
+  if (unformat (input, "use-decision-tree-matching %u", &val))
+    {
+      acl_dtree_set_enable (am, (val != 0));
+      goto done;
+    }
   if (unformat (input, "l4-match-nonfirst-fragment %u", &val))
     {
       am->l4_match_nonfirst_fragment = (val != 0);
@@ -3476,6 +3482,7 @@ acl_show_aclplugin_tables_fn (vlib_main_t * vm,
   int show_applied_info = 0;
   int show_mask_type = 0;
   int show_bihash = 0;
+  int show_dtree = 0;
   u32 show_bihash_verbose = 0;
 
   if (unformat (input, "acl"))
@@ -3499,21 +3506,29 @@ acl_show_aclplugin_tables_fn (vlib_main_t * vm,
       show_bihash = 1;
       unformat (input, "verbose %u", &show_bihash_verbose);
     }
+  else if (unformat (input, "dtree"))
+    {
+      show_dtree = 1;
+      unformat (input, "lc_index %u", &lc_index);
+    }
 
   if (!
       (show_mask_type || show_acl_hash_info || show_applied_info
-       || show_bihash))
+       || show_bihash || show_dtree))
     {
       /* if no qualifiers specified, show all */
       show_mask_type = 1;
       show_acl_hash_info = 1;
       show_applied_info = 1;
       show_bihash = 1;
+      show_dtree = 1;
     }
   vlib_cli_output (vm, "Stats counters enabled for interface ACLs: %d",
 		   acl_main.interface_acl_counters_enabled);
   vlib_cli_output (vm, "Use hash-based lookup for ACLs: %d",
 		   acl_main.use_hash_acl_matching);
+  vlib_cli_output (vm, "Use decision tree lookup for ACLs: %d",
+		   acl_main.use_dtree_acl_matching);
   if (show_mask_type)
     acl_plugin_show_tables_mask_type ();
   if (show_acl_hash_info)
@@ -3522,10 +3537,302 @@ acl_show_aclplugin_tables_fn (vlib_main_t * vm,
     acl_plugin_show_tables_applied_info (lc_index);
   if (show_bihash)
     acl_plugin_show_tables_bihash (show_bihash_verbose);
+  if (show_dtree)
+    acl_plugin_show_tables_dtree (lc_index);
 
   return error;
 }
 
+static void
+acl_bench_random_prefix (u32 * seed, int is_ip6, ip_prefix_t * pfx)
+{
+  u32 r = random_u32 (seed);
+  int i;
+
+  clib_memset (pfx, 0, sizeof (*pfx));
+  pfx->addr.version = is_ip6 ? AF_IP6 : AF_IP4;
+  if (is_ip6)
+    {
+      /* byte aligned: the linear matching mishandles the others */
+      pfx->len = 8 * (r % 17);
+      for (i = 0; i < pfx->len / 8; i++)
+	pfx->addr.ip.ip6.as_u8[i] = random_u32 (seed);
+    }
+  else
+    {
+      /* mostly long prefixes, with a sprinkle of wildcards */
+      static const u8 lens[] = { 0, 8, 16, 20, 24, 24, 28, 32, 32, 32 };
+      pfx->len = lens[r % ARRAY_LEN (lens)];
+      if (pfx->len)
+	pfx->addr.ip.ip4.as_u32 =
+	  clib_host_to_net_u32 (random_u32 (seed) & (~0U << (32 - pfx->len)));
+    }
+}
+
+static void
+acl_bench_random_ports (u32 * seed, u16 * first, u16 * last)
+{
+  u32 r = random_u32 (seed);
+  u16 port = random_u32 (seed);
+
+  switch (r % 3)
+    {
+    case 0:
+      *first = *last = port;
+      break;
+    case 1:
+      *first = port & 0xff00;
+      *last = port | 0xff;
+      break;
+    default:
+      *first = 0;
+      *last = 0xffff;
+      break;
+    }
+}
+
+static void
+acl_bench_random_rule (u32 * seed, int is_ip6, vl_api_acl_rule_t * rule)
+{
+  static const u8 protos[] = { 0, IP_PROTOCOL_TCP, IP_PROTOCOL_TCP,
+    IP_PROTOCOL_UDP
+  };
+  ip_prefix_t src, dst;
+  u16 first, last;
+
+  clib_memset (rule, 0, sizeof (*rule));
+  rule->is_permit = random_u32 (seed) & 1;
+  acl_bench_random_prefix (seed, is_ip6, &src);
+  acl_bench_random_prefix (seed, is_ip6, &dst);
+  ip_prefix_encode2 (&src, &rule->src_prefix);
+  ip_prefix_encode2 (&dst, &rule->dst_prefix);
+  rule->proto = protos[random_u32 (seed) % ARRAY_LEN (protos)];
+  if (random_u32 (seed) & 3)
+    {
+      first = 0;
+      last = 0xffff;
+    }
+  else
+    acl_bench_random_ports (seed, &first, &last);
+  rule->srcport_or_icmptype_first = htons (first);
+  rule->srcport_or_icmptype_last = htons (last);
+  acl_bench_random_ports (seed, &first, &last);
+  rule->dstport_or_icmpcode_first = htons (first);
+  rule->dstport_or_icmpcode_last = htons (last);
+}
+
+static u64
+acl_bench_random_in_range (u32 * seed, u64 first, u64 last)
+{
+  return first + (random_u32 (seed) % (last - first + 1));
+}
+
+/* half of the packets aim at a rule, the other half are random */
+static void
+acl_bench_random_packet (u32 * seed, acl_rule_t * rules, int is_ip6,
+			 u32 lc_index, fa_5tuple_t * pkt)
+{
+  acl_rule_t *r = vec_elt_at_index (rules, random_u32 (seed) % vec_len (rules));
+  int aimed = random_u32 (seed) & 1;
+  ip46_address_t *prefix[2] = { &r->src, &r->dst };
+  u8 len[2] = { r->src_prefixlen, r->dst_prefixlen };
+  int i, j;
+
+  clib_memset (pkt, 0, sizeof (*pkt));
+  for (i = 0; i < 2; i++)
+    {
+      if (is_ip6)
+	{
+	  for (j = 0; j < 16; j++)
+	    pkt->ip6_addr[i].as_u8[j] = (aimed && j < len[i] / 8) ?
+	      prefix[i]->ip6.as_u8[j] : random_u32 (seed);
+	}
+      else
+	{
+	  u32 mask = (aimed && len[i]) ? ~0U << (32 - len[i]) : 0;
+	  pkt->ip4_addr[i].as_u32 =
+	    clib_host_to_net_u32 ((clib_net_to_host_u32
+				   (prefix[i]->ip4.as_u32) & mask) |
+				  (random_u32 (seed) & ~mask));
+	}
+    }
+  pkt->l4.proto = (aimed && r->proto) ? r->proto :
+    ((random_u32 (seed) & 1) ? IP_PROTOCOL_TCP : IP_PROTOCOL_UDP);
+  pkt->l4.port[0] = aimed ? acl_bench_random_in_range (seed,
+						       r->src_port_or_type_first,
+						       r->src_port_or_type_last) :
+    random_u32 (seed);
+  pkt->l4.port[1] = aimed ? acl_bench_random_in_range (seed,
+						       r->dst_port_or_code_first,
+						       r->dst_port_or_code_last) :
+    random_u32 (seed);
+  pkt->pkt.lc_index = lc_index;
+  pkt->pkt.is_ip6 = is_ip6;
+  pkt->pkt.l4_valid = 1;
+  pkt->pkt.tcp_flags_valid = (pkt->l4.proto == IP_PROTOCOL_TCP);
+  pkt->pkt.tcp_flags = TCP_FLAG_ACK;
+}
+
+typedef struct
+{
+  u32 matched;
+  u32 acl_pos;
+  u32 acl_index;
+  u32 rule_index;
+  u8 action;
+} acl_bench_result_t;
+
+static clib_error_t *
+acl_test_aclplugin_lookup_bench_fn (vlib_main_t * vm,
+				    unformat_input_t * input,
+				    vlib_cli_command_t * cmd)
+{
+  static u32 bench_user_id = ~0;
+  acl_main_t *am = &acl_main;
+  u32 n_rules = 1000, n_acls = 1, n_lookups = 100000, seed = 0xdeadbeef;
+  u32 i, a, lc_index, trace_bitmap = 0, n_mismatch[3] = { 0 };
+  u32 *acl_list = 0;
+  acl_rule_t *all_rules = 0;
+  fa_5tuple_t *pkts = 0;
+  acl_bench_result_t *res[3] = { 0 };
+  vl_api_acl_rule_t *rules = 0;
+  acl_dtree_lc_t *dt;
+  u64 clocks[3];
+  f64 build_time;
+  int engine, is_ip6 = 0, rv;
+  static const char *engines[] = { "linear", "hash", "dtree" };
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "rules %u", &n_rules))
+	;
+      else if (unformat (input, "acls %u", &n_acls))
+	;
+      else if (unformat (input, "lookups %u", &n_lookups))
+	;
+      else if (unformat (input, "seed %u", &seed))
+	;
+      else if (unformat (input, "ip6"))
+	is_ip6 = 1;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+  if (!n_rules || !n_acls || n_acls > n_rules || !n_lookups)
+    return clib_error_return (0, "need some rules, acls and lookups");
+
+  if (bench_user_id == ~0)
+    bench_user_id =
+      acl_plugin.register_user_module ("ACL lookup bench", "unused",
+				       "unused");
+  lc_index = acl_plugin.get_lookup_context_index (bench_user_id, 0, 0);
+
+  for (a = 0; a < n_acls; a++)
+    {
+      u32 acl_index = ~0;
+      u32 count = n_rules / n_acls + (a < n_rules % n_acls);
+
+      vec_validate (rules, count - 1);
+      for (i = 0; i < count; i++)
+	acl_bench_random_rule (&seed, is_ip6, &rules[i]);
+      rv = acl_add_list (count, rules, &acl_index, (u8 *) "bench");
+      if (rv)
+	{
+	  vlib_cli_output (vm, "acl_add_list failed: %d", rv);
+	  goto done;
+	}
+      vec_add1 (acl_list, acl_index);
+      vec_append (all_rules, am->acls[acl_index].rules);
+    }
+  acl_plugin.set_acl_vec_for_context (lc_index, acl_list);
+
+  build_time = vlib_time_now (vm);
+  dt = acl_dtree_build (am, lc_index, 0);
+  build_time = vlib_time_now (vm) - build_time;
+  if (!dt)
+    {
+      vlib_cli_output (vm, "decision tree could not be built");
+      goto done;
+    }
+
+  vec_validate (pkts, n_lookups - 1);
+  for (i = 0; i < n_lookups; i++)
+    acl_bench_random_packet (&seed, all_rules, is_ip6, lc_index, &pkts[i]);
+
+  for (engine = 0; engine < 3; engine++)
+    {
+      u64 start = clib_cpu_time_now ();
+
+      vec_validate (res[engine], n_lookups - 1);
+      for (i = 0; i < n_lookups; i++)
+	{
+	  acl_bench_result_t *r = &res[engine][i];
+	  switch (engine)
+	    {
+	    case 0:
+	      r->matched =
+		linear_multi_acl_match_5tuple (am, lc_index, &pkts[i], is_ip6,
+					       &r->action, &r->acl_pos,
+					       &r->acl_index, &r->rule_index,
+					       &trace_bitmap);
+	      break;
+	    case 1:
+	      r->matched =
+		hash_multi_acl_match_5tuple (am, lc_index, &pkts[i], is_ip6,
+					     &r->action, &r->acl_pos,
+					     &r->acl_index, &r->rule_index,
+					     &trace_bitmap);
+	      break;
+	    default:
+	      r->matched =
+		dtree_multi_acl_match_5tuple (am, dt, lc_index, &pkts[i],
+					      is_ip6, &r->action, &r->acl_pos,
+					      &r->acl_index, &r->rule_index,
+					      &trace_bitmap);
+	      break;
+	    }
+	}
+      clocks[engine] = clib_cpu_time_now () - start;
+    }
+
+  /* all the engines have to agree with the linear matching */
+  for (i = 0; i < n_lookups; i++)
+    for (engine = 1; engine < 3; engine++)
+      {
+	acl_bench_result_t *r0 = &res[0][i], *r = &res[engine][i];
+	if (r0->matched != r->matched || (r0->matched &&
+					  (r0->acl_index != r->acl_index
+					   || r0->rule_index != r->rule_index
+					   || r0->action != r->action)))
+	  n_mismatch[engine]++;
+      }
+
+  vlib_cli_output (vm, "%u %s rules in %u ACLs, %u lookups",
+		   n_rules, is_ip6 ? "ip6" : "ip4", n_acls, n_lookups);
+  for (engine = 0; engine < 3; engine++)
+    vlib_cli_output (vm, "  %-6s %10.1f clocks/lookup, %u mismatches",
+		     engines[engine], (f64) clocks[engine] / n_lookups,
+		     n_mismatch[engine]);
+  vlib_cli_output (vm, "  dtree built in %.3f ms, %u nodes, depth %u, "
+		   "max leaf rules %u, leaf rule refs %u",
+		   build_time * 1e3, vec_len (dt->trees[is_ip6].nodes),
+		   dt->trees[is_ip6].max_depth,
+		   dt->trees[is_ip6].max_leaf_rules,
+		   vec_len (dt->trees[is_ip6].refs));
+  acl_dtree_free (dt);
+
+done:
+  acl_plugin.put_lookup_context_index (lc_index);
+  vec_foreach_index (i, acl_list) acl_del_list (acl_list[i]);
+  for (engine = 0; engine < 3; engine++)
+    vec_free (res[engine]);
+  vec_free (acl_list);
+  vec_free (all_rules);
+  vec_free (rules);
+  vec_free (pkts);
+  return 0;
+}
+
 static clib_error_t *
 acl_clear_aclplugin_fn (vlib_main_t * vm,
 			unformat_input_t * input, vlib_cli_command_t * cmd)
@@ -3588,7 +3895,7 @@ VLIB_CLI_COMMAND (aclplugin_show_sessions_command, static) = {
 
 VLIB_CLI_COMMAND (aclplugin_show_tables_command, static) = {
     .path = "show acl-plugin tables",
-    .short_help = "show acl-plugin tables [ acl [index N] | applied [ lc_index N ] | mask | hash [verbose N] ]",
+    .short_help = "show acl-plugin tables [ acl [index N] | applied [ lc_index N ] | mask | hash [verbose N] | dtree [ lc_index N ] ]",
     .function = acl_show_aclplugin_tables_fn,
 };
 
@@ -3610,6 +3917,19 @@ VLIB_CLI_COMMAND (aclplugin_clear_command, static) = {
     .function = acl_clear_aclplugin_fn,
 };
 
+/*?
+ * Compare the linear, hash and decision tree ACL matching on a random
+ * rule set, applied to a lookup context of its own. The lookups aim at
+ * the rules half of the time, the results have to agree across the engines.
+ *
+ * @cliexcmd{test acl-plugin lookup-bench rules 5000 acls 4 lookups 100000}
+ ?*/
+VLIB_CLI_COMMAND (aclplugin_lookup_bench_command, static) = {
+    .path = "test acl-plugin lookup-bench",
+    .short_help = "test acl-plugin lookup-bench [rules N] [acls N] [lookups N] [seed N] [ip6]",
+    .function = acl_test_aclplugin_lookup_bench_fn,
+};
+
 /*?
  * [un]Apply an ACL to an interface.
  *  The ACL is applied in a given direction, either input or output.
@@ -3681,6 +4001,7 @@ acl_plugin_config (vlib_main_t * vm, unformat_input_t * input)
   uword hash_lookup_hash_memory;
   u32 reclassify_sessions;
   u32 use_tuple_merge;
+  u32 use_decision_tree;
   u32 tuple_merge_split_threshold;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
@@ -3719,6 +4040,8 @@ acl_plugin_config (vlib_main_t * vm, unformat_input_t * input)
 	am->hash_lookup_hash_memory = hash_lookup_hash_memory;
       else if (unformat (input, "use tuple merge %d", &use_tuple_merge))
 	am->use_tuple_merge = use_tuple_merge;
+      else if (unformat (input, "use decision tree %d", &use_decision_tree))
+	am->use_dtree_acl_matching = use_decision_tree;
       else
 	if (unformat
 	    (input, "tuple merge split threshold %d",
@@ -32,6 +32,7 @@
 #include "types.h"
 #include "fa_node.h"
 #include "hash_lookup_types.h"
+#include "dtree_lookup_types.h"
 #include "lookup_context.h"
 
 #define  ACL_PLUGIN_VERSION_MAJOR 1
@@ -183,6 +184,16 @@ typedef struct {
 #define TM_SPLIT_THRESHOLD 39
   int tuple_merge_split_threshold;
 
+  /* Do we use the decision trees for ACL matching where they are built */
+  int use_dtree_acl_matching;
+
+  /* decision trees by lc_index, 0 while a tree is being (re)built */
+  acl_dtree_lc_t **dtree_by_lc_index;
+  /* lookup contexts whose trees need to be rebuilt */
+  uword *dtree_rebuild_lc_bitmap;
+  /* trees unpublished but possibly still in use by the workers */
+  acl_dtree_lc_t **dtree_retired;
+
   /* a pool of all mask types present in all ACEs */
   ace_mask_type_entry_t *ace_mask_type_pool;
 
@@ -0,0 +1,571 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2024 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/vnet.h>
+#include <vppinfra/error.h>
+#include <acl/acl.h>
+
+#include "dtree_lookup.h"
+
+/*
+ * Decision tree matching
+ *
+ * A HyperSplit style tree, compiled per lookup context from the applied
+ * ACEs the hash matching maintains. Each rule is a box of ranges, one per
+ * dimension; each inner node cuts its region in two along one dimension,
+ * and the rules overlapping both halves are copied into both subtrees.
+ * The cut is put at the weighted median of the elementary segments the
+ * rules' ranges form in that dimension, and the dimension which copies
+ * the fewest rules is chosen. Rules after one covering the whole region
+ * can never match in there, and are dropped.
+ *
+ * The trees are compiled by a process node. A change to the applied ACEs
+ * unpublishes the lookup context's trees, the packets are matched using
+ * the hash until the process publishes the new ones with a pointer store.
+ * Unpublished trees are freed once the workers went through a loop.
+ *
+ * The rules are copied into the tree up front, so the nodes are then
+ * built off an explicit work stack, and the process suspends every
+ * ACL_DTREE_BUILD_SLICE seconds to let the main thread serve the CLI and
+ * API. A build whose lookup context changed meanwhile is dropped, the
+ * change has queued a fresh one.
+ */
+
+#define ACL_DTREE_EVENT_REBUILD 1
+/* let a burst of ACL changes settle before compiling */
+#define ACL_DTREE_BUILD_HOLDDOWN 1e-3
+/* build for this long, then suspend for ACL_DTREE_BUILD_YIELD */
+#define ACL_DTREE_BUILD_SLICE 1e-3
+#define ACL_DTREE_BUILD_YIELD 1e-4
+
+typedef struct {
+  u32 *rules;
+  u64 lo[ACL_DTREE_N_DIMS];
+  u64 hi[ACL_DTREE_N_DIMS];
+  u32 node_index;
+  u32 depth;
+} acl_dtree_build_item_t;
+
+typedef struct {
+  acl_main_t *am;
+  /* set when building from the process, which may suspend */
+  vlib_main_t *vm;
+  u32 lc_index;
+  f64 slice_start;
+  acl_dtree_t *t;
+  u32 max_refs;
+  int overflow;
+  int aborted;
+  /* nodes still to build, the top one is built next */
+  acl_dtree_build_item_t *stack;
+  /* scratch vectors for choosing the splits */
+  u64 *starts;
+  u64 *ends;
+  u64 *bounds;
+} acl_dtree_build_ctx_t;
+
+vlib_node_registration_t acl_dtree_builder_process_node;
+
+static void
+acl_dtree_ip4_range(ip4_address_t *addr, u8 prefixlen, u64 *lo, u64 *hi)
+{
+  u32 len = clib_min(prefixlen, 32);
+  u32 mask = len ? ~0U << (32 - len) : 0;
+  *lo = clib_net_to_host_u32(addr->as_u32) & mask;
+  *hi = *lo | (u32) ~mask;
+}
+
+static void
+acl_dtree_ip6_range(ip6_address_t *addr, u8 prefixlen, u64 *lo, u64 *hi,
+                    u64 *ip6_lo, u64 *ip6_lo_mask)
+{
+  u32 len_hi = clib_min(prefixlen, 64);
+  u32 len_lo = prefixlen > 64 ? clib_min(prefixlen - 64, 64) : 0;
+  u64 mask_hi = len_hi ? ~0ULL << (64 - len_hi) : 0;
+  u64 mask_lo = len_lo ? ~0ULL << (64 - len_lo) : 0;
+
+  *lo = clib_net_to_host_u64(addr->as_u64[0]) & mask_hi;
+  *hi = *lo | ~mask_hi;
+  *ip6_lo_mask = clib_host_to_net_u64(mask_lo);
+  *ip6_lo = addr->as_u64[1] & *ip6_lo_mask;
+}
+
+static void
+acl_dtree_compile_rule(acl_rule_t *r, u32 applied_entry_index, acl_dtree_rule_t *dr)
+{
+  clib_memset(dr, 0, sizeof(*dr));
+  dr->applied_entry_index = applied_entry_index;
+
+  if (r->is_ipv6) {
+    acl_dtree_ip6_range(&r->src.ip6, r->src_prefixlen,
+                        &dr->lo[ACL_DTREE_DIM_SRC_ADDR], &dr->hi[ACL_DTREE_DIM_SRC_ADDR],
+                        &dr->ip6_lo[0], &dr->ip6_lo_mask[0]);
+    acl_dtree_ip6_range(&r->dst.ip6, r->dst_prefixlen,
+                        &dr->lo[ACL_DTREE_DIM_DST_ADDR], &dr->hi[ACL_DTREE_DIM_DST_ADDR],
+                        &dr->ip6_lo[1], &dr->ip6_lo_mask[1]);
+  } else {
+    acl_dtree_ip4_range(&r->src.ip4, r->src_prefixlen,
+                        &dr->lo[ACL_DTREE_DIM_SRC_ADDR], &dr->hi[ACL_DTREE_DIM_SRC_ADDR]);
+    acl_dtree_ip4_range(&r->dst.ip4, r->dst_prefixlen,
+                        &dr->lo[ACL_DTREE_DIM_DST_ADDR], &dr->hi[ACL_DTREE_DIM_DST_ADDR]);
+  }
+
+  if (r->proto) {
+    /* same as the linear matching: ports and flags only count with a protocol */
+    dr->lo[ACL_DTREE_DIM_PROTO] = dr->hi[ACL_DTREE_DIM_PROTO] = r->proto;
+    dr->lo[ACL_DTREE_DIM_SRC_PORT] = r->src_port_or_type_first;
+    dr->hi[ACL_DTREE_DIM_SRC_PORT] = r->src_port_or_type_last;
+    dr->lo[ACL_DTREE_DIM_DST_PORT] = r->dst_port_or_code_first;
+    dr->hi[ACL_DTREE_DIM_DST_PORT] = r->dst_port_or_code_last;
+    dr->tcp_flags_value = r->tcp_flags_value;
+    dr->tcp_flags_mask = r->tcp_flags_mask;
+    dr->need_l4 = 1;
+  } else {
+    dr->hi[ACL_DTREE_DIM_PROTO] = 0xff;
+    dr->hi[ACL_DTREE_DIM_SRC_PORT] = 0xffff;
+    dr->hi[ACL_DTREE_DIM_DST_PORT] = 0xffff;
+  }
+
+  dr->is_exact = !dr->need_l4 &&
+    (!r->is_ipv6 || (r->src_prefixlen <= 64 && r->dst_prefixlen <= 64));
+}
+
+static int
+acl_dtree_rule_covers(acl_dtree_rule_t *r, u64 *lo, u64 *hi)
+{
+  int d;
+  if (!r->is_exact)
+    return 0;
+  for (d = 0; d < ACL_DTREE_N_DIMS; d++)
+    if (r->lo[d] > lo[d] || r->hi[d] < hi[d])
+      return 0;
+  return 1;
+}
+
+static int
+acl_dtree_cmp_u64(void *a1, void *a2)
+{
+  u64 *v1 = a1, *v2 = a2;
+  return (*v1 > *v2) - (*v1 < *v2);
+}
+
+/*
+ * Find the cut in dimension d: the region [lo, hi] is split into the
+ * elementary segments delimited by the rules' ranges, each weighted by
+ * the number of rules overlapping it, and the cut is put at the end of
+ * the segment where the weight to its left reaches half of the total.
+ */
+static int
+acl_dtree_choose_split(acl_dtree_build_ctx_t *ctx, u32 *rules, u32 n, int d,
+                       u64 lo, u64 hi, u64 *split, u32 *n_left, u32 *n_right)
+{
+  acl_dtree_t *t = ctx->t;
+  u64 total = 0, sum = 0, seg_start;
+  u32 i, k, n_bounds, si = 0, ei = 0;
+
+  vec_reset_length(ctx->starts);
+  vec_reset_length(ctx->ends);
+  vec_reset_length(ctx->bounds);
+
+  for (i = 0; i < n; i++) {
+    acl_dtree_rule_t *r = vec_elt_at_index(t->rules, rules[i]);
+    u64 a = clib_max(r->lo[d], lo);
+    u64 b = clib_min(r->hi[d], hi);
+    vec_add1(ctx->starts, a);
+    vec_add1(ctx->ends, b);
+    if (a > lo)
+      vec_add1(ctx->bounds, a);
+    if (b < hi)
+      vec_add1(ctx->bounds, b + 1);
+  }
+
+  if (0 == vec_len(ctx->bounds))
+    return 0;
+
+  vec_sort_with_function(ctx->starts, acl_dtree_cmp_u64);
+  vec_sort_with_function(ctx->ends, acl_dtree_cmp_u64);
+  vec_sort_with_function(ctx->bounds, acl_dtree_cmp_u64);
+  for (i = 1, n_bounds = 1; i < vec_len(ctx->bounds); i++)
+    if (ctx->bounds[i] != ctx->bounds[n_bounds - 1])
+      ctx->bounds[n_bounds++] = ctx->bounds[i];
+
+  /* a segment's weight is the number of rules started but not ended before it */
+  for (k = 0; k <= n_bounds; k++) {
+    seg_start = k ? ctx->bounds[k - 1] : lo;
+    while (si < n && ctx->starts[si] <= seg_start)
+      si++;
+    while (ei < n && ctx->ends[ei] < seg_start)
+      ei++;
+    total += si - ei;
+  }
+
+  /* the cut goes at the end of a segment, so never after the last one */
+  si = ei = 0;
+  for (k = 0; k < n_bounds - 1; k++) {
+    seg_start = k ? ctx->bounds[k - 1] : lo;
+    while (si < n && ctx->starts[si] <= seg_start)
+      si++;
+    while (ei < n && ctx->ends[ei] < seg_start)
+      ei++;
+    sum += si - ei;
+    if (2 * sum >= total)
+      break;
+  }
+  *split = ctx->bounds[k] - 1;
+
+  /* rules starting at or before the cut go left, ending after it go right */
+  for (i = 0, *n_left = 0; i < n && ctx->starts[i] <= *split; i++)
+    (*n_left)++;
+  for (i = 0, *n_right = 0; i < n; i++)
+    *n_right += ctx->ends[i] > *split;
+  return 1;
+}
+
+/*
+ * Suspend the builder once it used up its time slice. Returns 0 when the
+ * lookup context changed or went away meanwhile, and the build is moot.
+ */
+static int
+acl_dtree_build_yield(acl_dtree_build_ctx_t *ctx)
+{
+  acl_main_t *am = ctx->am;
+  f64 now;
+
+  if (!ctx->vm)
+    return 1;
+  now = vlib_time_now(ctx->vm);
+  if (now - ctx->slice_start < ACL_DTREE_BUILD_SLICE)
+    return 1;
+
+  vlib_process_suspend(ctx->vm, ACL_DTREE_BUILD_YIELD);
+  ctx->slice_start = vlib_time_now(ctx->vm);
+
+  return am->use_dtree_acl_matching
+    && !pool_is_free_index(am->acl_lookup_contexts, ctx->lc_index)
+    && !clib_bitmap_get(am->dtree_rebuild_lc_bitmap, ctx->lc_index);
+}
+
+static void
+acl_dtree_build_push(acl_dtree_build_ctx_t *ctx, u32 node_index, u32 *rules,
+                     u64 *lo, u64 *hi, u32 depth)
+{
+  acl_dtree_build_item_t *it;
+
+  vec_add2(ctx->stack, it, 1);
+  it->rules = rules;
+  clib_memcpy_fast(it->lo, lo, sizeof(it->lo));
+  clib_memcpy_fast(it->hi, hi, sizeof(it->hi));
+  it->node_index = node_index;
+  it->depth = depth;
+}
+
+/*
+ * Turn the node into a leaf, or cut it and queue up both children. The
+ * item is a copy popped off the stack, and owns its rules vector.
+ */
+static void
+acl_dtree_build_node(acl_dtree_build_ctx_t *ctx, acl_dtree_build_item_t *it)
+{
+  acl_dtree_t *t = ctx->t;
+  u32 i, n, n_left, n_right, cost, best_cost = ~0, child;
+  int d, best_dim = -1;
+  u64 split, best_split = 0, saved;
+  u32 *rules = it->rules, *left = 0, *right = 0;
+  acl_dtree_node_t *c;
+
+  n = vec_len(rules);
+  for (i = 0; i < n; i++) {
+    if (acl_dtree_rule_covers(vec_elt_at_index(t->rules, rules[i]), it->lo, it->hi)) {
+      /* nothing after this one can match in here */
+      n = i + 1;
+      break;
+    }
+  }
+
+  if (n > ACL_DTREE_LEAF_SIZE && it->depth < ACL_DTREE_MAX_DEPTH) {
+    for (d = 0; d < ACL_DTREE_N_DIMS; d++) {
+      if (!acl_dtree_choose_split(ctx, rules, n, d, it->lo[d], it->hi[d], &split, &n_left, &n_right))
+        continue;
+      /* a cut which leaves all the rules on one side gets us nowhere */
+      if (clib_max(n_left, n_right) >= n)
+        continue;
+      cost = n_left + n_right;
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_dim = d;
+        best_split = split;
+      }
+    }
+  }
+
+  if (best_dim < 0) {
+    acl_dtree_node_t *leaf = vec_elt_at_index(t->nodes, it->node_index);
+    leaf->dim = ACL_DTREE_DIM_LEAF;
+    leaf->index = vec_len(t->refs);
+    leaf->split = n;
+    vec_add(t->refs, rules, n);
+    t->max_depth = clib_max(t->max_depth, it->depth);
+    t->max_leaf_rules = clib_max(t->max_leaf_rules, n);
+    if (vec_len(t->refs) > ctx->max_refs)
+      ctx->overflow = 1;
+    vec_free(rules);
+    return;
+  }
+
+  for (i = 0; i < n; i++) {
+    acl_dtree_rule_t *r = vec_elt_at_index(t->rules, rules[i]);
+    if (r->lo[best_dim] <= best_split)
+      vec_add1(left, rules[i]);
+    if (r->hi[best_dim] > best_split)
+      vec_add1(right, rules[i]);
+  }
+  vec_free(rules);
+
+  vec_add2(t->nodes, c, 2);
+  child = c - t->nodes;
+  t->nodes[it->node_index].dim = best_dim;
+  t->nodes[it->node_index].split = best_split;
+  t->nodes[it->node_index].index = child;
+
+  /* the left child goes on top, so the leaves are laid out depth first */
+  saved = it->lo[best_dim];
+  it->lo[best_dim] = best_split + 1;
+  acl_dtree_build_push(ctx, child + 1, right, it->lo, it->hi, it->depth + 1);
+  it->lo[best_dim] = saved;
+
+  it->hi[best_dim] = best_split;
+  acl_dtree_build_push(ctx, child, left, it->lo, it->hi, it->depth + 1);
+}
+
+static int
+acl_dtree_build_af(acl_dtree_build_ctx_t *ctx, applied_hash_ace_entry_t *aces,
+                   int is_ip6, acl_dtree_t *t)
+{
+  acl_main_t *am = ctx->am;
+  u64 lo[ACL_DTREE_N_DIMS] = { 0 };
+  u64 hi[ACL_DTREE_N_DIMS];
+  acl_dtree_build_item_t it;
+  acl_dtree_node_t *root;
+  acl_dtree_rule_t *dr;
+  u32 i, *rules = 0;
+
+  for (i = 0; i < vec_len(aces); i++) {
+    applied_hash_ace_entry_t *pae = vec_elt_at_index(aces, i);
+    acl_rule_t *r = vec_elt_at_index(am->acls[pae->acl_index].rules, pae->ace_index);
+    if (r->is_ipv6 != is_ip6)
+      continue;
+    vec_add2(t->rules, dr, 1);
+    acl_dtree_compile_rule(r, i, dr);
+    vec_add1(rules, dr - t->rules);
+  }
+
+  hi[ACL_DTREE_DIM_SRC_ADDR] = hi[ACL_DTREE_DIM_DST_ADDR] = is_ip6 ? ~0ULL : 0xffffffff;
+  hi[ACL_DTREE_DIM_PROTO] = 0xff;
+  hi[ACL_DTREE_DIM_SRC_PORT] = hi[ACL_DTREE_DIM_DST_PORT] = 0xffff;
+
+  ctx->t = t;
+  ctx->max_refs = ACL_DTREE_MAX_REFS_PER_RULE * vec_len(rules) + ACL_DTREE_LEAF_SIZE;
+  vec_add2(t->nodes, root, 1);
+  acl_dtree_build_push(ctx, 0, rules, lo, hi, 0);
+
+  while (vec_len(ctx->stack) && !ctx->overflow) {
+    it = vec_pop(ctx->stack);
+    acl_dtree_build_node(ctx, &it);
+    if (!acl_dtree_build_yield(ctx)) {
+      ctx->aborted = 1;
+      break;
+    }
+  }
+
+  /* whatever is left over when giving up */
+  vec_foreach_index(i, ctx->stack)
+    vec_free(ctx->stack[i].rules);
+  vec_reset_length(ctx->stack);
+  return !ctx->overflow && !ctx->aborted;
+}
+
+void
+acl_dtree_free(acl_dtree_lc_t *dt)
+{
+  int is_ip6;
+  for (is_ip6 = 0; is_ip6 < 2; is_ip6++) {
+    vec_free(dt->trees[is_ip6].nodes);
+    vec_free(dt->trees[is_ip6].refs);
+    vec_free(dt->trees[is_ip6].rules);
+  }
+  clib_mem_free(dt);
+}
+
+acl_dtree_lc_t *
+acl_dtree_build(acl_main_t *am, u32 lc_index, vlib_main_t *vm)
+{
+  acl_dtree_build_ctx_t ctx = { .am = am, .vm = vm, .lc_index = lc_index };
+  applied_hash_ace_entry_t *aces = 0;
+  acl_dtree_lc_t *dt = 0;
+  f64 start = vlib_time_now(am->vlib_main);
+  int is_ip6;
+
+  if (lc_index < vec_len(am->hash_entry_vec_by_lc_index))
+    aces = am->hash_entry_vec_by_lc_index[lc_index];
+
+  dt = clib_mem_alloc_aligned(sizeof(*dt), CLIB_CACHE_LINE_BYTES);
+  clib_memset(dt, 0, sizeof(*dt));
+
+  ctx.slice_start = start;
+  for (is_ip6 = 0; is_ip6 < 2; is_ip6++) {
+    /* the ACEs may have changed while suspended building the ip4 tree */
+    if (is_ip6 && lc_index < vec_len(am->hash_entry_vec_by_lc_index))
+      aces = am->hash_entry_vec_by_lc_index[lc_index];
+    if (!acl_dtree_build_af(&ctx, aces, is_ip6, &dt->trees[is_ip6])) {
+      if (ctx.overflow)
+        clib_warning("ACL decision tree for lc_index %d is too large, using the hash", lc_index);
+      acl_dtree_free(dt);
+      dt = 0;
+      goto done;
+    }
+  }
+  /* wall clock, including the time spent suspended */
+  dt->build_time = vlib_time_now(am->vlib_main) - start;
+
+done:
+  vec_free(ctx.stack);
+  vec_free(ctx.starts);
+  vec_free(ctx.ends);
+  vec_free(ctx.bounds);
+  return dt;
+}
+
+static void
+acl_dtree_signal_builder(acl_main_t *am)
+{
+  vlib_process_signal_event(am->vlib_main, acl_dtree_builder_process_node.index,
+                            ACL_DTREE_EVENT_REBUILD, 0);
+}
+
+/* publish a tree, or unpublish with dt == 0, retiring the previous one */
+static void
+acl_dtree_publish(acl_main_t *am, u32 lc_index, acl_dtree_lc_t *dt)
+{
+  acl_dtree_lc_t *old = am->dtree_by_lc_index[lc_index];
+  clib_atomic_store_rel_n(&am->dtree_by_lc_index[lc_index], dt);
+  if (old)
+    vec_add1(am->dtree_retired, old);
+}
+
+void
+acl_dtree_invalidate(acl_main_t *am, u32 lc_index)
+{
+  /* the workers are stopped while the applied ACEs change, so can resize */
+  vec_validate(am->dtree_by_lc_index, lc_index);
+  acl_dtree_publish(am, lc_index, 0);
+
+  if (am->use_dtree_acl_matching)
+    am->dtree_rebuild_lc_bitmap = clib_bitmap_set(am->dtree_rebuild_lc_bitmap, lc_index, 1);
+
+  if (am->use_dtree_acl_matching || vec_len(am->dtree_retired))
+    acl_dtree_signal_builder(am);
+}
+
+void
+acl_dtree_set_enable(acl_main_t *am, int enable)
+{
+  acl_lookup_context_t *acontext;
+
+  am->use_dtree_acl_matching = enable;
+  pool_foreach (acontext, am->acl_lookup_contexts)
+   {
+    acl_dtree_invalidate(am, acontext - am->acl_lookup_contexts);
+  }
+}
+
+static uword
+acl_dtree_builder_process (vlib_main_t * vm, vlib_node_runtime_t * rt,
+                           vlib_frame_t * f)
+{
+  acl_main_t *am = &acl_main;
+  acl_dtree_lc_t **dtp, *dt;
+  uword *rebuild;
+  u32 lc_index;
+
+  while (1)
+    {
+      vlib_process_wait_for_event (vm);
+      vlib_process_get_events (vm, 0);
+      vlib_process_suspend (vm, ACL_DTREE_BUILD_HOLDDOWN);
+
+      rebuild = am->dtree_rebuild_lc_bitmap;
+      am->dtree_rebuild_lc_bitmap = 0;
+      clib_bitmap_foreach (lc_index, rebuild)
+        {
+          if (!am->use_dtree_acl_matching
+              || pool_is_free_index (am->acl_lookup_contexts, lc_index))
+            continue;
+          dt = acl_dtree_build (am, lc_index, vm);
+          /* a context changed while building was unpublished, and queued */
+          if (dt || !clib_bitmap_get (am->dtree_rebuild_lc_bitmap, lc_index))
+            acl_dtree_publish (am, lc_index, dt);
+        }
+      clib_bitmap_free (rebuild);
+
+      if (vec_len (am->dtree_retired))
+        {
+          /* let the lookups which may still see the retired trees finish */
+          vlib_worker_wait_one_loop ();
+          vec_foreach (dtp, am->dtree_retired)
+            acl_dtree_free (*dtp);
+          vec_reset_length (am->dtree_retired);
+        }
+    }
+  return 0;
+}
+
+VLIB_REGISTER_NODE (acl_dtree_builder_process_node) = {
+  .function = acl_dtree_builder_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "acl-plugin-dtree-builder-process",
+};
+
+void
+acl_plugin_show_tables_dtree (u32 lc_index)
+{
+  acl_main_t *am = &acl_main;
+  vlib_main_t *vm = am->vlib_main;
+  acl_lookup_context_t *acontext;
+  acl_dtree_lc_t *dt;
+  int is_ip6;
+
+  vlib_cli_output (vm, "Decision trees for lookup contexts");
+  pool_foreach (acontext, am->acl_lookup_contexts)
+   {
+    u32 lci = acontext - am->acl_lookup_contexts;
+    if ((lc_index != ~0) && (lc_index != lci))
+      continue;
+    dt = lci < vec_len(am->dtree_by_lc_index) ? am->dtree_by_lc_index[lci] : 0;
+    if (!dt) {
+      vlib_cli_output(vm, "lc_index %d: not built", lci);
+      continue;
+    }
+    vlib_cli_output(vm, "lc_index %d: built in %.3f ms", lci, dt->build_time * 1e3);
+    for (is_ip6 = 0; is_ip6 < 2; is_ip6++) {
+      acl_dtree_t *t = &dt->trees[is_ip6];
+      vlib_cli_output(vm, "  %s: rules %d nodes %d leaf rule refs %d max depth %d max leaf rules %d",
+                      is_ip6 ? "ip6" : "ip4", vec_len(t->rules), vec_len(t->nodes),
+                      vec_len(t->refs), t->max_depth, t->max_leaf_rules);
+    }
+  }
+}
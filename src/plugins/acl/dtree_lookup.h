@@ -0,0 +1,44 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2024 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+#ifndef _ACL_DTREE_LOOKUP_H_
+#define _ACL_DTREE_LOOKUP_H_
+
+#include "acl.h"
+
+/*
+ * Unpublish the trees of the lookup context before its applied ACEs
+ * change. The lookups fall back to the hash until the builder process
+ * has compiled and published the new trees.
+ */
+void acl_dtree_invalidate(acl_main_t *am, u32 lc_index);
+
+/* Turn the decision tree matching on or off, building or retiring all the trees */
+void acl_dtree_set_enable(acl_main_t *am, int enable);
+
+/*
+ * Compile the trees for the current applied ACEs of a lookup context,
+ * returns 0 if the rules do not make for a tree of a sensible size.
+ * With vm set, must run in a process, which suspends now and then and
+ * returns 0 if the lookup context changed meanwhile.
+ */
+acl_dtree_lc_t *acl_dtree_build(acl_main_t *am, u32 lc_index, vlib_main_t *vm);
+void acl_dtree_free(acl_dtree_lc_t *dt);
+
+void acl_plugin_show_tables_dtree (u32 lc_index);
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2024 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+#ifndef _ACL_DTREE_LOOKUP_TYPES_H_
+#define _ACL_DTREE_LOOKUP_TYPES_H_
+
+#include "types.h"
+
+/*
+ * The dimensions the decision tree cuts along. For IPv6 the address
+ * dimensions hold the upper 64 bits of the address, the lower 64 bits
+ * are only checked against the candidate rules in the leaves.
+ */
+typedef enum {
+  ACL_DTREE_DIM_SRC_ADDR,
+  ACL_DTREE_DIM_DST_ADDR,
+  ACL_DTREE_DIM_PROTO,
+  ACL_DTREE_DIM_SRC_PORT,
+  ACL_DTREE_DIM_DST_PORT,
+  ACL_DTREE_N_DIMS,
+} acl_dtree_dim_t;
+
+#define ACL_DTREE_DIM_LEAF 0xff
+
+/* trace bit: the packet was matched using the decision tree */
+#define ACL_DTREE_TRACE_BIT 0x20000000
+
+/* stop cutting once a node has this many candidate rules */
+#define ACL_DTREE_LEAF_SIZE 8
+#define ACL_DTREE_MAX_DEPTH 48
+/* give up if the rules get copied into more than this many leaves on average */
+#define ACL_DTREE_MAX_REFS_PER_RULE 64
+
+typedef struct {
+  /* inner nodes: the key goes left if <= split; leaves: number of rules */
+  u64 split;
+  /* inner nodes: index of the left child, the right one follows it;
+     leaves: index of the first rule reference */
+  u32 index;
+  u8 dim;
+} acl_dtree_node_t;
+
+/* A rule compiled into ranges, one per dimension */
+typedef struct {
+  u64 lo[ACL_DTREE_N_DIMS];
+  u64 hi[ACL_DTREE_N_DIMS];
+  /* lower 64 bits of the IPv6 src/dst prefixes, network order */
+  u64 ip6_lo[2];
+  u64 ip6_lo_mask[2];
+  /* index into the applied hash ACE entries of the lookup context */
+  u32 applied_entry_index;
+  u8 tcp_flags_value;
+  u8 tcp_flags_mask;
+  /* the rule has a protocol, so needs valid L4 info to match */
+  u8 need_l4;
+  /* the ranges describe the rule exactly, no leaf check needed */
+  u8 is_exact;
+} acl_dtree_rule_t;
+
+typedef struct {
+  acl_dtree_node_t *nodes;
+  /* leaves point into this vector of rule indices */
+  u32 *refs;
+  acl_dtree_rule_t *rules;
+  u32 max_depth;
+  u32 max_leaf_rules;
+} acl_dtree_t;
+
+/* The trees of a lookup context, published and retired as one */
+typedef struct {
+  /* indexed by is_ip6 */
+  acl_dtree_t trees[2];
+  /* time taken to compile, for show */
+  f64 build_time;
+} acl_dtree_lc_t;
+
+#endif
@@ -18,6 +18,7 @@
 #include <vlib/unix/plugin.h>
 #include <plugins/acl/public_inlines.h>
 #include "hash_lookup.h"
+#include "dtree_lookup.h"
 #include "elog_acl_trace.h"
 
 /* check if a given ACL exists */
@@ -203,6 +204,7 @@ static void acl_plugin_put_lookup_context_index (u32 lc_index)
   ASSERT(index != ~0);
 
   vec_del1(am->acl_users[acontext->context_user_id].lookup_contexts, index);
+  acl_dtree_invalidate(am, lc_index);
   unapply_acl_vec(lc_index, acontext->acl_indices);
   unlock_acl_vec(lc_index, acontext->acl_indices);
   vec_free(acontext->acl_indices);
@@ -254,6 +256,7 @@ static int acl_plugin_set_acl_vec_for_context (u32 lc_index, u32 *acl_list)
   u32 *old_acl_vector = acontext->acl_indices;
   acontext->acl_indices = vec_dup(acl_list);
 
+  acl_dtree_invalidate(am, lc_index);
   unapply_acl_vec(lc_index, old_acl_vector);
   unlock_acl_vec(lc_index, old_acl_vector);
   lock_acl_vec(lc_index, acontext->acl_indices);
@@ -270,6 +273,12 @@ done:
 void acl_plugin_lookup_context_notify_acl_change(u32 acl_num)
 {
   acl_main_t *am = &acl_main;
+  if (acl_num < vec_len(am->lc_index_vec_by_acl)) {
+    u32 *lc_index;
+    vec_foreach(lc_index, am->lc_index_vec_by_acl[acl_num]) {
+      acl_dtree_invalidate(am, *lc_index);
+    }
+  }
   if (acl_plugin_acl_exists(acl_num)) {
     if (hash_acl_exists(am, acl_num)) {
         /* this is a modification, clean up the older entries */
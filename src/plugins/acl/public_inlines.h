@@ -649,6 +649,104 @@ hash_multi_acl_match_5tuple (void *p_acl_main, u32 lc_index, fa_5tuple_t * pkt_5
 
 
 
+always_inline acl_dtree_lc_t *
+acl_dtree_get_lc (acl_main_t * am, u32 lc_index)
+{
+  if (lc_index >= vec_len(am->dtree_by_lc_index))
+    return 0;
+  return clib_atomic_load_acq_n(&am->dtree_by_lc_index[lc_index]);
+}
+
+always_inline void
+acl_dtree_fill_key (fa_5tuple_t * match, int is_ip6, u64 * key)
+{
+  if (is_ip6) {
+    key[ACL_DTREE_DIM_SRC_ADDR] = clib_net_to_host_u64(match->ip6_addr[0].as_u64[0]);
+    key[ACL_DTREE_DIM_DST_ADDR] = clib_net_to_host_u64(match->ip6_addr[1].as_u64[0]);
+  } else {
+    key[ACL_DTREE_DIM_SRC_ADDR] = clib_net_to_host_u32(match->ip4_addr[0].as_u32);
+    key[ACL_DTREE_DIM_DST_ADDR] = clib_net_to_host_u32(match->ip4_addr[1].as_u32);
+  }
+  key[ACL_DTREE_DIM_PROTO] = match->l4.proto;
+  key[ACL_DTREE_DIM_SRC_PORT] = match->l4.port[0];
+  key[ACL_DTREE_DIM_DST_PORT] = match->l4.port[1];
+}
+
+always_inline int
+acl_dtree_rule_match (acl_dtree_rule_t * r, u64 * key, int is_ip6, fa_5tuple_t * match)
+{
+  int i;
+  for (i = 0; i < ACL_DTREE_N_DIMS; i++)
+    if (key[i] < r->lo[i] || key[i] > r->hi[i])
+      return 0;
+
+  if (PREDICT_TRUE(r->is_exact))
+    return 1;
+
+  if (is_ip6
+      && (((match->ip6_addr[0].as_u64[1] & r->ip6_lo_mask[0]) != r->ip6_lo[0])
+          || ((match->ip6_addr[1].as_u64[1] & r->ip6_lo_mask[1]) != r->ip6_lo[1])))
+    return 0;
+
+  if (r->need_l4) {
+    if (PREDICT_FALSE(!match->pkt.l4_valid))
+      return 0;
+    if (match->pkt.tcp_flags_valid
+        && ((match->pkt.tcp_flags & r->tcp_flags_mask) != r->tcp_flags_value))
+      return 0;
+  }
+  return 1;
+}
+
+/*
+ * Walk the tree down to the leaf covering the packet and return the
+ * first of the leaf's rules, which are kept in the ACE order, that matches.
+ */
+always_inline u32
+dtree_multi_acl_match_get_applied_ace_index (acl_dtree_lc_t * dt, int is_ip6, fa_5tuple_t * match)
+{
+  acl_dtree_t *t = &dt->trees[is_ip6];
+  acl_dtree_node_t *n;
+  u64 key[ACL_DTREE_N_DIMS];
+  u32 i, *refs;
+
+  acl_dtree_fill_key(match, is_ip6, key);
+
+  n = t->nodes;
+  while (n->dim != ACL_DTREE_DIM_LEAF)
+    n = t->nodes + n->index + (key[n->dim] > n->split);
+
+  refs = t->refs + n->index;
+  for (i = 0; i < n->split; i++) {
+    acl_dtree_rule_t *r = vec_elt_at_index(t->rules, refs[i]);
+    if (acl_dtree_rule_match(r, key, is_ip6, match))
+      return r->applied_entry_index;
+  }
+  return ~0;
+}
+
+always_inline int
+dtree_multi_acl_match_5tuple (void *p_acl_main, acl_dtree_lc_t * dt, u32 lc_index,
+                       fa_5tuple_t * pkt_5tuple, int is_ip6, u8 *action,
+                       u32 *acl_pos_p, u32 * acl_match_p, u32 * rule_match_p,
+                       u32 * trace_bitmap)
+{
+  acl_main_t *am = p_acl_main;
+  applied_hash_ace_entry_t **applied_hash_aces = vec_elt_at_index(am->hash_entry_vec_by_lc_index, lc_index);
+  u32 match_index = dtree_multi_acl_match_get_applied_ace_index(dt, is_ip6, pkt_5tuple);
+  *trace_bitmap |= ACL_DTREE_TRACE_BIT;
+  if (match_index < vec_len((*applied_hash_aces))) {
+    applied_hash_ace_entry_t *pae = vec_elt_at_index((*applied_hash_aces), match_index);
+    pae->hitcount++;
+    *acl_pos_p = pae->acl_position;
+    *acl_match_p = pae->acl_index;
+    *rule_match_p = pae->ace_index;
+    *action = pae->action;
+    return 1;
+  }
+  return 0;
+}
+
 always_inline int
 acl_plugin_match_5tuple_inline (void *p_acl_main, u32 lc_index,
                                            fa_5tuple_opaque_t * pkt_5tuple,
@@ -661,6 +759,13 @@ acl_plugin_match_5tuple_inline (void *p_acl_main, u32 lc_index,
   acl_main_t *am = p_acl_main;
   fa_5tuple_t * pkt_5tuple_internal = (fa_5tuple_t *)pkt_5tuple;
   pkt_5tuple_internal->pkt.lc_index = lc_index;
+  if (PREDICT_FALSE(am->use_dtree_acl_matching) && !pkt_5tuple_internal->pkt.is_nonfirst_fragment) {
+    /* no tree while it is being rebuilt, the hash covers for it */
+    acl_dtree_lc_t *dt = acl_dtree_get_lc(am, lc_index);
+    if (PREDICT_TRUE(dt != 0))
+      return dtree_multi_acl_match_5tuple(p_acl_main, dt, lc_index, pkt_5tuple_internal, is_ip6, r_action,
+                                 r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
+  }
   if (PREDICT_TRUE(am->use_hash_acl_matching)) {
     if (PREDICT_FALSE(pkt_5tuple_internal->pkt.is_nonfirst_fragment)) {
       /*
@@ -694,9 +799,15 @@ acl_plugin_match_5tuple_inline_and_count (void *p_acl_main, u32 lc_index,
 {
   acl_main_t *am = p_acl_main;
   int ret = 0;
+  acl_dtree_lc_t *dt = 0;
   fa_5tuple_t * pkt_5tuple_internal = (fa_5tuple_t *)pkt_5tuple;
   pkt_5tuple_internal->pkt.lc_index = lc_index;
-  if (PREDICT_TRUE(am->use_hash_acl_matching)) {
+  if (PREDICT_FALSE(am->use_dtree_acl_matching) && !pkt_5tuple_internal->pkt.is_nonfirst_fragment)
+    dt = acl_dtree_get_lc(am, lc_index);
+  if (PREDICT_FALSE(dt != 0)) {
+    ret = dtree_multi_acl_match_5tuple(p_acl_main, dt, lc_index, pkt_5tuple_internal, is_ip6, r_action,
+                                 r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
+  } else if (PREDICT_TRUE(am->use_hash_acl_matching)) {
     if (PREDICT_FALSE(pkt_5tuple_internal->pkt.is_nonfirst_fragment)) {
       /*
        * tuplemerge does not take fragments into account,
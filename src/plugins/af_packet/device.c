@@ -746,25 +746,17 @@ af_packet_interface_rx_mode_change (vnet_main_t *vnm, u32 hw_if_index, u32 qid,
 
   apif = vec_elt_at_index (apm->interfaces, hw->dev_instance);
 
-  if (mode == VNET_HW_IF_RX_MODE_ADAPTIVE)
-    {
-      vlib_log_err (apm->log_class,
-		    "af_packet_%s adaptive mode is not supported",
-		    apif->host_if_name);
-      return clib_error_return (
-	0, "af_packet_%s adaptive mode is not supported", apif->host_if_name);
-    }
-
   af_packet_queue_t *rx_queue = vec_elt_at_index (apif->rx_queues, qid);
 
   if (rx_queue->mode != mode)
     {
-      rx_queue->mode = mode;
-
       if (mode == VNET_HW_IF_RX_MODE_POLLING)
 	apm->polling_count++;
-      else if (mode == VNET_HW_IF_RX_MODE_INTERRUPT && apm->polling_count > 0)
+      else if (rx_queue->mode == VNET_HW_IF_RX_MODE_POLLING &&
+	       apm->polling_count > 0)
 	apm->polling_count--;
+
+      rx_queue->mode = mode;
     }
 
   return 0;
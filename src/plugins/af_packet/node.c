@@ -537,7 +537,8 @@ af_packet_v3_device_input_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
 
 done:
 
-  if (apm->polling_count == 0)
+  /* adaptive mode state is driven by the main loop */
+  if (apm->polling_count == 0 && !(node->flags & VLIB_NODE_FLAG_ADAPTIVE_MODE))
     {
       if ((((block_desc_t *) (block_start = rx_queue->rx_ring[block]))
 	     ->hdr.bh1.block_status &
@@ -24,6 +24,42 @@
 
 #define AF_XDP_NUM_RX_QUEUES_ALL        ((u16)-1)
 
+/* max number of descriptors per packet, see MAX_SKB_FRAGS in Linux */
+#define AF_XDP_MAX_SEGS 17
+
+/* multi-buffer and tx metadata uapi, Linux 6.6 and 6.8 respectively */
+#ifndef XDP_USE_SG
+#define XDP_USE_SG (1 << 4)
+#endif
+#ifndef XDP_PKT_CONTD
+#define XDP_PKT_CONTD (1 << 0)
+#endif
+#ifndef XDP_TX_METADATA
+#define XDP_TX_METADATA (1 << 1)
+#endif
+#ifndef XDP_UMEM_TX_METADATA_LEN
+#define XDP_UMEM_TX_METADATA_LEN (1 << 2)
+#endif
+
+#define AF_XDP_TXMD_FLAGS_CHECKSUM (1 << 1)
+
+/* mirrors struct xsk_tx_metadata, placed right before the packet data */
+typedef struct
+{
+  u64 flags;
+  union
+  {
+    struct
+    {
+      u16 csum_start;
+      u16 csum_offset;
+    };
+    u64 tx_timestamp;
+  };
+} af_xdp_tx_metadata_t;
+
+STATIC_ASSERT_SIZEOF (af_xdp_tx_metadata_t, 16);
+
 #define af_xdp_log(lvl, dev, f, ...) \
   vlib_log(lvl, af_xdp_main.log_class, "%v: " f, (dev)->name, ##__VA_ARGS__)
 
@@ -33,7 +69,9 @@
   _ (2, ADMIN_UP, "admin-up")                                                 \
   _ (3, LINK_UP, "link-up")                                                   \
   _ (4, ZEROCOPY, "zero-copy")                                                \
-  _ (5, SYSCALL_LOCK, "syscall-lock")
+  _ (5, SYSCALL_LOCK, "syscall-lock")                                        \
+  _ (6, MULTI_BUFFER, "multi-buffer")                                         \
+  _ (7, TX_METADATA, "tx-metadata")
 
 enum
 {
@@ -192,6 +230,7 @@ typedef struct
 
 #define foreach_af_xdp_tx_func_error                                          \
   _ (NO_FREE_SLOTS, "no free tx slots")                                       \
+  _ (CHAIN_TOO_LONG, "buffer chain too long")                                 \
   _ (SYSCALL_REQUIRED, "syscall required")                                    \
   _ (SYSCALL_FAILURES, "syscall failures")
 
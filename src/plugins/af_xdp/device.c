@@ -78,7 +78,16 @@ af_xdp_set_max_frame_size (vnet_main_t *vnm, vnet_hw_interface_t *hw,
 {
   af_xdp_main_t *am = &af_xdp_main;
   af_xdp_device_t *ad = vec_elt_at_index (am->devices, hw->dev_instance);
-  af_xdp_log (VLIB_LOG_LEVEL_ERR, ad, "set mtu not supported yet");
+  vlib_main_t *vm = vlib_get_main ();
+
+  /* the Linux netdev mtu is managed from Linux, we only need to make sure
+   * we can receive and send frames of that size */
+  if ((ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER) ||
+      frame_size <= vlib_buffer_get_default_data_size (vm))
+    return 0;
+
+  af_xdp_log (VLIB_LOG_LEVEL_ERR, ad,
+	      "frame size %u requires multi-buffer support", frame_size);
   return vnet_error (VNET_ERR_UNSUPPORTED, 0);
 }
 
@@ -270,6 +279,24 @@ err0:
   return -1;
 }
 
+static void
+af_xdp_umem_config_tx_metadata (struct xsk_umem_config *umem_config,
+				int enable)
+{
+#ifdef HAVE_XSK_TX_METADATA
+  if (enable)
+    {
+      umem_config->flags |= XDP_UMEM_TX_METADATA_LEN;
+      umem_config->tx_metadata_len = sizeof (af_xdp_tx_metadata_t);
+    }
+  else
+    {
+      umem_config->flags &= ~XDP_UMEM_TX_METADATA_LEN;
+      umem_config->tx_metadata_len = 0;
+    }
+#endif
+}
+
 static int
 af_xdp_create_queue (vlib_main_t *vm, af_xdp_create_if_args_t *args,
 		     af_xdp_device_t *ad, int qid)
@@ -307,11 +334,22 @@ af_xdp_create_queue (vlib_main_t *vm, af_xdp_create_if_args_t *args,
     sizeof (vlib_buffer_t) + vlib_buffer_get_default_data_size (vm);
   umem_config.frame_headroom = sizeof (vlib_buffer_t);
   umem_config.flags = XDP_UMEM_UNALIGNED_CHUNK_FLAG;
+  af_xdp_umem_config_tx_metadata (&umem_config,
+				  ad->flags & AF_XDP_DEVICE_F_TX_METADATA);
+retry_umem:
   if (xsk_umem__create
       (umem, uword_to_pointer (vm->buffer_main->buffer_mem_start, void *),
        vm->buffer_main->buffer_mem_size, fq, cq, &umem_config))
     {
       uword sys_page_size = clib_mem_get_page_size ();
+      if (qid == 0 && (ad->flags & AF_XDP_DEVICE_F_TX_METADATA))
+	{
+	  /* kernel does not support tx metadata, go without */
+	  af_xdp_log (VLIB_LOG_LEVEL_DEBUG, ad, "tx metadata not supported");
+	  ad->flags &= ~AF_XDP_DEVICE_F_TX_METADATA;
+	  af_xdp_umem_config_tx_metadata (&umem_config, 0);
+	  goto retry_umem;
+	}
       args->rv = VNET_API_ERROR_SYSCALL_ERROR_1;
       args->error = clib_error_return_unix (0, "xsk_umem__create() failed");
       /* this should mimic the Linux kernel net/xdp/xdp_umem.c:xdp_umem_reg()
@@ -341,11 +379,23 @@ af_xdp_create_queue (vlib_main_t *vm, af_xdp_create_if_args_t *args,
       sock_config.bind_flags |= XDP_ZEROCOPY;
       break;
     }
+  if (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER)
+    sock_config.bind_flags |= XDP_USE_SG;
   if (args->prog)
     sock_config.libbpf_flags = XSK_LIBBPF_FLAGS__INHIBIT_PROG_LOAD;
+retry_socket:
   if (xsk_socket__create
       (xsk, ad->linux_ifname, qid, *umem, rx, tx, &sock_config))
     {
+      /* all queues must agree on multi-buffer, so only fallback on the
+       * first one */
+      if (qid == 0 && (sock_config.bind_flags & XDP_USE_SG))
+	{
+	  af_xdp_log (VLIB_LOG_LEVEL_DEBUG, ad, "multi-buffer not supported");
+	  ad->flags &= ~AF_XDP_DEVICE_F_MULTI_BUFFER;
+	  sock_config.bind_flags &= ~XDP_USE_SG;
+	  goto retry_socket;
+	}
       args->rv = VNET_API_ERROR_SYSCALL_ERROR_2;
       args->error =
 	clib_error_return_unix (0,
@@ -581,6 +631,7 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
   af_xdp_main_t *am = &af_xdp_main;
   af_xdp_device_t *ad;
   vnet_sw_interface_t *sw;
+  vnet_hw_if_caps_t caps;
   int rxq_num, txq_num, q_num;
   int ns_fds[2];
   int i, ret;
@@ -634,6 +685,13 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
       0 == (args->flags & AF_XDP_CREATE_FLAGS_NO_SYSCALL_LOCK))
     ad->flags |= AF_XDP_DEVICE_F_SYSCALL_LOCK;
 
+  /* optimistically request multi-buffer and tx metadata, queue creation
+   * falls back if the kernel does not support them */
+  ad->flags |= AF_XDP_DEVICE_F_MULTI_BUFFER;
+#ifdef HAVE_XSK_TX_METADATA
+  ad->flags |= AF_XDP_DEVICE_F_TX_METADATA;
+#endif
+
   ad->linux_ifname = (char *) format (0, "%s", args->linux_ifname);
   vec_validate (ad->linux_ifname, IFNAMSIZ - 1);	/* libbpf expects ifname to be at least IFNAMSIZ */
 
@@ -741,7 +799,15 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
   sw = vnet_get_hw_sw_interface (vnm, ad->hw_if_index);
   args->sw_if_index = ad->sw_if_index = sw->sw_if_index;
 
-  vnet_hw_if_set_caps (vnm, ad->hw_if_index, VNET_HW_IF_CAP_INT_MODE);
+  /* checksum requests are handled by the kernel in copy mode, but depend on
+   * the Linux driver in zero-copy mode */
+  if (ad->flags & AF_XDP_DEVICE_F_ZEROCOPY)
+    ad->flags &= ~AF_XDP_DEVICE_F_TX_METADATA;
+
+  caps = VNET_HW_IF_CAP_INT_MODE;
+  if (ad->flags & AF_XDP_DEVICE_F_TX_METADATA)
+    caps |= VNET_HW_IF_CAP_TX_CKSUM;
+  vnet_hw_if_set_caps (vnm, ad->hw_if_index, caps);
 
   vnet_hw_if_set_input_node (vnm, ad->hw_if_index, af_xdp_input_node.index);
 
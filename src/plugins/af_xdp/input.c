@@ -199,18 +199,76 @@ af_xdp_device_input_ethernet (vlib_main_t * vm, vlib_node_runtime_t * node,
   vlib_frame_no_append (f);
 }
 
+#define addr2bi(addr) ((addr) >> CLIB_LOG2_CACHE_LINE_BYTES)
+
+/* multi-buffer packets: chain descriptors into vlib buffer chains */
+static_always_inline u32
+af_xdp_device_input_bufs_mb (vlib_main_t *vm, af_xdp_rxq_t *rxq, u32 *bis,
+			     u32 *n_rx, vlib_buffer_t *bt, u32 idx)
+{
+  vlib_buffer_t *hb = 0, *pb = 0;
+  const u32 mask = rxq->rx.mask;
+  const u32 n_desc = *n_rx;
+  u32 n_pkts = 0, n_done = 0, n_pkts_done = 0, bytes = 0, bytes_done = 0;
+  u32 i;
+
+  for (i = 0; i < n_desc; i++)
+    {
+      const struct xdp_desc *desc = xsk_ring_cons__rx_desc (&rxq->rx, idx);
+      const u64 addr = desc->addr;
+      const u32 bi = addr2bi (xsk_umem__extract_addr (addr));
+      vlib_buffer_t *b = vlib_get_buffer (vm, bi);
+
+      ASSERT (vlib_buffer_is_known (vm, bi) == VLIB_BUFFER_KNOWN_ALLOCATED);
+      vlib_buffer_copy_template (b, bt);
+      b->current_data =
+	xsk_umem__extract_offset (addr) - sizeof (vlib_buffer_t);
+      b->current_length = desc->len;
+      bytes += desc->len;
+
+      if (hb)
+	{
+	  if (pb == hb)
+	    hb->total_length_not_including_first_buffer = 0;
+	  hb->total_length_not_including_first_buffer += desc->len;
+	  pb->next_buffer = bi;
+	  pb->flags |= VLIB_BUFFER_NEXT_PRESENT;
+	}
+      else
+	{
+	  hb = b;
+	  bis[n_pkts++] = bi;
+	}
+      pb = b;
+
+      if (!(desc->options & XDP_PKT_CONTD))
+	{
+	  hb = 0;
+	  n_done = i + 1;
+	  n_pkts_done = n_pkts;
+	  bytes_done = bytes;
+	}
+      idx = (idx + 1) & mask;
+    }
+
+  /* the end of the last packet was not peeked yet, leave it in the ring */
+  xsk_ring_cons__release (&rxq->rx, n_done);
+  xsk_ring_cons__cancel (&rxq->rx, n_desc - n_done);
+  *n_rx = n_pkts_done;
+  return bytes_done;
+}
+
 static_always_inline u32
 af_xdp_device_input_bufs (vlib_main_t *vm, const af_xdp_device_t *ad,
-			  af_xdp_rxq_t *rxq, u32 *bis, const u32 n_rx,
+			  af_xdp_rxq_t *rxq, u32 *bis, u32 *n_rx_ptr,
 			  vlib_buffer_t *bt, u32 idx)
 {
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
   u16 offs[VLIB_FRAME_SIZE], *off = offs;
   u16 lens[VLIB_FRAME_SIZE], *len = lens;
   const u32 mask = rxq->rx.mask;
-  u32 n = n_rx, *bi = bis, bytes = 0;
-
-#define addr2bi(addr) ((addr) >> CLIB_LOG2_CACHE_LINE_BYTES)
+  const u32 n_rx = *n_rx_ptr, idx0 = idx;
+  u32 n = n_rx, *bi = bis, bytes = 0, options = 0;
 
   while (n >= 1)
     {
@@ -221,6 +279,7 @@ af_xdp_device_input_bufs (vlib_main_t *vm, const af_xdp_device_t *ad,
 	      VLIB_BUFFER_KNOWN_ALLOCATED);
       off[0] = xsk_umem__extract_offset (addr) - sizeof (vlib_buffer_t);
       len[0] = desc->len;
+      options |= desc->options;
       idx = (idx + 1) & mask;
       bi += 1;
       off += 1;
@@ -228,6 +287,9 @@ af_xdp_device_input_bufs (vlib_main_t *vm, const af_xdp_device_t *ad,
       n -= 1;
     }
 
+  if (PREDICT_FALSE (options & XDP_PKT_CONTD))
+    return af_xdp_device_input_bufs_mb (vm, rxq, bis, n_rx_ptr, bt, idx0);
+
   vlib_get_buffers (vm, bis, bufs, n_rx);
 
   n = n_rx;
@@ -288,6 +350,7 @@ af_xdp_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   u32 n_rx_packets, n_rx_bytes;
   u32 idx;
 
+  /* number of descriptors, updated to number of packets below */
   n_rx_packets = xsk_ring_cons__peek (&rxq->rx, VLIB_FRAME_SIZE, &idx);
 
   if (PREDICT_FALSE (0 == n_rx_packets))
@@ -301,7 +364,7 @@ af_xdp_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   vlib_get_new_next_frame (vm, node, next_index, to_next, n_left_to_next);
 
   n_rx_bytes =
-    af_xdp_device_input_bufs (vm, ad, rxq, to_next, n_rx_packets, &bt, idx);
+    af_xdp_device_input_bufs (vm, ad, rxq, to_next, &n_rx_packets, &bt, idx);
   af_xdp_device_input_ethernet (vm, node, next_index, ad->sw_if_index,
 				ad->hw_if_index);
 
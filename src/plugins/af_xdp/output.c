@@ -4,6 +4,12 @@
 #include <vlib/unix/unix.h>
 #include <vnet/ethernet/ethernet.h>
 #include <vnet/devices/devices.h>
+#include <vnet/ip/ip4_packet.h>
+#include <vnet/ip/ip6_packet.h>
+#include <vnet/ip/ip_psh_cksum.h>
+#include <vnet/tcp/tcp_packet.h>
+#include <vnet/udp/udp_packet.h>
+#include <vnet/interface_output.h>
 #include <af_xdp/af_xdp.h>
 
 #define AF_XDP_TX_RETRIES 5
@@ -235,6 +241,170 @@ wrap_around:
   return n_tx;
 }
 
+/* request l4 checksum through tx metadata, returns descriptor options */
+static_always_inline u32
+af_xdp_device_output_offload (vlib_main_t *vm, vlib_buffer_t *b)
+{
+  vnet_buffer_oflags_t oflags = vnet_buffer (b)->oflags;
+  const int is_ip4 = b->flags & VNET_BUFFER_F_IS_IP4;
+  const int is_ip6 = b->flags & VNET_BUFFER_F_IS_IP6;
+  af_xdp_tx_metadata_t *md;
+  ip4_header_t *ip4;
+  ip6_header_t *ip6;
+  tcp_header_t *th;
+  udp_header_t *uh;
+  u16 psh;
+
+  if (oflags & (VNET_BUFFER_OFFLOAD_F_OUTER_IP_CKSUM |
+		VNET_BUFFER_OFFLOAD_F_OUTER_UDP_CKSUM))
+    vnet_calc_outer_checksums_inline (vm, b);
+
+  /* metadata must fit in the headroom right before the packet */
+  if (PREDICT_FALSE (
+	!(oflags &
+	  (VNET_BUFFER_OFFLOAD_F_TCP_CKSUM | VNET_BUFFER_OFFLOAD_F_UDP_CKSUM)) ||
+	!(is_ip4 || is_ip6) ||
+	b->current_data < (i16) sizeof (*md) - VLIB_BUFFER_PRE_DATA_SIZE))
+    {
+      vnet_calc_checksums_inline (vm, b, is_ip4, is_ip6);
+      return 0;
+    }
+
+  /* the kernel expects the l4 checksum field to hold the pseudo-header
+   * checksum, and never computes the ip4 header checksum */
+  if (is_ip4)
+    {
+      ip4 = (ip4_header_t *) (b->data + vnet_buffer (b)->l3_hdr_offset);
+      if (oflags & VNET_BUFFER_OFFLOAD_F_IP_CKSUM)
+	ip4->checksum = ip4_header_checksum (ip4);
+      psh = ip4_pseudo_header_cksum (ip4);
+    }
+  else
+    {
+      ip6 = (ip6_header_t *) (b->data + vnet_buffer (b)->l3_hdr_offset);
+      psh = ip6_pseudo_header_cksum (ip6);
+    }
+
+  md = vlib_buffer_get_current (b) - sizeof (*md);
+  md->flags = AF_XDP_TXMD_FLAGS_CHECKSUM;
+  md->csum_start = vnet_buffer (b)->l4_hdr_offset - b->current_data;
+
+  if (oflags & VNET_BUFFER_OFFLOAD_F_TCP_CKSUM)
+    {
+      th = (tcp_header_t *) (b->data + vnet_buffer (b)->l4_hdr_offset);
+      th->checksum = psh;
+      md->csum_offset = STRUCT_OFFSET_OF (tcp_header_t, checksum);
+    }
+  else
+    {
+      uh = (udp_header_t *) (b->data + vnet_buffer (b)->l4_hdr_offset);
+      uh->checksum = psh;
+      md->csum_offset = STRUCT_OFFSET_OF (udp_header_t, checksum);
+    }
+
+  vnet_buffer_offload_flags_clear (b, VNET_BUFFER_OFFLOAD_F_IP_CKSUM |
+					VNET_BUFFER_OFFLOAD_F_TCP_CKSUM |
+					VNET_BUFFER_OFFLOAD_F_UDP_CKSUM);
+  return XDP_TX_METADATA;
+}
+
+static_always_inline u32
+af_xdp_device_output_n_segs (vlib_main_t *vm, vlib_buffer_t *b)
+{
+  u32 n_segs = 1;
+
+  while (b->flags & VLIB_BUFFER_NEXT_PRESENT)
+    {
+      /* shared segments cannot be unchained */
+      if (b->ref_count > 1)
+	return ~0;
+      b = vlib_get_buffer (vm, b->next_buffer);
+      n_segs++;
+    }
+
+  return b->ref_count > 1 && n_segs > 1 ? ~0 : n_segs;
+}
+
+/*
+ * Slow path for multi-buffer and offload capable devices: each buffer of a
+ * chain gets its own descriptor, all but the last one flagged with
+ * XDP_PKT_CONTD. Buffers are unchained once enqueued as the completion ring
+ * returns them one by one. Returns the number of packets consumed, the
+ * number of descriptors to submit is added to n_desc.
+ */
+static_always_inline u32
+af_xdp_device_output_tx_try_mb (vlib_main_t *vm,
+				const vlib_node_runtime_t *node,
+				af_xdp_device_t *ad, af_xdp_txq_t *txq,
+				u32 n_tx, u32 *bi, u32 *n_desc)
+{
+  const uword start = vm->buffer_main->buffer_mem_start;
+  const int multi_buffer = ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER;
+  const int tx_metadata = ad->flags & AF_XDP_DEVICE_F_TX_METADATA;
+  struct xdp_desc *desc;
+  vlib_buffer_t *b;
+  u32 n, n_segs, idx, options;
+  u64 offset, addr;
+
+  for (n = 0; n < n_tx; n++)
+    {
+      b = vlib_get_buffer (vm, bi[n]);
+      n_segs = 1;
+
+      if (PREDICT_FALSE (b->flags & VLIB_BUFFER_NEXT_PRESENT))
+	{
+	  n_segs = multi_buffer ? af_xdp_device_output_n_segs (vm, b) : ~0;
+	  if (n_segs > AF_XDP_MAX_SEGS)
+	    {
+	      /* too long, shared or no multi-buffer support: linearize */
+	      n_segs = vlib_buffer_chain_linearize (vm, b);
+	      if (multi_buffer && n_segs > 1 && n_segs <= AF_XDP_MAX_SEGS)
+		n_segs = af_xdp_device_output_n_segs (vm, b);
+	      if (n_segs == 0 ||
+		  n_segs > (multi_buffer ? AF_XDP_MAX_SEGS : 1))
+		{
+		  vlib_buffer_free_one (vm, bi[n]);
+		  vlib_error_count (vm, node->node_index,
+				    AF_XDP_TX_ERROR_CHAIN_TOO_LONG, 1);
+		  continue;
+		}
+	    }
+	}
+
+      if (xsk_ring_prod__reserve (&txq->tx, n_segs, &idx) != n_segs)
+	break;
+
+      options = 0;
+      if (tx_metadata && (b->flags & VNET_BUFFER_F_OFFLOAD))
+	options = af_xdp_device_output_offload (vm, b);
+
+      while (1)
+	{
+	  desc = xsk_ring_prod__tx_desc (&txq->tx, idx++);
+	  offset = (sizeof (vlib_buffer_t) + b->current_data)
+		   << XSK_UNALIGNED_BUF_OFFSET_SHIFT;
+	  addr = pointer_to_uword (b) - start;
+	  desc->addr = offset | addr;
+	  desc->len = b->current_length;
+
+	  if (!(b->flags & VLIB_BUFFER_NEXT_PRESENT))
+	    {
+	      desc->options = options;
+	      break;
+	    }
+
+	  desc->options = options | XDP_PKT_CONTD;
+	  options = 0;
+	  b->flags &= ~VLIB_BUFFER_NEXT_PRESENT;
+	  b = vlib_get_buffer (vm, b->next_buffer);
+	}
+
+      *n_desc += n_segs;
+    }
+
+  return n;
+}
+
 VNET_DEVICE_CLASS_TX_FN (af_xdp_device_class) (vlib_main_t * vm,
 					       vlib_node_runtime_t * node,
 					       vlib_frame_t * frame)
@@ -246,7 +416,7 @@ VNET_DEVICE_CLASS_TX_FN (af_xdp_device_class) (vlib_main_t * vm,
   const int shared_queue = tf->shared_queue;
   af_xdp_txq_t *txq = vec_elt_at_index (ad->txqs, tf->queue_id);
   u32 *from;
-  u32 n, n_tx;
+  u32 n, n_tx, n_desc = 0;
   int i;
 
   from = vlib_frame_vector_args (frame);
@@ -259,12 +429,20 @@ VNET_DEVICE_CLASS_TX_FN (af_xdp_device_class) (vlib_main_t * vm,
     {
       u32 n_enq;
       af_xdp_device_output_free (vm, node, txq);
-      n_enq =
-	af_xdp_device_output_tx_try (vm, node, ad, txq, n_tx - n, from + n);
+      if (ad->flags &
+	  (AF_XDP_DEVICE_F_MULTI_BUFFER | AF_XDP_DEVICE_F_TX_METADATA))
+	n_enq = af_xdp_device_output_tx_try_mb (vm, node, ad, txq, n_tx - n,
+						from + n, &n_desc);
+      else
+	{
+	  n_enq = af_xdp_device_output_tx_try (vm, node, ad, txq, n_tx - n,
+					       from + n);
+	  n_desc += n_enq;
+	}
       n += n_enq;
     }
 
-  af_xdp_device_output_tx_db (vm, node, ad, txq, n);
+  af_xdp_device_output_tx_db (vm, node, ad, txq, n_desc);
 
   if (shared_queue)
     clib_spinlock_unlock (&txq->lock);
@@ -0,0 +1,216 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2024 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/plugin/plugin.h>
+#include <vnet/crypto/crypto.h>
+#include <crypto_native/crypto_native.h>
+#include <vppinfra/crypto/chacha20.h>
+#include <vppinfra/crypto/poly1305.h>
+
+#if __GNUC__ > 4 && !__clang__ && CLIB_DEBUG == 0
+#pragma GCC optimize("O3")
+#endif
+
+#define CHACHA20_POLY1305_KEY_LEN 32
+#define CHACHA20_POLY1305_TAG_LEN 16
+
+static_always_inline void
+chacha20_poly1305_pad16 (clib_poly1305_ctx *pctx)
+{
+  /* bytes past n_partial_bytes are always zero, so padding is just flush of
+   * the partial block */
+  if (pctx->n_partial_bytes)
+    {
+      _clib_poly1305_add_blocks (pctx, pctx->partial.as_u8, 16, 1);
+      pctx->n_partial_bytes = 0;
+    }
+}
+
+static_always_inline int
+chacha20_poly1305_one (vnet_crypto_op_t *op, vnet_crypto_op_chunk_t *chunks,
+		       const u8 *key, const u8 *poly_key, int is_enc,
+		       int maybe_chained)
+{
+  clib_chacha20_ctx_t cctx;
+  clib_poly1305_ctx pctx;
+  u64 lengths[2];
+  u8 tag[CHACHA20_POLY1305_TAG_LEN];
+  u32 len = 0;
+
+  clib_poly1305_init (&pctx, poly_key);
+  clib_poly1305_update (&pctx, op->aad, op->aad_len);
+  chacha20_poly1305_pad16 (&pctx);
+
+  /* keystream block 0 is used for poly1305 key, payload starts at 1 */
+  clib_chacha20_init (&cctx, key, op->iv, 1);
+
+  if (maybe_chained && op->flags & VNET_CRYPTO_OP_FLAG_CHAINED_BUFFERS)
+    {
+      vnet_crypto_op_chunk_t *chp = chunks + op->chunk_index;
+      for (int j = 0; j < op->n_chunks; j++, chp++)
+	{
+	  if (is_enc)
+	    {
+	      clib_chacha20_transform (&cctx, chp->src, chp->dst, chp->len);
+	      clib_poly1305_update (&pctx, chp->dst, chp->len);
+	    }
+	  else
+	    {
+	      clib_poly1305_update (&pctx, chp->src, chp->len);
+	      clib_chacha20_transform (&cctx, chp->src, chp->dst, chp->len);
+	    }
+	  len += chp->len;
+	}
+    }
+  else
+    {
+      if (is_enc)
+	{
+	  clib_chacha20_transform (&cctx, op->src, op->dst, op->len);
+	  clib_poly1305_update (&pctx, op->dst, op->len);
+	}
+      else
+	{
+	  clib_poly1305_update (&pctx, op->src, op->len);
+	  clib_chacha20_transform (&cctx, op->src, op->dst, op->len);
+	}
+      len = op->len;
+    }
+
+  chacha20_poly1305_pad16 (&pctx);
+  lengths[0] = clib_host_to_little_u64 (op->aad_len);
+  lengths[1] = clib_host_to_little_u64 (len);
+  _clib_poly1305_add_blocks (&pctx, (u8 *) lengths, sizeof (lengths), 1);
+  clib_poly1305_final (&pctx, tag);
+
+  if (is_enc)
+    {
+      clib_memcpy (op->tag, tag, clib_min (op->tag_len, sizeof (tag)));
+      return 1;
+    }
+
+  /* constant time compare, don't leak the position of the first mismatch */
+  u8 diff = 0;
+  for (u32 i = 0; i < clib_min (op->tag_len, sizeof (tag)); i++)
+    diff |= op->tag[i] ^ tag[i];
+
+  return diff == 0;
+}
+
+static_always_inline u32
+chacha20_poly1305_ops (vlib_main_t *vm, vnet_crypto_op_t *ops[], u32 n_ops,
+		       vnet_crypto_op_chunk_t *chunks, int is_enc,
+		       int maybe_chained)
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+  u8 poly_keys[N_CHACHA20_LANES][N_CHACHA20_BLOCK_BYTES];
+  const u8 *keys[N_CHACHA20_LANES], *nonces[N_CHACHA20_LANES];
+  u8 *out[N_CHACHA20_LANES];
+  u32 n_fail = 0;
+
+  for (int i = 0; i < N_CHACHA20_LANES; i++)
+    out[i] = poly_keys[i];
+
+  for (u32 n_left = n_ops; n_left; ops += N_CHACHA20_LANES)
+    {
+      u32 n = clib_min (n_left, N_CHACHA20_LANES);
+
+      /* derive one-time poly1305 keys for whole batch in parallel, one op
+       * per vector lane */
+      for (int i = 0; i < n; i++)
+	{
+	  keys[i] = cm->key_data[ops[i]->key_index];
+	  nonces[i] = ops[i]->iv;
+	}
+      clib_chacha20_block_multi (keys, nonces, 0, out, n);
+
+      for (int i = 0; i < n; i++)
+	{
+	  vnet_crypto_op_t *op = ops[i];
+
+	  if (chacha20_poly1305_one (op, chunks, keys[i], poly_keys[i], is_enc,
+				     maybe_chained))
+	    op->status = VNET_CRYPTO_OP_STATUS_COMPLETED;
+	  else
+	    {
+	      op->status = VNET_CRYPTO_OP_STATUS_FAIL_BAD_HMAC;
+	      n_fail++;
+	    }
+	}
+
+      n_left -= n;
+    }
+
+  return n_ops - n_fail;
+}
+
+static u32
+chacha20_poly1305_enc (vlib_main_t *vm, vnet_crypto_op_t *ops[], u32 n_ops)
+{
+  return chacha20_poly1305_ops (vm, ops, n_ops, 0, /* is_enc */ 1,
+				/* maybe_chained */ 0);
+}
+
+static u32
+chacha20_poly1305_dec (vlib_main_t *vm, vnet_crypto_op_t *ops[], u32 n_ops)
+{
+  return chacha20_poly1305_ops (vm, ops, n_ops, 0, /* is_enc */ 0,
+				/* maybe_chained */ 0);
+}
+
+static u32
+chacha20_poly1305_enc_chained (vlib_main_t *vm, vnet_crypto_op_t *ops[],
+			       vnet_crypto_op_chunk_t *chunks, u32 n_ops)
+{
+  return chacha20_poly1305_ops (vm, ops, n_ops, chunks, /* is_enc */ 1,
+				/* maybe_chained */ 1);
+}
+
+static u32
+chacha20_poly1305_dec_chained (vlib_main_t *vm, vnet_crypto_op_t *ops[],
+			       vnet_crypto_op_chunk_t *chunks, u32 n_ops)
+{
+  return chacha20_poly1305_ops (vm, ops, n_ops, chunks, /* is_enc */ 0,
+				/* maybe_chained */ 1);
+}
+
+static void *
+chacha20_poly1305_key_exp (vnet_crypto_key_t *key)
+{
+  u8 *kd;
+
+  kd = clib_mem_alloc_aligned (CHACHA20_POLY1305_KEY_LEN,
+			       CLIB_CACHE_LINE_BYTES);
+  clib_memcpy_fast (kd, key->data, CHACHA20_POLY1305_KEY_LEN);
+
+  return kd;
+}
+
+clib_error_t *
+#if defined(__VAES__) && defined(__AVX512F__)
+crypto_native_chacha20_poly1305_init_icl (vlib_main_t *vm)
+#elif defined(__VAES__)
+crypto_native_chacha20_poly1305_init_adl (vlib_main_t *vm)
+#elif __AVX512F__
+crypto_native_chacha20_poly1305_init_skx (vlib_main_t *vm)
+#elif __AVX2__
+crypto_native_chacha20_poly1305_init_hsw (vlib_main_t *vm)
+#elif __aarch64__
+crypto_native_chacha20_poly1305_init_neon (vlib_main_t *vm)
+#else
+crypto_native_chacha20_poly1305_init_slm (vlib_main_t *vm)
+#endif
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+
+  vnet_crypto_register_ops_handlers (
+    vm, cm->crypto_engine_index, VNET_CRYPTO_OP_CHACHA20_POLY1305_ENC,
+    chacha20_poly1305_enc, chacha20_poly1305_enc_chained);
+  vnet_crypto_register_ops_handlers (
+    vm, cm->crypto_engine_index, VNET_CRYPTO_OP_CHACHA20_POLY1305_DEC,
+    chacha20_poly1305_dec, chacha20_poly1305_dec_chained);
+  cm->key_fn[VNET_CRYPTO_ALG_CHACHA20_POLY1305] = chacha20_poly1305_key_exp;
+  return 0;
+}
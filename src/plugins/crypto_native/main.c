@@ -153,6 +153,53 @@ crypto_native_init (vlib_main_t * vm)
     return error;
 #endif
 
+  if (0)
+    ;
+#if __x86_64__
+  else if (crypto_native_chacha20_poly1305_init_icl &&
+	   clib_cpu_supports_vaes () && clib_cpu_supports_avx512f ())
+    error = crypto_native_chacha20_poly1305_init_icl (vm);
+  else if (crypto_native_chacha20_poly1305_init_adl &&
+	   clib_cpu_supports_vaes ())
+    error = crypto_native_chacha20_poly1305_init_adl (vm);
+  else if (crypto_native_chacha20_poly1305_init_skx &&
+	   clib_cpu_supports_avx512f ())
+    error = crypto_native_chacha20_poly1305_init_skx (vm);
+  else if (crypto_native_chacha20_poly1305_init_hsw &&
+	   clib_cpu_supports_avx2 ())
+    error = crypto_native_chacha20_poly1305_init_hsw (vm);
+  else if (crypto_native_chacha20_poly1305_init_slm)
+    error = crypto_native_chacha20_poly1305_init_slm (vm);
+#endif
+#if __aarch64__
+  else if (crypto_native_chacha20_poly1305_init_neon)
+    error = crypto_native_chacha20_poly1305_init_neon (vm);
+#endif
+  else
+    error = clib_error_return (
+      0, "No ChaCha20-Poly1305 implemenation available");
+
+  if (error)
+    return error;
+
+#if __x86_64__
+  if (0)
+    ;
+  else if (crypto_native_sha2_init_icl && clib_cpu_supports_sha () &&
+	   clib_cpu_supports_vaes () && clib_cpu_supports_avx512f ())
+    error = crypto_native_sha2_init_icl (vm);
+  else if (crypto_native_sha2_init_adl && clib_cpu_supports_sha () &&
+	   clib_cpu_supports_vaes ())
+    error = crypto_native_sha2_init_adl (vm);
+  else if (crypto_native_sha2_init_skx && clib_cpu_supports_avx512f ())
+    error = crypto_native_sha2_init_skx (vm);
+  else if (crypto_native_sha2_init_hsw && clib_cpu_supports_avx2 ())
+    error = crypto_native_sha2_init_hsw (vm);
+
+  if (error)
+    return error;
+#endif
+
   vnet_crypto_register_key_handler (vm, cm->crypto_engine_index,
 				    crypto_native_key_handler);
   return 0;
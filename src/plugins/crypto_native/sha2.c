@@ -0,0 +1,250 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2024 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/plugin/plugin.h>
+#include <vnet/crypto/crypto.h>
+#include <crypto_native/crypto_native.h>
+#include <vppinfra/crypto/sha2.h>
+
+#if __GNUC__ > 4 && !__clang__ && CLIB_DEBUG == 0
+#pragma GCC optimize("O3")
+#endif
+
+/* native sha2 is used only when CPU have SHA extensions or when many ops can
+ * be processed in parallel in wide vector registers */
+#if (defined(__SHA__) && defined(__x86_64__)) || defined(N_SHA256_LANES)
+
+static_always_inline u32
+crypto_native_ops_hash_sha2 (vlib_main_t *vm, vnet_crypto_op_t *ops[],
+			     u32 n_ops, vnet_crypto_op_chunk_t *chunks,
+			     clib_sha2_type_t type, int maybe_chained)
+{
+  clib_sha2_ctx_t ctx;
+
+  for (u32 i = 0; i < n_ops; i++)
+    {
+      vnet_crypto_op_t *op = ops[i];
+
+      clib_sha2_init (&ctx, type);
+      if (maybe_chained && op->flags & VNET_CRYPTO_OP_FLAG_CHAINED_BUFFERS)
+	{
+	  vnet_crypto_op_chunk_t *chp = chunks + op->chunk_index;
+	  for (int j = 0; j < op->n_chunks; j++, chp++)
+	    clib_sha2_update (&ctx, chp->src, chp->len);
+	}
+      else
+	clib_sha2_update (&ctx, op->src, op->len);
+
+      clib_sha2_final (&ctx, op->digest);
+      op->status = VNET_CRYPTO_OP_STATUS_COMPLETED;
+    }
+
+  return n_ops;
+}
+
+static_always_inline int
+crypto_native_sha2_hmac_done (vnet_crypto_op_t *op, const u8 *digest,
+			      u8 digest_size)
+{
+  u32 sz = op->digest_len ? op->digest_len : digest_size;
+
+  if (op->flags & VNET_CRYPTO_OP_FLAG_HMAC_CHECK)
+    {
+      /* constant time compare */
+      u8 diff = 0;
+      for (u32 i = 0; i < sz; i++)
+	diff |= op->digest[i] ^ digest[i];
+      if (diff)
+	{
+	  op->status = VNET_CRYPTO_OP_STATUS_FAIL_BAD_HMAC;
+	  return 0;
+	}
+    }
+  else
+    clib_memcpy_fast (op->digest, digest, sz);
+
+  op->status = VNET_CRYPTO_OP_STATUS_COMPLETED;
+  return 1;
+}
+
+static_always_inline int
+crypto_native_sha2_hmac_one (vnet_crypto_op_t *op,
+			     vnet_crypto_op_chunk_t *chunks,
+			     const clib_sha2_hmac_key_data_t *kd,
+			     int maybe_chained)
+{
+  u8 digest[SHA2_MAX_DIGEST_SIZE];
+  clib_sha2_hmac_ctx_t ctx;
+
+  clib_sha2_hmac_init (&ctx, kd);
+  if (maybe_chained && op->flags & VNET_CRYPTO_OP_FLAG_CHAINED_BUFFERS)
+    {
+      vnet_crypto_op_chunk_t *chp = chunks + op->chunk_index;
+      for (int j = 0; j < op->n_chunks; j++, chp++)
+	clib_sha2_hmac_update (&ctx, chp->src, chp->len);
+    }
+  else
+    clib_sha2_hmac_update (&ctx, op->src, op->len);
+
+  clib_sha2_hmac_final (&ctx, digest);
+
+  return crypto_native_sha2_hmac_done (op, digest, kd->digest_size);
+}
+
+#if !defined(__SHA__) && defined(N_SHA256_LANES)
+static_always_inline u32
+crypto_native_sha2_hmac_flush (const clib_sha2_hmac_key_data_t **kd,
+			       vnet_crypto_op_t **batch, const u8 **msg,
+			       u32 *len, u32 n_batch)
+{
+  u8 digests[N_SHA256_LANES][SHA256_DIGEST_SIZE];
+  u8 *dp[N_SHA256_LANES];
+  u32 n_fail = 0;
+
+  for (int i = 0; i < N_SHA256_LANES; i++)
+    dp[i] = digests[i];
+
+  clib_sha256_hmac_multi (kd, msg, len, dp, n_batch);
+  for (u32 j = 0; j < n_batch; j++)
+    n_fail += !crypto_native_sha2_hmac_done (batch[j], digests[j],
+					     kd[j]->digest_size);
+  return n_fail;
+}
+#endif
+
+static_always_inline u32
+crypto_native_ops_hmac_sha2 (vlib_main_t *vm, vnet_crypto_op_t *ops[],
+			     u32 n_ops, vnet_crypto_op_chunk_t *chunks,
+			     clib_sha2_type_t type, int maybe_chained)
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+  u32 n_fail = 0;
+
+#if !defined(__SHA__) && defined(N_SHA256_LANES)
+  const clib_sha2_hmac_key_data_t *kd[N_SHA256_LANES];
+  vnet_crypto_op_t *batch[N_SHA256_LANES];
+  const u8 *msg[N_SHA256_LANES];
+  u32 len[N_SHA256_LANES];
+  u32 n_batch = 0;
+
+  for (u32 i = 0; i < n_ops; i++)
+    {
+      vnet_crypto_op_t *op = ops[i];
+
+      if (maybe_chained && op->flags & VNET_CRYPTO_OP_FLAG_CHAINED_BUFFERS)
+	{
+	  n_fail += !crypto_native_sha2_hmac_one (
+	    op, chunks, cm->key_data[op->key_index], maybe_chained);
+	  continue;
+	}
+
+      /* collect ops and hash them in parallel, one op per vector lane */
+      batch[n_batch] = op;
+      kd[n_batch] = cm->key_data[op->key_index];
+      msg[n_batch] = op->src;
+      len[n_batch] = op->len;
+
+      if (++n_batch == N_SHA256_LANES)
+	{
+	  n_fail +=
+	    crypto_native_sha2_hmac_flush (kd, batch, msg, len, n_batch);
+	  n_batch = 0;
+	}
+    }
+
+  /* last op may have been a chained one, hash what is left */
+  if (n_batch)
+    n_fail += crypto_native_sha2_hmac_flush (kd, batch, msg, len, n_batch);
+#else
+  for (u32 i = 0; i < n_ops; i++)
+    {
+      vnet_crypto_op_t *op = ops[i];
+      n_fail += !crypto_native_sha2_hmac_one (
+	op, chunks, cm->key_data[op->key_index], maybe_chained);
+    }
+#endif
+
+  return n_ops - n_fail;
+}
+
+static void *
+sha2_key_add (vnet_crypto_key_t *k, clib_sha2_type_t type)
+{
+  clib_sha2_hmac_key_data_t *kd;
+
+  kd = clib_mem_alloc_aligned (sizeof (*kd), CLIB_CACHE_LINE_BYTES);
+  clib_sha2_hmac_key_data (kd, type, k->data, vec_len (k->data));
+
+  return kd;
+}
+
+#define foreach_crypto_native_sha2_handler_type _ (224) _ (256)
+
+#define _(b)                                                                  \
+  static u32 crypto_native_ops_hash_sha##b (                                  \
+    vlib_main_t *vm, vnet_crypto_op_t *ops[], u32 n_ops)                      \
+  {                                                                           \
+    return crypto_native_ops_hash_sha2 (vm, ops, n_ops, 0, CLIB_SHA2_##b, 0); \
+  }                                                                           \
+                                                                              \
+  static u32 crypto_native_ops_chained_hash_sha##b (                          \
+    vlib_main_t *vm, vnet_crypto_op_t *ops[], vnet_crypto_op_chunk_t *chunks, \
+    u32 n_ops)                                                                \
+  {                                                                           \
+    return crypto_native_ops_hash_sha2 (vm, ops, n_ops, chunks,               \
+					CLIB_SHA2_##b, 1);                    \
+  }                                                                           \
+                                                                              \
+  static u32 crypto_native_ops_hmac_sha##b (                                  \
+    vlib_main_t *vm, vnet_crypto_op_t *ops[], u32 n_ops)                      \
+  {                                                                           \
+    return crypto_native_ops_hmac_sha2 (vm, ops, n_ops, 0, CLIB_SHA2_##b, 0); \
+  }                                                                           \
+                                                                              \
+  static u32 crypto_native_ops_chained_hmac_sha##b (                          \
+    vlib_main_t *vm, vnet_crypto_op_t *ops[], vnet_crypto_op_chunk_t *chunks, \
+    u32 n_ops)                                                                \
+  {                                                                           \
+    return crypto_native_ops_hmac_sha2 (vm, ops, n_ops, chunks,               \
+					CLIB_SHA2_##b, 1);                    \
+  }                                                                           \
+                                                                              \
+  static void *sha2_##b##_key_add (vnet_crypto_key_t *k)                      \
+  {                                                                           \
+    return sha2_key_add (k, CLIB_SHA2_##b);                                   \
+  }
+
+foreach_crypto_native_sha2_handler_type;
+#undef _
+
+clib_error_t *
+#if defined(__VAES__) && defined(__AVX512F__)
+crypto_native_sha2_init_icl (vlib_main_t *vm)
+#elif defined(__VAES__)
+crypto_native_sha2_init_adl (vlib_main_t *vm)
+#elif __AVX512F__
+crypto_native_sha2_init_skx (vlib_main_t *vm)
+#elif __AVX2__
+crypto_native_sha2_init_hsw (vlib_main_t *vm)
+#else
+crypto_native_sha2_init_slm (vlib_main_t *vm)
+#endif
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+
+#define _(b)                                                                  \
+  vnet_crypto_register_ops_handlers (                                         \
+    vm, cm->crypto_engine_index, VNET_CRYPTO_OP_SHA##b##_HASH,                \
+    crypto_native_ops_hash_sha##b, crypto_native_ops_chained_hash_sha##b);    \
+  vnet_crypto_register_ops_handlers (                                         \
+    vm, cm->crypto_engine_index, VNET_CRYPTO_OP_SHA##b##_HMAC,                \
+    crypto_native_ops_hmac_sha##b, crypto_native_ops_chained_hmac_sha##b);    \
+  cm->key_fn[VNET_CRYPTO_ALG_HMAC_SHA##b] = sha2_##b##_key_add;
+  foreach_crypto_native_sha2_handler_type;
+#undef _
+  return 0;
+}
+
+#endif
@@ -44,6 +44,8 @@ uword flowprobe_walker_process (vlib_main_t * vm, vlib_node_runtime_t * rt,
 #define REPLY_MSG_ID_BASE fm->msg_id_base
 #include <vlibapi/api_helper_macros.h>
 
+#include <vppinfra/bihash_template.c>
+
 /* Define the per-interface configurable features */
 /* *INDENT-OFF* */
 VNET_FEATURE_INIT (flowprobe_input_ip4_unicast, static) = {
@@ -447,13 +449,27 @@ flowprobe_expired_timer_callback (u32 * expired_timers)
   vlib_main_t *vm = vlib_get_main ();
   flowprobe_main_t *fm = &flowprobe_main;
   u32 my_cpu_number = vm->thread_index;
+  flowprobe_entry_t *e;
   int i;
   u32 poolindex;
 
   for (i = 0; i < vec_len (expired_timers); i++)
     {
       poolindex = expired_timers[i] & 0x7FFFFFFF;
-      vec_add1 (fm->expired_passive_per_worker[my_cpu_number], poolindex);
+
+      /* The wheel has released the timer, mark it as not running */
+      if (!pool_is_free_index (fm->pool_per_worker[my_cpu_number],
+			       poolindex))
+	{
+	  e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number],
+				 poolindex);
+	  if ((expired_timers[i] >> 31) == FLOWPROBE_TIMER_ID_ACTIVE)
+	    e->active_timer_handle = ~0;
+	  else
+	    e->passive_timer_handle = ~0;
+	}
+      vec_add1 (fm->expired_timers_per_worker[my_cpu_number],
+		expired_timers[i]);
     }
 }
 
@@ -477,17 +493,27 @@ flowprobe_create_state_tables (u32 active_timer)
   if (active_timer)
     {
       vec_validate (fm->timers_per_worker, num_threads - 1);
-      vec_validate (fm->expired_passive_per_worker, num_threads - 1);
-      vec_validate (fm->hash_per_worker, num_threads - 1);
+      vec_validate (fm->expired_timers_per_worker, num_threads - 1);
+      vec_validate (fm->cache_per_worker, num_threads - 1);
       vec_validate (fm->pool_per_worker, num_threads - 1);
 
       for (i = 0; i < num_threads; i++)
 	{
-	  int j;
-	  pool_alloc (fm->pool_per_worker[i], 1 << fm->ht_log2len);
-	  vec_resize (fm->hash_per_worker[i], 1 << fm->ht_log2len);
-	  for (j = 0; j < (1 << fm->ht_log2len); j++)
-	    fm->hash_per_worker[i][j] = ~0;
+	  u32 max_entries = 1 << fm->ht_log2len;
+	  u32 nbuckets = clib_max (max_entries / BIHASH_KVP_PER_PAGE, 1);
+	  uword memory_size;
+
+	  /*
+	   * The data path stops adding flows at max_entries, so the arena
+	   * only has to hold that many kvps. Leave 4x for pages split by
+	   * rehashing and for the free lists.
+	   */
+	  memory_size = (uword) nbuckets * sizeof (clib_bihash_bucket_48_8_t) +
+			(uword) max_entries * sizeof (clib_bihash_kv_48_8_t) * 4;
+
+	  pool_alloc (fm->pool_per_worker[i], max_entries);
+	  clib_bihash_init_48_8 (&fm->cache_per_worker[i], "flowprobe cache",
+				 nbuckets, memory_size);
 	  fm->timers_per_worker[i] =
 	    clib_mem_alloc (sizeof (TWT (tw_timer_wheel)));
 	  tw_timer_wheel_init_2t_1w_2048sl (fm->timers_per_worker[i],
@@ -530,12 +556,6 @@ flowprobe_clear_state_if_index (u32 sw_if_index)
 		  e->packetcount = 0;
 		  e->octetcount = 0;
 		  e->prot.tcp.flags = 0;
-		  if (fm->passive_timer > 0)
-		    {
-		      tw_timer_stop_2t_1w_2048sl (
-			fm->timers_per_worker[worker_i],
-			e->passive_timer_handle);
-		    }
 		  flowprobe_delete_by_index (worker_i, entry_i);
 		}
 	    }
@@ -1144,6 +1164,10 @@ flowprobe_show_stats_fn (vlib_main_t * vm,
     vlib_cli_output (vm, "Pool utilisation thread %d is %d%%\n", i,
 		     (100 * pool_elts (fm->pool_per_worker[i])) /
 		     (0x1 << FLOWPROBE_LOG2_HASHSIZE));
+
+  for (i = 0; i < vec_len (fm->cache_per_worker); i++)
+    vlib_cli_output (vm, "%U", format_bihash_48_8, &fm->cache_per_worker[i],
+		     0 /* verbose */);
   return 0;
 }
 
@@ -1405,8 +1429,10 @@ timer_process (vlib_main_t * vm, vlib_node_runtime_t * rt, vlib_frame_t * f)
 	    {
 	      vlib_node_set_interrupt_pending (worker_vm,
 					       flowprobe_walker_node.index);
-	      sleep_duration =
-		(fm->expired_passive_per_worker[i] > 0) ? 1e-4 : 0.1;
+	      /* Come back soon if the walker ran out of time budget */
+	      if (vec_len (fm->expired_timers_per_worker) > i &&
+		  vec_len (fm->expired_timers_per_worker[i]))
+		sleep_duration = 1e-4;
 	    }
 	}
       vlib_process_suspend (vm, sleep_duration);
@@ -1458,11 +1484,12 @@ flowprobe_init (vlib_main_t * vm)
   for (i = 0; i < FLOW_N_VARIANTS; i++)
     {
       vec_validate (fm->context[i].buffers_per_worker, num_threads - 1);
-      vec_validate (fm->context[i].frames_per_worker, num_threads - 1);
       vec_validate (fm->context[i].next_record_offset_per_worker,
 		    num_threads - 1);
     }
 
+  vec_validate (fm->export_frame_per_worker, num_threads - 1);
+
   fm->active_timer = FLOWPROBE_TIMER_ACTIVE;
   fm->passive_timer = FLOWPROBE_TIMER_PASSIVE;
 
@@ -26,12 +26,18 @@
 #include <vnet/ipfix-export/flow_report.h>
 #include <vnet/ipfix-export/flow_report_classify.h>
 #include <vppinfra/tw_timer_2t_1w_2048sl.h>
+#include <vppinfra/bihash_48_8.h>
+#include <vppinfra/bihash_template.h>
 
 /* Default timers in seconds */
 #define FLOWPROBE_TIMER_ACTIVE   (15)
 #define FLOWPROBE_TIMER_PASSIVE  120	// XXXX: FOR TESTING (30*60)
 #define FLOWPROBE_LOG2_HASHSIZE  (18)
 
+/* Timer wheel timer ids of a flow entry */
+#define FLOWPROBE_TIMER_ID_PASSIVE 0
+#define FLOWPROBE_TIMER_ID_ACTIVE  1
+
 typedef enum
 {
   FLOW_RECORD_L2 = 1 << 0,
@@ -73,8 +79,6 @@ typedef struct
   flowprobe_record_t flags;
   /** ipfix buffers under construction, per-worker thread */
   vlib_buffer_t **buffers_per_worker;
-  /** frames containing ipfix buffers, per-worker thread */
-  vlib_frame_t **frames_per_worker;
   /** next record offset, per worker thread */
   u16 *next_record_offset_per_worker;
 } flowprobe_protocol_context_t;
@@ -96,6 +100,28 @@ typedef struct __attribute__ ((aligned (8))) {
 } flowprobe_key_t;
 /* *INDENT-ON* */
 
+/*
+ * Flow cache key, the fields of flowprobe_key_t that fit a bihash_48_8
+ * key. MAC addresses and ethertype go to the address padding of IPv4
+ * and L2 only flows, and are folded into l2_hash for IPv6 flows. The
+ * full key is compared with the entry's on lookup.
+ */
+typedef struct
+{
+  ip46_address_t src_address;
+  ip46_address_t dst_address;
+  u32 rx_sw_if_index;
+  u32 tx_sw_if_index;
+  u16 src_port;
+  u16 dst_port;
+  u8 protocol;
+  flowprobe_variant_t which;
+  flowprobe_direction_t direction;
+  u8 l2_hash;
+} flowprobe_cache_key_t;
+
+STATIC_ASSERT_SIZEOF (flowprobe_cache_key_t, 48);
+
 typedef struct
 {
   u32 sec;
@@ -112,6 +138,7 @@ typedef struct
   f64 last_updated;
   f64 last_exported;
   u32 passive_timer_handle;
+  u32 active_timer_handle;
   union
   {
     struct
@@ -140,12 +167,15 @@ typedef struct
 
   /** Per CPU flow-state */
   u8 ht_log2len;		/* Hash table size is 2^log2len */
-  u32 **hash_per_worker;
+  clib_bihash_48_8_t *cache_per_worker;
   flowprobe_entry_t **pool_per_worker;
   /* *INDENT-OFF* */
   TWT (tw_timer_wheel) ** timers_per_worker;
   /* *INDENT-ON* */
-  u32 **expired_passive_per_worker;
+  /** expired timer handles, the timer id is in the top bit */
+  u32 **expired_timers_per_worker;
+  /** frame of ipfix packets to ip4-lookup, per-worker thread */
+  vlib_frame_t **export_frame_per_worker;
 
   flowprobe_record_t record;
   u32 active_timer;
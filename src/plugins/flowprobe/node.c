@@ -16,8 +16,6 @@
  */
 #include <vlib/vlib.h>
 #include <vnet/vnet.h>
-#include <vppinfra/crc32.h>
-#include <vppinfra/xxhash.h>
 #include <vppinfra/error.h>
 #include <flowprobe/flowprobe.h>
 #include <vnet/ip/ip6_packet.h>
@@ -31,6 +29,9 @@ static void flowprobe_export_entry (vlib_main_t * vm, flowprobe_entry_t * e);
  * flow record generator graph node
  */
 
+/* Packets looked up in the flow cache at once */
+#define FLOWPROBE_BATCH_SIZE 64
+
 typedef struct
 {
   /** interface handle */
@@ -114,7 +115,8 @@ vlib_node_registration_t flowprobe_flush_l2_node;
 _(COLLISION, "Hash table collisions")		\
 _(BUFFER, "Buffer allocation error")		\
 _(EXPORTED_PACKETS, "Exported packets")		\
-_(INPATH, "Exported packets in path")
+_(INPATH, "Exported packets in path")		\
+_(CACHE_FULL, "Flow cache full, packet not tracked")
 
 typedef enum
 {
@@ -295,111 +297,97 @@ flowprobe_l4_add (vlib_buffer_t * to_b, flowprobe_entry_t * e, u16 offset)
   return offset - start;
 }
 
-static inline u32
-flowprobe_hash (flowprobe_key_t * k)
-{
-  flowprobe_main_t *fm = &flowprobe_main;
-  u32 h = 0;
-
-#ifdef clib_crc32c_uses_intrinsics
-  h = clib_crc32c ((u8 *) k, sizeof (*k));
-#else
-  int i;
-  u64 tmp = 0;
-  for (i = 0; i < sizeof (*k) / 8; i++)
-    tmp ^= ((u64 *) k)[i];
-
-  h = clib_xxhash (tmp);
-#endif
-
-  return h >> (32 - fm->ht_log2len);
-}
-
-flowprobe_entry_t *
-flowprobe_lookup (u32 my_cpu_number, flowprobe_key_t * k, u32 * poolindex,
-		  bool * collision)
+/*
+ * Flow cache key of a flow key, see flowprobe_cache_key_t. IPv6 addresses
+ * use the full address fields, so the L2 fields of IPv6 flows are folded
+ * into a single byte and lookups verify the full key.
+ */
+static_always_inline void
+flowprobe_make_cache_key (flowprobe_key_t *k, clib_bihash_kv_48_8_t *kv)
 {
-  flowprobe_main_t *fm = &flowprobe_main;
-  flowprobe_entry_t *e;
-  u32 h;
-
-  h = (fm->active_timer) ? flowprobe_hash (k) : 0;
-
-  /* Lookup in the flow state pool */
-  *poolindex = fm->hash_per_worker[my_cpu_number][h];
-  if (*poolindex != ~0)
+  flowprobe_cache_key_t *ck = (flowprobe_cache_key_t *) kv->key;
+
+  ck->src_address = k->src_address;
+  ck->dst_address = k->dst_address;
+  ck->rx_sw_if_index = k->rx_sw_if_index;
+  ck->tx_sw_if_index = k->tx_sw_if_index;
+  ck->src_port = k->src_port;
+  ck->dst_port = k->dst_port;
+  ck->protocol = k->protocol;
+  ck->which = k->which;
+  ck->direction = k->direction;
+  ck->l2_hash = 0;
+
+  if (k->which == FLOW_VARIANT_IP6 || k->which == FLOW_VARIANT_L2_IP6)
     {
-      e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number], *poolindex);
-      if (e)
-	{
-	  /* Verify key or report collision */
-	  if (memcmp (k, &e->key, sizeof (flowprobe_key_t)))
-	    *collision = true;
-	  return e;
-	}
+      u64 l2 = clib_mem_unaligned (k->src_mac, u64) ^
+	       clib_mem_unaligned (k->dst_mac + 2, u32) ^ k->ethertype;
+      l2 ^= l2 >> 32;
+      l2 ^= l2 >> 16;
+      l2 ^= l2 >> 8;
+      ck->l2_hash = l2;
+    }
+  else
+    {
+      clib_memcpy_fast (ck->src_address.as_u8, k->src_mac, 6);
+      clib_memcpy_fast (ck->src_address.as_u8 + 6, k->dst_mac, 6);
+      clib_memcpy_fast (ck->dst_address.as_u8, &k->ethertype, 2);
     }
-
-  return 0;
 }
 
-flowprobe_entry_t *
-flowprobe_create (u32 my_cpu_number, flowprobe_key_t * k, u32 * poolindex)
+static flowprobe_entry_t *
+flowprobe_create (u32 my_cpu_number, flowprobe_key_t *k,
+		  clib_bihash_kv_48_8_t *kv)
 {
   flowprobe_main_t *fm = &flowprobe_main;
-  u32 h;
-
   flowprobe_entry_t *e;
+  u32 poolindex;
 
-  /* Get my index */
-  h = (fm->active_timer) ? flowprobe_hash (k) : 0;
+  pool_get_zero (fm->pool_per_worker[my_cpu_number], e);
+  poolindex = e - fm->pool_per_worker[my_cpu_number];
 
-  pool_get (fm->pool_per_worker[my_cpu_number], e);
-  *poolindex = e - fm->pool_per_worker[my_cpu_number];
-  fm->hash_per_worker[my_cpu_number][h] = *poolindex;
+  kv->value = poolindex;
+  clib_bihash_add_del_48_8 (&fm->cache_per_worker[my_cpu_number], kv,
+			    1 /* is_add */);
 
   e->key = *k;
 
+  /* Active timeouts are driven by the wheel, not by the data path */
+  e->active_timer_handle = tw_timer_start_2t_1w_2048sl (
+    fm->timers_per_worker[my_cpu_number], poolindex,
+    FLOWPROBE_TIMER_ID_ACTIVE, fm->active_timer);
+
+  e->passive_timer_handle = ~0;
   if (fm->passive_timer > 0)
     {
-      e->passive_timer_handle = tw_timer_start_2t_1w_2048sl
-	(fm->timers_per_worker[my_cpu_number], *poolindex, 0,
-	 fm->passive_timer);
+      e->passive_timer_handle = tw_timer_start_2t_1w_2048sl (
+	fm->timers_per_worker[my_cpu_number], poolindex,
+	FLOWPROBE_TIMER_ID_PASSIVE, fm->passive_timer);
     }
   return e;
 }
 
-static inline void
-add_to_flow_record_state (vlib_main_t *vm, vlib_node_runtime_t *node,
-			  flowprobe_main_t *fm, vlib_buffer_t *b,
-			  timestamp_nsec_t timestamp, u16 length,
-			  flowprobe_variant_t which,
-			  flowprobe_direction_t direction,
-			  flowprobe_trace_t *t)
+static_always_inline void
+flowprobe_extract_key (flowprobe_main_t *fm, vlib_buffer_t *b,
+		       flowprobe_variant_t which,
+		       flowprobe_direction_t direction, flowprobe_key_t *k,
+		       u16 *octets, u8 *tcp_flags)
 {
-  if (fm->disabled)
-    return;
-
-  ASSERT (direction == FLOW_DIRECTION_RX || direction == FLOW_DIRECTION_TX);
-
-  u32 my_cpu_number = vm->thread_index;
-  u16 octets = 0;
-
   flowprobe_record_t flags = fm->context[which].flags;
   bool collect_ip4 = false, collect_ip6 = false;
-  ASSERT (b);
   ethernet_header_t *eth = (direction == FLOW_DIRECTION_TX) ?
 				   vlib_buffer_get_current (b) :
 				   ethernet_buffer_get_header (b);
   u16 ethertype = clib_net_to_host_u16 (eth->type);
   i16 l3_hdr_offset = (u8 *) eth - b->data + sizeof (ethernet_header_t);
-  /* *INDENT-OFF* */
-  flowprobe_key_t k = {};
-  /* *INDENT-ON* */
   ip4_header_t *ip4 = 0;
   ip6_header_t *ip6 = 0;
   udp_header_t *udp = 0;
   tcp_header_t *tcp = 0;
-  u8 tcp_flags = 0;
+
+  clib_memset (k, 0, sizeof (*k));
+  *octets = 0;
+  *tcp_flags = 0;
 
   if (flags & FLOW_RECORD_L3 || flags & FLOW_RECORD_L4)
     {
@@ -407,17 +395,17 @@ add_to_flow_record_state (vlib_main_t *vm, vlib_node_runtime_t *node,
       collect_ip6 = which == FLOW_VARIANT_L2_IP6 || which == FLOW_VARIANT_IP6;
     }
 
-  k.rx_sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_RX];
-  k.tx_sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_TX];
+  k->rx_sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_RX];
+  k->tx_sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_TX];
 
-  k.which = which;
-  k.direction = direction;
+  k->which = which;
+  k->direction = direction;
 
   if (flags & FLOW_RECORD_L2)
     {
-      clib_memcpy_fast (k.src_mac, eth->src_address, 6);
-      clib_memcpy_fast (k.dst_mac, eth->dst_address, 6);
-      k.ethertype = ethertype;
+      clib_memcpy_fast (k->src_mac, eth->src_address, 6);
+      clib_memcpy_fast (k->dst_mac, eth->dst_address, 6);
+      k->ethertype = ethertype;
     }
   if (ethertype == ETHERNET_TYPE_VLAN)
     {
@@ -430,25 +418,25 @@ add_to_flow_record_state (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  ethv++;
 	  l3_hdr_offset += sizeof (ethernet_vlan_header_tv_t);
 	}
-      k.ethertype = ethertype = clib_net_to_host_u16 ((ethv)->type);
+      k->ethertype = ethertype = clib_net_to_host_u16 ((ethv)->type);
     }
   if (collect_ip6 && ethertype == ETHERNET_TYPE_IP6)
     {
       ip6 = (ip6_header_t *) (b->data + l3_hdr_offset);
       if (flags & FLOW_RECORD_L3)
 	{
-	  k.src_address.as_u64[0] = ip6->src_address.as_u64[0];
-	  k.src_address.as_u64[1] = ip6->src_address.as_u64[1];
-	  k.dst_address.as_u64[0] = ip6->dst_address.as_u64[0];
-	  k.dst_address.as_u64[1] = ip6->dst_address.as_u64[1];
+	  k->src_address.as_u64[0] = ip6->src_address.as_u64[0];
+	  k->src_address.as_u64[1] = ip6->src_address.as_u64[1];
+	  k->dst_address.as_u64[0] = ip6->dst_address.as_u64[0];
+	  k->dst_address.as_u64[1] = ip6->dst_address.as_u64[1];
 	}
-      k.protocol = ip6->protocol;
-      if (k.protocol == IP_PROTOCOL_UDP)
+      k->protocol = ip6->protocol;
+      if (k->protocol == IP_PROTOCOL_UDP)
 	udp = (udp_header_t *) (ip6 + 1);
-      else if (k.protocol == IP_PROTOCOL_TCP)
+      else if (k->protocol == IP_PROTOCOL_TCP)
 	tcp = (tcp_header_t *) (ip6 + 1);
 
-      octets = clib_net_to_host_u16 (ip6->payload_length)
+      *octets = clib_net_to_host_u16 (ip6->payload_length)
 	+ sizeof (ip6_header_t);
     }
   if (collect_ip4 && ethertype == ETHERNET_TYPE_IP4)
@@ -456,88 +444,174 @@ add_to_flow_record_state (vlib_main_t *vm, vlib_node_runtime_t *node,
       ip4 = (ip4_header_t *) (b->data + l3_hdr_offset);
       if (flags & FLOW_RECORD_L3)
 	{
-	  k.src_address.ip4.as_u32 = ip4->src_address.as_u32;
-	  k.dst_address.ip4.as_u32 = ip4->dst_address.as_u32;
+	  k->src_address.ip4.as_u32 = ip4->src_address.as_u32;
+	  k->dst_address.ip4.as_u32 = ip4->dst_address.as_u32;
 	}
-      k.protocol = ip4->protocol;
-      if ((flags & FLOW_RECORD_L4) && k.protocol == IP_PROTOCOL_UDP)
+      k->protocol = ip4->protocol;
+      if ((flags & FLOW_RECORD_L4) && k->protocol == IP_PROTOCOL_UDP)
 	udp = (udp_header_t *) (ip4 + 1);
-      else if ((flags & FLOW_RECORD_L4) && k.protocol == IP_PROTOCOL_TCP)
+      else if ((flags & FLOW_RECORD_L4) && k->protocol == IP_PROTOCOL_TCP)
 	tcp = (tcp_header_t *) (ip4 + 1);
 
-      octets = clib_net_to_host_u16 (ip4->length);
+      *octets = clib_net_to_host_u16 (ip4->length);
     }
 
   if (udp)
     {
-      k.src_port = udp->src_port;
-      k.dst_port = udp->dst_port;
+      k->src_port = udp->src_port;
+      k->dst_port = udp->dst_port;
     }
   else if (tcp)
     {
-      k.src_port = tcp->src_port;
-      k.dst_port = tcp->dst_port;
-      tcp_flags = tcp->flags;
+      k->src_port = tcp->src_port;
+      k->dst_port = tcp->dst_port;
+      *tcp_flags = tcp->flags;
     }
+}
 
-  if (t)
+static_always_inline void
+flowprobe_trace_key (flowprobe_trace_t *t, flowprobe_key_t *k)
+{
+  t->rx_sw_if_index = k->rx_sw_if_index;
+  t->tx_sw_if_index = k->tx_sw_if_index;
+  clib_memcpy_fast (t->src_mac, k->src_mac, 6);
+  clib_memcpy_fast (t->dst_mac, k->dst_mac, 6);
+  t->ethertype = k->ethertype;
+  t->src_address.ip4.as_u32 = k->src_address.ip4.as_u32;
+  t->dst_address.ip4.as_u32 = k->dst_address.ip4.as_u32;
+  t->protocol = k->protocol;
+  t->src_port = k->src_port;
+  t->dst_port = k->dst_port;
+  t->which = k->which;
+}
+
+static_always_inline void
+flowprobe_update_entry (flowprobe_entry_t *e, timestamp_nsec_t timestamp,
+			f64 now, u16 octets, u8 tcp_flags)
+{
+  e->packetcount++;
+  e->octetcount += octets;
+  e->last_updated = now;
+  e->flow_end = timestamp;
+  e->prot.tcp.flags |= tcp_flags;
+}
+
+/*
+ * Account a batch of packets to their flows. Keys are extracted and
+ * hashed, and the cache buckets prefetched, for the whole batch before
+ * the first lookup.
+ */
+static_always_inline void
+flowprobe_process_batch (vlib_main_t *vm, vlib_node_runtime_t *node,
+			 flowprobe_main_t *fm, vlib_buffer_t **b, u32 n,
+			 timestamp_nsec_t timestamp, f64 now,
+			 flowprobe_variant_t which,
+			 flowprobe_direction_t direction)
+{
+  u32 my_cpu_number = vm->thread_index;
+  clib_bihash_48_8_t *h = &fm->cache_per_worker[my_cpu_number];
+  flowprobe_key_t keys[FLOWPROBE_BATCH_SIZE];
+  clib_bihash_kv_48_8_t kv[FLOWPROBE_BATCH_SIZE];
+  u64 hashes[FLOWPROBE_BATCH_SIZE];
+  u16 octets[FLOWPROBE_BATCH_SIZE];
+  u8 tcp_flags[FLOWPROBE_BATCH_SIZE];
+  u8 skip[FLOWPROBE_BATCH_SIZE];
+  bool stateless = fm->active_timer == 0;
+  flowprobe_entry_t *e;
+  u32 n_collisions = 0, n_cache_full = 0;
+  u32 max_entries = 1 << fm->ht_log2len;
+  u32 i;
+
+  for (i = 0; i < n; i++)
     {
-      t->rx_sw_if_index = k.rx_sw_if_index;
-      t->tx_sw_if_index = k.tx_sw_if_index;
-      clib_memcpy_fast (t->src_mac, k.src_mac, 6);
-      clib_memcpy_fast (t->dst_mac, k.dst_mac, 6);
-      t->ethertype = k.ethertype;
-      t->src_address.ip4.as_u32 = k.src_address.ip4.as_u32;
-      t->dst_address.ip4.as_u32 = k.dst_address.ip4.as_u32;
-      t->protocol = k.protocol;
-      t->src_port = k.src_port;
-      t->dst_port = k.dst_port;
-      t->which = k.which;
+      if (i + 4 < n)
+	{
+	  vlib_prefetch_buffer_header (b[i + 4], LOAD);
+	  clib_prefetch_load (b[i + 4]->data);
+	}
+
+      skip[i] = (b[i]->flags & VNET_BUFFER_F_FLOW_REPORT) != 0;
+      if (PREDICT_FALSE (skip[i]))
+	continue;
+
+      ethernet_header_t *eh = vlib_buffer_get_current (b[i]);
+      flowprobe_variant_t variant = flowprobe_get_variant (
+	which, fm->context[which].flags, clib_net_to_host_u16 (eh->type));
+
+      flowprobe_extract_key (fm, b[i], variant, direction, &keys[i],
+			     &octets[i], &tcp_flags[i]);
+      if (stateless)
+	continue;
+
+      flowprobe_make_cache_key (&keys[i], &kv[i]);
+      hashes[i] = clib_bihash_hash_48_8 (&kv[i]);
+      clib_bihash_prefetch_bucket_48_8 (h, hashes[i]);
     }
 
-  flowprobe_entry_t *e = 0;
-  f64 now = vlib_time_now (vm);
-  if (fm->active_timer > 0)
+  for (i = 0; i < n; i++)
     {
-      u32 poolindex = ~0;
-      bool collision = false;
+      if (PREDICT_FALSE (skip[i]))
+	continue;
 
-      e = flowprobe_lookup (my_cpu_number, &k, &poolindex, &collision);
-      if (collision)
+      if (stateless)
 	{
-	  /* Flush data and clean up entry for reuse. */
-	  if (e->packetcount)
-	    flowprobe_export_entry (vm, e);
-	  e->key = k;
-	  e->flow_start = timestamp;
-	  vlib_node_increment_counter (vm, node->node_index,
-				       FLOWPROBE_ERROR_COLLISION, 1);
+	  e = &fm->stateless_entry[my_cpu_number];
+	  e->key = keys[i];
 	}
-      if (!e)			/* Create new entry */
+      else
 	{
-	  e = flowprobe_create (my_cpu_number, &k, &poolindex);
-	  e->last_exported = now;
-	  e->flow_start = timestamp;
+	  if (i + 4 < n)
+	    clib_bihash_prefetch_data_48_8 (h, hashes[i + 4]);
+
+	  if (clib_bihash_search_inline_with_hash_48_8 (h, hashes[i],
+							&kv[i]) == 0)
+	    {
+	      e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number],
+				     kv[i].value);
+	      if (PREDICT_FALSE (memcmp (&keys[i], &e->key, sizeof (keys[i]))))
+		{
+		  /* Flush data and clean up entry for reuse. */
+		  if (e->packetcount)
+		    flowprobe_export_entry (vm, e);
+		  e->key = keys[i];
+		  e->flow_start = timestamp;
+		  n_collisions++;
+		}
+	    }
+	  else if (PREDICT_FALSE (
+		     pool_elts (fm->pool_per_worker[my_cpu_number]) >=
+		     max_entries))
+	    {
+	      /* Cache is sized for max_entries, don't grow past it */
+	      n_cache_full++;
+	      continue;
+	    }
+	  else
+	    {
+	      e = flowprobe_create (my_cpu_number, &keys[i], &kv[i]);
+	      e->last_exported = now;
+	      e->flow_start = timestamp;
+	    }
 	}
-    }
-  else
-    {
-      e = &fm->stateless_entry[my_cpu_number];
-      e->key = k;
-    }
 
-  if (e)
-    {
-      /* Updating entry */
-      e->packetcount++;
-      e->octetcount += octets;
-      e->last_updated = now;
-      e->flow_end = timestamp;
-      e->prot.tcp.flags |= tcp_flags;
-      if (fm->active_timer == 0
-	  || (now > e->last_exported + fm->active_timer))
+      flowprobe_update_entry (e, timestamp, now, octets[i], tcp_flags[i]);
+      if (stateless)
 	flowprobe_export_entry (vm, e);
+
+      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE) &&
+			 (b[i]->flags & VLIB_BUFFER_IS_TRACED)))
+	{
+	  flowprobe_trace_t *t = vlib_add_trace (vm, node, b[i], sizeof (*t));
+	  flowprobe_trace_key (t, &keys[i]);
+	}
     }
+
+  if (n_collisions)
+    vlib_node_increment_counter (vm, node->node_index,
+				 FLOWPROBE_ERROR_COLLISION, n_collisions);
+  if (n_cache_full)
+    vlib_node_increment_counter (vm, node->node_index,
+				 FLOWPROBE_ERROR_CACHE_FULL, n_cache_full);
 }
 
 static u16
@@ -633,31 +707,46 @@ flowprobe_export_send (vlib_main_t * vm, vlib_buffer_t * b0,
 
   ASSERT (ip4_header_checksum_is_valid (ip));
 
-  /* Find or allocate a frame */
-  f = fm->context[which].frames_per_worker[my_cpu_number];
+  /*
+   * Enqueue the buffer to the frame shared by all variants, which is
+   * handed to ip4-lookup once per dispatch by flowprobe_export_flush.
+   */
+  f = fm->export_frame_per_worker[my_cpu_number];
   if (PREDICT_FALSE (f == 0))
     {
-      u32 *to_next;
       f = vlib_get_frame_to_node (vm, ip4_lookup_node.index);
-      fm->context[which].frames_per_worker[my_cpu_number] = f;
-      u32 bi0 = vlib_get_buffer_index (vm, b0);
-
-      /* Enqueue the buffer */
-      to_next = vlib_frame_vector_args (f);
-      to_next[0] = bi0;
-      f->n_vectors = 1;
+      fm->export_frame_per_worker[my_cpu_number] = f;
     }
+  u32 *to_next = vlib_frame_vector_args (f);
+  to_next[f->n_vectors++] = vlib_get_buffer_index (vm, b0);
 
-  vlib_put_frame_to_node (vm, ip4_lookup_node.index, f);
+  if (f->n_vectors == VLIB_FRAME_SIZE)
+    {
+      vlib_put_frame_to_node (vm, ip4_lookup_node.index, f);
+      fm->export_frame_per_worker[my_cpu_number] = 0;
+    }
   vlib_node_increment_counter (vm, flowprobe_output_l2_node.index,
 			       FLOWPROBE_ERROR_EXPORTED_PACKETS, 1);
 
-  fm->context[which].frames_per_worker[my_cpu_number] = 0;
   fm->context[which].buffers_per_worker[my_cpu_number] = 0;
   fm->context[which].next_record_offset_per_worker[my_cpu_number] =
     flowprobe_get_headersize ();
 }
 
+/* Hand the ipfix packets built by this thread to ip4-lookup */
+static void
+flowprobe_export_flush (vlib_main_t *vm)
+{
+  flowprobe_main_t *fm = &flowprobe_main;
+  vlib_frame_t *f = fm->export_frame_per_worker[vm->thread_index];
+
+  if (f)
+    {
+      vlib_put_frame_to_node (vm, ip4_lookup_node.index, f);
+      fm->export_frame_per_worker[vm->thread_index] = 0;
+    }
+}
+
 static vlib_buffer_t *
 flowprobe_get_buffer (vlib_main_t * vm, flowprobe_variant_t which)
 {
@@ -759,133 +848,33 @@ flowprobe_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
 		   vlib_frame_t *frame, flowprobe_variant_t which,
 		   flowprobe_direction_t direction)
 {
-  u32 n_left_from, *from, *to_next;
-  flowprobe_next_t next_index;
   flowprobe_main_t *fm = &flowprobe_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE];
+  u16 nexts[VLIB_FRAME_SIZE];
+  u32 *from = vlib_frame_vector_args (frame);
+  u32 n_vectors = frame->n_vectors;
   timestamp_nsec_t timestamp;
+  f64 now = vlib_time_now (vm);
+  u32 i;
 
   unix_time_now_nsec_fraction (&timestamp.sec, &timestamp.nsec);
 
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
-
-  while (n_left_from > 0)
-    {
-      u32 n_left_to_next;
-
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
-
-      while (n_left_from >= 4 && n_left_to_next >= 2)
-	{
-	  u32 next0 = FLOWPROBE_NEXT_DROP;
-	  u32 next1 = FLOWPROBE_NEXT_DROP;
-	  u16 len0, len1;
-	  u32 bi0, bi1;
-	  vlib_buffer_t *b0, *b1;
+  vlib_get_buffers (vm, from, bufs, n_vectors);
 
-	  /* Prefetch next iteration. */
-	  {
-	    vlib_buffer_t *p2, *p3;
-
-	    p2 = vlib_get_buffer (vm, from[2]);
-	    p3 = vlib_get_buffer (vm, from[3]);
+  for (i = 0; i < n_vectors; i++)
+    vnet_feature_next_u16 (&nexts[i], bufs[i]);
 
-	    vlib_prefetch_buffer_header (p2, LOAD);
-	    vlib_prefetch_buffer_header (p3, LOAD);
-
-	    clib_prefetch_store (p2->data);
-	    clib_prefetch_store (p3->data);
-	  }
-
-	  /* speculatively enqueue b0 and b1 to the current next frame */
-	  to_next[0] = bi0 = from[0];
-	  to_next[1] = bi1 = from[1];
-	  from += 2;
-	  to_next += 2;
-	  n_left_from -= 2;
-	  n_left_to_next -= 2;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-	  b1 = vlib_get_buffer (vm, bi1);
-
-	  vnet_feature_next (&next0, b0);
-	  vnet_feature_next (&next1, b1);
-
-	  len0 = vlib_buffer_length_in_chain (vm, b0);
-	  ethernet_header_t *eh0 = vlib_buffer_get_current (b0);
-	  u16 ethertype0 = clib_net_to_host_u16 (eh0->type);
-
-	  if (PREDICT_TRUE ((b0->flags & VNET_BUFFER_F_FLOW_REPORT) == 0))
-	    add_to_flow_record_state (
-	      vm, node, fm, b0, timestamp, len0,
-	      flowprobe_get_variant (which, fm->context[which].flags,
-				     ethertype0),
-	      direction, 0);
-
-	  len1 = vlib_buffer_length_in_chain (vm, b1);
-	  ethernet_header_t *eh1 = vlib_buffer_get_current (b1);
-	  u16 ethertype1 = clib_net_to_host_u16 (eh1->type);
-
-	  if (PREDICT_TRUE ((b1->flags & VNET_BUFFER_F_FLOW_REPORT) == 0))
-	    add_to_flow_record_state (
-	      vm, node, fm, b1, timestamp, len1,
-	      flowprobe_get_variant (which, fm->context[which].flags,
-				     ethertype1),
-	      direction, 0);
-
-	  /* verify speculative enqueues, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x2 (vm, node, next_index,
-					   to_next, n_left_to_next,
-					   bi0, bi1, next0, next1);
-	}
-
-      while (n_left_from > 0 && n_left_to_next > 0)
-	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  u32 next0 = FLOWPROBE_NEXT_DROP;
-	  u16 len0;
-
-	  /* speculatively enqueue b0 to the current next frame */
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-
-	  vnet_feature_next (&next0, b0);
-
-	  len0 = vlib_buffer_length_in_chain (vm, b0);
-	  ethernet_header_t *eh0 = vlib_buffer_get_current (b0);
-	  u16 ethertype0 = clib_net_to_host_u16 (eh0->type);
-
-	  if (PREDICT_TRUE ((b0->flags & VNET_BUFFER_F_FLOW_REPORT) == 0))
-	    {
-	      flowprobe_trace_t *t = 0;
-	      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
-				 && (b0->flags & VLIB_BUFFER_IS_TRACED)))
-		t = vlib_add_trace (vm, node, b0, sizeof (*t));
-
-	      add_to_flow_record_state (
-		vm, node, fm, b0, timestamp, len0,
-		flowprobe_get_variant (which, fm->context[which].flags,
-				       ethertype0),
-		direction, t);
-	    }
-
-	  /* verify speculative enqueue, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index,
-					   to_next, n_left_to_next,
-					   bi0, next0);
-	}
-
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+  if (!fm->disabled)
+    {
+      for (i = 0; i < n_vectors; i += FLOWPROBE_BATCH_SIZE)
+	flowprobe_process_batch (vm, node, fm, bufs + i,
+				 clib_min (FLOWPROBE_BATCH_SIZE, n_vectors - i),
+				 timestamp, now, which, direction);
+      flowprobe_export_flush (vm);
     }
-  return frame->n_vectors;
+
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, n_vectors);
+  return n_vectors;
 }
 
 static uword
@@ -943,6 +932,7 @@ flush_record (flowprobe_variant_t which)
   vlib_buffer_t *b = flowprobe_get_buffer (vm, which);
   if (b)
     flowprobe_export_send (vm, b, which);
+  flowprobe_export_flush (vm);
 }
 
 void
@@ -1009,15 +999,21 @@ flowprobe_delete_by_index (u32 my_cpu_number, u32 poolindex)
 {
   flowprobe_main_t *fm = &flowprobe_main;
   flowprobe_entry_t *e;
-  u32 h;
+  clib_bihash_kv_48_8_t kv;
 
   e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number], poolindex);
 
-  /* Get my index */
-  h = flowprobe_hash (&e->key);
+  /* Stop the timers which are still running */
+  if (e->passive_timer_handle != ~0)
+    tw_timer_stop_2t_1w_2048sl (fm->timers_per_worker[my_cpu_number],
+				e->passive_timer_handle);
+  if (e->active_timer_handle != ~0)
+    tw_timer_stop_2t_1w_2048sl (fm->timers_per_worker[my_cpu_number],
+				e->active_timer_handle);
 
-  /* Reset hash */
-  fm->hash_per_worker[my_cpu_number][h] = ~0;
+  flowprobe_make_cache_key (&e->key, &kv);
+  clib_bihash_add_del_48_8 (&fm->cache_per_worker[my_cpu_number], &kv,
+			    0 /* is_add */);
 
   pool_put_index (fm->pool_per_worker[my_cpu_number], poolindex);
 }
@@ -1045,33 +1041,53 @@ flowprobe_walker_process (vlib_main_t * vm,
   fm->disabled = false;
 
   u32 cpu_index = os_get_thread_index ();
-  u32 *to_be_removed = 0, *i;
+  u32 *i;
 
   /*
    * Tick the timer when required and process the vector of expired
    * timers
    */
   f64 start_time = vlib_time_now (vm);
-  u32 count = 0;
+  u32 count = 0, exported = 0;
 
   tw_timer_expire_timers_2t_1w_2048sl (fm->timers_per_worker[cpu_index],
 				       start_time);
 
-  vec_foreach (i, fm->expired_passive_per_worker[cpu_index])
+  vec_foreach (i, fm->expired_timers_per_worker[cpu_index])
   {
-    u32 exported = 0;
     f64 now = vlib_time_now (vm);
     if (now > start_time + 100e-6
 	|| exported > FLOW_MAXIMUM_EXPORT_ENTRIES - 1)
       break;
+    count++;
+
+    u32 poolindex = *i & 0x7FFFFFFF;
+    u32 timer_id = *i >> 31;
 
-    if (pool_is_free_index (fm->pool_per_worker[cpu_index], *i))
+    if (pool_is_free_index (fm->pool_per_worker[cpu_index], poolindex))
+      continue;
+    e = pool_elt_at_index (fm->pool_per_worker[cpu_index], poolindex);
+
+    if (timer_id == FLOWPROBE_TIMER_ID_ACTIVE)
       {
-	clib_warning ("Element is %d is freed already\n", *i);
+	/* Stale, the entry was reused and has a timer running */
+	if (e->active_timer_handle != ~0)
+	  continue;
+
+	/* If anything to report send it to the exporter */
+	if (e->packetcount)
+	  {
+	    exported++;
+	    flowprobe_export_entry (vm, e);
+	  }
+	e->active_timer_handle = tw_timer_start_2t_1w_2048sl (
+	  fm->timers_per_worker[cpu_index], poolindex,
+	  FLOWPROBE_TIMER_ID_ACTIVE, fm->active_timer);
 	continue;
       }
-    else
-      e = pool_elt_at_index (fm->pool_per_worker[cpu_index], *i);
+
+    if (e->passive_timer_handle != ~0)
+      continue;
 
     /* Check last update timestamp. If it is longer than passive time nuke
      * entry. Otherwise restart timer with what's left
@@ -1080,26 +1096,25 @@ flowprobe_walker_process (vlib_main_t * vm,
     if ((now - e->last_updated) < (u64) (fm->passive_timer * 0.9))
       {
 	u64 delta = fm->passive_timer - (now - e->last_updated);
-	e->passive_timer_handle = tw_timer_start_2t_1w_2048sl
-	  (fm->timers_per_worker[cpu_index], *i, 0, delta);
+	delta = clib_max (delta, 1);
+	e->passive_timer_handle = tw_timer_start_2t_1w_2048sl (
+	  fm->timers_per_worker[cpu_index], poolindex,
+	  FLOWPROBE_TIMER_ID_PASSIVE, delta);
       }
     else			/* Nuke entry */
       {
-	vec_add1 (to_be_removed, *i);
-      }
-    /* If anything to report send it to the exporter */
-    if (e->packetcount && now > e->last_exported + fm->active_timer)
-      {
-	exported++;
-	flowprobe_export_entry (vm, e);
+	if (e->packetcount)
+	  {
+	    exported++;
+	    flowprobe_export_entry (vm, e);
+	  }
+	flowprobe_delete_by_index (cpu_index, poolindex);
       }
-    count++;
   }
   if (count)
-    vec_delete (fm->expired_passive_per_worker[cpu_index], count, 0);
+    vec_delete (fm->expired_timers_per_worker[cpu_index], count, 0);
 
-  vec_foreach (i, to_be_removed) flowprobe_delete_by_index (cpu_index, *i);
-  vec_free (to_be_removed);
+  flowprobe_export_flush (vm);
 
   return 0;
 }
@@ -365,8 +365,9 @@ proxy_rx_callback (session_t * s)
     {
       vnet_connect_args_t _a, *a = &_a;
       svm_fifo_t *tx_fifo, *rx_fifo;
-      u32 max_dequeue, ps_index;
+      u32 max_dequeue, ps_index, n_segs = 2;
       int actual_transfer __attribute__ ((unused));
+      svm_fifo_seg_t segs[2];
 
       rx_fifo = s->rx_fifo;
       tx_fifo = s->tx_fifo;
@@ -382,9 +383,11 @@ proxy_rx_callback (session_t * s)
 	  return 0;
 	}
 
+      /* Map the first bytes instead of copying them out, the fifo is
+       * handed over to the active open session as is */
       max_dequeue = clib_min (pm->rcv_buffer_size, max_dequeue);
-      actual_transfer = svm_fifo_peek (rx_fifo, 0 /* relative_offset */ ,
-				       max_dequeue, pm->rx_buf[thread_index]);
+      actual_transfer = svm_fifo_segments (rx_fifo, 0 /* offset */, segs,
+					   &n_segs, max_dequeue);
 
       /* $$$ your message in this space: parse url, etc. */
 
@@ -797,17 +800,6 @@ proxy_server_add_ckpair (void)
 static int
 proxy_server_create (vlib_main_t * vm)
 {
-  vlib_thread_main_t *vtm = vlib_get_thread_main ();
-  proxy_main_t *pm = &proxy_main;
-  u32 num_threads;
-  int i;
-
-  num_threads = 1 /* main thread */  + vtm->n_threads;
-  vec_validate (pm->rx_buf, num_threads - 1);
-
-  for (i = 0; i < num_threads; i++)
-    vec_validate (pm->rx_buf[i], pm->rcv_buffer_size);
-
   proxy_server_add_ckpair ();
 
   if (proxy_server_attach ())
@@ -45,7 +45,6 @@ typedef struct
 {
   proxy_session_t *sessions;		/**< session pool, shared */
   clib_spinlock_t sessions_lock;	/**< lock for session pool */
-  u8 **rx_buf;				/**< intermediate rx buffers */
 
   u32 server_client_index;		/**< server API client handle */
   u32 server_app_index;			/**< server app index */
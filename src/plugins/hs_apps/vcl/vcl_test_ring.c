@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Exercises the vcl submission and completion rings. The server accepts
+ * and echoes through the rings, the client checks a full ring, the cap on
+ * ops in flight, send and recv completions and the ops of a closed
+ * session. Only the client's exit code tells the result.
+ *
+ *   vcl_test_ring -s <port>
+ *   vcl_test_ring <server-ip4> <port>
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <vcl/vppcom.h>
+
+#define VTR_N_SQES	 4
+#define VTR_MAX_UD	 512
+#define VTR_WAIT_MS	 100
+#define VTR_WAIT_TRIES	 100
+
+#define vtr_fail(_fmt, _args...)                                              \
+  do                                                                          \
+    {                                                                         \
+      fprintf (stderr, "\nERROR: %s:%d: " _fmt "\n", __func__, __LINE__,     \
+	       ##_args);                                                      \
+      exit (1);                                                               \
+    }                                                                         \
+  while (0)
+
+#define vtr_check(_cond, _fmt, _args...)                                      \
+  do                                                                          \
+    {                                                                         \
+      if (!(_cond))                                                           \
+	vtr_fail (_fmt, ##_args);                                             \
+    }                                                                         \
+  while (0)
+
+typedef struct
+{
+  int res[VTR_MAX_UD];
+  uint8_t done[VTR_MAX_UD];
+  /* completion order, to check ops complete in submission order */
+  uint64_t order[VTR_MAX_UD];
+  uint32_t n_order;
+} vtr_main_t;
+
+static vtr_main_t vtr_main;
+
+static vppcom_ring_sqe_t *
+vtr_post (uint8_t op, uint32_t sh, void *buf, uint32_t len, uint64_t ud)
+{
+  vppcom_ring_sqe_t *sqe = vppcom_ring_get_sqe ();
+
+  vtr_check (sqe != 0, "no sqe for op %u user data %lu", op, ud);
+  vtr_check (ud < VTR_MAX_UD, "user data %lu too large", ud);
+  sqe->op = op;
+  sqe->session_handle = sh;
+  sqe->buf = buf;
+  sqe->len = len;
+  sqe->user_data = ud;
+  vtr_main.done[ud] = 0;
+  return sqe;
+}
+
+static void
+vtr_submit (int n_expected)
+{
+  int rv = vppcom_ring_submit ();
+  vtr_check (rv == n_expected, "submitted %d expected %d", rv, n_expected);
+}
+
+static int
+vtr_reap (double wait_ms)
+{
+  vtr_main_t *vm = &vtr_main;
+  vppcom_ring_cqe_t cqes[16];
+  int i, n;
+
+  n = vppcom_ring_wait (cqes, 16, wait_ms);
+  vtr_check (n >= 0, "vppcom_ring_wait returned %d", n);
+  for (i = 0; i < n; i++)
+    {
+      uint64_t ud = cqes[i].user_data;
+      vtr_check (ud < VTR_MAX_UD, "bogus user data %lu", ud);
+      vtr_check (!vm->done[ud], "op %lu completed twice", ud);
+      vm->done[ud] = 1;
+      vm->res[ud] = cqes[i].res;
+      vm->order[vm->n_order++ % VTR_MAX_UD] = ud;
+    }
+  return n;
+}
+
+/* wait for the completion of op ud and return its result */
+static int
+vtr_wait (uint64_t ud)
+{
+  int i;
+
+  for (i = 0; i < VTR_WAIT_TRIES && !vtr_main.done[ud]; i++)
+    vtr_reap (VTR_WAIT_MS);
+  vtr_check (vtr_main.done[ud], "op %lu never completed", ud);
+  return vtr_main.res[ud];
+}
+
+static void
+vtr_endpt (vppcom_endpt_t *ep, struct in_addr *addr, char *ip, char *port)
+{
+  memset (ep, 0, sizeof (*ep));
+  vtr_check (inet_pton (AF_INET, ip, addr) == 1, "bad address %s", ip);
+  ep->is_ip4 = 1;
+  ep->ip = (uint8_t *) addr;
+  ep->port = htons ((uint16_t) atoi (port));
+}
+
+static int
+vtr_server (char *port)
+{
+  uint8_t buf[4096], peer_ip[16];
+  vppcom_endpt_t ep, peer = { .ip = peer_ip };
+  struct in_addr addr;
+  int ls, sh, rv;
+  uint64_t ud = 0;
+
+  rv = vppcom_ring_setup (VTR_N_SQES);
+  vtr_check (rv == 0, "vppcom_ring_setup returned %d", rv);
+
+  vtr_endpt (&ep, &addr, "0.0.0.0", port);
+  ls = vppcom_session_create (VPPCOM_PROTO_TCP, 0 /* is_nonblocking */);
+  vtr_check (ls >= 0, "vppcom_session_create returned %d", ls);
+  rv = vppcom_session_bind (ls, &ep);
+  vtr_check (rv == 0, "vppcom_session_bind returned %d", rv);
+  rv = vppcom_session_listen (ls, 10);
+  vtr_check (rv == 0, "vppcom_session_listen returned %d", rv);
+
+  while (1)
+    {
+      /* parked until a client connects */
+      vtr_post (VPPCOM_RING_OP_ACCEPT, ls, &peer, 0, ud);
+      vtr_submit (1);
+      sh = vtr_wait (ud++);
+      vtr_check (sh >= 0, "accept completed with %d", sh);
+
+      /* echo until the client goes away */
+      while (1)
+	{
+	  vtr_post (VPPCOM_RING_OP_RECV, sh, buf, sizeof (buf), ud);
+	  vtr_submit (1);
+	  rv = vtr_wait (ud++);
+	  if (rv <= 0)
+	    break;
+	  vtr_post (VPPCOM_RING_OP_SEND, sh, buf, rv, ud);
+	  vtr_submit (1);
+	  vtr_check (vtr_wait (ud++) == rv, "short echo");
+	}
+
+      vtr_post (VPPCOM_RING_OP_CLOSE, sh, 0, 0, ud);
+      vtr_submit (1);
+      vtr_wait (ud++);
+      ud %= VTR_MAX_UD - 8;
+    }
+
+  return 0;
+}
+
+static int
+vtr_client (char *ip, char *port)
+{
+  vtr_main_t *vm = &vtr_main;
+  char tx[] = "Hello, world! Jenny is a friend of mine.";
+  uint8_t rx[sizeof (tx)];
+  vppcom_endpt_t ep;
+  struct in_addr addr;
+  int sh, rv, i;
+
+  /* nothing works without a ring */
+  vtr_check (vppcom_ring_get_sqe () == 0, "sqe without a ring");
+  vtr_check (vppcom_ring_submit () == VPPCOM_EINVAL, "submit without a ring");
+
+  rv = vppcom_ring_setup (VTR_N_SQES - 1);
+  vtr_check (rv == 0, "vppcom_ring_setup returned %d", rv);
+  rv = vppcom_ring_setup (VTR_N_SQES);
+  vtr_check (rv == VPPCOM_EEXIST, "second vppcom_ring_setup returned %d", rv);
+
+  /* a full submission ring, rounded up to a power of 2 */
+  for (i = 0; i < VTR_N_SQES; i++)
+    vtr_post (VPPCOM_RING_OP_NOP, 0, 0, 0, i);
+  vtr_check (vppcom_ring_get_sqe () == 0, "sqe from a full ring");
+  vtr_submit (VTR_N_SQES);
+  vtr_check (vtr_reap (0) == VTR_N_SQES, "nops did not complete");
+  for (i = 0; i < VTR_N_SQES; i++)
+    vtr_check (vm->order[i] == i && vm->res[i] == 0, "nop %d out of order",
+	       i);
+
+  vtr_endpt (&ep, &addr, ip, port);
+  sh = vppcom_session_create (VPPCOM_PROTO_TCP, 0 /* is_nonblocking */);
+  vtr_check (sh >= 0, "vppcom_session_create returned %d", sh);
+  rv = vppcom_session_connect (sh, &ep);
+  vtr_check (rv == 0, "vppcom_session_connect returned %d", rv);
+
+  /* the recv is parked, the server only echoes */
+  vtr_post (VPPCOM_RING_OP_RECV, sh, rx, sizeof (rx), 100);
+  for (i = 1; i < VTR_N_SQES; i++)
+    vtr_post (VPPCOM_RING_OP_NOP, 0, 0, 0, 100 + i);
+  vtr_submit (VTR_N_SQES);
+  vtr_check (!vm->done[100], "recv completed with no data");
+
+  /* unreaped completions count against the completion ring too */
+  for (i = 0; i < VTR_N_SQES; i++)
+    vtr_post (VPPCOM_RING_OP_NOP, 0, 0, 0, 110 + i);
+  vtr_submit (VTR_N_SQES);
+  vtr_check (vppcom_ring_get_sqe () == 0, "sqe past the in flight cap");
+  vtr_check (vtr_reap (0) == 2 * VTR_N_SQES - 1, "nops did not complete");
+  vtr_check (!vm->done[100], "recv completed with no data");
+
+  /* the send's tx event goes out with the batch, the echo wakes the recv */
+  vtr_post (VPPCOM_RING_OP_SEND, sh, tx, sizeof (tx), 200);
+  vtr_submit (1);
+  rv = vtr_wait (200);
+  vtr_check (rv == sizeof (tx), "send completed with %d", rv);
+  rv = vtr_wait (100);
+  vtr_check (rv > 0 && rv <= sizeof (tx), "recv completed with %d", rv);
+  vtr_check (!memcmp (rx, tx, rv), "echo does not match");
+
+  /* closing a session cancels its parked ops, in order, before closing */
+  vtr_post (VPPCOM_RING_OP_RECV, sh, rx, sizeof (rx), 300);
+  vtr_post (VPPCOM_RING_OP_RECV, sh, rx, sizeof (rx), 301);
+  vtr_post (VPPCOM_RING_OP_CLOSE, sh, 0, 0, 302);
+  vtr_submit (3);
+  vtr_check (vtr_wait (300) == VPPCOM_ECANCELED, "recv completed with %d",
+	     vm->res[300]);
+  vtr_check (vtr_wait (301) == VPPCOM_ECANCELED, "recv completed with %d",
+	     vm->res[301]);
+  vtr_check (vtr_wait (302) == 0, "close completed with %d", vm->res[302]);
+  vtr_check (vm->order[vm->n_order - 3] == 300 &&
+	       vm->order[vm->n_order - 1] == 302,
+	     "close completed before the ops it cancelled");
+
+  /* and ops on the closed session fail right away */
+  vtr_post (VPPCOM_RING_OP_SEND, sh, tx, sizeof (tx), 400);
+  vtr_submit (1);
+  vtr_check (vtr_wait (400) < 0, "send on closed session completed with %d",
+	     vm->res[400]);
+
+  vppcom_ring_free ();
+  vtr_check (vppcom_ring_get_sqe () == 0, "sqe after free");
+
+  printf ("vcl_test_ring: all ring checks passed\n");
+  return 0;
+}
+
+int
+main (int argc, char **argv)
+{
+  int rv;
+
+  if (argc != 3)
+    {
+      fprintf (stderr, "usage: %s -s <port> | <server-ip4> <port>\n",
+	       argv[0]);
+      return 1;
+    }
+
+  rv = vppcom_app_create ("vcl_test_ring");
+  vtr_check (rv == 0, "vppcom_app_create returned %d", rv);
+
+  if (!strcmp (argv[1], "-s"))
+    rv = vtr_server (argv[2]);
+  else
+    rv = vtr_client (argv[1], argv[2]);
+
+  vppcom_app_destroy ();
+  return rv;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
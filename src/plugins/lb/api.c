@@ -58,11 +58,39 @@ vl_api_lb_conf_t_handler
 
   rv = lb_conf((ip4_address_t *)&mp->ip4_src_address,
 	       (ip6_address_t *)&mp->ip6_src_address,
-	       sticky_buckets_per_core, flow_timeout);
+	       sticky_buckets_per_core,
+	       clib_max (lbm->per_cpu_sticky_buckets_max,
+			 sticky_buckets_per_core),
+	       flow_timeout);
 
  REPLY_MACRO (VL_API_LB_CONF_REPLY);
 }
 
+static void
+vl_api_lb_conf_v2_t_handler (vl_api_lb_conf_v2_t *mp)
+{
+  lb_main_t *lbm = &lb_main;
+  vl_api_lb_conf_v2_reply_t *rmp;
+  u32 sticky_buckets_per_core, sticky_buckets_max_per_core, flow_timeout;
+  int rv = 0;
+
+  sticky_buckets_per_core = mp->sticky_buckets_per_core == ~0 ?
+			      lbm->per_cpu_sticky_buckets :
+			      ntohl (mp->sticky_buckets_per_core);
+  sticky_buckets_max_per_core =
+    mp->sticky_buckets_max_per_core == ~0 ?
+      clib_max (lbm->per_cpu_sticky_buckets_max, sticky_buckets_per_core) :
+      ntohl (mp->sticky_buckets_max_per_core);
+  flow_timeout =
+    mp->flow_timeout == ~0 ? lbm->flow_timeout : ntohl (mp->flow_timeout);
+
+  rv = lb_conf ((ip4_address_t *) &mp->ip4_src_address,
+		(ip6_address_t *) &mp->ip6_src_address, sticky_buckets_per_core,
+		sticky_buckets_max_per_core, flow_timeout);
+
+  REPLY_MACRO (VL_API_LB_CONF_V2_REPLY);
+}
+
 static void
 vl_api_lb_add_del_vip_t_handler
 (vl_api_lb_add_del_vip_t * mp)
@@ -201,6 +229,83 @@ vl_api_lb_add_del_vip_v2_t_handler (vl_api_lb_add_del_vip_v2_t *mp)
   REPLY_MACRO (VL_API_LB_ADD_DEL_VIP_V2_REPLY);
 }
 
+static void
+vl_api_lb_add_del_vip_v3_t_handler (vl_api_lb_add_del_vip_v3_t *mp)
+{
+  lb_main_t *lbm = &lb_main;
+  vl_api_lb_conf_reply_t *rmp;
+  int rv = 0;
+  lb_vip_add_args_t args = {};
+
+  /* if port == 0, it means all-port VIP */
+  if (mp->port == 0)
+    {
+      mp->protocol = ~0;
+    }
+
+  ip_address_decode (&mp->pfx.address, &(args.prefix));
+
+  if (mp->is_del)
+    {
+      u32 vip_index;
+      if (!(rv = lb_vip_find_index (&(args.prefix), mp->pfx.len, mp->protocol,
+				    ntohs (mp->port), &vip_index)))
+	rv = lb_vip_del (vip_index);
+    }
+  else
+    {
+      u32 vip_index;
+      lb_vip_type_t type = 0;
+
+      if (ip46_prefix_is_ip4 (&(args.prefix), mp->pfx.len))
+	{
+	  if (mp->encap == LB_API_ENCAP_TYPE_GRE4)
+	    type = LB_VIP_TYPE_IP4_GRE4;
+	  else if (mp->encap == LB_API_ENCAP_TYPE_GRE6)
+	    type = LB_VIP_TYPE_IP4_GRE6;
+	  else if (mp->encap == LB_API_ENCAP_TYPE_L3DSR)
+	    type = LB_VIP_TYPE_IP4_L3DSR;
+	  else if (mp->encap == LB_API_ENCAP_TYPE_NAT4)
+	    type = LB_VIP_TYPE_IP4_NAT4;
+	}
+      else
+	{
+	  if (mp->encap == LB_API_ENCAP_TYPE_GRE4)
+	    type = LB_VIP_TYPE_IP6_GRE4;
+	  else if (mp->encap == LB_API_ENCAP_TYPE_GRE6)
+	    type = LB_VIP_TYPE_IP6_GRE6;
+	  else if (mp->encap == LB_API_ENCAP_TYPE_NAT6)
+	    type = LB_VIP_TYPE_IP6_NAT6;
+	}
+
+      args.plen = mp->pfx.len;
+      args.protocol = mp->protocol;
+      args.port = ntohs (mp->port);
+      args.type = type;
+      args.new_length = ntohl (mp->new_flows_table_length);
+
+      if (mp->src_ip_sticky)
+	args.src_ip_sticky = 1;
+
+      if (mp->maglev)
+	args.maglev = 1;
+
+      if (mp->encap == LB_API_ENCAP_TYPE_L3DSR)
+	{
+	  args.encap_args.dscp = (u8) (mp->dscp & 0x3F);
+	}
+      else if ((mp->encap == LB_API_ENCAP_TYPE_NAT4) ||
+	       (mp->encap == LB_API_ENCAP_TYPE_NAT6))
+	{
+	  args.encap_args.srv_type = mp->type;
+	  args.encap_args.target_port = ntohs (mp->target_port);
+	}
+
+      rv = lb_vip_add (args, &vip_index);
+    }
+  REPLY_MACRO (VL_API_LB_ADD_DEL_VIP_V3_REPLY);
+}
+
 static void
 vl_api_lb_add_del_as_t_handler
 (vl_api_lb_add_del_as_t * mp)
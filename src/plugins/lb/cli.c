@@ -33,6 +33,7 @@ lb_vip_command_fn (vlib_main_t * vm,
 
   args.new_length = 1024;
   args.src_ip_sticky = 0;
+  args.maglev = 0;
 
   if (!unformat_user (input, unformat_line_input, line_input))
     return 0;
@@ -52,6 +53,8 @@ lb_vip_command_fn (vlib_main_t * vm,
       del = 1;
     else if (unformat (line_input, "src_ip_sticky"))
       args.src_ip_sticky = 1;
+    else if (unformat (line_input, "maglev"))
+      args.maglev = 1;
     else if (unformat(line_input, "protocol tcp"))
       {
         args.protocol = (u8)IP_PROTOCOL_TCP;
@@ -189,7 +192,7 @@ VLIB_CLI_COMMAND (lb_vip_command, static) =
       "[encap (gre6|gre4|l3dsr|nat4|nat6)] "
       "[dscp <n>] "
       "[type (nodeport|clusterip) target_port <n>] "
-      "[new_len <n>] [src_ip_sticky] [del]",
+      "[new_len <n>] [src_ip_sticky] [maglev] [del]",
   .function = lb_vip_command_fn,
 };
 /* clang-format on */
@@ -312,6 +315,7 @@ lb_conf_command_fn (vlib_main_t * vm,
   ip6_address_t ip6 = lbm->ip6_src_address;
   u32 per_cpu_sticky_buckets = lbm->per_cpu_sticky_buckets;
   u32 per_cpu_sticky_buckets_log2 = 0;
+  u32 per_cpu_sticky_buckets_max = 0;
   u32 flow_timeout = lbm->flow_timeout;
   int ret;
   clib_error_t *error = 0;
@@ -331,7 +335,9 @@ lb_conf_command_fn (vlib_main_t * vm,
       if (per_cpu_sticky_buckets_log2 >= 32)
         return clib_error_return (0, "buckets-log2 value is too high");
       per_cpu_sticky_buckets = 1 << per_cpu_sticky_buckets_log2;
-    } else if (unformat(line_input, "timeout %d", &flow_timeout))
+    } else if (unformat(line_input, "max-buckets %d", &per_cpu_sticky_buckets_max))
+      ;
+    else if (unformat(line_input, "timeout %d", &flow_timeout))
       ;
     else {
       error = clib_error_return (0, "parse error: '%U'",
@@ -340,9 +346,14 @@ lb_conf_command_fn (vlib_main_t * vm,
     }
   }
 
+  if (per_cpu_sticky_buckets_max == 0)
+    per_cpu_sticky_buckets_max = clib_max (lbm->per_cpu_sticky_buckets_max,
+                                           per_cpu_sticky_buckets);
+
   lb_garbage_collection();
 
-  if ((ret = lb_conf(&ip4, &ip6, per_cpu_sticky_buckets, flow_timeout))) {
+  if ((ret = lb_conf(&ip4, &ip6, per_cpu_sticky_buckets,
+                     per_cpu_sticky_buckets_max, flow_timeout))) {
     error = clib_error_return (0, "lb_conf error %d", ret);
     goto done;
   }
@@ -356,7 +367,7 @@ done:
 VLIB_CLI_COMMAND (lb_conf_command, static) =
 {
   .path = "lb conf",
-  .short_help = "lb conf [ip4-src-address <addr>] [ip6-src-address <addr>] [buckets <n>] [timeout <s>]",
+  .short_help = "lb conf [ip4-src-address <addr>] [ip6-src-address <addr>] [buckets <n>] [max-buckets <n>] [timeout <s>]",
   .function = lb_conf_command_fn,
 };
 
@@ -107,6 +107,8 @@ u8 *format_lb_main (u8 * s, va_list * args)
   s = format(s, " ip6-src-address: %U \n", format_ip6_address, &lbm->ip6_src_address);
   s = format(s, " #vips: %u\n", pool_elts(lbm->vips));
   s = format(s, " #ass: %u\n", pool_elts(lbm->ass) - 1);
+  s = format(s, " sticky buckets: %u (max %u)\n", lbm->per_cpu_sticky_buckets,
+             lbm->per_cpu_sticky_buckets_max);
 
   u32 thread_index;
   for(thread_index = 0; thread_index < tm->n_vlib_mains; thread_index++ ) {
@@ -115,6 +117,7 @@ u8 *format_lb_main (u8 * s, va_list * args)
       s = format(s, "core %d\n", thread_index);
       s = format(s, "  timeout: %ds\n", h->timeout);
       s = format(s, "  usage: %d / %d\n", lb_hash_elts(h, lb_hash_time_now(vlib_get_main())),  lb_hash_size(h));
+      s = format(s, "  overflows: %u\n", lbm->per_cpu[thread_index].sticky_overflows);
     }
   }
 
@@ -156,11 +159,12 @@ uword unformat_lb_vip_type (unformat_input_t * input, va_list * args)
 u8 *format_lb_vip (u8 * s, va_list * args)
 {
   lb_vip_t *vip = va_arg (*args, lb_vip_t *);
-  s = format(s, "%U %U new_size:%u #as:%u%s",
+  s = format(s, "%U %U new_size:%u #as:%u%s%s",
              format_lb_vip_type, vip->type,
              format_ip46_prefix, &vip->prefix, vip->plen, IP46_TYPE_ANY,
-             vip->new_flow_table_mask + 1,
+             vec_len(vip->new_flow_table),
              pool_elts(vip->as_indexes),
+             lb_vip_is_maglev(vip)?" maglev":"",
              (vip->flags & LB_VIP_FLAGS_USED)?"":" removed");
 
   if (vip->port != 0)
@@ -199,16 +203,18 @@ u8 *format_lb_vip_detailed (u8 * s, va_list * args)
   u32 indent = format_get_indent (s);
 
   /* clang-format off */
-  s = format(s, "%U %U [%lu] %U%s%s\n"
-                   "%U  new_size:%u\n",
+  s = format(s, "%U %U [%lu] %U%s%s%s\n"
+                   "%U  new_size:%u sticky_flows:%u\n",
                   format_white_space, indent,
                   format_lb_vip_type, vip->type,
                   vip - lbm->vips,
                   format_ip46_prefix, &vip->prefix, (u32) vip->plen, IP46_TYPE_ANY,
                   lb_vip_is_src_ip_sticky (vip) ? " src_ip_sticky" : "",
+                  lb_vip_is_maglev (vip) ? " maglev" : "",
                   (vip->flags & LB_VIP_FLAGS_USED)?"":" removed",
                   format_white_space, indent,
-                  vip->new_flow_table_mask + 1);
+                  vec_len(vip->new_flow_table),
+                  lb_vip_sticky_flows(vip - lbm->vips));
   /* clang-format on */
 
   if (vip->port != 0)
@@ -382,17 +388,41 @@ void lb_garbage_collection()
   lb_put_writer_lock();
 }
 
+/**
+ * Smallest prime not below n, the length of a maglev new flow table.
+ * MagLev needs a prime length so that any skip visits every entry.
+ */
+static u32 lb_maglev_table_length(u32 n)
+{
+  u32 d;
+
+  if (n <= 2)
+    return 2;
+
+  for (n |= 1;; n += 2) {
+    for (d = 3; d * d <= n; d += 2)
+      if (n % d == 0)
+        break;
+    if (d * d > n)
+      return n;
+  }
+}
+
 static void lb_vip_update_new_flow_table(lb_vip_t *vip)
 {
   lb_main_t *lbm = &lb_main;
   lb_new_flow_entry_t *old_table;
-  u32 i, *as_index;
+  u32 i, *as_index, len;
   lb_new_flow_entry_t *new_flow_table = 0;
   lb_as_t *as;
   lb_pseudorand_t *pr, *sort_arr = 0;
 
   CLIB_SPINLOCK_ASSERT_LOCKED (&lbm->writer_lock); // We must have the lock
 
+  len = lb_vip_is_maglev(vip) ?
+      lb_maglev_table_length(vip->new_flow_table_mask + 1) :
+      vip->new_flow_table_mask + 1;
+
   //Check if some AS is configured or not
   i = 0;
   pool_foreach (as_index, vip->as_indexes) {
@@ -406,7 +436,7 @@ static void lb_vip_update_new_flow_table(lb_vip_t *vip)
 out:
   if (i == 0) {
     //Only the default. i.e. no AS
-    vec_validate(new_flow_table, vip->new_flow_table_mask);
+    vec_validate(new_flow_table, len - 1);
     for (i=0; i<vec_len(new_flow_table); i++)
       new_flow_table[i].as_index = 0;
 
@@ -433,6 +463,16 @@ out:
   vec_foreach(pr, sort_arr) {
     lb_as_t *as = &lbm->ass[pr->as_index];
 
+    if (lb_vip_is_maglev(vip)) {
+      /* offset and skip come from two independent hashes of the AS
+       * address, as in the MagLev paper */
+      u64 a = as->address.as_u64[0], b = as->address.as_u64[1], c = 0;
+      hash_mix64(a, b, c);
+      pr->last = c % len;
+      pr->skip = b % (len - 1) + 1;
+      continue;
+    }
+
     u64 seed = clib_xxhash(as->address.as_u64[0] ^
                            as->address.as_u64[1]);
     /* We have 2^n buckets.
@@ -447,7 +487,7 @@ out:
   }
 
   //Let's create a new flow table
-  vec_validate(new_flow_table, vip->new_flow_table_mask);
+  vec_validate(new_flow_table, len - 1);
   for (i=0; i<vec_len(new_flow_table); i++)
     new_flow_table[i].as_index = 0;
 
@@ -456,7 +496,8 @@ out:
     vec_foreach(pr, sort_arr) {
       while (1) {
         u32 last = pr->last;
-        pr->last = (pr->last + pr->skip) & vip->new_flow_table_mask;
+        pr->last += pr->skip;
+        pr->last -= (pr->last >= len) ? len : 0;
         if (new_flow_table[last].as_index == 0) {
           new_flow_table[last].as_index = pr->as_index;
           break;
@@ -477,17 +518,22 @@ finished:
 }
 
 int lb_conf(ip4_address_t *ip4_address, ip6_address_t *ip6_address,
-           u32 per_cpu_sticky_buckets, u32 flow_timeout)
+           u32 per_cpu_sticky_buckets, u32 per_cpu_sticky_buckets_max,
+           u32 flow_timeout)
 {
   lb_main_t *lbm = &lb_main;
 
-  if (!is_pow2(per_cpu_sticky_buckets))
+  if (!is_pow2(per_cpu_sticky_buckets) || !is_pow2(per_cpu_sticky_buckets_max))
     return VNET_API_ERROR_INVALID_MEMORY_SIZE;
 
+  if (per_cpu_sticky_buckets_max < per_cpu_sticky_buckets)
+    return VNET_API_ERROR_INVALID_VALUE;
+
   lb_get_writer_lock(); //Not exactly necessary but just a reminder that it exists for my future self
   lbm->ip4_src_address = *ip4_address;
   lbm->ip6_src_address = *ip6_address;
   lbm->per_cpu_sticky_buckets = per_cpu_sticky_buckets;
+  lbm->per_cpu_sticky_buckets_max = per_cpu_sticky_buckets_max;
   lbm->flow_timeout = flow_timeout;
   lb_put_writer_lock();
   return 0;
@@ -796,6 +842,32 @@ lb_flush_vip_as (u32 vip_index, u32 as_index)
   return 0;
 }
 
+/**
+ * Number of live flows the workers' sticky tables hold for a VIP.
+ * The tables are read while the workers update them, so this is an
+ * estimate of the VIP's share of the sticky capacity.
+ */
+u32
+lb_vip_sticky_flows (u32 vip_index)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main();
+  lb_main_t *lbm = &lb_main;
+  u32 now = lb_hash_time_now(vlib_get_main());
+  u32 thread_index, i, n = 0;
+  lb_hash_bucket_t *b;
+
+  for(thread_index = 0; thread_index < tm->n_vlib_mains; thread_index++ ) {
+    lb_hash_t *h = lbm->per_cpu[thread_index].sticky_ht;
+    if (h == NULL)
+      continue;
+    lb_hash_foreach_valid_entry(h, b, i, now) {
+      n += (b->vip[i] == vip_index);
+    }
+  }
+
+  return n;
+}
+
 int lb_vip_del_ass_withlock(u32 vip_index, ip46_address_t *addresses, u32 n,
                             u8 flush)
 {
@@ -1154,6 +1226,10 @@ int lb_vip_add(lb_vip_add_args_t args, u32 *vip_index)
     {
       vip->flags |= LB_VIP_FLAGS_SRC_IP_STICKY;
     }
+  if (args.maglev)
+    {
+      vip->flags |= LB_VIP_FLAGS_MAGLEV;
+    }
   vip->as_indexes = 0;
 
   //Validate counters
@@ -1401,6 +1477,7 @@ lb_init (vlib_main_t * vm)
   vec_validate(lbm->per_cpu, tm->n_vlib_mains - 1);
   clib_spinlock_init (&lbm->writer_lock);
   lbm->per_cpu_sticky_buckets = LB_DEFAULT_PER_CPU_STICKY_BUCKETS;
+  lbm->per_cpu_sticky_buckets_max = LB_DEFAULT_PER_CPU_STICKY_BUCKETS;
   lbm->flow_timeout = LB_DEFAULT_FLOW_TIMEOUT;
   lbm->ip4_src_address.as_u32 = 0xffffffff;
   lbm->ip6_src_address.as_u64[0] = 0xffffffffffffffffL;
@@ -44,6 +44,9 @@
 #include <vppinfra/lock.h>
 
 #define LB_DEFAULT_PER_CPU_STICKY_BUCKETS 1 << 10
+/* a worker doubles its sticky table after that many untracked packets
+   per 64 buckets within a flow timeout, up to per_cpu_sticky_buckets_max */
+#define LB_STICKY_GROW_SHIFT 6
 #define LB_DEFAULT_FLOW_TIMEOUT 40
 #define LB_MAPPING_BUCKETS  1024
 #define LB_MAPPING_MEMORY_SIZE  64<<20
@@ -272,6 +275,8 @@ typedef struct {
   /**
    * New flows table length - 1
    * (length MUST be a power of 2)
+   * Maglev VIPs round the length up to a prime and index the table
+   * with lb_vip_new_flow_as_index instead.
    */
   u32 new_flow_table_mask;
 
@@ -325,6 +330,7 @@ typedef struct {
   u8 flags;
 #define LB_VIP_FLAGS_USED 0x1
 #define LB_VIP_FLAGS_SRC_IP_STICKY 0x2
+#define LB_VIP_FLAGS_MAGLEV 0x4
 
   /**
    * Pool of AS indexes used for this VIP.
@@ -350,6 +356,25 @@ typedef struct {
 #define lb_vip_is_src_ip_sticky(vip)                                          \
   (((vip)->flags & LB_VIP_FLAGS_SRC_IP_STICKY) != 0)
 
+#define lb_vip_is_maglev(vip) (((vip)->flags & LB_VIP_FLAGS_MAGLEV) != 0)
+
+/**
+ * AS index for a new flow of the VIP.
+ * Maglev tables have a prime length, the hash is scaled to it with a
+ * multiply rather than a modulo.
+ */
+always_inline u32
+lb_vip_new_flow_as_index (const lb_vip_t *vip, u32 hash)
+{
+  u32 i;
+
+  if (lb_vip_is_maglev (vip))
+    i = ((u64) hash * vec_len (vip->new_flow_table)) >> 32;
+  else
+    i = hash & vip->new_flow_table_mask;
+  return vip->new_flow_table[i].as_index;
+}
+
 /* clang-format off */
 #define lb_vip_is_gre4(vip) (((vip)->type == LB_VIP_TYPE_IP6_GRE4 \
                             || (vip)->type == LB_VIP_TYPE_IP4_GRE4) \
@@ -470,6 +495,18 @@ typedef struct {
    * One single table is used for all VIPs.
    */
   lb_hash_t *sticky_ht;
+
+  /**
+   * Packets which found no free sticky entry since the table was
+   * last resized, or since sticky_overflows_time.
+   */
+  u32 sticky_overflows;
+
+  /**
+   * When sticky_overflows was last reset. It is reset every flow
+   * timeout, so that only recent overflows make the table grow.
+   */
+  u32 sticky_overflows_time;
 } lb_per_cpu_t;
 
 typedef struct {
@@ -526,6 +563,11 @@ typedef struct {
    */
   u32 per_cpu_sticky_buckets;
 
+  /**
+   * Upper bound a worker may grow its sticky table to when it overflows.
+   */
+  u32 per_cpu_sticky_buckets_max;
+
   /**
    * Flow timeout in seconds.
    */
@@ -581,6 +623,7 @@ typedef struct {
   u8 protocol;
   u16 port;
   u8 src_ip_sticky;
+  u8 maglev;
   lb_vip_type_t type;
   u32 new_length;
   lb_vip_encap_args_t encap_args;
@@ -598,12 +641,13 @@ extern vlib_node_registration_t lb_nat6_in2out_node;
  * Fix global load-balancer parameters.
  * @param ip4_address IPv4 source address used for encapsulated traffic
  * @param ip6_address IPv6 source address used for encapsulated traffic
- * @param sticky_buckets FIXME
+ * @param sticky_buckets per worker buckets in the sticky table
+ * @param sticky_buckets_max per worker buckets the table may grow to
  * @param flow_timeout FIXME
  * @return 0 on success. VNET_LB_ERR_XXX on error
  */
 int lb_conf(ip4_address_t *ip4_address, ip6_address_t *ip6_address,
-            u32 sticky_buckets, u32 flow_timeout);
+            u32 sticky_buckets, u32 sticky_buckets_max, u32 flow_timeout);
 
 int lb_vip_add(lb_vip_add_args_t args, u32 *vip_index);
 
@@ -620,6 +664,8 @@ int lb_flush_vip_as (u32 vip_index, u32 as_index);
 
 u32 lb_hash_time_now(vlib_main_t * vm);
 
+u32 lb_vip_sticky_flows(u32 vip_index);
+
 void lb_garbage_collection();
 
 int lb_nat4_interface_add_del (u32 sw_if_index, int is_del);
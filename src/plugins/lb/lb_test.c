@@ -115,6 +115,57 @@ static int api_lb_conf (vat_main_t * vam)
   return ret;
 }
 
+static int
+api_lb_conf_v2 (vat_main_t *vam)
+{
+  unformat_input_t *line_input = vam->input;
+  vl_api_lb_conf_v2_t *mp;
+  u32 ip4_src_address = 0xffffffff;
+  ip46_address_t ip6_src_address;
+  u32 sticky_buckets_per_core = LB_DEFAULT_PER_CPU_STICKY_BUCKETS;
+  u32 sticky_buckets_max_per_core = ~0;
+  u32 flow_timeout = LB_DEFAULT_FLOW_TIMEOUT;
+  int ret;
+
+  ip6_src_address.as_u64[0] = 0xffffffffffffffffL;
+  ip6_src_address.as_u64[1] = 0xffffffffffffffffL;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "ip4-src-address %U", unformat_ip4_address,
+		    &ip4_src_address))
+	;
+      else if (unformat (line_input, "ip6-src-address %U",
+			 unformat_ip6_address, &ip6_src_address))
+	;
+      else if (unformat (line_input, "buckets %d", &sticky_buckets_per_core))
+	;
+      else if (unformat (line_input, "max-buckets %d",
+			 &sticky_buckets_max_per_core))
+	;
+      else if (unformat (line_input, "timeout %d", &flow_timeout))
+	;
+      else
+	{
+	  errmsg ("invalid arguments\n");
+	  return -99;
+	}
+    }
+
+  M (LB_CONF_V2, mp);
+  clib_memcpy (&(mp->ip4_src_address), &ip4_src_address,
+	       sizeof (ip4_src_address));
+  clib_memcpy (&(mp->ip6_src_address), &ip6_src_address,
+	       sizeof (ip6_src_address));
+  mp->sticky_buckets_per_core = htonl (sticky_buckets_per_core);
+  mp->sticky_buckets_max_per_core = htonl (sticky_buckets_max_per_core);
+  mp->flow_timeout = htonl (flow_timeout);
+
+  S (mp);
+  W (ret);
+  return ret;
+}
+
 static int api_lb_add_del_vip (vat_main_t * vam)
 {
   unformat_input_t *line_input = vam->input;
@@ -306,6 +357,109 @@ api_lb_add_del_vip_v2 (vat_main_t *vam)
   return ret;
 }
 
+static int
+api_lb_add_del_vip_v3 (vat_main_t *vam)
+{
+  unformat_input_t *line_input = vam->input;
+  vl_api_lb_add_del_vip_v3_t *mp;
+  int ret;
+  ip46_address_t ip_prefix;
+  u8 prefix_length = 0;
+  u8 protocol = 0;
+  u32 port = 0;
+  u32 encap = 0;
+  u32 dscp = ~0;
+  u32 srv_type = LB_SRV_TYPE_CLUSTERIP;
+  u32 target_port = 0;
+  u32 new_length = 1024;
+  u8 src_ip_sticky = 0;
+  u8 maglev = 0;
+  int is_del = 0;
+
+  if (!unformat (line_input, "%U", unformat_ip46_prefix, &ip_prefix,
+		 &prefix_length, IP46_TYPE_ANY, &prefix_length))
+    {
+      errmsg ("lb_add_del_vip: invalid vip prefix\n");
+      return -99;
+    }
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "new_len %d", &new_length))
+	;
+      else if (unformat (line_input, "del"))
+	is_del = 1;
+      else if (unformat (line_input, "src_ip_sticky"))
+	src_ip_sticky = 1;
+      else if (unformat (line_input, "maglev"))
+	maglev = 1;
+      else if (unformat (line_input, "protocol tcp"))
+	{
+	  protocol = IP_PROTOCOL_TCP;
+	}
+      else if (unformat (line_input, "protocol udp"))
+	{
+	  protocol = IP_PROTOCOL_UDP;
+	}
+      else if (unformat (line_input, "port %d", &port))
+	;
+      else if (unformat (line_input, "encap gre4"))
+	encap = LB_ENCAP_TYPE_GRE4;
+      else if (unformat (line_input, "encap gre6"))
+	encap = LB_ENCAP_TYPE_GRE6;
+      else if (unformat (line_input, "encap l3dsr"))
+	encap = LB_ENCAP_TYPE_L3DSR;
+      else if (unformat (line_input, "encap nat4"))
+	encap = LB_ENCAP_TYPE_NAT4;
+      else if (unformat (line_input, "encap nat6"))
+	encap = LB_ENCAP_TYPE_NAT6;
+      else if (unformat (line_input, "dscp %d", &dscp))
+	;
+      else if (unformat (line_input, "type clusterip"))
+	srv_type = LB_SRV_TYPE_CLUSTERIP;
+      else if (unformat (line_input, "type nodeport"))
+	srv_type = LB_SRV_TYPE_NODEPORT;
+      else if (unformat (line_input, "target_port %d", &target_port))
+	;
+      else
+	{
+	  errmsg ("invalid arguments\n");
+	  return -99;
+	}
+    }
+
+  if ((encap != LB_ENCAP_TYPE_L3DSR) && (dscp != ~0))
+    {
+      errmsg ("lb_vip_add error: should not configure dscp for none L3DSR.");
+      return -99;
+    }
+
+  if ((encap == LB_ENCAP_TYPE_L3DSR) && (dscp >= 64))
+    {
+      errmsg ("lb_vip_add error: dscp for L3DSR should be less than 64.");
+      return -99;
+    }
+
+  M (LB_ADD_DEL_VIP_V3, mp);
+  ip_address_encode (&ip_prefix, IP46_TYPE_ANY, &mp->pfx.address);
+  mp->pfx.len = prefix_length;
+  mp->protocol = (u8) protocol;
+  mp->port = htons ((u16) port);
+  mp->encap = (u8) encap;
+  mp->dscp = (u8) dscp;
+  mp->type = (u8) srv_type;
+  mp->target_port = htons ((u16) target_port);
+  mp->node_port = htons ((u16) target_port);
+  mp->new_flows_table_length = htonl (new_length);
+  mp->is_del = is_del;
+  mp->src_ip_sticky = src_ip_sticky;
+  mp->maglev = maglev;
+
+  S (mp);
+  W (ret);
+  return ret;
+}
+
 static int api_lb_add_del_as (vat_main_t * vam)
 {
 
@@ -62,7 +62,7 @@ typedef struct {
 } lb_hash_t;
 
 #define lb_hash_nbuckets(h) (((h)->buckets_mask) + 1)
-#define lb_hash_size(h) ((h)->buckets_mask + LBHASH_ENTRY_PER_BUCKET)
+#define lb_hash_size(h) (lb_hash_nbuckets(h) * LBHASH_ENTRY_PER_BUCKET)
 
 #define lb_hash_foreach_bucket(h, bucket) \
   for (bucket = (h)->buckets; \
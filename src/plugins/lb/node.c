@@ -123,34 +123,94 @@ format_lb_nat_trace (u8 * s, va_list * args)
   return s;
 }
 
+/**
+ * Move the live entries of a worker's sticky table to a table of
+ * another size, so that resizing does not break the flows' affinity.
+ * Entries which expired or no longer fit release their AS.
+ */
+static lb_hash_t *
+lb_sticky_table_resize (u32 thread_index, lb_hash_t *old, u32 n_buckets,
+                        u32 time_now)
+{
+  lb_main_t *lbm = &lb_main;
+  lb_hash_t *h = lb_hash_alloc (n_buckets, lbm->flow_timeout);
+  lb_hash_bucket_t *b, *nb;
+  u32 i, j;
+
+  lb_hash_foreach_entry(old, b, i)
+    {
+      if (!clib_u32_loop_gt (time_now, b->timeout[i]))
+        {
+          nb = &h->buckets[b->hash[i] & h->buckets_mask];
+          for (j = 0; j < LBHASH_ENTRY_PER_BUCKET; j++)
+            if (nb->timeout[j] == 0)
+              break;
+
+          if (j < LBHASH_ENTRY_PER_BUCKET)
+            {
+              //The new entry takes over the AS reference of the old one
+              lb_hash_put (h, b->hash[i], b->value[i], b->vip[i], j, 0);
+              nb->timeout[j] = b->timeout[i];
+              continue;
+            }
+        }
+
+      vlib_refcount_add (&lbm->as_refcount, thread_index, b->value[i], -1);
+      vlib_refcount_add (&lbm->as_refcount, thread_index, 0, 1);
+    }
+
+  lb_hash_free (old);
+  return h;
+}
+
 lb_hash_t *
-lb_get_sticky_table (u32 thread_index)
+lb_get_sticky_table (u32 thread_index, u32 time_now)
 {
   lb_main_t *lbm = &lb_main;
-  lb_hash_t *sticky_ht = lbm->per_cpu[thread_index].sticky_ht;
-  //Check if size changed
-  if (PREDICT_FALSE(
-      sticky_ht && (lbm->per_cpu_sticky_buckets != lb_hash_nbuckets(sticky_ht))))
+  lb_per_cpu_t *pc = &lbm->per_cpu[thread_index];
+  lb_hash_t *sticky_ht = pc->sticky_ht;
+  u32 n_buckets = lbm->per_cpu_sticky_buckets;
+
+  if (PREDICT_TRUE (sticky_ht != NULL))
     {
-      //Dereference everything in there
-      lb_hash_bucket_t *b;
-      u32 i;
-      lb_hash_foreach_entry(sticky_ht, b, i)
+      u32 cur = lb_hash_nbuckets (sticky_ht);
+
+      //Keep the size the table grew to
+      if (cur > n_buckets && cur <= lbm->per_cpu_sticky_buckets_max)
+        n_buckets = cur;
+
+      //Grow it when too many new flows found no room in it
+      if (PREDICT_FALSE (pc->sticky_overflows >
+                         (cur >> LB_STICKY_GROW_SHIFT)) &&
+          cur < lbm->per_cpu_sticky_buckets_max)
+        n_buckets = clib_max (n_buckets, cur << 1);
+
+      //Check if size changed
+      if (PREDICT_FALSE (n_buckets != cur))
         {
-          vlib_refcount_add (&lbm->as_refcount, thread_index, b->value[i], -1);
-          vlib_refcount_add (&lbm->as_refcount, thread_index, 0, 1);
+          sticky_ht = lb_sticky_table_resize (thread_index, sticky_ht,
+                                              n_buckets, time_now);
+          pc->sticky_ht = sticky_ht;
+          pc->sticky_overflows = 0;
+          pc->sticky_overflows_time = time_now;
         }
 
-      lb_hash_free (sticky_ht);
-      sticky_ht = NULL;
+      //Forget overflows from flows which would have expired by now
+      if (PREDICT_FALSE (clib_u32_loop_gt (
+              time_now, pc->sticky_overflows_time + lbm->flow_timeout)))
+        {
+          pc->sticky_overflows = 0;
+          pc->sticky_overflows_time = time_now;
+        }
     }
 
   //Create if necessary
   if (PREDICT_FALSE(sticky_ht == NULL))
     {
-      lbm->per_cpu[thread_index].sticky_ht = lb_hash_alloc (
-          lbm->per_cpu_sticky_buckets, lbm->flow_timeout);
-      sticky_ht = lbm->per_cpu[thread_index].sticky_ht;
+      pc->sticky_ht = lb_hash_alloc (n_buckets, lbm->flow_timeout);
+      sticky_ht = pc->sticky_ht;
+      pc->sticky_overflows = 0;
+      pc->sticky_overflows_time = time_now;
       clib_warning("Regenerated sticky table %p", sticky_ht);
     }
 
@@ -285,7 +345,7 @@ lb_node_fn (vlib_main_t * vm,
   u32 thread_index = vm->thread_index;
   u32 lb_time = lb_hash_time_now (vm);
 
-  lb_hash_t *sticky_ht = lb_get_sticky_table (thread_index);
+  lb_hash_t *sticky_ht = lb_get_sticky_table (thread_index, lb_time);
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
   next_index = node->cached_next_index;
@@ -372,8 +432,7 @@ lb_node_fn (vlib_main_t * vm,
           else if (PREDICT_TRUE(available_index0 != ~0))
             {
               //There is an available slot for a new flow
-              asindex0 =
-                  vip0->new_flow_table[hash0 & vip0->new_flow_table_mask].as_index;
+              asindex0 = lb_vip_new_flow_as_index (vip0, hash0);
               counter = LB_VIP_COUNTER_FIRST_PACKET;
               counter = (asindex0 == 0) ? LB_VIP_COUNTER_NO_SERVER : counter;
 
@@ -397,9 +456,9 @@ lb_node_fn (vlib_main_t * vm,
           else
             {
               //Could not store new entry in the table
-              asindex0 =
-                  vip0->new_flow_table[hash0 & vip0->new_flow_table_mask].as_index;
+              asindex0 = lb_vip_new_flow_as_index (vip0, hash0);
               counter = LB_VIP_COUNTER_UNTRACKED_PACKET;
+              lbm->per_cpu[thread_index].sticky_overflows++;
             }
 
           vlib_increment_simple_counter (
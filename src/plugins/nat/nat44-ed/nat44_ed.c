@@ -203,18 +203,12 @@ nat44_ed_sm_o2i_del (snat_main_t *sm, ip4_address_t addr, u16 port,
   return clib_bihash_add_del_16_8 (&sm->flow_hash, &kv, 0 /*is_add*/);
 }
 
-void
-nat44_ed_free_session_data (snat_main_t *sm, snat_session_t *s,
-			    u32 thread_index, u8 is_ha)
+static void
+nat44_ed_release_session_data (snat_main_t *sm, snat_session_t *s,
+			       u32 thread_index, u8 is_ha)
 {
   per_vrf_sessions_unregister_session (s, thread_index);
 
-  if (nat_ed_ses_i2o_flow_hash_add_del (sm, thread_index, s, 0))
-    nat_elog_warn (sm, "flow hash del failed");
-
-  if (nat_ed_ses_o2i_flow_hash_add_del (sm, thread_index, s, 0))
-    nat_elog_warn (sm, "flow hash del failed");
-
   if (na44_ed_is_fwd_bypass_session (s))
     {
       return;
@@ -240,6 +234,19 @@ nat44_ed_free_session_data (snat_main_t *sm, snat_session_t *s,
     }
 }
 
+void
+nat44_ed_free_session_data (snat_main_t *sm, snat_session_t *s,
+			    u32 thread_index, u8 is_ha)
+{
+  if (nat_ed_ses_i2o_flow_hash_add_del (sm, thread_index, s, 0))
+    nat_elog_warn (sm, "flow hash del failed");
+
+  if (nat_ed_ses_o2i_flow_hash_add_del (sm, thread_index, s, 0))
+    nat_elog_warn (sm, "flow hash del failed");
+
+  nat44_ed_release_session_data (sm, s, thread_index, is_ha);
+}
+
 static ip_interface_address_t *
 nat44_ed_get_ip_interface_address (u32 sw_if_index, ip4_address_t addr)
 {
@@ -2358,6 +2365,10 @@ nat_init (vlib_main_t * vm)
 			   "/nat44-ed/total-sessions");
   sm->max_cfg_sessions_gauge =
     vlib_stats_add_gauge ("/nat44-ed/max-cfg-sessions");
+  nat_init_simple_counter (sm->expired_sessions, "expired-sessions",
+			   "/nat44-ed/expired-sessions");
+  sm->expirations_per_second_gauge =
+    vlib_stats_add_gauge ("/nat44-ed/expirations-per-second");
 
 #define _(x)                                                                  \
   nat_init_simple_counter (sm->counters.fastpath.in2out.x, #x,                \
@@ -2425,6 +2436,8 @@ nat_init (vlib_main_t * vm)
 
 VLIB_INIT_FUNCTION (nat_init);
 
+static void nat44_ed_create_expire_walk_process ();
+
 int
 nat44_plugin_enable (nat44_config_t c)
 {
@@ -2461,6 +2474,9 @@ nat44_plugin_enable (nat44_config_t c)
   nat_reset_timeouts (&sm->timeouts);
 
   vlib_zero_simple_counter (&sm->total_sessions, 0);
+  vlib_zero_simple_counter (&sm->expired_sessions, 0);
+
+  nat44_ed_create_expire_walk_process ();
 
   if (!sm->frame_queue_nelts)
     {
@@ -3272,31 +3288,12 @@ nat44_update_session_limit (u32 session_limit, u32 vrf_id)
 static void
 nat44_ed_worker_db_init (snat_main_per_thread_data_t *tsm, u32 translations)
 {
-  dlist_elt_t *head;
-
   pool_alloc (tsm->per_vrf_sessions_pool, translations);
   pool_alloc (tsm->sessions, translations);
-  pool_alloc (tsm->lru_pool, translations);
-
-  pool_get (tsm->lru_pool, head);
-  tsm->tcp_trans_lru_head_index = head - tsm->lru_pool;
-  clib_dlist_init (tsm->lru_pool, tsm->tcp_trans_lru_head_index);
 
-  pool_get (tsm->lru_pool, head);
-  tsm->tcp_estab_lru_head_index = head - tsm->lru_pool;
-  clib_dlist_init (tsm->lru_pool, tsm->tcp_estab_lru_head_index);
-
-  pool_get (tsm->lru_pool, head);
-  tsm->udp_lru_head_index = head - tsm->lru_pool;
-  clib_dlist_init (tsm->lru_pool, tsm->udp_lru_head_index);
-
-  pool_get (tsm->lru_pool, head);
-  tsm->icmp_lru_head_index = head - tsm->lru_pool;
-  clib_dlist_init (tsm->lru_pool, tsm->icmp_lru_head_index);
-
-  pool_get (tsm->lru_pool, head);
-  tsm->unk_proto_lru_head_index = head - tsm->lru_pool;
-  clib_dlist_init (tsm->lru_pool, tsm->unk_proto_lru_head_index);
+  tw_timer_wheel_init_2t_1w_2048sl (&tsm->timer_wheel, 0 /* no callback */,
+				    1.0 /* timer interval */,
+				    NAT44_ED_EXPIRE_MAX_PER_WALK);
 }
 
 static void
@@ -3327,7 +3324,8 @@ nat44_ed_db_init ()
 static void
 nat44_ed_worker_db_free (snat_main_per_thread_data_t *tsm)
 {
-  pool_free (tsm->lru_pool);
+  tw_timer_wheel_free_2t_1w_2048sl (&tsm->timer_wheel);
+  vec_free (tsm->expired_timers);
   pool_free (tsm->sessions);
   pool_free (tsm->per_vrf_sessions_pool);
 }
@@ -3364,6 +3362,190 @@ nat44_ed_sessions_clear ()
   vlib_zero_simple_counter (&sm->total_sessions, 0);
 }
 
+#define NAT44_ED_EXPIRE_BATCH 32
+
+/* delete expired sessions, flow hash buckets of a whole batch are
+ * prefetched before any of the keys is removed */
+static void
+nat44_ed_expired_sessions_delete (snat_main_t *sm, u32 thread_index,
+				  u32 *session_indices, u32 n_sessions)
+{
+  snat_main_per_thread_data_t *tsm =
+    vec_elt_at_index (sm->per_thread_data, thread_index);
+  clib_bihash_kv_16_8_t kv[2 * NAT44_ED_EXPIRE_BATCH];
+  u64 hash[2 * NAT44_ED_EXPIRE_BATCH];
+  snat_session_t *s;
+  u32 n, i;
+
+  while (n_sessions)
+    {
+      n = clib_min (n_sessions, NAT44_ED_EXPIRE_BATCH);
+
+      for (i = 0; i < n; i++)
+	{
+	  s = pool_elt_at_index (tsm->sessions, session_indices[i]);
+	  nat_6t_flow_to_ed_k (&kv[2 * i], &s->i2o);
+	  nat_6t_flow_to_ed_k (&kv[2 * i + 1], &s->o2i);
+	  hash[2 * i] = clib_bihash_hash_16_8 (&kv[2 * i]);
+	  hash[2 * i + 1] = clib_bihash_hash_16_8 (&kv[2 * i + 1]);
+	  clib_bihash_prefetch_bucket_16_8 (&sm->flow_hash, hash[2 * i]);
+	  clib_bihash_prefetch_bucket_16_8 (&sm->flow_hash, hash[2 * i + 1]);
+	}
+
+      for (i = 0; i < 2 * n; i++)
+	{
+	  if (clib_bihash_add_del_with_hash_16_8 (&sm->flow_hash, &kv[i],
+						  hash[i], 0))
+	    nat_elog_warn (sm, "flow hash del failed");
+	}
+
+      for (i = 0; i < n; i++)
+	{
+	  s = pool_elt_at_index (tsm->sessions, session_indices[i]);
+	  nat44_ed_release_session_data (sm, s, thread_index, 0);
+	  pool_put (tsm->sessions, s);
+	}
+
+      session_indices += n;
+      n_sessions -= n;
+    }
+}
+
+u32
+nat44_ed_expire_sessions (snat_main_t *sm, u32 thread_index, f64 now)
+{
+  snat_main_per_thread_data_t *tsm =
+    vec_elt_at_index (sm->per_thread_data, thread_index);
+  snat_session_t *s;
+  f64 expire_time;
+  u32 i, n_expired = 0;
+
+  /* the wheel is driven by the walk and by the max sessions path, let it
+   * run whenever a whole tick elapsed rather than once per interval */
+  vec_reset_length (tsm->expired_timers);
+  tsm->expired_timers = tw_timer_expire_timers_vec_elapsed_2t_1w_2048sl (
+    &tsm->timer_wheel, now, tsm->expired_timers);
+
+  vec_foreach_index (i, tsm->expired_timers)
+    {
+      /* user handle carries timer id in the top bit */
+      s = pool_elt_at_index (tsm->sessions,
+			     tsm->expired_timers[i] & 0x7FFFFFFF);
+      s->timer_handle = ~0;
+
+      expire_time = s->last_heard + (f64) nat44_session_get_timeout (sm, s);
+      if (now < expire_time)
+	{
+	  /* refreshed since the timer was armed */
+	  nat44_ed_session_timer_start (tsm, s, expire_time - now);
+	  continue;
+	}
+      /* reuse the vector for session indices */
+      tsm->expired_timers[n_expired++] = s - tsm->sessions;
+    }
+
+  if (n_expired)
+    {
+      nat44_ed_expired_sessions_delete (sm, thread_index, tsm->expired_timers,
+					n_expired);
+      vlib_set_simple_counter (&sm->total_sessions, thread_index, 0,
+			       pool_elts (tsm->sessions));
+      vlib_increment_simple_counter (&sm->expired_sessions, thread_index, 0,
+				     n_expired);
+    }
+
+  return n_expired;
+}
+
+/**
+ * @brief Per worker node expiring sessions from its timer wheel.
+ */
+static uword
+nat44_ed_expire_worker_walk_fn (vlib_main_t *vm, vlib_node_runtime_t *rt,
+				vlib_frame_t *f)
+{
+  snat_main_t *sm = &snat_main;
+  u32 thread_index = vm->thread_index;
+  snat_main_per_thread_data_t *tsm;
+  u32 n_expired;
+
+  if (!sm->enabled)
+    return 0;
+
+  tsm = vec_elt_at_index (sm->per_thread_data, thread_index);
+  n_expired = nat44_ed_expire_sessions (sm, thread_index, vlib_time_now (vm));
+
+  /* the wheel stopped at the per walk cap, come back for the rest on the
+   * next main loop instead of waiting for the next second */
+  if (vec_len (tsm->expired_timers) >= NAT44_ED_EXPIRE_MAX_PER_WALK)
+    vlib_node_set_interrupt_pending (vm, rt->node_index);
+
+  return n_expired;
+}
+
+VLIB_REGISTER_NODE (nat44_ed_expire_worker_walk_node) = {
+  .function = nat44_ed_expire_worker_walk_fn,
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_INTERRUPT,
+  .name = "nat44-ed-expire-worker-walk",
+};
+
+/**
+ * @brief Centralized process driving per worker expire walk once a second
+ * and publishing the expiration rate.
+ */
+static uword
+nat44_ed_expire_walk_fn (vlib_main_t *vm, vlib_node_runtime_t *rt,
+			 vlib_frame_t *f)
+{
+  snat_main_t *sm = &snat_main;
+  vlib_main_t *worker_vm;
+  f64 now, last_time = vlib_time_now (vm);
+  u64 total, last_total = 0;
+  int i;
+
+  while (1)
+    {
+      vlib_process_wait_for_event_or_clock (vm, 1.0);
+      vlib_process_get_events (vm, 0);
+
+      if (!sm->enabled)
+	continue;
+
+      for (i = 0; i < vlib_get_n_threads (); i++)
+	{
+	  worker_vm = vlib_get_main_by_index (i);
+	  if (worker_vm)
+	    vlib_node_set_interrupt_pending (
+	      worker_vm, nat44_ed_expire_worker_walk_node.index);
+	}
+
+      now = vlib_time_now (vm);
+      total = vlib_get_simple_counter (&sm->expired_sessions, 0);
+      /* counter is zeroed on enable */
+      if (total < last_total)
+	last_total = 0;
+      vlib_stats_set_gauge (sm->expirations_per_second_gauge,
+			    (total - last_total) / (now - last_time));
+      last_total = total;
+      last_time = now;
+    }
+
+  return 0;
+}
+
+static void
+nat44_ed_create_expire_walk_process ()
+{
+  snat_main_t *sm = &snat_main;
+
+  if (sm->expire_walk_node_index)
+    return;
+  sm->expire_walk_node_index =
+    vlib_process_create (vlib_get_main (), "nat44-ed-expire-walk",
+			 nat44_ed_expire_walk_fn, 16 /* stack_bytes */);
+}
+
 static void
 nat44_ed_add_del_static_mapping_cb (ip4_main_t *im, uword opaque,
 				    u32 sw_if_index, ip4_address_t *address,
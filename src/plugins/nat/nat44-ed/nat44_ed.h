@@ -27,6 +27,7 @@
 #include <vppinfra/bihash_16_8.h>
 #include <vppinfra/hash.h>
 #include <vppinfra/dlist.h>
+#include <vppinfra/tw_timer_2t_1w_2048sl.h>
 #include <vppinfra/error.h>
 #include <vlibapi/api.h>
 
@@ -46,6 +47,14 @@
  */
 #define ED_USER_PORT_OFFSET 1024
 
+/* session expiry timers run on a single 2048 slot wheel with one second
+ * ticks, longer timeouts are re-armed when the timer fires */
+#define NAT44_ED_TIMER_MAX_TICKS 2047
+
+/* upper bound on timers expired by one worker walk, a capped walk
+ * re-interrupts itself until the backlog is drained */
+#define NAT44_ED_EXPIRE_MAX_PER_WALK 4096
+
 /* NAT buffer flags */
 #define SNAT_FLAG_HAIRPINNING (1 << 0)
 
@@ -305,11 +314,8 @@ typedef CLIB_PACKED(struct
   /* Flags */
   u32 flags;
 
-  /* head of LRU list in which this session is tracked */
-  u32 lru_head_index;
-  /* index in global LRU list */
-  u32 lru_index;
-  f64 last_lru_update;
+  /* expiry timer handle, ~0 if not running */
+  u32 timer_handle;
 
   /* Last heard timer */
   f64 last_heard;
@@ -455,13 +461,10 @@ typedef struct
   /* Pool of doubly-linked list elements */
   dlist_elt_t *list_pool;
 
-  /* LRU session list - head is stale, tail is fresh */
-  dlist_elt_t *lru_pool;
-  u32 tcp_trans_lru_head_index;
-  u32 tcp_estab_lru_head_index;
-  u32 udp_lru_head_index;
-  u32 icmp_lru_head_index;
-  u32 unk_proto_lru_head_index;
+  /* session expiry timer wheel, one tick per second */
+  tw_timer_wheel_2t_1w_2048sl_t timer_wheel;
+  /* expired timer handles, reused between walks */
+  u32 *expired_timers;
 
   /* NAT thread index */
   u32 snat_thread_index;
@@ -584,6 +587,8 @@ typedef struct snat_main_s
   vlib_simple_counter_main_t total_sessions;
   u32 max_cfg_sessions_gauge; /* Index of max configured sessions gauge in
 				 stats */
+  vlib_simple_counter_main_t expired_sessions;
+  u32 expirations_per_second_gauge;
 
 #define _(x) vlib_simple_counter_main_t x;
   struct
@@ -638,6 +643,9 @@ typedef struct snat_main_s
   /* nat44 plugin enabled */
   u8 enabled;
 
+  /* session expiry walk process node index */
+  u32 expire_walk_node_index;
+
   /* TCP session state machine table:
    *   first dimension is possible states
    *   second dimension is direction (in2out/out2in)
@@ -681,6 +689,7 @@ extern vlib_node_registration_t nat44_ed_out2in_node;
 extern vlib_node_registration_t snat_in2out_worker_handoff_node;
 extern vlib_node_registration_t snat_in2out_output_worker_handoff_node;
 extern vlib_node_registration_t snat_out2in_worker_handoff_node;
+extern vlib_node_registration_t nat44_ed_expire_worker_walk_node;
 
 /** \brief Check if SNAT session is created from static mapping.
     @param s SNAT session
@@ -929,6 +938,16 @@ void nat44_addresses_free (snat_address_t **addresses);
 
 void nat44_ed_sessions_clear ();
 
+/** \brief Expire sessions whose timers fired on the given thread.
+    Runs the wheel for every whole tick elapsed since its last run, at most
+    NAT44_ED_EXPIRE_MAX_PER_WALK timers at a time.
+    @param sm      snat global configuration data
+    @param thread_index thread index
+    @param now     current time
+    @return number of sessions deleted
+*/
+u32 nat44_ed_expire_sessions (snat_main_t *sm, u32 thread_index, f64 now);
+
 int nat44_ed_set_frame_queue_nelts (u32 frame_queue_nelts);
 
 void nat_6t_l3_l4_csum_calc (nat_6t_flow_t *f);
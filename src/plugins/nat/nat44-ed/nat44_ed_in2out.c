@@ -450,7 +450,11 @@ slow_path_ed (vlib_main_t *vm, snat_main_t *sm, vlib_buffer_t *b,
   if (PREDICT_FALSE
       (nat44_ed_maximum_sessions_exceeded (sm, rx_fib_index, thread_index)))
     {
-      if (!nat_lru_free_one (sm, thread_index, now))
+      /* reclaim the sessions expired by the elapsed ticks, bounded by the
+       * per walk cap */
+      nat44_ed_expire_sessions (sm, thread_index, now);
+      if (nat44_ed_maximum_sessions_exceeded (sm, rx_fib_index,
+					      thread_index))
 	{
 	  b->error = node->errors[NAT_IN2OUT_ED_ERROR_MAX_SESSIONS_EXCEEDED];
 	  nat_ipfix_logging_max_sessions (thread_index,
@@ -731,8 +735,6 @@ nat_not_translate_output_feature_fwd (snat_main_t * sm, ip4_header_t * ip,
 	  nat44_session_update_counters (s, now,
 					 vlib_buffer_length_in_chain (vm, b),
 					 thread_index);
-	  /* Per-user LRU list maintenance */
-	  nat44_session_update_lru (sm, s, thread_index);
 	  return 1;
 	}
       else
@@ -892,8 +894,6 @@ out:
       /* Accounting */
       nat44_session_update_counters (
 	s, now, vlib_buffer_length_in_chain (vm, b), thread_index);
-      /* Per-user LRU list maintenance */
-      nat44_session_update_lru (sm, s, thread_index);
     }
   *s_p = s;
   return next;
@@ -1027,8 +1027,6 @@ nat44_ed_in2out_slowpath_unknown_proto (snat_main_t *sm, vlib_buffer_t *b,
   /* Accounting */
   nat44_session_update_counters (s, now, vlib_buffer_length_in_chain (vm, b),
 				 thread_index);
-  /* Per-user LRU list maintenance */
-  nat44_session_update_lru (sm, s, thread_index);
 
   return s;
 }
@@ -1282,8 +1280,6 @@ nat44_ed_in2out_fast_path_node_fn_inline (vlib_main_t *vm,
       nat44_session_update_counters (s0, now,
 				     vlib_buffer_length_in_chain (vm, b0),
 				     thread_index);
-      /* Per-user LRU list maintenance */
-      nat44_session_update_lru (sm, s0, thread_index);
 
     trace0:
       if (PREDICT_FALSE
@@ -1534,8 +1530,6 @@ nat44_ed_in2out_slow_path_node_fn_inline (vlib_main_t *vm,
       nat44_session_update_counters (s0, now,
 				     vlib_buffer_length_in_chain
 				     (vm, b0), thread_index);
-      /* Per-user LRU list maintenance */
-      nat44_session_update_lru (sm, s0, thread_index);
 
     trace0:
       if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
@@ -0,0 +1,393 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2026 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/classify/vnet_classify.h>
+
+/*
+ * Compare vnet_classify_lookup_n with the single packet lookup the nodes
+ * used before it: a frame of packets mixing hits and misses, starting in
+ * different tables of a chain, must end in the same table and entry, with
+ * the same next index, chain hits and per session hit counters.
+ */
+
+#define CLASSIFY_TEST_I(_cond, _comment, _args...)                            \
+  ({                                                                          \
+    int _evald = (_cond);                                                     \
+    if (!(_evald))                                                            \
+      {                                                                       \
+	fformat (stderr, "FAIL:%d: " _comment "\n", __LINE__, ##_args);       \
+      }                                                                       \
+    else                                                                      \
+      {                                                                       \
+	fformat (stderr, "PASS:%d: " _comment "\n", __LINE__, ##_args);       \
+      }                                                                       \
+    _evald;                                                                   \
+  })
+
+#define CLASSIFY_TEST(_cond, _comment, _args...)                              \
+  {                                                                           \
+    if (!CLASSIFY_TEST_I (_cond, _comment, ##_args))                          \
+      {                                                                       \
+	res = 1;                                                              \
+	goto done;                                                            \
+      }                                                                       \
+  }
+
+#define CLASSIFY_TEST_PKT_SIZE 80
+#define CLASSIFY_TEST_N_KEYS   8
+
+/* offsets into an untagged ethernet/ip4/udp header */
+#define CT_DST_MAC  0
+#define CT_PROTO    23
+#define CT_SRC_IP   26
+#define CT_DST_IP   30
+#define CT_DST_PORT 36
+
+typedef enum
+{
+  CT_TABLE_DST,
+  CT_TABLE_SRC,
+  CT_TABLE_L4,
+  CT_TABLE_MAC,
+  CT_N_TABLES,
+} classify_test_table_t;
+
+typedef struct
+{
+  u32 table_index[CT_N_TABLES];
+  /* single packet results */
+  u32 ref_table[VLIB_FRAME_SIZE];
+  u32 ref_hash[VLIB_FRAME_SIZE];
+  u32 ref_next[VLIB_FRAME_SIZE];
+  vnet_classify_entry_t *ref_entry[VLIB_FRAME_SIZE];
+  u32 ref_chain_hits;
+  /* reference hits of each session, by opaque index */
+  u32 *ref_hits;
+  vnet_classify_entry_t **entry_by_opaque;
+  u8 *pkts;
+} classify_test_main_t;
+
+static void
+ct_put_ip4 (u8 *p, u32 offset, u32 host_order)
+{
+  u32 a = clib_host_to_net_u32 (host_order);
+  clib_memcpy (p + offset, &a, sizeof (a));
+}
+
+static void
+ct_put_mac (u8 *p, u32 offset, u8 last)
+{
+  u8 mac[6] = { 0x02, 0, 0, 0, 0, last };
+  clib_memcpy (p + offset, mac, sizeof (mac));
+}
+
+static void
+ct_put_port (u8 *p, u32 offset, u16 port)
+{
+  u16 a = clib_host_to_net_u16 (port);
+  clib_memcpy (p + offset, &a, sizeof (a));
+}
+
+static int
+ct_add_table (classify_test_main_t *ctm, classify_test_table_t tt,
+	      u32 skip, u32 match, u32 *offsets, u32 *lens, u32 n_fields,
+	      u32 next_table_index, u32 miss_next_index)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+  u8 mask[5 * sizeof (u32x4)] = { 0 };
+  u32 i, skip_bytes = skip * sizeof (u32x4);
+
+  /* the table's mask starts after the skipped vectors */
+  for (i = 0; i < n_fields; i++)
+    clib_memset (mask + offsets[i] - skip_bytes, 0xff, lens[i]);
+
+  ctm->table_index[tt] = ~0;
+  return vnet_classify_add_del_table (
+    cm, mask, 64, 2 << 20, skip, match, next_table_index, miss_next_index,
+    &ctm->table_index[tt], 0, 0, 1 /* is_add */, 0);
+}
+
+static int
+ct_add_session (classify_test_main_t *ctm, classify_test_table_t tt, u8 *key,
+		u16 next_index, u32 opaque_index)
+{
+  return vnet_classify_add_del_session (&vnet_classify_main,
+					ctm->table_index[tt], key, next_index,
+					opaque_index, 0, 0, 0, 1 /* is_add */);
+}
+
+static int
+ct_setup (classify_test_main_t *ctm)
+{
+  u8 key[CLASSIFY_TEST_PKT_SIZE];
+  u32 offsets[2], lens[2], k;
+  int rv = 0;
+
+  /* chain: dst ip -> src ip -> proto and dst port; dst mac stands alone */
+  offsets[0] = CT_PROTO;
+  lens[0] = 1;
+  offsets[1] = CT_DST_PORT;
+  lens[1] = 2;
+  rv |= ct_add_table (ctm, CT_TABLE_L4, 1, 2, offsets, lens, 2, ~0, 12);
+  offsets[0] = CT_SRC_IP;
+  lens[0] = 4;
+  rv |= ct_add_table (ctm, CT_TABLE_SRC, 1, 1, offsets, lens, 1,
+		      ctm->table_index[CT_TABLE_L4], 11);
+  offsets[0] = CT_DST_IP;
+  rv |= ct_add_table (ctm, CT_TABLE_DST, 1, 2, offsets, lens, 1,
+		      ctm->table_index[CT_TABLE_SRC], 10);
+  offsets[0] = CT_DST_MAC;
+  lens[0] = 6;
+  rv |= ct_add_table (ctm, CT_TABLE_MAC, 0, 1, offsets, lens, 1, ~0, 13);
+  if (rv)
+    return rv;
+
+  /* every table matches the first keys, the packets use a few more */
+  for (k = 0; k < CLASSIFY_TEST_N_KEYS; k++)
+    {
+      clib_memset (key, 0, sizeof (key));
+      ct_put_ip4 (key, CT_DST_IP, 0x0a000000 + k);
+      rv |= ct_add_session (ctm, CT_TABLE_DST, key, 1, 100 + k);
+
+      clib_memset (key, 0, sizeof (key));
+      ct_put_ip4 (key, CT_SRC_IP, 0x14000000 + k);
+      rv |= ct_add_session (ctm, CT_TABLE_SRC, key, 2, 200 + k);
+
+      clib_memset (key, 0, sizeof (key));
+      key[CT_PROTO] = 17;
+      ct_put_port (key, CT_DST_PORT, 1000 + k);
+      rv |= ct_add_session (ctm, CT_TABLE_L4, key, 3, 300 + k);
+
+      clib_memset (key, 0, sizeof (key));
+      ct_put_mac (key, CT_DST_MAC, k);
+      rv |= ct_add_session (ctm, CT_TABLE_MAC, key, 4, 400 + k);
+    }
+  return rv;
+}
+
+static void
+ct_gen_pkts (classify_test_main_t *ctm, u32 *seed, u32 *first_table)
+{
+  u32 i, r;
+
+  for (i = 0; i < VLIB_FRAME_SIZE; i++)
+    {
+      u8 *p = ctm->pkts + i * CLASSIFY_TEST_PKT_SIZE;
+
+      /* a third of each field's values miss */
+      clib_memset (p, 0, CLASSIFY_TEST_PKT_SIZE);
+      r = random_u32 (seed);
+      ct_put_mac (p, CT_DST_MAC, r % 12);
+      ct_put_ip4 (p, CT_DST_IP, 0x0a000000 + (r >> 4) % 12);
+      ct_put_ip4 (p, CT_SRC_IP, 0x14000000 + (r >> 8) % 12);
+      p[CT_PROTO] = (r >> 12) & 1 ? 17 : 6;
+      ct_put_port (p, CT_DST_PORT, 1000 + (r >> 13) % 12);
+
+      switch ((r >> 20) % 8)
+	{
+	case 5:
+	  first_table[i] = ctm->table_index[CT_TABLE_SRC];
+	  break;
+	case 6:
+	  first_table[i] = ctm->table_index[CT_TABLE_MAC];
+	  break;
+	case 7:
+	  first_table[i] = ~0;
+	  break;
+	default:
+	  first_table[i] = ctm->table_index[CT_TABLE_DST];
+	}
+    }
+}
+
+/* what the nodes did before the batch lookup, one packet at a time */
+static void
+ct_lookup_one (classify_test_main_t *ctm, u32 i, u32 table_index, f64 now,
+	       int walk_chain)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+  u8 *h = ctm->pkts + i * CLASSIFY_TEST_PKT_SIZE;
+  vnet_classify_table_t *t;
+  vnet_classify_entry_t *e = 0;
+  u32 hash = 0, n_tables = 0;
+
+  while (table_index != ~0)
+    {
+      t = pool_elt_at_index (cm->tables, table_index);
+      hash = vnet_classify_hash_packet (t, h);
+      e = vnet_classify_find_entry (t, h, hash, now);
+      n_tables++;
+      if (e || !walk_chain || t->next_table_index == ~0)
+	break;
+      table_index = t->next_table_index;
+    }
+
+  ctm->ref_table[i] = table_index;
+  ctm->ref_hash[i] = hash;
+  ctm->ref_entry[i] = e;
+  ctm->ref_next[i] = ~0;
+  if (table_index == ~0)
+    return;
+
+  t = pool_elt_at_index (cm->tables, table_index);
+  ctm->ref_next[i] = e ? e->next_index : t->miss_next_index;
+  if (e)
+    {
+      ctm->ref_chain_hits += n_tables > 1;
+      vec_validate (ctm->ref_hits, e->opaque_index);
+      vec_validate (ctm->entry_by_opaque, e->opaque_index);
+      ctm->ref_hits[e->opaque_index]++;
+      ctm->entry_by_opaque[e->opaque_index] = e;
+    }
+}
+
+static int
+ct_compare (vlib_main_t *vm, classify_test_main_t *ctm, u32 *first_table,
+	    u32 n, int walk_chain, u32 *n_hits)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+  u32 table_indices[VLIB_FRAME_SIZE], hashes[VLIB_FRAME_SIZE];
+  vnet_classify_entry_t *entries[VLIB_FRAME_SIZE];
+  const u8 *headers[VLIB_FRAME_SIZE];
+  u32 i, chain_hits, next;
+  int res = 0;
+
+  ctm->ref_chain_hits = 0;
+  for (i = 0; i < n; i++)
+    ct_lookup_one (ctm, i, first_table[i], 1.0, walk_chain);
+
+  for (i = 0; i < n; i++)
+    {
+      headers[i] = ctm->pkts + i * CLASSIFY_TEST_PKT_SIZE;
+      table_indices[i] = first_table[i];
+    }
+  chain_hits = vnet_classify_lookup_n (headers, table_indices, hashes,
+				       entries, n, 2.0, walk_chain);
+
+  *n_hits = 0;
+  for (i = 0; i < n; i++)
+    {
+      vnet_classify_table_t *t;
+
+      if (table_indices[i] != ctm->ref_table[i] ||
+	  entries[i] != ctm->ref_entry[i])
+	break;
+      *n_hits += entries[i] != 0;
+      if (table_indices[i] == ~0)
+	continue;
+      t = pool_elt_at_index (cm->tables, table_indices[i]);
+      next = entries[i] ? entries[i]->next_index : t->miss_next_index;
+      if (hashes[i] != ctm->ref_hash[i] || next != ctm->ref_next[i])
+	break;
+    }
+  CLASSIFY_TEST (i == n, "%u packets, walk chain %d: same table, entry, "
+			 "hash and next as one at a time", n, walk_chain);
+  CLASSIFY_TEST (chain_hits == ctm->ref_chain_hits,
+		 "%u chain hits, expected %u", chain_hits,
+		 ctm->ref_chain_hits);
+
+done:
+  return res;
+}
+
+static int
+classify_test_lookup_n (vlib_main_t *vm, unformat_input_t *input)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+  classify_test_main_t _ctm = { 0 }, *ctm = &_ctm;
+  u32 first_table[VLIB_FRAME_SIZE];
+  u32 seed = 0xdeadbeef, i, n_hits, n_misses;
+  int res = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "seed %u", &seed))
+	;
+      else
+	{
+	  vlib_cli_output (vm, "unknown input `%U'", format_unformat_error,
+			   input);
+	  return 1;
+	}
+    }
+
+  ctm->pkts = clib_mem_alloc_aligned (VLIB_FRAME_SIZE * CLASSIFY_TEST_PKT_SIZE,
+				      CLIB_CACHE_LINE_BYTES);
+  for (i = 0; i < CT_N_TABLES; i++)
+    ctm->table_index[i] = ~0;
+
+  CLASSIFY_TEST (!ct_setup (ctm), "tables and sessions added");
+  ct_gen_pkts (ctm, &seed, first_table);
+
+  /* a full frame, then one the prefetch loops do not divide evenly */
+  CLASSIFY_TEST (!ct_compare (vm, ctm, first_table, VLIB_FRAME_SIZE, 1,
+			      &n_hits),
+		 "full frame");
+  n_misses = VLIB_FRAME_SIZE - n_hits;
+  CLASSIFY_TEST (n_hits > 0 && n_misses > 0 && ctm->ref_chain_hits > 0,
+		 "%u hits, %u misses and %u chain hits in the frame", n_hits,
+		 n_misses, ctm->ref_chain_hits);
+  CLASSIFY_TEST (!ct_compare (vm, ctm, first_table, 7, 1, &n_hits),
+		 "partial frame");
+
+  /* both lookups counted each hit once */
+  for (i = 0; i < vec_len (ctm->ref_hits); i++)
+    {
+      vnet_classify_entry_t *e;
+
+      if (!ctm->ref_hits[i])
+	continue;
+      e = ctm->entry_by_opaque[i];
+      if (e->hits != 2 * ctm->ref_hits[i])
+	break;
+    }
+  CLASSIFY_TEST (i == vec_len (ctm->ref_hits),
+		 "session hit counters agree with one at a time");
+
+  CLASSIFY_TEST (!ct_compare (vm, ctm, first_table, VLIB_FRAME_SIZE, 0,
+			      &n_hits),
+		 "full frame without walking the chains");
+
+done:
+  for (i = 0; i < CT_N_TABLES; i++)
+    if (ctm->table_index[i] != ~0)
+      vnet_classify_delete_table_index (cm, ctm->table_index[i], 0);
+  clib_mem_free (ctm->pkts);
+  vec_free (ctm->ref_hits);
+  vec_free (ctm->entry_by_opaque);
+
+  return res;
+}
+
+static clib_error_t *
+classify_test (vlib_main_t *vm, unformat_input_t *input,
+	       vlib_cli_command_t *cmd_arg)
+{
+  int res = 0;
+
+  if (unformat (input, "lookup-n"))
+    res = classify_test_lookup_n (vm, input);
+  else
+    return clib_error_return (0, "unknown input `%U'", format_unformat_error,
+			      input);
+
+  if (res)
+    return clib_error_return (0, "classify unit test failed");
+  return 0;
+}
+
+VLIB_CLI_COMMAND (classify_test_command, static) = {
+  .path = "test classify",
+  .short_help = "test classify lookup-n [seed <n>]",
+  .function = classify_test,
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
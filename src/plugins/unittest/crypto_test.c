@@ -17,6 +17,7 @@
 #include <vppinfra/cache.h>
 #include <vppinfra/error.h>
 #include <vnet/crypto/crypto.h>
+#include <vppinfra/crypto/sha2.h>
 #include <unittest/crypto/crypto.h>
 
 crypto_test_main_t crypto_test_main;
@@ -1019,13 +1020,156 @@ done:
   return err;
 }
 
+/*
+ * Engines may batch non-chained HMAC ops and process chained ones on the
+ * side, so submit a mix of both in one call, ending with a chained op, and
+ * compare each digest with the vppinfra implementation.
+ */
+static clib_error_t *
+test_crypto_hmac_mixed (vlib_main_t *vm, crypto_test_main_t *tm)
+{
+  static const struct
+  {
+    vnet_crypto_alg_t alg;
+    vnet_crypto_op_id_t op;
+    clib_sha2_type_t type;
+    u32 digest_len;
+  } algs[] = {
+    { VNET_CRYPTO_ALG_HMAC_SHA224, VNET_CRYPTO_OP_SHA224_HMAC, CLIB_SHA2_224,
+      SHA224_DIGEST_SIZE },
+    { VNET_CRYPTO_ALG_HMAC_SHA256, VNET_CRYPTO_OP_SHA256_HMAC, CLIB_SHA2_256,
+      SHA256_DIGEST_SIZE },
+  };
+  const u32 n_ops = 37;
+  vnet_crypto_main_t *cm = &crypto_main;
+  u8 key[20], data[512], digests[n_ops][SHA2_MAX_DIGEST_SIZE];
+  u8 ref[SHA2_MAX_DIGEST_SIZE];
+  vnet_crypto_op_t *ops = 0, *op;
+  vnet_crypto_op_chunk_t *chunks = 0, ch = {};
+  clib_error_t *err = 0;
+  u32 seed = 0x12345678;
+
+  for (u32 i = 0; i < sizeof (key); i++)
+    key[i] = random_u32 (&seed);
+  for (u32 i = 0; i < sizeof (data); i++)
+    data[i] = random_u32 (&seed);
+
+  /* the handler vectors only exist once an engine registered */
+  for (u32 a = 0; a < ARRAY_LEN (algs); a++)
+    if (vec_len (cm->chained_ops_handlers) <= algs[a].op ||
+	!cm->ops_handlers[algs[a].op] ||
+	!cm->chained_ops_handlers[algs[a].op])
+      return clib_error_return (0, "%U: no crypto handler",
+				format_vnet_crypto_alg, algs[a].alg);
+
+  for (u32 a = 0; a < ARRAY_LEN (algs) && !err; a++)
+    {
+      u32 key_index = vnet_crypto_key_add (vm, algs[a].alg, key, sizeof (key));
+      u32 digest_len = algs[a].digest_len;
+
+      for (int check = 0; check < 2 && !err; check++)
+	{
+	  u32 n_ok, n_exp = n_ops;
+
+	  vec_validate_aligned (ops, n_ops - 1, CLIB_CACHE_LINE_BYTES);
+	  vec_reset_length (chunks);
+
+	  for (u32 i = 0; i < n_ops; i++)
+	    {
+	      u32 len = 1 + (i * 37) % (sizeof (data) - 1);
+
+	      op = ops + i;
+	      vnet_crypto_op_init (op, algs[a].op);
+	      op->key_index = key_index;
+	      op->digest = digests[i];
+	      op->digest_len = digest_len;
+	      op->user_data = len;
+
+	      /* every third op is chained, including the last one */
+	      if (i % 3 == 0 || i == n_ops - 1)
+		{
+		  op->flags |= VNET_CRYPTO_OP_FLAG_CHAINED_BUFFERS;
+		  op->chunk_index = vec_len (chunks);
+		  ch.src = data;
+		  ch.len = len / 2;
+		  vec_add1 (chunks, ch);
+		  ch.src = data + len / 2;
+		  ch.len = len - len / 2;
+		  vec_add1 (chunks, ch);
+		  op->n_chunks = 2;
+		}
+	      else
+		{
+		  op->src = data;
+		  op->len = len;
+		}
+
+	      if (check)
+		{
+		  op->flags |= VNET_CRYPTO_OP_FLAG_HMAC_CHECK;
+		  clib_hmac_sha2 (algs[a].type, key, sizeof (key), data, len,
+				  digests[i]);
+		  /* corrupt one digest per lane batch */
+		  if (i % 8 == 5)
+		    {
+		      digests[i][0] ^= 1;
+		      n_exp--;
+		    }
+		}
+	      else
+		clib_memset (digests[i], 0, sizeof (digests[i]));
+	    }
+
+	  n_ok = vnet_crypto_process_chained_ops (vm, ops, chunks, n_ops);
+
+	  for (u32 i = 0; i < n_ops && !err; i++)
+	    {
+	      vnet_crypto_op_status_t exp = VNET_CRYPTO_OP_STATUS_COMPLETED;
+
+	      op = ops + i;
+	      if (check && i % 8 == 5)
+		exp = VNET_CRYPTO_OP_STATUS_FAIL_BAD_HMAC;
+	      if (op->status != exp)
+		err = clib_error_return (0, "%U op %u: status %U expected %U",
+					 format_vnet_crypto_alg, algs[a].alg, i,
+					 format_vnet_crypto_op_status,
+					 op->status, format_vnet_crypto_op_status,
+					 exp);
+	      else if (!check)
+		{
+		  clib_hmac_sha2 (algs[a].type, key, sizeof (key), data,
+				  op->user_data, ref);
+		  if (memcmp (ref, digests[i], digest_len))
+		    err = clib_error_return (0, "%U op %u: bad digest",
+					     format_vnet_crypto_alg,
+					     algs[a].alg, i);
+		}
+	    }
+
+	  if (!err && n_ok != n_exp)
+	    err = clib_error_return (0, "%U: %u ops completed, expected %u",
+				     format_vnet_crypto_alg, algs[a].alg, n_ok,
+				     n_exp);
+	}
+
+      vnet_crypto_key_del (vm, key_index);
+    }
+
+  if (!err)
+    vlib_cli_output (vm, "mixed chained and non-chained HMAC ops: OK");
+
+  vec_free (ops);
+  vec_free (chunks);
+  return err;
+}
+
 static clib_error_t *
 test_crypto_command_fn (vlib_main_t * vm,
 			unformat_input_t * input, vlib_cli_command_t * cmd)
 {
   crypto_test_main_t *tm = &crypto_test_main;
   unittest_crypto_test_registration_t *tr;
-  int is_perf = 0;
+  int is_perf = 0, is_hmac_mixed = 0;
 
   tr = tm->test_registrations;
   memset (tm, 0, sizeof (crypto_test_main_t));
@@ -1041,6 +1185,8 @@ test_crypto_command_fn (vlib_main_t * vm,
       else
 	if (unformat (input, "perf %U", unformat_vnet_crypto_alg, &tm->alg))
 	is_perf = 1;
+      else if (unformat (input, "hmac-mixed"))
+	is_hmac_mixed = 1;
       else if (unformat (input, "buffers %u", &tm->n_buffers))
 	;
       else if (unformat (input, "rounds %u", &tm->rounds))
@@ -1054,6 +1200,8 @@ test_crypto_command_fn (vlib_main_t * vm,
 				  format_unformat_error, input);
     }
 
+  if (is_hmac_mixed)
+    return test_crypto_hmac_mixed (vm, tm);
   if (is_perf)
     return test_crypto_perf (vm, tm);
   else
@@ -1064,7 +1212,7 @@ test_crypto_command_fn (vlib_main_t * vm,
 VLIB_CLI_COMMAND (test_crypto_command, static) =
 {
   .path = "test crypto",
-  .short_help = "test crypto",
+  .short_help = "test crypto [verbose|detail] [hmac-mixed] [perf <alg>]",
   .function = test_crypto_command_fn,
 };
 /* *INDENT-ON* */
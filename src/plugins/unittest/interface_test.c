@@ -14,6 +14,7 @@
  */
 
 #include <vnet/vnet.h>
+#include <vnet/interface/rx_queue_funcs.h>
 
 static clib_error_t *
 test_interface_command_fn (vlib_main_t * vm,
@@ -66,6 +67,110 @@ VLIB_CLI_COMMAND (test_interface_command, static) =
 };
 /* *INDENT-ON* */
 
+#define RXQ_PLAN_TEST(_cond, _comment, _args...)                              \
+  {                                                                           \
+    if (!(_cond))                                                             \
+      {                                                                       \
+	fformat (stderr, "FAIL:%d: " _comment "\n", __LINE__, ##_args);       \
+	res = 1;                                                              \
+	goto done;                                                            \
+      }                                                                       \
+    fformat (stderr, "PASS:%d: " _comment "\n", __LINE__, ##_args);         \
+  }
+
+static vnet_hw_if_rxq_move_t *
+rxq_plan (vnet_hw_if_rxq_move_t *moves, u64 *queue_load, u32 *thread_of,
+	  u32 max_moves)
+{
+  u64 *thread_load = 0;
+  u32 qi;
+
+  /* threads 1 and 2 are the workers, 0 is main and never gets a queue */
+  vec_validate (thread_load, 2);
+  for (qi = 0; qi < vec_len (queue_load); qi++)
+    thread_load[qi < 2 ? 1 : 2] += queue_load[qi];
+
+  moves = vnet_hw_if_rx_rebalance_plan (moves, thread_load, queue_load,
+					thread_of, 1, 2, 20, max_moves);
+  vec_free (thread_load);
+  return moves;
+}
+
+static clib_error_t *
+test_interface_rx_rebalance_command_fn (vlib_main_t *vm,
+					unformat_input_t *input,
+					vlib_cli_command_t *cmd)
+{
+  vnet_hw_if_rxq_move_t *moves = 0;
+  u64 *queue_load = 0;
+  u32 *thread_of = 0;
+  int res = 0;
+
+  /* q0 and q1 on worker 1, q2 on worker 2 */
+  vec_add1 (queue_load, 60);
+  vec_add1 (queue_load, 30);
+  vec_add1 (queue_load, 10);
+
+  vec_add1 (thread_of, 1);
+  vec_add1 (thread_of, 1);
+  vec_add1 (thread_of, 2);
+  moves = rxq_plan (moves, queue_load, thread_of, 4);
+  RXQ_PLAN_TEST (vec_len (moves) == 1, "90/10 plans one move");
+  RXQ_PLAN_TEST (moves[0].queue_index == 1 && moves[0].from == 1 &&
+		   moves[0].to == 2 && moves[0].load == 30,
+		 "closest to half the gap moves 1 -> 2");
+  RXQ_PLAN_TEST (thread_of[1] == 2, "plan tracks the new placement");
+
+  /* the queue its driver balances loads worker 1 but stays put */
+  thread_of[0] = 1;
+  thread_of[1] = ~0;
+  thread_of[2] = 2;
+  moves = rxq_plan (moves, queue_load, thread_of, 1);
+  RXQ_PLAN_TEST (vec_len (moves) == 1 && moves[0].queue_index == 0,
+		 "driver balanced queue is skipped");
+
+  thread_of[0] = 1;
+  thread_of[1] = ~0;
+  thread_of[2] = 2;
+  moves = rxq_plan (moves, queue_load, thread_of, 4);
+  RXQ_PLAN_TEST (vec_len (moves) == 2 && moves[1].queue_index == 2 &&
+		   moves[1].from == 2 && moves[1].to == 1,
+		 "second move evens out the first one");
+
+  thread_of[0] = thread_of[1] = ~0;
+  thread_of[2] = 2;
+  moves = rxq_plan (moves, queue_load, thread_of, 4);
+  RXQ_PLAN_TEST (vec_len (moves) == 0, "nothing movable, no plan");
+
+  /* 55/45 is within a 20% threshold */
+  queue_load[0] = 30;
+  queue_load[1] = 25;
+  queue_load[2] = 45;
+  thread_of[0] = thread_of[1] = 1;
+  thread_of[2] = 2;
+  moves = rxq_plan (moves, queue_load, thread_of, 4);
+  RXQ_PLAN_TEST (vec_len (moves) == 0, "balanced workers, no plan");
+
+  vec_reset_length (queue_load);
+  moves = rxq_plan (moves, queue_load, thread_of, 4);
+  RXQ_PLAN_TEST (vec_len (moves) == 0, "idle workers, no plan");
+
+done:
+  vec_free (moves);
+  vec_free (queue_load);
+  vec_free (thread_of);
+
+  if (res)
+    return clib_error_return (0, "rx-rebalance unit test failed");
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_interface_rx_rebalance_command, static) = {
+  .path = "test interface rx-rebalance",
+  .short_help = "test interface rx-rebalance",
+  .function = test_interface_rx_rebalance_command_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -0,0 +1,430 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2024 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/ip/ip.h>
+#include <vnet/ip/ip4_mtrie.h>
+#include <vnet/ip/ip4_poptrie.h>
+#include <vnet/fib/ip4_fib.h>
+#include <vnet/dpo/drop_dpo.h>
+
+/*
+ * Compare the ip4 lookup engines, 16-8-8 mtrie, 8-8-8-8 mtrie and poptrie,
+ * on the same random route set: check they agree with each other and with
+ * a brute force longest prefix match, then measure lookup cost and memory.
+ * Then switch a FIB table between mtrie and poptrie forwarding and check
+ * its lookups against the table's own longest prefix match.
+ */
+
+#define LPM_TEST_I(_cond, _comment, _args...)                                 \
+  ({                                                                          \
+    int _evald = (_cond);                                                     \
+    if (!(_evald))                                                            \
+      {                                                                       \
+	fformat (stderr, "FAIL:%d: " _comment "\n", __LINE__, ##_args);       \
+      }                                                                       \
+    else                                                                      \
+      {                                                                       \
+	fformat (stderr, "PASS:%d: " _comment "\n", __LINE__, ##_args);       \
+      }                                                                       \
+    _evald;                                                                   \
+  })
+
+#define LPM_TEST(_cond, _comment, _args...)                                   \
+  {                                                                           \
+    if (!LPM_TEST_I (_cond, _comment, ##_args))                               \
+      {                                                                       \
+	res = 1;                                                              \
+	goto done;                                                            \
+      }                                                                       \
+  }
+
+typedef struct
+{
+  u32 addr; /* host order */
+  u32 len;
+  u32 adj;
+} ip4_lpm_test_route_t;
+
+typedef struct
+{
+  ip4_mtrie_16_t *m16;
+  ip4_mtrie_8_t m8;
+  ip4_poptrie_t pt;
+  ip4_lpm_test_route_t *routes;
+  uword *route_by_prefix;
+} ip4_lpm_test_main_t;
+
+static_always_inline uword
+ip4_lpm_test_key (u32 addr, u32 len)
+{
+  return ((u64) addr << 6) | len;
+}
+
+static_always_inline u32
+ip4_lpm_test_mask (u32 len)
+{
+  return len ? ~0 << (32 - len) : 0;
+}
+
+static u32
+ip4_lpm_test_lookup_16 (ip4_lpm_test_main_t *tm, const ip4_address_t *a)
+{
+  ip4_mtrie_leaf_t leaf;
+
+  leaf = ip4_mtrie_16_lookup_step_one (tm->m16, a);
+  leaf = ip4_mtrie_16_lookup_step (leaf, a, 2);
+  leaf = ip4_mtrie_16_lookup_step (leaf, a, 3);
+
+  return ip4_mtrie_leaf_get_adj_index (leaf);
+}
+
+static u32
+ip4_lpm_test_lookup_8 (ip4_lpm_test_main_t *tm, const ip4_address_t *a)
+{
+  ip4_mtrie_leaf_t leaf;
+
+  leaf = ip4_mtrie_8_lookup_step_one (&tm->m8, a);
+  leaf = ip4_mtrie_8_lookup_step (leaf, a, 1);
+  leaf = ip4_mtrie_8_lookup_step (leaf, a, 2);
+  leaf = ip4_mtrie_8_lookup_step (leaf, a, 3);
+
+  return ip4_mtrie_leaf_get_adj_index (leaf);
+}
+
+/* longest prefix match by probing the prefix DB once per length */
+static ip4_lpm_test_route_t *
+ip4_lpm_test_lookup_ref (ip4_lpm_test_main_t *tm, u32 addr, u32 max_len)
+{
+  uword *p;
+  i32 len;
+
+  for (len = max_len; len > 0; len--)
+    {
+      p = hash_get (tm->route_by_prefix,
+		    ip4_lpm_test_key (addr & ip4_lpm_test_mask (len), len));
+      if (p)
+	return vec_elt_at_index (tm->routes, p[0]);
+    }
+
+  return 0;
+}
+
+static int
+ip4_lpm_test_verify (vlib_main_t *vm, ip4_lpm_test_main_t *tm, u32 *addrs)
+{
+  ip4_lpm_test_route_t *r;
+  ip4_address_t a;
+  u32 i, ref, v16, v8, vpt;
+
+  for (i = 0; i < vec_len (addrs); i++)
+    {
+      a.as_u32 = clib_host_to_net_u32 (addrs[i]);
+      r = ip4_lpm_test_lookup_ref (tm, addrs[i], 32);
+      ref = r ? r->adj : 0;
+
+      v16 = ip4_lpm_test_lookup_16 (tm, &a);
+      v8 = ip4_lpm_test_lookup_8 (tm, &a);
+      vpt = ip4_poptrie_lookup (&tm->pt, &a);
+
+      if (v16 != ref || v8 != ref || vpt != ref)
+	{
+	  vlib_cli_output (vm,
+			   "%U: expected %u, mtrie-16 %u, mtrie-8 %u, "
+			   "poptrie %u",
+			   format_ip4_address, &a, ref, v16, v8, vpt);
+	  return 1;
+	}
+    }
+
+  return 0;
+}
+
+static void
+ip4_lpm_test_del (ip4_lpm_test_main_t *tm, ip4_lpm_test_route_t *r)
+{
+  ip4_lpm_test_route_t *cover;
+  ip4_address_t a;
+  u32 cover_len, cover_adj;
+
+  a.as_u32 = clib_host_to_net_u32 (r->addr);
+  hash_unset (tm->route_by_prefix, ip4_lpm_test_key (r->addr, r->len));
+
+  cover = ip4_lpm_test_lookup_ref (tm, r->addr, r->len - 1);
+  cover_len = cover ? cover->len : 0;
+  cover_adj = cover ? cover->adj : 0;
+
+  ip4_mtrie_16_route_del (tm->m16, &a, r->len, r->adj, cover_len, cover_adj);
+  ip4_mtrie_8_route_del (&tm->m8, &a, r->len, r->adj, cover_len, cover_adj);
+  ip4_poptrie_route_del (&tm->pt, &a, r->len);
+}
+
+static int
+ip4_lpm_test_table_verify (vlib_main_t *vm, u32 fib_index, u32 *addrs)
+{
+  ip4_address_t a;
+  u32 i, ref, fwd;
+
+  for (i = 0; i < vec_len (addrs); i++)
+    {
+      a.as_u32 = clib_host_to_net_u32 (addrs[i]);
+      ref = ip4_fib_table_lookup_lb (ip4_fib_get (fib_index), &a);
+      fwd = ip4_fib_forwarding_lookup (fib_index, &a);
+
+      if (ref != fwd)
+	{
+	  vlib_cli_output (vm, "%U: expected %u, forwarding %u",
+			   format_ip4_address, &a, ref, fwd);
+	  return 1;
+	}
+    }
+
+  return 0;
+}
+
+static void
+ip4_lpm_test_table_route (u32 fib_index, ip4_lpm_test_route_t *r, int is_add)
+{
+  fib_prefix_t pfx = {
+    .fp_proto = FIB_PROTOCOL_IP4,
+    .fp_len = r->len,
+    .fp_addr.ip4.as_u32 = clib_host_to_net_u32 (r->addr),
+  };
+
+  if (is_add)
+    fib_table_entry_special_dpo_add (fib_index, &pfx, FIB_SOURCE_SPECIAL,
+				     FIB_ENTRY_FLAG_EXCLUSIVE,
+				     drop_dpo_get (DPO_PROTO_IP4));
+  else
+    fib_table_entry_special_remove (fib_index, &pfx, FIB_SOURCE_SPECIAL);
+}
+
+/*
+ * Each route is its own load-balance, so the lookups tell them apart.
+ */
+static int
+ip4_lpm_test_table (vlib_main_t *vm, ip4_lpm_test_main_t *tm, u32 *addrs,
+		    u32 n_routes)
+{
+  u32 fib_index, i, table_id = 0x4c504d;
+  ip4_fib_t *fib;
+  int res = 0;
+
+  n_routes = clib_min (n_routes, vec_len (tm->routes));
+  fib_index = fib_table_find_or_create_and_lock (FIB_PROTOCOL_IP4, table_id,
+						 FIB_SOURCE_CLI);
+
+  for (i = 0; i < n_routes / 2; i++)
+    ip4_lpm_test_table_route (fib_index, tm->routes + i, 1);
+
+  LPM_TEST (!ip4_lpm_test_table_verify (vm, fib_index, addrs),
+	    "table with %u routes forwards with the mtrie", n_routes / 2);
+
+  ip4_fib_table_set_poptrie (fib_index, 1);
+  fib = ip4_fib_get (fib_index);
+  LPM_TEST (NULL != fib->poptrie, "table forwards with the poptrie");
+  /* the special routes go too, so no ply is left below the root */
+  LPM_TEST (ip4_mtrie_memory_usage (&fib->mtrie) == sizeof (fib->mtrie),
+	    "mtrie emptied");
+  LPM_TEST (!ip4_lpm_test_table_verify (vm, fib_index, addrs),
+	    "lookups agree after switching to the poptrie");
+
+  /* updates while forwarding with the poptrie */
+  for (; i < n_routes; i++)
+    ip4_lpm_test_table_route (fib_index, tm->routes + i, 1);
+  for (i = 0; i < n_routes; i += 3)
+    ip4_lpm_test_table_route (fib_index, tm->routes + i, 0);
+
+  LPM_TEST (!ip4_lpm_test_table_verify (vm, fib_index, addrs),
+	    "lookups agree after poptrie updates");
+
+  ip4_fib_table_set_poptrie (fib_index, 0);
+  fib = ip4_fib_get (fib_index);
+  LPM_TEST (NULL == fib->poptrie, "table forwards with the mtrie");
+  LPM_TEST (!ip4_lpm_test_table_verify (vm, fib_index, addrs),
+	    "lookups agree after switching back to the mtrie");
+
+done:
+  for (i = 0; i < n_routes; i++)
+    ip4_lpm_test_table_route (fib_index, tm->routes + i, 0);
+  ip4_fib_table_set_poptrie (fib_index, 0);
+  fib_table_unlock (fib_index, FIB_PROTOCOL_IP4, FIB_SOURCE_CLI);
+
+  return res;
+}
+
+static int
+ip4_lpm_test_run (vlib_main_t *vm, unformat_input_t *input)
+{
+  ip4_lpm_test_main_t _tm = {}, *tm = &_tm;
+  u32 n_routes = 100000, n_lookups = 1 << 20, seed = 0xdeadbeef;
+  u32 i, n, *addrs = 0, *order = 0, sum;
+  ip4_lpm_test_route_t *r;
+  ip4_address_t a;
+  u64 t0, t1;
+  f64 dt16, dt8, dtpt;
+  int res = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "routes %u", &n_routes))
+	;
+      else if (unformat (input, "lookups %u", &n_lookups))
+	;
+      else if (unformat (input, "seed %u", &seed))
+	;
+      else
+	{
+	  vlib_cli_output (vm, "parse error: '%U'", format_unformat_error,
+			   input);
+	  return -1;
+	}
+    }
+
+  tm->m16 = clib_mem_alloc_aligned (sizeof (*tm->m16), CLIB_CACHE_LINE_BYTES);
+  ip4_mtrie_16_init (tm->m16);
+  ip4_mtrie_8_init (&tm->m8);
+  ip4_poptrie_init (&tm->pt);
+  tm->route_by_prefix = hash_create (0, sizeof (uword));
+
+  /* mostly /24s, the rest /8 to /23, as in an internet routing table */
+  while (vec_len (tm->routes) < n_routes)
+    {
+      ip4_lpm_test_route_t route;
+      u32 rnd = random_u32 (&seed);
+
+      route.len = (rnd & 3) ? 24 : 8 + (rnd >> 28);
+      route.addr = random_u32 (&seed) & ip4_lpm_test_mask (route.len);
+      route.adj = 1 + (random_u32 (&seed) & ((1 << 20) - 1));
+
+      if (hash_get (tm->route_by_prefix,
+		    ip4_lpm_test_key (route.addr, route.len)))
+	continue;
+
+      hash_set (tm->route_by_prefix, ip4_lpm_test_key (route.addr, route.len),
+		vec_len (tm->routes));
+      vec_add1 (tm->routes, route);
+    }
+
+  vec_foreach (r, tm->routes)
+    {
+      a.as_u32 = clib_host_to_net_u32 (r->addr);
+      ip4_mtrie_16_route_add (tm->m16, &a, r->len, r->adj);
+      ip4_mtrie_8_route_add (&tm->m8, &a, r->len, r->adj);
+      ip4_poptrie_route_add (&tm->pt, &a, r->len, r->adj);
+    }
+
+  /* half random addresses, half inside the routes */
+  for (i = 0; i < n_lookups; i++)
+    {
+      u32 addr = random_u32 (&seed);
+      if (i & 1)
+	{
+	  r = vec_elt_at_index (tm->routes, addr % vec_len (tm->routes));
+	  addr = r->addr | (addr & ~ip4_lpm_test_mask (r->len));
+	}
+      vec_add1 (addrs, addr);
+    }
+
+  LPM_TEST (!ip4_lpm_test_verify (vm, tm, addrs),
+	    "%u routes, %u lookups agree", n_routes, n_lookups);
+
+  LPM_TEST (!ip4_lpm_test_table (vm, tm, addrs, n_routes / 10),
+	    "fib table mtrie/poptrie switch");
+
+  for (i = 0; i < n_lookups; i++)
+    addrs[i] = clib_host_to_net_u32 (addrs[i]);
+
+  sum = 0;
+  t0 = clib_cpu_time_now ();
+  for (i = 0; i < n_lookups; i++)
+    sum += ip4_lpm_test_lookup_16 (tm, (ip4_address_t *) (addrs + i));
+  t1 = clib_cpu_time_now ();
+  dt16 = (f64) (t1 - t0) / n_lookups;
+
+  t0 = clib_cpu_time_now ();
+  for (i = 0; i < n_lookups; i++)
+    sum += ip4_lpm_test_lookup_8 (tm, (ip4_address_t *) (addrs + i));
+  t1 = clib_cpu_time_now ();
+  dt8 = (f64) (t1 - t0) / n_lookups;
+
+  t0 = clib_cpu_time_now ();
+  for (i = 0; i < n_lookups; i++)
+    sum += ip4_poptrie_lookup (&tm->pt, (ip4_address_t *) (addrs + i));
+  t1 = clib_cpu_time_now ();
+  dtpt = (f64) (t1 - t0) / n_lookups;
+
+  vlib_cli_output (vm, "%u routes, %u lookups (checksum %x)", n_routes,
+		   n_lookups, sum);
+  vlib_cli_output (vm, "  %-10s %8.2f clocks/lookup, memory %U", "mtrie-16",
+		   dt16, format_memory_size,
+		   ip4_mtrie_16_memory_usage (tm->m16));
+  vlib_cli_output (vm, "  %-10s %8.2f clocks/lookup, memory %U", "mtrie-8",
+		   dt8, format_memory_size,
+		   ip4_mtrie_8_memory_usage (&tm->m8));
+  vlib_cli_output (vm, "  %-10s %8.2f clocks/lookup, %U", "poptrie", dtpt,
+		   format_ip4_poptrie, &tm->pt, 0);
+
+  for (i = 0; i < n_lookups; i++)
+    addrs[i] = clib_net_to_host_u32 (addrs[i]);
+
+  /* remove half the routes in random order, covers must be restored */
+  for (i = 0; i < vec_len (tm->routes); i++)
+    vec_add1 (order, i);
+  for (i = vec_len (order) - 1; i > 0; i--)
+    {
+      u32 j = random_u32 (&seed) % (i + 1);
+      u32 tmp = order[i];
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+
+  n = vec_len (order) / 2;
+  for (i = 0; i < n; i++)
+    ip4_lpm_test_del (tm, vec_elt_at_index (tm->routes, order[i]));
+
+  LPM_TEST (!ip4_lpm_test_verify (vm, tm, addrs),
+	    "lookups agree after %u deletes", n);
+
+  for (; i < vec_len (order); i++)
+    ip4_lpm_test_del (tm, vec_elt_at_index (tm->routes, order[i]));
+
+  LPM_TEST (!ip4_lpm_test_verify (vm, tm, addrs),
+	    "lookups agree on the empty table");
+
+done:
+  ip4_mtrie_16_free (tm->m16);
+  ip4_mtrie_8_free (&tm->m8);
+  ip4_poptrie_free (&tm->pt);
+  clib_mem_free (tm->m16);
+  hash_free (tm->route_by_prefix);
+  vec_free (tm->routes);
+  vec_free (addrs);
+  vec_free (order);
+
+  return res;
+}
+
+static clib_error_t *
+ip4_lpm_test (vlib_main_t *vm, unformat_input_t *input,
+	      vlib_cli_command_t *cmd_arg)
+{
+  if (ip4_lpm_test_run (vm, input))
+    return clib_error_return (0, "ip4 lpm unit test failed");
+  return 0;
+}
+
+VLIB_CLI_COMMAND (ip4_lpm_test_command, static) = {
+  .path = "test ip4-lpm",
+  .short_help = "test ip4-lpm [routes <n>] [lookups <n>] [seed <n>]",
+  .function = ip4_lpm_test,
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,433 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2024 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/ip/ip.h>
+#include <vnet/fib/ip6_fib.h>
+#include <vppinfra/mhash.h>
+
+/*
+ * Compare the ip6 forwarding lookups, linear and binary search on the
+ * prefix lengths, on the same random route set installed in two otherwise
+ * unused fib indices: check they agree, singly and four at a time, across
+ * adds, deletes and switching the search, then measure lookup cost.
+ */
+
+#define LPM_TEST_I(_cond, _comment, _args...)                                 \
+  ({                                                                          \
+    int _evald = (_cond);                                                     \
+    if (!(_evald))                                                            \
+      {                                                                       \
+	fformat (stderr, "FAIL:%d: " _comment "\n", __LINE__, ##_args);       \
+      }                                                                       \
+    else                                                                      \
+      {                                                                       \
+	fformat (stderr, "PASS:%d: " _comment "\n", __LINE__, ##_args);       \
+      }                                                                       \
+    _evald;                                                                   \
+  })
+
+#define LPM_TEST(_cond, _comment, _args...)                                   \
+  {                                                                           \
+    if (!LPM_TEST_I (_cond, _comment, ##_args))                               \
+      {                                                                       \
+	res = 1;                                                              \
+	goto done;                                                            \
+      }                                                                       \
+  }
+
+typedef struct
+{
+  ip6_address_t addr;
+  u32 len;
+  dpo_id_t dpo;
+  u8 installed;
+} ip6_lpm_test_route_t;
+
+typedef struct
+{
+  ip6_address_t addr;
+  u32 len;
+} ip6_lpm_test_key_t;
+
+typedef struct
+{
+  /* fib searched linearly, and by binary search */
+  u32 linear;
+  u32 binary;
+  ip6_lpm_test_route_t *routes;
+  u32 n_entries;
+} ip6_lpm_test_main_t;
+
+static int
+ip6_lpm_test_verify (vlib_main_t *vm, ip6_lpm_test_main_t *tm,
+		     ip6_address_t *addrs)
+{
+  index_t lb[4];
+  u32 i, j, ref;
+
+  for (i = 0; i + 4 <= vec_len (addrs); i += 4)
+    {
+      ip6_fib_table_fwding_lookup_x4 (tm->binary, tm->linear, tm->binary,
+				      tm->linear, addrs + i, addrs + i + 1,
+				      addrs + i + 2, addrs + i + 3, &lb[0],
+				      &lb[1], &lb[2], &lb[3]);
+
+      for (j = 0; j < 4; j++)
+	{
+	  ref = ip6_fib_table_fwding_lookup (tm->linear, addrs + i + j);
+
+	  if (ref != lb[j] ||
+	      ref != ip6_fib_table_fwding_lookup (tm->binary, addrs + i + j))
+	    {
+	      vlib_cli_output (
+		vm, "%U: linear %u, binary %u, x4 %u", format_ip6_address,
+		addrs + i + j, ref,
+		ip6_fib_table_fwding_lookup (tm->binary, addrs + i + j),
+		lb[j]);
+	      return 1;
+	    }
+	}
+    }
+
+  return 0;
+}
+
+static void
+ip6_lpm_test_add (ip6_lpm_test_main_t *tm, ip6_lpm_test_route_t *r)
+{
+  ip6_fib_table_fwding_dpo_update (tm->linear, &r->addr, r->len, &r->dpo);
+  ip6_fib_table_fwding_dpo_update (tm->binary, &r->addr, r->len, &r->dpo);
+  r->installed = 1;
+}
+
+static void
+ip6_lpm_test_del (ip6_lpm_test_main_t *tm, ip6_lpm_test_route_t *r)
+{
+  ip6_fib_table_fwding_dpo_remove (tm->linear, &r->addr, r->len, &r->dpo);
+  ip6_fib_table_fwding_dpo_remove (tm->binary, &r->addr, r->len, &r->dpo);
+  r->installed = 0;
+}
+
+static int
+ip6_lpm_test_count (clib_bihash_kv_24_8_t *kvp, void *arg)
+{
+  ip6_lpm_test_main_t *tm = arg;
+
+  if ((kvp->key[2] >> 32) == tm->binary)
+    tm->n_entries++;
+
+  return (BIHASH_WALK_CONTINUE);
+}
+
+static u32
+ip6_lpm_test_n_entries (ip6_lpm_test_main_t *tm)
+{
+  tm->n_entries = 0;
+  clib_bihash_foreach_key_value_pair_24_8 (
+    &ip6_fib_table[IP6_FIB_TABLE_FWDING].ip6_hash, ip6_lpm_test_count, tm);
+
+  return (tm->n_entries);
+}
+
+/*
+ * Nested /32, /48 and /64 routes over one address, and a second /48 so
+ * the set of lengths, and thus the markers, survive removing the first.
+ * The /48 is both a route and the marker for the /64; once removed its
+ * marker must lead to the /32.
+ */
+static int
+ip6_lpm_test_nested (vlib_main_t *vm, ip6_lpm_test_main_t *tm)
+{
+  ip6_lpm_test_route_t routes[4] = {}, *r;
+  ip6_address_t *addrs = 0, a;
+  u32 lens[4] = { 32, 48, 64, 48 }, i;
+  int res = 0;
+
+  for (i = 0; i < ARRAY_LEN (routes); i++)
+    {
+      r = &routes[i];
+      r->addr.as_u64[0] = clib_host_to_net_u64 (0x20010db800010002);
+      r->len = lens[i];
+      r->dpo.dpoi_index = 10 + i;
+    }
+  routes[3].addr.as_u16[2] = 0xffff;
+  for (i = 0; i < ARRAY_LEN (routes); i++)
+    ip6_address_mask (&routes[i].addr, &ip6_main.fib_masks[lens[i]]);
+
+  /* in the /64, in the /48 only, in the /32 only, other /48, outside */
+  a = routes[2].addr;
+  a.as_u64[1] = 1;
+  vec_add1 (addrs, a);
+  a.as_u16[3] ^= 1;
+  vec_add1 (addrs, a);
+  a.as_u16[2] ^= 1;
+  vec_add1 (addrs, a);
+  a = routes[3].addr;
+  a.as_u64[1] = 1;
+  vec_add1 (addrs, a);
+  a.as_u16[0] ^= 1;
+  vec_add1 (addrs, a);
+  /* the x4 check consumes groups of four */
+  while (vec_len (addrs) & 3)
+    vec_add1 (addrs, addrs[0]);
+
+  for (i = 0; i < ARRAY_LEN (routes); i++)
+    ip6_lpm_test_add (tm, &routes[i]);
+
+  LPM_TEST (!ip6_lpm_test_verify (vm, tm, addrs), "nested routes agree");
+  LPM_TEST (ip6_fib_table_fwding_lookup (tm->binary, &addrs[1]) == 11,
+	    "inner /48 matched");
+
+  ip6_lpm_test_del (tm, &routes[1]);
+  LPM_TEST (!ip6_lpm_test_verify (vm, tm, addrs),
+	    "nested routes agree after removing the inner /48");
+  LPM_TEST (ip6_fib_table_fwding_lookup (tm->binary, &addrs[1]) == 10,
+	    "/48 marker resolves to the /32");
+  LPM_TEST (ip6_fib_table_fwding_lookup (tm->binary, &addrs[0]) == 12,
+	    "/64 still matched");
+
+  ip6_lpm_test_add (tm, &routes[1]);
+  ip6_lpm_test_del (tm, &routes[0]);
+  LPM_TEST (!ip6_lpm_test_verify (vm, tm, addrs),
+	    "nested routes agree after removing the outer /32");
+  LPM_TEST (ip6_fib_table_fwding_lookup (tm->binary, &addrs[2]) == 1,
+	    "/32 only address falls back to the default");
+
+  ip6_lpm_test_del (tm, &routes[1]);
+  LPM_TEST (!ip6_lpm_test_verify (vm, tm, addrs),
+	    "nested routes agree after removing both");
+
+done:
+  for (i = 0; i < ARRAY_LEN (routes); i++)
+    {
+      if (routes[i].installed)
+	ip6_lpm_test_del (tm, &routes[i]);
+    }
+  vec_free (addrs);
+
+  return res;
+}
+
+static int
+ip6_lpm_test_run (vlib_main_t *vm, unformat_input_t *input)
+{
+  ip6_lpm_test_main_t _tm = {}, *tm = &_tm;
+  u32 n_routes = 100000, n_lookups = 1 << 20, seed = 0xdeadbeef;
+  u32 i, n, *order = 0, sum;
+  ip6_lpm_test_route_t *r, dflt = {};
+  ip6_address_t *addrs = 0;
+  mhash_t route_by_prefix = {};
+  index_t lb[4];
+  u64 t0, t1;
+  f64 dtl, dtb, dtx4;
+  int res = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "routes %u", &n_routes))
+	;
+      else if (unformat (input, "lookups %u", &n_lookups))
+	;
+      else if (unformat (input, "seed %u", &seed))
+	;
+      else
+	{
+	  vlib_cli_output (vm, "parse error: '%U'", format_unformat_error,
+			   input);
+	  return -1;
+	}
+    }
+
+  n_lookups = round_pow2 (n_lookups, 4);
+
+  /* two fib indices beyond those allocated */
+  tm->linear = pool_len (ip6_main.fibs) + 1;
+  tm->binary = tm->linear + 1;
+  mhash_init (&route_by_prefix, sizeof (uword), sizeof (ip6_lpm_test_key_t));
+
+  ip6_fib_table_set_binary_search (tm->binary, 1);
+
+  dflt.dpo.dpoi_index = 1;
+  ip6_lpm_test_add (tm, &dflt);
+
+  if (ip6_lpm_test_nested (vm, tm))
+    {
+      res = 1;
+      goto done;
+    }
+
+  /* 2000::/3, mostly /48s, some /32, /64 and /128 and the rest /16 to /47 */
+  while (vec_len (tm->routes) < n_routes)
+    {
+      ip6_lpm_test_route_t route = {};
+      ip6_lpm_test_key_t key = {};
+      u32 rnd = random_u32 (&seed);
+
+      switch (rnd >> 29)
+	{
+	case 4:
+	  route.len = 32;
+	  break;
+	case 5:
+	  route.len = 64;
+	  break;
+	case 6:
+	  route.len = 128;
+	  break;
+	case 7:
+	  route.len = 16 + ((rnd >> 8) & 31);
+	  break;
+	default:
+	  route.len = 48;
+	  break;
+	}
+
+      for (i = 0; i < 4; i++)
+	route.addr.as_u32[i] = random_u32 (&seed);
+      route.addr.as_u8[0] = 0x20 | (route.addr.as_u8[0] & 0x1f);
+      ip6_address_mask (&route.addr, &ip6_main.fib_masks[route.len]);
+      route.dpo.dpoi_index = 2 + (random_u32 (&seed) & ((1 << 20) - 1));
+
+      key.addr = route.addr;
+      key.len = route.len;
+      if (mhash_get (&route_by_prefix, &key))
+	continue;
+
+      mhash_set (&route_by_prefix, &key, vec_len (tm->routes), 0);
+      vec_add1 (tm->routes, route);
+    }
+
+  vec_foreach (r, tm->routes)
+    ip6_lpm_test_add (tm, r);
+
+  /* half random addresses, half inside the routes */
+  for (i = 0; i < n_lookups; i++)
+    {
+      ip6_address_t a;
+      u32 j;
+
+      for (j = 0; j < 4; j++)
+	a.as_u32[j] = random_u32 (&seed);
+      if (i & 1)
+	{
+	  r = vec_elt_at_index (tm->routes, a.as_u32[0] % vec_len (tm->routes));
+	  for (j = 0; j < 2; j++)
+	    a.as_u64[j] = r->addr.as_u64[j] |
+			  (a.as_u64[j] & ~ip6_main.fib_masks[r->len].as_u64[j]);
+	}
+      vec_add1 (addrs, a);
+    }
+
+  LPM_TEST (!ip6_lpm_test_verify (vm, tm, addrs),
+	    "%u routes, %u lookups agree", n_routes, n_lookups);
+
+  ip6_fib_table_set_binary_search (tm->binary, 0);
+  LPM_TEST (ip6_lpm_test_n_entries (tm) == n_routes + 1,
+	    "linear search has no markers");
+  LPM_TEST (!ip6_lpm_test_verify (vm, tm, addrs),
+	    "lookups agree after disabling binary search");
+
+  ip6_fib_table_set_binary_search (tm->binary, 1);
+  LPM_TEST (!ip6_lpm_test_verify (vm, tm, addrs),
+	    "lookups agree after enabling binary search");
+
+  sum = 0;
+  t0 = clib_cpu_time_now ();
+  for (i = 0; i < n_lookups; i++)
+    sum += ip6_fib_table_fwding_lookup (tm->linear, addrs + i);
+  t1 = clib_cpu_time_now ();
+  dtl = (f64) (t1 - t0) / n_lookups;
+
+  t0 = clib_cpu_time_now ();
+  for (i = 0; i < n_lookups; i++)
+    sum += ip6_fib_table_fwding_lookup (tm->binary, addrs + i);
+  t1 = clib_cpu_time_now ();
+  dtb = (f64) (t1 - t0) / n_lookups;
+
+  t0 = clib_cpu_time_now ();
+  for (i = 0; i < n_lookups; i += 4)
+    {
+      ip6_fib_table_fwding_lookup_x4 (tm->binary, tm->binary, tm->binary,
+				      tm->binary, addrs + i, addrs + i + 1,
+				      addrs + i + 2, addrs + i + 3, &lb[0],
+				      &lb[1], &lb[2], &lb[3]);
+      sum += lb[0] + lb[1] + lb[2] + lb[3];
+    }
+  t1 = clib_cpu_time_now ();
+  dtx4 = (f64) (t1 - t0) / n_lookups;
+
+  vlib_cli_output (
+    vm, "%u routes, %u prefix lengths, %u lookups (checksum %x)", n_routes,
+    vec_len (ip6_fib_table[IP6_FIB_TABLE_FWDING].prefix_lengths_in_search_order),
+    n_lookups, sum);
+  vlib_cli_output (vm, "  %-14s %8.2f clocks/lookup", "linear", dtl);
+  vlib_cli_output (vm, "  %-14s %8.2f clocks/lookup, %u entries with markers",
+		   "binary", dtb, ip6_lpm_test_n_entries (tm));
+  vlib_cli_output (vm, "  %-14s %8.2f clocks/lookup", "binary x4", dtx4);
+
+  /* remove half the routes in random order, markers must follow */
+  for (i = 0; i < vec_len (tm->routes); i++)
+    vec_add1 (order, i);
+  for (i = vec_len (order) - 1; i > 0; i--)
+    {
+      u32 j = random_u32 (&seed) % (i + 1);
+      u32 tmp = order[i];
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+
+  n = vec_len (order) / 2;
+  for (i = 0; i < n; i++)
+    ip6_lpm_test_del (tm, vec_elt_at_index (tm->routes, order[i]));
+
+  LPM_TEST (!ip6_lpm_test_verify (vm, tm, addrs),
+	    "lookups agree after %u deletes", n);
+
+  for (; i < vec_len (order); i++)
+    ip6_lpm_test_del (tm, vec_elt_at_index (tm->routes, order[i]));
+
+  LPM_TEST (!ip6_lpm_test_verify (vm, tm, addrs),
+	    "lookups agree on the empty table");
+  LPM_TEST (ip6_lpm_test_n_entries (tm) == 1, "no markers left");
+
+done:
+  vec_foreach (r, tm->routes)
+    {
+      if (r->installed)
+	ip6_lpm_test_del (tm, r);
+    }
+  ip6_lpm_test_del (tm, &dflt);
+  ip6_fib_table_set_binary_search (tm->binary, 0);
+
+  mhash_free (&route_by_prefix);
+  vec_free (tm->routes);
+  vec_free (addrs);
+  vec_free (order);
+
+  return res;
+}
+
+static clib_error_t *
+ip6_lpm_test (vlib_main_t *vm, unformat_input_t *input,
+	      vlib_cli_command_t *cmd_arg)
+{
+  if (ip6_lpm_test_run (vm, input))
+    return clib_error_return (0, "ip6 lpm unit test failed");
+  return 0;
+}
+
+VLIB_CLI_COMMAND (ip6_lpm_test_command, static) = {
+  .path = "test ip6-lpm",
+  .short_help = "test ip6-lpm [routes <n>] [lookups <n>] [seed <n>]",
+  .function = ip6_lpm_test,
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
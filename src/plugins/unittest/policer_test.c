@@ -26,6 +26,9 @@ policer_test (vlib_main_t *vm, unformat_input_t *input,
   double cpu_speed, cpu_ticks_per_byte;
   policer_result_e result, input_colour = POLICE_CONFORM;
   uint64_t policer_time;
+  policer_shard_t *shard = 0;
+  u32 len = PKT_LEN;
+  int sharded;
 
   policer_t *pol;
   vnet_policer_main_t *pm = &vnet_policer_main;
@@ -36,6 +39,7 @@ policer_test (vlib_main_t *vm, unformat_input_t *input,
       !unformat (input, "colour %u",
 		 &input_colour)) /* input colour if aware */
     return clib_error_return (0, "Policer test failed to parse params");
+  sharded = unformat (input, "sharded");
 
   total_bytes = (rate_kbps * burst) / 8;
   num_pkts = total_bytes / PKT_LEN;
@@ -46,11 +50,21 @@ policer_test (vlib_main_t *vm, unformat_input_t *input,
 
   pol = &pm->policers[policer_index];
 
+  if (sharded)
+    {
+      policer_shard (policer_index, true);
+      shard = &pm->shards[vm->thread_index][policer_index];
+    }
+
   for (i = 0; i < num_pkts; i++)
     {
       time += cpu_ticks_per_pkt;
       policer_time = ((uint64_t) time) >> POLICER_TICKS_PER_PERIOD_SHIFT;
-      result = vnet_police_packet (pol, PKT_LEN, input_colour, policer_time);
+      if (sharded)
+	vnet_police_packets (pol, shard, &len, &result, 1, input_colour,
+			     policer_time);
+      else
+	result = vnet_police_packet (pol, PKT_LEN, input_colour, policer_time);
       vlib_increment_combined_counter (&policer_counters[result], 0,
 				       policer_index, 1, PKT_LEN);
     }
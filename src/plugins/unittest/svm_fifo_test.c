@@ -2088,6 +2088,150 @@ sfifo_test_fifo_make_rcv_wnd_zero (vlib_main_t * vm, unformat_input_t * input)
   return 0;
 }
 
+/* Enqueue in 4kB writes, so fifo grows in 4kB chunks */
+static void
+sfifo_test_enqueue_chunks (svm_fifo_t *f, u8 *data, u32 len)
+{
+  u32 n_written = 0;
+
+  while (n_written < len)
+    n_written += svm_fifo_enqueue (f, clib_min (4096, len - n_written),
+				   data + n_written);
+}
+
+static int
+sfifo_test_fifo_splice (vlib_main_t *vm, unformat_input_t *input)
+{
+  int __clib_unused verbose = 0, fifo_size = 4096;
+  fifo_segment_main_t _fsm = { 0 }, *fsm = &_fsm;
+  u8 *test_data = 0, *data_buf = 0;
+  svm_fifo_t *sf, *df, *of;
+  svm_fifo_chunk_t *c;
+  fifo_segment_t *fs;
+  u32 data_len = 3 * 4096 + 1000;
+  int rv, i;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "verbose"))
+	verbose = 1;
+      else
+	{
+	  vlib_cli_output (vm, "parse error: '%U'", format_unformat_error,
+			   input);
+	  return -1;
+	}
+    }
+
+  fs = fifo_segment_prepare (fsm, "fifo-splice", 0);
+  sf = fifo_prepare (fs, fifo_size);
+  df = fifo_prepare (fs, fifo_size);
+  svm_fifo_set_size (sf, 4 * fifo_size);
+  svm_fifo_set_size (df, 4 * fifo_size);
+
+  validate_test_and_buf_vecs (&test_data, &data_buf, data_len);
+  for (i = 0; i < data_len; i++)
+    test_data[i] = i;
+
+  rv = svm_fifo_splice (df, sf, data_len);
+  SFIFO_TEST (rv == SVM_FIFO_EEMPTY, "splice from empty fifo %d", rv);
+
+  /*
+   * Misalign destination so first bytes must be copied
+   */
+  rv = svm_fifo_enqueue (df, 1000, test_data);
+  SFIFO_TEST (rv == 1000, "enqueued %d", rv);
+  rv = svm_fifo_dequeue (df, 1000, data_buf);
+  SFIFO_TEST (rv == 1000, "dequeued %d", rv);
+
+  sfifo_test_enqueue_chunks (sf, test_data, data_len);
+  SFIFO_TEST (svm_fifo_n_chunks (sf) == 4, "source has %u chunks",
+	      svm_fifo_n_chunks (sf));
+
+  /* Destination has 3096 bytes left in its first chunk, so first 3096
+   * bytes are copied and the source head is not at a chunk start */
+  rv = svm_fifo_splice (df, sf, data_len);
+  SFIFO_TEST (rv == data_len, "spliced %d", rv);
+  SFIFO_TEST (svm_fifo_is_sane (sf), "source should be sane");
+  SFIFO_TEST (svm_fifo_is_sane (df), "destination should be sane");
+  SFIFO_TEST (svm_fifo_is_empty (sf), "source should be empty");
+  rv = svm_fifo_max_dequeue (df);
+  SFIFO_TEST (rv == data_len, "destination has %d", rv);
+
+  rv = svm_fifo_dequeue (df, data_len, data_buf);
+  SFIFO_TEST (rv == data_len, "dequeued %d", rv);
+  rv = compare_data (data_buf, test_data, 0, data_len, (u32 *) &i);
+  SFIFO_TEST (rv == 0, "[%d] dequeued %u expected %u", i, data_buf[i],
+	      test_data[i]);
+
+  /*
+   * Fresh fifos, first source chunk is copied after which chunk
+   * boundaries are aligned and the rest of the chunks are moved
+   */
+  ft_fifo_free (fs, sf);
+  sf = fifo_prepare (fs, fifo_size);
+  svm_fifo_set_size (sf, 4 * fifo_size);
+  of = fifo_prepare (fs, fifo_size);
+  svm_fifo_set_size (of, 4 * fifo_size);
+
+  sfifo_test_enqueue_chunks (sf, test_data, data_len);
+  c = f_cptr (sf, f_start_cptr (sf)->next);
+
+  rv = svm_fifo_splice (of, sf, data_len);
+  SFIFO_TEST (rv == data_len, "spliced %d", rv);
+  SFIFO_TEST (f_cptr (of, f_start_cptr (of)->next) == c,
+	      "source chunk should be linked to destination");
+  SFIFO_TEST (f_start_cptr (sf) != c, "source chunk should be unlinked");
+  SFIFO_TEST (svm_fifo_is_sane (sf), "source should be sane");
+  SFIFO_TEST (svm_fifo_is_sane (of), "destination should be sane");
+  SFIFO_TEST (svm_fifo_is_empty (sf), "source should be empty");
+
+  rv = svm_fifo_max_dequeue (of);
+  SFIFO_TEST (rv == data_len, "destination has %d", rv);
+  rv = svm_fifo_dequeue (of, data_len, data_buf);
+  SFIFO_TEST (rv == data_len, "dequeued %d", rv);
+  rv = compare_data (data_buf, test_data, 0, data_len, (u32 *) &i);
+  SFIFO_TEST (rv == 0, "[%d] dequeued %u expected %u", i, data_buf[i],
+	      test_data[i]);
+
+  /* Moved chunks can be refilled by the destination's producer */
+  rv = svm_fifo_enqueue (of, data_len, test_data);
+  SFIFO_TEST (rv == data_len, "enqueued %d", rv);
+  rv = svm_fifo_dequeue (of, data_len, data_buf);
+  SFIFO_TEST (rv == data_len, "dequeued %d", rv);
+  rv = compare_data (data_buf, test_data, 0, data_len, (u32 *) &i);
+  SFIFO_TEST (rv == 0, "[%d] dequeued %u expected %u", i, data_buf[i],
+	      test_data[i]);
+  SFIFO_TEST (svm_fifo_is_sane (of), "destination should be sane");
+
+  /*
+   * Splice limited by destination free space
+   */
+  sfifo_test_enqueue_chunks (sf, test_data, data_len);
+  svm_fifo_set_size (of, 4096);
+  rv = svm_fifo_splice (of, sf, data_len);
+  SFIFO_TEST (rv == 4096, "spliced %d", rv);
+  rv = svm_fifo_splice (of, sf, data_len);
+  SFIFO_TEST (rv == SVM_FIFO_EFULL, "splice to full fifo %d", rv);
+  SFIFO_TEST (svm_fifo_max_dequeue (sf) == data_len - 4096,
+	      "source has %u", svm_fifo_max_dequeue (sf));
+  SFIFO_TEST (svm_fifo_is_sane (sf), "source should be sane");
+  SFIFO_TEST (svm_fifo_is_sane (of), "destination should be sane");
+
+  /*
+   * Cleanup
+   */
+
+  ft_fifo_free (fs, sf);
+  ft_fifo_free (fs, df);
+  ft_fifo_free (fs, of);
+  ft_fifo_segment_free (fsm, fs);
+  vec_free (test_data);
+  vec_free (data_buf);
+
+  return 0;
+}
+
 
 static fifo_segment_main_t segment_main;
 
@@ -2775,6 +2919,8 @@ svm_fifo_test (vlib_main_t * vm, unformat_input_t * input,
 	res = sfifo_test_fifo_indirect (vm, input);
       else if (unformat (input, "zero"))
 	res = sfifo_test_fifo_make_rcv_wnd_zero (vm, input);
+      else if (unformat (input, "splice"))
+	res = sfifo_test_fifo_splice (vm, input);
       else if (unformat (input, "segment"))
 	res = sfifo_test_fifo_segment (vm, input);
       else if (unformat (input, "all"))
@@ -2842,6 +2988,9 @@ svm_fifo_test (vlib_main_t * vm, unformat_input_t * input,
 	  if ((res = sfifo_test_fifo_make_rcv_wnd_zero (vm, input)))
 	    goto done;
 
+	  if ((res = sfifo_test_fifo_splice (vm, input)))
+	    goto done;
+
 	  str = "all";
 	  unformat_init_cstring (input, str);
 	  if ((res = sfifo_test_fifo_segment (vm, input)))
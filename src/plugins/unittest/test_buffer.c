@@ -318,6 +318,81 @@ VLIB_CLI_COMMAND (test_linearize_speed_command, static) = {
   .function = test_linearize_speed_fn,
 };
 
+static u32
+pool_free_buffers (vlib_buffer_pool_t *bp)
+{
+  vlib_buffer_pool_thread_t *bpt;
+  u32 n = vlib_buffer_pool_n_avail (bp);
+
+  vec_foreach (bpt, bp->threads)
+    n += bpt->n_cached;
+  return n;
+}
+
+static int
+pool_cache_test (vlib_main_t *vm)
+{
+  u8 bpi = vlib_buffer_pool_get_default_for_numa (vm, vm->numa_node);
+  vlib_buffer_pool_t *bp = vlib_get_buffer_pool (vm, bpi);
+  vlib_buffer_pool_thread_t *bpt = bp->threads + vm->thread_index;
+  const u32 min_sz = VLIB_BUFFER_POOL_PER_THREAD_CACHE_MIN_SZ;
+  u32 saved_cache_size = bpt->cache_size, n_free, n_refills, n_spills;
+  u32 *buffers = 0, n, i;
+  int ret = 0;
+
+  n_free = pool_free_buffers (bp);
+  n_refills = bpt->n_refills;
+  n_spills = bpt->n_spills;
+
+  /* refill and spill in turns - cache grows */
+  bpt->cache_size = min_sz;
+  bpt->last_op = VLIB_BUFFER_POOL_OP_NONE;
+  vec_validate (buffers, 4 * VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ - 1);
+  for (i = 0; i < 4; i++)
+    {
+      n = vlib_buffer_alloc (vm, buffers, min_sz - 1);
+      n += vlib_buffer_alloc (vm, buffers + n, min_sz - 1);
+      TEST (n == 2 * (min_sz - 1), "alloc %u buffers", n);
+      vlib_buffer_free (vm, buffers, n);
+    }
+  TEST (bpt->cache_size > min_sz, "cache grew to %u", bpt->cache_size);
+  TEST (bpt->n_refills > n_refills && bpt->n_spills > n_spills,
+	"%lu refills %lu spills", bpt->n_refills - n_refills,
+	bpt->n_spills - n_spills);
+
+  /* keep freeing buffers allocated in bulk - cache shrinks */
+  n = vlib_buffer_alloc (vm, buffers, vec_len (buffers));
+  TEST (n == vec_len (buffers), "bulk alloc %u buffers", n);
+  for (i = 0; i < n; i += min_sz)
+    vlib_buffer_free (vm, buffers + i, clib_min (min_sz, n - i));
+  TEST (bpt->cache_size == min_sz, "cache shrank to %u", bpt->cache_size);
+
+  TEST (pool_free_buffers (bp) == n_free, "%u free buffers, expected %u",
+	pool_free_buffers (bp), n_free);
+
+  ret = 1;
+err:
+  bpt->cache_size = saved_cache_size;
+  vec_free (buffers);
+  return ret;
+}
+
+static clib_error_t *
+test_pool_cache_fn (vlib_main_t *vm, unformat_input_t *input,
+		    vlib_cli_command_t *cmd)
+{
+  if (!pool_cache_test (vm))
+    return clib_error_return (0, "buffer pool cache test failed");
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_pool_cache_command, static) = {
+  .path = "test buffer-pool cache",
+  .short_help = "test buffer-pool cache",
+  .function = test_pool_cache_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -224,9 +224,272 @@ VLIB_CLI_COMMAND (test_vlib2_command, static) =
 };
 /* *INDENT-ON* */
 
+static u32 frame_queue_test_n_received;
 
+VLIB_NODE_FN (frame_queue_test_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  frame_queue_test_n_received += frame->n_vectors;
+  vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
+  return frame->n_vectors;
+}
+
+VLIB_REGISTER_NODE (frame_queue_test_node) = {
+  .name = "frame-queue-test",
+  .vector_size = sizeof (u32),
+  .type = VLIB_NODE_TYPE_INTERNAL,
+};
+
+static clib_error_t *
+test_frame_queue_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			     vlib_cli_command_t *cmd)
+{
+  static u32 fq_index = ~0;
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_frame_queue_main_t *fqm;
+  vlib_frame_queue_ring_t *r;
+  vlib_node_runtime_t *rt;
+  u32 *buffers = 0, n_buffers, n_enq, limit, i;
+  u16 *thread_indices = 0;
+  clib_error_t *error = 0;
+
+  if (fq_index == ~0)
+    fq_index = vlib_frame_queue_main_init (frame_queue_test_node.index, 0);
+
+  fqm = vec_elt_at_index (tm->frame_queue_mains, fq_index);
+  r = fqm->vlib_frame_queues[vm->thread_index]->rings + vm->thread_index;
+  rt = vlib_node_get_runtime (vm, frame_queue_test_node.index);
+
+  /* overflow the ring and the backlog by a frame's worth of packets */
+  vlib_frame_queue_set_nelts (fqm->vlib_frame_queues[vm->thread_index], 4);
+  limit = r->limit;
+  n_buffers = limit + VLIB_FRAME_QUEUE_BACKLOG_SIZE + VLIB_FRAME_SIZE;
+
+  vec_validate (buffers, n_buffers - 1);
+  vec_validate (thread_indices, n_buffers - 1);
+  if ((i = vlib_buffer_alloc (vm, buffers, n_buffers)) != n_buffers)
+    {
+      vlib_buffer_free (vm, buffers, i);
+      error = clib_error_return (0, "buffer allocation failure");
+      goto done;
+    }
+  for (i = 0; i < n_buffers; i++)
+    thread_indices[i] = vm->thread_index;
+
+  frame_queue_test_n_received = 0;
+  n_enq = vlib_buffer_enqueue_to_thread (vm, rt, fq_index, buffers,
+					 thread_indices, n_buffers, 1);
+
+  if (n_enq != limit + VLIB_FRAME_QUEUE_BACKLOG_SIZE)
+    {
+      error = clib_error_return (0, "enqueued %u expected %u", n_enq,
+				 limit + VLIB_FRAME_QUEUE_BACKLOG_SIZE);
+      goto done;
+    }
+  if (r->tail - r->head != limit ||
+      vec_len (r->backlog) != VLIB_FRAME_QUEUE_BACKLOG_SIZE)
+    {
+      error = clib_error_return (0, "ring %lu backlog %u", r->tail - r->head,
+				 vec_len (r->backlog));
+      goto done;
+    }
+
+  /* let the main loop drain the ring and flush the backlog */
+  for (i = 0; i < 100 && frame_queue_test_n_received < n_enq; i++)
+    vlib_process_suspend (vm, 1e-3);
+
+  if (frame_queue_test_n_received != n_enq || vec_len (r->backlog))
+    error = clib_error_return (0, "received %u expected %u",
+			       frame_queue_test_n_received, n_enq);
+  else
+    vlib_cli_output (vm, "frame queue: %u enqueued, %u dropped, PASS", n_enq,
+		     n_buffers - n_enq);
+
+done:
+  vlib_frame_queue_set_nelts (fqm->vlib_frame_queues[vm->thread_index],
+			      fqm->frame_queue_nelts);
+  vec_free (buffers);
+  vec_free (thread_indices);
+  return error;
+}
+
+VLIB_CLI_COMMAND (test_frame_queue_command, static) = {
+  .path = "test frame-queue congestion",
+  .short_help = "test frame-queue congestion",
+  .function = test_frame_queue_command_fn,
+};
+
+static u32 adaptive_mode_test_n_vectors;
+
+VLIB_NODE_FN (adaptive_mode_test_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  return adaptive_mode_test_n_vectors;
+}
+
+VLIB_REGISTER_NODE (adaptive_mode_test_node) = {
+  .name = "adaptive-mode-test",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_DISABLED,
+};
+
+static clib_error_t *
+test_adaptive_mode_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			       vlib_cli_command_t *cmd)
+{
+  vlib_node_main_t *nm = &vm->node_main;
+  u32 ni = adaptive_mode_test_node.index;
+  f64 saved_idle_time = nm->adaptive_idle_time;
+  vlib_node_adaptive_state_t *as;
+  clib_error_t *error = 0;
+  u64 n_switches = 0;
+  f64 polling_time;
+  int i;
+
+  if ((as = vlib_node_get_adaptive_state (vm, ni)))
+    n_switches = as->n_switches;
+
+  nm->adaptive_idle_time = 20e-3;
+  vlib_node_set_state (vm, ni, VLIB_NODE_STATE_INTERRUPT);
+  vlib_node_set_flag (vm, ni, VLIB_NODE_FLAG_ADAPTIVE_MODE, 1);
+
+  /* a burst switches the node to polling */
+  adaptive_mode_test_n_vectors = nm->polling_threshold_vector_length;
+  vlib_node_set_interrupt_pending (vm, ni);
+  for (i = 0; i < 100; i++)
+    {
+      vlib_process_suspend (vm, 1e-3);
+      if (vlib_node_get_state (vm, ni) == VLIB_NODE_STATE_POLLING)
+	break;
+    }
+
+  if (vlib_node_get_state (vm, ni) != VLIB_NODE_STATE_POLLING)
+    {
+      error = clib_error_return (0, "node did not switch to polling");
+      goto done;
+    }
+
+  /* staying idle for longer than idle time switches it back */
+  adaptive_mode_test_n_vectors = 0;
+  for (i = 0; i < 1000; i++)
+    {
+      vlib_process_suspend (vm, 1e-3);
+      if (vlib_node_get_state (vm, ni) == VLIB_NODE_STATE_INTERRUPT)
+	break;
+    }
+
+  if (vlib_node_get_state (vm, ni) != VLIB_NODE_STATE_INTERRUPT)
+    {
+      error = clib_error_return (0, "node did not switch to interrupt");
+      goto done;
+    }
+
+  as = vlib_node_get_adaptive_state (vm, ni);
+  polling_time = vlib_node_adaptive_time_in_state (
+    as, VLIB_NODE_STATE_POLLING, vlib_time_now (vm));
+
+  if (as->n_switches - n_switches != 2 ||
+      polling_time < nm->adaptive_idle_time)
+    error = clib_error_return (0, "switches %lu polling time %.3f",
+			       as->n_switches - n_switches, polling_time);
+  else
+    vlib_cli_output (vm, "adaptive mode: polling for %.3f s, PASS",
+		     polling_time);
+
+done:
+  vlib_node_set_flag (vm, ni, VLIB_NODE_FLAG_ADAPTIVE_MODE, 0);
+  vlib_node_set_state (vm, ni, VLIB_NODE_STATE_DISABLED);
+  nm->adaptive_idle_time = saved_idle_time;
+  return error;
+}
+
+VLIB_CLI_COMMAND (test_adaptive_mode_command, static) = {
+  .path = "test node adaptive-mode",
+  .short_help = "test node adaptive-mode",
+  .function = test_adaptive_mode_command_fn,
+};
 
+typedef struct
+{
+  u64 epoch;
+  u32 n_called;
+  u32 n_early;
+} test_rcu_t;
+
+/* workers which may still hold references from before the call */
+static u32
+test_rcu_n_behind (u64 epoch)
+{
+  u32 i, n = 0;
+
+  for (i = 1; i < vlib_get_n_threads (); i++)
+    if (__atomic_load_n (&vlib_get_main_by_index (i)->rcu_epoch,
+			 __ATOMIC_ACQUIRE) < epoch)
+      n++;
+  return n;
+}
+
+static void
+test_rcu_cb (void *data)
+{
+  test_rcu_t *t = data;
+
+  t->n_early += test_rcu_n_behind (t->epoch);
+  t->n_called++;
+}
 
+static clib_error_t *
+test_rcu_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  /* static, callbacks may outlive a failed test */
+  static test_rcu_t t[2];
+  u64 epoch = vlib_rcu_main.epoch;
+  int i;
+
+  clib_memset (t, 0, sizeof (t));
+
+  /* other users may advance the epoch too, so read it after each call */
+  for (i = 0; i < ARRAY_LEN (t); i++)
+    {
+      vlib_rcu_call (test_rcu_cb, &t[i]);
+      t[i].epoch = vlib_rcu_main.epoch;
+    }
+  if (t[0].n_called || t[1].n_called)
+    return clib_error_return (0, "callback ran before the grace period");
+
+  /* the main loop reclaims once every worker went through its loop */
+  for (i = 0; i < 1000 && !(t[0].n_called && t[1].n_called); i++)
+    vlib_process_suspend (vm, 1e-3);
+
+  if (t[0].n_called != 1 || t[1].n_called != 1)
+    return clib_error_return (0, "callbacks ran %u and %u times",
+			      t[0].n_called, t[1].n_called);
+
+  if (t[0].n_early || t[1].n_early)
+    return clib_error_return (0, "callbacks ran before %u workers were "
+			      "quiescent", t[0].n_early + t[1].n_early);
+
+  vlib_rcu_synchronize (vm);
+
+  if (vlib_rcu_main.epoch < epoch + 3)
+    return clib_error_return (0, "epoch %lu expected at least %lu",
+			      vlib_rcu_main.epoch, epoch + 3);
+
+  if (test_rcu_n_behind (epoch + 3))
+    return clib_error_return (0, "synchronize returned before %u workers "
+			      "were quiescent", test_rcu_n_behind (epoch + 3));
+
+  vlib_cli_output (vm, "rcu: %u workers, PASS", vlib_num_workers ());
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_rcu_command, static) = {
+  .path = "test rcu",
+  .short_help = "test rcu",
+  .function = test_rcu_command_fn,
+  .is_mp_safe = 1,
+};
 
 /*
  * fd.io coding-style-patch-verification: ON
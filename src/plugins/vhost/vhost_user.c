@@ -181,6 +181,8 @@ vhost_user_rx_thread_placement (vhost_user_intf_t * vui, u32 qid)
 						    VNET_HW_IF_RXQ_THREAD_ANY);
   txvq->thread_index =
     vnet_hw_if_get_rx_queue_thread_index (vnm, txvq->queue_index);
+  vnet_hw_if_set_rx_queue_driver_rebalance (vnm, txvq->queue_index,
+					    vum->rebalance_interval > 0);
 
   if (txvq->mode == VNET_HW_IF_RX_MODE_UNKNOWN)
     /* Set polling as the default */
@@ -352,11 +354,18 @@ vhost_user_vring_close (vhost_user_intf_t * vui, u32 qid)
   u32 queue_index = vui->vrings[qid].queue_index;
   u32 mode = vui->vrings[qid].mode;
   u32 thread_index = vui->vrings[qid].thread_index;
+  vhost_user_dma_info_t *dma_info = vui->vrings[qid].dma_info;
+  u16 dma_info_head = vui->vrings[qid].dma_info_head;
+  u16 dma_info_tail = vui->vrings[qid].dma_info_tail;
   vhost_user_vring_init (vui, qid);
   vui->vrings[qid].qid = q;
   vui->vrings[qid].queue_index = queue_index;
   vui->vrings[qid].mode = mode;
   vui->vrings[qid].thread_index = thread_index;
+  /* dma copies in flight complete against the closed vring */
+  vui->vrings[qid].dma_info = dma_info;
+  vui->vrings[qid].dma_info_head = dma_info_head;
+  vui->vrings[qid].dma_info_tail = dma_info_tail;
 }
 
 static_always_inline void
@@ -523,6 +532,8 @@ vhost_user_socket_read (clib_file_t * uf)
 	msg.u64 |= FEATURE_VIRTIO_NET_F_HOST_GUEST_TSO_FEATURE_BITS;
       if (vui->enable_packed)
 	msg.u64 |= VIRTIO_FEATURE (VIRTIO_F_RING_PACKED);
+      if (vui->enable_in_order)
+	msg.u64 |= VIRTIO_FEATURE (VIRTIO_F_IN_ORDER);
 
       msg.size = sizeof (msg.u64);
       vu_log_debug (vui, "if %d msg VHOST_USER_GET_FEATURES - reply "
@@ -1175,6 +1186,8 @@ vhost_user_init (vlib_main_t * vm)
 
   vum->coalesce_frames = 32;
   vum->coalesce_time = 1e-3;
+  vum->dma_copy_threshold = VHOST_USER_DMA_COPY_THRESHOLD_DEFAULT;
+  vum->rebalance_threshold = 20;
 
   vec_validate (vum->cpus, tm->n_vlib_mains - 1);
 
@@ -1289,6 +1302,172 @@ VLIB_REGISTER_NODE (vhost_user_send_interrupt_node) = {
 };
 /* *INDENT-ON* */
 
+/*
+ * Move at most one polling rx queue from the busiest to the idlest worker,
+ * based on the clocks each queue spent in vhost-user-input since the
+ * previous pass. Moving one queue per pass keeps the barrier short and lets
+ * the next measurement reflect the new placement.
+ */
+static void
+vhost_user_rebalance (vlib_main_t * vm)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vhost_user_intf_t *vui, *best_vui = 0;
+  vhost_user_vring_t *best_txvq = 0;
+  u64 *load = 0, gap, best_dist = ~0ULL;
+  u32 t, src, dst;
+  u16 qid;
+
+  if (vlib_num_workers () < 2)
+    return;
+
+  vec_validate (load, vdm->last_worker_thread_index);
+
+  pool_foreach (vui, vum->vhost_user_interfaces)
+    {
+      FOR_ALL_VHOST_TXQ (qid, vui)
+	{
+	  vhost_user_vring_t *txvq = &vui->vrings[qid];
+
+	  if (txvq->queue_index == ~0)
+	    continue;
+	  txvq->n_clocks_interval = txvq->n_clocks - txvq->n_clocks_last;
+	  txvq->n_clocks_last = txvq->n_clocks;
+
+	  t = vnet_hw_if_get_rx_queue_thread_index (vnm, txvq->queue_index);
+	  if (t != txvq->thread_index)
+	    {
+	      /* placed elsewhere by "set interface rx-placement" */
+	      if (txvq->mode == VNET_HW_IF_RX_MODE_POLLING)
+		{
+		  vum->cpus[txvq->thread_index].polling_q_count--;
+		  vum->cpus[t].polling_q_count++;
+		}
+	      txvq->thread_index = t;
+	    }
+	  if (t < vec_len (load))
+	    load[t] += txvq->n_clocks_interval;
+	}
+    }
+
+  src = dst = vdm->first_worker_thread_index;
+  for (t = vdm->first_worker_thread_index;
+       t <= vdm->last_worker_thread_index; t++)
+    {
+      if (load[t] > load[src])
+	src = t;
+      if (load[t] < load[dst])
+	dst = t;
+    }
+
+  if (load[src] == 0 ||
+      (load[src] - load[dst]) * 100 <= vum->rebalance_threshold * load[src])
+    goto done;
+
+  /* the queue which brings both workers closest to the average */
+  gap = load[src] - load[dst];
+  pool_foreach (vui, vum->vhost_user_interfaces)
+    {
+      FOR_ALL_VHOST_TXQ (qid, vui)
+	{
+	  vhost_user_vring_t *txvq = &vui->vrings[qid];
+	  u64 dist;
+
+	  if (txvq->queue_index == ~0 || txvq->thread_index != src ||
+	      txvq->mode != VNET_HW_IF_RX_MODE_POLLING ||
+	      vhost_user_dma_in_flight (txvq) ||
+	      txvq->n_clocks_interval == 0 || txvq->n_clocks_interval >= gap)
+	    continue;
+	  dist = txvq->n_clocks_interval > gap / 2 ?
+		   txvq->n_clocks_interval - gap / 2 :
+		   gap / 2 - txvq->n_clocks_interval;
+	  if (dist < best_dist)
+	    {
+	      best_dist = dist;
+	      best_vui = vui;
+	      best_txvq = txvq;
+	    }
+	}
+    }
+
+  if (best_txvq == 0)
+    goto done;
+
+  /*
+   * The source worker may have submitted a copy batch since the scan. Its
+   * completion publishes the used index and enqueues on the old thread, so
+   * the queue only moves if nothing is in flight with the workers stopped.
+   */
+  vlib_worker_thread_barrier_sync (vm);
+  if (vhost_user_dma_in_flight (best_txvq))
+    {
+      vlib_worker_thread_barrier_release (vm);
+      goto done;
+    }
+
+  vu_log_debug (best_vui, "moving queue %u from thread %u to %u",
+		best_txvq->qid, src, dst);
+  vnet_hw_if_set_rx_queue_thread_index (vnm, best_txvq->queue_index, dst);
+  vnet_hw_if_update_runtime_data (vnm, best_vui->hw_if_index);
+  vum->cpus[src].polling_q_count--;
+  vum->cpus[dst].polling_q_count++;
+  best_txvq->thread_index = dst;
+  vum->n_rebalanced++;
+  vlib_worker_thread_barrier_release (vm);
+
+done:
+  vec_free (load);
+}
+
+/* hand our rx queues to the generic rx-rebalance unless we balance them */
+static void
+vhost_user_set_driver_rebalance (vhost_user_main_t *vum)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vhost_user_intf_t *vui;
+  vhost_user_vring_t *txvq;
+  u32 qid;
+
+  pool_foreach (vui, vum->vhost_user_interfaces)
+    {
+      FOR_ALL_VHOST_TXQ (qid, vui)
+	{
+	  txvq = &vui->vrings[qid];
+	  if (txvq->queue_index != ~0)
+	    vnet_hw_if_set_rx_queue_driver_rebalance (
+	      vnm, txvq->queue_index, vum->rebalance_interval > 0);
+	}
+    }
+}
+
+static uword
+vhost_user_rebalance_process (vlib_main_t * vm,
+			      vlib_node_runtime_t * rt, vlib_frame_t * f)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+
+  while (1)
+    {
+      if (vum->rebalance_interval > 0)
+	vlib_process_wait_for_event_or_clock (vm, vum->rebalance_interval);
+      else
+	vlib_process_wait_for_event (vm);
+      vlib_process_get_events (vm, 0);
+
+      if (vum->rebalance_interval > 0)
+	vhost_user_rebalance (vm);
+    }
+  return 0;
+}
+
+VLIB_REGISTER_NODE (vhost_user_rebalance_node, static) = {
+  .function = vhost_user_rebalance_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "vhost-user-rebalance-process",
+};
+
 static uword
 vhost_user_process (vlib_main_t * vm,
 		    vlib_node_runtime_t * rt, vlib_frame_t * f)
@@ -1415,7 +1594,22 @@ vhost_user_term_if (vhost_user_intf_t * vui)
   vhost_user_update_iface_state (vui);
 
   for (q = 0; q < vec_len (vui->vrings); q++)
-    clib_spinlock_free (&vui->vrings[q].vring_lock);
+    {
+      vhost_user_vring_t *vring = &vui->vrings[q];
+      vhost_user_dma_info_t *dma_info;
+
+      clib_spinlock_free (&vring->vring_lock);
+      vec_foreach (dma_info, vring->dma_info)
+	vec_free (dma_info->buffers);
+      vec_free (vring->dma_info);
+      vring->dma_info_head = vring->dma_info_tail = 0;
+    }
+
+  if (vui->dma_input_config >= 0)
+    vlib_dma_config_del (vlib_get_main (), vui->dma_input_config);
+  if (vui->dma_tx_config >= 0)
+    vlib_dma_config_del (vlib_get_main (), vui->dma_tx_config);
+  vui->dma_input_config = vui->dma_tx_config = -1;
 
   if (vui->unix_server_index != ~0)
     {
@@ -1589,6 +1783,31 @@ vhost_user_create_ethernet (vnet_main_t *vnm, vlib_main_t *vm,
   vui->hw_if_index = vnet_eth_register_interface (vnm, &eir);
 }
 
+/*
+ * Register the dma configs used to offload rx and tx copies. Without a
+ * dma backend the interface keeps copying on the cpu.
+ */
+static void
+vhost_user_dma_config_add (vhost_user_intf_t *vui)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  vlib_dma_config_t dma_args = {};
+
+  dma_args.max_batches = 256;
+  dma_args.max_transfers = VHOST_USER_DMA_MAX_TRANSFERS;
+  dma_args.max_transfer_size = vlib_buffer_get_default_data_size (vm);
+  dma_args.barrier_before_last = 1;
+  dma_args.sw_fallback = 1;
+
+  dma_args.callback_fn = vhost_user_input_dma_completion_cb;
+  vui->dma_input_config = vlib_dma_config_add (vm, &dma_args);
+  dma_args.callback_fn = vhost_user_tx_dma_completion_cb;
+  vui->dma_tx_config = vlib_dma_config_add (vm, &dma_args);
+
+  if (vui->dma_input_config < 0 || vui->dma_tx_config < 0)
+    vu_log_warn (vui, "no dma backend available, copying on the cpu");
+}
+
 /*
  *  Initialize vui with specified attributes
  */
@@ -1628,6 +1847,11 @@ vhost_user_vui_init (vnet_main_t * vnm, vhost_user_intf_t * vui,
   vui->enable_gso = args->enable_gso;
   vui->enable_event_idx = args->enable_event_idx;
   vui->enable_packed = args->enable_packed;
+  vui->enable_in_order = args->enable_in_order;
+  vui->use_dma = args->use_dma;
+  vui->dma_input_config = vui->dma_tx_config = -1;
+  if (vui->use_dma)
+    vhost_user_dma_config_add (vui);
   /*
    * enable_gso takes precedence over configurable feature mask if there
    * is a clash.
@@ -1788,6 +2012,8 @@ vhost_user_connect_command_fn (vlib_main_t * vm,
   args.feature_mask &= ~VIRTIO_FEATURE (VIRTIO_F_RING_PACKED);
   /* event_idx feature is disable by default */
   args.feature_mask &= ~VIRTIO_FEATURE (VIRTIO_RING_F_EVENT_IDX);
+  /* in_order feature is disable by default */
+  args.feature_mask &= ~VIRTIO_FEATURE (VIRTIO_F_IN_ORDER);
 
   while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
     {
@@ -1801,6 +2027,10 @@ vhost_user_connect_command_fn (vlib_main_t * vm,
 	args.enable_packed = 1;
       else if (unformat (line_input, "event-idx"))
 	args.enable_event_idx = 1;
+      else if (unformat (line_input, "in-order"))
+	args.enable_in_order = 1;
+      else if (unformat (line_input, "use-dma"))
+	args.use_dma = 1;
       else if (unformat (line_input, "feature-mask 0x%llx",
 			 &args.feature_mask))
 	;
@@ -2194,6 +2424,12 @@ show_vhost_user_command_fn (vlib_main_t * vm,
   vlib_cli_output (vm, "  Number of rx virtqueues in interrupt mode: %d",
 		   vum->ifq_count);
   vlib_cli_output (vm, "  Number of GSO interfaces: %d", vum->gso_count);
+  if (vum->rebalance_interval > 0)
+    vlib_cli_output (vm,
+		     "  Rx queue rebalance interval %.2f sec threshold %u%% "
+		     "queues moved %u",
+		     vum->rebalance_interval, vum->rebalance_threshold,
+		     vum->n_rebalanced);
   for (u32 tid = 0; tid <= vlib_num_workers (); tid++)
     {
       vhost_cpu_t *cpu = vec_elt_at_index (vum->cpus, tid);
@@ -2215,6 +2451,12 @@ show_vhost_user_command_fn (vlib_main_t * vm,
 	vlib_cli_output (vm, "  Packed ring enable");
       if (vui->enable_event_idx)
 	vlib_cli_output (vm, "  Event index enable");
+      if (vui->enable_in_order)
+	vlib_cli_output (vm, "  In-order enable");
+      if (vui->use_dma)
+	vlib_cli_output (vm, "  DMA copy %s (threshold %u bytes)",
+			 vui->dma_tx_config >= 0 ? "enable" : "unavailable",
+			 vum->dma_copy_threshold);
 
       vlib_cli_output (vm, "virtio_net_hdr_sz %d\n"
 		       " features mask (0x%llx): \n"
@@ -2398,7 +2640,7 @@ VLIB_CLI_COMMAND (vhost_user_connect_command, static) = {
     .path = "create vhost-user",
     .short_help = "create vhost-user socket <socket-filename> [server] "
     "[feature-mask <hex>] [hwaddr <mac-addr>] [renumber <dev_instance>] [gso] "
-    "[packed] [event-idx]",
+    "[packed] [event-idx] [in-order] [use-dma]",
     .function = vhost_user_connect_command_fn,
     .is_mp_safe = 1,
 };
@@ -2566,6 +2808,75 @@ VLIB_CLI_COMMAND (show_vhost_user_command, static) = {
 };
 /* *INDENT-ON* */
 
+static clib_error_t *
+vhost_user_rebalance_command_fn (vlib_main_t * vm,
+				 unformat_input_t * input,
+				 vlib_cli_command_t * cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vhost_user_main_t *vum = &vhost_user_main;
+  clib_error_t *error = NULL;
+  f64 interval = vum->rebalance_interval;
+  u32 threshold = vum->rebalance_threshold;
+
+  /* Get a line of input. */
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "interval %f", &interval))
+	;
+      else if (unformat (line_input, "threshold %u", &threshold))
+	;
+      else if (unformat (line_input, "disable"))
+	interval = 0;
+      else
+	{
+	  error = clib_error_return (0, "unknown input '%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (interval < 0 || threshold > 100)
+    {
+      error = clib_error_return (0, "invalid interval or threshold");
+      goto done;
+    }
+
+  vum->rebalance_interval = interval;
+  vum->rebalance_threshold = threshold;
+  vhost_user_set_driver_rebalance (vum);
+  vlib_process_signal_event (vm, vhost_user_rebalance_node.index, 0, 0);
+
+done:
+  unformat_free (line_input);
+
+  return error;
+}
+
+/*?
+ * Periodically move polling vHost User rx queues from the busiest worker to
+ * the idlest one, based on the cpu clocks each queue spent in
+ * vhost-user-input. A queue is moved only when the load of the two workers
+ * differs by more than <em>threshold</em> percent, and at most one queue is
+ * moved per <em>interval</em>. Queues placed with
+ * 'set interface rx-placement' are subject to rebalancing as well.
+ * While enabled, the generic 'set interface rx-rebalance' leaves vHost User
+ * queues alone.
+ *
+ * @cliexpar
+ * @cliexcmd{set vhost-user rebalance interval 5 threshold 20}
+ * @cliexcmd{set vhost-user rebalance disable}
+?*/
+VLIB_CLI_COMMAND (vhost_user_rebalance_command, static) = {
+  .path = "set vhost-user rebalance",
+  .short_help = "set vhost-user rebalance {interval <sec> "
+		"[threshold <percent>] | disable}",
+  .function = vhost_user_rebalance_command_fn,
+};
+
 
 static clib_error_t *
 vhost_user_config (vlib_main_t * vm, unformat_input_t * input)
@@ -2580,6 +2891,18 @@ vhost_user_config (vlib_main_t * vm, unformat_input_t * input)
 	;
       else if (unformat (input, "dont-dump-memory"))
 	vum->dont_dump_vhost_user_memory = 1;
+      else if (unformat (input, "rebalance-interval %f",
+			 &vum->rebalance_interval))
+	;
+      else if (unformat (input, "rebalance-threshold %u",
+			 &vum->rebalance_threshold))
+	;
+      else if (unformat (input, "dma-copy-threshold %u",
+			 &vum->dma_copy_threshold))
+	/* virtio headers live in per-thread scratch, keep them on the cpu */
+	vum->dma_copy_threshold =
+	  clib_max (vum->dma_copy_threshold,
+		    sizeof (vnet_virtio_net_hdr_mrg_rxbuf_t) + 1);
       else
 	return clib_error_return (0, "unknown input `%U'",
 				  format_unformat_error, input);
@@ -17,6 +17,7 @@
 
 #include <vhost/virtio_std.h>
 #include <vhost/vhost_std.h>
+#include <vlib/dma/dma.h>
 
 /* vhost-user data structures */
 
@@ -109,7 +110,9 @@ typedef struct
   u8 enable_gso;
   u8 enable_packed;
   u8 enable_event_idx;
+  u8 enable_in_order;
   u8 use_custom_mac;
+  u8 use_dma;
 
   /* return */
   u32 sw_if_index;
@@ -177,6 +180,22 @@ typedef struct vhost_user_msg {
 } __attribute ((packed)) vhost_user_msg_t;
 /* *INDENT-ON* */
 
+#define VHOST_USER_DMA_INFO_SIZE 16
+#define VHOST_USER_DMA_MAX_TRANSFERS (4 * VLIB_FRAME_SIZE)
+#define VHOST_USER_DMA_COPY_THRESHOLD_DEFAULT 256
+
+typedef struct
+{
+  /* vlib buffers which have to outlive the dma batch */
+  u32 *buffers;
+  /* rx only: node runtime handing the packets over on completion */
+  vlib_node_runtime_t *node;
+  u32 next_index;
+  /* used index to publish once the copies are done */
+  u16 used_idx;
+  u8 finished;
+} vhost_user_dma_info_t;
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -208,6 +227,9 @@ typedef struct
   u8 log_used;
   clib_spinlock_t vring_lock;
 
+  /* cpu clocks spent polling this queue, rx queues only */
+  u64 n_clocks;
+
   //Put non-runtime in a different cache line
     CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
   int errfd;
@@ -232,6 +254,15 @@ typedef struct
   u8 first_kick;
   u32 queue_index;
   u32 thread_index;
+
+  /* polling clocks at the previous rebalance pass, and since then */
+  u64 n_clocks_last;
+  u64 n_clocks_interval;
+
+  /* dma copy offload, kept across reconnects */
+  vhost_user_dma_info_t *dma_info;
+  u16 dma_info_head;
+  u16 dma_info_tail;
 } vhost_user_vring_t;
 
 #define VHOST_USER_EVENT_START_TIMER 1
@@ -285,6 +316,14 @@ typedef struct
   u8 enable_packed;
 
   u8 enable_event_idx;
+
+  /* VIRTIO_F_IN_ORDER offered to the driver */
+  u8 enable_in_order;
+
+  /* dma copy offload, -1 when no dma backend is available */
+  u8 use_dma;
+  int dma_input_config;
+  int dma_tx_config;
 } vhost_user_intf_t;
 
 #define FOR_ALL_VHOST_TXQ(qid, vui) for (qid = 1; qid < vui->num_qid; qid += 2)
@@ -353,6 +392,17 @@ typedef struct
 
   /* gso interface count */
   u32 gso_count;
+
+  /* copies shorter than this are done by the cpu on dma interfaces */
+  u32 dma_copy_threshold;
+
+  /*
+   * Rx queue rebalancing, 0 interval when disabled. A queue is moved when
+   * the busiest and idlest workers differ by more than threshold percent.
+   */
+  f64 rebalance_interval;
+  u32 rebalance_threshold;
+  u32 n_rebalanced;
 } vhost_user_main_t;
 
 typedef struct
@@ -371,6 +421,9 @@ int vhost_user_dump_ifs (vnet_main_t * vnm, vlib_main_t * vm,
 			 vhost_user_intf_details_t ** out_vuids);
 void vhost_user_set_operation_mode (vhost_user_intf_t *vui,
 				    vhost_user_vring_t *txvq);
+void vhost_user_input_dma_completion_cb (vlib_main_t *vm,
+					 vlib_dma_batch_t *b);
+void vhost_user_tx_dma_completion_cb (vlib_main_t *vm, vlib_dma_batch_t *b);
 
 extern vlib_node_registration_t vhost_user_send_interrupt_node;
 extern vnet_device_class_t vhost_user_device_class;
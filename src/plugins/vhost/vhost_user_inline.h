@@ -263,6 +263,12 @@ vhost_user_is_event_idx_supported (vhost_user_intf_t * vui)
   return (vui->features & VIRTIO_FEATURE (VIRTIO_RING_F_EVENT_IDX));
 }
 
+static_always_inline u64
+vhost_user_is_in_order_supported (vhost_user_intf_t *vui)
+{
+  return (vui->features & VIRTIO_FEATURE (VIRTIO_F_IN_ORDER));
+}
+
 static_always_inline void
 vhost_user_kick (vlib_main_t * vm, vhost_user_vring_t * vq)
 {
@@ -485,6 +491,68 @@ vhost_user_advance_last_used_idx (vhost_user_vring_t * vring)
     }
 }
 
+/*
+ * DMA copy offload is limited to split rings. It is also bypassed while
+ * dirty page logging is active, as pages would be logged before the copy
+ * engine has written them.
+ */
+static_always_inline u8
+vhost_user_dma_enabled (vhost_user_intf_t *vui, int config_index)
+{
+  return (config_index >= 0 && vui->log_base_addr == 0 &&
+	  !vhost_user_is_packed_ring_supported (vui));
+}
+
+static_always_inline u8
+vhost_user_dma_in_flight (vhost_user_vring_t *vring)
+{
+  return vring->dma_info_head != vring->dma_info_tail;
+}
+
+/* Returns the next free dma info entry, or 0 if the ring is full */
+static_always_inline vhost_user_dma_info_t *
+vhost_user_dma_info_get (vhost_user_vring_t *vring)
+{
+  u16 mask = VHOST_USER_DMA_INFO_SIZE - 1;
+
+  if (PREDICT_FALSE (vring->dma_info == 0))
+    vec_validate_aligned (vring->dma_info, mask, CLIB_CACHE_LINE_BYTES);
+
+  if (((vring->dma_info_tail + 1) & mask) == vring->dma_info_head)
+    return 0;
+
+  return vring->dma_info + vring->dma_info_tail;
+}
+
+static_always_inline void
+vhost_user_dma_info_enqueue (vhost_user_vring_t *vring)
+{
+  vring->dma_info_tail =
+    (vring->dma_info_tail + 1) & (VHOST_USER_DMA_INFO_SIZE - 1);
+}
+
+static_always_inline void
+vhost_user_dma_info_dequeue (vhost_user_vring_t *vring)
+{
+  vring->dma_info_head =
+    (vring->dma_info_head + 1) & (VHOST_USER_DMA_INFO_SIZE - 1);
+}
+
+/*
+ * Copy through the dma batch if there is one and the copy is big enough
+ * to be worth it, otherwise on the cpu.
+ */
+static_always_inline void
+vhost_user_dma_copy (vlib_main_t *vm, vlib_dma_batch_t *b, void *dst,
+		     void *src, u32 len)
+{
+  if (b && len >= vhost_user_main.dma_copy_threshold &&
+      b->n_enq < VHOST_USER_DMA_MAX_TRANSFERS)
+    vlib_dma_batch_add (vm, b, dst, src, len);
+  else
+    clib_memcpy_fast (dst, src, len);
+}
+
 #endif
 
 /*
@@ -141,8 +141,9 @@ vhost_user_rx_trace (vhost_trace_t * t,
 }
 
 static_always_inline u32
-vhost_user_input_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
-		       u16 copy_len, u32 * map_hint)
+vhost_user_input_copy (vlib_main_t *vm, vlib_dma_batch_t *b,
+		       vhost_user_intf_t *vui, vhost_copy_t *cpy, u16 copy_len,
+		       u32 *map_hint)
 {
   void *src0, *src1, *src2, *src3;
   if (PREDICT_TRUE (copy_len >= 4))
@@ -167,8 +168,8 @@ vhost_user_input_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
 	  clib_prefetch_load (src2);
 	  clib_prefetch_load (src3);
 
-	  clib_memcpy_fast ((void *) cpy[0].dst, src0, cpy[0].len);
-	  clib_memcpy_fast ((void *) cpy[1].dst, src1, cpy[1].len);
+	  vhost_user_dma_copy (vm, b, (void *) cpy[0].dst, src0, cpy[0].len);
+	  vhost_user_dma_copy (vm, b, (void *) cpy[1].dst, src1, cpy[1].len);
 	  copy_len -= 2;
 	  cpy += 2;
 	}
@@ -177,7 +178,7 @@ vhost_user_input_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
     {
       if (PREDICT_FALSE (!(src0 = map_guest_mem (vui, cpy->src, map_hint))))
 	return 1;
-      clib_memcpy_fast ((void *) cpy->dst, src0, cpy->len);
+      vhost_user_dma_copy (vm, b, (void *) cpy->dst, src0, cpy->len);
       copy_len -= 1;
       cpy += 1;
     }
@@ -344,10 +345,8 @@ vhost_user_input_do_interrupt (vlib_main_t * vm, vhost_user_intf_t * vui,
 }
 
 static_always_inline void
-vhost_user_input_setup_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
-			      vhost_user_intf_t * vui,
-			      u32 * current_config_index, u32 * next_index,
-			      u32 ** to_next, u32 * n_left_to_next)
+vhost_user_input_next_index (vhost_user_intf_t *vui, u32 *current_config_index,
+			     u32 *next_index)
 {
   vnet_feature_main_t *fm = &feature_main;
   u8 feature_arc_idx = fm->device_input_feature_arc_index;
@@ -361,16 +360,22 @@ vhost_user_input_setup_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
       vnet_get_config_data (&cm->config_main, current_config_index,
 			    next_index, 0);
     }
+}
 
-  vlib_get_new_next_frame (vm, node, *next_index, *to_next, *n_left_to_next);
+static_always_inline void
+vhost_user_input_get_frame (vlib_main_t *vm, vlib_node_runtime_t *node,
+			    vhost_user_intf_t *vui, u32 next_index,
+			    u32 **to_next, u32 *n_left_to_next)
+{
+  vlib_get_new_next_frame (vm, node, next_index, *to_next, *n_left_to_next);
 
-  if (*next_index == VNET_DEVICE_INPUT_NEXT_ETHERNET_INPUT)
+  if (next_index == VNET_DEVICE_INPUT_NEXT_ETHERNET_INPUT)
     {
       /* give some hints to ethernet-input */
       vlib_next_frame_t *nf;
       vlib_frame_t *f;
       ethernet_input_frame_t *ef;
-      nf = vlib_node_runtime_get_next_frame (vm, node, *next_index);
+      nf = vlib_node_runtime_get_next_frame (vm, node, next_index);
       f = vlib_get_frame (vm, nf->frame);
       f->flags = ETH_INPUT_FRAME_F_SINGLE_SW_IF_IDX;
 
@@ -381,6 +386,105 @@ vhost_user_input_setup_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
     }
 }
 
+static_always_inline void
+vhost_user_input_setup_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
+			      vhost_user_intf_t * vui,
+			      u32 * current_config_index, u32 * next_index,
+			      u32 ** to_next, u32 * n_left_to_next)
+{
+  vhost_user_input_next_index (vui, current_config_index, next_index);
+  vhost_user_input_get_frame (vm, node, vui, *next_index, to_next,
+			      n_left_to_next);
+}
+
+/*
+ * Hand the packets of a dma info entry over to the next node and give the
+ * descriptors back to the driver.
+ */
+static_always_inline void
+vhost_user_input_dma_complete (vlib_main_t *vm, vhost_user_intf_t *vui,
+			       vhost_user_vring_t *txvq,
+			       vhost_user_dma_info_t *dma_info)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  u32 n_packets = vec_len (dma_info->buffers);
+  u32 n_left_to_next, *to_next;
+
+  if (n_packets)
+    {
+      vhost_user_input_get_frame (vm, dma_info->node, vui,
+				  dma_info->next_index, &to_next,
+				  &n_left_to_next);
+      vlib_buffer_copy_indices (to_next, dma_info->buffers, n_packets);
+      vlib_put_next_frame (vm, dma_info->node, dma_info->next_index,
+			   n_left_to_next - n_packets);
+      vec_reset_length (dma_info->buffers);
+    }
+
+  /* the vring may have been closed while the copies were in flight */
+  if (PREDICT_FALSE (txvq->used == 0))
+    return;
+
+  CLIB_MEMORY_STORE_BARRIER ();
+  txvq->used->idx = dma_info->used_idx;
+  vhost_user_log_dirty_ring (vui, txvq, idx);
+
+  if ((txvq->callfd_idx != ~0) &&
+      !(txvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT) &&
+      (txvq->n_since_last_int > vum->coalesce_frames))
+    vhost_user_send_call (vm, vui, txvq);
+}
+
+CLIB_MARCH_FN (vhost_user_input_dma_completion_cb, void, vlib_main_t *vm,
+	       vlib_dma_batch_t *b)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vhost_user_intf_t *vui;
+  vhost_user_vring_t *txvq;
+  vhost_user_dma_info_t *dma_info;
+
+  if (pool_is_free_index (vum->vhost_user_interfaces, b->cookie >> 16))
+    return;
+
+  vui = pool_elt_at_index (vum->vhost_user_interfaces, b->cookie >> 16);
+  txvq = vec_elt_at_index (vui->vrings, b->cookie & 0xffff);
+  txvq->dma_info[txvq->dma_info_head].finished = 1;
+
+  /* also hand over the cpu copied frames queued behind this batch */
+  while (vhost_user_dma_in_flight (txvq))
+    {
+      dma_info = txvq->dma_info + txvq->dma_info_head;
+      if (!dma_info->finished)
+	break;
+      vhost_user_dma_info_dequeue (txvq);
+      vhost_user_input_dma_complete (vm, vui, txvq, dma_info);
+    }
+}
+
+#ifndef CLIB_MARCH_VARIANT
+void
+vhost_user_input_dma_completion_cb (vlib_main_t *vm, vlib_dma_batch_t *b)
+{
+  return CLIB_MARCH_FN_SELECT (vhost_user_input_dma_completion_cb) (vm, b);
+}
+#endif
+
+/*
+ * With VIRTIO_F_IN_ORDER the driver infers the skipped used entries, only
+ * the last one of a batch has to be written before publishing the index.
+ */
+static_always_inline void
+vhost_user_input_in_order_used (vhost_user_intf_t *vui,
+				vhost_user_vring_t *txvq, u16 last_used_idx,
+				u16 last_desc_head)
+{
+  u16 slot = (u16) (last_used_idx - 1) & txvq->qsz_mask;
+
+  txvq->used->ring[slot].id = last_desc_head;
+  txvq->used->ring[slot].len = 0;
+  vhost_user_log_dirty_ring (vui, txvq, ring[slot]);
+}
+
 static_always_inline u32
 vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 		     vhost_user_intf_t *vui, u16 qid,
@@ -401,6 +505,10 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
   u8 feature_arc_idx = fm->device_input_feature_arc_index;
   u32 current_config_index = ~(u32) 0;
   u16 mask = txvq->qsz_mask;
+  vhost_user_dma_info_t *dma_info = 0;
+  vlib_dma_batch_t *b = 0;
+  u8 in_order = vhost_user_is_in_order_supported (vui) != 0;
+  u16 last_desc_head = 0, desc_head;
 
   /* The descriptor table is not ready yet */
   if (PREDICT_FALSE (txvq->avail == 0))
@@ -455,6 +563,21 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
       goto done;
     }
 
+  /*
+   * Once dma is involved, packets are handed over in ring order from
+   * the dma info ring, wait for a free slot if it is full.
+   */
+  if (vhost_user_dma_enabled (vui, vui->dma_input_config) ||
+      PREDICT_FALSE (vhost_user_dma_in_flight (txvq)))
+    {
+      if (!(dma_info = vhost_user_dma_info_get (txvq)))
+	goto done;
+      if (vhost_user_dma_enabled (vui, vui->dma_input_config))
+	b = vlib_dma_batch_new (vm, vui->dma_input_config);
+      if (!b && !vhost_user_dma_in_flight (txvq))
+	dma_info = 0;
+    }
+
   if (PREDICT_FALSE (n_left == (mask + 1)))
     {
       /*
@@ -505,8 +628,17 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 	}
     }
 
-  vhost_user_input_setup_frame (vm, node, vui, &current_config_index,
-				&next_index, &to_next, &n_left_to_next);
+  if (dma_info)
+    {
+      /* buffers are kept aside until their copies are done */
+      vhost_user_input_next_index (vui, &current_config_index, &next_index);
+      vec_validate (dma_info->buffers, VLIB_FRAME_SIZE - 1);
+      to_next = dma_info->buffers;
+      n_left_to_next = VLIB_FRAME_SIZE;
+    }
+  else
+    vhost_user_input_setup_frame (vm, node, vui, &current_config_index,
+				  &next_index, &to_next, &n_left_to_next);
 
   u16 last_avail_idx = txvq->last_avail_idx;
   u16 last_used_idx = txvq->last_used_idx;
@@ -518,6 +650,7 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
       u16 desc_current;
       u32 desc_data_offset;
       vnet_virtio_vring_desc_t *desc_table = txvq->desc;
+      u16 pkt_copy_len = copy_len;
 
       if (PREDICT_FALSE (cpu->rx_buffers_len <= 1))
 	{
@@ -541,9 +674,13 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 	(vm, cpu->rx_buffers[cpu->rx_buffers_len - 1], LOAD);
 
       /* Just preset the used descriptor id and length for later */
-      txvq->used->ring[last_used_idx & mask].id = desc_current;
-      txvq->used->ring[last_used_idx & mask].len = 0;
-      vhost_user_log_dirty_ring (vui, txvq, ring[last_used_idx & mask]);
+      if (PREDICT_TRUE (!in_order))
+	{
+	  txvq->used->ring[last_used_idx & mask].id = desc_current;
+	  txvq->used->ring[last_used_idx & mask].len = 0;
+	  vhost_user_log_dirty_ring (vui, txvq, ring[last_used_idx & mask]);
+	}
+      desc_head = desc_current;
 
       /* The buffer should already be initialized */
       b_head->total_length_not_including_first_buffer = 0;
@@ -643,11 +780,11 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 		  /*
 		   * Checking if there are some left buffers.
 		   * If not, just rewind the used buffers and stop.
-		   * Note: Scheduled copies are not cancelled. This is
-		   * not an issue as they would still be valid. Useless,
-		   * but valid.
+		   * Scheduled copies are cancelled as the buffers may be
+		   * reused before a dma copy into them completes.
 		   */
 		  vhost_user_input_rewind_buffers (vm, cpu, b_head);
+		  copy_len = pkt_copy_len;
 		  n_left = 0;
 		  goto stop;
 		}
@@ -689,6 +826,7 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
       /* consume the descriptor and return it as used */
       last_avail_idx++;
       last_used_idx++;
+      last_desc_head = desc_head;
 
       vnet_buffer (b_head)->sw_if_index[VLIB_RX] = vui->sw_if_index;
       vnet_buffer (b_head)->sw_if_index[VLIB_TX] = (u32) ~ 0;
@@ -709,7 +847,7 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
        */
       if (PREDICT_FALSE (copy_len >= VHOST_USER_RX_COPY_THRESHOLD))
 	{
-	  if (PREDICT_FALSE (vhost_user_input_copy (vui, cpu->copy,
+	  if (PREDICT_FALSE (vhost_user_input_copy (vm, b, vui, cpu->copy,
 						    copy_len, &map_hint)))
 	    {
 	      vlib_error_count (vm, node->node_index,
@@ -717,39 +855,79 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 	    }
 	  copy_len = 0;
 
+	  if (in_order)
+	    vhost_user_input_in_order_used (vui, txvq, last_used_idx,
+					    last_desc_head);
+
 	  /* give buffers back to driver */
-	  CLIB_MEMORY_STORE_BARRIER ();
-	  txvq->used->idx = last_used_idx;
-	  vhost_user_log_dirty_ring (vui, txvq, idx);
+	  if (PREDICT_TRUE (!dma_info))
+	    {
+	      CLIB_MEMORY_STORE_BARRIER ();
+	      txvq->used->idx = last_used_idx;
+	      vhost_user_log_dirty_ring (vui, txvq, idx);
+	    }
 	}
     }
 stop:
-  vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+  if (PREDICT_TRUE (!dma_info))
+    vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+
+  if (in_order && n_rx_packets)
+    vhost_user_input_in_order_used (vui, txvq, last_used_idx, last_desc_head);
 
   txvq->last_used_idx = last_used_idx;
   txvq->last_avail_idx = last_avail_idx;
 
   /* Do the memory copies */
-  if (PREDICT_FALSE (vhost_user_input_copy (vui, cpu->copy, copy_len,
+  if (PREDICT_FALSE (vhost_user_input_copy (vm, b, vui, cpu->copy, copy_len,
 					    &map_hint)))
     {
       vlib_error_count (vm, node->node_index,
 			VHOST_USER_INPUT_FUNC_ERROR_MMAP_FAIL, 1);
     }
 
-  /* give buffers back to driver */
-  CLIB_MEMORY_STORE_BARRIER ();
-  txvq->used->idx = txvq->last_used_idx;
-  vhost_user_log_dirty_ring (vui, txvq, idx);
+  if (dma_info)
+    {
+      u16 n_dma = b ? b->n_enq : 0;
 
-  /* interrupt (call) handling */
-  if ((txvq->callfd_idx != ~0) &&
-      !(txvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
+      if ((txvq->callfd_idx != ~0) &&
+	  !(txvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
+	txvq->n_since_last_int += n_rx_packets;
+
+      vec_set_len (dma_info->buffers, VLIB_FRAME_SIZE - n_left_to_next);
+      dma_info->node = node;
+      dma_info->next_index = next_index;
+      dma_info->used_idx = txvq->last_used_idx;
+      dma_info->finished = (n_dma == 0);
+
+      if (n_dma || vhost_user_dma_in_flight (txvq))
+	vhost_user_dma_info_enqueue (txvq);
+      else
+	vhost_user_input_dma_complete (vm, vui, txvq, dma_info);
+
+      if (b)
+	{
+	  vlib_dma_batch_set_cookie (vm, b, ((u64) vui->if_index << 16) |
+					      VHOST_VRING_IDX_TX (qid));
+	  vlib_dma_batch_submit (vm, b);
+	}
+    }
+  else
     {
-      txvq->n_since_last_int += n_rx_packets;
+      /* give buffers back to driver */
+      CLIB_MEMORY_STORE_BARRIER ();
+      txvq->used->idx = txvq->last_used_idx;
+      vhost_user_log_dirty_ring (vui, txvq, idx);
+
+      /* interrupt (call) handling */
+      if ((txvq->callfd_idx != ~0) &&
+	  !(txvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
+	{
+	  txvq->n_since_last_int += n_rx_packets;
 
-      if (txvq->n_since_last_int > vum->coalesce_frames)
-	vhost_user_send_call (vm, vui, txvq);
+	  if (txvq->n_since_last_int > vum->coalesce_frames)
+	    vhost_user_send_call (vm, vui, txvq);
+	}
     }
 
   /* increase rx counters */
@@ -1423,7 +1601,12 @@ VLIB_NODE_FN (vhost_user_input_node) (vlib_main_t * vm,
 
   vec_foreach (pve, pv)
     {
+      u64 start = 0;
+
       vui = pool_elt_at_index (vum->vhost_user_interfaces, pve->dev_instance);
+      if (PREDICT_FALSE (vum->rebalance_interval > 0))
+	start = clib_cpu_time_now ();
+
       if (vhost_user_is_packed_ring_supported (vui))
 	{
 	  if (vui->features & VIRTIO_FEATURE (VIRTIO_NET_F_CSUM))
@@ -1442,6 +1625,10 @@ VLIB_NODE_FN (vhost_user_input_node) (vlib_main_t * vm,
 	    n_rx_packets +=
 	      vhost_user_if_input (vm, vum, vui, pve->queue_id, node, 0);
 	}
+
+      if (PREDICT_FALSE (start != 0))
+	vui->vrings[VHOST_VRING_IDX_TX (pve->queue_id)].n_clocks +=
+	  clib_cpu_time_now () - start;
     }
 
   return n_rx_packets;
@@ -155,8 +155,9 @@ vhost_user_tx_trace (vhost_trace_t * t,
 }
 
 static_always_inline u32
-vhost_user_tx_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
-		    u16 copy_len, u32 * map_hint)
+vhost_user_tx_copy (vlib_main_t *vm, vlib_dma_batch_t *b,
+		    vhost_user_intf_t *vui, vhost_copy_t *cpy, u16 copy_len,
+		    u32 *map_hint)
 {
   void *dst0, *dst1, *dst2, *dst3;
   if (PREDICT_TRUE (copy_len >= 4))
@@ -180,8 +181,8 @@ vhost_user_tx_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
 	  clib_prefetch_load ((void *) cpy[2].src);
 	  clib_prefetch_load ((void *) cpy[3].src);
 
-	  clib_memcpy_fast (dst0, (void *) cpy[0].src, cpy[0].len);
-	  clib_memcpy_fast (dst1, (void *) cpy[1].src, cpy[1].len);
+	  vhost_user_dma_copy (vm, b, dst0, (void *) cpy[0].src, cpy[0].len);
+	  vhost_user_dma_copy (vm, b, dst1, (void *) cpy[1].src, cpy[1].len);
 
 	  vhost_user_log_dirty_pages_2 (vui, cpy[0].dst, cpy[0].len, 1);
 	  vhost_user_log_dirty_pages_2 (vui, cpy[1].dst, cpy[1].len, 1);
@@ -193,7 +194,7 @@ vhost_user_tx_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
     {
       if (PREDICT_FALSE (!(dst0 = map_guest_mem (vui, cpy->dst, map_hint))))
 	return 1;
-      clib_memcpy_fast (dst0, (void *) cpy->src, cpy->len);
+      vhost_user_dma_copy (vm, b, dst0, (void *) cpy->src, cpy->len);
       vhost_user_log_dirty_pages_2 (vui, cpy->dst, cpy->len, 1);
       copy_len -= 1;
       cpy += 1;
@@ -627,8 +628,8 @@ retry:
        */
       if (PREDICT_FALSE (copy_len >= VHOST_USER_TX_COPY_THRESHOLD) || chained)
 	{
-	  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
-						 &map_hint)))
+	  if (PREDICT_FALSE (vhost_user_tx_copy (vm, 0, vui, cpu->copy,
+						 copy_len, &map_hint)))
 	    vlib_error_count (vm, node->node_index,
 			      VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
 	  copy_len = 0;
@@ -644,7 +645,7 @@ retry:
 done:
   if (PREDICT_TRUE (copy_len))
     {
-      if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
+      if (PREDICT_FALSE (vhost_user_tx_copy (vm, 0, vui, cpu->copy, copy_len,
 					     &map_hint)))
 	vlib_error_count (vm, node->node_index,
 			  VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
@@ -685,6 +686,52 @@ done:
   return frame->n_vectors;
 }
 
+CLIB_MARCH_FN (vhost_user_tx_dma_completion_cb, void, vlib_main_t *vm,
+	       vlib_dma_batch_t *b)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vhost_user_intf_t *vui;
+  vhost_user_vring_t *rxvq;
+  vhost_user_dma_info_t *dma_info;
+
+  if (pool_is_free_index (vum->vhost_user_interfaces, b->cookie >> 16))
+    return;
+
+  vui = pool_elt_at_index (vum->vhost_user_interfaces, b->cookie >> 16);
+  rxvq = vec_elt_at_index (vui->vrings, b->cookie & 0xffff);
+  dma_info = rxvq->dma_info + rxvq->dma_info_head;
+
+  vlib_buffer_free (vm, dma_info->buffers, vec_len (dma_info->buffers));
+  vec_reset_length (dma_info->buffers);
+  vhost_user_dma_info_dequeue (rxvq);
+
+  /* the vring may have been closed while the copies were in flight */
+  if (PREDICT_FALSE (rxvq->used == 0))
+    return;
+
+  /*
+   * Frames copied by the cpu while this batch was in flight are covered
+   * by the last completion.
+   */
+  CLIB_MEMORY_BARRIER ();
+  rxvq->used->idx = vhost_user_dma_in_flight (rxvq) ? dma_info->used_idx :
+							rxvq->last_used_idx;
+  vhost_user_log_dirty_ring (vui, rxvq, idx);
+
+  if ((rxvq->callfd_idx != ~0) &&
+      !(rxvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT) &&
+      (rxvq->n_since_last_int > vum->coalesce_frames))
+    vhost_user_send_call (vm, vui, rxvq);
+}
+
+#ifndef CLIB_MARCH_VARIANT
+void
+vhost_user_tx_dma_completion_cb (vlib_main_t *vm, vlib_dma_batch_t *b)
+{
+  return CLIB_MARCH_FN_SELECT (vhost_user_tx_dma_completion_cb) (vm, b);
+}
+#endif
+
 VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
 						   vlib_node_runtime_t *
 						   node, vlib_frame_t * frame)
@@ -706,6 +753,9 @@ VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
   u16 tx_headers_len;
   u32 or_flags;
   vnet_hw_if_tx_frame_t *tf = vlib_frame_scalar_args (frame);
+  vhost_user_dma_info_t *dma_info = 0;
+  vlib_dma_batch_t *b = 0;
+  u16 n_dma = 0;
 
   if (PREDICT_FALSE (!vui->admin_up))
     {
@@ -734,6 +784,14 @@ VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
   if (vhost_user_is_packed_ring_supported (vui))
     return (vhost_user_device_class_packed (vm, node, frame, vui, rxvq));
 
+  /*
+   * Shared queues stay on the cpu, completions are delivered to the
+   * submitting thread only.
+   */
+  if (vhost_user_dma_enabled (vui, vui->dma_tx_config) && !tf->shared_queue &&
+      (dma_info = vhost_user_dma_info_get (rxvq)))
+    b = vlib_dma_batch_new (vm, vui->dma_tx_config);
+
 retry:
   error = VHOST_USER_TX_FUNC_ERROR_NONE;
   tx_headers_len = 0;
@@ -954,34 +1012,40 @@ retry:
        */
       if (PREDICT_FALSE (copy_len >= VHOST_USER_TX_COPY_THRESHOLD))
 	{
-	  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
-						 &map_hint)))
+	  if (PREDICT_FALSE (vhost_user_tx_copy (vm, b, vui, cpu->copy,
+						 copy_len, &map_hint)))
 	    {
 	      vlib_error_count (vm, node->node_index,
 				VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
 	    }
 	  copy_len = 0;
 
-	  /* give buffers back to driver */
-	  CLIB_MEMORY_BARRIER ();
-	  rxvq->used->idx = rxvq->last_used_idx;
-	  vhost_user_log_dirty_ring (vui, rxvq, idx);
+	  /* give buffers back to driver, unless dma copies are pending */
+	  if (PREDICT_TRUE (!b && !vhost_user_dma_in_flight (rxvq)))
+	    {
+	      CLIB_MEMORY_BARRIER ();
+	      rxvq->used->idx = rxvq->last_used_idx;
+	      vhost_user_log_dirty_ring (vui, rxvq, idx);
+	    }
 	}
       buffers++;
     }
 
 done:
   //Do the memory copies
-  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
+  if (PREDICT_FALSE (vhost_user_tx_copy (vm, b, vui, cpu->copy, copy_len,
 					 &map_hint)))
     {
       vlib_error_count (vm, node->node_index,
 			VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
     }
 
-  CLIB_MEMORY_BARRIER ();
-  rxvq->used->idx = rxvq->last_used_idx;
-  vhost_user_log_dirty_ring (vui, rxvq, idx);
+  if (PREDICT_TRUE (!b && !vhost_user_dma_in_flight (rxvq)))
+    {
+      CLIB_MEMORY_BARRIER ();
+      rxvq->used->idx = rxvq->last_used_idx;
+      vhost_user_log_dirty_ring (vui, rxvq, idx);
+    }
 
   /*
    * When n_left is set, error is always set to something too.
@@ -1001,13 +1065,40 @@ done:
       goto retry;
     }
 
+  if (b)
+    {
+      if ((n_dma = b->n_enq))
+	{
+	  /*
+	   * The copy engine still reads from the buffers, they are freed
+	   * and the used index is published by the completion callback.
+	   */
+	  vec_add (dma_info->buffers, vlib_frame_vector_args (frame),
+		   frame->n_vectors);
+	  dma_info->used_idx = rxvq->last_used_idx;
+	  vhost_user_dma_info_enqueue (rxvq);
+	  vlib_dma_batch_set_cookie (vm, b, ((u64) rd->dev_instance << 16) |
+					      VHOST_VRING_IDX_RX (tf->queue_id));
+	}
+      vlib_dma_batch_submit (vm, b);
+
+      if (!vhost_user_dma_in_flight (rxvq))
+	{
+	  /* everything ended up being copied by the cpu */
+	  CLIB_MEMORY_BARRIER ();
+	  rxvq->used->idx = rxvq->last_used_idx;
+	  vhost_user_log_dirty_ring (vui, rxvq, idx);
+	}
+    }
+
   /* interrupt (call) handling */
   if ((rxvq->callfd_idx != ~0) &&
       !(rxvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
     {
       rxvq->n_since_last_int += frame->n_vectors - n_left;
 
-      if (rxvq->n_since_last_int > vum->coalesce_frames)
+      if (rxvq->n_since_last_int > vum->coalesce_frames &&
+	  !vhost_user_dma_in_flight (rxvq))
 	vhost_user_send_call (vm, vui, rxvq);
     }
 
@@ -1023,7 +1114,8 @@ done3:
 	 thread_index, vui->sw_if_index, n_left);
     }
 
-  vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
+  if (PREDICT_TRUE (n_dma == 0))
+    vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
   return frame->n_vectors;
 }
 
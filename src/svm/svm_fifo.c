@@ -1225,6 +1225,137 @@ svm_fifo_dequeue_drop_all (svm_fifo_t * f)
   clib_atomic_store_rel_n (&f->shr->head, tail);
 }
 
+/**
+ * Move whole chunks from the head of source fifo to the tail of destination
+ *
+ * Only possible if both fifos share the fifo segment, source head is at the
+ * start of its first chunk and destination tail at the end of its last
+ * chunk. The last source chunk is never moved as the producer owns it.
+ */
+static u32
+f_splice_chunks (svm_fifo_t *df, svm_fifo_t *sf, u32 len)
+{
+  u32 s_head, s_tail, d_head, d_tail, n_bytes = 0, start_byte;
+  svm_fifo_chunk_t *c, *first, *last = 0;
+
+  if (df->fs_hdr != sf->fs_hdr ||
+      df->ooos_list_head != OOO_SEGMENT_INVALID_INDEX)
+    return 0;
+
+  f_load_head_tail_cons (sf, &s_head, &s_tail);
+  f_load_head_tail_prod (df, &d_head, &d_tail);
+
+  if (d_tail != f_chunk_end (f_end_cptr (df)))
+    return 0;
+
+  first = f_start_cptr (sf);
+  if (s_head != first->start_byte)
+    return 0;
+
+  c = first;
+  while (c->next && f_pos_leq (f_chunk_end (c), s_tail) &&
+	 n_bytes + c->length <= len && c->enq_rb_index == RBTREE_TNIL_INDEX)
+    {
+      n_bytes += c->length;
+      last = c;
+      c = f_cptr (sf, c->next);
+    }
+
+  if (!last)
+    return 0;
+
+  /* unlink from source as a drop would, minus returning the chunks */
+  first = f_unlink_chunks (sf, s_head + n_bytes, 1);
+  ASSERT (first != 0);
+  sf->shr->head_chunk =
+    f_chunk_includes_pos (f_start_cptr (sf), s_head + n_bytes) ?
+      sf->shr->start_chunk :
+      0;
+
+  /* store-rel: consumer owned index (paired with load-acq in producer) */
+  clib_atomic_store_rel_n (&sf->shr->head, s_head + n_bytes);
+
+  /* renumber in destination byte space and link after its last chunk */
+  start_byte = d_tail;
+  for (c = first; c; c = f_cptr (df, c->next))
+    {
+      c->start_byte = start_byte;
+      c->deq_rb_index = RBTREE_TNIL_INDEX;
+      start_byte += c->length;
+    }
+
+  f_csptr_link (df, df->shr->end_chunk, first);
+  df->shr->end_chunk = f_csptr (df, last);
+  df->shr->tail_chunk = 0;
+
+  /* store-rel: producer owned index (paired with load-acq in consumer) */
+  clib_atomic_store_rel_n (&df->shr->tail, d_tail + n_bytes);
+
+  return n_bytes;
+}
+
+/**
+ * Copy from source to destination fifo, but not past the next chunk
+ * boundary of either fifo, so chunks can be moved afterwards if the two
+ * fifos have their boundaries lined up
+ */
+static int
+f_splice_copy (svm_fifo_t *df, svm_fifo_t *sf, u32 len)
+{
+  u32 d_head, d_tail, n_segs = 1;
+  svm_fifo_seg_t seg;
+  svm_fifo_chunk_t *c;
+  int rv;
+
+  rv = svm_fifo_segments (sf, 0, &seg, &n_segs, len);
+  if (rv <= 0)
+    return rv;
+
+  f_load_head_tail_prod (df, &d_head, &d_tail);
+  c = f_tail_cptr (df);
+  if (c && f_chunk_includes_pos (c, d_tail))
+    seg.len = clib_min (seg.len, f_chunk_end (c) - d_tail);
+
+  rv = svm_fifo_enqueue_segments (df, &seg, 1, 1 /* allow partial */);
+  if (rv <= 0)
+    return rv;
+
+  svm_fifo_dequeue_drop (sf, rv);
+  return rv;
+}
+
+int
+svm_fifo_splice (svm_fifo_t *df, svm_fifo_t *sf, u32 len)
+{
+  u32 head, tail, n_left, n_spliced = 0;
+  int rv;
+
+  f_load_head_tail_cons (sf, &head, &tail);
+  n_left = f_cursize (sf, head, tail);
+  if (PREDICT_FALSE (n_left == 0))
+    return SVM_FIFO_EEMPTY;
+
+  f_load_head_tail_prod (df, &head, &tail);
+  n_left = clib_min (n_left, f_free_count (df, head, tail));
+  if (PREDICT_FALSE (n_left == 0))
+    return SVM_FIFO_EFULL;
+
+  n_left = clib_min (n_left, len);
+
+  while (n_left)
+    {
+      rv = f_splice_chunks (df, sf, n_left);
+      if (!rv)
+	rv = f_splice_copy (df, sf, n_left);
+      if (rv <= 0)
+	break;
+      n_spliced += rv;
+      n_left -= rv;
+    }
+
+  return n_spliced ? n_spliced : rv;
+}
+
 int
 svm_fifo_fill_chunk_list (svm_fifo_t * f)
 {
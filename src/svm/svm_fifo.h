@@ -416,6 +416,23 @@ int svm_fifo_dequeue_drop (svm_fifo_t * f, u32 len);
  * @param f		fifo
  */
 void svm_fifo_dequeue_drop_all (svm_fifo_t * f);
+/**
+ * Move data from one fifo to another
+ *
+ * If both fifos are allocated in the same fifo segment and their chunk
+ * boundaries are aligned, full chunks are unlinked from the head of the
+ * source and linked to the tail of the destination, so no data is copied.
+ * Otherwise, data is copied up to the next chunk boundary, after which
+ * chunks can again be moved. Must be called by the consumer of the source
+ * and the producer of the destination fifo.
+ *
+ * @param df		destination fifo
+ * @param sf		source fifo
+ * @param len		max number of bytes to move
+ * @return		number of bytes moved, SVM_FIFO_EEMPTY if source is
+ * 			empty or SVM_FIFO_EFULL if destination is full
+ */
+int svm_fifo_splice (svm_fifo_t *df, svm_fifo_t *sf, u32 len);
 /**
  * Get pointers to fifo chunks data in @ref svm_fifo_seg_t array
  *
@@ -166,6 +166,7 @@ vcl_worker_cleanup (vcl_worker_t * wrk, u8 notify_vpp)
   clib_bitmap_free (wrk->rd_bitmap);
   clib_bitmap_free (wrk->wr_bitmap);
   clib_bitmap_free (wrk->ex_bitmap);
+  vcl_ring_free (wrk);
   vcl_worker_free (wrk);
   clib_spinlock_unlock (&vcm->workers_lock);
 }
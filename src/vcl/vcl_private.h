@@ -183,6 +183,8 @@ typedef struct vcl_session_
 
   u16 original_dst_port; /**< original dst port (network order) */
   u32 original_dst_ip4;	 /**< original dst ip4 (network order) */
+
+  u32 ring_ops; /**< first pending ring op, see @ref vcl_ring_t */
 } vcl_session_t;
 
 typedef struct vppcom_cfg_t_
@@ -231,6 +233,35 @@ typedef struct vcl_mq_evt_conn_
   int mq_fd;
 } vcl_mq_evt_conn_t;
 
+typedef struct vcl_ring_op_
+{
+  vppcom_ring_sqe_t sqe;
+  u32 next; /**< next pending op of the same session */
+} vcl_ring_op_t;
+
+typedef struct vcl_ring_
+{
+  vppcom_ring_sqe_t *sq; /**< submission ring, filled by app */
+  vppcom_ring_cqe_t *cq; /**< completion ring, filled by vcl */
+  u32 sq_size;		 /**< entries in sq, power of 2 */
+  u32 cq_size;		 /**< entries in cq, power of 2 */
+  u32 sq_head;		 /**< next sqe to be executed */
+  u32 sq_tail;		 /**< next sqe to be handed to app */
+  u32 cq_head;		 /**< next cqe to be reaped */
+  u32 cq_tail;		 /**< next cqe to be filled */
+  u32 n_inflight;	 /**< ops handed to app and not yet reaped */
+
+  /** Pool of ops waiting for session activity */
+  vcl_ring_op_t *ops;
+
+  /** Sessions with pending ops that saw activity */
+  u32 *ready_sessions;
+
+  /** Io events to be sent to vpp at the end of the batch */
+  session_event_t *vpp_evts;
+  svm_msg_q_t **vpp_evt_mqs;
+} vcl_ring_t;
+
 typedef struct vcl_worker_
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -311,6 +342,9 @@ typedef struct vcl_worker_
   int session_attr_op_rv;
   transport_endpt_attr_t session_attr_rv;
 
+  /** Submission/completion rings, if configured */
+  vcl_ring_t *ring;
+
   /** vcl needs next epoll_create to go to libc_epoll */
   u8 vcl_needs_real_epoll;
   volatile int rpc_done;
@@ -389,6 +423,8 @@ extern vppcom_main_t _vppcom_main;
 #define VCL_INVALID_SEGMENT_HANDLE ((u64)~0)
 
 void vcl_session_detach_fifos (vcl_session_t *s);
+void vcl_ring_session_cleanup (vcl_worker_t *wrk, vcl_session_t *s);
+void vcl_ring_free (vcl_worker_t *wrk);
 
 static inline vcl_session_t *
 vcl_session_alloc (vcl_worker_t * wrk)
@@ -398,6 +434,7 @@ vcl_session_alloc (vcl_worker_t * wrk)
   memset (s, 0, sizeof (*s));
   s->session_index = s - wrk->sessions;
   s->listener_index = VCL_INVALID_SESSION_INDEX;
+  s->ring_ops = VCL_INVALID_SESSION_INDEX;
   return s;
 }
 
@@ -406,6 +443,8 @@ vcl_session_free (vcl_worker_t * wrk, vcl_session_t * s)
 {
   /* Debug level set to 1 to avoid debug messages while ldp is cleaning up */
   VDBG (1, "session %u [0x%llx] removed", s->session_index, s->vpp_handle);
+  if (PREDICT_FALSE (s->ring_ops != VCL_INVALID_SESSION_INDEX))
+    vcl_ring_session_cleanup (wrk, s);
   vcl_session_detach_fifos (s);
   if (s->ext_config)
     clib_mem_free (s->ext_config);
@@ -2365,6 +2365,80 @@ vppcom_session_write_msg (uint32_t session_handle, void *buf, size_t n)
 				      s->is_dgram ? 1 : 0);
 }
 
+int
+vppcom_session_splice (uint32_t dst_session_handle,
+		       uint32_t src_session_handle, uint32_t n_bytes)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  svm_fifo_t *rx_fifo, *tx_fifo;
+  vcl_session_t *src, *dst;
+  session_event_t *e;
+  int rv;
+
+  src = vcl_session_get_w_handle (wrk, src_session_handle);
+  dst = vcl_session_get_w_handle (wrk, dst_session_handle);
+  if (PREDICT_FALSE (!src || !dst || src == dst))
+    return VPPCOM_EBADFD;
+
+  if (PREDICT_FALSE ((src->flags | dst->flags) & VCL_SESSION_F_IS_VEP ||
+		     src->is_dgram || dst->is_dgram))
+    return VPPCOM_EBADFD;
+
+  if (PREDICT_FALSE (!vcl_session_is_open (src)))
+    return vcl_session_closed_error (src);
+  if (PREDICT_FALSE (!vcl_session_is_open (dst)))
+    return vcl_session_closed_error (dst);
+  if (PREDICT_FALSE (dst->flags & VCL_SESSION_F_WR_SHUTDOWN))
+    return VPPCOM_EPIPE;
+
+  rx_fifo = vcl_session_is_ct (src) ? src->ct_rx_fifo : src->rx_fifo;
+  tx_fifo = vcl_session_is_ct (dst) ? dst->ct_tx_fifo : dst->tx_fifo;
+  src->flags &= ~VCL_SESSION_F_HAS_RX_EVT;
+
+  rv = svm_fifo_splice (tx_fifo, rx_fifo, n_bytes);
+
+  if (svm_fifo_is_empty_cons (rx_fifo))
+    {
+      if (vcl_session_is_ct (src))
+	svm_fifo_unset_event (src->rx_fifo);
+      svm_fifo_unset_event (rx_fifo);
+      if (!svm_fifo_is_empty_cons (rx_fifo) && svm_fifo_set_event (rx_fifo))
+	{
+	  vec_add2 (wrk->unhandled_evts_vector, e, 1);
+	  e->event_type = SESSION_IO_EVT_RX;
+	  e->session_index = src->session_index;
+	}
+    }
+
+  if (rv <= 0)
+    {
+      if (rv == SVM_FIFO_EFULL)
+	svm_fifo_add_want_deq_ntf (tx_fifo, SVM_FIFO_WANT_DEQ_NOTIF);
+      if (rv == SVM_FIFO_EEMPTY && vcl_session_is_closing (src))
+	return vcl_session_closing_error (src);
+      return VPPCOM_EWOULDBLOCK;
+    }
+
+  if (PREDICT_FALSE (svm_fifo_needs_deq_ntf (rx_fifo, rv)))
+    {
+      svm_fifo_clear_deq_ntf (rx_fifo);
+      app_send_io_evt_to_vpp (src->vpp_evt_q,
+			      src->rx_fifo->shr->master_session_index,
+			      SESSION_IO_EVT_RX, SVM_Q_WAIT);
+    }
+
+  if (svm_fifo_set_event (dst->tx_fifo))
+    app_send_io_evt_to_vpp (dst->vpp_evt_q,
+			    dst->tx_fifo->shr->master_session_index,
+			    SESSION_IO_EVT_TX, SVM_Q_WAIT);
+
+  VDBG (2, "session %u [0x%llx]: spliced %d bytes to session %u [0x%llx]",
+	src->session_index, src->vpp_handle, rv, dst->session_index,
+	dst->vpp_handle);
+
+  return rv;
+}
+
 #define vcl_fifo_rx_evt_valid_or_break(_s)				\
 if (PREDICT_FALSE (!_s->rx_fifo))					\
   break;								\
@@ -3559,6 +3633,666 @@ vppcom_epoll_wait (uint32_t vep_handle, struct epoll_event *events,
   return n_evts;
 }
 
+static inline void
+vcl_ring_complete (vcl_ring_t *r, u64 user_data, int res)
+{
+  vppcom_ring_cqe_t *cqe;
+
+  /* n_inflight bounds the number of ops so the cq never overflows */
+  ASSERT (r->cq_tail - r->cq_head < r->cq_size);
+  cqe = &r->cq[r->cq_tail & (r->cq_size - 1)];
+  cqe->user_data = user_data;
+  cqe->res = res;
+  r->cq_tail += 1;
+}
+
+static inline void
+vcl_ring_add_vpp_evt (vcl_ring_t *r, svm_msg_q_t *mq, u32 session_index,
+		      u8 evt_type)
+{
+  session_event_t *e;
+
+  vec_add2 (r->vpp_evts, e, 1);
+  e->session_index = session_index;
+  e->event_type = evt_type;
+  vec_add1 (r->vpp_evt_mqs, mq);
+}
+
+static void
+vcl_ring_flush_vpp_evts (vcl_ring_t *r)
+{
+  u32 i, first = 0, n_evts = vec_len (r->vpp_evts);
+
+  if (!n_evts)
+    return;
+
+  /* one lock, and at most one signal, per run of events for the same mq */
+  for (i = 1; i <= n_evts; i++)
+    {
+      if (i < n_evts && r->vpp_evt_mqs[i] == r->vpp_evt_mqs[first])
+	continue;
+      app_send_io_evts_to_vpp (r->vpp_evt_mqs[first], r->vpp_evts + first,
+			       i - first);
+      first = i;
+    }
+
+  vec_reset_length (r->vpp_evts);
+  vec_reset_length (r->vpp_evt_mqs);
+}
+
+static int
+vcl_ring_recv (vcl_worker_t *wrk, vcl_ring_t *r, vcl_session_t *s,
+	       vppcom_ring_sqe_t *sqe)
+{
+  svm_fifo_t *rx_fifo;
+  u8 is_ct;
+  int rv;
+
+  if (PREDICT_FALSE (!vcl_session_is_open (s)))
+    return vcl_session_closed_error (s);
+
+  is_ct = vcl_session_is_ct (s);
+  rx_fifo = is_ct ? s->ct_rx_fifo : s->rx_fifo;
+  s->flags &= ~VCL_SESSION_F_HAS_RX_EVT;
+
+  if (svm_fifo_is_empty_cons (rx_fifo))
+    {
+      if (is_ct)
+	svm_fifo_unset_event (s->rx_fifo);
+      svm_fifo_unset_event (rx_fifo);
+      /* Data enqueued before event was unset generates no event */
+      if (svm_fifo_is_empty_cons (rx_fifo))
+	{
+	  if (vcl_session_is_closing (s))
+	    return vcl_session_closing_error (s);
+	  return VPPCOM_EWOULDBLOCK;
+	}
+    }
+
+  if (s->is_dgram)
+    rv = app_recv_dgram_raw (rx_fifo, sqe->buf, sqe->len, &s->transport, 0,
+			     0);
+  else
+    rv = app_recv_stream_raw (rx_fifo, sqe->buf, sqe->len, 0, 0);
+
+  if (svm_fifo_is_empty_cons (rx_fifo))
+    {
+      if (is_ct)
+	svm_fifo_unset_event (s->rx_fifo);
+      svm_fifo_unset_event (rx_fifo);
+      if (!svm_fifo_is_empty_cons (rx_fifo) && svm_fifo_set_event (rx_fifo))
+	vec_add1 (r->ready_sessions, s->session_index);
+    }
+
+  if (PREDICT_FALSE (svm_fifo_needs_deq_ntf (rx_fifo, rv)))
+    {
+      svm_fifo_clear_deq_ntf (rx_fifo);
+      vcl_ring_add_vpp_evt (r, s->vpp_evt_q,
+			    s->rx_fifo->shr->master_session_index,
+			    SESSION_IO_EVT_RX);
+    }
+
+  return rv;
+}
+
+static int
+vcl_ring_send (vcl_worker_t *wrk, vcl_ring_t *r, vcl_session_t *s,
+	       vppcom_ring_sqe_t *sqe)
+{
+  session_evt_type_t et = SESSION_IO_EVT_TX;
+  svm_fifo_t *tx_fifo;
+  int n_write;
+
+  if (PREDICT_FALSE (!vcl_session_is_open (s)))
+    return vcl_session_closed_error (s);
+
+  if (PREDICT_FALSE (s->flags & VCL_SESSION_F_WR_SHUTDOWN))
+    return VPPCOM_EPIPE;
+
+  if (PREDICT_FALSE (!sqe->len))
+    return VPPCOM_OK;
+
+  tx_fifo = vcl_session_is_ct (s) ? s->ct_tx_fifo : s->tx_fifo;
+  if (!vcl_fifo_is_writeable (tx_fifo, sqe->len, s->is_dgram))
+    {
+      svm_fifo_add_want_deq_ntf (tx_fifo, SVM_FIFO_WANT_DEQ_NOTIF);
+      /* Space freed before notification was requested generates no event */
+      if (!vcl_fifo_is_writeable (tx_fifo, sqe->len, s->is_dgram))
+	{
+	  if (vcl_session_is_closing (s))
+	    return vcl_session_closing_error (s);
+	  return VPPCOM_EWOULDBLOCK;
+	}
+    }
+
+  if (s->is_dgram)
+    {
+      et = vcl_session_dgram_tx_evt (s, et);
+      n_write = app_send_dgram_raw_gso (
+	tx_fifo, &s->transport, s->vpp_evt_q, sqe->buf, sqe->len, s->gso_size,
+	et, 0 /* do_evt */, SVM_Q_WAIT);
+    }
+  else
+    {
+      n_write = app_send_stream_raw (tx_fifo, s->vpp_evt_q, sqe->buf,
+				     sqe->len, et, 0 /* do_evt */, SVM_Q_WAIT);
+    }
+
+  /* Coalesced with the other tx events of the batch */
+  if (svm_fifo_set_event (s->tx_fifo))
+    vcl_ring_add_vpp_evt (r, s->vpp_evt_q,
+			  s->tx_fifo->shr->master_session_index, et);
+
+  /* The underlying fifo segment can run out of memory */
+  if (PREDICT_FALSE (n_write < 0))
+    return VPPCOM_EAGAIN;
+
+  return n_write;
+}
+
+static int
+vcl_ring_accept (vcl_worker_t *wrk, vcl_session_t *ls, vppcom_ring_sqe_t *sqe)
+{
+  if (ls->session_state != VCL_STATE_LISTEN &&
+      ls->session_state != VCL_STATE_LISTEN_NO_MQ)
+    return VPPCOM_EBADFD;
+
+  if (!clib_fifo_elts (ls->accept_evts_fifo))
+    return VPPCOM_EWOULDBLOCK;
+
+  return vppcom_session_accept (vcl_session_handle (ls), sqe->buf,
+				sqe->flags);
+}
+
+/**
+ * Try to execute op, returns VPPCOM_EWOULDBLOCK if it should be retried
+ * once session sees activity. Session pool may grow, i.e., on accept, so
+ * session pointer must be reloaded by caller.
+ */
+static int
+vcl_ring_op_try (vcl_worker_t *wrk, vcl_ring_t *r, vcl_session_t *s,
+		 vppcom_ring_sqe_t *sqe)
+{
+  switch (sqe->op)
+    {
+    case VPPCOM_RING_OP_RECV:
+      return vcl_ring_recv (wrk, r, s, sqe);
+    case VPPCOM_RING_OP_SEND:
+      return vcl_ring_send (wrk, r, s, sqe);
+    case VPPCOM_RING_OP_ACCEPT:
+      return vcl_ring_accept (wrk, s, sqe);
+    default:
+      return VPPCOM_EINVAL;
+    }
+}
+
+static void
+vcl_ring_op_park (vcl_ring_t *r, vcl_session_t *s, vppcom_ring_sqe_t *sqe)
+{
+  vcl_ring_op_t *op, *last;
+  u32 oi;
+
+  pool_get (r->ops, op);
+  op->sqe = *sqe;
+  op->next = VCL_INVALID_SESSION_INDEX;
+
+  /* Ops of a session are retried in submission order */
+  if (s->ring_ops == VCL_INVALID_SESSION_INDEX)
+    {
+      s->ring_ops = op - r->ops;
+      return;
+    }
+  oi = s->ring_ops;
+  do
+    {
+      last = pool_elt_at_index (r->ops, oi);
+      oi = last->next;
+    }
+  while (oi != VCL_INVALID_SESSION_INDEX);
+  last->next = op - r->ops;
+}
+
+static u8
+vcl_ring_session_has_op (vcl_ring_t *r, vcl_session_t *s, u8 op_type)
+{
+  vcl_ring_op_t *op;
+  u32 oi = s->ring_ops;
+
+  while (oi != VCL_INVALID_SESSION_INDEX)
+    {
+      op = pool_elt_at_index (r->ops, oi);
+      if (op->sqe.op == op_type)
+	return 1;
+      oi = op->next;
+    }
+  return 0;
+}
+
+static void
+vcl_ring_session_retry (vcl_worker_t *wrk, vcl_ring_t *r, u32 session_index)
+{
+  u32 oi, prev = VCL_INVALID_SESSION_INDEX, blocked = 0;
+  vcl_ring_op_t *op;
+  vcl_session_t *s;
+  int rv;
+
+  s = vcl_session_get (wrk, session_index);
+  if (!s)
+    return;
+
+  oi = s->ring_ops;
+  while (oi != VCL_INVALID_SESSION_INDEX)
+    {
+      op = pool_elt_at_index (r->ops, oi);
+
+      /* Do not reorder ops of the same type */
+      if (blocked & (1 << op->sqe.op))
+	{
+	  prev = oi;
+	  oi = op->next;
+	  continue;
+	}
+
+      rv = vcl_ring_op_try (wrk, r, s, &op->sqe);
+      s = vcl_session_get (wrk, session_index);
+      op = pool_elt_at_index (r->ops, oi);
+
+      if (rv == VPPCOM_EWOULDBLOCK)
+	{
+	  blocked |= 1 << op->sqe.op;
+	  prev = oi;
+	  oi = op->next;
+	  continue;
+	}
+
+      vcl_ring_complete (r, op->sqe.user_data, rv);
+      if (prev == VCL_INVALID_SESSION_INDEX)
+	s->ring_ops = op->next;
+      else
+	pool_elt_at_index (r->ops, prev)->next = op->next;
+      oi = op->next;
+      pool_put (r->ops, op);
+    }
+}
+
+static void
+vcl_ring_session_cancel (vcl_ring_t *r, vcl_session_t *s, int res)
+{
+  vcl_ring_op_t *op;
+  u32 oi = s->ring_ops;
+
+  while (oi != VCL_INVALID_SESSION_INDEX)
+    {
+      op = pool_elt_at_index (r->ops, oi);
+      vcl_ring_complete (r, op->sqe.user_data, res);
+      oi = op->next;
+      pool_put (r->ops, op);
+    }
+  s->ring_ops = VCL_INVALID_SESSION_INDEX;
+}
+
+void
+vcl_ring_session_cleanup (vcl_worker_t *wrk, vcl_session_t *s)
+{
+  if (!wrk->ring)
+    {
+      s->ring_ops = VCL_INVALID_SESSION_INDEX;
+      return;
+    }
+  vcl_ring_session_cancel (wrk->ring, s, VPPCOM_ECANCELED);
+}
+
+static inline void
+vcl_ring_session_ready (vcl_ring_t *r, vcl_session_t *s)
+{
+  if (s->ring_ops != VCL_INVALID_SESSION_INDEX)
+    vec_add1 (r->ready_sessions, s->session_index);
+}
+
+static void
+vcl_ring_handle_mq_event (vcl_worker_t *wrk, vcl_ring_t *r,
+			  session_event_t *e)
+{
+  vcl_session_t *s;
+  u32 sid;
+
+  switch (e->event_type)
+    {
+    case SESSION_IO_EVT_RX:
+      if (!(s = vcl_session_get (wrk, e->session_index)))
+	break;
+      vcl_ring_session_ready (r, s);
+      break;
+    case SESSION_IO_EVT_TX:
+      if (!(s = vcl_session_get (wrk, e->session_index)))
+	break;
+      svm_fifo_reset_has_deq_ntf (vcl_session_is_ct (s) ? s->ct_tx_fifo :
+							    s->tx_fifo);
+      vcl_ring_session_ready (r, s);
+      break;
+    case SESSION_CTRL_EVT_ACCEPTED:
+      if (!e->postponed)
+	s = vcl_session_accepted (wrk, (session_accepted_msg_t *) e->data);
+      else
+	s = vcl_session_get (wrk, e->session_index);
+      if (s)
+	vcl_ring_session_ready (r, s);
+      break;
+    case SESSION_CTRL_EVT_CONNECTED:
+      if (!e->postponed)
+	vcl_session_connected_handler (wrk,
+				       (session_connected_msg_t *) e->data);
+      break;
+    case SESSION_CTRL_EVT_DISCONNECTED:
+    case SESSION_CTRL_EVT_RESET:
+      if (!e->postponed)
+	{
+	  if (e->event_type == SESSION_CTRL_EVT_DISCONNECTED)
+	    s = vcl_session_disconnected_handler (
+	      wrk, (session_disconnected_msg_t *) e->data);
+	  else
+	    {
+	      sid = vcl_session_reset_handler (
+		wrk, (session_reset_msg_t *) e->data);
+	      s = vcl_session_get (wrk, sid);
+	    }
+	}
+      else
+	{
+	  s = vcl_session_get (wrk, e->session_index);
+	  if (s)
+	    s->flags &= ~VCL_SESSION_F_PENDING_DISCONNECT;
+	}
+      if (!s)
+	break;
+      /* Pending ops complete with closing errors */
+      sid = s->session_index;
+      vcl_ring_session_retry (wrk, r, sid);
+      s = vcl_session_get (wrk, sid);
+      if (s && (s->flags & VCL_SESSION_F_PENDING_FREE))
+	vcl_session_free (wrk, s);
+      break;
+    default:
+      vcl_handle_mq_event (wrk, e);
+      break;
+    }
+}
+
+static void
+vcl_ring_handle_mq (vcl_worker_t *wrk, vcl_ring_t *r, svm_msg_q_t *mq)
+{
+  svm_msg_q_msg_t *msg;
+  session_event_t *e;
+  int i;
+
+  vcl_mq_dequeue_batch (wrk, mq, ~0);
+
+  for (i = 0; i < vec_len (wrk->mq_msg_vector); i++)
+    {
+      msg = vec_elt_at_index (wrk->mq_msg_vector, i);
+      e = svm_msg_q_msg_data (mq, msg);
+      vcl_ring_handle_mq_event (wrk, r, e);
+      svm_msg_q_free_msg (mq, msg);
+    }
+  vec_reset_length (wrk->mq_msg_vector);
+  vcl_handle_pending_wrk_updates (wrk);
+}
+
+static void
+vcl_ring_wait_mq (vcl_worker_t *wrk, vcl_ring_t *r, double wait_for_time)
+{
+  int __clib_unused n_read;
+  vcl_mq_evt_conn_t *mqc;
+  svm_msg_q_t *mq;
+  int n_mq_evts, i;
+  u64 buf;
+
+  if (!vcm->cfg.use_mq_eventfd)
+    {
+      mq = wrk->app_event_queue;
+      if (svm_msg_q_is_empty (mq))
+	{
+	  if (!wait_for_time)
+	    return;
+	  else if (wait_for_time < 0)
+	    svm_msg_q_wait (mq, SVM_MQ_WAIT_EMPTY);
+	  else if (svm_msg_q_timedwait (mq, wait_for_time / 1e3))
+	    return;
+	}
+      vcl_ring_handle_mq (wrk, r, mq);
+      return;
+    }
+
+  if (PREDICT_FALSE (wrk->api_client_handle == ~0))
+    {
+      vcl_api_retry_attach (wrk);
+      return;
+    }
+
+  vec_validate (wrk->mq_events, pool_elts (wrk->mq_evt_conns));
+  n_mq_evts = epoll_wait (wrk->mqs_epfd, wrk->mq_events,
+			  vec_len (wrk->mq_events), wait_for_time);
+  for (i = 0; i < n_mq_evts; i++)
+    {
+      if (PREDICT_FALSE (wrk->mq_events[i].data.u32 == ~0))
+	{
+	  /* api socket was closed */
+	  vcl_api_handle_disconnect (wrk);
+	  continue;
+	}
+      mqc = vcl_mq_evt_conn_get (wrk, wrk->mq_events[i].data.u32);
+      n_read = read (mqc->mq_fd, &buf, sizeof (buf));
+      vcl_ring_handle_mq (wrk, r, mqc->mq);
+    }
+}
+
+static void
+vcl_ring_retry_ready (vcl_worker_t *wrk, vcl_ring_t *r)
+{
+  u32 *ready = 0, *si;
+
+  while (vec_len (r->ready_sessions))
+    {
+      /* Retries can mark sessions ready again */
+      ready = r->ready_sessions;
+      r->ready_sessions = 0;
+      vec_foreach (si, ready)
+	vcl_ring_session_retry (wrk, r, *si);
+      if (r->ready_sessions == 0)
+	{
+	  vec_reset_length (ready);
+	  r->ready_sessions = ready;
+	  break;
+	}
+      vec_free (ready);
+    }
+  vcl_ring_flush_vpp_evts (r);
+}
+
+int
+vppcom_ring_setup (uint32_t n_entries)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  vcl_ring_t *r;
+
+  if (!n_entries)
+    return VPPCOM_EINVAL;
+
+  if (wrk->ring)
+    return VPPCOM_EEXIST;
+
+  r = clib_mem_alloc (sizeof (*r));
+  clib_memset (r, 0, sizeof (*r));
+  r->sq_size = 1 << max_log2 (n_entries);
+  r->cq_size = 2 * r->sq_size;
+  vec_validate (r->sq, r->sq_size - 1);
+  vec_validate (r->cq, r->cq_size - 1);
+  wrk->ring = r;
+
+  VDBG (0, "worker %u: ring with %u entries", wrk->wrk_index, r->sq_size);
+
+  return VPPCOM_OK;
+}
+
+void
+vcl_ring_free (vcl_worker_t *wrk)
+{
+  vcl_ring_t *r = wrk->ring;
+  vcl_session_t *s;
+
+  if (!r)
+    return;
+
+  pool_foreach (s, wrk->sessions)
+    s->ring_ops = VCL_INVALID_SESSION_INDEX;
+
+  vec_free (r->sq);
+  vec_free (r->cq);
+  pool_free (r->ops);
+  vec_free (r->ready_sessions);
+  vec_free (r->vpp_evts);
+  vec_free (r->vpp_evt_mqs);
+  clib_mem_free (r);
+  wrk->ring = 0;
+}
+
+void
+vppcom_ring_free (void)
+{
+  vcl_ring_free (vcl_worker_get_current ());
+}
+
+vppcom_ring_sqe_t *
+vppcom_ring_get_sqe (void)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  vppcom_ring_sqe_t *sqe;
+  vcl_ring_t *r = wrk->ring;
+
+  if (PREDICT_FALSE (!r))
+    return 0;
+
+  if (r->sq_tail - r->sq_head == r->sq_size || r->n_inflight == r->cq_size)
+    return 0;
+
+  sqe = &r->sq[r->sq_tail & (r->sq_size - 1)];
+  clib_memset (sqe, 0, sizeof (*sqe));
+  r->sq_tail += 1;
+  r->n_inflight += 1;
+
+  return sqe;
+}
+
+int
+vppcom_ring_submit (void)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  vcl_ring_t *r = wrk->ring;
+  vppcom_ring_sqe_t *sqe;
+  vcl_session_t *s;
+  u32 n_sqes = 0;
+  int rv;
+
+  if (PREDICT_FALSE (!r))
+    return VPPCOM_EINVAL;
+
+  while (r->sq_head != r->sq_tail)
+    {
+      sqe = &r->sq[r->sq_head & (r->sq_size - 1)];
+      r->sq_head += 1;
+      n_sqes += 1;
+
+      if (sqe->op == VPPCOM_RING_OP_NOP)
+	{
+	  vcl_ring_complete (r, sqe->user_data, VPPCOM_OK);
+	  continue;
+	}
+
+      s = vcl_session_get_w_handle (wrk, sqe->session_handle);
+      if (PREDICT_FALSE (!s || (s->flags & VCL_SESSION_F_IS_VEP)))
+	{
+	  vcl_ring_complete (r, sqe->user_data, VPPCOM_EBADFD);
+	  continue;
+	}
+
+      if (sqe->op == VPPCOM_RING_OP_CLOSE)
+	{
+	  vcl_ring_session_cancel (r, s, VPPCOM_ECANCELED);
+	  rv = vppcom_session_close (sqe->session_handle);
+	  vcl_ring_complete (r, sqe->user_data, rv);
+	  continue;
+	}
+
+      if (PREDICT_FALSE (sqe->op >= VPPCOM_RING_N_OPS))
+	{
+	  vcl_ring_complete (r, sqe->user_data, VPPCOM_EINVAL);
+	  continue;
+	}
+
+      /* Wait behind ops of same type that are already pending */
+      if (vcl_ring_session_has_op (r, s, sqe->op))
+	{
+	  vcl_ring_op_park (r, s, sqe);
+	  continue;
+	}
+
+      rv = vcl_ring_op_try (wrk, r, s, sqe);
+      if (rv == VPPCOM_EWOULDBLOCK)
+	{
+	  s = vcl_session_get_w_handle (wrk, sqe->session_handle);
+	  vcl_ring_op_park (r, s, sqe);
+	  continue;
+	}
+      vcl_ring_complete (r, sqe->user_data, rv);
+    }
+
+  vcl_ring_retry_ready (wrk, r);
+
+  return n_sqes;
+}
+
+int
+vppcom_ring_wait (vppcom_ring_cqe_t *cqes, uint32_t max_cqes,
+		  double wait_for_time)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  vcl_ring_t *r = wrk->ring;
+  u32 n_cqes = 0, i;
+  double end = -1;
+
+  if (PREDICT_FALSE (!r || !max_cqes))
+    return VPPCOM_EINVAL;
+
+  if (wait_for_time > 0)
+    end = clib_time_now (&wrk->clib_time) + (wait_for_time / 1e3);
+
+  /* Events dequeued by non-ring apis */
+  for (i = 0; i < vec_len (wrk->unhandled_evts_vector); i++)
+    vcl_ring_handle_mq_event (wrk, r, &wrk->unhandled_evts_vector[i]);
+  vec_reset_length (wrk->unhandled_evts_vector);
+
+  vcl_ring_retry_ready (wrk, r);
+
+  do
+    {
+      /* Always drain the mq, but only block if nothing completed */
+      vcl_ring_wait_mq (wrk, r,
+			r->cq_tail != r->cq_head ? 0 : wait_for_time);
+      vcl_ring_retry_ready (wrk, r);
+    }
+  while (r->cq_tail == r->cq_head && wait_for_time &&
+	 (end == -1 || clib_time_now (&wrk->clib_time) < end));
+
+  while (r->cq_head != r->cq_tail && n_cqes < max_cqes)
+    {
+      cqes[n_cqes++] = r->cq[r->cq_head & (r->cq_size - 1)];
+      r->cq_head += 1;
+    }
+  r->n_inflight -= n_cqes;
+
+  return n_cqes;
+}
+
 int
 vppcom_session_attr (uint32_t session_handle, uint32_t op,
 		     void *buffer, uint32_t * buflen)
@@ -4660,6 +5394,10 @@ vppcom_retval_str (int retval)
       st = "VPPCOM_EADDRINUSE";
       break;
 
+    case VPPCOM_ECANCELED:
+      st = "VPPCOM_ECANCELED";
+      break;
+
     default:
       st = "UNKNOWN_STATE";
       break;
@@ -128,7 +128,8 @@ typedef enum
   VPPCOM_EPIPE = -EPIPE,
   VPPCOM_ENOENT = -ENOENT,
   VPPCOM_EADDRINUSE = -EADDRINUSE,
-  VPPCOM_ENOTSUP = -ENOTSUP
+  VPPCOM_ENOTSUP = -ENOTSUP,
+  VPPCOM_ECANCELED = -ECANCELED
 } vppcom_error_t;
 
 typedef enum
@@ -197,6 +198,32 @@ typedef vppcom_data_segment_t vppcom_data_segments_t[2];
 
 typedef unsigned long vcl_si_set;
 
+typedef enum vppcom_ring_op_
+{
+  VPPCOM_RING_OP_NOP,
+  VPPCOM_RING_OP_RECV,
+  VPPCOM_RING_OP_SEND,
+  VPPCOM_RING_OP_ACCEPT,
+  VPPCOM_RING_OP_CLOSE,
+  VPPCOM_RING_N_OPS,
+} vppcom_ring_op_t;
+
+typedef struct vppcom_ring_sqe_
+{
+  uint8_t op;			/**< see @ref vppcom_ring_op_t */
+  uint32_t flags;		/**< accept flags, i.e., O_NONBLOCK */
+  uint32_t session_handle;	/**< session the op applies to */
+  uint32_t len;			/**< buffer length */
+  void *buf;			/**< data buffer or endpoint for accept */
+  uint64_t user_data;		/**< opaque, copied to completion */
+} vppcom_ring_sqe_t;
+
+typedef struct vppcom_ring_cqe_
+{
+  uint64_t user_data;		/**< user data of the completed op */
+  int32_t res;			/**< bytes, accepted session or error */
+} vppcom_ring_cqe_t;
+
 /*
  * VPPCOM Public API Functions
  */
@@ -253,6 +280,14 @@ extern int vppcom_session_read_segments (uint32_t session_handle,
 					 uint32_t max_bytes);
 extern void vppcom_session_free_segments (uint32_t session_handle,
 					  uint32_t n_bytes);
+/**
+ * Move up to n_bytes of stream data from src session's rx fifo to dst
+ * session's tx fifo. Fifo chunks are relinked instead of copied whenever
+ * the fifos allow it. Never blocks.
+ */
+extern int vppcom_session_splice (uint32_t dst_session_handle,
+				  uint32_t src_session_handle,
+				  uint32_t n_bytes);
 extern int vppcom_add_cert_key_pair (vppcom_cert_key_pair_t *ckpair);
 extern int vppcom_del_cert_key_pair (uint32_t ckpair_index);
 extern int vppcom_unformat_proto (uint8_t * proto, char *proto_str);
@@ -309,6 +344,49 @@ extern int vppcom_session_get_error (uint32_t session_handle);
  */
 extern int vppcom_worker_is_detached (void);
 
+/**
+ * Allocate current worker's submission and completion rings
+ *
+ * Ops posted to the submission ring are executed in batches by
+ * @ref vppcom_ring_submit. Ops that cannot complete immediately are kept
+ * pending until vpp reports session activity, which is collected by
+ * @ref vppcom_ring_wait. Io notifications to vpp are sent once per batch.
+ * Workers that use the rings should not also use epoll or select.
+ *
+ * @param n_entries	submission ring size, rounded up to power of 2
+ */
+extern int vppcom_ring_setup (uint32_t n_entries);
+
+/**
+ * Free current worker's rings, pending ops are dropped
+ */
+extern void vppcom_ring_free (void);
+
+/**
+ * Get next free submission ring entry
+ *
+ * @return entry or 0 if ring is full or too many ops are in flight
+ */
+extern vppcom_ring_sqe_t *vppcom_ring_get_sqe (void);
+
+/**
+ * Execute all posted submission ring entries
+ *
+ * @return number of entries consumed or negative error
+ */
+extern int vppcom_ring_submit (void);
+
+/**
+ * Collect completions, waiting for session activity if none available
+ *
+ * @param cqes		array where completions are copied
+ * @param max_cqes	size of cqes array
+ * @param wait_for_time	ms to wait, 0 to not wait, negative to wait forever
+ * @return number of completions or negative error
+ */
+extern int vppcom_ring_wait (vppcom_ring_cqe_t *cqes, uint32_t max_cqes,
+			     double wait_for_time);
+
 #ifdef __cplusplus
 }
 #endif
@@ -480,6 +480,136 @@ vlib_buffer_alloc_size (uword ext_hdr_size, uword data_size)
   return alloc_size;
 }
 
+u32
+vlib_buffer_pool_n_avail (vlib_buffer_pool_t *bp)
+{
+  vlib_buffer_pool_shard_t *s;
+  u32 n_avail = 0;
+
+  vec_foreach (s, bp->shards)
+    n_avail += s->n_avail;
+
+  return n_avail;
+}
+
+u32
+vlib_buffer_pool_steal (vlib_buffer_pool_t *bp, u32 shard, u32 *buffers,
+			u32 n_buffers)
+{
+  u32 i, n_shards = vec_len (bp->shards), n = 0;
+
+  for (i = 1; i < n_shards && n < n_buffers; i++)
+    {
+      vlib_buffer_pool_shard_t *s = bp->shards + (shard + i) % n_shards;
+      if (s->n_avail)
+	n += vlib_buffer_pool_shard_get (s, buffers + n, n_buffers - n);
+    }
+
+  return n;
+}
+
+void
+vlib_buffer_pool_spill (vlib_buffer_pool_t *bp, u32 shard, u32 *buffers,
+			u32 n_buffers)
+{
+  u32 i, n_shards = vec_len (bp->shards), n = 0;
+
+  /* shards can hold all buffers of the pool together, so there is always
+     room in one of them */
+  for (i = 1; i <= n_shards && n < n_buffers; i++)
+    {
+      vlib_buffer_pool_shard_t *s = bp->shards + (shard + i) % n_shards;
+      n += vlib_buffer_pool_shard_put (s, bp->shard_size, buffers + n,
+				       n_buffers - n);
+    }
+
+  ASSERT (n == n_buffers);
+}
+
+u32
+vlib_buffer_alloc_numa_fallback (vlib_main_t *vm, u32 *buffers, u32 n_buffers,
+				 u8 buffer_pool_index)
+{
+  vlib_buffer_pool_t *bp = vlib_get_buffer_pool (vm, buffer_pool_index);
+  vlib_buffer_pool_thread_t *bpt =
+    vec_elt_at_index (bp->threads, vm->thread_index);
+  u32 n_alloc = 0;
+  u8 *index;
+
+  vec_foreach (index, bp->numa_fallback_pools)
+    {
+      n_alloc += vlib_buffer_alloc_from_pool (vm, buffers + n_alloc,
+					      n_buffers - n_alloc, index[0]);
+      if (n_alloc == n_buffers)
+	break;
+    }
+
+  bpt->n_numa_fallback += n_alloc;
+  return n_alloc;
+}
+
+/* Resize per-thread data and redistribute free buffers over one shard per
+   thread, or configured number of shards. Must not race with buffer
+   alloc and free, so runs at pool creation or under barrier. */
+static void
+vlib_buffer_pool_set_n_threads (vlib_buffer_main_t *bm,
+				vlib_buffer_pool_t *bp, u32 n_threads)
+{
+  vlib_buffer_pool_thread_t *bpt;
+  vlib_buffer_pool_shard_t *s;
+  u32 *free = 0, n_shards, n_per_shard, i;
+
+  vec_validate_aligned (bp->threads, n_threads - 1, CLIB_CACHE_LINE_BYTES);
+
+  vec_foreach (bpt, bp->threads)
+    if (bpt->cache_size == 0)
+      bpt->cache_size = VLIB_BUFFER_POOL_PER_THREAD_CACHE_DEF_SZ;
+
+  n_shards = bm->n_shards ? bm->n_shards : n_threads;
+  n_shards = clib_min (n_shards, VLIB_BUFFER_POOL_MAX_SHARDS);
+
+  if (n_shards != vec_len (bp->shards))
+    {
+      /* all buffers are free when the pool is created */
+      if (bp->shards == 0)
+	vec_add (free, bp->buffers, bp->n_buffers);
+
+      vec_foreach (s, bp->shards)
+	{
+	  vec_add (free, s->buffers, s->n_avail);
+	  clib_mem_free (s->buffers);
+	  clib_spinlock_free (&s->lock);
+	}
+      vec_free (bp->shards);
+
+      /* twice the fair share, so shards rarely overflow into each other */
+      n_per_shard = (bp->n_buffers + n_shards - 1) / n_shards;
+      bp->shard_size = clib_min (bp->n_buffers, 2 * n_per_shard);
+      n_per_shard = (vec_len (free) + n_shards - 1) / n_shards;
+
+      vec_validate_aligned (bp->shards, n_shards - 1, CLIB_CACHE_LINE_BYTES);
+      vec_foreach (s, bp->shards)
+	{
+	  u32 start = (s - bp->shards) * n_per_shard;
+	  u32 n = start < vec_len (free) ?
+			  clib_min (n_per_shard, vec_len (free) - start) :
+			  0;
+
+	  clib_spinlock_init (&s->lock);
+	  s->buffers = clib_mem_alloc_aligned (
+	    round_pow2 ((bp->shard_size + 1) * sizeof (u32),
+			CLIB_CACHE_LINE_BYTES),
+	    CLIB_CACHE_LINE_BYTES);
+	  vlib_buffer_copy_indices (s->buffers, free + start, n);
+	  s->n_avail = n;
+	}
+      vec_free (free);
+    }
+
+  vec_foreach_index (i, bp->threads)
+    bp->threads[i].shard = i % n_shards;
+}
+
 u8
 vlib_buffer_pool_create (vlib_main_t *vm, u32 data_size, u32 physmem_map_index,
 			 char *fmt, ...)
@@ -538,9 +668,6 @@ vlib_buffer_pool_create (vlib_main_t *vm, u32 data_size, u32 physmem_map_index,
   bp->name = va_format (0, fmt, &va);
   va_end (va);
 
-  vec_validate_aligned (bp->threads, vlib_get_n_threads () - 1,
-			CLIB_CACHE_LINE_BYTES);
-
   alloc_size = vlib_buffer_alloc_size (bm->ext_hdr_size, data_size);
   bp->alloc_size = alloc_size;
 
@@ -549,8 +676,6 @@ vlib_buffer_pool_create (vlib_main_t *vm, u32 data_size, u32 physmem_map_index,
     round_pow2 ((size / alloc_size) * sizeof (u32), CLIB_CACHE_LINE_BYTES),
     CLIB_CACHE_LINE_BYTES);
 
-  clib_spinlock_init (&bp->lock);
-
   p = m->base;
 
   /* start with naturally aligned address */
@@ -576,11 +701,11 @@ vlib_buffer_pool_create (vlib_main_t *vm, u32 data_size, u32 physmem_map_index,
       b = (vlib_buffer_t *) (p + bm->ext_hdr_size);
       b->template = bp->buffer_template;
       bi = vlib_get_buffer_index (vm, b);
-      bp->buffers[bp->n_avail++] = bi;
+      bp->buffers[bp->n_buffers++] = bi;
       vlib_get_buffer (vm, bi);
     }
 
-  bp->n_buffers = bp->n_avail;
+  vlib_buffer_pool_set_n_threads (bm, bp, vlib_get_n_threads ());
 
   return bp->index;
 }
@@ -591,7 +716,7 @@ format_vlib_buffer_pool (u8 * s, va_list * va)
   vlib_main_t *vm = va_arg (*va, vlib_main_t *);
   vlib_buffer_pool_t *bp = va_arg (*va, vlib_buffer_pool_t *);
   vlib_buffer_pool_thread_t *bpt;
-  u32 cached = 0;
+  u32 cached = 0, n_avail;
 
   if (!bp)
     return format (s, "%-20s%=6s%=6s%=6s%=11s%=6s%=8s%=8s%=8s",
@@ -603,12 +728,13 @@ format_vlib_buffer_pool (u8 * s, va_list * va)
     cached += bpt->n_cached;
   /* *INDENT-ON* */
 
+  n_avail = vlib_buffer_pool_n_avail (bp);
   s = format (s, "%-20v%=6d%=6d%=6u%=11u%=6u%=8u%=8u%=8u", bp->name, bp->index,
 	      bp->numa_node,
 	      bp->data_size + sizeof (vlib_buffer_t) +
 		vm->buffer_main->ext_hdr_size,
-	      bp->data_size, bp->n_buffers, bp->n_avail, cached,
-	      bp->n_buffers - bp->n_avail - cached);
+	      bp->data_size, bp->n_buffers, n_avail, cached,
+	      bp->n_buffers - n_avail - cached);
 
   return s;
 }
@@ -632,14 +758,38 @@ static clib_error_t *
 show_buffers (vlib_main_t *vm, unformat_input_t *input,
 	      vlib_cli_command_t *cmd)
 {
+  vlib_buffer_main_t *bm = vm->buffer_main;
+  vlib_buffer_pool_thread_t *bpt;
+  vlib_buffer_pool_t *bp;
+
   vlib_cli_output (vm, "%U", format_vlib_buffer_pool_all, vm);
+
+  if (!unformat (input, "verbose"))
+    return 0;
+
+  vlib_cli_output (vm, "\n%-20s%=8s%=8s%=8s%=10s%=10s%=12s%=14s",
+		   "Pool Name", "Thread", "Cache", "Cached", "Refills",
+		   "Spills", "Alloc Fail", "NUMA Fallback");
+
+  vec_foreach (bp, bm->buffer_pools)
+    {
+      if (bp->n_buffers == 0)
+	continue;
+
+      vec_foreach (bpt, bp->threads)
+	vlib_cli_output (vm, "%-20v%=8u%=8u%=8u%=10lu%=10lu%=12lu%=14lu",
+			 bp->name, bpt - bp->threads, bpt->cache_size,
+			 bpt->n_cached, bpt->n_refills, bpt->n_spills,
+			 bpt->n_alloc_fail, bpt->n_numa_fallback);
+    }
+
   return 0;
 }
 
 /* *INDENT-OFF* */
 VLIB_CLI_COMMAND (show_buffers_command, static) = {
   .path = "show buffers",
-  .short_help = "Show packet buffer allocation",
+  .short_help = "show buffers [verbose]",
   .function = show_buffers,
 };
 /* *INDENT-ON* */
@@ -651,8 +801,7 @@ vlib_buffer_num_workers_change (vlib_main_t *vm)
   vlib_buffer_pool_t *bp;
 
   vec_foreach (bp, bm->buffer_pools)
-    vec_validate_aligned (bp->threads, vlib_get_n_threads () - 1,
-			  CLIB_CACHE_LINE_BYTES);
+    vlib_buffer_pool_set_n_threads (bm, bp, vlib_get_n_threads ());
 
   return 0;
 }
@@ -763,15 +912,11 @@ buffer_get_cached (vlib_buffer_pool_t * bp)
   u32 cached = 0;
   vlib_buffer_pool_thread_t *bpt;
 
-  clib_spinlock_lock (&bp->lock);
-
   /* *INDENT-OFF* */
   vec_foreach (bpt, bp->threads)
     cached += bpt->n_cached;
   /* *INDENT-ON* */
 
-  clib_spinlock_unlock (&bp->lock);
-
   return cached;
 }
 
@@ -795,7 +940,8 @@ buffer_gauges_collect_used_fn (vlib_stats_collector_data_t *d)
   if (!bp)
     return;
 
-  d->entry->value = bp->n_buffers - bp->n_avail - buffer_get_cached (bp);
+  d->entry->value =
+    bp->n_buffers - vlib_buffer_pool_n_avail (bp) - buffer_get_cached (bp);
 }
 
 static void
@@ -807,7 +953,43 @@ buffer_gauges_collect_available_fn (vlib_stats_collector_data_t *d)
   if (!bp)
     return;
 
-  d->entry->value = bp->n_avail;
+  d->entry->value = vlib_buffer_pool_n_avail (bp);
+}
+
+static void
+buffer_gauges_collect_alloc_fail_fn (vlib_stats_collector_data_t *d)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  vlib_buffer_pool_t *bp =
+    buffer_get_by_index (vm->buffer_main, d->private_data);
+  vlib_buffer_pool_thread_t *bpt;
+  u64 n = 0;
+
+  if (!bp)
+    return;
+
+  vec_foreach (bpt, bp->threads)
+    n += bpt->n_alloc_fail;
+
+  d->entry->value = n;
+}
+
+static void
+buffer_gauges_collect_numa_fallback_fn (vlib_stats_collector_data_t *d)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  vlib_buffer_pool_t *bp =
+    buffer_get_by_index (vm->buffer_main, d->private_data);
+  vlib_buffer_pool_thread_t *bpt;
+  u64 n = 0;
+
+  if (!bp)
+    return;
+
+  vec_foreach (bpt, bp->threads)
+    n += bpt->n_numa_fallback;
+
+  d->entry->value = n;
 }
 
 static void
@@ -822,6 +1004,78 @@ buffer_gauges_collect_cached_fn (vlib_stats_collector_data_t *d)
   d->entry->value = buffer_get_cached (bp);
 }
 
+static uword
+unformat_numa_distances (unformat_input_t *input, va_list *va)
+{
+  u32 **distances = va_arg (*va, u32 **);
+  u32 d;
+
+  while (unformat (input, "%u", &d))
+    vec_add1 (*distances, d);
+
+  return vec_len (*distances) > 0;
+}
+
+static u32
+numa_distance (u32 *distances, u32 numa_node)
+{
+  return numa_node < vec_len (distances) ? distances[numa_node] : ~0;
+}
+
+/* Build list of pools on other numa nodes, nearest first, to fall back to
+   when default pool of a numa node runs out of buffers. */
+static void
+vlib_buffer_main_init_numa_fallback (vlib_buffer_main_t *bm,
+				     clib_bitmap_t *bmp)
+{
+  u32 numa_node, other, *distances = 0, *order = 0, i, j;
+  clib_error_t *err;
+  u8 *name = 0;
+
+  clib_bitmap_foreach (numa_node, bmp)
+    {
+      u8 index = bm->default_buffer_pool_index_for_numa[numa_node];
+      vlib_buffer_pool_t *bp = vec_elt_at_index (bm->buffer_pools, index);
+
+      if (bp->numa_node != numa_node)
+	continue;
+
+      vec_reset_length (distances);
+      vec_reset_length (order);
+      vec_reset_length (name);
+      name = format (name, "/sys/devices/system/node/node%u/distance%c",
+		     numa_node, 0);
+      if ((err = clib_sysfs_read ((char *) name, "%U",
+				  unformat_numa_distances, &distances)))
+	clib_error_free (err);
+
+      clib_bitmap_foreach (other, bmp)
+	if (other != numa_node)
+	  vec_add1 (order, other);
+
+      for (i = 1; i < vec_len (order); i++)
+	for (j = i; j > 0 && numa_distance (distances, order[j]) <
+			       numa_distance (distances, order[j - 1]);
+	     j--)
+	  {
+	    u32 tmp = order[j];
+	    order[j] = order[j - 1];
+	    order[j - 1] = tmp;
+	  }
+
+      vec_foreach_index (i, order)
+	{
+	  u8 fi = bm->default_buffer_pool_index_for_numa[order[i]];
+	  if (fi != index && vec_search (bp->numa_fallback_pools, fi) == ~0)
+	    vec_add1 (bp->numa_fallback_pools, fi);
+	}
+    }
+
+  vec_free (distances);
+  vec_free (order);
+  vec_free (name);
+}
+
 clib_error_t *
 vlib_buffer_main_init (struct vlib_main_t * vm)
 {
@@ -891,6 +1145,8 @@ vlib_buffer_main_init (struct vlib_main_t * vm)
     }
   /* *INDENT-ON* */
 
+  vlib_buffer_main_init_numa_fallback (bm, bmp);
+
   vec_foreach (bp, bm->buffer_pools)
   {
     vlib_stats_collector_reg_t reg = { .private_data = bp - bm->buffer_pools };
@@ -910,6 +1166,16 @@ vlib_buffer_main_init (struct vlib_main_t * vm)
       vlib_stats_add_gauge ("/buffer-pools/%v/available", bp->name);
     reg.collect_fn = buffer_gauges_collect_available_fn;
     vlib_stats_register_collector_fn (&reg);
+
+    reg.entry_index =
+      vlib_stats_add_gauge ("/buffer-pools/%v/alloc-failures", bp->name);
+    reg.collect_fn = buffer_gauges_collect_alloc_fail_fn;
+    vlib_stats_register_collector_fn (&reg);
+
+    reg.entry_index =
+      vlib_stats_add_gauge ("/buffer-pools/%v/numa-fallback", bp->name);
+    reg.collect_fn = buffer_gauges_collect_numa_fallback_fn;
+    vlib_stats_register_collector_fn (&reg);
   }
 
 done:
@@ -939,6 +1205,10 @@ vlib_buffers_configure (vlib_main_t * vm, unformat_input_t * input)
       else if (unformat (input, "default data-size %u",
 			 &bm->default_data_size))
 	;
+      else if (unformat (input, "pool-shards %u", &bm->n_shards))
+	;
+      else if (unformat (input, "numa-fallback"))
+	bm->numa_fallback = 1;
       else
 	return unformat_parse_error (input);
     }
@@ -454,15 +454,49 @@ vlib_buffer_pull (vlib_buffer_t * b, u8 size)
 /* Forward declaration. */
 struct vlib_main_t;
 
-#define VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ 512
+/* Per-thread cache size bounds, actual size of each thread's cache is
+   adjusted at runtime to its alloc/free pattern. */
+#define VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ	 1024
+#define VLIB_BUFFER_POOL_PER_THREAD_CACHE_MIN_SZ 64
+#define VLIB_BUFFER_POOL_PER_THREAD_CACHE_DEF_SZ 512
+
+#define VLIB_BUFFER_POOL_MAX_SHARDS 16
+
+typedef enum
+{
+  VLIB_BUFFER_POOL_OP_NONE,
+  VLIB_BUFFER_POOL_OP_REFILL,
+  VLIB_BUFFER_POOL_OP_SPILL,
+} vlib_buffer_pool_op_t;
 
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
   u32 cached_buffers[VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ];
   u32 n_cached;
+  u32 cache_size;
+
+  /* shard refilled from and spilled to first */
+  u16 shard;
+
+  /* last cache refill or spill, vlib_buffer_pool_op_t */
+  u8 last_op;
+
+  /* counters */
+  u64 n_refills;
+  u64 n_spills;
+  u64 n_alloc_fail;
+  u64 n_numa_fallback;
 } vlib_buffer_pool_thread_t;
 
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  clib_spinlock_t lock;
+  u32 n_avail;
+  u32 *buffers;
+} vlib_buffer_pool_shard_t;
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -475,10 +509,19 @@ typedef struct
   u32 data_size;
   u32 alloc_size;
   u32 n_buffers;
-  u32 n_avail;
+
+  /* indices of all buffers in the pool */
   u32 *buffers;
   u8 *name;
-  clib_spinlock_t lock;
+
+  /* free buffers, each thread uses its own shard first and steals from
+     others when it runs dry */
+  vlib_buffer_pool_shard_t *shards;
+  u32 shard_size;
+
+  /* pools on other numa nodes to allocate from when this one is
+     exhausted, nearest first */
+  u8 *numa_fallback_pools;
 
   /* per-thread data */
   vlib_buffer_pool_thread_t *threads;
@@ -509,6 +552,8 @@ typedef struct
 
   /* config */
   u32 buffers_per_numa;
+  u32 n_shards;
+  u8 numa_fallback;
   u16 ext_hdr_size;
   u32 default_data_size;
   clib_mem_page_sz_t log2_page_size;
@@ -254,36 +254,133 @@ CLIB_MULTIARCH_FN (vlib_buffer_enqueue_to_single_next_with_aux_fn)
 }
 CLIB_MARCH_FN_REGISTRATION (vlib_buffer_enqueue_to_single_next_with_aux_fn);
 
-static inline vlib_frame_queue_elt_t *
-vlib_get_frame_queue_elt (vlib_frame_queue_main_t *fqm, u32 index,
-			  int dont_wait)
+/*
+ * Handoff rings: free space seen by the producer. The consumer's head is
+ * only re-read when the cached copy says there is not enough room.
+ */
+static_always_inline u32
+vlib_frame_queue_ring_n_free (vlib_frame_queue_ring_t *r, u32 n_wanted)
 {
-  vlib_frame_queue_t *fq;
-  u64 nelts, tail, new_tail;
+  u64 n_used = r->tail - r->head_cache;
 
-  fq = vec_elt (fqm->vlib_frame_queues, index);
-  ASSERT (fq);
-  nelts = fq->nelts;
+  if (n_used + n_wanted > r->limit)
+    {
+      r->head_cache = __atomic_load_n (&r->head, __ATOMIC_ACQUIRE);
+      n_used = r->tail - r->head_cache;
+    }
+
+  return n_used < r->limit ? r->limit - n_used : 0;
+}
+
+static_always_inline void
+vlib_frame_queue_ring_copy (u32 *ring, u32 size, u64 tail, u32 *from, u32 n)
+{
+  u32 slot = tail & (size - 1);
+  u32 n_first = clib_min (n, size - slot);
+
+  vlib_buffer_copy_indices (ring + slot, from, n_first);
+  if (n > n_first)
+    vlib_buffer_copy_indices (ring, from + n_first, n - n_first);
+}
 
-retry:
-  tail = __atomic_load_n (&fq->tail, __ATOMIC_ACQUIRE);
-  new_tail = tail + 1;
+/* Enqueue as many of the buffers as fit, publishing them in one go */
+static_always_inline u32
+vlib_frame_queue_ring_push (vlib_frame_queue_ring_t *r, u32 *from,
+			    u32 *from_aux, u32 n, int with_aux)
+{
+  n = clib_min (n, vlib_frame_queue_ring_n_free (r, n));
+  if (n == 0)
+    return 0;
+
+  vlib_frame_queue_ring_copy (r->buffer_indices, r->size, r->tail, from, n);
+  if (with_aux)
+    vlib_frame_queue_ring_copy (r->aux_data, r->size, r->tail, from_aux, n);
+
+  __atomic_store_n (&r->tail, r->tail + n, __ATOMIC_RELEASE);
+  return n;
+}
+
+static_always_inline u32
+vlib_frame_queue_ring_flush_backlog (vlib_frame_queue_ring_t *r,
+				     int with_aux)
+{
+  u32 n;
 
-  if (new_tail >= fq->head + nelts)
+  n = vlib_frame_queue_ring_push (r, r->backlog, r->backlog_aux,
+				  vec_len (r->backlog), with_aux);
+  if (n)
     {
-      if (dont_wait)
-	return 0;
+      vec_delete (r->backlog, n, 0);
+      if (with_aux)
+	vec_delete (r->backlog_aux, n, 0);
+    }
+  return n;
+}
+
+static_always_inline void
+vlib_frame_queue_notify (u32 thread_index)
+{
+  vlib_main_t *vm = vlib_get_main_by_index (thread_index);
+
+  /* avoid dirtying the consumer's cache line when it is polling anyway */
+  if (!vm->check_frame_queues)
+    vm->check_frame_queues = 1;
+}
 
-      /* Wait until a ring slot is available */
-      while (new_tail >= fq->head + nelts)
-	vlib_worker_thread_barrier_check ();
+/*
+ * The ring to thread_index is full. Either wait for the consumer to make
+ * room or, when dropping on congestion, hold back what fits into the
+ * backlog of the ring. The backlog is flushed ahead of newer packets, on
+ * the next enqueue or from the main loop of the sending thread, so the
+ * packet order is kept. Returns the number of buffers to drop, which are
+ * copied to drop_list.
+ */
+static __clib_noinline u32
+vlib_frame_queue_congestion (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
+			     vlib_frame_queue_ring_t *r, u16 thread_index,
+			     u32 *from, u32 *from_aux, u32 n_left,
+			     int drop_on_congestion, int with_aux,
+			     u32 *drop_list)
+{
+  vlib_frame_queue_per_thread_t *ptd;
+  u32 n;
+
+  if (!drop_on_congestion)
+    {
+      while (n_left)
+	{
+	  if (vec_len (r->backlog))
+	    vlib_frame_queue_ring_flush_backlog (r, with_aux);
+	  else
+	    {
+	      n = vlib_frame_queue_ring_push (r, from, from_aux, n_left,
+					      with_aux);
+	      from += n;
+	      from_aux += with_aux ? n : 0;
+	      n_left -= n;
+	    }
+	  vlib_frame_queue_notify (thread_index);
+	  if (n_left)
+	    vlib_worker_thread_barrier_check ();
+	}
+      return 0;
     }
 
-  if (!__atomic_compare_exchange_n (&fq->tail, &tail, new_tail, 0 /* weak */,
-				    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
-    goto retry;
+  n = clib_min (n_left, VLIB_FRAME_QUEUE_BACKLOG_SIZE - vec_len (r->backlog));
+  if (n)
+    {
+      vec_add (r->backlog, from, n);
+      if (with_aux)
+	vec_add (r->backlog_aux, from_aux, n);
+
+      ptd = vec_elt_at_index (fqm->per_thread_data, vm->thread_index);
+      ptd->backlog_bitmap =
+	clib_bitmap_set (ptd->backlog_bitmap, thread_index, 1);
+      vm->check_frame_queues = 1;
+    }
 
-  return fq->elts + (new_tail & (nelts - 1));
+  vlib_buffer_copy_indices (drop_list, from + n, n_left - n);
+  return n_left - n;
 }
 
 static_always_inline u32
@@ -295,33 +392,56 @@ vlib_buffer_enqueue_to_thread_inline (vlib_main_t *vm,
 				      int with_aux, u32 *aux_data)
 {
   u32 drop_list[VLIB_FRAME_SIZE], n_drop = 0;
+  u32 tmp[VLIB_FRAME_SIZE], tmp_aux[VLIB_FRAME_SIZE];
   vlib_frame_bitmap_t mask, used_elts = {};
-  vlib_frame_queue_elt_t *hf = 0;
+  vlib_frame_queue_ring_t *r;
   u16 thread_index;
-  u32 n_comp, off = 0, n_left = n_packets;
+  u32 n_comp, n_enq, slot, off = 0, n_left = n_packets;
+  int direct;
 
   thread_index = thread_indices[0];
 
 more:
   clib_mask_compare_u16 (thread_index, thread_indices, mask, n_packets);
-  hf = vlib_get_frame_queue_elt (fqm, thread_index, drop_on_congestion);
+  r = vec_elt_at_index (fqm->vlib_frame_queues[thread_index]->rings,
+			vm->thread_index);
+  ASSERT (!with_aux || r->aux_data);
+
+  if (PREDICT_FALSE (vec_len (r->backlog)))
+    vlib_frame_queue_ring_flush_backlog (r, with_aux);
+
+  /* compress straight onto the ring if there is contiguous room for all the
+   * remaining packets, otherwise go through tmp */
+  slot = r->tail & (r->size - 1);
+  direct = vec_len (r->backlog) == 0 && r->size - slot >= n_left &&
+	   vlib_frame_queue_ring_n_free (r, n_left) >= n_left;
 
-  n_comp = clib_compress_u32 (hf ? hf->buffer_index : drop_list + n_drop,
+  n_comp = clib_compress_u32 (direct ? r->buffer_indices + slot : tmp,
 			      buffer_indices, mask, n_packets);
   if (with_aux)
-    clib_compress_u32 (hf ? hf->aux_data : drop_list + n_drop, aux_data, mask,
+    clib_compress_u32 (direct ? r->aux_data + slot : tmp_aux, aux_data, mask,
 		       n_packets);
 
-  if (hf)
+  if (node->flags & VLIB_NODE_FLAG_TRACE)
+    r->maybe_trace = 1;
+
+  if (direct)
     {
-      if (node->flags & VLIB_NODE_FLAG_TRACE)
-	hf->maybe_trace = 1;
-      hf->n_vectors = n_comp;
-      __atomic_store_n (&hf->valid, 1, __ATOMIC_RELEASE);
-      vlib_get_main_by_index (thread_index)->check_frame_queues = 1;
+      __atomic_store_n (&r->tail, r->tail + n_comp, __ATOMIC_RELEASE);
+      n_enq = n_comp;
     }
+  else if (vec_len (r->backlog) == 0)
+    n_enq = vlib_frame_queue_ring_push (r, tmp, tmp_aux, n_comp, with_aux);
   else
-    n_drop += n_comp;
+    n_enq = 0;
+
+  if (PREDICT_FALSE (n_enq < n_comp))
+    n_drop += vlib_frame_queue_congestion (
+      vm, fqm, r, thread_index, tmp + n_enq, tmp_aux + n_enq, n_comp - n_enq,
+      drop_on_congestion, with_aux, drop_list + n_drop);
+
+  if (n_enq)
+    vlib_frame_queue_notify (thread_index);
 
   n_left -= n_comp;
 
@@ -340,7 +460,7 @@ more:
       goto more;
     }
 
-  if (drop_on_congestion && n_drop)
+  if (n_drop)
     vlib_buffer_free (vm, drop_list, n_drop);
 
   return n_packets - n_drop;
@@ -358,23 +478,18 @@ CLIB_MULTIARCH_FN (vlib_buffer_enqueue_to_thread_fn)
 
   fqm = vec_elt_at_index (tm->frame_queue_mains, frame_queue_index);
 
-  while (n_packets >= VLIB_FRAME_SIZE)
+  /* a single call site, the inline has a large stack frame */
+  while (n_packets)
     {
+      u32 n = clib_min (n_packets, VLIB_FRAME_SIZE);
       n_enq += vlib_buffer_enqueue_to_thread_inline (
-	vm, node, fqm, buffer_indices, thread_indices, VLIB_FRAME_SIZE,
-	drop_on_congestion, 0 /* with_aux */, NULL);
-      buffer_indices += VLIB_FRAME_SIZE;
-      thread_indices += VLIB_FRAME_SIZE;
-      n_packets -= VLIB_FRAME_SIZE;
+	vm, node, fqm, buffer_indices, thread_indices, n, drop_on_congestion,
+	0 /* with_aux */, NULL);
+      buffer_indices += n;
+      thread_indices += n;
+      n_packets -= n;
     }
 
-  if (n_packets == 0)
-    return n_enq;
-
-  n_enq += vlib_buffer_enqueue_to_thread_inline (
-    vm, node, fqm, buffer_indices, thread_indices, n_packets,
-    drop_on_congestion, 0 /* with_aux */, NULL);
-
   return n_enq;
 }
 
@@ -390,46 +505,82 @@ CLIB_MULTIARCH_FN (vlib_buffer_enqueue_to_thread_with_aux_fn)
 
   fqm = vec_elt_at_index (tm->frame_queue_mains, frame_queue_index);
 
-  while (n_packets >= VLIB_FRAME_SIZE)
+  /* a single call site, the inline has a large stack frame */
+  while (n_packets)
     {
+      u32 n = clib_min (n_packets, VLIB_FRAME_SIZE);
       n_enq += vlib_buffer_enqueue_to_thread_inline (
-	vm, node, fqm, buffer_indices, thread_indices, VLIB_FRAME_SIZE,
-	drop_on_congestion, 1 /* with_aux */, aux);
-      buffer_indices += VLIB_FRAME_SIZE;
-      thread_indices += VLIB_FRAME_SIZE;
-      n_packets -= VLIB_FRAME_SIZE;
+	vm, node, fqm, buffer_indices, thread_indices, n, drop_on_congestion,
+	1 /* with_aux */, aux);
+      buffer_indices += n;
+      thread_indices += n;
+      aux += n;
+      n_packets -= n;
     }
 
-  if (n_packets == 0)
-    return n_enq;
-
-  n_enq += vlib_buffer_enqueue_to_thread_inline (
-    vm, node, fqm, buffer_indices, thread_indices, n_packets,
-    drop_on_congestion, 1 /* with_aux */, aux);
-
   return n_enq;
 }
 
 CLIB_MARCH_FN_REGISTRATION (vlib_buffer_enqueue_to_thread_fn);
 CLIB_MARCH_FN_REGISTRATION (vlib_buffer_enqueue_to_thread_with_aux_fn);
 
+/* Push out what this thread held back on congestion as a producer */
+static_always_inline u32
+vlib_frame_queue_flush_backlogs (vlib_main_t *vm,
+				 vlib_frame_queue_main_t *fqm,
+				 vlib_frame_queue_per_thread_t *ptd,
+				 u8 with_aux)
+{
+  vlib_frame_queue_ring_t *r;
+  u32 i, n, n_flushed = 0;
+
+  for (i = 0; i < vec_len (fqm->vlib_frame_queues); i++)
+    {
+      if (!clib_bitmap_get (ptd->backlog_bitmap, i))
+	continue;
+
+      r = fqm->vlib_frame_queues[i]->rings + vm->thread_index;
+      n = vlib_frame_queue_ring_flush_backlog (r, with_aux);
+      if (n)
+	vlib_frame_queue_notify (i);
+      if (vec_len (r->backlog) == 0)
+	ptd->backlog_bitmap = clib_bitmap_set (ptd->backlog_bitmap, i, 0);
+      n_flushed += n;
+    }
+
+  /* keep polling until the consumers have taken it all */
+  if (!clib_bitmap_is_zero (ptd->backlog_bitmap))
+    vm->check_frame_queues = 1;
+
+  return n_flushed;
+}
+
 static_always_inline u32
 vlib_frame_queue_dequeue_inline (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
 				 u8 with_aux)
 {
   u32 thread_id = vm->thread_index;
   vlib_frame_queue_t *fq = fqm->vlib_frame_queues[thread_id];
-  u32 mask = fq->nelts - 1;
-  vlib_frame_queue_elt_t *elt;
-  u32 n_free, n_copy, *from, *from_aux, *to = 0, *to_aux = 0, processed = 0,
-					vectors = 0;
+  vlib_frame_queue_per_thread_t *ptd = fqm->per_thread_data + thread_id;
+  vlib_frame_queue_ring_t *r;
+  u32 n_free = 0, n_copy, slot, *to = 0, *to_aux = 0, processed = 0,
+      vectors = 0;
+  u32 i, n_rings, ring_index;
+  u64 head, tail, n_avail;
   vlib_frame_t *f = 0;
+  u8 maybe_trace = 0;
 
   ASSERT (fq);
   ASSERT (vm == vlib_global_main.vlib_mains[thread_id]);
 
   if (PREDICT_FALSE (fqm->node_index == ~0))
     return 0;
+
+  if (PREDICT_FALSE (ptd->backlog_bitmap != 0))
+    processed += vlib_frame_queue_flush_backlogs (vm, fqm, ptd, with_aux);
+
+  n_rings = vec_len (fq->rings);
+
   /*
    * Gather trace data for frame queues
    */
@@ -437,102 +588,108 @@ vlib_frame_queue_dequeue_inline (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
     {
       frame_queue_trace_t *fqt;
       frame_queue_nelt_counter_t *fqh;
-      u32 elix;
+      u64 n_in_use = 0;
 
       fqt = &fqm->frame_queue_traces[thread_id];
 
       fqt->nelts = fq->nelts;
-      fqt->head = fq->head;
-      fqt->tail = fq->tail;
       fqt->threshold = fq->vector_threshold;
-      fqt->n_in_use = fqt->tail - fqt->head;
-      if (fqt->n_in_use >= fqt->nelts)
+      fqt->head = fqt->tail = 0;
+
+      /* Record a snapshot of the packets in use per producer ring */
+      for (i = 0; i < n_rings; i++)
 	{
-	  // if beyond max then use max
-	  fqt->n_in_use = fqt->nelts - 1;
+	  r = fq->rings + i;
+	  head = r->head;
+	  tail = r->tail;
+	  fqt->head += head;
+	  fqt->tail += tail;
+	  n_in_use += tail - head;
+	  if (i < FRAME_QUEUE_MAX_NELTS)
+	    fqt->n_vectors[i] = tail - head;
 	}
 
+      /* in frames, if beyond max then use max */
+      fqt->n_in_use = round_pow2 (n_in_use, VLIB_FRAME_SIZE) / VLIB_FRAME_SIZE;
+      fqt->n_in_use = clib_min (fqt->n_in_use, fqt->nelts - 1);
+      fqt->n_in_use = clib_min (fqt->n_in_use, FRAME_QUEUE_MAX_NELTS - 1);
+
       /* Record the number of elements in use in the histogram */
       fqh = &fqm->frame_queue_histogram[thread_id];
       fqh->count[fqt->n_in_use]++;
-
-      /* Record a snapshot of the elements in use */
-      for (elix = 0; elix < fqt->nelts; elix++)
-	{
-	  elt = fq->elts + ((fq->head + 1 + elix) & (mask));
-	  if (1 || elt->valid)
-	    {
-	      fqt->n_vectors[elix] = elt->n_vectors;
-	    }
-	}
       fqt->written = 1;
     }
 
-  while (1)
+  /* drain the producer rings round robin, starting where the last call
+   * hit the vector threshold */
+  ring_index = fq->next_ring;
+  for (i = 0; i < n_rings; i++, ring_index++)
     {
-      if (fq->head == fq->tail)
-	break;
+      if (ring_index >= n_rings)
+	ring_index = 0;
 
-      elt = fq->elts + ((fq->head + 1) & mask);
+      r = fq->rings + ring_index;
+      head = r->head;
+      tail = __atomic_load_n (&r->tail, __ATOMIC_ACQUIRE);
+      if (head == tail)
+	continue;
 
-      if (!__atomic_load_n (&elt->valid, __ATOMIC_ACQUIRE))
-	break;
+      if (r->maybe_trace)
+	{
+	  r->maybe_trace = 0;
+	  maybe_trace = 1;
+	}
 
-      from = elt->buffer_index + elt->offset;
-      if (with_aux)
-	from_aux = elt->aux_data + elt->offset;
-      ASSERT (elt->offset + elt->n_vectors <= VLIB_FRAME_SIZE);
+      n_avail = clib_min (tail - head, fq->vector_threshold - vectors);
 
-      if (f == 0)
+      while (n_avail)
 	{
-	  f = vlib_get_frame_to_node (vm, fqm->node_index);
-	  to = vlib_frame_vector_args (f);
-	  if (with_aux)
-	    to_aux = vlib_frame_aux_args (f);
-	  n_free = VLIB_FRAME_SIZE;
-	}
+	  if (f == 0)
+	    {
+	      f = vlib_get_frame_to_node (vm, fqm->node_index);
+	      to = vlib_frame_vector_args (f);
+	      if (with_aux)
+		to_aux = vlib_frame_aux_args (f);
+	      n_free = VLIB_FRAME_SIZE;
+	    }
 
-      if (elt->maybe_trace)
-	f->frame_flags |= VLIB_NODE_FLAG_TRACE;
+	  if (maybe_trace)
+	    f->frame_flags |= VLIB_NODE_FLAG_TRACE;
 
-      n_copy = clib_min (n_free, elt->n_vectors);
+	  slot = head & (r->size - 1);
+	  n_copy = clib_min (n_avail, n_free);
+	  n_copy = clib_min (n_copy, r->size - slot);
 
-      vlib_buffer_copy_indices (to, from, n_copy);
-      to += n_copy;
-      if (with_aux)
-	{
-	  vlib_buffer_copy_indices (to_aux, from_aux, n_copy);
-	  to_aux += n_copy;
-	}
+	  vlib_buffer_copy_indices (to, r->buffer_indices + slot, n_copy);
+	  to += n_copy;
+	  if (with_aux)
+	    {
+	      vlib_buffer_copy_indices (to_aux, r->aux_data + slot, n_copy);
+	      to_aux += n_copy;
+	    }
 
-      n_free -= n_copy;
-      vectors += n_copy;
+	  head += n_copy;
+	  n_avail -= n_copy;
+	  n_free -= n_copy;
+	  vectors += n_copy;
 
-      if (n_free == 0)
-	{
-	  f->n_vectors = VLIB_FRAME_SIZE;
-	  vlib_put_frame_to_node (vm, fqm->node_index, f);
-	  f = 0;
+	  if (n_free == 0)
+	    {
+	      f->n_vectors = VLIB_FRAME_SIZE;
+	      vlib_put_frame_to_node (vm, fqm->node_index, f);
+	      f = 0;
+	    }
 	}
 
-      if (n_copy < elt->n_vectors)
-	{
-	  /* not empty - leave it on the ring */
-	  elt->n_vectors -= n_copy;
-	  elt->offset += n_copy;
-	}
-      else
-	{
-	  /* empty - reset and bump head */
-	  u32 sz = STRUCT_OFFSET_OF (vlib_frame_queue_elt_t, end_of_reset);
-	  clib_memset (elt, 0, sz);
-	  __atomic_store_n (&fq->head, fq->head + 1, __ATOMIC_RELEASE);
-	  processed++;
-	}
+      /* hand the slots back to the producer */
+      __atomic_store_n (&r->head, head, __ATOMIC_RELEASE);
 
       /* Limit the number of packets pushed into the graph */
       if (vectors >= fq->vector_threshold)
-	break;
+	{
+	  fq->next_ring = ring_index + 1 < n_rings ? ring_index + 1 : 0;
+	  break;
+	}
     }
 
   if (f)
@@ -541,7 +698,7 @@ vlib_frame_queue_dequeue_inline (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
       vlib_put_frame_to_node (vm, fqm->node_index, f);
     }
 
-  return processed;
+  return processed + vectors;
 }
 
 u32 __clib_section (".vlib_frame_queue_dequeue_fn")
@@ -505,34 +505,89 @@ vlib_get_buffer_pool (vlib_main_t * vm, u8 buffer_pool_index)
   return vec_elt_at_index (bm->buffer_pools, buffer_pool_index);
 }
 
+u32 vlib_buffer_pool_n_avail (vlib_buffer_pool_t *bp);
+u32 vlib_buffer_pool_steal (vlib_buffer_pool_t *bp, u32 shard, u32 *buffers,
+			    u32 n_buffers);
+void vlib_buffer_pool_spill (vlib_buffer_pool_t *bp, u32 shard, u32 *buffers,
+			     u32 n_buffers);
+u32 vlib_buffer_alloc_numa_fallback (vlib_main_t *vm, u32 *buffers,
+				     u32 n_buffers, u8 buffer_pool_index);
+
+static_always_inline u32
+vlib_buffer_pool_shard_get (vlib_buffer_pool_shard_t *s, u32 *buffers,
+			    u32 n_buffers)
+{
+  u32 len;
+
+  clib_spinlock_lock (&s->lock);
+  len = clib_min (n_buffers, s->n_avail);
+  s->n_avail -= len;
+  vlib_buffer_copy_indices (buffers, s->buffers + s->n_avail, len);
+  clib_spinlock_unlock (&s->lock);
+  return len;
+}
+
+static_always_inline u32
+vlib_buffer_pool_shard_put (vlib_buffer_pool_shard_t *s, u32 shard_size,
+			    u32 *buffers, u32 n_buffers)
+{
+  u32 len;
+
+  clib_spinlock_lock (&s->lock);
+  len = clib_min (n_buffers, shard_size - s->n_avail);
+  vlib_buffer_copy_indices (s->buffers + s->n_avail, buffers, len);
+  s->n_avail += len;
+  clib_spinlock_unlock (&s->lock);
+  return len;
+}
+
 static_always_inline __clib_warn_unused_result uword
 vlib_buffer_pool_get (vlib_main_t * vm, u8 buffer_pool_index, u32 * buffers,
 		      u32 n_buffers)
 {
   vlib_buffer_pool_t *bp = vlib_get_buffer_pool (vm, buffer_pool_index);
-  u32 len;
+  vlib_buffer_pool_thread_t *bpt =
+    vec_elt_at_index (bp->threads, vm->thread_index);
+  u32 n;
 
-  ASSERT (bp->buffers);
+  ASSERT (bp->shards);
 
-  clib_spinlock_lock (&bp->lock);
-  len = bp->n_avail;
-  if (PREDICT_TRUE (n_buffers < len))
-    {
-      len -= n_buffers;
-      vlib_buffer_copy_indices (buffers, bp->buffers + len, n_buffers);
-      bp->n_avail = len;
-      clib_spinlock_unlock (&bp->lock);
-      return n_buffers;
-    }
-  else
-    {
-      vlib_buffer_copy_indices (buffers, bp->buffers, len);
-      bp->n_avail = 0;
-      clib_spinlock_unlock (&bp->lock);
-      return len;
-    }
+  n = vlib_buffer_pool_shard_get (bp->shards + bpt->shard, buffers,
+				  n_buffers);
+  if (PREDICT_FALSE (n < n_buffers))
+    n += vlib_buffer_pool_steal (bp, bpt->shard, buffers + n, n_buffers - n);
+  return n;
+}
+
+static_always_inline void
+vlib_buffer_pool_put_shard (vlib_buffer_pool_t *bp,
+			    vlib_buffer_pool_thread_t *bpt, u32 *buffers,
+			    u32 n_buffers)
+{
+  u32 n;
+
+  n = vlib_buffer_pool_shard_put (bp->shards + bpt->shard, bp->shard_size,
+				  buffers, n_buffers);
+  if (PREDICT_FALSE (n < n_buffers))
+    vlib_buffer_pool_spill (bp, bpt->shard, buffers + n, n_buffers - n);
 }
 
+/* Threads refilling right after spilling, or the other way around, need
+   a bigger cache. Threads that keep spilling free more than they allocate
+   and only hold buffers other threads are waiting for, so their cache
+   shrinks. */
+static_always_inline void
+vlib_buffer_pool_thread_resize (vlib_buffer_pool_thread_t *bpt,
+				vlib_buffer_pool_op_t op)
+{
+  if (bpt->last_op != VLIB_BUFFER_POOL_OP_NONE && bpt->last_op != op)
+    bpt->cache_size =
+      clib_min (bpt->cache_size * 2, VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ);
+  else if (op == VLIB_BUFFER_POOL_OP_SPILL && bpt->last_op == op)
+    bpt->cache_size =
+      clib_max (bpt->cache_size / 2, VLIB_BUFFER_POOL_PER_THREAD_CACHE_MIN_SZ);
+  bpt->last_op = op;
+}
 
 /** \brief Allocate buffers from specific pool into supplied array
 
@@ -550,7 +605,7 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
   vlib_buffer_main_t *bm = vm->buffer_main;
   vlib_buffer_pool_t *bp;
   vlib_buffer_pool_thread_t *bpt;
-  u32 *src, *dst, len, n_left;
+  u32 *src, *dst, len, n_left, n_requested;
 
   /* If buffer allocation fault injection is configured */
   if (VLIB_BUFFER_ALLOC_FAULT_INJECTOR > 0)
@@ -567,7 +622,7 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
   bpt = vec_elt_at_index (bp->threads, vm->thread_index);
 
   dst = buffers;
-  n_left = n_buffers;
+  n_left = n_requested = n_buffers;
   len = bpt->n_cached;
 
   /* per-thread cache contains enough buffers */
@@ -580,7 +635,7 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
     }
 
   /* alloc bigger than cache - take buffers directly from main pool */
-  if (n_buffers >= VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ)
+  if (n_buffers >= bpt->cache_size)
     {
       n_buffers = vlib_buffer_pool_get (vm, buffer_pool_index, buffers,
 					n_buffers);
@@ -596,7 +651,10 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
       n_left -= len;
     }
 
-  len = round_pow2 (n_left, 32);
+  /* refill cache to half of its size */
+  vlib_buffer_pool_thread_resize (bpt, VLIB_BUFFER_POOL_OP_REFILL);
+  bpt->n_refills++;
+  len = clib_max (round_pow2 (n_left, 32), bpt->cache_size / 2);
   len = vlib_buffer_pool_get (vm, buffer_pool_index, bpt->cached_buffers,
 			      len);
   bpt->n_cached = len;
@@ -613,6 +671,9 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
   n_buffers -= n_left;
 
 done:
+  if (PREDICT_FALSE (n_buffers < n_requested))
+    bpt->n_alloc_fail += n_requested - n_buffers;
+
   /* Verify that buffers are known free. */
   if (CLIB_DEBUG > 0)
     vlib_buffer_validate_alloc_free (vm, buffers, n_buffers,
@@ -636,7 +697,15 @@ vlib_buffer_alloc_on_numa (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
 			   u32 numa_node)
 {
   u8 index = vlib_buffer_pool_get_default_for_numa (vm, numa_node);
-  return vlib_buffer_alloc_from_pool (vm, buffers, n_buffers, index);
+  u32 n_alloc;
+
+  n_alloc = vlib_buffer_alloc_from_pool (vm, buffers, n_buffers, index);
+
+  /* local pool exhausted, try pools on other numa nodes */
+  if (PREDICT_FALSE (n_alloc < n_buffers) && vm->buffer_main->numa_fallback)
+    n_alloc += vlib_buffer_alloc_numa_fallback (vm, buffers + n_alloc,
+						n_buffers - n_alloc, index);
+  return n_alloc;
 }
 
 /** \brief Allocate buffers into supplied array
@@ -724,7 +793,7 @@ vlib_buffer_pool_put (vlib_main_t * vm, u8 buffer_pool_index,
   vlib_buffer_pool_t *bp = vlib_get_buffer_pool (vm, buffer_pool_index);
   vlib_buffer_pool_thread_t *bpt = vec_elt_at_index (bp->threads,
 						     vm->thread_index);
-  u32 n_cached, n_empty;
+  u32 n_cached, n_keep, n_copy;
 
   if (CLIB_DEBUG > 0)
     vlib_buffer_validate_alloc_free (vm, buffers, n_buffers,
@@ -733,8 +802,7 @@ vlib_buffer_pool_put (vlib_main_t * vm, u8 buffer_pool_index,
     bm->free_callback_fn (vm, buffer_pool_index, buffers, n_buffers);
 
   n_cached = bpt->n_cached;
-  n_empty = VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ - n_cached;
-  if (n_buffers <= n_empty)
+  if (n_cached + n_buffers <= bpt->cache_size)
     {
       vlib_buffer_copy_indices (bpt->cached_buffers + n_cached,
 				buffers, n_buffers);
@@ -742,15 +810,25 @@ vlib_buffer_pool_put (vlib_main_t * vm, u8 buffer_pool_index,
       return;
     }
 
+  /* cache overflow - keep it half full and return the rest to the pool */
+  vlib_buffer_pool_thread_resize (bpt, VLIB_BUFFER_POOL_OP_SPILL);
+  bpt->n_spills++;
+  n_keep = bpt->cache_size / 2;
+
+  if (n_cached > n_keep)
+    {
+      vlib_buffer_pool_put_shard (bp, bpt, bpt->cached_buffers + n_keep,
+				  n_cached - n_keep);
+      n_cached = n_keep;
+    }
+
+  n_copy = clib_min (n_buffers, n_keep - n_cached);
   vlib_buffer_copy_indices (bpt->cached_buffers + n_cached,
-			    buffers + n_buffers - n_empty, n_empty);
-  bpt->n_cached = VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ;
-
-  clib_spinlock_lock (&bp->lock);
-  vlib_buffer_copy_indices (bp->buffers + bp->n_avail, buffers,
-			    n_buffers - n_empty);
-  bp->n_avail += n_buffers - n_empty;
-  clib_spinlock_unlock (&bp->lock);
+			    buffers + n_buffers - n_copy, n_copy);
+  bpt->n_cached = n_cached + n_copy;
+
+  if (n_buffers > n_copy)
+    vlib_buffer_pool_put_shard (bp, bpt, buffers, n_buffers - n_copy);
 }
 
 /** \brief return unused buffers back to pool
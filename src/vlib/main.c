@@ -881,6 +881,121 @@ add_trajectory_trace (vlib_buffer_t * b, u32 node_index)
 #endif
 }
 
+static_always_inline void
+adaptive_mode_account (vlib_node_adaptive_state_t *as,
+		       vlib_node_state_t new_state, f64 now)
+{
+  as->time_in_state[as->state] += now - as->last_switch_time;
+  as->last_switch_time = now;
+  as->state = new_state;
+}
+
+/* Adaptive mode input nodes switch to polling mode as soon as a call
+   returns a burst of at least polling threshold vectors, and back to
+   interrupt mode once the average vectors per call stayed at or below
+   interrupt threshold for the configured idle time. */
+static void
+dispatch_node_adaptive (vlib_main_t *vm, vlib_node_runtime_t *node,
+			vlib_node_state_t dispatch_state, uword n)
+{
+  vlib_node_main_t *nm = &vm->node_main;
+  vlib_node_adaptive_state_t *as;
+  vlib_node_t *nd;
+  f64 now = vlib_time_now (vm);
+
+  /* *INDENT-OFF* */
+  ELOG_TYPE_DECLARE (e) =
+    {
+      .function = (char *) __FUNCTION__,
+      .format = "%s vector length %d, switching to %s",
+      .format_args = "T4i4t4",
+      .n_enum_strings = 2,
+      .enum_strings = {
+        "interrupt", "polling",
+      },
+    };
+  /* *INDENT-ON* */
+  struct
+  {
+    u32 node_name, vector_length, is_polling;
+  } *ed;
+
+  vec_validate (nm->adaptive_state, node->node_index);
+  as = vec_elt_at_index (nm->adaptive_state, node->node_index);
+
+  if (PREDICT_FALSE (as->last_switch_time == 0))
+    {
+      as->last_switch_time = as->last_busy_time = now;
+      as->state = dispatch_state;
+    }
+  else if (PREDICT_FALSE (as->state != dispatch_state))
+    /* state changed outside of adaptive mode, e.g. by rx-mode change */
+    adaptive_mode_account (as, dispatch_state, now);
+
+  /* moving average over roughly last 8 calls */
+  as->vectors_per_call += ((f64) n - as->vectors_per_call) / 8;
+
+  if (as->vectors_per_call > nm->interrupt_threshold_vector_length)
+    as->last_busy_time = now;
+
+  if (dispatch_state == VLIB_NODE_STATE_INTERRUPT &&
+      (n >= nm->polling_threshold_vector_length ||
+       as->vectors_per_call >= nm->polling_threshold_vector_length) &&
+      !(node->flags & VLIB_NODE_FLAG_SWITCH_FROM_INTERRUPT_TO_POLLING_MODE))
+    {
+      nd = vlib_get_node (vm, node->node_index);
+      nd->state = VLIB_NODE_STATE_POLLING;
+      node->state = VLIB_NODE_STATE_POLLING;
+      node->flags &= ~VLIB_NODE_FLAG_SWITCH_FROM_POLLING_TO_INTERRUPT_MODE;
+      node->flags |= VLIB_NODE_FLAG_SWITCH_FROM_INTERRUPT_TO_POLLING_MODE;
+      nm->input_node_counts_by_state[VLIB_NODE_STATE_INTERRUPT] -= 1;
+      nm->input_node_counts_by_state[VLIB_NODE_STATE_POLLING] += 1;
+      as->last_busy_time = now;
+      as->n_switches++;
+      adaptive_mode_account (as, VLIB_NODE_STATE_POLLING, now);
+
+      if (PREDICT_FALSE (vlib_get_first_main ()->elog_trace_graph_dispatch))
+	{
+	  vlib_worker_thread_t *w = vlib_worker_threads + vm->thread_index;
+
+	  ed = ELOG_TRACK_DATA (&vlib_global_main.elog_main, e, w->elog_track);
+	  ed->node_name = nd->name_elog_string;
+	  ed->vector_length = n;
+	  ed->is_polling = 1;
+	}
+    }
+  else if (dispatch_state == VLIB_NODE_STATE_POLLING &&
+	   now - as->last_busy_time >= nm->adaptive_idle_time)
+    {
+      nd = vlib_get_node (vm, node->node_index);
+      if (node->flags & VLIB_NODE_FLAG_SWITCH_FROM_POLLING_TO_INTERRUPT_MODE)
+	{
+	  /* Switch to interrupt mode after dispatch in polling one more time.
+	     This allows driver to re-enable interrupts. */
+	  nd->state = VLIB_NODE_STATE_INTERRUPT;
+	  node->state = VLIB_NODE_STATE_INTERRUPT;
+	  node->flags &= ~VLIB_NODE_FLAG_SWITCH_FROM_INTERRUPT_TO_POLLING_MODE;
+	  nm->input_node_counts_by_state[VLIB_NODE_STATE_POLLING] -= 1;
+	  nm->input_node_counts_by_state[VLIB_NODE_STATE_INTERRUPT] += 1;
+	  as->n_switches++;
+	  adaptive_mode_account (as, VLIB_NODE_STATE_INTERRUPT, now);
+	}
+      else
+	{
+	  vlib_worker_thread_t *w = vlib_worker_threads + vm->thread_index;
+	  node->flags |= VLIB_NODE_FLAG_SWITCH_FROM_POLLING_TO_INTERRUPT_MODE;
+	  if (PREDICT_FALSE (vlib_get_first_main ()->elog_trace_graph_dispatch))
+	    {
+	      ed =
+		ELOG_TRACK_DATA (&vlib_global_main.elog_main, e, w->elog_track);
+	      ed->node_name = nd->name_elog_string;
+	      ed->vector_length = n;
+	      ed->is_polling = 0;
+	    }
+	}
+    }
+}
+
 static_always_inline u64
 dispatch_node (vlib_main_t * vm,
 	       vlib_node_runtime_t * node,
@@ -888,7 +1003,7 @@ dispatch_node (vlib_main_t * vm,
 	       vlib_node_state_t dispatch_state,
 	       vlib_frame_t * frame, u64 last_time_stamp)
 {
-  uword n, v;
+  uword n;
   u64 t;
   vlib_node_main_t *nm = &vm->node_main;
   vlib_next_frame_t *nf;
@@ -972,94 +1087,13 @@ dispatch_node (vlib_main_t * vm,
   vm->main_loop_vectors_processed += n;
   vm->main_loop_nodes_processed += n > 0;
 
-  v = vlib_node_runtime_update_stats (vm, node,
-				      /* n_calls */ 1,
-				      /* n_vectors */ n,
-				      /* n_clocks */ t - last_time_stamp);
+  vlib_node_runtime_update_stats (vm, node,
+				  /* n_calls */ 1,
+				  /* n_vectors */ n,
+				  /* n_clocks */ t - last_time_stamp);
 
-  /* When in adaptive mode and vector rate crosses threshold switch to
-     polling mode and vice versa. */
   if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_ADAPTIVE_MODE))
-    {
-      /* *INDENT-OFF* */
-      ELOG_TYPE_DECLARE (e) =
-        {
-          .function = (char *) __FUNCTION__,
-          .format = "%s vector length %d, switching to %s",
-          .format_args = "T4i4t4",
-          .n_enum_strings = 2,
-          .enum_strings = {
-            "interrupt", "polling",
-          },
-        };
-      /* *INDENT-ON* */
-      struct
-      {
-	u32 node_name, vector_length, is_polling;
-      } *ed;
-
-      if ((dispatch_state == VLIB_NODE_STATE_INTERRUPT
-	   && v >= nm->polling_threshold_vector_length) &&
-	  !(node->flags &
-	    VLIB_NODE_FLAG_SWITCH_FROM_INTERRUPT_TO_POLLING_MODE))
-	{
-	  vlib_node_t *n = vlib_get_node (vm, node->node_index);
-	  n->state = VLIB_NODE_STATE_POLLING;
-	  node->state = VLIB_NODE_STATE_POLLING;
-	  node->flags &=
-	    ~VLIB_NODE_FLAG_SWITCH_FROM_POLLING_TO_INTERRUPT_MODE;
-	  node->flags |= VLIB_NODE_FLAG_SWITCH_FROM_INTERRUPT_TO_POLLING_MODE;
-	  nm->input_node_counts_by_state[VLIB_NODE_STATE_INTERRUPT] -= 1;
-	  nm->input_node_counts_by_state[VLIB_NODE_STATE_POLLING] += 1;
-
-	  if (PREDICT_FALSE (
-		vlib_get_first_main ()->elog_trace_graph_dispatch))
-	    {
-	      vlib_worker_thread_t *w = vlib_worker_threads
-		+ vm->thread_index;
-
-	      ed = ELOG_TRACK_DATA (&vlib_global_main.elog_main, e,
-				    w->elog_track);
-	      ed->node_name = n->name_elog_string;
-	      ed->vector_length = v;
-	      ed->is_polling = 1;
-	    }
-	}
-      else if (dispatch_state == VLIB_NODE_STATE_POLLING
-	       && v <= nm->interrupt_threshold_vector_length)
-	{
-	  vlib_node_t *n = vlib_get_node (vm, node->node_index);
-	  if (node->flags &
-	      VLIB_NODE_FLAG_SWITCH_FROM_POLLING_TO_INTERRUPT_MODE)
-	    {
-	      /* Switch to interrupt mode after dispatch in polling one more time.
-	         This allows driver to re-enable interrupts. */
-	      n->state = VLIB_NODE_STATE_INTERRUPT;
-	      node->state = VLIB_NODE_STATE_INTERRUPT;
-	      node->flags &=
-		~VLIB_NODE_FLAG_SWITCH_FROM_INTERRUPT_TO_POLLING_MODE;
-	      nm->input_node_counts_by_state[VLIB_NODE_STATE_POLLING] -= 1;
-	      nm->input_node_counts_by_state[VLIB_NODE_STATE_INTERRUPT] += 1;
-
-	    }
-	  else
-	    {
-	      vlib_worker_thread_t *w = vlib_worker_threads
-		+ vm->thread_index;
-	      node->flags |=
-		VLIB_NODE_FLAG_SWITCH_FROM_POLLING_TO_INTERRUPT_MODE;
-	      if (PREDICT_FALSE (
-		    vlib_get_first_main ()->elog_trace_graph_dispatch))
-		{
-		  ed = ELOG_TRACK_DATA (&vlib_global_main.elog_main, e,
-					w->elog_track);
-		  ed->node_name = n->name_elog_string;
-		  ed->vector_length = v;
-		  ed->is_polling = 0;
-		}
-	    }
-	}
-    }
+    dispatch_node_adaptive (vm, node, dispatch_state, n);
 
   return t;
 }
@@ -1476,6 +1510,8 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
     nm->polling_threshold_vector_length = 10;
   if (!nm->interrupt_threshold_vector_length)
     nm->interrupt_threshold_vector_length = 5;
+  if (nm->adaptive_idle_time == 0)
+    nm->adaptive_idle_time = 100e-3;
 
   vm->cpu_id = clib_get_current_cpu_id ();
   vm->numa_node = clib_get_current_numa_node ();
@@ -1510,7 +1546,12 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
 	}
 
       if (!is_main)
-	vlib_worker_thread_barrier_check ();
+	{
+	  vlib_worker_thread_barrier_check ();
+	  vlib_rcu_quiescent (vm);
+	}
+      else if (PREDICT_FALSE (vec_len (vlib_rcu_main.pending) > 0))
+	vlib_rcu_reclaim (vm);
 
       if (PREDICT_FALSE (vm->check_frame_queues + frame_queue_check_counter))
 	{
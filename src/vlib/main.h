@@ -240,6 +240,9 @@ typedef struct vlib_main_t
   /* Earliest barrier can be closed again */
   f64 barrier_no_close_before;
 
+  /* Last rcu epoch this thread went through a quiescent state in */
+  volatile u64 rcu_epoch;
+
   /* Barrier counter callback */
   void (**volatile barrier_perf_callbacks)
     (struct vlib_main_t *, u64 t, int leave);
@@ -666,6 +666,25 @@ vlib_timing_wheel_data_get_index (u32 d)
   return d / 2;
 }
 
+/* Per-thread adaptive mode state of an input node. */
+typedef struct
+{
+  /* Moving average of vectors returned per call. */
+  f64 vectors_per_call;
+
+  /* Last time average was at or above interrupt threshold. */
+  f64 last_busy_time;
+
+  /* Time of last state change and time accumulated in each state
+     before it. */
+  f64 last_switch_time;
+  f64 time_in_state[VLIB_N_NODE_STATE];
+  vlib_node_state_t state;
+
+  /* Number of polling <-> interrupt transitions. */
+  u64 n_switches;
+} vlib_node_adaptive_state_t;
+
 typedef struct
 {
   clib_march_variant_type_t index;
@@ -699,6 +718,13 @@ typedef struct
   u32 polling_threshold_vector_length;
   u32 interrupt_threshold_vector_length;
 
+  /* Seconds average vector length must stay below interrupt threshold
+     before switching back to interrupt mode. */
+  f64 adaptive_idle_time;
+
+  /* Adaptive mode state indexed by node index. */
+  vlib_node_adaptive_state_t *adaptive_state;
+
   /* Vector of next frames. */
   vlib_next_frame_t *next_frames;
 
@@ -916,6 +916,129 @@ VLIB_CLI_COMMAND (set_node_fn_command, static) = {
 };
 /* *INDENT-ON* */
 
+static clib_error_t *
+set_node_adaptive_mode (vlib_main_t *vm, unformat_input_t *input,
+			vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vlib_node_main_t *nm = &vm->node_main;
+  u32 polling_threshold = nm->polling_threshold_vector_length;
+  u32 interrupt_threshold = nm->interrupt_threshold_vector_length;
+  f64 idle_time = nm->adaptive_idle_time;
+  clib_error_t *err = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "polling-threshold %u", &polling_threshold))
+	;
+      else if (unformat (line_input, "interrupt-threshold %u",
+			 &interrupt_threshold))
+	;
+      else if (unformat (line_input, "idle-time %f", &idle_time))
+	;
+      else
+	{
+	  err = clib_error_return (0, "unknown input '%U'",
+				   format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (interrupt_threshold >= polling_threshold)
+    {
+      err = clib_error_return (
+	0, "interrupt-threshold must be lower than polling-threshold");
+      goto done;
+    }
+
+  if (idle_time <= 0)
+    {
+      err = clib_error_return (0, "idle-time must be positive");
+      goto done;
+    }
+
+  foreach_vlib_main ()
+    {
+      nm = &this_vlib_main->node_main;
+      nm->polling_threshold_vector_length = polling_threshold;
+      nm->interrupt_threshold_vector_length = interrupt_threshold;
+      nm->adaptive_idle_time = idle_time;
+    }
+
+done:
+  unformat_free (line_input);
+  return err;
+}
+
+/*?
+ * Set the thresholds used by input nodes in adaptive rx-mode. A node
+ * switches to polling once a call returns at least polling-threshold
+ * vectors, and back to interrupt once its average vectors per call stayed
+ * at or below interrupt-threshold for idle-time seconds.
+ *
+ * @cliexpar
+ * @cliexcmd{set node adaptive-mode polling-threshold 16 idle-time 0.5}
+?*/
+VLIB_CLI_COMMAND (set_node_adaptive_mode_command, static) = {
+  .path = "set node adaptive-mode",
+  .short_help = "set node adaptive-mode [polling-threshold <n>] "
+		"[interrupt-threshold <n>] [idle-time <seconds>]",
+  .function = set_node_adaptive_mode,
+};
+
+static clib_error_t *
+show_node_adaptive_mode (vlib_main_t *vm, unformat_input_t *input,
+			 vlib_cli_command_t *cmd)
+{
+  vlib_node_main_t *nm = &vm->node_main;
+  vlib_node_adaptive_state_t *as;
+  vlib_node_t *n;
+  f64 now;
+  u32 i;
+
+  vlib_cli_output (vm,
+		   "polling-threshold %u interrupt-threshold %u "
+		   "idle-time %.3f",
+		   nm->polling_threshold_vector_length,
+		   nm->interrupt_threshold_vector_length,
+		   nm->adaptive_idle_time);
+  vlib_cli_output (vm, "%-7s%-32s%-10s%12s%14s%14s%10s", "Thread", "Node",
+		   "State", "Vec/Call", "Polling(s)", "Interrupt(s)",
+		   "Switches");
+
+  foreach_vlib_main ()
+    {
+      nm = &this_vlib_main->node_main;
+      now = vlib_time_now (this_vlib_main);
+
+      vec_foreach_index (i, nm->adaptive_state)
+	{
+	  if (!(as = vlib_node_get_adaptive_state (this_vlib_main, i)))
+	    continue;
+	  n = vlib_get_node (this_vlib_main, i);
+	  vlib_cli_output (
+	    vm, "%-7u%-32v%-10U%12.2f%14.3f%14.3f%10lu",
+	    this_vlib_main->thread_index, n->name, format_vlib_node_state,
+	    this_vlib_main, n, as->vectors_per_call,
+	    vlib_node_adaptive_time_in_state (as, VLIB_NODE_STATE_POLLING, now),
+	    vlib_node_adaptive_time_in_state (as, VLIB_NODE_STATE_INTERRUPT,
+					      now),
+	    as->n_switches);
+	}
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_node_adaptive_mode_command, static) = {
+  .path = "show node adaptive-mode",
+  .short_help = "show node adaptive-mode",
+  .function = show_node_adaptive_mode,
+};
+
 /* Dummy function to get us linked in. */
 void
 vlib_node_cli_reference (void)
@@ -226,6 +226,40 @@ vlib_node_get_state (vlib_main_t * vm, u32 node_index)
   return n->state;
 }
 
+/** \brief Get adaptive mode state of an input node
+    @param vm - vlib_main_t pointer
+    @param node_index - index of the node
+    @return adaptive state, or 0 if node was never dispatched in adaptive mode
+*/
+always_inline vlib_node_adaptive_state_t *
+vlib_node_get_adaptive_state (vlib_main_t *vm, u32 node_index)
+{
+  vlib_node_main_t *nm = &vm->node_main;
+  vlib_node_adaptive_state_t *as;
+
+  if (node_index >= vec_len (nm->adaptive_state))
+    return 0;
+  as = vec_elt_at_index (nm->adaptive_state, node_index);
+  return as->last_switch_time != 0 ? as : 0;
+}
+
+/** \brief Get time an adaptive mode input node spent in given state
+    @param as - adaptive state
+    @param state - node state
+    @param now - current time
+    @return seconds spent in the state, including the current residency
+*/
+always_inline f64
+vlib_node_adaptive_time_in_state (vlib_node_adaptive_state_t *as,
+				  vlib_node_state_t state, f64 now)
+{
+  f64 t = as->time_in_state[state];
+
+  if (as->state == state && now > as->last_switch_time)
+    t += now - as->last_switch_time;
+  return t;
+}
+
 always_inline void
 vlib_node_set_flag (vlib_main_t *vm, u32 node_index, u16 flag, u8 enable)
 {
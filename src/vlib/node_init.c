@@ -72,6 +72,35 @@ vlib_node_config (vlib_main_t *vm, unformat_input_t *input)
 	      unformat_free (&sub_input);
 	    }
 	}
+      else if (unformat (input, "adaptive-mode %U",
+			 unformat_vlib_cli_sub_input, &sub_input))
+	{
+	  vlib_node_main_t *nm = &vm->node_main;
+	  f64 idle_time;
+
+	  while (unformat_check_input (&sub_input) != UNFORMAT_END_OF_INPUT)
+	    {
+	      if (unformat (&sub_input, "polling-threshold %u",
+			    &nm->polling_threshold_vector_length))
+		;
+	      else if (unformat (&sub_input, "interrupt-threshold %u",
+				 &nm->interrupt_threshold_vector_length))
+		;
+	      else if (unformat (&sub_input, "idle-time %f", &idle_time) &&
+		       idle_time > 0)
+		nm->adaptive_idle_time = idle_time;
+	      else
+		return clib_error_return (0, "unknown input '%U'",
+					  format_unformat_error, &sub_input);
+	    }
+	  unformat_free (&sub_input);
+
+	  if (nm->polling_threshold_vector_length &&
+	      nm->interrupt_threshold_vector_length >=
+		nm->polling_threshold_vector_length)
+	    return clib_error_return (
+	      0, "interrupt-threshold must be lower than polling-threshold");
+	}
       else /* specify prioritization for an individual graph node */
 	if (unformat (input, "%U", unformat_vlib_node, vm, &node_index))
 	{
@@ -0,0 +1,246 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2024 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+
+vlib_rcu_main_t vlib_rcu_main;
+
+static vlib_rcu_caller_t *
+vlib_rcu_get_caller (const char *name)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  vlib_rcu_caller_t *c;
+  uword *p;
+
+  if (rm->caller_by_name == 0)
+    rm->caller_by_name = hash_create_string (0, sizeof (uword));
+
+  p = hash_get_mem (rm->caller_by_name, name);
+  if (p)
+    return vec_elt_at_index (rm->callers, p[0]);
+
+  vec_add2 (rm->callers, c, 1);
+  c->name = name;
+  hash_set_mem (rm->caller_by_name, name, c - rm->callers);
+  return c;
+}
+
+/* oldest epoch any worker may still hold references from */
+static u64
+vlib_rcu_min_epoch (void)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  u64 min = rm->epoch;
+
+  /* workers parked at the barrier hold no references */
+  if (vlib_worker_thread_barrier_held ())
+    return min;
+
+  for (u32 i = 1; i < vlib_get_n_threads (); i++)
+    {
+      vlib_main_t *ovm = vlib_get_main_by_index (i);
+      min = clib_min (min, __atomic_load_n (&ovm->rcu_epoch, __ATOMIC_ACQUIRE));
+    }
+
+  return min;
+}
+
+static u64
+vlib_rcu_advance (const char *caller)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  rm->n_rcu_calls++;
+  vlib_rcu_get_caller (caller)->n_rcu_calls++;
+
+  /* orders the unpublish of the old version before the new epoch */
+  return __atomic_add_fetch (&rm->epoch, 1, __ATOMIC_SEQ_CST);
+}
+
+void
+vlib_rcu_call_int (vlib_rcu_cb_t *fn, void *data, const char *caller)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  vlib_rcu_entry_t *e;
+  u64 epoch = vlib_rcu_advance (caller);
+
+  vec_add2 (rm->pending, e, 1);
+  e->fn = fn;
+  e->data = data;
+  e->epoch = epoch;
+  e->time = vlib_time_now (vlib_get_main ());
+  rm->max_pending = clib_max (rm->max_pending, vec_len (rm->pending));
+}
+
+void
+vlib_rcu_synchronize_int (vlib_main_t *vm, const char *caller)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  u64 epoch = vlib_rcu_advance (caller);
+  f64 t0 = vlib_time_now (vm), dt;
+
+  while (vlib_rcu_min_epoch () < epoch)
+    {
+      if (vlib_in_process_context (vm))
+	vlib_process_suspend (vm, 10e-6);
+      else
+	CLIB_PAUSE ();
+    }
+
+  dt = vlib_time_now (vm) - t0;
+  rm->grace_time += dt;
+  rm->max_grace_time = clib_max (rm->max_grace_time, dt);
+  rm->n_reclaimed++;
+}
+
+void
+vlib_rcu_reclaim (vlib_main_t *vm)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  u64 min = vlib_rcu_min_epoch ();
+  f64 now = vlib_time_now (vm), dt;
+  u32 i;
+
+  /* callbacks may queue more work, which always gets a newer epoch */
+  for (i = 0; i < vec_len (rm->pending) && rm->pending[i].epoch <= min; i++)
+    {
+      vlib_rcu_entry_t e = rm->pending[i];
+
+      e.fn (e.data);
+      dt = now - e.time;
+      rm->grace_time += dt;
+      rm->max_grace_time = clib_max (rm->max_grace_time, dt);
+      rm->n_reclaimed++;
+    }
+
+  if (i)
+    vec_delete (rm->pending, i, 0);
+}
+
+void
+vlib_rcu_barrier_account (const char *caller, f64 time)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  vlib_rcu_caller_t *c;
+
+  if (caller == 0)
+    return;
+
+  c = vlib_rcu_get_caller (caller);
+  c->n_barrier_syncs++;
+  c->barrier_time += time;
+  rm->n_barrier_syncs++;
+  rm->barrier_time += time;
+}
+
+static int
+vlib_rcu_caller_cmp (void *a1, void *a2)
+{
+  vlib_rcu_caller_t *c1 = a1, *c2 = a2;
+
+  if (c1->barrier_time != c2->barrier_time)
+    return c1->barrier_time < c2->barrier_time ? 1 : -1;
+  if (c1->n_rcu_calls != c2->n_rcu_calls)
+    return c1->n_rcu_calls < c2->n_rcu_calls ? 1 : -1;
+  return 0;
+}
+
+static clib_error_t *
+show_rcu_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  vlib_rcu_caller_t *callers, *c;
+  int verbose = 0;
+
+  if (unformat (input, "verbose"))
+    verbose = 1;
+
+  vlib_cli_output (vm, "epoch %lu pending %u (max %u) reclaimed %lu",
+		   rm->epoch, vec_len (rm->pending), rm->max_pending,
+		   rm->n_reclaimed);
+  if (rm->n_reclaimed)
+    vlib_cli_output (vm, "grace period avg %.3fms max %.3fms",
+		     rm->grace_time * 1e3 / rm->n_reclaimed,
+		     rm->max_grace_time * 1e3);
+  vlib_cli_output (vm, "barrier syncs %lu held %.6fs, rcu calls %lu",
+		   rm->n_barrier_syncs, rm->barrier_time, rm->n_rcu_calls);
+
+  if (vec_len (rm->callers) == 0)
+    return 0;
+
+  if (verbose)
+    {
+      for (u32 i = 1; i < vlib_get_n_threads (); i++)
+	vlib_cli_output (vm, "thread %u epoch %lu", i,
+			 vlib_get_main_by_index (i)->rcu_epoch);
+    }
+
+  callers = vec_dup (rm->callers);
+  vec_sort_with_function (callers, vlib_rcu_caller_cmp);
+  vlib_cli_output (vm, "%-40s%16s%16s%16s", "Caller", "Barrier syncs",
+		   "Held (s)", "RCU calls");
+  vec_foreach (c, callers)
+    vlib_cli_output (vm, "%-40s%16lu%16.6f%16lu", c->name, c->n_barrier_syncs,
+		     c->barrier_time, c->n_rcu_calls);
+  vec_free (callers);
+
+  return 0;
+}
+
+/*?
+ * Show quiescent state reclamation statistics, and for each function that
+ * took the worker thread barrier or deferred work with vlib_rcu_call, how
+ * often it did so and how long it held the barrier.
+ *
+ * @cliexpar
+ * @cliexstart{show rcu}
+ * epoch 24 pending 0 (max 2) reclaimed 24
+ * grace period avg 0.041ms max 0.212ms
+ * barrier syncs 17 held 0.000912s, rcu calls 24
+ * Caller                                     Barrier syncs        Held (s)       RCU calls
+ * vl_msg_api_handler_with_vm_node                       12        0.000700               0
+ * ...
+ * @cliexend
+?*/
+VLIB_CLI_COMMAND (show_rcu_command, static) = {
+  .path = "show rcu",
+  .short_help = "show rcu [verbose]",
+  .function = show_rcu_command_fn,
+};
+
+static clib_error_t *
+clear_rcu_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  vlib_rcu_caller_t *c;
+
+  vec_foreach (c, rm->callers)
+    {
+      c->n_barrier_syncs = c->n_rcu_calls = 0;
+      c->barrier_time = 0;
+    }
+  rm->n_barrier_syncs = rm->n_rcu_calls = rm->n_reclaimed = 0;
+  rm->barrier_time = rm->grace_time = rm->max_grace_time = 0;
+  rm->max_pending = vec_len (rm->pending);
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (clear_rcu_command, static) = {
+  .path = "clear rcu",
+  .short_help = "clear rcu",
+  .function = clear_rcu_command_fn,
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
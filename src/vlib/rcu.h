@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2024 Cisco Systems, Inc.
+ */
+
+#ifndef included_vlib_rcu_h
+#define included_vlib_rcu_h
+
+/*
+ * Quiescent state based reclamation.
+ *
+ * Worker threads hold no reference to data-plane tables between two main
+ * loop iterations, so each iteration is a quiescent state. The control plane
+ * publishes a new version of a table with vlib_rcu_assign_pointer () and
+ * passes the old one to vlib_rcu_call (). The callback runs on the main
+ * thread once every worker went through its main loop since, without
+ * stopping the workers the way vlib_worker_thread_barrier_sync () does.
+ * Readers fetch the table once per frame with vlib_rcu_dereference ().
+ */
+
+typedef void (vlib_rcu_cb_t) (void *data);
+
+typedef struct
+{
+  vlib_rcu_cb_t *fn;
+  void *data;
+  u64 epoch;
+  f64 time;
+} vlib_rcu_entry_t;
+
+/* per call site barrier and rcu usage, to track conversions */
+typedef struct
+{
+  const char *name;
+  u64 n_barrier_syncs;
+  f64 barrier_time;
+  u64 n_rcu_calls;
+} vlib_rcu_caller_t;
+
+typedef struct
+{
+  /* bumped by each vlib_rcu_call / vlib_rcu_synchronize */
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  volatile u64 epoch;
+
+  /* callbacks waiting for their grace period, oldest first */
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+  vlib_rcu_entry_t *pending;
+
+  /* statistics */
+  vlib_rcu_caller_t *callers;
+  uword *caller_by_name;
+  const char *barrier_caller;
+  u64 n_barrier_syncs;
+  f64 barrier_time;
+  u64 n_rcu_calls;
+  u64 n_reclaimed;
+  u32 max_pending;
+  f64 grace_time;
+  f64 max_grace_time;
+} vlib_rcu_main_t;
+
+extern vlib_rcu_main_t vlib_rcu_main;
+
+#define vlib_rcu_dereference(p)	      __atomic_load_n (&(p), __ATOMIC_ACQUIRE)
+#define vlib_rcu_assign_pointer(p, v) __atomic_store_n (&(p), (v), __ATOMIC_RELEASE)
+
+void vlib_rcu_call_int (vlib_rcu_cb_t *fn, void *data, const char *caller);
+void vlib_rcu_synchronize_int (vlib_main_t *vm, const char *caller);
+void vlib_rcu_reclaim (vlib_main_t *vm);
+void vlib_rcu_barrier_account (const char *caller, f64 time);
+
+/* run fn (data) on the main thread after a grace period */
+#define vlib_rcu_call(fn, data) vlib_rcu_call_int (fn, data, __FUNCTION__)
+
+/* wait for a grace period, suspends when called from a process */
+#define vlib_rcu_synchronize(vm) vlib_rcu_synchronize_int (vm, __FUNCTION__)
+
+static_always_inline void
+vlib_rcu_quiescent (vlib_main_t *vm)
+{
+  u64 epoch = __atomic_load_n (&vlib_rcu_main.epoch, __ATOMIC_ACQUIRE);
+
+  /* the release store orders the table reads of the previous iteration
+     before the new epoch becomes visible to the main thread */
+  if (PREDICT_FALSE (vm->rcu_epoch != epoch))
+    __atomic_store_n (&vm->rcu_epoch, epoch, __ATOMIC_RELEASE);
+}
+
+#endif /* included_vlib_rcu_h */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -335,26 +335,53 @@ vlib_thread_init (vlib_main_t * vm)
   return 0;
 }
 
+/*
+ * The nelts frames of the queue are split between the producer rings,
+ * so adding workers does not grow the handoff memory footprint much.
+ */
+static u32
+vlib_frame_queue_ring_size (u32 nelts, u32 n_rings)
+{
+  u32 size = nelts * VLIB_FRAME_SIZE / n_rings;
+  return max_pow2 (clib_max (size, 4 * VLIB_FRAME_SIZE));
+}
+
 vlib_frame_queue_t *
-vlib_frame_queue_alloc (int nelts)
+vlib_frame_queue_alloc (int nelts, u32 n_rings, int with_aux)
 {
   vlib_frame_queue_t *fq;
+  vlib_frame_queue_ring_t *r;
 
   fq = clib_mem_alloc_aligned (sizeof (*fq), CLIB_CACHE_LINE_BYTES);
   clib_memset (fq, 0, sizeof (*fq));
   fq->nelts = nelts;
   fq->vector_threshold = 2 * VLIB_FRAME_SIZE;
-  vec_validate_aligned (fq->elts, nelts - 1, CLIB_CACHE_LINE_BYTES);
+  vec_validate_aligned (fq->rings, n_rings - 1, CLIB_CACHE_LINE_BYTES);
 
-  if (nelts & (nelts - 1))
+  vec_foreach (r, fq->rings)
     {
-      fformat (stderr, "FATAL: nelts MUST be a power of 2\n");
-      abort ();
+      r->size = r->limit = vlib_frame_queue_ring_size (nelts, n_rings);
+      vec_validate_aligned (r->buffer_indices, r->size - 1,
+			    CLIB_CACHE_LINE_BYTES);
+      if (with_aux)
+	vec_validate_aligned (r->aux_data, r->size - 1, CLIB_CACHE_LINE_BYTES);
     }
 
   return (fq);
 }
 
+/* Shrink the usable part of the rings, used for congestion testing */
+void
+vlib_frame_queue_set_nelts (vlib_frame_queue_t *fq, u32 nelts)
+{
+  vlib_frame_queue_ring_t *r;
+  u32 limit = nelts * VLIB_FRAME_SIZE / vec_len (fq->rings);
+
+  fq->nelts = nelts;
+  vec_foreach (r, fq->rings)
+    r->limit = clib_max (clib_min (limit, r->size), VLIB_FRAME_SIZE);
+}
+
 void vl_msg_api_handler_no_free (void *) __attribute__ ((weak));
 void
 vl_msg_api_handler_no_free (void *v)
@@ -740,6 +767,10 @@ start_workers (vlib_main_t * vm)
 	      /* Create per-thread frame freelist */
 	      nm_clone->frame_sizes = 0;
 	      nm_clone->node_by_error = nm->node_by_error;
+	      /* sized up front so main thread can read it safely */
+	      nm_clone->adaptive_state = 0;
+	      vec_validate (nm_clone->adaptive_state,
+			    vec_len (nm_clone->nodes) - 1);
 
 	      /* Packet trace buffers are guaranteed to be empty, nothing to do here */
 
@@ -1059,6 +1090,8 @@ vlib_worker_thread_node_refork (void)
 
   vec_free (old_rt);
 
+  vec_validate (nm_clone->adaptive_state, vec_len (nm_clone->nodes) - 1);
+
   /* re-clone pre-input nodes */
   old_rt = nm_clone->nodes_by_type[VLIB_NODE_TYPE_PRE_INPUT];
   nm_clone->nodes_by_type[VLIB_NODE_TYPE_PRE_INPUT] =
@@ -1342,6 +1375,7 @@ vlib_worker_thread_barrier_sync_int (vlib_main_t * vm, const char *func_name)
     }
 
   vlib_worker_threads[0].barrier_sync_count++;
+  vlib_rcu_main.barrier_caller = func_name;
 
   /* Enforce minimum barrier open time to minimize packet loss */
   ASSERT (vm->barrier_no_close_before <= (now + BARRIER_MINIMUM_OPEN_LIMIT));
@@ -1480,6 +1514,7 @@ vlib_worker_thread_barrier_release (vlib_main_t * vm)
     }
 
   t_closed_total = now - vm->barrier_epoch;
+  vlib_rcu_barrier_account (vlib_rcu_main.barrier_caller, t_closed_total);
 
   minimum_open = t_closed_total * BARRIER_MINIMUM_OPEN_FACTOR;
 
@@ -1632,17 +1667,13 @@ vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts)
   vlib_frame_queue_t *fq;
   vlib_node_t *node;
   int i;
-  u32 num_threads;
 
   if (frame_queue_nelts == 0)
     frame_queue_nelts = FRAME_QUEUE_MAX_NELTS;
 
-  num_threads = 1 /* main thread */  + tm->n_threads;
-  ASSERT (frame_queue_nelts >= 8 + num_threads);
-
   vec_add2 (tm->frame_queue_mains, fqm, 1);
 
-  node = vlib_get_node (vm, fqm->node_index);
+  node = vlib_get_node (vm, node_index);
   ASSERT (node);
   if (node->aux_offset)
     {
@@ -1662,9 +1693,12 @@ vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts)
   vec_set_len (fqm->vlib_frame_queues, 0);
   for (i = 0; i < tm->n_vlib_mains; i++)
     {
-      fq = vlib_frame_queue_alloc (frame_queue_nelts);
+      fq = vlib_frame_queue_alloc (frame_queue_nelts, tm->n_vlib_mains,
+				   node->aux_offset != 0);
       vec_add1 (fqm->vlib_frame_queues, fq);
     }
+  vec_validate_aligned (fqm->per_thread_data, tm->n_vlib_mains - 1,
+			CLIB_CACHE_LINE_BYTES);
 
   return (fqm - tm->frame_queue_mains);
 }
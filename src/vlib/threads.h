@@ -48,21 +48,6 @@ typedef struct vlib_thread_registration_
 #define VLIB_LOG2_THREAD_STACK_SIZE (21)
 #define VLIB_THREAD_STACK_SIZE (1<<VLIB_LOG2_THREAD_STACK_SIZE)
 
-typedef struct
-{
-  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
-  volatile u32 valid;
-  u32 maybe_trace : 1;
-  u32 n_vectors;
-  u32 offset;
-  STRUCT_MARK (end_of_reset);
-
-  CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
-  u32 buffer_index[VLIB_FRAME_SIZE];
-  u32 aux_data[VLIB_FRAME_SIZE];
-}
-vlib_frame_queue_elt_t;
-
 typedef struct
 {
   /* First cache line */
@@ -99,25 +84,62 @@ typedef struct
 
 extern vlib_worker_thread_t *vlib_worker_threads;
 
+/*
+ * Single producer, single consumer ring of buffer indices, one per
+ * producer thread and consumer thread pair. Producers enqueue whole
+ * bursts with a single tail update and never contend with each other.
+ */
 typedef struct
 {
   /* static data */
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
-  vlib_frame_queue_elt_t *elts;
-  u64 vector_threshold;
-  u64 trace;
-  u32 nelts;
+  u32 *buffer_indices;
+  u32 *aux_data;
+  u32 size;
+  /* usable part of the ring, may be lowered at runtime */
+  u32 limit;
 
   /* modified by enqueue side  */
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
   volatile u64 tail;
+  /* last head seen by the producer, saves reading the consumer's line */
+  u64 head_cache;
+  /* packets held back on congestion, flushed ahead of any new ones */
+  u32 *backlog;
+  u32 *backlog_aux;
+  volatile u32 maybe_trace;
 
   /* modified by dequeue side  */
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline2);
   volatile u64 head;
+} vlib_frame_queue_ring_t;
+
+/* max packets held back per ring before congestion drops kick in */
+#define VLIB_FRAME_QUEUE_BACKLOG_SIZE (2 * VLIB_FRAME_SIZE)
+
+typedef struct
+{
+  /* static data */
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /* indexed by producer thread */
+  vlib_frame_queue_ring_t *rings;
+  u64 vector_threshold;
+  u64 trace;
+  u32 nelts;
+
+  /* modified by dequeue side  */
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+  u32 next_ring;
 }
 vlib_frame_queue_t;
 
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /* consumer threads this producer holds a backlog for */
+  uword *backlog_bitmap;
+} vlib_frame_queue_per_thread_t;
+
 struct vlib_frame_queue_main_t_;
 typedef u32 (vlib_frame_queue_dequeue_fn_t) (
   vlib_main_t *vm, struct vlib_frame_queue_main_t_ *fqm);
@@ -127,6 +149,7 @@ typedef struct vlib_frame_queue_main_t_
   u32 frame_queue_nelts;
 
   vlib_frame_queue_t **vlib_frame_queues;
+  vlib_frame_queue_per_thread_t *per_thread_data;
 
   /* for frame queue tracing */
   frame_queue_trace_t *frame_queue_traces;
@@ -151,6 +174,9 @@ void vlib_create_worker_threads (vlib_main_t * vm, int n,
 
 void vlib_worker_thread_init (vlib_worker_thread_t * w);
 u32 vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts);
+vlib_frame_queue_t *vlib_frame_queue_alloc (int nelts, u32 n_rings,
+					    int with_aux);
+void vlib_frame_queue_set_nelts (vlib_frame_queue_t *fq, u32 nelts);
 
 /* Check for a barrier sync request every 30ms */
 #define BARRIER_SYNC_DELAY (0.030000)
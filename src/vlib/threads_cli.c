@@ -437,7 +437,7 @@ test_frame_queue_nelts (vlib_main_t * vm, unformat_input_t * input,
 
   for (fqix = 0; fqix < num_fq; fqix++)
     {
-      fqm->vlib_frame_queues[fqix]->nelts = nelts;
+      vlib_frame_queue_set_nelts (fqm->vlib_frame_queues[fqix], nelts);
     }
 
 done:
@@ -66,200 +66,102 @@ flow_classify_inline (vlib_main_t * vm,
 		      vlib_node_runtime_t * node,
 		      vlib_frame_t * frame, flow_classify_table_id_t tid)
 {
-  u32 n_left_from, *from, *to_next;
-  flow_classify_next_index_t next_index;
+  u32 n_vectors, *from;
   flow_classify_main_t *fcm = &flow_classify_main;
   vnet_classify_main_t *vcm = fcm->vnet_classify_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 table_indices[VLIB_FRAME_SIZE], hashes[VLIB_FRAME_SIZE];
+  vnet_classify_entry_t *entries[VLIB_FRAME_SIZE];
+  const u8 *headers[VLIB_FRAME_SIZE];
   f64 now = vlib_time_now (vm);
   u32 hits = 0;
   u32 misses = 0;
   u32 chain_hits = 0;
   u32 drop = 0;
+  u32 i;
 
   from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
+  n_vectors = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_vectors);
 
-  /* First pass: compute hashes */
-  while (n_left_from > 2)
+  /* First pass: find each packet's table */
+  for (i = 0; i < n_vectors; i++)
     {
-      vlib_buffer_t *b0, *b1;
-      u32 bi0, bi1;
-      u8 *h0, *h1;
-      u32 sw_if_index0, sw_if_index1;
-      u32 table_index0, table_index1;
-      vnet_classify_table_t *t0, *t1;
-
-      /* Prefetch next iteration */
-      {
-	vlib_buffer_t *p1, *p2;
-
-	p1 = vlib_get_buffer (vm, from[1]);
-	p2 = vlib_get_buffer (vm, from[2]);
-
-	vlib_prefetch_buffer_header (p1, STORE);
-	clib_prefetch_store (p1->data);
-	vlib_prefetch_buffer_header (p2, STORE);
-	clib_prefetch_store (p2->data);
-      }
-
-      bi0 = from[0];
-      b0 = vlib_get_buffer (vm, bi0);
-      h0 = b0->data;
-
-      bi1 = from[1];
-      b1 = vlib_get_buffer (vm, bi1);
-      h1 = b1->data;
-
-      sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_RX];
-      table_index0 =
-	fcm->classify_table_index_by_sw_if_index[tid][sw_if_index0];
-
-      sw_if_index1 = vnet_buffer (b1)->sw_if_index[VLIB_RX];
-      table_index1 =
-	fcm->classify_table_index_by_sw_if_index[tid][sw_if_index1];
-
-      t0 = pool_elt_at_index (vcm->tables, table_index0);
-
-      t1 = pool_elt_at_index (vcm->tables, table_index1);
-
-      vnet_buffer (b0)->l2_classify.hash = vnet_classify_hash_packet (t0, h0);
-
-      vnet_classify_prefetch_bucket (t0, vnet_buffer (b0)->l2_classify.hash);
-
-      vnet_buffer (b1)->l2_classify.hash = vnet_classify_hash_packet (t1, h1);
-
-      vnet_classify_prefetch_bucket (t1, vnet_buffer (b1)->l2_classify.hash);
-
-      vnet_buffer (b0)->l2_classify.table_index = table_index0;
-
-      vnet_buffer (b1)->l2_classify.table_index = table_index1;
-
-      from += 2;
-      n_left_from -= 2;
-    }
-
-  while (n_left_from > 0)
-    {
-      vlib_buffer_t *b0;
-      u32 bi0;
-      u8 *h0;
       u32 sw_if_index0;
-      u32 table_index0;
-      vnet_classify_table_t *t0;
 
-      bi0 = from[0];
-      b0 = vlib_get_buffer (vm, bi0);
-      h0 = b0->data;
+      b = bufs + i;
+      if (i + 2 < n_vectors)
+	{
+	  vlib_prefetch_buffer_header (b[2], STORE);
+	  clib_prefetch_store (b[2]->data);
+	}
 
-      sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_RX];
-      table_index0 =
+      headers[i] = b[0]->data;
+      sw_if_index0 = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+      table_indices[i] =
 	fcm->classify_table_index_by_sw_if_index[tid][sw_if_index0];
-
-      t0 = pool_elt_at_index (vcm->tables, table_index0);
-      vnet_buffer (b0)->l2_classify.hash = vnet_classify_hash_packet (t0, h0);
-
-      vnet_buffer (b0)->l2_classify.table_index = table_index0;
-      vnet_classify_prefetch_bucket (t0, vnet_buffer (b0)->l2_classify.hash);
-
-      from++;
-      n_left_from--;
     }
 
-  next_index = node->cached_next_index;
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
+  /* Second pass: look them all up; flow tables are not chained */
+  vnet_classify_lookup_n (headers, table_indices, hashes, entries, n_vectors,
+			  now, 0 /* walk_chain */ );
 
-  while (n_left_from > 0)
+  b = bufs;
+  next = nexts;
+  for (i = 0; i < n_vectors; i++)
     {
-      u32 n_left_to_next;
+      u32 next0 = FLOW_CLASSIFY_NEXT_INDEX_DROP;
+      vnet_classify_table_t *t0;
+      vnet_classify_entry_t *e0;
+      u8 *h0 = b[0]->data;
+
+      e0 = entries[i];
+      t0 = 0;
 
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
+      vnet_get_config_data (fcm->vnet_config_main[tid],
+			    &b[0]->current_config_index, &next0,
+			    /* # bytes of config data */ 0);
 
-      /* Not enough load/store slots to dual loop... */
-      while (n_left_from > 0 && n_left_to_next > 0)
+      if (PREDICT_TRUE (table_indices[i] != ~0))
 	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  u32 next0 = FLOW_CLASSIFY_NEXT_INDEX_DROP;
-	  u32 table_index0;
-	  vnet_classify_table_t *t0;
-	  vnet_classify_entry_t *e0;
-	  u32 hash0;
-	  u8 *h0;
-
-	  /* Stride 3 seems to work best */
-	  if (PREDICT_TRUE (n_left_from > 3))
-	    {
-	      vlib_buffer_t *p1 = vlib_get_buffer (vm, from[3]);
-	      vnet_classify_table_t *tp1;
-	      u32 table_index1;
-	      u32 phash1;
-
-	      table_index1 = vnet_buffer (p1)->l2_classify.table_index;
-
-	      if (PREDICT_TRUE (table_index1 != ~0))
-		{
-		  tp1 = pool_elt_at_index (vcm->tables, table_index1);
-		  phash1 = vnet_buffer (p1)->l2_classify.hash;
-		  vnet_classify_prefetch_entry (tp1, phash1);
-		}
-	    }
+	  t0 = pool_elt_at_index (vcm->tables, table_indices[i]);
 
-	  /* Speculatively enqueue b0 to the current next frame */
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-	  h0 = b0->data;
-	  table_index0 = vnet_buffer (b0)->l2_classify.table_index;
-	  e0 = 0;
-	  t0 = 0;
-
-	  vnet_get_config_data (fcm->vnet_config_main[tid],
-				&b0->current_config_index, &next0,
-				/* # bytes of config data */ 0);
-
-	  if (PREDICT_TRUE (table_index0 != ~0))
+	  /* an earlier packet of the frame may have added the flow */
+	  if (PREDICT_FALSE (!e0))
+	    e0 = vnet_classify_find_entry (t0, h0, hashes[i], now);
+
+	  if (e0)
 	    {
-	      hash0 = vnet_buffer (b0)->l2_classify.hash;
-	      t0 = pool_elt_at_index (vcm->tables, table_index0);
-	      e0 = vnet_classify_find_entry (t0, h0, hash0, now);
-	      if (e0)
-		{
-		  hits++;
-		}
-	      else
-		{
-		  misses++;
-		  vnet_classify_add_del_session (vcm, table_index0,
-						 h0, ~0, 0, 0, 0, 0, 1);
-		  /* increment counter */
-		  vnet_classify_find_entry (t0, h0, hash0, now);
-		}
+	      hits++;
 	    }
-	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
-			     && (b0->flags & VLIB_BUFFER_IS_TRACED)))
+	  else
 	    {
-	      flow_classify_trace_t *t =
-		vlib_add_trace (vm, node, b0, sizeof (*t));
-	      t->sw_if_index = vnet_buffer (b0)->sw_if_index[VLIB_RX];
-	      t->next_index = next0;
-	      t->table_index = t0 ? t0 - vcm->tables : ~0;
-	      t->offset = (t0 && e0) ? vnet_classify_get_offset (t0, e0) : ~0;
+	      misses++;
+	      vnet_classify_add_del_session (vcm, table_indices[i],
+					     h0, ~0, 0, 0, 0, 0, 1);
+	      /* increment counter */
+	      vnet_classify_find_entry (t0, h0, hashes[i], now);
 	    }
-
-	  /* Verify speculative enqueue, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
+	}
+      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
+			 && (b[0]->flags & VLIB_BUFFER_IS_TRACED)))
+	{
+	  flow_classify_trace_t *t =
+	    vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+	  t->next_index = next0;
+	  t->table_index = t0 ? t0 - vcm->tables : ~0;
+	  t->offset = (t0 && e0) ? vnet_classify_get_offset (t0, e0) : ~0;
 	}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      next[0] = next0;
+      b += 1;
+      next += 1;
     }
 
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
   vlib_node_increment_counter (vm, node->node_index,
 			       FLOW_CLASSIFY_ERROR_MISS, misses);
   vlib_node_increment_counter (vm, node->node_index,
@@ -581,6 +581,97 @@ vnet_classify_find_entry_inline (const vnet_classify_table_t *t, const u8 *h,
   return 0;
 }
 
+/**
+ * @brief Look up a vector of packets in their classify table chains.
+ *
+ * The packets move through the chains together: each round hashes the
+ * masked keys of every packet still searching and prefetches its bucket,
+ * then prefetches the entries a few packets ahead of the matching. The
+ * packets that miss and whose table has a next table make up the next
+ * round, so a long chain costs a round per table instead of a dependent
+ * walk per packet.
+ *
+ * @param h header of each packet, as given to vnet_classify_hash_packet
+ * @param table_indices in: first table of each packet's chain, ~0 for
+ *        none; out: the table that matched, or the last table tried
+ * @param hashes out: the packet's hash in that table
+ * @param entries out: the matching entry, or 0
+ * @param n number of packets, at most VLIB_FRAME_SIZE
+ * @param now time to record against matching entries, 0 for none
+ * @param walk_chain zero to look in the first table only
+ * @return the number of matches in other than the first table
+ */
+static_always_inline u32
+vnet_classify_lookup_n (const u8 **h, u32 *table_indices, u32 *hashes,
+			vnet_classify_entry_t **entries, u32 n, f64 now,
+			int walk_chain)
+{
+  vnet_classify_main_t *vcm = &vnet_classify_main;
+  vnet_classify_table_t *t;
+  u16 todo[VLIB_FRAME_SIZE];
+  u32 i, j, n_todo, n_next, n_chain_hits = 0;
+  int is_chain = 0;
+
+  ASSERT (n <= VLIB_FRAME_SIZE);
+
+  n_todo = 0;
+  for (i = 0; i < n; i++)
+    {
+      entries[i] = 0;
+      if (PREDICT_TRUE (table_indices[i] != ~0))
+	todo[n_todo++] = i;
+    }
+
+  while (n_todo)
+    {
+      /* hash the keys, prefetch the buckets */
+      for (j = 0; j < n_todo; j++)
+	{
+	  i = todo[j];
+	  t = pool_elt_at_index (vcm->tables, table_indices[i]);
+	  hashes[i] = vnet_classify_hash_packet_inline (t, h[i]);
+	  vnet_classify_prefetch_bucket (t, hashes[i]);
+	}
+
+      /* the first buckets are in by now, prefetch their entries */
+      for (j = 0; j < clib_min (n_todo, 4); j++)
+	{
+	  i = todo[j];
+	  t = pool_elt_at_index (vcm->tables, table_indices[i]);
+	  vnet_classify_prefetch_entry (t, hashes[i]);
+	}
+
+      n_next = 0;
+      for (j = 0; j < n_todo; j++)
+	{
+	  if (j + 4 < n_todo)
+	    {
+	      i = todo[j + 4];
+	      t = pool_elt_at_index (vcm->tables, table_indices[i]);
+	      vnet_classify_prefetch_entry (t, hashes[i]);
+	    }
+
+	  i = todo[j];
+	  t = pool_elt_at_index (vcm->tables, table_indices[i]);
+	  entries[i] = vnet_classify_find_entry_inline (t, h[i], hashes[i], now);
+
+	  if (entries[i])
+	    n_chain_hits += is_chain;
+	  else if (walk_chain && t->next_table_index != ~0)
+	    {
+	      /* on to the next table in the chain, in the next round */
+	      table_indices[i] = t->next_table_index;
+	      todo[n_next++] = i;
+	    }
+	}
+
+      n_todo = n_next;
+      is_chain = 1;
+    }
+
+  return n_chain_hits;
+}
+
 vnet_classify_table_t *vnet_classify_new_table (vnet_classify_main_t *cm,
 						const u8 *mask, u32 nbuckets,
 						u32 memory_size,
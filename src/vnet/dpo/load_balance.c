@@ -138,6 +138,38 @@ load_balance_alloc_i (void)
     return (lb);
 }
 
+u8
+load_balance_pool_will_expand (u32 n)
+{
+    uword n_free = pool_free_elts(load_balance_pool);
+    index_t last = vec_len(load_balance_pool) + n;
+
+    if (n_free < n &&
+        vec_resize_will_expand(load_balance_pool, n - n_free))
+        return (1);
+
+    return (vlib_validate_combined_counter_will_expand
+            (&(load_balance_main.lbm_to_counters), last) ||
+            vlib_validate_combined_counter_will_expand
+            (&(load_balance_main.lbm_via_counters), last));
+}
+
+void
+load_balance_pool_reserve (u32 n)
+{
+    uword n_free = pool_free_elts(load_balance_pool);
+    index_t last = vec_len(load_balance_pool) + n;
+
+    if (n_free < n)
+        pool_alloc_aligned(load_balance_pool, n - n_free,
+                           CLIB_CACHE_LINE_BYTES);
+
+    vlib_validate_combined_counter(&(load_balance_main.lbm_to_counters),
+                                   last);
+    vlib_validate_combined_counter(&(load_balance_main.lbm_via_counters),
+                                   last);
+}
+
 static u8*
 load_balance_format (index_t lbi,
                      load_balance_format_flags_t flags,
@@ -195,6 +195,13 @@ typedef enum load_balance_format_flags_t_ {
     LOAD_BALANCE_FORMAT_DETAIL = (1 << 0),
 } load_balance_format_flags_t;
 
+/**
+ * Make room for n more load-balances so that allocating them does not
+ * need the worker barrier. reserve is called with the barrier held.
+ */
+extern u8 load_balance_pool_will_expand(u32 n);
+extern void load_balance_pool_reserve(u32 n);
+
 extern index_t load_balance_create(u32 num_buckets,
 				   dpo_proto_t lb_proto,
 				   flow_hash_config_t fhc);
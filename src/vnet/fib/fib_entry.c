@@ -530,6 +530,24 @@ fib_entry_child_remove (fib_node_index_t fib_entry_index,
     }
 }
 
+u8
+fib_entry_pool_will_expand (u32 n)
+{
+    uword n_free = pool_free_elts(fib_entry_pool);
+
+    return (n_free < n &&
+            vec_resize_will_expand(fib_entry_pool, n - n_free));
+}
+
+void
+fib_entry_pool_reserve (u32 n)
+{
+    uword n_free = pool_free_elts(fib_entry_pool);
+
+    if (n_free < n)
+        pool_alloc(fib_entry_pool, n - n_free);
+}
+
 static fib_entry_t *
 fib_entry_alloc (u32 fib_index,
 		 const fib_prefix_t *prefix,
@@ -22,6 +22,8 @@
 #include <vnet/fib/ip4_fib.h>
 #include <vnet/fib/ip6_fib.h>
 #include <vnet/fib/mpls_fib.h>
+#include <vnet/fib/fib_urpf_list.h>
+#include <vnet/dpo/load_balance.h>
 
 const static char * fib_table_flags_strings[] = FIB_TABLE_ATTRIBUTES;
 
@@ -770,6 +772,31 @@ fib_table_entry_path_remove (u32 fib_index,
     vec_free(paths);
 }
 
+void
+fib_table_entry_reserve (u32 n_entries, u32 n_ip4_plies)
+{
+    vlib_main_t *vm = vlib_get_main();
+
+    ASSERT (vm->thread_index == 0);
+
+    /*
+     * the data-plane visible pools grow under the worker barrier. do it
+     * once for the whole batch rather than at each reallocation.
+     */
+    if (!fib_entry_pool_will_expand(n_entries) &&
+        !load_balance_pool_will_expand(n_entries) &&
+        !fib_urpf_list_pool_will_expand(n_entries) &&
+        !ip4_mtrie_ply_pool_will_expand(n_ip4_plies))
+        return;
+
+    vlib_worker_thread_barrier_sync(vm);
+    fib_entry_pool_reserve(n_entries);
+    load_balance_pool_reserve(n_entries);
+    fib_urpf_list_pool_reserve(n_entries);
+    ip4_mtrie_ply_pool_reserve(n_ip4_plies);
+    vlib_worker_thread_barrier_release(vm);
+}
+
 fib_node_index_t
 fib_table_entry_update (u32 fib_index,
 			const fib_prefix_t *prefix,
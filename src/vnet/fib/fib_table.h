@@ -448,6 +448,21 @@ extern void fib_table_entry_path_remove2(u32 fib_index,
 					 fib_source_t source,
 					 fib_route_path_t *paths);
 
+/**
+ * @brief
+ *  Make room for n_entries more entries, their load-balance and uRPF
+ *  lists, and n_ip4_plies IPv4 mtrie plies, under a single worker
+ *  barrier. Used before programming routes in bulk, so that pool growth
+ *  does not stop the workers once per reallocation.
+ *
+ * @param n_entries
+ *  The number of entries about to be added
+ *
+ * @param n_ip4_plies
+ *  The number of plies the IPv4 entries may add, see ip4_mtrie_ply_count
+ */
+extern void fib_table_entry_reserve(u32 n_entries, u32 n_ip4_plies);
+
 /**
  * @brief
  *  Update an entry to have a new set of paths. If the entry does not
@@ -51,6 +51,24 @@ format_fib_urpf_list (u8 *s, va_list *args)
     return (s);
 }
 
+u8
+fib_urpf_list_pool_will_expand (u32 n)
+{
+    uword n_free = pool_free_elts(fib_urpf_list_pool);
+
+    return (n_free < n &&
+            vec_resize_will_expand(fib_urpf_list_pool, n - n_free));
+}
+
+void
+fib_urpf_list_pool_reserve (u32 n)
+{
+    uword n_free = pool_free_elts(fib_urpf_list_pool);
+
+    if (n_free < n)
+        pool_alloc(fib_urpf_list_pool, n - n_free);
+}
+
 index_t
 fib_urpf_list_alloc_and_lock (void)
 {
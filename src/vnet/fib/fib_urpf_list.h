@@ -75,6 +75,8 @@ typedef struct fib_urpf_list_t_
 } fib_urpf_list_t;
 
 extern index_t fib_urpf_list_alloc_and_lock(void);
+extern u8 fib_urpf_list_pool_will_expand(u32 n);
+extern void fib_urpf_list_pool_reserve(u32 n);
 extern void fib_urpf_list_unlock(index_t urpf);
 extern void fib_urpf_list_lock(index_t urpf);
 
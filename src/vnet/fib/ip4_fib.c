@@ -17,6 +17,11 @@
 #include <vnet/fib/fib_entry.h>
 #include <vnet/fib/ip4_fib.h>
 
+/*
+ * Forward new tables with the poptrie, from the 'ip' startup config
+ */
+static u8 ip4_fib_table_poptrie;
+
 /*
  * A table of prefixes to be added to tables and the sources for them
  */
@@ -177,6 +182,9 @@ ip4_create_fib_with_table_id (u32 table_id,
 
     ip4_fib_table_init(v4_fib);
 
+    if (ip4_fib_table_poptrie)
+        ip4_fib_table_set_poptrie(fib_table->ft_index, 1);
+
     /*
      * add the special entries into the new FIB
      */
@@ -225,6 +233,123 @@ ip4_fib_table_destroy (u32 fib_index)
 }
 
 
+static fib_table_walk_rc_t
+ip4_fib_table_collect (fib_node_index_t fei,
+                       void *arg)
+{
+    fib_node_index_t **entries = arg;
+
+    vec_add1(*entries, fei);
+
+    return (FIB_TABLE_WALK_CONTINUE);
+}
+
+static int
+ip4_fib_entry_sort_longest_first (void *a1,
+                                  void *a2)
+{
+    const fib_prefix_t *p1, *p2;
+
+    p1 = fib_entry_get_prefix(*(fib_node_index_t *) a1);
+    p2 = fib_entry_get_prefix(*(fib_node_index_t *) a2);
+
+    return ((int) p2->fp_len - (int) p1->fp_len);
+}
+
+void
+ip4_fib_table_set_poptrie (u32 fib_index,
+                           int enable)
+{
+    vlib_main_t *vm = vlib_get_main();
+    ip4_fib_t *fib = ip4_fib_get(fib_index);
+    fib_node_index_t *entries = NULL, *fei;
+    const fib_prefix_t *pfx, *cover_pfx;
+    const dpo_id_t *dpo, *cover_dpo;
+    ip4_poptrie_t *poptrie;
+
+    if (!enable == (NULL == fib->poptrie))
+        return;
+
+    ip4_fib_table_walk(fib, ip4_fib_table_collect, &entries);
+
+    if (enable)
+    {
+        /*
+         * build the poptrie aside, the workers use the mtrie until the
+         * switch
+         */
+        poptrie = clib_mem_alloc(sizeof(*poptrie));
+        ip4_poptrie_init(poptrie);
+
+        vec_foreach(fei, entries)
+        {
+            pfx = fib_entry_get_prefix(*fei);
+            dpo = fib_entry_contribute_ip_forwarding(*fei);
+            ip4_poptrie_route_add(poptrie, &pfx->fp_addr.ip4, pfx->fp_len,
+                                  dpo->dpoi_index);
+        }
+
+        vlib_worker_thread_barrier_sync(vm);
+        fib->poptrie = poptrie;
+        vlib_worker_thread_barrier_release(vm);
+
+        /*
+         * empty the mtrie so its plys are returned. Longest first, so the
+         * cover of each prefix is still in the mtrie when it is removed.
+         */
+        vec_sort_with_function(entries, ip4_fib_entry_sort_longest_first);
+
+        vec_foreach(fei, entries)
+        {
+            u32 cover_len = 0, cover_lbi = 0;
+
+            pfx = fib_entry_get_prefix(*fei);
+            dpo = fib_entry_contribute_ip_forwarding(*fei);
+
+            if (pfx->fp_len > 0)
+            {
+                fib_node_index_t cover;
+
+                cover = ip4_fib_table_lookup(fib, &pfx->fp_addr.ip4,
+                                             pfx->fp_len - 1);
+                if (FIB_NODE_INDEX_INVALID != cover)
+                {
+                    cover_pfx = fib_entry_get_prefix(cover);
+                    cover_dpo = fib_entry_contribute_ip_forwarding(cover);
+                    cover_len = cover_pfx->fp_len;
+                    cover_lbi = cover_dpo->dpoi_index;
+                }
+            }
+            ip4_mtrie_route_del(&fib->mtrie, &pfx->fp_addr.ip4, pfx->fp_len,
+                                dpo->dpoi_index, cover_len, cover_lbi);
+        }
+    }
+    else
+    {
+        /*
+         * refill the mtrie, which the workers do not read until the switch
+         */
+        vec_foreach(fei, entries)
+        {
+            pfx = fib_entry_get_prefix(*fei);
+            dpo = fib_entry_contribute_ip_forwarding(*fei);
+            ip4_mtrie_route_add(&fib->mtrie, &pfx->fp_addr.ip4, pfx->fp_len,
+                                dpo->dpoi_index);
+        }
+
+        poptrie = fib->poptrie;
+
+        vlib_worker_thread_barrier_sync(vm);
+        fib->poptrie = NULL;
+        vlib_worker_thread_barrier_release(vm);
+
+        ip4_poptrie_free(poptrie);
+        clib_mem_free(poptrie);
+    }
+
+    vec_free(entries);
+}
+
 u32
 ip4_fib_table_find_or_create_and_lock (u32 table_id,
                                        fib_source_t src)
@@ -393,7 +518,10 @@ ip4_show_fib (vlib_main_t * vm,
             uword mtrie_size, hash_size;
 
 
-            mtrie_size = ip4_mtrie_memory_usage(&fib->mtrie);
+            if (NULL != fib->poptrie)
+                mtrie_size = ip4_poptrie_memory_usage(fib->poptrie);
+            else
+                mtrie_size = ip4_mtrie_memory_usage(&fib->mtrie);
             hash_size = 0;
 
 	    for (i = 0; i < ARRAY_LEN (fib->hash.fib_entry_by_dst_address); i++)
@@ -440,7 +568,12 @@ ip4_show_fib (vlib_main_t * vm,
 	/* Show summary? */
 	if (mtrie)
         {
-	    vlib_cli_output (vm, "%U", format_ip4_mtrie, &fib->mtrie, verbose);
+            if (NULL != fib->poptrie)
+                vlib_cli_output (vm, "%U", format_ip4_poptrie, fib->poptrie,
+                                 verbose);
+            else
+                vlib_cli_output (vm, "%U", format_ip4_mtrie, &fib->mtrie,
+                                 verbose);
             continue;
         }
 	if (! verbose)
@@ -628,3 +761,72 @@ VLIB_CLI_COMMAND (ip4_show_fib_command, static) = {
     .function = ip4_show_fib,
 };
 /* *INDENT-ON* */
+
+static clib_error_t *
+ip4_fib_lookup_command_fn (vlib_main_t * vm,
+                           unformat_input_t * input,
+                           vlib_cli_command_t * cmd)
+{
+    u32 table_id = 0, fib_index;
+    int enable = -1;
+
+    while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+        if (unformat (input, "table %d", &table_id))
+            ;
+        else if (unformat (input, "poptrie"))
+            enable = 1;
+        else if (unformat (input, "mtrie"))
+            enable = 0;
+        else
+            return (clib_error_return (0, "unknown input '%U'",
+                                       format_unformat_error, input));
+    }
+
+    if (-1 == enable)
+        return (clib_error_return (0, "specify mtrie or poptrie"));
+
+    fib_index = fib_table_find (FIB_PROTOCOL_IP4, table_id);
+
+    if (~0 == fib_index)
+        return (clib_error_return (0, "no such table %d", table_id));
+
+    ip4_fib_table_set_poptrie (fib_index, enable);
+
+    return (NULL);
+}
+
+/*?
+ * This command selects the structure forwarding lookups use in an IPv4
+ * table. The mtrie is the default; the poptrie is a compressed 8-8-8-8
+ * trie that uses much less memory for large tables, at the cost of a
+ * slightly longer lookup. The default for new tables is set by
+ * 'ip { fib-lookup poptrie }' in the startup config.
+ *
+ * @cliexpar
+ * @cliexcmd{set ip fib-lookup table 0 poptrie}
+ ?*/
+VLIB_CLI_COMMAND (ip4_fib_lookup_command, static) = {
+    .path = "set ip fib-lookup",
+    .short_help = "set ip fib-lookup [table <table-id>] <mtrie|poptrie>",
+    .function = ip4_fib_lookup_command_fn,
+};
+
+static clib_error_t *
+ip4_fib_config (vlib_main_t * vm, unformat_input_t * input)
+{
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "fib-lookup poptrie"))
+	ip4_fib_table_poptrie = 1;
+      else if (unformat (input, "fib-lookup mtrie"))
+	ip4_fib_table_poptrie = 0;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  return 0;
+}
+
+VLIB_EARLY_CONFIG_FUNCTION (ip4_fib_config, "ip");
@@ -59,6 +59,8 @@ typedef ip4_fib_16_t ip4_fib_t;
 #define ip4_fib_table_init ip4_fib_16_table_init
 #define ip4_fib_table_free ip4_fib_16_table_free
 #define ip4_mtrie_memory_usage ip4_mtrie_16_memory_usage
+#define ip4_mtrie_route_add ip4_mtrie_16_route_add
+#define ip4_mtrie_route_del ip4_mtrie_16_route_del
 #define format_ip4_mtrie format_ip4_mtrie_16
 
 #else
@@ -77,6 +79,8 @@ typedef ip4_fib_8_t ip4_fib_t;
 #define ip4_fib_table_init ip4_fib_8_table_init
 #define ip4_fib_table_free ip4_fib_8_table_free
 #define ip4_mtrie_memory_usage ip4_mtrie_8_memory_usage
+#define ip4_mtrie_route_add ip4_mtrie_8_route_add
+#define ip4_mtrie_route_del ip4_mtrie_8_route_del
 #define format_ip4_mtrie format_ip4_mtrie_8
 
 #endif
@@ -117,6 +121,11 @@ extern void ip4_fib_table_destroy(u32 fib_index);
 
 extern u8 *format_ip4_fib_table_memory(u8 * s, va_list * args);
 
+/**
+ * @brief Forward with the poptrie, rather than the mtrie, in this table
+ */
+extern void ip4_fib_table_set_poptrie(u32 fib_index, int enable);
+
 static inline 
 u32 ip4_fib_index_from_table_id (u32 table_id)
 {
@@ -137,10 +146,14 @@ always_inline index_t
 ip4_fib_forwarding_lookup (u32 fib_index,
                            const ip4_address_t * addr)
 {
+    ip4_fib_t *fib = ip4_fib_get(fib_index);
     ip4_mtrie_leaf_t leaf;
     ip4_mtrie_16_t * mtrie;
 
-    mtrie = &ip4_fib_get(fib_index)->mtrie;
+    if (PREDICT_FALSE(NULL != fib->poptrie))
+        return (ip4_poptrie_lookup(fib->poptrie, addr));
+
+    mtrie = &fib->mtrie;
 
     leaf = ip4_mtrie_16_lookup_step_one (mtrie, addr);
     leaf = ip4_mtrie_16_lookup_step (leaf, addr, 2);
@@ -160,6 +173,14 @@ ip4_fib_forwarding_lookup_x2 (u32 fib_index0,
     ip4_mtrie_leaf_t leaf[2];
     ip4_mtrie_16_t * mtrie[2];
 
+    if (PREDICT_FALSE(NULL != ip4_fib_get(fib_index0)->poptrie ||
+                      NULL != ip4_fib_get(fib_index1)->poptrie))
+    {
+        *lb0 = ip4_fib_forwarding_lookup(fib_index0, addr0);
+        *lb1 = ip4_fib_forwarding_lookup(fib_index1, addr1);
+        return;
+    }
+
     mtrie[0] = &ip4_fib_get(fib_index0)->mtrie;
     mtrie[1] = &ip4_fib_get(fib_index1)->mtrie;
 
@@ -191,6 +212,18 @@ ip4_fib_forwarding_lookup_x4 (u32 fib_index0,
     ip4_mtrie_leaf_t leaf[4];
     ip4_mtrie_16_t * mtrie[4];
 
+    if (PREDICT_FALSE(NULL != ip4_fib_get(fib_index0)->poptrie ||
+                      NULL != ip4_fib_get(fib_index1)->poptrie ||
+                      NULL != ip4_fib_get(fib_index2)->poptrie ||
+                      NULL != ip4_fib_get(fib_index3)->poptrie))
+    {
+        *lb0 = ip4_fib_forwarding_lookup(fib_index0, addr0);
+        *lb1 = ip4_fib_forwarding_lookup(fib_index1, addr1);
+        *lb2 = ip4_fib_forwarding_lookup(fib_index2, addr2);
+        *lb3 = ip4_fib_forwarding_lookup(fib_index3, addr3);
+        return;
+    }
+
     mtrie[0] = &ip4_fib_get(fib_index0)->mtrie;
     mtrie[1] = &ip4_fib_get(fib_index1)->mtrie;
     mtrie[2] = &ip4_fib_get(fib_index2)->mtrie;
@@ -223,10 +256,14 @@ always_inline index_t
 ip4_fib_forwarding_lookup (u32 fib_index,
                            const ip4_address_t * addr)
 {
+    ip4_fib_t *fib = ip4_fib_get(fib_index);
     ip4_mtrie_leaf_t leaf;
     ip4_mtrie_8_t * mtrie;
 
-    mtrie = &ip4_fib_get(fib_index)->mtrie;
+    if (PREDICT_FALSE(NULL != fib->poptrie))
+        return (ip4_poptrie_lookup(fib->poptrie, addr));
+
+    mtrie = &fib->mtrie;
 
     leaf = ip4_mtrie_8_lookup_step_one (mtrie, addr);
     leaf = ip4_mtrie_8_lookup_step (leaf, addr, 1);
@@ -247,6 +284,14 @@ ip4_fib_forwarding_lookup_x2 (u32 fib_index0,
     ip4_mtrie_leaf_t leaf[2];
     ip4_mtrie_8_t * mtrie[2];
 
+    if (PREDICT_FALSE(NULL != ip4_fib_get(fib_index0)->poptrie ||
+                      NULL != ip4_fib_get(fib_index1)->poptrie))
+    {
+        *lb0 = ip4_fib_forwarding_lookup(fib_index0, addr0);
+        *lb1 = ip4_fib_forwarding_lookup(fib_index1, addr1);
+        return;
+    }
+
     mtrie[0] = &ip4_fib_get(fib_index0)->mtrie;
     mtrie[1] = &ip4_fib_get(fib_index1)->mtrie;
 
@@ -280,6 +325,18 @@ ip4_fib_forwarding_lookup_x4 (u32 fib_index0,
     ip4_mtrie_leaf_t leaf[4];
     ip4_mtrie_8_t * mtrie[4];
 
+    if (PREDICT_FALSE(NULL != ip4_fib_get(fib_index0)->poptrie ||
+                      NULL != ip4_fib_get(fib_index1)->poptrie ||
+                      NULL != ip4_fib_get(fib_index2)->poptrie ||
+                      NULL != ip4_fib_get(fib_index3)->poptrie))
+    {
+        *lb0 = ip4_fib_forwarding_lookup(fib_index0, addr0);
+        *lb1 = ip4_fib_forwarding_lookup(fib_index1, addr1);
+        *lb2 = ip4_fib_forwarding_lookup(fib_index2, addr2);
+        *lb3 = ip4_fib_forwarding_lookup(fib_index3, addr3);
+        return;
+    }
+
     mtrie[0] = &ip4_fib_get(fib_index0)->mtrie;
     mtrie[1] = &ip4_fib_get(fib_index1)->mtrie;
     mtrie[2] = &ip4_fib_get(fib_index2)->mtrie;
@@ -22,12 +22,19 @@ ip4_fib_16_t *ip4_fib_16s;
 void
 ip4_fib_16_table_init (ip4_fib_16_t *fib)
 {
+    fib->poptrie = NULL;
     ip4_mtrie_16_init(&fib->mtrie);
 }
 
 void
 ip4_fib_16_table_free (ip4_fib_16_t *fib)
 {
+    if (NULL != fib->poptrie)
+    {
+        ip4_poptrie_free(fib->poptrie);
+        clib_mem_free(fib->poptrie);
+        fib->poptrie = NULL;
+    }
     ip4_mtrie_16_free(&fib->mtrie);
 }
 
@@ -92,7 +99,10 @@ ip4_fib_16_table_fwding_dpo_update (ip4_fib_16_t *fib,
 				 u32 len,
 				 const dpo_id_t *dpo)
 {
-    ip4_mtrie_16_route_add(&fib->mtrie, addr, len, dpo->dpoi_index);
+    if (NULL != fib->poptrie)
+        ip4_poptrie_route_add(fib->poptrie, addr, len, dpo->dpoi_index);
+    else
+        ip4_mtrie_16_route_add(&fib->mtrie, addr, len, dpo->dpoi_index);
 }
 
 void
@@ -105,6 +115,15 @@ ip4_fib_16_table_fwding_dpo_remove (ip4_fib_16_t *fib,
     const fib_prefix_t *cover_prefix;
     const dpo_id_t *cover_dpo;
 
+    /*
+     * the poptrie finds the cover itself
+     */
+    if (NULL != fib->poptrie)
+    {
+        ip4_poptrie_route_del(fib->poptrie, addr, len);
+        return;
+    }
+
     /*
      * We need to pass the MTRIE the LB index and address length of the
      * covering prefix, so it can fill the plys with the correct replacement
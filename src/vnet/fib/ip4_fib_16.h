@@ -32,15 +32,22 @@
 
 #include <vnet/fib/ip4_fib_hash.h>
 #include <vnet/ip/ip4_mtrie.h>
+#include <vnet/ip/ip4_poptrie.h>
 
 typedef struct ip4_fib_16_t_
 {
   /** Required for pool_get_aligned */
   CLIB_CACHE_LINE_ALIGN_MARK(cacheline0);
 
+  /**
+   * Poptrie used for forwarding instead of the mtrie when set, in which
+   * case the mtrie is empty. See ip4_fib_table_set_poptrie.
+   */
+  ip4_poptrie_t *poptrie;
+
   /**
    * Mtrie for fast lookups. Hash is used to maintain overlapping prefixes.
-   * First member so it's in the first cacheline.
+   * In the first cacheline, after the poptrie pointer.
    */
   ip4_mtrie_16_t mtrie;
 
@@ -16,6 +16,7 @@
 #include <vnet/fib/ip6_fib.h>
 #include <vnet/fib/fib_table.h>
 #include <vnet/dpo/ip6_ll_dpo.h>
+#include <vppinfra/mhash.h>
 
 #include <vppinfra/bihash_24_8.h>
 #include <vppinfra/bihash_template.c>
@@ -25,6 +26,7 @@ ip6_fib_table_instance_t ip6_fib_table[IP6_FIB_NUM_TABLES];
 /* ip6 lookup table config parameters */
 u32 ip6_fib_table_nbuckets;
 uword ip6_fib_table_size;
+static u8 ip6_fib_table_binary_search;
 
 static void
 vnet_ip6_fib_init (u32 fib_index)
@@ -92,6 +94,9 @@ create_fib_with_table_id (u32 table_id,
     fib_table->ft_flags = flags;
     fib_table->ft_desc = desc;
 
+    if (ip6_fib_table_binary_search)
+        ip6_fib_table_set_binary_search(fib_table->ft_index, 1);
+
     vnet_ip6_fib_init(fib_table->ft_index);
     fib_table_lock(fib_table->ft_index, FIB_PROTOCOL_IP6, src);
 
@@ -170,6 +175,8 @@ ip6_fib_table_destroy (u32 fib_index)
 	ASSERT(0 == fib_table->ft_src_route_counts[source]);
     }
 
+    ip6_fib_table_set_binary_search(fib_index, 0);
+
     if (~0 != fib_table->ft_table_id)
     {
 	hash_unset (ip6_main.fib_index_by_table_id, fib_table->ft_table_id);
@@ -252,6 +259,492 @@ ip6_fib_table_lookup_exact_match (u32 fib_index,
     return (FIB_NODE_INDEX_INVALID);
 }
 
+/**
+ * @brief An entry in the forwarding table of a fib that uses binary search.
+ *
+ * An entry is a route, a marker or both. A marker at a prefix length
+ * directs the search towards the longer routes below it; its value in
+ * the forwarding hash is the best matching route strictly shorter than
+ * the marker, so the search has an answer if nothing longer matches.
+ */
+typedef struct ip6_fib_marker_t_
+{
+    ip6_address_t im_addr;
+    u32 im_fib_index;
+    /** the route's load-balance, if a route */
+    u32 im_lbi;
+    /** the best matching shorter route; len -1 if none */
+    u32 im_bmp_lbi;
+    i16 im_bmp_len;
+    u8 im_len;
+    u8 im_is_route;
+    /** number of longer routes whose search path passes through here */
+    u32 im_n_markers;
+} ip6_fib_marker_t;
+
+typedef struct ip6_fib_marker_db_t_
+{
+    /** pool of routes and markers of all binary search fibs */
+    ip6_fib_marker_t *entries;
+
+    /** forwarding hash key to pool index */
+    mhash_t by_key;
+
+    /** entries with markers, per-length, sorted by fib and address */
+    u32 *by_len[129];
+} ip6_fib_marker_db_t;
+
+static ip6_fib_marker_db_t ip6_fib_marker_db;
+
+static void
+ip6_fib_marker_mk_key (u64 key[3],
+                       u32 fib_index,
+                       const ip6_address_t *addr,
+                       u32 len)
+{
+    const ip6_address_t *mask = &ip6_main.fib_masks[len];
+
+    key[0] = addr->as_u64[0] & mask->as_u64[0];
+    key[1] = addr->as_u64[1] & mask->as_u64[1];
+    key[2] = ((u64)((fib_index))<<32) | len;
+}
+
+static ip6_fib_marker_t *
+ip6_fib_marker_find (u32 fib_index,
+                     const ip6_address_t *addr,
+                     u32 len)
+{
+    uword *p;
+    u64 key[3];
+
+    ip6_fib_marker_mk_key(key, fib_index, addr, len);
+    p = mhash_get(&ip6_fib_marker_db.by_key, key);
+
+    if (NULL == p)
+        return (NULL);
+
+    return (pool_elt_at_index(ip6_fib_marker_db.entries, p[0]));
+}
+
+static ip6_fib_marker_t *
+ip6_fib_marker_find_or_add (u32 fib_index,
+                            const ip6_address_t *addr,
+                            u32 len)
+{
+    ip6_fib_marker_t *im;
+    u64 key[3];
+
+    im = ip6_fib_marker_find(fib_index, addr, len);
+
+    if (NULL != im)
+        return (im);
+
+    ip6_fib_marker_mk_key(key, fib_index, addr, len);
+    pool_get_zero(ip6_fib_marker_db.entries, im);
+
+    im->im_addr.as_u64[0] = key[0];
+    im->im_addr.as_u64[1] = key[1];
+    im->im_fib_index = fib_index;
+    im->im_len = len;
+    im->im_bmp_len = -1;
+
+    mhash_set(&ip6_fib_marker_db.by_key, key,
+              im - ip6_fib_marker_db.entries, NULL);
+
+    return (im);
+}
+
+static void
+ip6_fib_marker_free (ip6_fib_marker_t *im)
+{
+    u64 key[3];
+
+    ASSERT(!im->im_is_route && !im->im_n_markers);
+
+    ip6_fib_marker_mk_key(key, im->im_fib_index, &im->im_addr, im->im_len);
+    mhash_unset(&ip6_fib_marker_db.by_key, key, NULL);
+    pool_put(ip6_fib_marker_db.entries, im);
+}
+
+/**
+ * @brief Write the entry's value into the forwarding hash
+ */
+static void
+ip6_fib_marker_install (ip6_fib_table_instance_t *table,
+                        const ip6_fib_marker_t *im)
+{
+    clib_bihash_kv_24_8_t kv;
+
+    ip6_fib_marker_mk_key(kv.key, im->im_fib_index, &im->im_addr, im->im_len);
+    kv.value = (im->im_is_route ? im->im_lbi : im->im_bmp_lbi);
+
+    clib_bihash_add_del_24_8(&table->ip6_hash, &kv, 1);
+}
+
+static void
+ip6_fib_marker_uninstall (ip6_fib_table_instance_t *table,
+                          const ip6_fib_marker_t *im)
+{
+    clib_bihash_kv_24_8_t kv;
+
+    ip6_fib_marker_mk_key(kv.key, im->im_fib_index, &im->im_addr, im->im_len);
+
+    clib_bihash_add_del_24_8(&table->ip6_hash, &kv, 0);
+}
+
+/**
+ * @brief Find the best matching route strictly shorter than the entry
+ */
+static void
+ip6_fib_marker_resolve (ip6_fib_table_instance_t *table,
+                        ip6_fib_marker_t *im)
+{
+    ip6_fib_marker_t *cover;
+    int len;
+
+    im->im_bmp_len = -1;
+    im->im_bmp_lbi = 0;
+
+    for (len = im->im_len - 1; len >= 0; len--)
+    {
+        if (0 == table->dst_address_length_refcounts[len])
+            continue;
+
+        cover = ip6_fib_marker_find(im->im_fib_index, &im->im_addr, len);
+
+        if (NULL != cover && cover->im_is_route)
+        {
+            im->im_bmp_len = len;
+            im->im_bmp_lbi = cover->im_lbi;
+            break;
+        }
+    }
+}
+
+static int
+ip6_fib_marker_cmp (const ip6_fib_marker_t *im,
+                    u32 fib_index,
+                    const ip6_address_t *addr)
+{
+    if (im->im_fib_index != fib_index)
+        return (im->im_fib_index < fib_index ? -1 : 1);
+
+    return (memcmp(&im->im_addr, addr, sizeof(*addr)));
+}
+
+static int
+ip6_fib_marker_sort (void *a1, void *a2)
+{
+    ip6_fib_marker_t *im1, *im2;
+
+    im1 = pool_elt_at_index(ip6_fib_marker_db.entries, *(u32*)a1);
+    im2 = pool_elt_at_index(ip6_fib_marker_db.entries, *(u32*)a2);
+
+    return (ip6_fib_marker_cmp(im1, im2->im_fib_index, &im2->im_addr));
+}
+
+/**
+ * @brief Position of the first marker of the length not less than the
+ * fib and address.
+ */
+static u32
+ip6_fib_marker_lower_bound (u32 len,
+                            u32 fib_index,
+                            const ip6_address_t *addr)
+{
+    u32 *markers = ip6_fib_marker_db.by_len[len];
+    u32 lo = 0, hi = vec_len(markers), mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+
+        if (ip6_fib_marker_cmp(pool_elt_at_index(ip6_fib_marker_db.entries,
+                                                 markers[mid]),
+                               fib_index, addr) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return (lo);
+}
+
+/**
+ * @brief Add the markers on the search path of a route.
+ *
+ * The path is that of a search, in the given order of prefix lengths,
+ * for an address matching only the route; every shorter length probed
+ * on the way must hit to steer the search towards the route.
+ * In bulk mode new markers are appended rather than inserted in order,
+ * the caller sorts once done.
+ */
+static void
+ip6_fib_marker_add_path (ip6_fib_table_instance_t *table,
+                         const u8 *order,
+                         u32 route_index,
+                         int bulk)
+{
+    ip6_fib_marker_t *route, *im;
+    ip6_address_t addr;
+    u32 fib_index, len;
+    int lo, hi, mid;
+
+    route = pool_elt_at_index(ip6_fib_marker_db.entries, route_index);
+    addr = route->im_addr;
+    fib_index = route->im_fib_index;
+    len = route->im_len;
+    lo = 0;
+    hi = vec_len(order) - 1;
+
+    while (lo <= hi)
+    {
+        mid = (lo + hi) / 2;
+
+        if (order[mid] == len)
+            break;
+        if (order[mid] > len)
+        {
+            lo = mid + 1;
+            continue;
+        }
+        hi = mid - 1;
+
+        im = ip6_fib_marker_find_or_add(fib_index, &addr, order[mid]);
+
+        if (0 == im->im_n_markers++)
+        {
+            u32 *markers = ip6_fib_marker_db.by_len[im->im_len];
+            u32 index = im - ip6_fib_marker_db.entries;
+
+            if (bulk)
+                vec_add1(markers, index);
+            else
+                vec_insert_elts(markers, &index, 1,
+                                ip6_fib_marker_lower_bound(im->im_len,
+                                                           fib_index,
+                                                           &im->im_addr));
+            ip6_fib_marker_db.by_len[im->im_len] = markers;
+
+            /*
+             * a route's best match is not tracked until it is also a
+             * marker, and is needed once the route is removed
+             */
+            ip6_fib_marker_resolve(table, im);
+            if (!im->im_is_route)
+                ip6_fib_marker_install(table, im);
+        }
+    }
+}
+
+static void
+ip6_fib_marker_del_path (ip6_fib_table_instance_t *table,
+                         const u8 *order,
+                         const ip6_fib_marker_t *route)
+{
+    ip6_address_t addr = route->im_addr;
+    u32 fib_index = route->im_fib_index;
+    u32 len = route->im_len;
+    ip6_fib_marker_t *im;
+    int lo, hi, mid;
+
+    lo = 0;
+    hi = vec_len(order) - 1;
+
+    while (lo <= hi)
+    {
+        mid = (lo + hi) / 2;
+
+        if (order[mid] == len)
+            break;
+        if (order[mid] > len)
+        {
+            lo = mid + 1;
+            continue;
+        }
+        hi = mid - 1;
+
+        im = ip6_fib_marker_find(fib_index, &addr, order[mid]);
+        ASSERT(im && im->im_n_markers);
+
+        if (0 == --im->im_n_markers)
+        {
+            vec_delete(ip6_fib_marker_db.by_len[im->im_len], 1,
+                       ip6_fib_marker_lower_bound(im->im_len,
+                                                  fib_index,
+                                                  &im->im_addr));
+            if (!im->im_is_route)
+            {
+                ip6_fib_marker_uninstall(table, im);
+                ip6_fib_marker_free(im);
+            }
+        }
+    }
+}
+
+/**
+ * @brief A route has been added or removed; update the markers below it
+ * that now have a different best matching route.
+ */
+static void
+ip6_fib_marker_update_covered (ip6_fib_table_instance_t *table,
+                               const ip6_fib_marker_t *route)
+{
+    const ip6_address_t *mask = &ip6_main.fib_masks[route->im_len];
+    ip6_fib_marker_t *im;
+    u32 len, i;
+
+    for (len = route->im_len + 1; len <= 128; len++)
+    {
+        i = ip6_fib_marker_lower_bound(len, route->im_fib_index,
+                                       &route->im_addr);
+
+        for (; i < vec_len(ip6_fib_marker_db.by_len[len]); i++)
+        {
+            im = pool_elt_at_index(ip6_fib_marker_db.entries,
+                                   ip6_fib_marker_db.by_len[len][i]);
+
+            if (im->im_fib_index != route->im_fib_index ||
+                ((im->im_addr.as_u64[0] & mask->as_u64[0]) !=
+                 route->im_addr.as_u64[0]) ||
+                ((im->im_addr.as_u64[1] & mask->as_u64[1]) !=
+                 route->im_addr.as_u64[1]))
+                break;
+
+            if (route->im_is_route)
+            {
+                if (im->im_bmp_len > route->im_len)
+                    continue;
+                im->im_bmp_len = route->im_len;
+                im->im_bmp_lbi = route->im_lbi;
+            }
+            else
+            {
+                if (im->im_bmp_len != route->im_len)
+                    continue;
+                ip6_fib_marker_resolve(table, im);
+            }
+
+            if (!im->im_is_route)
+                ip6_fib_marker_install(table, im);
+        }
+    }
+}
+
+/**
+ * @brief Re-add the markers of all routes for a new order of the prefix
+ * lengths. The markers of the current order stay in place so the search
+ * in progress by the workers is unaffected; those no longer needed are
+ * removed, by ip6_fib_marker_flush, once the new order is in use.
+ */
+static void
+ip6_fib_marker_rebuild (ip6_fib_table_instance_t *table,
+                        const u8 *order)
+{
+    ip6_fib_marker_t *im;
+    u32 *routes = NULL, *ri;
+    int len;
+
+    pool_foreach (im, ip6_fib_marker_db.entries)
+    {
+        im->im_n_markers = 0;
+        if (im->im_is_route)
+            vec_add1(routes, im - ip6_fib_marker_db.entries);
+    }
+    for (len = 0; len <= 128; len++)
+        vec_reset_length(ip6_fib_marker_db.by_len[len]);
+
+    vec_foreach(ri, routes)
+        ip6_fib_marker_add_path(table, order, *ri, 1);
+
+    for (len = 0; len <= 128; len++)
+        vec_sort_with_function(ip6_fib_marker_db.by_len[len],
+                               ip6_fib_marker_sort);
+    vec_free(routes);
+}
+
+/**
+ * @brief Remove the entries of a fib, or all entries with index ~0, that
+ * are neither routes nor markers.
+ */
+static void
+ip6_fib_marker_flush (ip6_fib_table_instance_t *table,
+                      u32 fib_index)
+{
+    ip6_fib_marker_t *im;
+    u32 *stale = NULL, *si;
+
+    pool_foreach (im, ip6_fib_marker_db.entries)
+    {
+        if (~0 != fib_index && im->im_fib_index != fib_index)
+            continue;
+        if (!im->im_is_route && !im->im_n_markers)
+            vec_add1(stale, im - ip6_fib_marker_db.entries);
+    }
+
+    vec_foreach(si, stale)
+    {
+        im = pool_elt_at_index(ip6_fib_marker_db.entries, *si);
+        ip6_fib_marker_uninstall(table, im);
+        ip6_fib_marker_free(im);
+    }
+    vec_free(stale);
+}
+
+/**
+ * @brief Add, or update, a route. Returns non-zero if it existed.
+ */
+static int
+ip6_fib_marker_route_add (ip6_fib_table_instance_t *table,
+                          u32 fib_index,
+                          const ip6_address_t *addr,
+                          u32 len,
+                          u32 lbi)
+{
+    ip6_fib_marker_t *im;
+    int was_route;
+
+    im = ip6_fib_marker_find_or_add(fib_index, addr, len);
+    was_route = im->im_is_route;
+    if (!was_route)
+        ip6_fib_marker_resolve(table, im);
+    im->im_is_route = 1;
+    im->im_lbi = lbi;
+
+    ip6_fib_marker_update_covered(table, im);
+
+    return (was_route);
+}
+
+static void
+ip6_fib_marker_route_del (ip6_fib_table_instance_t *table,
+                          u32 fib_index,
+                          const ip6_address_t *addr,
+                          u32 len)
+{
+    ip6_fib_marker_t *im;
+
+    im = ip6_fib_marker_find(fib_index, addr, len);
+
+    if (NULL == im)
+        return;
+
+    /*
+     * a marker reverts to the best match of the shorter routes
+     */
+    im->im_is_route = 0;
+    ip6_fib_marker_resolve(table, im);
+    if (im->im_n_markers)
+        ip6_fib_marker_install(table, im);
+    else
+        ip6_fib_marker_uninstall(table, im);
+
+    ip6_fib_marker_update_covered(table, im);
+    ip6_fib_marker_del_path(table, table->prefix_lengths_in_search_order, im);
+
+    if (!im->im_n_markers)
+        ip6_fib_marker_free(im);
+}
+
 static void
 compute_prefix_lengths_in_search_order (ip6_fib_table_instance_t *table)
 {
@@ -271,6 +764,12 @@ compute_prefix_lengths_in_search_order (ip6_fib_table_instance_t *table)
 	vec_add1(prefix_lengths_in_search_order, dst_address_length);
     }
 
+    /*
+     * the markers of the binary search fibs depend on the order
+     */
+    if (!clib_bitmap_is_zero(table->binary_search_fib_bitmap))
+        ip6_fib_marker_rebuild(table, prefix_lengths_in_search_order);
+
     table->prefix_lengths_in_search_order = prefix_lengths_in_search_order;
 
     /*
@@ -278,6 +777,9 @@ compute_prefix_lengths_in_search_order (ip6_fib_table_instance_t *table)
      */
     vlib_worker_wait_one_loop();
     vec_free(old);
+
+    if (!clib_bitmap_is_zero(table->binary_search_fib_bitmap))
+        ip6_fib_marker_flush(table, ~0);
 }
 
 void
@@ -373,6 +875,7 @@ ip6_fib_table_fwding_dpo_update (u32 fib_index,
     ip6_fib_table_instance_t *table;
     clib_bihash_kv_24_8_t kv;
     ip6_address_t *mask;
+    int was_route = 0;
     u64 fib;
 
     table = &ip6_fib_table[IP6_FIB_TABLE_FWDING];
@@ -386,6 +889,10 @@ ip6_fib_table_fwding_dpo_update (u32 fib_index,
 
     clib_bihash_add_del_24_8(&table->ip6_hash, &kv, 1);
 
+    if (clib_bitmap_get(table->binary_search_fib_bitmap, fib_index))
+        was_route = ip6_fib_marker_route_add(table, fib_index, addr, len,
+                                             dpo->dpoi_index);
+
     if (0 == table->dst_address_length_refcounts[len]++)
     {
         table->non_empty_dst_address_length_bitmap =
@@ -393,6 +900,15 @@ ip6_fib_table_fwding_dpo_update (u32 fib_index,
                              128 - len, 1);
         compute_prefix_lengths_in_search_order (table);
     }
+    else if (clib_bitmap_get(table->binary_search_fib_bitmap, fib_index) &&
+             !was_route)
+    {
+        ip6_fib_marker_t *im;
+
+        im = ip6_fib_marker_find(fib_index, addr, len);
+        ip6_fib_marker_add_path(table, table->prefix_lengths_in_search_order,
+                                im - ip6_fib_marker_db.entries, 0);
+    }
 }
 
 void
@@ -415,7 +931,10 @@ ip6_fib_table_fwding_dpo_remove (u32 fib_index,
     kv.key[2] = fib | len;
     kv.value = dpo->dpoi_index;
 
-    clib_bihash_add_del_24_8(&table->ip6_hash, &kv, 0);
+    if (clib_bitmap_get(table->binary_search_fib_bitmap, fib_index))
+        ip6_fib_marker_route_del(table, fib_index, addr, len);
+    else
+        clib_bihash_add_del_24_8(&table->ip6_hash, &kv, 0);
 
     /* refcount accounting */
     ASSERT (table->dst_address_length_refcounts[len] > 0);
@@ -428,6 +947,123 @@ ip6_fib_table_fwding_dpo_remove (u32 fib_index,
     }
 }
 
+typedef struct ip6_fib_marker_collect_ctx_t_
+{
+    u32 fib_index;
+    clib_bihash_kv_24_8_t *routes;
+} ip6_fib_marker_collect_ctx_t;
+
+static int
+ip6_fib_marker_collect_routes (clib_bihash_kv_24_8_t * kvp,
+                               void *arg)
+{
+    ip6_fib_marker_collect_ctx_t *ctx = arg;
+
+    if ((kvp->key[2]>>32) == ctx->fib_index)
+        vec_add1(ctx->routes, *kvp);
+
+    return (BIHASH_WALK_CONTINUE);
+}
+
+void
+ip6_fib_table_set_binary_search (u32 fib_index,
+                                 int enable)
+{
+    ip6_fib_marker_collect_ctx_t ctx = {
+        .fib_index = fib_index,
+    };
+    ip6_fib_table_instance_t *table;
+    clib_bihash_kv_24_8_t *kvp;
+    ip6_fib_marker_t *im;
+    u32 *indices = NULL, *ii;
+    int len;
+
+    table = &ip6_fib_table[IP6_FIB_TABLE_FWDING];
+
+    if (!enable == !clib_bitmap_get(table->binary_search_fib_bitmap,
+                                    fib_index))
+        return;
+
+    if (enable)
+    {
+        clib_bihash_foreach_key_value_pair_24_8(&table->ip6_hash,
+                                                ip6_fib_marker_collect_routes,
+                                                &ctx);
+        vec_foreach(kvp, ctx.routes)
+        {
+            ip6_address_t addr;
+
+            addr.as_u64[0] = kvp->key[0];
+            addr.as_u64[1] = kvp->key[1];
+            ip6_fib_marker_route_add(table, fib_index, &addr,
+                                     kvp->key[2] & 0xff, kvp->value);
+        }
+
+        /*
+         * add the markers before the workers start to search for them
+         */
+        pool_foreach (im, ip6_fib_marker_db.entries)
+        {
+            if (im->im_fib_index == fib_index)
+                vec_add1(indices, im - ip6_fib_marker_db.entries);
+        }
+        vec_foreach(ii, indices)
+            ip6_fib_marker_add_path(table,
+                                    table->prefix_lengths_in_search_order,
+                                    *ii, 1);
+        for (len = 0; len <= 128; len++)
+            vec_sort_with_function(ip6_fib_marker_db.by_len[len],
+                                   ip6_fib_marker_sort);
+
+        vlib_worker_thread_barrier_sync(vlib_get_main());
+        table->binary_search_fib_bitmap =
+            clib_bitmap_set(table->binary_search_fib_bitmap, fib_index, 1);
+        vlib_worker_thread_barrier_release(vlib_get_main());
+    }
+    else
+    {
+        vlib_worker_thread_barrier_sync(vlib_get_main());
+        table->binary_search_fib_bitmap =
+            clib_bitmap_set(table->binary_search_fib_bitmap, fib_index, 0);
+        vlib_worker_thread_barrier_release(vlib_get_main());
+
+        /*
+         * the routes stay in the hash, the markers go
+         */
+        for (len = 0; len <= 128; len++)
+        {
+            u32 *markers = NULL, *mi;
+
+            vec_foreach(mi, ip6_fib_marker_db.by_len[len])
+            {
+                im = pool_elt_at_index(ip6_fib_marker_db.entries, *mi);
+                if (im->im_fib_index != fib_index)
+                    vec_add1(markers, *mi);
+            }
+            vec_free(ip6_fib_marker_db.by_len[len]);
+            ip6_fib_marker_db.by_len[len] = markers;
+        }
+        pool_foreach (im, ip6_fib_marker_db.entries)
+        {
+            if (im->im_fib_index != fib_index)
+                continue;
+            if (!im->im_is_route)
+                ip6_fib_marker_uninstall(table, im);
+            vec_add1(indices, im - ip6_fib_marker_db.entries);
+        }
+        vec_foreach(ii, indices)
+        {
+            im = pool_elt_at_index(ip6_fib_marker_db.entries, *ii);
+            im->im_is_route = 0;
+            im->im_n_markers = 0;
+            ip6_fib_marker_free(im);
+        }
+    }
+
+    vec_free(indices);
+    vec_free(ctx.routes);
+}
+
 /**
  * @brief Context when walking the IPv6 table. Since all VRFs are in the
  * same hash table, we need to filter only those we need as we walk
@@ -870,6 +1506,56 @@ VLIB_CLI_COMMAND (ip6_show_fib_command, static) = {
 };
 /* *INDENT-ON* */
 
+static clib_error_t *
+ip6_fib_lookup_command_fn (vlib_main_t * vm,
+                           unformat_input_t * input,
+                           vlib_cli_command_t * cmd)
+{
+    u32 table_id = 0, fib_index;
+    int enable = -1;
+
+    while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+        if (unformat (input, "table %d", &table_id))
+            ;
+        else if (unformat (input, "binary-search"))
+            enable = 1;
+        else if (unformat (input, "linear"))
+            enable = 0;
+        else
+            return (clib_error_return (0, "unknown input '%U'",
+                                       format_unformat_error, input));
+    }
+
+    if (-1 == enable)
+        return (clib_error_return (0, "specify linear or binary-search"));
+
+    fib_index = fib_table_find (FIB_PROTOCOL_IP6, table_id);
+
+    if (~0 == fib_index)
+        return (clib_error_return (0, "no such table %d", table_id));
+
+    ip6_fib_table_set_binary_search (fib_index, enable);
+
+    return (NULL);
+}
+
+/*?
+ * This command selects how forwarding lookups search the prefix lengths
+ * in use in an IPv6 table. A linear search probes every length, longest
+ * first, until a match; a binary search probes about log2 of them, at the
+ * cost of extra marker entries in the forwarding hash. The default for new
+ * tables is set by 'ip6 { fib-lookup binary-search }' in the startup config.
+ *
+ * @cliexpar
+ * @cliexcmd{set ip6 fib-lookup table 0 binary-search}
+ ?*/
+VLIB_CLI_COMMAND (ip6_fib_lookup_command, static) = {
+    .path = "set ip6 fib-lookup",
+    .short_help = "set ip6 fib-lookup [table <table-id>] <linear|binary-search>",
+    .function = ip6_fib_lookup_command_fn,
+};
+
 static clib_error_t *
 ip6_config (vlib_main_t * vm, unformat_input_t * input)
 {
@@ -883,6 +1569,10 @@ ip6_config (vlib_main_t * vm, unformat_input_t * input)
       else if (unformat (input, "heap-size %U",
 			 unformat_memory_size, &heapsize))
 	;
+      else if (unformat (input, "fib-lookup binary-search"))
+	ip6_fib_table_binary_search = 1;
+      else if (unformat (input, "fib-lookup linear"))
+	ip6_fib_table_binary_search = 0;
       else
 	return clib_error_return (0, "unknown input '%U'",
 				  format_unformat_error, input);
@@ -913,6 +1603,7 @@ ip6_fib_init (vlib_main_t * vm)
     clib_bihash_init_24_8 (&ip6_fib_table[IP6_FIB_TABLE_NON_FWDING].ip6_hash,
                            "ip6 FIB non-fwding table",
                            ip6_fib_table_nbuckets, ip6_fib_table_size);
+    mhash_init (&ip6_fib_marker_db.by_key, sizeof(uword), 3 * sizeof(u64));
 
     return (NULL);
 }
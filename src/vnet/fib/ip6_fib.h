@@ -64,6 +64,9 @@ typedef struct ip6_fib_table_instance_t_
   uword *non_empty_dst_address_length_bitmap;
   u8 *prefix_lengths_in_search_order;
   i32 dst_address_length_refcounts[129];
+
+  /* fibs whose lookups binary search the mask widths (FWDING only) */
+  uword *binary_search_fib_bitmap;
 } ip6_fib_table_instance_t;
 
 /**
@@ -111,6 +114,65 @@ extern void ip6_fib_table_walk(u32 fib_index,
                                fib_table_walk_fn_t fn,
                                void *ctx);
 
+/**
+ * @brief Fill the forwarding hash key for the address masked to a length
+ */
+always_inline void
+ip6_fib_table_fwding_key (clib_bihash_kv_24_8_t *kv,
+                          u32 fib_index,
+                          const ip6_address_t *dst,
+                          int dst_address_length)
+{
+    const ip6_address_t *mask = &ip6_main.fib_masks[dst_address_length];
+
+    ASSERT(dst_address_length >= 0 && dst_address_length <= 128);
+    kv->key[0] = dst->as_u64[0] & mask->as_u64[0];
+    kv->key[1] = dst->as_u64[1] & mask->as_u64[1];
+    kv->key[2] = ((u64)((fib_index))<<32) | dst_address_length;
+}
+
+/**
+ * @brief Binary search on the mask widths.
+ *
+ * A hit at a width means the best match is that long or longer, a miss
+ * that it is shorter. Each route leaves a marker at the shorter widths
+ * visited on the way to its own, whose value is the marker's best
+ * matching route, so a hit on a marker is never a dead end. The search
+ * costs log2 of the number of widths in use, plus one, hash probes.
+ */
+always_inline u32
+ip6_fib_table_fwding_lookup_binary (ip6_fib_table_instance_t *table,
+                                    u32 fib_index,
+                                    const ip6_address_t * dst)
+{
+    u8 *widths = table->prefix_lengths_in_search_order;
+    clib_bihash_kv_24_8_t kv, value;
+    int lo, hi, mid;
+    u32 lbi = 0;
+
+    lo = 0;
+    hi = vec_len (widths) - 1;
+
+    while (lo <= hi)
+    {
+        mid = (lo + hi) / 2;
+        ip6_fib_table_fwding_key (&kv, fib_index, dst, widths[mid]);
+
+        if (0 == clib_bihash_search_inline_2_24_8(&table->ip6_hash, &kv, &value))
+        {
+            /* widths are decreasing, longer ones are to the left */
+            lbi = value.value;
+            hi = mid - 1;
+        }
+        else
+            lo = mid + 1;
+    }
+
+    /* default route is always present */
+    ASSERT(lbi);
+    return (lbi);
+}
+
 always_inline u32
 ip6_fib_table_fwding_lookup (u32 fib_index,
                              const ip6_address_t * dst)
@@ -122,6 +184,10 @@ ip6_fib_table_fwding_lookup (u32 fib_index,
     u64 fib;
 
     table = &ip6_fib_table[IP6_FIB_TABLE_FWDING];
+
+    if (clib_bitmap_get (table->binary_search_fib_bitmap, fib_index))
+        return (ip6_fib_table_fwding_lookup_binary (table, fib_index, dst));
+
     len = vec_len (table->prefix_lengths_in_search_order);
 
     kv.key[0] = dst->as_u64[0];
@@ -149,6 +215,88 @@ ip6_fib_table_fwding_lookup (u32 fib_index,
     return 0;
 }
 
+/**
+ * @brief Forwarding lookup of four addresses.
+ *
+ * The lookups proceed in lock-step, one hash probe per address per round,
+ * so the bucket fetches of the four overlap. Each address is searched
+ * in the manner of its own table: linearly, longest width first, or by
+ * binary search.
+ */
+static_always_inline void
+ip6_fib_table_fwding_lookup_x4 (u32 fib_index0,
+                                u32 fib_index1,
+                                u32 fib_index2,
+                                u32 fib_index3,
+                                const ip6_address_t * addr0,
+                                const ip6_address_t * addr1,
+                                const ip6_address_t * addr2,
+                                const ip6_address_t * addr3,
+                                index_t *lb0,
+                                index_t *lb1,
+                                index_t *lb2,
+                                index_t *lb3)
+{
+    const ip6_address_t *addr[4] = { addr0, addr1, addr2, addr3 };
+    u32 fib_index[4] = { fib_index0, fib_index1, fib_index2, fib_index3 };
+    clib_bihash_kv_24_8_t kv[4], value;
+    ip6_fib_table_instance_t *table;
+    int lo[4], hi[4], mid[4], i;
+    u32 lbi[4] = { 0 };
+    u8 binary[4];
+    u64 hash[4];
+    u8 *widths;
+
+    table = &ip6_fib_table[IP6_FIB_TABLE_FWDING];
+    widths = table->prefix_lengths_in_search_order;
+
+    for (i = 0; i < 4; i++)
+    {
+        lo[i] = 0;
+        hi[i] = vec_len (widths) - 1;
+        binary[i] = clib_bitmap_get (table->binary_search_fib_bitmap,
+                                     fib_index[i]);
+    }
+
+    while (lo[0] <= hi[0] || lo[1] <= hi[1] ||
+           lo[2] <= hi[2] || lo[3] <= hi[3])
+    {
+        for (i = 0; i < 4; i++)
+        {
+            if (lo[i] > hi[i])
+                continue;
+
+            mid[i] = binary[i] ? (lo[i] + hi[i]) / 2 : lo[i];
+            ip6_fib_table_fwding_key (&kv[i], fib_index[i], addr[i],
+                                      widths[mid[i]]);
+            hash[i] = clib_bihash_hash_24_8 (&kv[i]);
+            clib_bihash_prefetch_bucket_24_8 (&table->ip6_hash, hash[i]);
+        }
+
+        for (i = 0; i < 4; i++)
+        {
+            if (lo[i] > hi[i])
+                continue;
+
+            if (0 == clib_bihash_search_inline_2_with_hash_24_8 (
+                    &table->ip6_hash, hash[i], &kv[i], &value))
+            {
+                lbi[i] = value.value;
+                /* a linear search stops at the first, i.e. longest, hit */
+                hi[i] = binary[i] ? mid[i] - 1 : -1;
+            }
+            else
+                lo[i] = mid[i] + 1;
+        }
+    }
+
+    ASSERT(lbi[0] && lbi[1] && lbi[2] && lbi[3]);
+    *lb0 = lbi[0];
+    *lb1 = lbi[1];
+    *lb2 = lbi[2];
+    *lb3 = lbi[3];
+}
+
 /**
  * @brief Walk all entries in a sub-tree of the FIB table
  * N.B: This is NOT safe to deletes. If you need to delete walk the whole
@@ -209,6 +357,12 @@ extern u32 ip6_fib_table_create_and_lock(fib_source_t src,
 
 extern u8 *format_ip6_fib_table_memory(u8 * s, va_list * args);
 
+/**
+ * @brief Select binary search on the prefix lengths, rather than a linear
+ * walk, for forwarding lookups in the table.
+ */
+extern void ip6_fib_table_set_binary_search(u32 fib_index, int enable);
+
 static inline ip6_fib_t *
 ip6_fib_get (fib_node_index_t index)
 {
@@ -19,6 +19,7 @@
 #include <vnet/ethernet/ethernet.h>
 #include <vnet/feature/feature.h>
 #include <vnet/gso/gso.h>
+#include <vnet/gso/gro.h>
 
 static clib_error_t *
 set_interface_feature_gso_command_fn (vlib_main_t * vm,
@@ -84,6 +85,97 @@ VLIB_CLI_COMMAND (set_interface_feature_gso_command, static) = {
 };
 /* *INDENT-ON* */
 
+static clib_error_t *
+set_interface_feature_gro_command_fn (vlib_main_t *vm,
+				      unformat_input_t *input,
+				      vlib_cli_command_t *cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  unformat_input_t _line_input, *line_input = &_line_input;
+  clib_error_t *error = 0;
+
+  u32 sw_if_index = ~0;
+  u8 enable = 0;
+
+  /* Get a line of input. */
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "enable"))
+	enable = 1;
+      else if (unformat (line_input, "disable"))
+	enable = 0;
+      else
+	{
+	  error = unformat_parse_error (line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0)
+    {
+      error = clib_error_return (0, "Interface not specified...");
+      goto done;
+    }
+  int rv = vnet_sw_interface_gro_enable_disable (sw_if_index, enable);
+
+  switch (rv)
+    {
+    case VNET_API_ERROR_INVALID_VALUE:
+      error = clib_error_return (0, "interface type is not hardware");
+      break;
+    case 0:
+      break;
+    default:
+      error = clib_error_return (0, "failed, error %d", rv);
+    }
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+VLIB_CLI_COMMAND (set_interface_feature_gro_command, static) = {
+  .path = "set interface feature gro",
+  .short_help = "set interface feature gro <intfc> [enable | disable]",
+  .function = set_interface_feature_gro_command_fn,
+};
+
+static clib_error_t *
+show_gro_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  gro_main_t *gm = &gro_main;
+  gro_per_thread_data_t *ptd;
+
+  if (vec_len (gm->per_thread_data) == 0)
+    {
+      vlib_cli_output (vm, "gro is not enabled on any interface");
+      return 0;
+    }
+
+  vec_foreach (ptd, gm->per_thread_data)
+    {
+      u32 thread_index = ptd - gm->per_thread_data;
+      vlib_cli_output (vm, "Thread %u (%v):\n  %U", thread_index,
+		       vlib_worker_threads[thread_index].name,
+		       format_gro_per_thread_data, ptd);
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_gro_command, static) = {
+  .path = "show gro",
+  .short_help = "show gro",
+  .function = show_gro_command_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
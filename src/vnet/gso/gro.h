@@ -19,6 +19,8 @@
 #include <vlib/vlib.h>
 #include <vppinfra/error.h>
 #include <vnet/ip/ip46_address.h>
+#include <vppinfra/crc32.h>
+#include <vppinfra/xxhash.h>
 
 #define GRO_FLOW_TABLE_MAX_SIZE 16
 #define GRO_FLOW_TABLE_FLUSH 1e-5
@@ -37,8 +39,11 @@ typedef union
     u16 dst_port;
   };
 
-  u64 flow_data[5];
-  u32 flow_data_u32;
+  struct
+  {
+    u64 flow_data[5];
+    u32 flow_data_u32;
+  };
 } gro_flow_key_t;
 
 typedef struct
@@ -62,6 +67,69 @@ typedef struct
   gro_flow_t gro_flow[GRO_FLOW_TABLE_MAX_SIZE];
 } gro_flow_table_t;
 
+/*
+ * Hashed per-thread flow table used by the gro-input feature node
+ */
+#define GRO_HASH_TABLE_MIN_LOG2	     4
+#define GRO_HASH_TABLE_MAX_LOG2	     12
+#define GRO_HASH_TABLE_DEFAULT_LOG2  8
+#define GRO_HASH_RESIZE_INTERVAL     4096
+#define GRO_HASH_FLOW_TIMEOUT_MIN    2e-6
+#define GRO_HASH_FLOW_TIMEOUT_MAX    1e-4
+#define GRO_HASH_FLUSH_ALL_THRESHOLD (VLIB_FRAME_SIZE / 4)
+
+typedef struct
+{
+  gro_flow_t flow;
+  u32 next_node_index;
+  u16 next_index;
+  u16 active_index;
+} gro_hash_flow_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /* direct mapped flow table, 1 << log2_n_flows entries */
+  gro_hash_flow_t *flows;
+  /* indices of flows holding packets */
+  u16 *active;
+  /* packets to be sent to the next nodes */
+  u32 *to;
+  u16 *nexts;
+  u8 log2_n_flows;
+
+  /* adaptive flush timeout */
+  f64 last_input_time;
+  f64 avg_input_gap;
+  f64 flow_timeout;
+
+  /* resize window */
+  u32 window_lookups;
+  u32 window_collisions;
+  u32 window_peak_active;
+
+  /* counters */
+  u64 n_packets_in;
+  u64 n_packets_out;
+  u64 n_merged;
+  u64 n_collisions;
+  u64 n_timeout_flushes;
+  u32 n_resizes;
+} gro_per_thread_data_t;
+
+typedef struct
+{
+  gro_per_thread_data_t *per_thread_data;
+  uword *enabled_by_sw_if_index;
+  u32 n_enabled;
+} gro_main_t;
+
+extern gro_main_t gro_main;
+extern vlib_node_registration_t gro_flush_node;
+
+int vnet_sw_interface_gro_enable_disable (u32 sw_if_index, u8 enable);
+format_function_t format_gro_per_thread_data;
+
 static_always_inline void
 gro_flow_set_flow_key (gro_flow_t * to, gro_flow_key_t * from)
 {
@@ -87,6 +155,24 @@ gro_flow_is_equal (gro_flow_key_t * first, gro_flow_key_t * second)
   return 0;
 }
 
+static_always_inline u32
+gro_flow_key_hash (gro_flow_key_t *key)
+{
+#ifdef clib_crc32c_uses_intrinsics
+  u32 h = 0;
+  h = clib_crc32c_u64 (h, key->flow_data[0]);
+  h = clib_crc32c_u64 (h, key->flow_data[1]);
+  h = clib_crc32c_u64 (h, key->flow_data[2]);
+  h = clib_crc32c_u64 (h, key->flow_data[3]);
+  h = clib_crc32c_u64 (h, key->flow_data[4]);
+  return clib_crc32c_u32 (h, key->flow_data_u32);
+#else
+  u64 tmp = key->flow_data[0] ^ key->flow_data[1] ^ key->flow_data[2] ^
+	    key->flow_data[3] ^ key->flow_data[4] ^ key->flow_data_u32;
+  return clib_xxhash (tmp);
+#endif
+}
+
 /**
  * timeout_expire is in between 3 to 10 microseconds
  * 3e-6 1e-5
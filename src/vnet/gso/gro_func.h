@@ -155,6 +155,9 @@ gro_validate_checksum (vlib_main_t * vm, vlib_buffer_t * b0,
 
   if (b0->flags & VNET_BUFFER_F_OFFLOAD)
     return VNET_BUFFER_F_L4_CHECKSUM_CORRECT;
+  /* already verified by the device */
+  if (b0->flags & VNET_BUFFER_F_L4_CHECKSUM_CORRECT)
+    return VNET_BUFFER_F_L4_CHECKSUM_CORRECT;
   vlib_buffer_advance (b0, gho0->l3_hdr_offset);
   if (is_ip4)
     flags = ip4_tcp_udp_validate_checksum (vm, b0);
@@ -0,0 +1,557 @@
+/*
+ * Copyright (c) 2024 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/vnet.h>
+#include <vnet/feature/feature.h>
+#include <vnet/gso/gro_func.h>
+
+gro_main_t gro_main;
+
+typedef struct
+{
+  u32 sw_if_index;
+  u32 n_flows;
+  u32 n_active;
+} gro_input_trace_t;
+
+static u8 *
+format_gro_input_trace (u8 *s, va_list *args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  gro_input_trace_t *t = va_arg (*args, gro_input_trace_t *);
+
+  s = format (s, "gro-input: sw_if_index %u flow-table size %u active %u",
+	      t->sw_if_index, t->n_flows, t->n_active);
+  return s;
+}
+
+static_always_inline void
+gro_input_enqueue (gro_per_thread_data_t *ptd, u32 bi, u16 next)
+{
+  vec_add1 (ptd->to, bi);
+  vec_add1 (ptd->nexts, next);
+}
+
+static_always_inline gro_hash_flow_t *
+gro_hash_flow_get (gro_per_thread_data_t *ptd, gro_flow_key_t *key)
+{
+  u32 index = gro_flow_key_hash (key) & pow2_mask (ptd->log2_n_flows);
+  return vec_elt_at_index (ptd->flows, index);
+}
+
+static_always_inline void
+gro_hash_flow_store (vlib_main_t *vm, vlib_node_runtime_t *node,
+		     gro_per_thread_data_t *ptd, gro_hash_flow_t *f,
+		     gro_flow_key_t *key, u32 bi0, u32 ack_number, u16 next0,
+		     f64 now)
+{
+  gro_flow_set_flow_key (&f->flow, key);
+  f->flow.buffer_index = bi0;
+  f->flow.n_buffers = 1;
+  f->flow.last_ack_number = ack_number;
+  f->flow.next_timeout_ts = now + ptd->flow_timeout;
+  f->next_index = next0;
+  f->next_node_index = vlib_get_next_node (vm, node->node_index, next0)->index;
+  f->active_index = vec_len (ptd->active);
+  vec_add1 (ptd->active, f - ptd->flows);
+  ptd->window_peak_active =
+    clib_max (ptd->window_peak_active, vec_len (ptd->active));
+}
+
+/**
+ * Release the packets stored by a flow, returning the buffer index of the
+ * (possibly coalesced) head packet.
+ */
+static_always_inline u32
+gro_hash_flow_flush (vlib_main_t *vm, gro_per_thread_data_t *ptd,
+		     gro_hash_flow_t *f)
+{
+  u32 bi = f->flow.buffer_index;
+  u16 last;
+
+  if (f->flow.n_buffers > 1)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, bi);
+      gro_fixup_header (vm, b, f->flow.last_ack_number, 1 /* is_l2 */);
+      /* the packet goes up the rx path, where ip4-input validates the
+       * header checksum */
+      if (b->flags & VNET_BUFFER_F_IS_IP4)
+	{
+	  ip4_header_t *ip4 =
+	    (ip4_header_t *) (b->data + vnet_buffer (b)->l3_hdr_offset);
+	  ip4->checksum = ip4_header_checksum (ip4);
+	}
+    }
+
+  last = vec_pop (ptd->active);
+  if (last != f - ptd->flows)
+    {
+      ptd->active[f->active_index] = last;
+      ptd->flows[last].active_index = f->active_index;
+    }
+  f->flow.n_buffers = 0;
+  return bi;
+}
+
+static_always_inline void
+gro_input_flush_all (vlib_main_t *vm, gro_per_thread_data_t *ptd)
+{
+  while (vec_len (ptd->active))
+    {
+      gro_hash_flow_t *f = ptd->flows + ptd->active[vec_len (ptd->active) - 1];
+      u16 next = f->next_index;
+      gro_input_enqueue (ptd, gro_hash_flow_flush (vm, ptd, f), next);
+    }
+}
+
+static_always_inline void
+gro_input_flush_expired (vlib_main_t *vm, gro_per_thread_data_t *ptd,
+			 f64 now)
+{
+  int i;
+
+  /* flushing moves the last active flow into the flushed slot, which has
+   * already been visited when walking backwards */
+  for (i = vec_len (ptd->active) - 1; i >= 0; i--)
+    {
+      gro_hash_flow_t *f = ptd->flows + ptd->active[i];
+      if (f->flow.next_timeout_ts <= now)
+	{
+	  u16 next = f->next_index;
+	  gro_input_enqueue (ptd, gro_hash_flow_flush (vm, ptd, f), next);
+	  ptd->n_timeout_flushes++;
+	}
+    }
+}
+
+static void
+gro_per_thread_data_alloc_flows (gro_per_thread_data_t *ptd, u8 log2_n_flows)
+{
+  ASSERT (vec_len (ptd->active) == 0);
+  vec_free (ptd->flows);
+  vec_validate_aligned (ptd->flows, pow2_mask (log2_n_flows),
+			CLIB_CACHE_LINE_BYTES);
+  ptd->log2_n_flows = log2_n_flows;
+}
+
+/**
+ * Grow the table when too many lookups hit a slot held by another flow,
+ * shrink it when only a small fraction of it has been in use.
+ */
+static_always_inline void
+gro_input_maybe_resize (vlib_main_t *vm, gro_per_thread_data_t *ptd)
+{
+  u8 log2_n_flows = ptd->log2_n_flows;
+
+  if (ptd->window_lookups < GRO_HASH_RESIZE_INTERVAL)
+    return;
+
+  if (ptd->window_collisions * 8 > ptd->window_lookups &&
+      log2_n_flows < GRO_HASH_TABLE_MAX_LOG2)
+    log2_n_flows++;
+  else if (ptd->window_peak_active * 16 < (1 << log2_n_flows) &&
+	   log2_n_flows > GRO_HASH_TABLE_MIN_LOG2)
+    log2_n_flows--;
+
+  ptd->window_lookups = 0;
+  ptd->window_collisions = 0;
+  ptd->window_peak_active = vec_len (ptd->active);
+
+  if (log2_n_flows == ptd->log2_n_flows)
+    return;
+
+  gro_input_flush_all (vm, ptd);
+  gro_per_thread_data_alloc_flows (ptd, log2_n_flows);
+  ptd->window_peak_active = 0;
+  ptd->n_resizes++;
+}
+
+/**
+ * Flows are held for roughly two input intervals, so that segments of a
+ * burst spread over consecutive frames can still be coalesced.
+ */
+static_always_inline void
+gro_input_update_timeout (gro_per_thread_data_t *ptd, f64 now)
+{
+  if (ptd->last_input_time != 0)
+    ptd->avg_input_gap +=
+      ((now - ptd->last_input_time) - ptd->avg_input_gap) / 8;
+  ptd->last_input_time = now;
+  ptd->flow_timeout = clib_min (
+    clib_max (2 * ptd->avg_input_gap, GRO_HASH_FLOW_TIMEOUT_MIN),
+    GRO_HASH_FLOW_TIMEOUT_MAX);
+}
+
+/**
+ * Packets which are not coalesced must not overtake the stored packets
+ * of their flow.
+ */
+static_always_inline void
+gro_input_flush_bypassed_flow (vlib_main_t *vm, gro_per_thread_data_t *ptd,
+			       vlib_buffer_t *b0,
+			       generic_header_offset_t *gho0)
+{
+  u32 sw_if_index0[VLIB_N_RX_TX] = { 0 };
+  gro_flow_key_t flow_key0 = {};
+  gro_hash_flow_t *f;
+  tcp_header_t *tcp0;
+  u8 *data0;
+
+  if (vec_len (ptd->active) == 0 || (gho0->gho_flags & GHO_F_TCP) == 0)
+    return;
+
+  data0 = vlib_buffer_get_current (b0);
+  tcp0 = (tcp_header_t *) (data0 + gho0->l4_hdr_offset);
+  sw_if_index0[VLIB_RX] = vnet_buffer (b0)->sw_if_index[VLIB_RX];
+  sw_if_index0[VLIB_TX] = ~0;
+
+  if (gho0->gho_flags & GHO_F_IP4)
+    gro_get_ip4_flow_from_packet (
+      sw_if_index0, (ip4_header_t *) (data0 + gho0->l3_hdr_offset), tcp0,
+      &flow_key0, 1);
+  else if (gho0->gho_flags & GHO_F_IP6)
+    gro_get_ip6_flow_from_packet (
+      sw_if_index0, (ip6_header_t *) (data0 + gho0->l3_hdr_offset), tcp0,
+      &flow_key0, 1);
+  else
+    return;
+
+  f = gro_hash_flow_get (ptd, &flow_key0);
+  if (f->flow.n_buffers && gro_flow_is_equal (&f->flow.flow_key, &flow_key0))
+    {
+      u16 next = f->next_index;
+      gro_input_enqueue (ptd, gro_hash_flow_flush (vm, ptd, f), next);
+    }
+}
+
+static_always_inline void
+gro_input_one (vlib_main_t *vm, vlib_node_runtime_t *node,
+	       gro_per_thread_data_t *ptd, u32 bi0, f64 now)
+{
+  vlib_buffer_t *b0 = vlib_get_buffer (vm, bi0);
+  generic_header_offset_t gho0 = { 0 };
+  gro_flow_key_t flow_key0 = {};
+  gro_hash_flow_t *f;
+  tcp_header_t *tcp0;
+  u32 pkt_len0, next0;
+  u8 is_flush;
+
+  vnet_feature_next (&next0, b0);
+
+  if (PREDICT_FALSE (b0->flags & VNET_BUFFER_F_GSO))
+    goto bypass;
+
+  pkt_len0 = gro_get_packet_data (vm, b0, &gho0, &flow_key0, 1 /* is_l2 */);
+  if (pkt_len0 == 0)
+    {
+      gro_input_flush_bypassed_flow (vm, ptd, b0, &gho0);
+      goto bypass;
+    }
+
+  /* tx interface is not known yet on device-input */
+  flow_key0.sw_if_index[VLIB_TX] = ~0;
+
+  tcp0 = (tcp_header_t *) (vlib_buffer_get_current (b0) + gho0.l4_hdr_offset);
+  is_flush =
+    (tcp0->flags & TCP_FLAG_PSH) || (pkt_len0 <= GRO_MIN_PACKET_SIZE);
+
+  f = gro_hash_flow_get (ptd, &flow_key0);
+  ptd->window_lookups++;
+
+  if (f->flow.n_buffers)
+    {
+      if (PREDICT_TRUE (gro_flow_is_equal (&f->flow.flow_key, &flow_key0)))
+	{
+	  generic_header_offset_t gho_s = { 0 };
+	  u32 bi_s = f->flow.buffer_index;
+	  vlib_buffer_t *b_s = vlib_get_buffer (vm, bi_s);
+	  u32 is_ip_s = gro_is_ip4_or_ip6_packet (b_s, 1);
+	  u32 pkt_len_s, payload_len0, payload_len_s;
+	  tcp_header_t *tcp_s;
+
+	  vnet_generic_header_offset_parser (
+	    b_s, &gho_s, 1 /* is_l2 */, is_ip_s & VNET_BUFFER_F_IS_IP4,
+	    is_ip_s & VNET_BUFFER_F_IS_IP6);
+	  tcp_s = (tcp_header_t *) (vlib_buffer_get_current (b_s) +
+				    gho_s.l4_hdr_offset);
+	  pkt_len_s = vlib_buffer_length_in_chain (vm, b_s);
+	  payload_len0 = pkt_len0 - gho0.hdr_sz;
+	  payload_len_s = pkt_len_s - gho_s.hdr_sz;
+
+	  if (gro_tcp_sequence_check (tcp_s, tcp0, payload_len_s) ==
+		GRO_PACKET_ACTION_ENQUEUE &&
+	      (pkt_len_s + payload_len0) < TCP_MAX_GSO_SZ &&
+	      f->flow.n_buffers < GRO_FLOW_N_BUFFERS)
+	    {
+	      gro_merge_buffers (vm, b_s, b0, bi0, payload_len0, gho0.hdr_sz);
+	      tcp_s->flags |= tcp0->flags;
+	      f->flow.n_buffers++;
+	      f->flow.last_ack_number = tcp0->ack_number;
+	      ptd->n_merged++;
+	      if (PREDICT_FALSE (is_flush))
+		{
+		  u16 next = f->next_index;
+		  gro_input_enqueue (ptd, gro_hash_flow_flush (vm, ptd, f),
+				     next);
+		}
+	      return;
+	    }
+	}
+      else
+	{
+	  ptd->n_collisions++;
+	  ptd->window_collisions++;
+	}
+
+      /* out of sequence, full, or the slot belongs to another flow */
+      u16 next = f->next_index;
+      gro_input_enqueue (ptd, gro_hash_flow_flush (vm, ptd, f), next);
+    }
+
+  if (is_flush)
+    goto bypass;
+
+  gro_hash_flow_store (vm, node, ptd, f, &flow_key0, bi0, tcp0->ack_number,
+		       next0, now);
+  return;
+
+bypass:
+  gro_input_enqueue (ptd, bi0, next0);
+}
+
+VLIB_NODE_FN (gro_input_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  gro_main_t *gm = &gro_main;
+  gro_per_thread_data_t *ptd =
+    vec_elt_at_index (gm->per_thread_data, vm->thread_index);
+  u32 *from = vlib_frame_vector_args (frame);
+  u32 n_left = frame->n_vectors;
+  f64 now = vlib_time_now (vm);
+
+  vec_reset_length (ptd->to);
+  vec_reset_length (ptd->nexts);
+  gro_input_update_timeout (ptd, now);
+  ptd->n_packets_in += frame->n_vectors;
+
+  while (n_left)
+    {
+      if (n_left > 2)
+	vlib_prefetch_buffer_header (vlib_get_buffer (vm, from[2]), LOAD);
+
+      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
+	{
+	  vlib_buffer_t *b0 = vlib_get_buffer (vm, from[0]);
+	  if (b0->flags & VLIB_BUFFER_IS_TRACED)
+	    {
+	      gro_input_trace_t *t = vlib_add_trace (vm, node, b0, sizeof (*t));
+	      t->sw_if_index = vnet_buffer (b0)->sw_if_index[VLIB_RX];
+	      t->n_flows = 1 << ptd->log2_n_flows;
+	      t->n_active = vec_len (ptd->active);
+	    }
+	}
+
+      gro_input_one (vm, node, ptd, from[0], now);
+      from += 1;
+      n_left -= 1;
+    }
+
+  /* a short frame means the rx queues are drained, nothing more to wait
+   * for */
+  if (frame->n_vectors < GRO_HASH_FLUSH_ALL_THRESHOLD)
+    gro_input_flush_all (vm, ptd);
+  else
+    gro_input_flush_expired (vm, ptd, now);
+
+  gro_input_maybe_resize (vm, ptd);
+
+  ptd->n_packets_out += vec_len (ptd->to);
+  vlib_buffer_enqueue_to_next (vm, node, ptd->to, ptd->nexts,
+			       vec_len (ptd->to));
+
+  return frame->n_vectors;
+}
+
+VLIB_REGISTER_NODE (gro_input_node) = {
+  .name = "gro-input",
+  .vector_size = sizeof (u32),
+  .format_trace = format_gro_input_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_next_nodes = 0,
+};
+
+VNET_FEATURE_INIT (gro_input_feature, static) = {
+  .arc_name = "device-input",
+  .node_name = "gro-input",
+  .runs_before = VNET_FEATURES ("ethernet-input"),
+};
+
+/**
+ * Flushes the flows which timed out when the gro-input node does not run,
+ * e.g. when the traffic stops right after a full frame. Once gro is
+ * disabled on all interfaces, flushes all flows and disables itself.
+ */
+static uword
+gro_flush_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
+		   vlib_frame_t *frame)
+{
+  gro_main_t *gm = &gro_main;
+  gro_per_thread_data_t *ptd =
+    vec_elt_at_index (gm->per_thread_data, vm->thread_index);
+  u32 next_node_index = ~0, *to_next = 0;
+  vlib_frame_t *f = 0;
+  f64 now;
+  int i;
+
+  if (vec_len (ptd->active) == 0)
+    {
+      if (gm->n_enabled == 0)
+	vlib_node_set_state (vm, gro_flush_node.index,
+			     VLIB_NODE_STATE_DISABLED);
+      return 0;
+    }
+
+  now = vlib_time_now (vm);
+  for (i = vec_len (ptd->active) - 1; i >= 0; i--)
+    {
+      gro_hash_flow_t *fl = ptd->flows + ptd->active[i];
+
+      if (gm->n_enabled && fl->flow.next_timeout_ts > now)
+	continue;
+
+      if (fl->next_node_index != next_node_index ||
+	  f->n_vectors == VLIB_FRAME_SIZE)
+	{
+	  if (f)
+	    vlib_put_frame_to_node (vm, next_node_index, f);
+	  next_node_index = fl->next_node_index;
+	  f = vlib_get_frame_to_node (vm, next_node_index);
+	  to_next = vlib_frame_vector_args (f);
+	}
+
+      to_next[f->n_vectors++] = gro_hash_flow_flush (vm, ptd, fl);
+      ptd->n_timeout_flushes++;
+      ptd->n_packets_out++;
+    }
+
+  if (f)
+    vlib_put_frame_to_node (vm, next_node_index, f);
+
+  return 0;
+}
+
+VLIB_REGISTER_NODE (gro_flush_node) = {
+  .function = gro_flush_node_fn,
+  .type = VLIB_NODE_TYPE_PRE_INPUT,
+  .name = "gro-flush",
+  .state = VLIB_NODE_STATE_DISABLED,
+};
+
+int
+vnet_sw_interface_gro_enable_disable (u32 sw_if_index, u8 enable)
+{
+  gro_main_t *gm = &gro_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_sw_interface_t *si;
+  int rv;
+
+  if (pool_is_free_index (vnm->interface_main.sw_interfaces, sw_if_index))
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX;
+
+  si = vnet_get_sw_interface (vnm, sw_if_index);
+  if (si->type != VNET_SW_INTERFACE_TYPE_HARDWARE)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  enable = enable != 0;
+  if (clib_bitmap_get (gm->enabled_by_sw_if_index, sw_if_index) == enable)
+    return 0;
+
+  if (enable && vec_len (gm->per_thread_data) == 0)
+    {
+      gro_per_thread_data_t *ptd;
+
+      vec_validate_aligned (gm->per_thread_data, vlib_get_n_threads () - 1,
+			    CLIB_CACHE_LINE_BYTES);
+      vec_foreach (ptd, gm->per_thread_data)
+	{
+	  gro_per_thread_data_alloc_flows (ptd, GRO_HASH_TABLE_DEFAULT_LOG2);
+	  ptd->flow_timeout = GRO_FLOW_TIMEOUT;
+	  vec_validate (ptd->to, 2 * VLIB_FRAME_SIZE +
+				   (1 << GRO_HASH_TABLE_MAX_LOG2));
+	  vec_validate (ptd->nexts, 2 * VLIB_FRAME_SIZE +
+				      (1 << GRO_HASH_TABLE_MAX_LOG2));
+	  vec_validate (ptd->active, 1 << GRO_HASH_TABLE_MAX_LOG2);
+	  vec_reset_length (ptd->to);
+	  vec_reset_length (ptd->nexts);
+	  vec_reset_length (ptd->active);
+	}
+    }
+
+  rv = vnet_feature_enable_disable ("device-input", "gro-input", sw_if_index,
+				    enable, 0, 0);
+  if (rv)
+    return rv;
+
+  gm->enabled_by_sw_if_index =
+    clib_bitmap_set (gm->enabled_by_sw_if_index, sw_if_index, enable);
+
+  if (enable)
+    {
+      gm->n_enabled++;
+      if (gm->n_enabled == 1)
+	{
+	  foreach_vlib_main ()
+	    vlib_node_set_state (this_vlib_main, gro_flush_node.index,
+				 VLIB_NODE_STATE_POLLING);
+	}
+    }
+  else
+    /* gro-flush disables itself once the stored packets are flushed */
+    gm->n_enabled--;
+
+  return 0;
+}
+
+u8 *
+format_gro_per_thread_data (u8 *s, va_list *args)
+{
+  gro_per_thread_data_t *ptd = va_arg (*args, gro_per_thread_data_t *);
+  u32 indent = format_get_indent (s);
+
+  s = format (s, "flow-table: size %u active %u resizes %u timeout %.2fus",
+	      1 << ptd->log2_n_flows, vec_len (ptd->active), ptd->n_resizes,
+	      ptd->flow_timeout * 1e6);
+  s = format (s, "\n%Upackets: in %lu out %lu merged %lu", format_white_space,
+	      indent, ptd->n_packets_in, ptd->n_packets_out, ptd->n_merged);
+  if (ptd->n_packets_out)
+    s = format (s, " merge-ratio %.2f",
+		(f64) ptd->n_packets_in / (f64) ptd->n_packets_out);
+  else
+    s = format (s, " merge-ratio 0.00");
+  s = format (s, "\n%Ucollisions %lu timeout-flushes %lu", format_white_space,
+	      indent, ptd->n_collisions, ptd->n_timeout_flushes);
+
+  return s;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -18,7 +18,10 @@
 
 #include <vnet/vnet.h>
 #include <vnet/gso/hdr_offset_parser.h>
+#include <vnet/ip/ip4.h>
+#include <vnet/ip/ip6.h>
 #include <vnet/ip/ip_psh_cksum.h>
+#include <vnet/udp/udp_packet.h>
 
 typedef struct
 {
@@ -166,6 +169,115 @@ gso_fixup_segmented_buf (vlib_main_t *vm, vlib_buffer_t *b0, u32 next_tcp_seq,
     }
 }
 
+static_always_inline u16
+tso_segment_ipip_tunnel_fixup (vlib_main_t * vm,
+			       vnet_interface_per_thread_data_t * ptd,
+			       vlib_buffer_t * sb0,
+			       generic_header_offset_t * gho)
+{
+  u16 n_tx_bufs = vec_len (ptd->split_buffers);
+  u16 i = 0, n_tx_bytes = 0;
+
+  while (i < n_tx_bufs)
+    {
+      vlib_buffer_t *b0 = vlib_get_buffer (vm, ptd->split_buffers[i]);
+
+      ip4_header_t *ip4 =
+	(ip4_header_t *) (vlib_buffer_get_current (b0) +
+			  gho->outer_l3_hdr_offset);
+      ip6_header_t *ip6 =
+	(ip6_header_t *) (vlib_buffer_get_current (b0) +
+			  gho->outer_l3_hdr_offset);
+
+      if (gho->gho_flags & GHO_F_OUTER_IP4)
+	{
+	  ip4->length =
+	    clib_host_to_net_u16 (b0->current_length -
+				  gho->outer_l3_hdr_offset);
+	  ip4->checksum = ip4_header_checksum (ip4);
+	}
+      else if (gho->gho_flags & GHO_F_OUTER_IP6)
+	{
+	  ip6->payload_length =
+	    clib_host_to_net_u16 (b0->current_length -
+				  gho->outer_l4_hdr_offset);
+	}
+
+      n_tx_bytes += gho->outer_hdr_sz;
+      i++;
+    }
+  return n_tx_bytes;
+}
+
+static_always_inline void
+tso_segment_vxlan_tunnel_headers_fixup (vlib_main_t * vm, vlib_buffer_t * b,
+					generic_header_offset_t * gho)
+{
+  u8 proto = 0;
+  ip4_header_t *ip4 = 0;
+  ip6_header_t *ip6 = 0;
+  udp_header_t *udp = 0;
+
+  ip4 =
+    (ip4_header_t *) (vlib_buffer_get_current (b) + gho->outer_l3_hdr_offset);
+  ip6 =
+    (ip6_header_t *) (vlib_buffer_get_current (b) + gho->outer_l3_hdr_offset);
+  udp =
+    (udp_header_t *) (vlib_buffer_get_current (b) + gho->outer_l4_hdr_offset);
+
+  if (gho->gho_flags & GHO_F_OUTER_IP4)
+    {
+      proto = ip4->protocol;
+      ip4->length =
+	clib_host_to_net_u16 (b->current_length - gho->outer_l3_hdr_offset);
+      ip4->checksum = ip4_header_checksum (ip4);
+    }
+  else if (gho->gho_flags & GHO_F_OUTER_IP6)
+    {
+      proto = ip6->protocol;
+      ip6->payload_length =
+	clib_host_to_net_u16 (b->current_length - gho->outer_l4_hdr_offset);
+    }
+  if (proto == IP_PROTOCOL_UDP)
+    {
+      int bogus;
+      udp->length =
+	clib_host_to_net_u16 (b->current_length - gho->outer_l4_hdr_offset);
+      udp->checksum = 0;
+      if (gho->gho_flags & GHO_F_OUTER_IP6)
+	{
+	  udp->checksum =
+	    ip6_tcp_udp_icmp_compute_checksum (vm, b, ip6, &bogus);
+	}
+      else if (gho->gho_flags & GHO_F_OUTER_IP4)
+	{
+	  udp->checksum = ip4_tcp_udp_compute_checksum (vm, b, ip4);
+	}
+      /* FIXME: it should be OUTER_UDP_CKSUM */
+      vnet_buffer_offload_flags_clear (b, VNET_BUFFER_OFFLOAD_F_UDP_CKSUM);
+    }
+}
+
+static_always_inline u16
+tso_segment_vxlan_tunnel_fixup (vlib_main_t * vm,
+				vnet_interface_per_thread_data_t * ptd,
+				vlib_buffer_t * sb0,
+				generic_header_offset_t * gho)
+{
+  u16 n_tx_bufs = vec_len (ptd->split_buffers);
+  u16 i = 0, n_tx_bytes = 0;
+
+  while (i < n_tx_bufs)
+    {
+      vlib_buffer_t *b0 = vlib_get_buffer (vm, ptd->split_buffers[i]);
+
+      tso_segment_vxlan_tunnel_headers_fixup (vm, b0, gho);
+      n_tx_bytes += gho->outer_hdr_sz;
+      i++;
+    }
+  return n_tx_bytes;
+}
+
 static_always_inline u32
 gso_segment_buffer_inline (vlib_main_t *vm,
 			   vnet_interface_per_thread_data_t *ptd,
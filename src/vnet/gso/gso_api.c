@@ -20,6 +20,7 @@
 #include <vnet/vnet.h>
 #include <vlibmemory/api.h>
 #include <vnet/gso/gso.h>
+#include <vnet/gso/gro.h>
 
 #include <vnet/format_fns.h>
 #include <vnet/gso/gso.api_enum.h>
@@ -46,6 +47,23 @@ static void
   REPLY_MACRO (VL_API_FEATURE_GSO_ENABLE_DISABLE_REPLY);
 }
 
+static void
+vl_api_feature_gro_enable_disable_t_handler (
+  vl_api_feature_gro_enable_disable_t *mp)
+{
+  vl_api_feature_gro_enable_disable_reply_t *rmp;
+  int rv = 0;
+
+  VALIDATE_SW_IF_INDEX (mp);
+
+  rv = vnet_sw_interface_gro_enable_disable (ntohl (mp->sw_if_index),
+					     mp->enable_disable);
+
+  BAD_SW_IF_INDEX_LABEL;
+
+  REPLY_MACRO (VL_API_FEATURE_GRO_ENABLE_DISABLE_REPLY);
+}
+
 #include <vnet/gso/gso.api.c>
 
 static clib_error_t *
@@ -609,6 +609,9 @@ typedef struct
 
   /* mode */
   vnet_hw_if_rx_mode mode : 8;
+
+  /* placement is balanced by the driver, rx-rebalance leaves it alone */
+  u8 driver_rebalance : 1;
 #define VNET_HW_IF_RXQ_THREAD_ANY      ~0
 #define VNET_HW_IF_RXQ_NO_RX_INTERRUPT ~0
 } vnet_hw_if_rx_queue_t;
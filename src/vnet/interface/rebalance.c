@@ -0,0 +1,552 @@
+/*
+ * Copyright (c) 2024 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Automatic rx queue placement.
+ *
+ * Input nodes poll all queues placed on a thread in a single dispatch, so
+ * there is no per-queue cycle counter. Every interval the clocks an input
+ * node spent on a worker are sampled from the node runtime stats and split
+ * between the queues it polls there, in proportion to the packets each
+ * interface received on that worker. Queues are then moved from the busiest
+ * worker to the idlest one until their load differs by less than the
+ * configured threshold, or max-moves queues have been moved. Queues whose
+ * driver balances them itself (vhost-user with its own rebalancing enabled)
+ * count towards their worker load but are never moved.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/devices/devices.h>
+#include <vnet/interface/rx_queue_funcs.h>
+
+VLIB_REGISTER_LOG_CLASS (if_rxq_rebalance_log, static) = {
+  .class_name = "interface",
+  .subclass_name = "rx-rebalance",
+};
+
+#define log_debug(fmt, ...)                                                   \
+  vlib_log_debug (if_rxq_rebalance_log.class, fmt, __VA_ARGS__)
+#define log_notice(fmt, ...)                                                  \
+  vlib_log_notice (if_rxq_rebalance_log.class, fmt, __VA_ARGS__)
+
+typedef struct
+{
+  /* configuration, 0 interval disables */
+  f64 interval;
+  u32 threshold;
+  u32 max_moves;
+  u8 dry_run;
+
+  /* node clocks and interface rx packets at the previous sample,
+     indexed by [thread_index][node_index] and [thread_index][sw_if_index] */
+  u64 **node_clocks;
+  u64 **rx_packets;
+
+  /* results of the last pass */
+  f64 last_run;
+  f64 last_interval;
+  u64 *thread_load;
+  u64 *queue_load;
+  vnet_hw_if_rxq_move_t *moves;
+  u32 n_passes;
+  u32 n_moved;
+} rxq_rebalance_main_t;
+
+static rxq_rebalance_main_t rxq_rebalance_main = {
+  .threshold = 20,
+  .max_moves = 1,
+};
+
+static u64
+rxq_rebalance_delta (u64 *last, u64 now)
+{
+  /* counters may have been cleared meanwhile */
+  u64 d = now >= *last ? now - *last : 0;
+  *last = now;
+  return d;
+}
+
+static void
+rxq_rebalance_sample (vlib_main_t *vm)
+{
+  rxq_rebalance_main_t *rm = &rxq_rebalance_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_interface_main_t *im = &vnm->interface_main;
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vlib_combined_counter_main_t *cm =
+    im->combined_sw_if_counters + VNET_INTERFACE_COUNTER_RX;
+  vnet_hw_if_rx_queue_t *rxq;
+  vnet_hw_interface_t *hi;
+  uword *input_nodes = 0;
+  u64 **node_delta = 0, **rx_delta = 0;
+  f64 **node_weight = 0, *queue_weight = 0;
+  u32 t, ni;
+
+  vec_validate (rm->node_clocks, vdm->last_worker_thread_index);
+  vec_validate (rm->rx_packets, vdm->last_worker_thread_index);
+  vec_validate (node_delta, vdm->last_worker_thread_index);
+  vec_validate (rx_delta, vdm->last_worker_thread_index);
+  vec_validate (node_weight, vdm->last_worker_thread_index);
+  vec_reset_length (rm->thread_load);
+  vec_validate (rm->thread_load, vdm->last_worker_thread_index);
+  vec_reset_length (rm->queue_load);
+  if (pool_len (im->hw_if_rx_queues))
+    {
+      vec_validate (rm->queue_load, pool_len (im->hw_if_rx_queues) - 1);
+      vec_validate (queue_weight, pool_len (im->hw_if_rx_queues) - 1);
+    }
+
+  pool_foreach (rxq, im->hw_if_rx_queues)
+    {
+      hi = vnet_get_hw_interface (vnm, rxq->hw_if_index);
+      input_nodes = clib_bitmap_set (input_nodes, hi->input_node_index, 1);
+    }
+
+  /* node stats live in the worker runtimes until synced */
+  vlib_worker_thread_barrier_sync (vm);
+  for (t = vdm->first_worker_thread_index; t <= vdm->last_worker_thread_index;
+       t++)
+    {
+      vlib_main_t *wvm = vlib_get_main_by_index (t);
+
+      clib_bitmap_foreach (ni, input_nodes)
+	{
+	  vlib_node_t *n = vlib_get_node (wvm, ni);
+	  vlib_node_sync_stats (wvm, n);
+	  vec_validate (rm->node_clocks[t], ni);
+	  vec_validate (node_delta[t], ni);
+	  node_delta[t][ni] = rxq_rebalance_delta (&rm->node_clocks[t][ni],
+						   n->stats_total.clocks);
+	}
+    }
+  vlib_worker_thread_barrier_release (vm);
+
+  for (t = vdm->first_worker_thread_index; t <= vdm->last_worker_thread_index;
+       t++)
+    {
+      pool_foreach (hi, im->hw_interfaces)
+	{
+	  u32 sw_if_index = hi->sw_if_index;
+
+	  if (vec_len (hi->rx_queue_indices) == 0 ||
+	      sw_if_index >= vec_len (cm->counters[t]))
+	    continue;
+	  vec_validate (rm->rx_packets[t], sw_if_index);
+	  vec_validate (rx_delta[t], sw_if_index);
+	  rx_delta[t][sw_if_index] = rxq_rebalance_delta (
+	    &rm->rx_packets[t][sw_if_index], cm->counters[t][sw_if_index].packets);
+	}
+    }
+
+  /* a queue's share of its node clocks on a thread, split evenly between
+     queues of the same interface */
+  pool_foreach (hi, im->hw_interfaces)
+    {
+      u32 *qi;
+      vec_foreach (qi, hi->rx_queue_indices)
+	{
+	  u32 n_same = 0, *qj;
+
+	  rxq = vnet_hw_if_get_rx_queue (vnm, qi[0]);
+	  t = rxq->thread_index;
+	  if (t < vdm->first_worker_thread_index ||
+	      t > vdm->last_worker_thread_index ||
+	      hi->sw_if_index >= vec_len (rx_delta[t]))
+	    continue;
+	  vec_foreach (qj, hi->rx_queue_indices)
+	    n_same += vnet_hw_if_get_rx_queue (vnm, qj[0])->thread_index == t;
+	  queue_weight[qi[0]] = (f64) rx_delta[t][hi->sw_if_index] / n_same;
+	  vec_validate (node_weight[t], hi->input_node_index);
+	  node_weight[t][hi->input_node_index] += queue_weight[qi[0]];
+	}
+    }
+
+  pool_foreach (rxq, im->hw_if_rx_queues)
+    {
+      u32 qi = rxq - im->hw_if_rx_queues;
+
+      t = rxq->thread_index;
+      hi = vnet_get_hw_interface (vnm, rxq->hw_if_index);
+      ni = hi->input_node_index;
+      if (queue_weight[qi] == 0)
+	continue;
+      rm->queue_load[qi] =
+	queue_weight[qi] / node_weight[t][ni] * node_delta[t][ni];
+      rm->thread_load[t] += rm->queue_load[qi];
+    }
+
+  for (t = 0; t < vec_len (node_delta); t++)
+    {
+      vec_free (node_delta[t]);
+      vec_free (rx_delta[t]);
+      vec_free (node_weight[t]);
+    }
+  vec_free (node_delta);
+  vec_free (rx_delta);
+  vec_free (node_weight);
+  vec_free (queue_weight);
+  clib_bitmap_free (input_nodes);
+}
+
+/*
+ * Plan queue moves from the busiest to the idlest of the threads
+ * [first_thread, last_thread], each move planned on the loads left by the
+ * previous ones. thread_of is the thread polling each queue, ~0 for a queue
+ * which must not be moved; it is updated with the planned moves.
+ */
+vnet_hw_if_rxq_move_t *
+vnet_hw_if_rx_rebalance_plan (vnet_hw_if_rxq_move_t *moves, u64 *thread_load,
+			      u64 *queue_load, u32 *thread_of,
+			      u32 first_thread, u32 last_thread, u32 threshold,
+			      u32 max_moves)
+{
+  u64 *load = vec_dup (thread_load);
+  u32 i, qi, t, src, dst;
+
+  vec_reset_length (moves);
+  vec_validate (load, last_thread);
+
+  for (i = 0; i < max_moves; i++)
+    {
+      vnet_hw_if_rxq_move_t *mv;
+      u64 gap, best_dist = ~0ULL;
+      u32 best = ~0;
+
+      src = dst = first_thread;
+      for (t = first_thread; t <= last_thread; t++)
+	{
+	  if (load[t] > load[src])
+	    src = t;
+	  if (load[t] < load[dst])
+	    dst = t;
+	}
+
+      if (load[src] == 0 ||
+	  (load[src] - load[dst]) * 100 <= (u64) threshold * load[src])
+	break;
+
+      /* moving a queue lighter than the gap always lowers the busiest
+	 worker, prefer the one that leaves both closest to the average */
+      gap = load[src] - load[dst];
+      for (qi = 0; qi < vec_len (queue_load); qi++)
+	{
+	  u64 l = queue_load[qi], dist;
+
+	  if (thread_of[qi] != src || l == 0 || l >= gap)
+	    continue;
+	  dist = l > gap / 2 ? l - gap / 2 : gap / 2 - l;
+	  if (dist < best_dist)
+	    {
+	      best_dist = dist;
+	      best = qi;
+	    }
+	}
+
+      if (best == ~0)
+	break;
+
+      vec_add2 (moves, mv, 1);
+      mv->queue_index = best;
+      mv->from = src;
+      mv->to = dst;
+      mv->load = queue_load[best];
+      thread_of[best] = dst;
+      load[src] -= mv->load;
+      load[dst] += mv->load;
+    }
+
+  vec_free (load);
+  return moves;
+}
+
+static void
+rxq_rebalance_plan (void)
+{
+  rxq_rebalance_main_t *rm = &rxq_rebalance_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_interface_main_t *im = &vnm->interface_main;
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vnet_hw_if_rx_queue_t *rxq;
+  u32 *thread_of = 0;
+
+  /* queues the driver balances itself still load their thread */
+  vec_validate_init_empty (thread_of, vec_len (rm->queue_load), ~0);
+  pool_foreach (rxq, im->hw_if_rx_queues)
+    if (!rxq->driver_rebalance)
+      thread_of[rxq - im->hw_if_rx_queues] = rxq->thread_index;
+
+  rm->moves = vnet_hw_if_rx_rebalance_plan (
+    rm->moves, rm->thread_load, rm->queue_load, thread_of,
+    vdm->first_worker_thread_index, vdm->last_worker_thread_index,
+    rm->threshold, rm->max_moves);
+
+  vec_free (thread_of);
+}
+
+static void
+rxq_rebalance_apply (void)
+{
+  rxq_rebalance_main_t *rm = &rxq_rebalance_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_hw_if_rxq_move_t *mv;
+  uword *hw_if_indices = 0;
+  u32 hw_if_index;
+
+  vec_foreach (mv, rm->moves)
+    {
+      vnet_hw_if_rx_queue_t *rxq = vnet_hw_if_get_rx_queue (vnm, mv->queue_index);
+      vnet_hw_interface_t *hi = vnet_get_hw_interface (vnm, rxq->hw_if_index);
+
+      if (rm->dry_run)
+	{
+	  log_notice ("suggest moving %v queue %u from thread %u to %u",
+		      hi->name, rxq->queue_id, mv->from, mv->to);
+	  continue;
+	}
+
+      log_debug ("moving %v queue %u from thread %u to %u", hi->name,
+		 rxq->queue_id, mv->from, mv->to);
+      vnet_hw_if_set_rx_queue_thread_index (vnm, mv->queue_index, mv->to);
+      hw_if_indices = clib_bitmap_set (hw_if_indices, rxq->hw_if_index, 1);
+      rm->n_moved++;
+    }
+
+  clib_bitmap_foreach (hw_if_index, hw_if_indices)
+    vnet_hw_if_update_runtime_data (vnm, hw_if_index);
+  clib_bitmap_free (hw_if_indices);
+}
+
+static uword
+rxq_rebalance_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
+		       vlib_frame_t *f)
+{
+  rxq_rebalance_main_t *rm = &rxq_rebalance_main;
+  vnet_device_main_t *vdm = &vnet_device_main;
+  f64 now;
+
+  while (1)
+    {
+      if (rm->interval > 0)
+	vlib_process_wait_for_event_or_clock (vm, rm->interval);
+      else
+	vlib_process_wait_for_event (vm);
+      vlib_process_get_events (vm, 0);
+
+      if (rm->interval <= 0 || vlib_num_workers () < 2)
+	continue;
+
+      now = vlib_time_now (vm);
+      rxq_rebalance_sample (vm);
+
+      /* first pass after (re)enabling only sets the baseline */
+      if (rm->last_run == 0 || vdm->last_worker_thread_index == 0)
+	vec_reset_length (rm->moves);
+      else
+	{
+	  rxq_rebalance_plan ();
+	  rxq_rebalance_apply ();
+	  rm->last_interval = now - rm->last_run;
+	  rm->n_passes++;
+	}
+      rm->last_run = now;
+    }
+  return 0;
+}
+
+VLIB_REGISTER_NODE (rxq_rebalance_node, static) = {
+  .function = rxq_rebalance_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "rx-queue-rebalance-process",
+};
+
+static clib_error_t *
+rxq_rebalance_parse (unformat_input_t *input, rxq_rebalance_main_t *cfg)
+{
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "interval %f", &cfg->interval))
+	;
+      else if (unformat (input, "threshold %u", &cfg->threshold))
+	;
+      else if (unformat (input, "max-moves %u", &cfg->max_moves))
+	;
+      else if (unformat (input, "dry-run"))
+	cfg->dry_run = 1;
+      else if (unformat (input, "apply"))
+	cfg->dry_run = 0;
+      else if (unformat (input, "disable"))
+	cfg->interval = 0;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (cfg->interval < 0 || cfg->threshold > 100 || cfg->max_moves == 0)
+    return clib_error_return (0, "invalid interval, threshold or max-moves");
+
+  return 0;
+}
+
+static clib_error_t *
+set_interface_rx_rebalance_command_fn (vlib_main_t *vm,
+				       unformat_input_t *input,
+				       vlib_cli_command_t *cmd)
+{
+  rxq_rebalance_main_t *rm = &rxq_rebalance_main;
+  unformat_input_t _line_input, *line_input = &_line_input;
+  rxq_rebalance_main_t cfg = *rm;
+  clib_error_t *error;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  error = rxq_rebalance_parse (line_input, &cfg);
+  unformat_free (line_input);
+  if (error)
+    return error;
+
+  if (cfg.interval != rm->interval)
+    rm->last_run = 0;
+  rm->interval = cfg.interval;
+  rm->threshold = cfg.threshold;
+  rm->max_moves = cfg.max_moves;
+  rm->dry_run = cfg.dry_run;
+  vlib_process_signal_event (vm, rxq_rebalance_node.index, 0, 0);
+
+  return 0;
+}
+
+/*?
+ * Periodically move rx queues between worker threads to even out their
+ * load. The load of each queue is estimated from the clocks its input node
+ * spent on the worker and the packets the interface received there. Queues
+ * are moved from the busiest to the idlest worker while their load differs
+ * by more than <em>threshold</em> percent, at most <em>max-moves</em>
+ * queues per <em>interval</em>. With <em>dry-run</em> the suggested moves
+ * are only logged and listed by '<em>show interface rx-rebalance</em>'.
+ *
+ * @cliexpar
+ * @cliexcmd{set interface rx-rebalance interval 5 threshold 20 max-moves 2}
+ * @cliexcmd{set interface rx-rebalance interval 5 dry-run}
+ * @cliexcmd{set interface rx-rebalance disable}
+?*/
+VLIB_CLI_COMMAND (set_interface_rx_rebalance_command, static) = {
+  .path = "set interface rx-rebalance",
+  .short_help = "set interface rx-rebalance {[interval <sec>] "
+		"[threshold <percent>] [max-moves <n>] [dry-run | apply] | "
+		"disable}",
+  .function = set_interface_rx_rebalance_command_fn,
+};
+
+static clib_error_t *
+show_interface_rx_rebalance_command_fn (vlib_main_t *vm,
+					unformat_input_t *input,
+					vlib_cli_command_t *cmd)
+{
+  rxq_rebalance_main_t *rm = &rxq_rebalance_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_interface_main_t *im = &vnm->interface_main;
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vnet_hw_if_rx_queue_t *rxq;
+  vnet_hw_if_rxq_move_t *mv;
+  f64 clocks;
+  u32 t;
+
+  if (rm->interval <= 0)
+    {
+      vlib_cli_output (vm, "rx queue rebalancing disabled");
+      return 0;
+    }
+
+  vlib_cli_output (vm,
+		   "interval %.2f sec threshold %u%% max-moves %u%s, "
+		   "%u passes, %u queues moved",
+		   rm->interval, rm->threshold, rm->max_moves,
+		   rm->dry_run ? " dry-run" : "", rm->n_passes, rm->n_moved);
+
+  if (rm->n_passes == 0 || vdm->first_worker_thread_index == 0)
+    return 0;
+
+  /* loads are clocks spent over the last interval */
+  clocks = rm->last_interval * vm->clib_time.clocks_per_second;
+  for (t = vdm->first_worker_thread_index;
+       t < vec_len (rm->thread_load) && t <= vdm->last_worker_thread_index;
+       t++)
+    {
+      vlib_cli_output (vm, "thread %u (%s): busy %.1f%%", t,
+		       vlib_worker_threads[t].name,
+		       100.0 * rm->thread_load[t] / clocks);
+      pool_foreach (rxq, im->hw_if_rx_queues)
+	{
+	  u32 qi = rxq - im->hw_if_rx_queues;
+	  if (rxq->thread_index != t || qi >= vec_len (rm->queue_load))
+	    continue;
+	  vlib_cli_output (vm, "  %U queue %u: %.1f%%",
+			   format_vnet_hw_if_index_name, vnm, rxq->hw_if_index,
+			   rxq->queue_id, 100.0 * rm->queue_load[qi] / clocks);
+	}
+    }
+
+  vec_foreach (mv, rm->moves)
+    {
+      if (pool_is_free_index (im->hw_if_rx_queues, mv->queue_index))
+	continue;
+      rxq = vnet_hw_if_get_rx_queue (vnm, mv->queue_index);
+      vlib_cli_output (vm, "%s %U queue %u from thread %u to %u",
+		       rm->dry_run ? "suggested:" : "moved:",
+		       format_vnet_hw_if_index_name, vnm, rxq->hw_if_index,
+		       rxq->queue_id, mv->from, mv->to);
+    }
+
+  return 0;
+}
+
+/*?
+ * Show the rx queue rebalancing configuration, the load of each worker
+ * and rx queue measured in the last interval, and the queue moves done or,
+ * in dry-run mode, suggested in the last pass.
+ *
+ * @cliexpar
+ * @cliexstart{show interface rx-rebalance}
+ * interval 5.00 sec threshold 20% max-moves 1, 12 passes, 1 queues moved
+ * thread 1 (vpp_wk_0): busy 41.2%
+ *   eth0 queue 0: 22.8%
+ *   eth1 queue 0: 18.4%
+ * thread 2 (vpp_wk_1): busy 37.9%
+ *   eth0 queue 1: 37.9%
+ * @cliexend
+?*/
+VLIB_CLI_COMMAND (show_interface_rx_rebalance_command, static) = {
+  .path = "show interface rx-rebalance",
+  .short_help = "show interface rx-rebalance",
+  .function = show_interface_rx_rebalance_command_fn,
+};
+
+static clib_error_t *
+rxq_rebalance_config (vlib_main_t *vm, unformat_input_t *input)
+{
+  return rxq_rebalance_parse (input, &rxq_rebalance_main);
+}
+
+/* rx-rebalance { ... } configuration. */
+VLIB_CONFIG_FUNCTION (rxq_rebalance_config, "rx-rebalance");
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
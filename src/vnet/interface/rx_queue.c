@@ -240,6 +240,14 @@ vnet_hw_if_set_rx_queue_thread_index (vnet_main_t *vnm, u32 queue_index,
 	     hi->name, rxq->queue_id, thread_index);
 }
 
+void
+vnet_hw_if_set_rx_queue_driver_rebalance (vnet_main_t *vnm, u32 queue_index,
+					  int enable)
+{
+  vnet_hw_if_rx_queue_t *rxq = vnet_hw_if_get_rx_queue (vnm, queue_index);
+  rxq->driver_rebalance = enable != 0;
+}
+
 vnet_hw_if_rxq_poll_vector_t *
 vnet_hw_if_generate_rxq_int_poll_vector (vlib_main_t *vm,
 					 vlib_node_runtime_t *node)
@@ -33,6 +33,21 @@ vnet_hw_if_rx_mode vnet_hw_if_get_rx_queue_mode (vnet_main_t *vnm,
 						 u32 queue_index);
 void vnet_hw_if_set_rx_queue_thread_index (vnet_main_t *vnm, u32 queue_index,
 					   u32 thread_index);
+void vnet_hw_if_set_rx_queue_driver_rebalance (vnet_main_t *vnm,
+					       u32 queue_index, int enable);
+
+typedef struct
+{
+  u32 queue_index;
+  u32 from;
+  u32 to;
+  u64 load;
+} vnet_hw_if_rxq_move_t;
+
+vnet_hw_if_rxq_move_t *vnet_hw_if_rx_rebalance_plan (
+  vnet_hw_if_rxq_move_t *moves, u64 *thread_load, u64 *queue_load,
+  u32 *thread_of, u32 first_thread, u32 last_thread, u32 threshold,
+  u32 max_moves);
 vnet_hw_if_rxq_poll_vector_t *
 vnet_hw_if_generate_rxq_int_poll_vector (vlib_main_t *vm,
 					 vlib_node_runtime_t *node);
@@ -82,3 +82,135 @@ statseg_sw_interface_add_del (vnet_main_t *vnm, u32 sw_if_index, u32 is_add)
 }
 
 VNET_SW_INTERFACE_ADD_DEL_FUNCTION (statseg_sw_interface_add_del);
+
+/* Per rx queue snapshot used to turn input node mode residency into per
+   queue counters. */
+typedef struct
+{
+  u32 hw_if_index;
+  u32 queue_id;
+  u32 thread_index;
+  vnet_hw_if_rx_mode mode;
+  f64 last_update;
+  f64 time_in_state[VLIB_N_NODE_STATE];
+  u64 n_switches;
+} rxq_residency_t;
+
+static struct
+{
+  vlib_stats_string_vector_t names;
+  u32 polling_time_index;
+  u32 interrupt_time_index;
+  u32 switches_index;
+  rxq_residency_t *queues;
+} rxq_stats;
+
+static void
+rxq_residency_collector_fn (vlib_stats_collector_data_t *d)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_interface_main_t *im = &vnm->interface_main;
+  vnet_hw_if_rx_queue_t *rxq;
+  counter_t *polling, *interrupt, *switches;
+  u32 n_queues = pool_len (im->hw_if_rx_queues);
+  f64 now = vlib_time_now (vlib_get_main ());
+
+  if (n_queues == 0)
+    return;
+
+  vlib_stats_validate (rxq_stats.polling_time_index, 0, n_queues - 1);
+  vlib_stats_validate (rxq_stats.interrupt_time_index, 0, n_queues - 1);
+  vlib_stats_validate (rxq_stats.switches_index, 0, n_queues - 1);
+  vec_validate (rxq_stats.queues, n_queues - 1);
+
+  polling = ((counter_t **) vlib_stats_get_entry_data_pointer (
+    rxq_stats.polling_time_index))[0];
+  interrupt = ((counter_t **) vlib_stats_get_entry_data_pointer (
+    rxq_stats.interrupt_time_index))[0];
+  switches = ((counter_t **) vlib_stats_get_entry_data_pointer (
+    rxq_stats.switches_index))[0];
+
+  pool_foreach (rxq, im->hw_if_rx_queues)
+    {
+      u32 qi = rxq - im->hw_if_rx_queues;
+      rxq_residency_t *r = vec_elt_at_index (rxq_stats.queues, qi);
+      vnet_hw_interface_t *hi = vnet_get_hw_interface (vnm, rxq->hw_if_index);
+      vlib_node_adaptive_state_t *as = 0;
+      f64 t[VLIB_N_NODE_STATE] = {};
+      u64 n_switches = 0;
+
+      /* adaptive queues follow their input node on the owning thread,
+	 other queues stay in configured mode */
+      if (rxq->mode == VNET_HW_IF_RX_MODE_ADAPTIVE)
+	as = vlib_node_get_adaptive_state (
+	  vlib_get_main_by_index (rxq->thread_index), hi->input_node_index);
+
+      if (as)
+	{
+	  t[VLIB_NODE_STATE_POLLING] = vlib_node_adaptive_time_in_state (
+	    as, VLIB_NODE_STATE_POLLING, now);
+	  t[VLIB_NODE_STATE_INTERRUPT] = vlib_node_adaptive_time_in_state (
+	    as, VLIB_NODE_STATE_INTERRUPT, now);
+	  n_switches = as->n_switches;
+	}
+
+      if (r->last_update == 0 || r->hw_if_index != rxq->hw_if_index ||
+	  r->queue_id != rxq->queue_id)
+	{
+	  /* new queue */
+	  polling[qi] = interrupt[qi] = switches[qi] = 0;
+	  vlib_stats_set_string_vector (&rxq_stats.names, qi, "%v/%u",
+					hi->name, rxq->queue_id);
+	}
+      else if (r->thread_index != rxq->thread_index || r->mode != rxq->mode)
+	;
+      else if (as)
+	{
+	  for (int s = 0; s < VLIB_N_NODE_STATE; s++)
+	    if (t[s] > r->time_in_state[s])
+	      {
+		counter_t us = (t[s] - r->time_in_state[s]) * 1e6;
+		if (s == VLIB_NODE_STATE_POLLING)
+		  polling[qi] += us;
+		else if (s == VLIB_NODE_STATE_INTERRUPT)
+		  interrupt[qi] += us;
+	      }
+	  if (n_switches > r->n_switches)
+	    switches[qi] += n_switches - r->n_switches;
+	}
+      else if (rxq->mode == VNET_HW_IF_RX_MODE_POLLING)
+	polling[qi] += (now - r->last_update) * 1e6;
+      else
+	interrupt[qi] += (now - r->last_update) * 1e6;
+
+      r->hw_if_index = rxq->hw_if_index;
+      r->queue_id = rxq->queue_id;
+      r->thread_index = rxq->thread_index;
+      r->mode = rxq->mode;
+      r->last_update = now;
+      r->n_switches = n_switches;
+      clib_memcpy_fast (r->time_in_state, t, sizeof (t));
+    }
+}
+
+static clib_error_t *
+statseg_rxq_init (vlib_main_t *vm)
+{
+  vlib_stats_collector_reg_t reg = {};
+
+  rxq_stats.names = vlib_stats_add_string_vector ("/if/rx-queue/names");
+  rxq_stats.polling_time_index =
+    vlib_stats_add_counter_vector ("/if/rx-queue/polling-time");
+  rxq_stats.interrupt_time_index =
+    vlib_stats_add_counter_vector ("/if/rx-queue/interrupt-time");
+  rxq_stats.switches_index =
+    vlib_stats_add_counter_vector ("/if/rx-queue/mode-switches");
+
+  reg.entry_index = rxq_stats.polling_time_index;
+  reg.collect_fn = rxq_residency_collector_fn;
+  vlib_stats_register_collector_fn (&reg);
+
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (statseg_rxq_init);
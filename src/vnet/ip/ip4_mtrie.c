@@ -135,6 +135,49 @@ ply_create (ip4_mtrie_leaf_t init_leaf, u32 leaf_prefix_len, u32 ply_base_len)
   return l;
 }
 
+u32
+ip4_mtrie_ply_count (uword **plies, const ip4_address_t *dst_address,
+		     u32 dst_address_length)
+{
+  u32 addr = clib_net_to_host_u32 (dst_address->as_u32);
+  u32 n_new = 0, len;
+  u64 key;
+
+  /*
+   * a prefix longer than a ply boundary lives in the ply below it, the
+   * 8 bit boundary only exists in the 8-8-8-8 trie
+   */
+  for (len = 8; len < dst_address_length; len += 8)
+    {
+      key = ((u64) len << 32) | (addr & ~pow2_mask (32 - len));
+      if (hash_get (*plies, key))
+	continue;
+      hash_set (*plies, key, 1);
+      n_new++;
+    }
+
+  return n_new;
+}
+
+u8
+ip4_mtrie_ply_pool_will_expand (u32 n_plies)
+{
+  uword n_free = pool_free_elts (ip4_ply_pool);
+
+  return (n_free < n_plies &&
+	  vec_resize_will_expand (ip4_ply_pool, n_plies - n_free));
+}
+
+void
+ip4_mtrie_ply_pool_reserve (u32 n_plies)
+{
+  uword n_free = pool_free_elts (ip4_ply_pool);
+
+  if (n_free < n_plies)
+    pool_alloc_aligned (ip4_ply_pool, n_plies - n_free,
+			CLIB_CACHE_LINE_BYTES);
+}
+
 always_inline ip4_mtrie_8_ply_t *
 get_next_ply_for_leaf (ip4_mtrie_leaf_t l)
 {
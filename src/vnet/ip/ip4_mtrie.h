@@ -161,6 +161,21 @@ void ip4_mtrie_8_route_del (ip4_mtrie_8_t *m, const ip4_address_t *dst_address,
 			    u32 dst_address_length, u32 adj_index,
 			    u32 cover_address_length, u32 cover_adj_index);
 
+/**
+ * @brief Count the plies a prefix may add to a trie. plies collects the
+ * plies already counted for the batch, hash_free it when done.
+ * @return the number of plies not counted before
+ */
+u32 ip4_mtrie_ply_count (uword **plies, const ip4_address_t *dst_address,
+			 u32 dst_address_length);
+
+/**
+ * @brief Make room for n_plies more plies in the ply pool. Growing the pool
+ * takes the worker barrier.
+ */
+u8 ip4_mtrie_ply_pool_will_expand (u32 n_plies);
+void ip4_mtrie_ply_pool_reserve (u32 n_plies);
+
 /**
  * @brief return the memory used by the table
  */
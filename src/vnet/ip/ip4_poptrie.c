@@ -0,0 +1,557 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2024 Cisco Systems, Inc.
+ */
+
+#include <vnet/ip/ip.h>
+#include <vnet/ip/ip4_poptrie.h>
+#include <vlib/rcu.h>
+#include <vppinfra/heap.h>
+
+/**
+ * Global heaps of nodes and leaves. Blocks are allocated per node, all the
+ * children of a node are contiguous, as are its leaves.
+ */
+ip4_poptrie_node_t *ip4_poptrie_nodes;
+u32 *ip4_poptrie_leaves;
+
+typedef struct ip4_poptrie_update_t_
+{
+  const ip4_poptrie_t *p;
+
+  /* host order address range changed by the update */
+  u32 lo, hi;
+
+  /* blocks to free once the new root is visible */
+  u32 *node_handles;
+  u32 *leaf_handles;
+} ip4_poptrie_update_t;
+
+static_always_inline u32
+ip4_poptrie_mask (u32 len)
+{
+  return len ? ~0 << (32 - len) : 0;
+}
+
+/* depth of the node a route of the given length is compiled into */
+static_always_inline u32
+ip4_poptrie_route_depth (u32 len)
+{
+  return len ? (len - 1) / 8 : 0;
+}
+
+static u32
+ip4_poptrie_node_alloc (u32 n_nodes, u32 *handle)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  u8 need_barrier_sync;
+  u32 index;
+
+  ASSERT (vm->thread_index == 0);
+
+  /* the heap's vector may move, workers must not be walking it */
+  need_barrier_sync = (vec_len (ip4_poptrie_nodes) + n_nodes >
+		       vec_max_len (ip4_poptrie_nodes));
+
+  if (need_barrier_sync)
+    vlib_worker_thread_barrier_sync (vm);
+
+  index = heap_alloc (ip4_poptrie_nodes, n_nodes, *handle);
+
+  if (need_barrier_sync)
+    vlib_worker_thread_barrier_release (vm);
+
+  return index;
+}
+
+static u32
+ip4_poptrie_leaf_alloc (u32 n_leaves, u32 *handle)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  u8 need_barrier_sync;
+  u32 index;
+
+  ASSERT (vm->thread_index == 0);
+
+  need_barrier_sync = (vec_len (ip4_poptrie_leaves) + n_leaves >
+		       vec_max_len (ip4_poptrie_leaves));
+
+  if (need_barrier_sync)
+    vlib_worker_thread_barrier_sync (vm);
+
+  index = heap_alloc (ip4_poptrie_leaves, n_leaves, *handle);
+
+  if (need_barrier_sync)
+    vlib_worker_thread_barrier_release (vm);
+
+  return index;
+}
+
+static_always_inline u32
+ip4_poptrie_node_n_children (const ip4_poptrie_node_t *n)
+{
+  return n->pre_vec[3] + count_set_bits (n->vector[3]);
+}
+
+static_always_inline u32
+ip4_poptrie_node_n_leaves (const ip4_poptrie_node_t *n)
+{
+  return n->pre_leaf[3] + count_set_bits (n->leafvec[3]);
+}
+
+static_always_inline u32
+ip4_poptrie_node_child (const ip4_poptrie_node_t *n, u8 slot)
+{
+  u8 w = slot >> 6;
+  u64 bit = 1ULL << (slot & 63);
+
+  if (!(n->vector[w] & bit))
+    return ~0;
+
+  return n->base1 + n->pre_vec[w] + count_set_bits (n->vector[w] & (bit - 1));
+}
+
+static void
+ip4_poptrie_node_release (ip4_poptrie_update_t *u, const ip4_poptrie_node_t *n)
+{
+  if (n->node_handle != ~0)
+    vec_add1 (u->node_handles, n->node_handle);
+  if (n->leaf_handle != ~0)
+    vec_add1 (u->leaf_handles, n->leaf_handle);
+}
+
+static void
+ip4_poptrie_subtree_release (ip4_poptrie_update_t *u, u32 index)
+{
+  ip4_poptrie_node_t *n = ip4_poptrie_nodes + index;
+  u32 i, n_children;
+
+  n_children = ip4_poptrie_node_n_children (n);
+
+  for (i = 0; i < n_children; i++)
+    ip4_poptrie_subtree_release (u, n->base1 + i);
+
+  ip4_poptrie_node_release (u, n);
+}
+
+/*
+ * Compile the node at the given depth covering base_address/8*depth. Its
+ * leaves are the routes of its stride painted, shortest first, over the
+ * leaf inherited from the parent. Children whose address range is untouched
+ * by the update are shared with the old node, the rest are compiled afresh.
+ * The node is returned by value since the node heap may move as children
+ * are allocated.
+ */
+static ip4_poptrie_node_t
+ip4_poptrie_compile (ip4_poptrie_update_t *u, u32 depth, u32 base_address,
+		     u32 old_index, index_t inherited)
+{
+  ip4_poptrie_node_t n = { .leaf_handle = ~0, .node_handle = ~0 };
+  const ip4_poptrie_t *p = u->p;
+  ip4_poptrie_route_t *routes = 0, *r;
+  index_t leaves[256], prev = ~0;
+  u8 leaf_len[256];
+  u32 i, k, n_leaves = 0, n_children = 0, shift = 24 - 8 * depth;
+  uword *h;
+
+  for (i = 0; i < ARRAY_LEN (leaves); i++)
+    {
+      leaves[i] = inherited;
+      leaf_len[i] = 0;
+    }
+
+  h = hash_get (p->routes_by_node[depth], base_address);
+  if (h)
+    routes = uword_to_pointer (h[0], ip4_poptrie_route_t *);
+
+  /* routes of the same length are disjoint, so the longest one wins */
+  vec_foreach (r, routes)
+    {
+      u32 first = (r->addr >> shift) & 0xff;
+      u32 last = first + (1 << (8 * (depth + 1) - r->len)) - 1;
+
+      for (i = first; i <= last; i++)
+	if (r->len >= leaf_len[i])
+	  {
+	    leaves[i] = r->lbi;
+	    leaf_len[i] = r->len;
+	  }
+    }
+
+  for (i = 0; i < ARRAY_LEN (leaves); i++)
+    {
+      if (depth < 3 &&
+	  hash_get (p->n_longer[depth], base_address | (i << shift)))
+	{
+	  n.vector[i >> 6] |= 1ULL << (i & 63);
+	  n_children++;
+	  prev = ~0;
+	}
+      else if (leaves[i] != prev)
+	{
+	  n.leafvec[i >> 6] |= 1ULL << (i & 63);
+	  n_leaves++;
+	  prev = leaves[i];
+	}
+    }
+
+  for (i = 1; i < 4; i++)
+    {
+      n.pre_vec[i] = n.pre_vec[i - 1] + count_set_bits (n.vector[i - 1]);
+      n.pre_leaf[i] = n.pre_leaf[i - 1] + count_set_bits (n.leafvec[i - 1]);
+    }
+
+  if (n_leaves)
+    {
+      n.base0 = ip4_poptrie_leaf_alloc (n_leaves, &n.leaf_handle);
+
+      for (i = 0, k = 0; i < ARRAY_LEN (leaves); i++)
+	if (n.leafvec[i >> 6] & (1ULL << (i & 63)))
+	  ip4_poptrie_leaves[n.base0 + k++] = leaves[i];
+    }
+
+  if (n_children)
+    {
+      n.base1 = ip4_poptrie_node_alloc (n_children, &n.node_handle);
+
+      for (i = 0, k = 0; i < ARRAY_LEN (leaves); i++)
+	{
+	  ip4_poptrie_node_t child;
+	  u32 old_child = ~0, lo, hi;
+
+	  if (!(n.vector[i >> 6] & (1ULL << (i & 63))))
+	    continue;
+
+	  lo = base_address + (i << shift);
+	  hi = lo + (1 << shift) - 1;
+
+	  if (old_index != ~0)
+	    old_child =
+	      ip4_poptrie_node_child (ip4_poptrie_nodes + old_index, i);
+
+	  if (old_child != ~0 && (lo > u->hi || hi < u->lo))
+	    child = ip4_poptrie_nodes[old_child];
+	  else
+	    child =
+	      ip4_poptrie_compile (u, depth + 1, lo, old_child, leaves[i]);
+
+	  ip4_poptrie_nodes[n.base1 + k++] = child;
+	}
+    }
+
+  if (old_index != ~0)
+    {
+      ip4_poptrie_node_t *old = ip4_poptrie_nodes + old_index;
+      u32 old_child;
+
+      /* children that collapsed into leaves */
+      for (i = 0; i < ARRAY_LEN (leaves); i++)
+	if (!(n.vector[i >> 6] & (1ULL << (i & 63))) &&
+	    (old_child = ip4_poptrie_node_child (old, i)) != ~0)
+	  ip4_poptrie_subtree_release (u, old_child);
+
+      ip4_poptrie_node_release (u, old);
+    }
+
+  return n;
+}
+
+static void
+ip4_poptrie_reclaim (void *data)
+{
+  ip4_poptrie_update_t *u = data;
+  u32 *h;
+
+  vec_foreach (h, u->node_handles)
+    heap_dealloc (ip4_poptrie_nodes, h[0]);
+  vec_foreach (h, u->leaf_handles)
+    heap_dealloc (ip4_poptrie_leaves, h[0]);
+
+  vec_free (u->node_handles);
+  vec_free (u->leaf_handles);
+  clib_mem_free (u);
+}
+
+/*
+ * Workers may still be walking the old nodes, free them after a grace
+ * period. Each update leaves a whole path of old nodes behind, and a
+ * CLI or API batch of updates may not return to the main loop for a
+ * long time, so reclaim what is already past its grace period here
+ * rather than let it pile up until then.
+ */
+static void
+ip4_poptrie_release_deferred (ip4_poptrie_update_t *u)
+{
+  ip4_poptrie_update_t *d;
+
+  if (!vec_len (u->node_handles) && !vec_len (u->leaf_handles))
+    return;
+
+  d = clib_mem_alloc (sizeof (*d));
+  clib_memcpy_fast (d, u, sizeof (*d));
+  vlib_rcu_call (ip4_poptrie_reclaim, d);
+  vlib_rcu_reclaim (vlib_get_main ());
+}
+
+static void
+ip4_poptrie_update (ip4_poptrie_t *p, u32 addr, u32 len)
+{
+  ip4_poptrie_update_t u = { .p = p };
+  ip4_poptrie_node_t root;
+  u32 index, handle;
+
+  u.lo = addr & ip4_poptrie_mask (len);
+  u.hi = u.lo | ~ip4_poptrie_mask (len);
+
+  /* slots no route covers forward to load-balance 0, drop */
+  root = ip4_poptrie_compile (&u, 0, 0, p->root, 0);
+
+  index = ip4_poptrie_node_alloc (1, &handle);
+  ip4_poptrie_nodes[index] = root;
+
+  if (p->root_handle != ~0)
+    vec_add1 (u.node_handles, p->root_handle);
+
+  clib_atomic_store_rel_n (&p->root, index);
+  p->root_handle = handle;
+
+  ip4_poptrie_release_deferred (&u);
+}
+
+void
+ip4_poptrie_init (ip4_poptrie_t *p)
+{
+  u32 i;
+
+  clib_memset (p, 0, sizeof (*p));
+
+  for (i = 0; i < ARRAY_LEN (p->routes_by_node); i++)
+    p->routes_by_node[i] = hash_create (0, sizeof (uword));
+  for (i = 0; i < ARRAY_LEN (p->n_longer); i++)
+    p->n_longer[i] = hash_create (0, sizeof (uword));
+
+  p->root = ~0;
+  p->root_handle = ~0;
+
+  /* compile the empty table */
+  ip4_poptrie_update (p, 0, 0);
+}
+
+void
+ip4_poptrie_free (ip4_poptrie_t *p)
+{
+  ip4_poptrie_update_t u = { .p = p };
+  uword key, value;
+  u32 i;
+
+  ip4_poptrie_subtree_release (&u, p->root);
+  vec_add1 (u.node_handles, p->root_handle);
+  ip4_poptrie_release_deferred (&u);
+
+  for (i = 0; i < ARRAY_LEN (p->routes_by_node); i++)
+    {
+      hash_foreach (key, value, p->routes_by_node[i], ({
+		      ip4_poptrie_route_t *routes;
+
+		      routes = uword_to_pointer (value, ip4_poptrie_route_t *);
+		      vec_free (routes);
+		    }));
+      hash_free (p->routes_by_node[i]);
+    }
+  for (i = 0; i < ARRAY_LEN (p->n_longer); i++)
+    hash_free (p->n_longer[i]);
+
+  p->root = ~0;
+  p->root_handle = ~0;
+  p->n_routes = 0;
+}
+
+static ip4_poptrie_route_t *
+ip4_poptrie_route_find (ip4_poptrie_t *p, u32 addr, u32 len,
+			ip4_poptrie_route_t **routesp)
+{
+  u32 depth = ip4_poptrie_route_depth (len);
+  ip4_poptrie_route_t *routes, *r;
+  uword *h;
+
+  h = hash_get (p->routes_by_node[depth], addr & ip4_poptrie_mask (8 * depth));
+  routes = h ? uword_to_pointer (h[0], ip4_poptrie_route_t *) : 0;
+
+  *routesp = routes;
+
+  vec_foreach (r, routes)
+    if (r->addr == addr && r->len == len)
+      return r;
+
+  return 0;
+}
+
+static void
+ip4_poptrie_n_longer_update (ip4_poptrie_t *p, u32 addr, u32 len, int delta)
+{
+  u32 d, key;
+  uword *h;
+
+  for (d = 0; d < ip4_poptrie_route_depth (len); d++)
+    {
+      key = addr & ip4_poptrie_mask (8 * (d + 1));
+      h = hash_get (p->n_longer[d], key);
+
+      if (!h)
+	hash_set (p->n_longer[d], key, delta);
+      else if (h[0] + delta)
+	h[0] += delta;
+      else
+	hash_unset (p->n_longer[d], key);
+    }
+}
+
+void
+ip4_poptrie_route_add (ip4_poptrie_t *p, const ip4_address_t *dst_address,
+		       u32 dst_address_length, u32 adj_index)
+{
+  u32 len = dst_address_length, depth = ip4_poptrie_route_depth (len);
+  u32 addr = clib_net_to_host_u32 (dst_address->as_u32) &
+	     ip4_poptrie_mask (len);
+  ip4_poptrie_route_t *routes, *r, route = {
+    .addr = addr,
+    .len = len,
+    .lbi = adj_index,
+  };
+
+  r = ip4_poptrie_route_find (p, addr, len, &routes);
+
+  if (r)
+    r->lbi = adj_index;
+  else
+    {
+      vec_add1 (routes, route);
+      hash_set (p->routes_by_node[depth], addr & ip4_poptrie_mask (8 * depth),
+		pointer_to_uword (routes));
+      ip4_poptrie_n_longer_update (p, addr, len, 1);
+      p->n_routes++;
+    }
+
+  ip4_poptrie_update (p, addr, len);
+}
+
+void
+ip4_poptrie_route_del (ip4_poptrie_t *p, const ip4_address_t *dst_address,
+		       u32 dst_address_length)
+{
+  u32 len = dst_address_length, depth = ip4_poptrie_route_depth (len);
+  u32 addr = clib_net_to_host_u32 (dst_address->as_u32) &
+	     ip4_poptrie_mask (len);
+  ip4_poptrie_route_t *routes, *r;
+
+  r = ip4_poptrie_route_find (p, addr, len, &routes);
+
+  if (!r)
+    return;
+
+  vec_del1 (routes, r - routes);
+  if (vec_len (routes))
+    hash_set (p->routes_by_node[depth], addr & ip4_poptrie_mask (8 * depth),
+	      pointer_to_uword (routes));
+  else
+    {
+      hash_unset (p->routes_by_node[depth],
+		  addr & ip4_poptrie_mask (8 * depth));
+      vec_free (routes);
+    }
+  ip4_poptrie_n_longer_update (p, addr, len, -1);
+  p->n_routes--;
+
+  ip4_poptrie_update (p, addr, len);
+}
+
+static void
+ip4_poptrie_subtree_count (u32 index, uword *n_nodes, uword *n_leaves)
+{
+  ip4_poptrie_node_t *n = ip4_poptrie_nodes + index;
+  u32 i, n_children = ip4_poptrie_node_n_children (n);
+
+  *n_nodes += 1;
+  *n_leaves += ip4_poptrie_node_n_leaves (n);
+
+  for (i = 0; i < n_children; i++)
+    ip4_poptrie_subtree_count (n->base1 + i, n_nodes, n_leaves);
+}
+
+static uword
+ip4_poptrie_compiled_memory_usage (ip4_poptrie_t *p)
+{
+  uword n_nodes = 0, n_leaves = 0;
+
+  ip4_poptrie_subtree_count (p->root, &n_nodes, &n_leaves);
+
+  return (n_nodes * sizeof (ip4_poptrie_node_t) +
+	  n_leaves * sizeof (ip4_poptrie_leaves[0]));
+}
+
+static uword
+ip4_poptrie_control_plane_memory_usage (ip4_poptrie_t *p)
+{
+  uword bytes = 0, key, value;
+  u32 i;
+
+  for (i = 0; i < ARRAY_LEN (p->routes_by_node); i++)
+    {
+      bytes += hash_bytes (p->routes_by_node[i]);
+      hash_foreach (key, value, p->routes_by_node[i], ({
+		      ip4_poptrie_route_t *routes;
+
+		      routes = uword_to_pointer (value, ip4_poptrie_route_t *);
+		      bytes += vec_mem_size (routes);
+		    }));
+    }
+  for (i = 0; i < ARRAY_LEN (p->n_longer); i++)
+    bytes += hash_bytes (p->n_longer[i]);
+
+  return bytes;
+}
+
+uword
+ip4_poptrie_memory_usage (ip4_poptrie_t *p)
+{
+  return (sizeof (*p) + ip4_poptrie_compiled_memory_usage (p) +
+	  ip4_poptrie_control_plane_memory_usage (p));
+}
+
+u8 *
+format_ip4_poptrie (u8 *s, va_list *va)
+{
+  ip4_poptrie_t *p = va_arg (*va, ip4_poptrie_t *);
+  int __clib_unused verbose = va_arg (*va, int);
+  uword n_nodes = 0, n_leaves = 0;
+  u32 indent = format_get_indent (s);
+
+  ip4_poptrie_subtree_count (p->root, &n_nodes, &n_leaves);
+
+  s = format (s, "poptrie 8-8-8-8; %d nodes, %d leaves, memory usage %U",
+	      n_nodes, n_leaves, format_memory_size,
+	      ip4_poptrie_compiled_memory_usage (p));
+  s = format (s, "\n%Ucontrol-plane: %d routes, memory usage %U",
+	      format_white_space, indent, p->n_routes, format_memory_size,
+	      ip4_poptrie_control_plane_memory_usage (p));
+
+  return s;
+}
+
+static clib_error_t *
+ip4_poptrie_module_init (vlib_main_t *vm)
+{
+  heap_new (ip4_poptrie_nodes);
+  heap_new (ip4_poptrie_leaves);
+
+  return (NULL);
+}
+
+VLIB_INIT_FUNCTION (ip4_poptrie_module_init);
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,173 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2024 Cisco Systems, Inc.
+ */
+
+#ifndef included_ip_ip4_poptrie_h
+#define included_ip_ip4_poptrie_h
+
+#include <vnet/ip/ip4_packet.h>
+#include <vnet/dpo/dpo.h>
+
+/**
+ * @brief ip4 poptrie lookup engine.
+ *
+ * A compressed multibit trie with an 8-8-8-8 stride. Each node replaces
+ * the 256 slot array of an mtrie ply with two 256 bit bitmaps: one marks
+ * the slots that descend to a child node, the other marks the slots that
+ * start a new run of identical leaves. Children and leaves are stored in
+ * contiguous blocks and indexed by counting the set bits below the slot,
+ * so a node costs 88 bytes plus 4 bytes per distinct leaf run instead of
+ * the 1.3KB of a ply.
+ *
+ * The control plane keeps the routes grouped by the node whose stride
+ * holds their length, so a node is compiled from its own routes and the
+ * leaf it inherits from its parent. After each update only the nodes whose
+ * address range overlaps the changed prefix are rebuilt, the new path is
+ * published by swapping the root index and the replaced blocks are freed
+ * once the workers are done with them.
+ */
+typedef struct ip4_poptrie_node_t_
+{
+  /** bit set: slot descends to a child node */
+  u64 vector[4];
+
+  /** bit set: slot is a leaf which starts a new run of leaves */
+  u64 leafvec[4];
+
+  /** index of the first leaf in the leaf heap */
+  u32 base0;
+
+  /** index of the first child in the node heap */
+  u32 base1;
+
+  /** number of children/leaf runs in the preceding words of the bitmaps */
+  u8 pre_vec[4];
+  u8 pre_leaf[4];
+
+  /** heap handles of the leaf and child blocks, ~0 if empty */
+  u32 leaf_handle;
+  u32 node_handle;
+} ip4_poptrie_node_t;
+
+/**
+ * @brief A route, as kept by the control plane
+ */
+typedef struct ip4_poptrie_route_t_
+{
+  /** host order, masked */
+  u32 addr;
+  u32 len;
+  index_t lbi;
+} ip4_poptrie_route_t;
+
+typedef struct
+{
+  /** heap index of the root node; the only field the data-plane reads */
+  u32 root;
+
+  /** heap handle of the root node */
+  u32 root_handle;
+
+  /**
+   * Routes of length 8d+1 to 8d+8 (and 0 for d = 0), keyed by the /8d
+   * prefix of the depth d node they are compiled into. Values are vectors.
+   */
+  uword *routes_by_node[4];
+
+  /**
+   * Number of routes longer than /8(d+1) below each /8(d+1) prefix; the
+   * slots of a depth d node with a count are children.
+   */
+  uword *n_longer[3];
+
+  u32 n_routes;
+} ip4_poptrie_t;
+
+/**
+ * @brief Initialise a poptrie
+ */
+void ip4_poptrie_init (ip4_poptrie_t *p);
+
+/**
+ * @brief Free a poptrie and its routes
+ */
+void ip4_poptrie_free (ip4_poptrie_t *p);
+
+/**
+ * @brief Add a route/entry to the poptrie
+ */
+void ip4_poptrie_route_add (ip4_poptrie_t *p, const ip4_address_t *dst_address,
+			    u32 dst_address_length, u32 adj_index);
+
+/**
+ * @brief remove a route/entry from the poptrie
+ */
+void ip4_poptrie_route_del (ip4_poptrie_t *p, const ip4_address_t *dst_address,
+			    u32 dst_address_length);
+
+/**
+ * @brief return the memory used by the table, compiled and control-plane
+ */
+uword ip4_poptrie_memory_usage (ip4_poptrie_t *p);
+
+/**
+ * @brief Format/display the contents of the poptrie
+ */
+format_function_t format_ip4_poptrie;
+
+/**
+ * @brief Global heaps of nodes and leaves shared by all poptries
+ */
+extern ip4_poptrie_node_t *ip4_poptrie_nodes;
+extern u32 *ip4_poptrie_leaves;
+
+always_inline index_t
+ip4_poptrie_node_leaf (const ip4_poptrie_node_t *n, u8 w, u64 bit)
+{
+  /* the slot's leaf is the last run started at or below the slot */
+  return ip4_poptrie_leaves[n->base0 + n->pre_leaf[w] +
+			    count_set_bits (n->leafvec[w] & ((bit << 1) - 1)) -
+			    1];
+}
+
+/**
+ * @brief Lookup the LB index of the longest prefix matching the address
+ */
+always_inline index_t
+ip4_poptrie_lookup (const ip4_poptrie_t *p, const ip4_address_t *dst)
+{
+  const ip4_poptrie_node_t *n;
+  u64 bit, vec;
+  u8 v, w;
+  int i;
+
+  n = ip4_poptrie_nodes + p->root;
+
+  for (i = 0; i < 3; i++)
+    {
+      v = dst->as_u8[i];
+      w = v >> 6;
+      bit = 1ULL << (v & 63);
+      vec = n->vector[w];
+
+      if (!(vec & bit))
+	return ip4_poptrie_node_leaf (n, w, bit);
+
+      n = ip4_poptrie_nodes + n->base1 + n->pre_vec[w] +
+	  count_set_bits (vec & (bit - 1));
+    }
+
+  /* the last stride has no children */
+  v = dst->as_u8[3];
+  return ip4_poptrie_node_leaf (n, v >> 6, 1ULL << (v & 63));
+}
+
+#endif /* included_ip_ip4_poptrie_h */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -29,6 +29,7 @@
 #include <vnet/ip/ip_punt_drop.h>
 #include <vnet/ip/ip_types_api.h>
 #include <vnet/ip/ip_path_mtu.h>
+#include <vnet/ip/ip4_mtrie.h>
 #include <vnet/fib/fib_table.h>
 #include <vnet/fib/fib_api.h>
 #include <vnet/ethernet/arp_packet.h>
@@ -807,6 +808,85 @@ vl_api_ip_route_add_del_v2_t_handler (vl_api_ip_route_add_del_v2_t *mp)
   /* clang-format on */
 }
 
+typedef struct
+{
+  fib_prefix_t pfx;
+  fib_route_path_t rpath;
+  fib_entry_flag_t entry_flags;
+  u32 fib_index;
+} ip_route_bulk_entry_t;
+
+void
+vl_api_ip_route_add_del_bulk_t_handler (vl_api_ip_route_add_del_bulk_t *mp)
+{
+  vl_api_ip_route_add_del_bulk_reply_t *rmp;
+  ip_route_bulk_entry_t *routes = 0, *r;
+  fib_route_path_t *rpaths = 0;
+  u32 n_routes = ntohl (mp->n_routes);
+  u32 table_id = ntohl (mp->table_id);
+  u32 n_done = 0, ii;
+  f64 t0, rate = 0;
+  int rv = 0;
+
+  /* decode everything before touching the tables */
+  if (0 != n_routes)
+    vec_validate (routes, n_routes - 1);
+
+  for (ii = 0; ii < n_routes; ii++)
+    {
+      r = &routes[ii];
+      ip_prefix_decode (&mp->routes[ii].prefix, &r->pfx);
+      rv = fib_api_table_id_decode (r->pfx.fp_proto, table_id, &r->fib_index);
+      if (0 != rv)
+	goto out;
+      rv = fib_api_path_decode (&mp->routes[ii].path, &r->rpath);
+      if (0 != rv)
+	goto out;
+      r->entry_flags = FIB_ENTRY_FLAG_NONE;
+      if ((r->rpath.frp_flags & FIB_ROUTE_PATH_LOCAL) &&
+	  (~0 == r->rpath.frp_sw_if_index))
+	r->entry_flags = (FIB_ENTRY_FLAG_CONNECTED | FIB_ENTRY_FLAG_LOCAL);
+    }
+
+  t0 = vlib_time_now (vlib_get_main ());
+  if (mp->is_add)
+    {
+      uword *plies = 0;
+      u32 n_plies = 0;
+
+      vec_foreach (r, routes)
+	if (FIB_PROTOCOL_IP4 == r->pfx.fp_proto)
+	  n_plies += ip4_mtrie_ply_count (&plies, &r->pfx.fp_addr.ip4,
+					  r->pfx.fp_len);
+      hash_free (plies);
+      fib_table_entry_reserve (n_routes, n_plies);
+    }
+
+  vec_validate (rpaths, 0);
+  vec_foreach (r, routes)
+    {
+      rpaths[0] = r->rpath;
+      rv = fib_api_route_add_del (mp->is_add, mp->is_multipath, r->fib_index,
+				  &r->pfx, FIB_SOURCE_API, r->entry_flags,
+				  rpaths);
+      if (0 != rv)
+	break;
+      n_done++;
+    }
+
+  if (n_done)
+    rate = n_done / clib_max (vlib_time_now (vlib_get_main ()) - t0, 1e-9);
+
+out:
+  vec_free (rpaths);
+  vec_free (routes);
+
+  REPLY_MACRO2 (VL_API_IP_ROUTE_ADD_DEL_BULK_REPLY, {
+    rmp->n_routes = htonl (n_done);
+    rmp->routes_per_sec = clib_host_to_net_f64 (rate);
+  })
+}
+
 void
 vl_api_ip_route_lookup_t_handler (vl_api_ip_route_lookup_t * mp)
 {
@@ -2148,6 +2228,10 @@ ip_api_hookup (vlib_main_t * vm)
     am, REPLY_MSG_ID_BASE + VL_API_IP_ROUTE_ADD_DEL_V2, 1);
   vl_api_set_msg_thread_safe (
     am, REPLY_MSG_ID_BASE + VL_API_IP_ROUTE_ADD_DEL_V2_REPLY, 1);
+  vl_api_set_msg_thread_safe (
+    am, REPLY_MSG_ID_BASE + VL_API_IP_ROUTE_ADD_DEL_BULK, 1);
+  vl_api_set_msg_thread_safe (
+    am, REPLY_MSG_ID_BASE + VL_API_IP_ROUTE_ADD_DEL_BULK_REPLY, 1);
 
   return 0;
 }
@@ -365,6 +365,21 @@ vnet_ip_route_cmd (vlib_main_t * vm,
 	  f64 t[2];
 	  n = count;
 	  t[0] = vlib_time_now (vm);
+	  if (!is_del && n > 1)
+	    {
+	      fib_prefix_t pfx = prefixs[i];
+	      uword *plies = 0;
+	      u32 n_plies = 0;
+
+	      for (k = 0; FIB_PROTOCOL_IP4 == pfx.fp_proto && k < n; k++)
+		{
+		  n_plies += ip4_mtrie_ply_count (&plies, &pfx.fp_addr.ip4,
+						  pfx.fp_len);
+		  fib_prefix_increment (&pfx);
+		}
+	      hash_free (plies);
+	      fib_table_entry_reserve (n, n_plies);
+	    }
 
 	  for (k = 0; k < n; k++)
 	    {
@@ -115,6 +115,48 @@ esp_seq_advance (ipsec_sa_t * sa)
   return 0;
 }
 
+/*
+ * The sequence number of an SA shared by all workers, taken from the
+ * thread's block of numbers. A new block is reserved from the SA under
+ * its lock when this one ran out or fell too far behind.
+ */
+always_inline int
+esp_seq_advance_shared (ipsec_sa_t *sa, ipsec_sa_seq_block_t *blk, u32 *seq,
+			u32 *seq_hi)
+{
+  int esn = ipsec_sa_is_set_USE_ESN (sa);
+  u64 last, n;
+
+  last = esn ? (u64) sa->seq_hi << 32 | sa->seq : sa->seq;
+  if (PREDICT_FALSE (blk->n_left == 0 ||
+		     last + 1 - blk->next > IPSEC_SA_SEQ_BLOCK_MAX_LAG))
+    {
+      clib_spinlock_lock (&sa->shard_lock);
+      last = esn ? (u64) sa->seq_hi << 32 | sa->seq : sa->seq;
+      n = IPSEC_SA_SEQ_BLOCK_SIZE;
+      if (ipsec_sa_is_set_USE_ANTI_REPLAY (sa))
+	n = clib_min (n, (esn ? ~0ULL : ESP_SEQ_MAX) - last);
+      if (PREDICT_FALSE (n == 0))
+	{
+	  clib_spinlock_unlock (&sa->shard_lock);
+	  return 1;
+	}
+      blk->next = last + 1;
+      blk->n_left = n;
+      last += n;
+      sa->seq = last;
+      if (esn)
+	sa->seq_hi = last >> 32;
+      clib_spinlock_unlock (&sa->shard_lock);
+    }
+
+  *seq = blk->next;
+  *seq_hi = esn ? blk->next >> 32 : sa->seq_hi;
+  blk->next++;
+  blk->n_left--;
+  return 0;
+}
+
 always_inline u16
 esp_aad_fill (u8 *data, const esp_header_t *esp, const ipsec_sa_t *sa,
 	      u32 seq_hi)
@@ -782,7 +782,9 @@ esp_decrypt_post_crypto (vlib_main_t *vm, vlib_node_runtime_t *node,
   const u8 tun_flags = IPSEC_SA_FLAG_IS_TUNNEL | IPSEC_SA_FLAG_IS_TUNNEL_V6;
   u8 pad_length = 0, next_header = 0;
   u16 icv_sz;
-  u64 n_lost;
+  u64 n_lost = 0;
+  int shared = ipsec_sa_is_shared (sa0);
+  bool replayed;
 
   /*
    * redo the anti-reply check
@@ -806,31 +808,36 @@ esp_decrypt_post_crypto (vlib_main_t *vm, vlib_node_runtime_t *node,
    * a sequence s, s+1, s+2, s+3, ... s+n and nothing will prevent any
    * implementation, sequential or batching, from decrypting these.
    */
+  /* workers sharing the SA check and advance its window one at a time */
+  if (PREDICT_FALSE (shared))
+    clib_spinlock_lock (&sa0->shard_lock);
+
   if (PREDICT_FALSE (ipsec_sa_is_set_ANTI_REPLAY_HUGE (sa0)))
     {
-      if (ipsec_sa_anti_replay_and_sn_advance (sa0, pd->seq, pd->seq_hi, true,
-					       NULL, true))
-	{
-	  esp_decrypt_set_next_index (b, node, vm->thread_index,
-				      ESP_DECRYPT_ERROR_REPLAY, 0, next,
-				      ESP_DECRYPT_NEXT_DROP, pd->sa_index);
-	  return;
-	}
-      n_lost = ipsec_sa_anti_replay_advance (sa0, vm->thread_index, pd->seq,
-					     pd->seq_hi, true);
+      replayed = ipsec_sa_anti_replay_and_sn_advance (
+	sa0, pd->seq, pd->seq_hi, true, NULL, true);
+      if (!replayed)
+	n_lost = ipsec_sa_anti_replay_advance (sa0, vm->thread_index, pd->seq,
+					       pd->seq_hi, true);
     }
   else
     {
-      if (ipsec_sa_anti_replay_and_sn_advance (sa0, pd->seq, pd->seq_hi, true,
-					       NULL, false))
-	{
-	  esp_decrypt_set_next_index (b, node, vm->thread_index,
-				      ESP_DECRYPT_ERROR_REPLAY, 0, next,
-				      ESP_DECRYPT_NEXT_DROP, pd->sa_index);
-	  return;
-	}
-      n_lost = ipsec_sa_anti_replay_advance (sa0, vm->thread_index, pd->seq,
-					     pd->seq_hi, false);
+      replayed = ipsec_sa_anti_replay_and_sn_advance (
+	sa0, pd->seq, pd->seq_hi, true, NULL, false);
+      if (!replayed)
+	n_lost = ipsec_sa_anti_replay_advance (sa0, vm->thread_index, pd->seq,
+					       pd->seq_hi, false);
+    }
+
+  if (PREDICT_FALSE (shared))
+    clib_spinlock_unlock (&sa0->shard_lock);
+
+  if (replayed)
+    {
+      esp_decrypt_set_next_index (b, node, vm->thread_index,
+				  ESP_DECRYPT_ERROR_REPLAY, 0, next,
+				  ESP_DECRYPT_NEXT_DROP, pd->sa_index);
+      return;
     }
 
   vlib_prefetch_simple_counter (&ipsec_sa_err_counters[IPSEC_SA_ERROR_LOST],
@@ -1178,7 +1185,8 @@ esp_decrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 				    ipsec_sa_assign_thread (thread_index));
 	}
 
-      if (PREDICT_FALSE (thread_index != sa0->thread_index))
+      if (PREDICT_FALSE (thread_index != sa0->thread_index) &&
+	  !ipsec_sa_is_shared (sa0))
 	{
 	  vnet_buffer (b[0])->ipsec.thread_index = sa0->thread_index;
 	  err = ESP_DECRYPT_ERROR_HANDOFF;
@@ -26,6 +26,7 @@
 #include <vnet/ipsec/ipsec.api_enum.h>
 #include <vnet/ipsec/esp.h>
 #include <vnet/tunnel/tunnel_dp.h>
+#include <vnet/gso/gso.h>
 
 #define foreach_esp_encrypt_next                                              \
   _ (DROP4, "ip4-drop")                                                       \
@@ -225,12 +226,20 @@ esp_get_ip6_hdr_len (ip6_header_t * ip6, ip6_ext_header_t ** ext_hdr)
  * message. You can refer to NIST SP800-38a and NIST SP800-38d for more
  * details. */
 static_always_inline void *
-esp_generate_iv (ipsec_sa_t *sa, void *payload, int iv_sz)
+esp_generate_iv (ipsec_per_thread_data_t *ptd, ipsec_sa_t *sa, void *payload,
+		 int iv_sz, esp_header_t *esp, u32 seq_hi)
 {
   ASSERT (iv_sz >= sizeof (u64));
   u64 *iv = (u64 *) (payload - iv_sz);
   clib_memset_u8 (iv, 0, iv_sz);
-  *iv = clib_pcg64i_random_r (&sa->iv_prng);
+  if (PREDICT_TRUE (!ipsec_sa_is_shared (sa)))
+    *iv = clib_pcg64i_random_r (&sa->iv_prng);
+  else if (ipsec_sa_is_set_IS_CTR (sa))
+    /* the workers do not share a generator, yet a counter mode IV must not
+     * repeat under a key, so use the sequence number, unique per packet */
+    *iv = (u64) seq_hi << 32 | clib_net_to_host_u32 (esp->seq);
+  else
+    *iv = clib_pcg64i_random_r (&ptd->iv_prng);
   return iv;
 }
 
@@ -336,7 +345,7 @@ static_always_inline u32
 esp_encrypt_chain_integ (vlib_main_t * vm, ipsec_per_thread_data_t * ptd,
 			 ipsec_sa_t * sa0, vlib_buffer_t * b,
 			 vlib_buffer_t * lb, u8 icv_sz, u8 * start,
-			 u32 start_len, u8 * digest, u16 * n_ch)
+			 u32 start_len, u8 * digest, u32 seq_hi, u16 * n_ch)
 {
   vnet_crypto_op_chunk_t *ch;
   vlib_buffer_t *cb = b;
@@ -356,8 +365,8 @@ esp_encrypt_chain_integ (vlib_main_t * vm, ipsec_per_thread_data_t * ptd,
 	  total_len += ch->len = cb->current_length - icv_sz;
 	  if (ipsec_sa_is_set_USE_ESN (sa0))
 	    {
-	      u32 seq_hi = clib_net_to_host_u32 (sa0->seq_hi);
-	      clib_memcpy_fast (digest, &seq_hi, sizeof (seq_hi));
+	      u32 tmp = clib_net_to_host_u32 (seq_hi);
+	      clib_memcpy_fast (digest, &tmp, sizeof (seq_hi));
 	      ch->len += sizeof (seq_hi);
 	      total_len += sizeof (seq_hi);
 	    }
@@ -398,7 +407,7 @@ esp_prepare_sync_op (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
       u16 crypto_len = payload_len - icv_sz;
 
       /* generate the IV in front of the payload */
-      void *pkt_iv = esp_generate_iv (sa0, payload, iv_sz);
+      void *pkt_iv = esp_generate_iv (ptd, sa0, payload, iv_sz, esp, seq_hi);
 
       op->key_index = sa0->crypto_key_index;
       op->user_data = bi;
@@ -481,7 +490,7 @@ esp_prepare_sync_op (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 	  esp_encrypt_chain_integ (vm, ptd, sa0, b[0], lb, icv_sz,
 				   payload - iv_sz - sizeof (esp_header_t),
 				   payload_len + iv_sz +
-				   sizeof (esp_header_t), op->digest,
+				   sizeof (esp_header_t), op->digest, seq_hi,
 				   &op->n_chunks);
 	}
       else if (ipsec_sa_is_set_USE_ESN (sa0))
@@ -496,7 +505,8 @@ esp_prepare_sync_op (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 static_always_inline void
 esp_prepare_async_frame (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 			 vnet_crypto_async_frame_t *async_frame,
-			 ipsec_sa_t *sa, vlib_buffer_t *b, esp_header_t *esp,
+			 ipsec_sa_t *sa, u32 seq_hi, vlib_buffer_t *b,
+			 esp_header_t *esp,
 			 u8 *payload, u32 payload_len, u8 iv_sz, u8 icv_sz,
 			 u32 bi, u16 next, u32 hdr_len, u16 async_next,
 			 vlib_buffer_t *lb)
@@ -516,7 +526,7 @@ esp_prepare_async_frame (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
   tag = payload + crypto_total_len;
 
   /* generate the IV in front of the payload */
-  void *pkt_iv = esp_generate_iv (sa, payload, iv_sz);
+  void *pkt_iv = esp_generate_iv (ptd, sa, payload, iv_sz, esp, seq_hi);
 
   if (ipsec_sa_is_set_IS_CTR (sa))
     {
@@ -527,7 +537,7 @@ esp_prepare_async_frame (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 	{
 	  /* constuct aad in a scratch space in front of the nonce */
 	  aad = (u8 *) nonce - sizeof (esp_aead_t);
-	  esp_aad_fill (aad, esp, sa, sa->seq_hi);
+	  esp_aad_fill (aad, esp, sa, seq_hi);
 	  if (PREDICT_FALSE (ipsec_sa_is_set_IS_NULL_GMAC (sa)))
 	    {
 	      /* RFC-4543 ENCR_NULL_AUTH_AES_GMAC: IV is part of AAD */
@@ -574,12 +584,12 @@ esp_prepare_async_frame (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 	  integ_total_len = esp_encrypt_chain_integ (
 	    vm, ptd, sa, b, lb, icv_sz,
 	    payload - iv_sz - sizeof (esp_header_t),
-	    payload_len + iv_sz + sizeof (esp_header_t), tag, 0);
+	    payload_len + iv_sz + sizeof (esp_header_t), tag, seq_hi, 0);
 	}
       else if (ipsec_sa_is_set_USE_ESN (sa))
 	{
-	  u32 seq_hi = clib_net_to_host_u32 (sa->seq_hi);
-	  clib_memcpy_fast (tag, &seq_hi, sizeof (seq_hi));
+	  u32 tmp = clib_net_to_host_u32 (seq_hi);
+	  clib_memcpy_fast (tag, &tmp, sizeof (seq_hi));
 	  integ_total_len += sizeof (seq_hi);
 	}
     }
@@ -591,15 +601,14 @@ esp_prepare_async_frame (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 				  async_next, iv, tag, aad, flag);
 }
 
-always_inline uword
-esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
-		    vlib_frame_t *frame, vnet_link_t lt, int is_tun,
-		    u16 async_next_node)
+always_inline void
+esp_encrypt_vectors (vlib_main_t *vm, vlib_node_runtime_t *node, u32 *from,
+		     u32 n_vectors, vnet_link_t lt, int is_tun,
+		     u16 async_next_node)
 {
   ipsec_main_t *im = &ipsec_main;
   ipsec_per_thread_data_t *ptd = vec_elt_at_index (im->ptd, vm->thread_index);
-  u32 *from = vlib_frame_vector_args (frame);
-  u32 n_left = frame->n_vectors;
+  u32 n_left = n_vectors;
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
   u32 thread_index = vm->thread_index;
   u16 buffer_data_size = vlib_buffer_get_default_data_size (vm);
@@ -647,7 +656,7 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
       esp_header_t *esp;
       u8 *payload, *next_hdr_ptr;
       u16 payload_len, payload_len_total, n_bufs;
-      u32 hdr_len;
+      u32 hdr_len, seq = 0, seq_hi = 0;
 
       err = ESP_ENCRYPT_ERROR_RX_PKTS;
 
@@ -727,7 +736,8 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 				    ipsec_sa_assign_thread (thread_index));
 	}
 
-      if (PREDICT_FALSE (thread_index != sa0->thread_index))
+      if (PREDICT_FALSE (thread_index != sa0->thread_index) &&
+	  !ipsec_sa_is_shared (sa0))
 	{
 	  vnet_buffer (b[0])->ipsec.thread_index = sa0->thread_index;
 	  err = ESP_ENCRYPT_ERROR_HANDOFF;
@@ -754,9 +764,23 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	    lb = vlib_get_buffer (vm, lb->next_buffer);
 	}
 
-      if (PREDICT_FALSE (esp_seq_advance (sa0)))
+      if (PREDICT_TRUE (!ipsec_sa_is_shared (sa0)))
+	{
+	  if (PREDICT_FALSE (esp_seq_advance (sa0)))
+	    err = ESP_ENCRYPT_ERROR_SEQ_CYCLED;
+	  seq = sa0->seq;
+	  seq_hi = sa0->seq_hi;
+	}
+      else
+	{
+	  vec_validate (ptd->seq_blocks, sa_index0);
+	  if (PREDICT_FALSE (esp_seq_advance_shared (
+		sa0, ptd->seq_blocks + sa_index0, &seq, &seq_hi)))
+	    err = ESP_ENCRYPT_ERROR_SEQ_CYCLED;
+	}
+
+      if (PREDICT_FALSE (err == ESP_ENCRYPT_ERROR_SEQ_CYCLED))
 	{
-	  err = ESP_ENCRYPT_ERROR_SEQ_CYCLED;
 	  esp_encrypt_set_next_index (b[0], node, thread_index, err, n_noop,
 				      noop_nexts, drop_next, current_sa_index);
 	  goto trace;
@@ -1001,7 +1025,7 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	}
 
       esp->spi = spi;
-      esp->seq = clib_net_to_host_u32 (sa0->seq);
+      esp->seq = clib_net_to_host_u32 (seq);
 
       if (is_async)
 	{
@@ -1028,13 +1052,13 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	      vec_add1 (ptd->async_frames, async_frames[async_op]);
 	    }
 
-	  esp_prepare_async_frame (vm, ptd, async_frames[async_op], sa0, b[0],
-				   esp, payload, payload_len, iv_sz, icv_sz,
-				   from[b - bufs], sync_next[0], hdr_len,
-				   async_next_node, lb);
+	  esp_prepare_async_frame (vm, ptd, async_frames[async_op], sa0,
+				   seq_hi, b[0], esp, payload, payload_len,
+				   iv_sz, icv_sz, from[b - bufs], sync_next[0],
+				   hdr_len, async_next_node, lb);
 	}
       else
-	esp_prepare_sync_op (vm, ptd, crypto_ops, integ_ops, sa0, sa0->seq_hi,
+	esp_prepare_sync_op (vm, ptd, crypto_ops, integ_ops, sa0, seq_hi,
 			     payload, payload_len, iv_sz, icv_sz, n_sync, b,
 			     lb, hdr_len, esp);
 
@@ -1054,8 +1078,8 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	    {
 	      tr->sa_index = sa_index0;
 	      tr->spi = sa0->spi;
-	      tr->seq = sa0->seq;
-	      tr->sa_seq_hi = sa0->seq_hi;
+	      tr->seq = seq;
+	      tr->sa_seq_hi = seq_hi;
 	      tr->udp_encap = ipsec_sa_is_set_UDP_ENCAP (sa0);
 	      tr->crypto_alg = sa0->crypto_alg;
 	      tr->integ_alg = sa0->integ_alg;
@@ -1123,7 +1147,142 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
     vlib_buffer_enqueue_to_next (vm, node, noop_bi, noop_nexts, n_noop);
 
   vlib_node_increment_counter (vm, node->node_index, ESP_ENCRYPT_ERROR_RX_PKTS,
-			       frame->n_vectors);
+			       n_vectors);
+}
+
+/*
+ * Segment the GSO packets of a frame here rather than in the gso node, so
+ * the segments get their sequence numbers, IVs and crypto ops in the same
+ * batch as the rest of the frame. Returns the buffers to encrypt, with the
+ * segments in place of their packet. A GSO packet is never encrypted
+ * whole: one that cannot be segmented, such as one under an MPLS label
+ * stack, is dropped.
+ */
+static_always_inline u32 *
+esp_encrypt_gso_segment (vlib_main_t *vm, vlib_node_runtime_t *node,
+			 ipsec_per_thread_data_t *ptd, u32 *from,
+			 u32 n_vectors, vnet_link_t lt, int is_tun)
+{
+  vnet_interface_main_t *vim = &vnet_get_main ()->interface_main;
+  vnet_interface_per_thread_data_t *iptd =
+    vec_elt_at_index (vim->per_thread_data, vm->thread_index);
+  int is_ip6 = lt == VNET_LINK_IP6;
+  u16 drop_next =
+    (lt == VNET_LINK_IP6 ? ESP_ENCRYPT_NEXT_DROP6 :
+			   (lt == VNET_LINK_IP4 ? ESP_ENCRYPT_NEXT_DROP4 :
+						  ESP_ENCRYPT_NEXT_DROP_MPLS));
+  u32 n_segments = 0, *bi, i;
+
+  vec_reset_length (ptd->gso_buffers);
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, from[i]), *sb;
+      generic_header_offset_t gho = { 0 };
+      u16 rewrite_len, l2_len;
+      int inner_is_ip6 = is_ip6;
+      u32 err;
+
+      if (!(b->flags & VNET_BUFFER_F_GSO))
+	{
+	  vec_add1 (ptd->gso_buffers, from[i]);
+	  continue;
+	}
+
+      /*
+       * Off the tunnel arc the L2 rewrite sits in front of the IP header
+       * and is copied into each ESP packet, so segment it along.
+       */
+      rewrite_len = vnet_buffer (b)->ip.save_rewrite_length;
+      l2_len = is_tun ? 0 : rewrite_len;
+      vnet_buffer (b)->ip.save_rewrite_length = l2_len;
+      vlib_buffer_advance (b, -l2_len);
+
+      if (lt == VNET_LINK_MPLS)
+	{
+	  err = ESP_ENCRYPT_ERROR_GSO_UNHANDLED_TYPE;
+	  goto drop;
+	}
+
+      vnet_generic_header_offset_parser (b, &gho, 0, !is_ip6, is_ip6);
+
+      if (gho.gho_flags & GHO_F_TUNNEL)
+	inner_is_ip6 = (gho.gho_flags & GHO_F_IP6) != 0;
+
+      if (!(gho.gho_flags & GHO_F_TCP) ||
+	  (gho.gho_flags & (GHO_F_GRE_TUNNEL | GHO_F_GENEVE_TUNNEL)))
+	{
+	  err = ESP_ENCRYPT_ERROR_GSO_UNHANDLED_TYPE;
+	  goto drop;
+	}
+
+      /* is_l2 as there is no midchain fixup to run on the inner packet */
+      if (!gso_segment_buffer_inline (vm, iptd, b, &gho, 1, inner_is_ip6))
+	{
+	  err = ESP_ENCRYPT_ERROR_GSO_NO_BUFFERS;
+	  goto drop;
+	}
+
+      if (gho.gho_flags & GHO_F_VXLAN_TUNNEL)
+	tso_segment_vxlan_tunnel_fixup (vm, iptd, b, &gho);
+      else if (gho.gho_flags & (GHO_F_IPIP_TUNNEL | GHO_F_IPIP6_TUNNEL))
+	tso_segment_ipip_tunnel_fixup (vm, iptd, b, &gho);
+
+      vec_foreach (bi, iptd->split_buffers)
+	{
+	  sb = vlib_get_buffer (vm, bi[0]);
+	  vlib_buffer_advance (sb, l2_len);
+	  vnet_buffer (sb)->ip.save_rewrite_length = rewrite_len;
+	}
+
+      n_segments += vec_len (iptd->split_buffers);
+      vec_append (ptd->gso_buffers, iptd->split_buffers);
+      vec_set_len (iptd->split_buffers, 0);
+      vlib_buffer_free_one (vm, from[i]);
+      continue;
+
+    drop:
+      vlib_buffer_advance (b, l2_len);
+      vnet_buffer (b)->ip.save_rewrite_length = rewrite_len;
+      vlib_error_drop_buffers (vm, node, from + i, /* buffer stride */ 1,
+			       /* n_buffers */ 1, drop_next, node->node_index,
+			       err);
+    }
+
+  vlib_node_increment_counter (vm, node->node_index,
+			       ESP_ENCRYPT_ERROR_GSO_SEGMENTS, n_segments);
+  return ptd->gso_buffers;
+}
+
+always_inline uword
+esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
+		    vlib_frame_t *frame, vnet_link_t lt, int is_tun,
+		    u16 async_next_node)
+{
+  ipsec_per_thread_data_t *ptd =
+    vec_elt_at_index (ipsec_main.ptd, vm->thread_index);
+  u32 *from = vlib_frame_vector_args (frame);
+  u32 n_left = frame->n_vectors, n, i;
+
+  for (i = 0; i < n_left; i++)
+    if (vlib_get_buffer (vm, from[i])->flags & VNET_BUFFER_F_GSO)
+      break;
+
+  if (PREDICT_FALSE (i < n_left))
+    {
+      from =
+	esp_encrypt_gso_segment (vm, node, ptd, from, n_left, lt, is_tun);
+      n_left = vec_len (from);
+    }
+
+  /* segmenting may leave more buffers than a frame holds */
+  while (n_left > 0)
+    {
+      n = clib_min (n_left, VLIB_FRAME_SIZE);
+      esp_encrypt_vectors (vm, node, from, n, lt, is_tun, async_next_node);
+      from += n;
+      n_left -= n;
+    }
 
   return frame->n_vectors;
 }
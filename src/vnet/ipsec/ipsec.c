@@ -15,6 +15,7 @@
  * limitations under the License.
  */
 
+#include <sys/random.h>
 #include <vnet/vnet.h>
 #include <vnet/api_errno.h>
 #include <vnet/ip/ip.h>
@@ -425,6 +426,7 @@ ipsec_init (vlib_main_t * vm)
   clib_error_t *error;
   ipsec_main_t *im = &ipsec_main;
   ipsec_main_crypto_alg_t *a;
+  ipsec_per_thread_data_t *ptd;
 
   /* Backend registration requires the feature arcs to be set up */
   if ((error = vlib_call_init_function (vm, vnet_feature_init)))
@@ -621,6 +623,16 @@ ipsec_init (vlib_main_t * vm)
 
   vec_validate_aligned (im->ptd, vlib_num_workers (), CLIB_CACHE_LINE_BYTES);
 
+  /* IVs of the SAs shared by all workers come from the thread's generator */
+  vec_foreach (ptd, im->ptd)
+    {
+      u64 rand[2];
+
+      if (getrandom (rand, sizeof (rand), 0) != sizeof (rand))
+	return clib_error_return_unix (0, "getrandom");
+      clib_pcg64i_srandom_r (&ptd->iv_prng, rand[0], rand[1]);
+    }
+
   im->async_mode = 0;
   crypto_engine_backend_register_post_node (vm);
 
@@ -127,6 +127,13 @@ typedef struct
   u8 icv_size;
 } ipsec_main_integ_alg_t;
 
+/* outbound sequence numbers a worker took from a shared SA */
+typedef struct
+{
+  u64 next;
+  u32 n_left;
+} ipsec_sa_seq_block_t;
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -136,6 +143,10 @@ typedef struct
   vnet_crypto_op_t *chained_integ_ops;
   vnet_crypto_op_chunk_t *chunks;
   vnet_crypto_async_frame_t **async_frames;
+  u32 *gso_buffers;
+  /* per SA index, for the SAs shared by all workers */
+  ipsec_sa_seq_block_t *seq_blocks;
+  clib_pcg64i_random_t iv_prng;
 } ipsec_per_thread_data_t;
 
 typedef struct
@@ -224,7 +224,7 @@ ipsec_sa_bind_cli (vlib_main_t *vm, unformat_input_t *input,
   unformat_input_t _line_input, *line_input = &_line_input;
   u32 id = ~0;
   u32 worker = ~0;
-  bool bind = 1;
+  bool bind = 1, any = 0;
   int rv;
   clib_error_t *error = NULL;
 
@@ -235,6 +235,8 @@ ipsec_sa_bind_cli (vlib_main_t *vm, unformat_input_t *input,
     {
       if (unformat (line_input, "unbind"))
 	bind = 0;
+      else if (unformat (line_input, "any"))
+	any = 1;
       else if (id == ~0 && unformat (line_input, "%u", &id))
 	;
       else if (unformat (line_input, "%u", &worker))
@@ -253,7 +255,7 @@ ipsec_sa_bind_cli (vlib_main_t *vm, unformat_input_t *input,
       goto done;
     }
 
-  if (bind && ~0 == worker)
+  if (bind && ~0 == worker && !any)
     {
       error = clib_error_return (0, "please specify worker to bind to");
       goto done;
@@ -268,6 +270,10 @@ ipsec_sa_bind_cli (vlib_main_t *vm, unformat_input_t *input,
     case VNET_API_ERROR_INVALID_WORKER:
       error = clib_error_return (0, "please specify a valid worker index");
       break;
+    case VNET_API_ERROR_UNSUPPORTED:
+      error = clib_error_return (0, "only ESP SAs with ESN or anti-replay "
+				 "can be bound to any worker");
+      break;
     }
 
 done:
@@ -278,7 +284,7 @@ done:
 
 VLIB_CLI_COMMAND (ipsec_sa_bind_cmd, static) = {
   .path = "ipsec sa bind",
-  .short_help = "ipsec sa [unbind] <sa-id> <worker>",
+  .short_help = "ipsec sa [unbind] <sa-id> <worker>|any",
   .function = ipsec_sa_bind_cli,
 };
 
@@ -464,7 +464,10 @@ format_ipsec_sa (u8 * s, va_list * args)
 
   s = format (s, "\n   locks %d", sa->node.fn_locks);
   s = format (s, "\n   salt 0x%x", clib_net_to_host_u32 (sa->salt));
-  s = format (s, "\n   thread-index:%d", sa->thread_index);
+  if (ipsec_sa_is_shared (sa))
+    s = format (s, "\n   thread-index:any");
+  else
+    s = format (s, "\n   thread-index:%d", sa->thread_index);
   s = format (s, "\n   seq %u seq-hi %u", sa->seq, sa->seq_hi);
   s = format (s, "\n   window-size: %llu",
 	      IPSEC_SA_ANTI_REPLAY_WINDOW_SIZE (sa));
@@ -327,6 +327,8 @@ ipsec_itf_create (u32 user_instance, tunnel_mode_t mode, u32 * sw_if_indexp)
 
   hi = vnet_get_hw_interface (vnm, hw_if_index);
   vnet_sw_interface_set_mtu (vnm, hi->sw_if_index, 9000);
+  /* esp-encrypt segments GSO packets as it encrypts them */
+  vnet_hw_if_set_caps (vnm, hw_if_index, VNET_HW_IF_CAP_TCP_GSO);
 
   vec_validate_init_empty (ipsec_itf_index_by_sw_if_index, hi->sw_if_index,
 			   INDEX_INVALID);
@@ -517,6 +517,7 @@ ipsec_sa_del (ipsec_sa_t * sa)
 {
   vlib_main_t *vm = vlib_get_main ();
   ipsec_main_t *im = &ipsec_main;
+  ipsec_per_thread_data_t *ptd;
   u32 sa_index;
 
   sa_index = sa - ipsec_sa_pool;
@@ -543,6 +544,13 @@ ipsec_sa_del (ipsec_sa_t * sa)
     vnet_crypto_key_del (vm, sa->integ_sync_key_index);
   if (ipsec_sa_is_set_ANTI_REPLAY_HUGE (sa))
     clib_bitmap_free (sa->replay_window_huge);
+  clib_spinlock_free (&sa->shard_lock);
+
+  /* the next SA with this index must not use numbers taken from this one */
+  vec_foreach (ptd, im->ptd)
+    if (sa_index < vec_len (ptd->seq_blocks))
+      ptd->seq_blocks[sa_index].n_left = 0;
+
   pool_put (ipsec_sa_pool, sa);
 }
 
@@ -565,6 +573,24 @@ ipsec_sa_bind (u32 id, u32 worker, bool bind)
       return 0;
     }
 
+  if (worker == ~0)
+    {
+      /* AH has no locking around its SN and replay window */
+      if (sa->protocol != IPSEC_PROTOCOL_ESP)
+	return VNET_API_ERROR_UNSUPPORTED;
+
+      /* the 32 bit SN would wrap, and with it the IVs of a counter mode
+	 cipher, which are derived from it on a shared SA */
+      if (!ipsec_sa_is_set_USE_ESN (sa) &&
+	  !ipsec_sa_is_set_USE_ANTI_REPLAY (sa))
+	return VNET_API_ERROR_UNSUPPORTED;
+
+      if (!sa->shard_lock)
+	clib_spinlock_init (&sa->shard_lock);
+      sa->thread_index = IPSEC_SA_THREAD_ANY;
+      return 0;
+    }
+
   if (worker >= vlib_num_workers ())
     return VNET_API_ERROR_INVALID_WORKER;
 
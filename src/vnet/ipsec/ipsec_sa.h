@@ -208,6 +208,9 @@ typedef struct
   tunnel_encap_decap_flags_t tunnel_flags;
   u8 __pad[2];
 
+  /* serialises the SN and the replay window of an SA shared by workers */
+  clib_spinlock_t shard_lock;
+
   /* data accessed by dataplane code should be above this comment */
     CLIB_CACHE_LINE_ALIGN_MARK (cacheline2);
 
@@ -323,6 +326,23 @@ extern uword unformat_ipsec_key (unformat_input_t *input, va_list *args);
 
 #define IPSEC_UDP_PORT_NONE ((u16) ~0)
 
+/* thread_index of an SA processed on whichever worker receives its packets */
+#define IPSEC_SA_THREAD_ANY ((u16) ~1)
+
+/*
+ * A worker takes outbound sequence numbers of a shared SA in blocks, and
+ * drops what is left of its block once the others ran that far ahead of
+ * it, so its packets stay within the peer's replay window.
+ */
+#define IPSEC_SA_SEQ_BLOCK_SIZE	   16
+#define IPSEC_SA_SEQ_BLOCK_MAX_LAG 32
+
+always_inline bool
+ipsec_sa_is_shared (const ipsec_sa_t *sa)
+{
+  return sa->thread_index == IPSEC_SA_THREAD_ANY;
+}
+
 /*
  * Anti Replay definitions
  */
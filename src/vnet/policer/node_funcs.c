@@ -70,9 +70,12 @@ static inline uword
 vnet_policer_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 		     vlib_frame_t *frame, vlib_dir_t dir)
 {
-  u32 n_left_from, *from, *to_next;
-  vnet_policer_next_t next_index;
   vnet_policer_main_t *pm = &vnet_policer_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 pis[VLIB_FRAME_SIZE];
+  u8 acts[VLIB_FRAME_SIZE];
+  u32 *from, n_left, n_run, i;
   u64 time_in_policer_periods;
   u32 transmitted = 0;
 
@@ -80,173 +83,63 @@ vnet_policer_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
     clib_cpu_time_now () >> POLICER_TICKS_PER_PERIOD_SHIFT;
 
   from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
+  n_left = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left);
 
-  while (n_left_from > 0)
+  for (i = 0; i < n_left; i++)
     {
-      u32 n_left_to_next;
-
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
-
-      while (n_left_from >= 4 && n_left_to_next >= 2)
-	{
-	  u32 bi0, bi1;
-	  vlib_buffer_t *b0, *b1;
-	  u32 next0, next1;
-	  u32 sw_if_index0, sw_if_index1;
-	  u32 pi0 = 0, pi1 = 0;
-	  u8 act0, act1;
-
-	  /* Prefetch next iteration. */
-	  {
-	    vlib_buffer_t *b2, *b3;
-
-	    b2 = vlib_get_buffer (vm, from[2]);
-	    b3 = vlib_get_buffer (vm, from[3]);
-
-	    vlib_prefetch_buffer_header (b2, LOAD);
-	    vlib_prefetch_buffer_header (b3, LOAD);
-	  }
-
-	  /* speculatively enqueue b0 and b1 to the current next frame */
-	  to_next[0] = bi0 = from[0];
-	  to_next[1] = bi1 = from[1];
-	  from += 2;
-	  to_next += 2;
-	  n_left_from -= 2;
-	  n_left_to_next -= 2;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-	  b1 = vlib_get_buffer (vm, bi1);
-
-	  sw_if_index0 = vnet_buffer (b0)->sw_if_index[dir];
-	  sw_if_index1 = vnet_buffer (b1)->sw_if_index[dir];
-
-	  pi0 = pm->policer_index_by_sw_if_index[dir][sw_if_index0];
-	  pi1 = pm->policer_index_by_sw_if_index[dir][sw_if_index1];
-
-	  act0 = vnet_policer_police (vm, b0, pi0, time_in_policer_periods,
-				      POLICE_CONFORM /* no chaining */, true);
-
-	  act1 = vnet_policer_police (vm, b1, pi1, time_in_policer_periods,
-				      POLICE_CONFORM /* no chaining */, true);
-
-	  if (PREDICT_FALSE (act0 == QOS_ACTION_HANDOFF))
-	    {
-	      next0 = VNET_POLICER_NEXT_HANDOFF;
-	      vnet_buffer (b0)->policer.index = pi0;
-	    }
-	  else if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
-	    {
-	      next0 = VNET_POLICER_NEXT_DROP;
-	      b0->error = node->errors[VNET_POLICER_ERROR_DROP];
-	    }
-	  else /* transmit or mark-and-transmit action */
-	    {
-	      transmitted++;
-	      vnet_feature_next (&next0, b0);
-	    }
+      u32 sw_if_index = vnet_buffer (bufs[i])->sw_if_index[dir];
+      pis[i] = pm->policer_index_by_sw_if_index[dir][sw_if_index];
+    }
 
-	  if (PREDICT_FALSE (act1 == QOS_ACTION_HANDOFF))
-	    {
-	      next1 = VNET_POLICER_NEXT_HANDOFF;
-	      vnet_buffer (b1)->policer.index = pi1;
-	    }
-	  else if (PREDICT_FALSE (act1 == QOS_ACTION_DROP)) /* drop action */
-	    {
-	      next1 = VNET_POLICER_NEXT_DROP;
-	      b1->error = node->errors[VNET_POLICER_ERROR_DROP];
-	    }
-	  else /* transmit or mark-and-transmit action */
-	    {
-	      transmitted++;
-	      vnet_feature_next (&next1, b1);
-	    }
+  /* police each run of packets that share a policer as one batch */
+  for (i = 0; i < n_left; i += n_run)
+    {
+      n_run = 1;
+      while (i + n_run < n_left && pis[i + n_run] == pis[i])
+	n_run++;
+
+      vnet_policer_police_packets (vm, bufs + i, pis[i],
+				   time_in_policer_periods,
+				   POLICE_CONFORM /* no chaining */, true,
+				   acts + i, n_run);
+    }
 
-	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)))
-	    {
-	      if (b0->flags & VLIB_BUFFER_IS_TRACED)
-		{
-		  vnet_policer_trace_t *t =
-		    vlib_add_trace (vm, node, b0, sizeof (*t));
-		  t->sw_if_index = sw_if_index0;
-		  t->next_index = next0;
-		}
-	      if (b1->flags & VLIB_BUFFER_IS_TRACED)
-		{
-		  vnet_policer_trace_t *t =
-		    vlib_add_trace (vm, node, b1, sizeof (*t));
-		  t->sw_if_index = sw_if_index1;
-		  t->next_index = next1;
-		}
-	    }
+  b = bufs;
+  next = nexts;
 
-	  /* verify speculative enqueues, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x2 (vm, node, next_index,
-					   to_next, n_left_to_next,
-					   bi0, bi1, next0, next1);
+  for (i = 0; i < n_left; i++)
+    {
+      if (PREDICT_FALSE (acts[i] == QOS_ACTION_HANDOFF))
+	{
+	  next[0] = VNET_POLICER_NEXT_HANDOFF;
+	  vnet_buffer (b[0])->policer.index = pis[i];
 	}
-
-      while (n_left_from > 0 && n_left_to_next > 0)
+      else if (PREDICT_FALSE (acts[i] == QOS_ACTION_DROP))
 	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  u32 next0;
-	  u32 sw_if_index0;
-	  u32 pi0 = 0;
-	  u8 act0;
-
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-
-	  sw_if_index0 = vnet_buffer (b0)->sw_if_index[dir];
-	  pi0 = pm->policer_index_by_sw_if_index[dir][sw_if_index0];
-
-	  act0 = vnet_policer_police (vm, b0, pi0, time_in_policer_periods,
-				      POLICE_CONFORM /* no chaining */, true);
-
-	  if (PREDICT_FALSE (act0 == QOS_ACTION_HANDOFF))
-	    {
-	      next0 = VNET_POLICER_NEXT_HANDOFF;
-	      vnet_buffer (b0)->policer.index = pi0;
-	    }
-	  else if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
-	    {
-	      next0 = VNET_POLICER_NEXT_DROP;
-	      b0->error = node->errors[VNET_POLICER_ERROR_DROP];
-	    }
-	  else /* transmit or mark-and-transmit action */
-	    {
-	      transmitted++;
-	      vnet_feature_next (&next0, b0);
-	    }
-
-	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
-			     && (b0->flags & VLIB_BUFFER_IS_TRACED)))
-	    {
-	      vnet_policer_trace_t *t =
-		vlib_add_trace (vm, node, b0, sizeof (*t));
-	      t->sw_if_index = sw_if_index0;
-	      t->next_index = next0;
-	      t->policer_index = pi0;
-	    }
+	  next[0] = VNET_POLICER_NEXT_DROP;
+	  b[0]->error = node->errors[VNET_POLICER_ERROR_DROP];
+	}
+      else /* transmit or mark-and-transmit action */
+	{
+	  transmitted++;
+	  vnet_feature_next_u16 (next, b[0]);
+	}
 
-	  /* verify speculative enqueue, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index,
-					   to_next, n_left_to_next,
-					   bi0, next0);
+      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE) &&
+			 (b[0]->flags & VLIB_BUFFER_IS_TRACED)))
+	{
+	  vnet_policer_trace_t *t = vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->sw_if_index = vnet_buffer (b[0])->sw_if_index[dir];
+	  t->next_index = next[0];
+	  t->policer_index = pis[i];
 	}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      b++;
+      next++;
     }
 
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
   vlib_node_increment_counter (vm, node->node_index,
 			       VNET_POLICER_ERROR_TRANSMIT, transmitted);
   return frame->n_vectors;
@@ -400,16 +293,21 @@ policer_classify_inline (vlib_main_t * vm,
 			 vlib_frame_t * frame,
 			 policer_classify_table_id_t tid)
 {
-  u32 n_left_from, *from, *to_next;
-  policer_classify_next_index_t next_index;
+  u32 n_vectors, *from;
   policer_classify_main_t *pcm = &policer_classify_main;
   vnet_classify_main_t *vcm = pcm->vnet_classify_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 table_indices[VLIB_FRAME_SIZE], hashes[VLIB_FRAME_SIZE];
+  vnet_classify_entry_t *entries[VLIB_FRAME_SIZE];
+  const u8 *headers[VLIB_FRAME_SIZE];
   f64 now = vlib_time_now (vm);
   u32 hits = 0;
   u32 misses = 0;
   u32 chain_hits = 0;
   u32 n_next_nodes;
   u64 time_in_policer_periods;
+  u32 i;
 
   time_in_policer_periods =
     clib_cpu_time_now () >> POLICER_TICKS_PER_PERIOD_SHIFT;
@@ -417,241 +315,99 @@ policer_classify_inline (vlib_main_t * vm,
   n_next_nodes = node->n_next_nodes;
 
   from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-
-  /* First pass: compute hashes */
-  while (n_left_from > 2)
-    {
-      vlib_buffer_t *b0, *b1;
-      u32 bi0, bi1;
-      u8 *h0, *h1;
-      u32 sw_if_index0, sw_if_index1;
-      u32 table_index0, table_index1;
-      vnet_classify_table_t *t0, *t1;
-
-      /* Prefetch next iteration */
-      {
-	vlib_buffer_t *p1, *p2;
-
-	p1 = vlib_get_buffer (vm, from[1]);
-	p2 = vlib_get_buffer (vm, from[2]);
-
-	vlib_prefetch_buffer_header (p1, STORE);
-	clib_prefetch_store (p1->data);
-	vlib_prefetch_buffer_header (p2, STORE);
-	clib_prefetch_store (p2->data);
-      }
-
-      bi0 = from[0];
-      b0 = vlib_get_buffer (vm, bi0);
-      h0 = b0->data;
-
-      bi1 = from[1];
-      b1 = vlib_get_buffer (vm, bi1);
-      h1 = b1->data;
-
-      sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_RX];
-      table_index0 =
-	pcm->classify_table_index_by_sw_if_index[tid][sw_if_index0];
-
-      sw_if_index1 = vnet_buffer (b1)->sw_if_index[VLIB_RX];
-      table_index1 =
-	pcm->classify_table_index_by_sw_if_index[tid][sw_if_index1];
-
-      t0 = pool_elt_at_index (vcm->tables, table_index0);
+  n_vectors = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_vectors);
 
-      t1 = pool_elt_at_index (vcm->tables, table_index1);
-
-      vnet_buffer (b0)->l2_classify.hash =
-	vnet_classify_hash_packet (t0, (u8 *) h0);
-
-      vnet_classify_prefetch_bucket (t0, vnet_buffer (b0)->l2_classify.hash);
-
-      vnet_buffer (b1)->l2_classify.hash =
-	vnet_classify_hash_packet (t1, (u8 *) h1);
-
-      vnet_classify_prefetch_bucket (t1, vnet_buffer (b1)->l2_classify.hash);
-
-      vnet_buffer (b0)->l2_classify.table_index = table_index0;
-
-      vnet_buffer (b1)->l2_classify.table_index = table_index1;
-
-      from += 2;
-      n_left_from -= 2;
-    }
-
-  while (n_left_from > 0)
+  /* First pass: find each packet's table */
+  for (i = 0; i < n_vectors; i++)
     {
-      vlib_buffer_t *b0;
-      u32 bi0;
-      u8 *h0;
       u32 sw_if_index0;
-      u32 table_index0;
-      vnet_classify_table_t *t0;
 
-      bi0 = from[0];
-      b0 = vlib_get_buffer (vm, bi0);
-      h0 = b0->data;
+      b = bufs + i;
+      if (i + 2 < n_vectors)
+	{
+	  vlib_prefetch_buffer_header (b[2], STORE);
+	  clib_prefetch_store (b[2]->data);
+	}
 
-      sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_RX];
-      table_index0 =
+      headers[i] = b[0]->data;
+      sw_if_index0 = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+      table_indices[i] =
 	pcm->classify_table_index_by_sw_if_index[tid][sw_if_index0];
-
-      t0 = pool_elt_at_index (vcm->tables, table_index0);
-      vnet_buffer (b0)->l2_classify.hash =
-	vnet_classify_hash_packet (t0, (u8 *) h0);
-
-      vnet_buffer (b0)->l2_classify.table_index = table_index0;
-      vnet_classify_prefetch_bucket (t0, vnet_buffer (b0)->l2_classify.hash);
-
-      from++;
-      n_left_from--;
     }
 
-  next_index = node->cached_next_index;
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
+  /* Second pass: look them all up, walking the table chains */
+  chain_hits = vnet_classify_lookup_n (headers, table_indices, hashes,
+				       entries, n_vectors, now,
+				       1 /* walk_chain */ );
 
-  while (n_left_from > 0)
+  b = bufs;
+  next = nexts;
+  for (i = 0; i < n_vectors; i++)
     {
-      u32 n_left_to_next;
+      u32 next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
+      vnet_classify_table_t *t0;
+      vnet_classify_entry_t *e0;
+      u8 act0;
 
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
+      e0 = entries[i];
+      t0 = 0;
 
-      /* Not enough load/store slots to dual loop... */
-      while (n_left_from > 0 && n_left_to_next > 0)
+      if (tid == POLICER_CLASSIFY_TABLE_L2)
 	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  u32 next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
-	  u32 table_index0;
-	  vnet_classify_table_t *t0;
-	  vnet_classify_entry_t *e0;
-	  u32 hash0;
-	  u8 *h0;
-	  u8 act0;
-
-	  /* Stride 3 seems to work best */
-	  if (PREDICT_TRUE (n_left_from > 3))
-	    {
-	      vlib_buffer_t *p1 = vlib_get_buffer (vm, from[3]);
-	      vnet_classify_table_t *tp1;
-	      u32 table_index1;
-	      u32 phash1;
-
-	      table_index1 = vnet_buffer (p1)->l2_classify.table_index;
-
-	      if (PREDICT_TRUE (table_index1 != ~0))
-		{
-		  tp1 = pool_elt_at_index (vcm->tables, table_index1);
-		  phash1 = vnet_buffer (p1)->l2_classify.hash;
-		  vnet_classify_prefetch_entry (tp1, phash1);
-		}
-	    }
+	  /* Feature bitmap update and determine the next node */
+	  next0 = vnet_l2_feature_next (b[0], pcm->feat_next_node_index,
+					L2INPUT_FEAT_POLICER_CLAS);
+	}
+      else
+	vnet_get_config_data (pcm->vnet_config_main[tid],
+			      &b[0]->current_config_index, &next0,
+			      /* # bytes of config data */ 0);
 
-	  /* Speculatively enqueue b0 to the current next frame */
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-	  h0 = b0->data;
-	  table_index0 = vnet_buffer (b0)->l2_classify.table_index;
-	  e0 = 0;
-	  t0 = 0;
-
-	  if (tid == POLICER_CLASSIFY_TABLE_L2)
-	    {
-	      /* Feature bitmap update and determine the next node */
-	      next0 = vnet_l2_feature_next (b0, pcm->feat_next_node_index,
-					    L2INPUT_FEAT_POLICER_CLAS);
-	    }
-	  else
-	    vnet_get_config_data (pcm->vnet_config_main[tid],
-				  &b0->current_config_index, &next0,
-				  /* # bytes of config data */ 0);
+      vnet_buffer (b[0])->l2_classify.opaque_index = ~0;
 
-	  vnet_buffer (b0)->l2_classify.opaque_index = ~0;
+      if (PREDICT_TRUE (table_indices[i] != ~0))
+	{
+	  t0 = pool_elt_at_index (vcm->tables, table_indices[i]);
 
-	  if (PREDICT_TRUE (table_index0 != ~0))
+	  if (e0)
 	    {
-	      hash0 = vnet_buffer (b0)->l2_classify.hash;
-	      t0 = pool_elt_at_index (vcm->tables, table_index0);
-	      e0 = vnet_classify_find_entry (t0, (u8 *) h0, hash0, now);
-
-	      if (e0)
-		{
-		  act0 = vnet_policer_police (vm, b0, e0->next_index,
-					      time_in_policer_periods,
-					      e0->opaque_index, false);
-		  if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
-		    {
-		      next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
-		      b0->error = node->errors[POLICER_CLASSIFY_ERROR_DROP];
-		    }
-		  hits++;
-		}
-	      else
+	      act0 = vnet_policer_police (vm, b[0], e0->next_index,
+					  time_in_policer_periods,
+					  e0->opaque_index, false);
+	      if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
 		{
-		  while (1)
-		    {
-		      if (PREDICT_TRUE (t0->next_table_index != ~0))
-			{
-			  t0 = pool_elt_at_index (vcm->tables,
-						  t0->next_table_index);
-			}
-		      else
-			{
-			  next0 = (t0->miss_next_index < n_next_nodes) ?
-			    t0->miss_next_index : next0;
-			  misses++;
-			  break;
-			}
-
-		      hash0 = vnet_classify_hash_packet (t0, (u8 *) h0);
-		      e0 =
-			vnet_classify_find_entry (t0, (u8 *) h0, hash0, now);
-		      if (e0)
-			{
-			  act0 = vnet_policer_police (vm, b0, e0->next_index,
-						      time_in_policer_periods,
-						      e0->opaque_index, false);
-			  if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
-			    {
-			      next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
-			      b0->error =
-				node->errors[POLICER_CLASSIFY_ERROR_DROP];
-			    }
-			  hits++;
-			  chain_hits++;
-			  break;
-			}
-		    }
+		  next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
+		  b[0]->error = node->errors[POLICER_CLASSIFY_ERROR_DROP];
 		}
+	      hits++;
 	    }
-	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
-			     && (b0->flags & VLIB_BUFFER_IS_TRACED)))
+	  else
 	    {
-	      policer_classify_trace_t *t =
-		vlib_add_trace (vm, node, b0, sizeof (*t));
-	      t->sw_if_index = vnet_buffer (b0)->sw_if_index[VLIB_RX];
-	      t->next_index = next0;
-	      t->table_index = t0 ? t0 - vcm->tables : ~0;
-	      t->offset = (e0 && t0) ? vnet_classify_get_offset (t0, e0) : ~0;
-	      t->policer_index = e0 ? e0->next_index : ~0;
+	      next0 = (t0->miss_next_index < n_next_nodes) ?
+		t0->miss_next_index : next0;
+	      misses++;
 	    }
-
-	  /* Verify speculative enqueue, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
+	}
+      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
+			 && (b[0]->flags & VLIB_BUFFER_IS_TRACED)))
+	{
+	  policer_classify_trace_t *t =
+	    vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+	  t->next_index = next0;
+	  t->table_index = t0 ? t0 - vcm->tables : ~0;
+	  t->offset = (e0 && t0) ? vnet_classify_get_offset (t0, e0) : ~0;
+	  t->policer_index = e0 ? e0->next_index : ~0;
 	}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      next[0] = next0;
+      b += 1;
+      next += 1;
     }
 
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
   vlib_node_increment_counter (vm, node->node_index,
 			       POLICER_CLASSIFY_ERROR_MISS, misses);
   vlib_node_increment_counter (vm, node->node_index,
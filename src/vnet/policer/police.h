@@ -66,6 +66,16 @@ typedef enum
 // The lock field should be used for a spin-lock on the struct. Alternatively,
 // a thread index field is provided so that policed packets may be handed
 // off to a single worker thread.
+//
+// A sharded policer is neither locked nor tied to a thread. Each thread
+// polices against a private policer_shard_t holding a slice of the tokens,
+// and the buckets in the policer_t become the shared reserve. The reserve
+// is refilled by whichever thread first sees a new period, and threads move
+// tokens between the reserve and their shard with atomic operations only
+// when their slice runs out. A shard tops up with at most
+// current_limit >> shard_shift tokens beyond what the packets in hand need,
+// so tokens cached across all threads exceed the configured burst by a
+// bounded amount (a quarter of it with the default shard_shift).
 
 #define POLICER_TICKS_PER_PERIOD_SHIFT 17
 #define POLICER_TICKS_PER_PERIOD       (1 << POLICER_TICKS_PER_PERIOD_SHIFT)
@@ -78,7 +88,8 @@ typedef struct
   u32 scale;			// power-of-2 shift amount for lower rates
   qos_action_type_en action[3];
   ip_dscp_t mark_dscp[3];
-  u8 pad[2];
+  u8 sharded;			// police per thread, see policer_shard_t
+  u8 shard_shift;		// log2 of limit over the shard top-up
 
   // Fields are marked as 2R if they are only used for a 2-rate policer,
   // and MOD if they are modified as part of the update operation.
@@ -98,6 +109,55 @@ typedef struct
 
 STATIC_ASSERT_SIZEOF (policer_t, CLIB_CACHE_LINE_BYTES);
 
+typedef struct
+{
+  u64 current_bucket;
+  u64 extended_bucket;
+  u64 last_update_time;
+} policer_shard_t;
+
+// Idle periods after which a shard hands its tokens back to the reserve
+#define POLICER_SHARD_IDLE_PERIODS 64
+
+// Determine the colour of a packet given the tokens available, and consume
+// the tokens that colour costs.
+static_always_inline policer_result_e
+vnet_police_color (policer_t *policer, u32 packet_length,
+		   policer_result_e packet_color, u64 *current_tokens,
+		   u64 *extended_tokens)
+{
+  if (policer->single_rate)
+    {
+      if ((!policer->color_aware || (packet_color == POLICE_CONFORM))
+	  && (*current_tokens >= packet_length))
+	{
+	  *current_tokens -= packet_length;
+	  *extended_tokens -= clib_min (*extended_tokens, packet_length);
+	  return POLICE_CONFORM;
+	}
+      else if ((!policer->color_aware || (packet_color != POLICE_VIOLATE))
+	       && (*extended_tokens >= packet_length))
+	{
+	  *extended_tokens -= packet_length;
+	  return POLICE_EXCEED;
+	}
+      return POLICE_VIOLATE;
+    }
+
+  // Two-rate policer
+  if ((policer->color_aware && (packet_color == POLICE_VIOLATE))
+      || (*extended_tokens < packet_length))
+    return POLICE_VIOLATE;
+
+  *extended_tokens -= packet_length;
+  if ((policer->color_aware && (packet_color == POLICE_EXCEED))
+      || (*current_tokens < packet_length))
+    return POLICE_EXCEED;
+
+  *current_tokens -= packet_length;
+  return POLICE_CONFORM;
+}
+
 static inline policer_result_e
 vnet_police_packet (policer_t *policer, u32 packet_length,
 		    policer_result_e packet_color, u64 time)
@@ -128,90 +188,138 @@ vnet_police_packet (policer_t *policer, u32 packet_length,
   // packet. This constraint on tokens_per_period lets the ucode omit
   // code to dynamically check for or prevent the overflow.
 
-  if (policer->single_rate)
+  // Compute number of tokens for this time period
+  current_tokens =
+    policer->current_bucket + n_periods * policer->cir_tokens_per_period;
+  extended_tokens =
+    policer->extended_bucket +
+    n_periods * (policer->single_rate ? policer->cir_tokens_per_period :
+					policer->pir_tokens_per_period);
+  if (current_tokens > policer->current_limit)
     {
+      current_tokens = policer->current_limit;
+    }
+  if (extended_tokens > policer->extended_limit)
+    {
+      extended_tokens = policer->extended_limit;
+    }
 
-      // Compute number of tokens for this time period
-      current_tokens =
-	policer->current_bucket + n_periods * policer->cir_tokens_per_period;
-      if (current_tokens > policer->current_limit)
-	{
-	  current_tokens = policer->current_limit;
-	}
+  // Determine color
+  result = vnet_police_color (policer, packet_length, packet_color,
+			      &current_tokens, &extended_tokens);
 
-      extended_tokens =
-	policer->extended_bucket + n_periods * policer->cir_tokens_per_period;
-      if (extended_tokens > policer->extended_limit)
-	{
-	  extended_tokens = policer->extended_limit;
-	}
+  policer->current_bucket = current_tokens;
+  policer->extended_bucket = extended_tokens;
 
-      // Determine color
+  return result;
+}
 
-      if ((!policer->color_aware || (packet_color == POLICE_CONFORM))
-	  && (current_tokens >= packet_length))
-	{
-	  policer->current_bucket = current_tokens - packet_length;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_CONFORM;
-	}
-      else if ((!policer->color_aware || (packet_color != POLICE_VIOLATE))
-	       && (extended_tokens >= packet_length))
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_EXCEED;
-	}
-      else
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens;
-	  result = POLICE_VIOLATE;
-	}
+// Add tokens to a shared bucket of a sharded policer, up to its limit
+static_always_inline void
+vnet_police_reserve_put (u32 *bucket, u64 tokens, u32 limit)
+{
+  u32 old = __atomic_load_n (bucket, __ATOMIC_RELAXED), new;
 
-    }
-  else
+  do
+    new = clib_min ((u64) old + tokens, limit);
+  while (new != old &&
+	 !__atomic_compare_exchange_n (bucket, &old, new, 0, __ATOMIC_RELAXED,
+				       __ATOMIC_RELAXED));
+}
+
+// Take up to the given number of tokens from a shared bucket
+static_always_inline u64
+vnet_police_reserve_get (u32 *bucket, u64 tokens)
+{
+  u32 old = __atomic_load_n (bucket, __ATOMIC_RELAXED), n;
+
+  do
     {
-      // Two-rate policer
-
-      // Compute number of tokens for this time period
-      current_tokens =
-	policer->current_bucket + n_periods * policer->cir_tokens_per_period;
-      extended_tokens =
-	policer->extended_bucket + n_periods * policer->pir_tokens_per_period;
-      if (current_tokens > policer->current_limit)
-	{
-	  current_tokens = policer->current_limit;
-	}
-      if (extended_tokens > policer->extended_limit)
-	{
-	  extended_tokens = policer->extended_limit;
-	}
+      n = clib_min (old, tokens);
+      if (n == 0)
+	return 0;
+    }
+  while (!__atomic_compare_exchange_n (bucket, &old, old - n, 0,
+				       __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  return n;
+}
 
-      // Determine color
+// Credit the shared buckets with the periods elapsed since the last refill.
+// Only the thread that moves last_update_time forward adds the tokens.
+static_always_inline void
+vnet_police_reserve_refill (policer_t *policer, u64 time)
+{
+  u64 last = __atomic_load_n (&policer->last_update_time, __ATOMIC_RELAXED);
+  u64 n_periods;
 
-      if ((policer->color_aware && (packet_color == POLICE_VIOLATE))
-	  || (extended_tokens < packet_length))
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens;
-	  result = POLICE_VIOLATE;
-	}
-      else if ((policer->color_aware && (packet_color == POLICE_EXCEED))
-	       || (current_tokens < packet_length))
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_EXCEED;
-	}
-      else
-	{
-	  policer->current_bucket = current_tokens - packet_length;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_CONFORM;
-	}
+  if (time <= last ||
+      !__atomic_compare_exchange_n (&policer->last_update_time, &last, time,
+				    0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    return;
+
+  n_periods = time - last;
+  vnet_police_reserve_put (&policer->current_bucket,
+			   n_periods * policer->cir_tokens_per_period,
+			   policer->current_limit);
+  vnet_police_reserve_put (&policer->extended_bucket,
+			   n_periods *
+			     (policer->single_rate ?
+				policer->cir_tokens_per_period :
+				policer->pir_tokens_per_period),
+			   policer->extended_limit);
+}
+
+// Police a batch of packets against one policer. For a sharded policer the
+// shard of the calling thread is topped up from the reserve once per batch,
+// so the shared cache line is only written when the shard runs dry.
+static_always_inline void
+vnet_police_packets (policer_t *policer, policer_shard_t *shard,
+		     u32 *packet_lengths, policer_result_e *results,
+		     u32 n_packets, policer_result_e packet_color, u64 time)
+{
+  u64 need = 0, top_up;
+  u32 i;
+
+  if (!policer->sharded)
+    {
+      for (i = 0; i < n_packets; i++)
+	results[i] = vnet_police_packet (policer, packet_lengths[i],
+					 packet_color, time);
+      return;
     }
-  return result;
+
+  // A shard left idle hands its tokens back, they were accounted for
+  // in a period that has long gone.
+  if (PREDICT_FALSE (time - shard->last_update_time >
+		     POLICER_SHARD_IDLE_PERIODS))
+    {
+      vnet_police_reserve_put (&policer->current_bucket,
+			       shard->current_bucket, policer->current_limit);
+      vnet_police_reserve_put (&policer->extended_bucket,
+			       shard->extended_bucket, policer->extended_limit);
+      shard->current_bucket = shard->extended_bucket = 0;
+    }
+  shard->last_update_time = time;
+
+  vnet_police_reserve_refill (policer, time);
+
+  for (i = 0; i < n_packets; i++)
+    need += (u64) packet_lengths[i] << policer->scale;
+
+  top_up = policer->current_limit >> policer->shard_shift;
+  if (shard->current_bucket < need)
+    shard->current_bucket += vnet_police_reserve_get (
+      &policer->current_bucket, need - shard->current_bucket + top_up);
+
+  top_up = policer->extended_limit >> policer->shard_shift;
+  if (shard->extended_bucket < need)
+    shard->extended_bucket += vnet_police_reserve_get (
+      &policer->extended_bucket, need - shard->extended_bucket + top_up);
+
+  for (i = 0; i < n_packets; i++)
+    results[i] = vnet_police_color (
+      policer, packet_lengths[i] << policer->scale, packet_color,
+      &shard->current_bucket, &shard->extended_bucket);
 }
 
 #endif // __POLICE_H__
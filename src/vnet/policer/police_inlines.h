@@ -55,6 +55,13 @@ vnet_policer_mark (vlib_buffer_t *b, ip_dscp_t dscp)
     }
 }
 
+static_always_inline policer_shard_t *
+vnet_policer_shard (vlib_main_t *vm, u32 policer_index)
+{
+  return vec_elt_at_index (vnet_policer_main.shards[vm->thread_index],
+			   policer_index);
+}
+
 static_always_inline u8
 vnet_policer_police (vlib_main_t *vm, vlib_buffer_t *b, u32 policer_index,
 		     u64 time_in_policer_periods,
@@ -62,7 +69,7 @@ vnet_policer_police (vlib_main_t *vm, vlib_buffer_t *b, u32 policer_index,
 {
   qos_action_type_en act;
   u32 len;
-  u32 col;
+  policer_result_e col;
   policer_t *pol;
   vnet_policer_main_t *pm = &vnet_policer_main;
 
@@ -72,6 +79,14 @@ vnet_policer_police (vlib_main_t *vm, vlib_buffer_t *b, u32 policer_index,
 
   pol = &pm->policers[policer_index];
 
+  if (pol->sharded)
+    {
+      len = vlib_buffer_length_in_chain (vm, b);
+      vnet_police_packets (pol, vnet_policer_shard (vm, policer_index), &len,
+			   &col, 1, packet_color, time_in_policer_periods);
+      goto done;
+    }
+
   if (handoff)
     {
       if (PREDICT_FALSE (pol->thread_index == ~0))
@@ -90,6 +105,7 @@ vnet_policer_police (vlib_main_t *vm, vlib_buffer_t *b, u32 policer_index,
 
   len = vlib_buffer_length_in_chain (vm, b);
   col = vnet_police_packet (pol, len, packet_color, time_in_policer_periods);
+done:
   act = pol->action[col];
   vlib_increment_combined_counter (&policer_counters[col], vm->thread_index,
 				   policer_index, 1, len);
@@ -99,6 +115,57 @@ vnet_policer_police (vlib_main_t *vm, vlib_buffer_t *b, u32 policer_index,
   return act;
 }
 
+/*
+ * Police a batch of packets that all use the same policer, storing the
+ * action for each in acts. The tokens are accounted for once per batch.
+ */
+static_always_inline void
+vnet_policer_police_packets (vlib_main_t *vm, vlib_buffer_t **b,
+			     u32 policer_index, u64 time_in_policer_periods,
+			     policer_result_e packet_color, bool handoff,
+			     u8 *acts, u32 n_packets)
+{
+  vnet_policer_main_t *pm = &vnet_policer_main;
+  u32 lens[VLIB_FRAME_SIZE];
+  policer_result_e cols[VLIB_FRAME_SIZE];
+  policer_shard_t *shard = 0;
+  policer_t *pol;
+  u32 i;
+
+  ASSERT (n_packets <= VLIB_FRAME_SIZE);
+
+  pol = &pm->policers[policer_index];
+
+  if (pol->sharded)
+    shard = vnet_policer_shard (vm, policer_index);
+  else if (handoff)
+    {
+      if (PREDICT_FALSE (pol->thread_index == ~0))
+	clib_atomic_cmp_and_swap (&pol->thread_index, ~0, vm->thread_index);
+      else if (PREDICT_FALSE (pol->thread_index != vm->thread_index))
+	{
+	  clib_memset_u8 (acts, QOS_ACTION_HANDOFF, n_packets);
+	  return;
+	}
+    }
+
+  for (i = 0; i < n_packets; i++)
+    lens[i] = vlib_buffer_length_in_chain (vm, b[i]);
+
+  vnet_police_packets (pol, shard, lens, cols, n_packets, packet_color,
+		       time_in_policer_periods);
+
+  for (i = 0; i < n_packets; i++)
+    {
+      acts[i] = pol->action[cols[i]];
+      vlib_increment_combined_counter (&policer_counters[cols[i]],
+				       vm->thread_index, policer_index, 1,
+				       lens[i]);
+      if (PREDICT_TRUE (acts[i] == QOS_ACTION_MARK_AND_TRANSMIT))
+	vnet_policer_mark (b[i], pol->mark_dscp[cols[i]]);
+    }
+}
+
 typedef enum
 {
   POLICER_HANDOFF_ERROR_CONGESTION_DROP,
@@ -97,6 +97,33 @@ policer_add (vlib_main_t *vm, const u8 *name, const qos_pol_cfg_params_st *cfg,
   return 0;
 }
 
+/* drop the tokens cached by each thread, or return them to the policer */
+static void
+policer_shards_flush (policer_t *policer, u32 policer_index, bool give_back)
+{
+  vnet_policer_main_t *pm = &vnet_policer_main;
+  policer_shard_t *shard;
+  u32 i;
+
+  vec_foreach_index (i, pm->shards)
+    {
+      if (policer_index >= vec_len (pm->shards[i]))
+	continue;
+
+      shard = &pm->shards[i][policer_index];
+      if (give_back)
+	{
+	  vnet_police_reserve_put (&policer->current_bucket,
+				   shard->current_bucket,
+				   policer->current_limit);
+	  vnet_police_reserve_put (&policer->extended_bucket,
+				   shard->extended_bucket,
+				   policer->extended_limit);
+	}
+      clib_memset (shard, 0, sizeof (*shard));
+    }
+}
+
 int
 policer_del (vlib_main_t *vm, u32 policer_index)
 {
@@ -136,6 +163,7 @@ policer_update (vlib_main_t *vm, u32 policer_index,
   qos_pol_cfg_params_st *cp;
   uword *p;
   u8 *name;
+  u8 sharded, shard_shift;
   int rv;
   int i;
 
@@ -164,12 +192,17 @@ policer_update (vlib_main_t *vm, u32 policer_index,
     }
 
   name = policer->name;
+  sharded = policer->sharded;
+  shard_shift = policer->shard_shift;
 
   clib_memcpy (cp, cfg, sizeof (*cp));
   clib_memcpy (policer, &test_policer, sizeof (*policer));
 
   policer->name = name;
   policer->thread_index = ~0;
+  policer->sharded = sharded;
+  policer->shard_shift = shard_shift;
+  policer_shards_flush (policer, policer_index, false);
 
   for (i = 0; i < NUM_POLICE_RESULTS; i++)
     vlib_zero_combined_counter (&policer_counters[i], policer_index);
@@ -190,6 +223,7 @@ policer_reset (vlib_main_t *vm, u32 policer_index)
 
   policer->current_bucket = policer->current_limit;
   policer->extended_bucket = policer->extended_limit;
+  policer_shards_flush (policer, policer_index, false);
 
   return 0;
 }
@@ -212,6 +246,7 @@ policer_bind_worker (u32 policer_index, u32 worker, bool bind)
 	  return VNET_API_ERROR_INVALID_WORKER;
 	}
 
+      policer_shard (policer_index, false);
       policer->thread_index = vlib_get_worker_thread_index (worker);
     }
   else
@@ -221,6 +256,44 @@ policer_bind_worker (u32 policer_index, u32 worker, bool bind)
   return 0;
 }
 
+int
+policer_shard (u32 policer_index, bool enable)
+{
+  vnet_policer_main_t *pm = &vnet_policer_main;
+  policer_t *policer;
+  u32 n_threads = vlib_get_n_threads ();
+  u32 i;
+
+  if (pool_is_free_index (pm->policers, policer_index))
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  policer = &pm->policers[policer_index];
+
+  if (enable == policer->sharded)
+    return 0;
+
+  if (enable)
+    {
+      vec_validate (pm->shards, n_threads - 1);
+      for (i = 0; i < n_threads; i++)
+	vec_validate_aligned (pm->shards[i], policer_index,
+			      CLIB_CACHE_LINE_BYTES);
+
+      policer_shards_flush (policer, policer_index, false);
+      /* cap the tokens cached by all threads to a quarter of the burst */
+      policer->shard_shift = max_log2 (n_threads) + 2;
+      policer->thread_index = ~0;
+      policer->sharded = 1;
+    }
+  else
+    {
+      policer->sharded = 0;
+      policer_shards_flush (policer, policer_index, true);
+    }
+
+  return 0;
+}
+
 int
 policer_input (u32 policer_index, u32 sw_if_index, vlib_dir_t dir, bool apply)
 {
@@ -275,6 +348,20 @@ format_policer_instance (u8 * s, va_list * va)
 	      i->current_limit,
 	      i->current_bucket, i->extended_limit, i->extended_bucket);
   s = format (s, "last update %llu\n", i->last_update_time);
+  if (i->sharded)
+    {
+      u64 cur = 0, ext = 0;
+      u32 ti;
+
+      vec_foreach_index (ti, pm->shards)
+	{
+	  cur += pm->shards[ti][policer_index].current_bucket;
+	  ext += pm->shards[ti][policer_index].extended_bucket;
+	}
+      s = format (s, "sharded over %u threads, top-up lim/%u, "
+		  "cur bkt %llu, ext bkt %llu cached\n",
+		  vec_len (pm->shards), 1 << i->shard_shift, cur, ext);
+    }
   s = format (s, "conform %llu packets, %llu bytes\n",
 	      counts[POLICE_CONFORM].packets, counts[POLICE_CONFORM].bytes);
   s = format (s, "exceed %llu packets, %llu bytes\n",
@@ -758,6 +845,60 @@ done:
   return error;
 }
 
+static clib_error_t *
+policer_shard_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			  vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  clib_error_t *error = NULL;
+  vnet_policer_main_t *pm = &vnet_policer_main;
+  u8 enable = 1;
+  u8 *name = 0;
+  u32 policer_index = ~0;
+  uword *p;
+  int rv;
+
+  /* Get a line of input. */
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "name %s", &name))
+	;
+      else if (unformat (line_input, "index %u", &policer_index))
+	;
+      else if (unformat (line_input, "disable"))
+	enable = 0;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (~0 == policer_index && 0 != name)
+    {
+      p = hash_get_mem (pm->policer_index_by_name, name);
+      if (p != NULL)
+	policer_index = p[0];
+    }
+
+  rv = VNET_API_ERROR_NO_SUCH_ENTRY;
+  if (~0 != policer_index)
+    rv = policer_shard (policer_index, enable);
+
+  if (rv)
+    error = clib_error_return (0, "failed: `%d'", rv);
+
+done:
+  unformat_free (line_input);
+  vec_free (name);
+
+  return error;
+}
+
 static clib_error_t *
 policer_input_command_fn (vlib_main_t *vm, unformat_input_t *input,
 			  vlib_cli_command_t *cmd)
@@ -917,6 +1058,21 @@ VLIB_CLI_COMMAND (policer_bind_command, static) = {
   .function = policer_bind_command_fn,
 };
 
+/*?
+ * Police packets on the thread that receives them rather than handing
+ * them off to, or serializing on, a single thread. Each thread owns a
+ * slice of the token buckets and tops it up from the policer when it
+ * runs out. Binding the policer to a worker disables sharding.
+ *
+ * @cliexpar
+ * @cliexcmd{policer shard name pol1}
+?*/
+VLIB_CLI_COMMAND (policer_shard_command, static) = {
+  .path = "policer shard",
+  .short_help = "policer shard [disable] [name <name> | index <index>]",
+  .function = policer_shard_command_fn,
+};
+
 VLIB_CLI_COMMAND (policer_input_command, static) = {
   .path = "policer input",
   .short_help =
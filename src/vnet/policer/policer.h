@@ -38,6 +38,9 @@ typedef struct
   /* Policer by name hash */
   uword *policer_index_by_name;
 
+  /* Per thread token shards of sharded policers, indexed by policer */
+  policer_shard_t **shards;
+
   /* Policer by sw_if_index vector */
   u32 *policer_index_by_sw_if_index[VLIB_N_RX_TX];
 
@@ -76,6 +79,7 @@ int policer_update (vlib_main_t *vm, u32 policer_index,
 int policer_del (vlib_main_t *vm, u32 policer_index);
 int policer_reset (vlib_main_t *vm, u32 policer_index);
 int policer_bind_worker (u32 policer_index, u32 worker, bool bind);
+int policer_shard (u32 policer_index, bool enable);
 int policer_input (u32 policer_index, u32 sw_if_index, vlib_dir_t dir,
 		   bool apply);
 
@@ -221,6 +221,17 @@ vl_api_policer_bind_v2_t_handler (vl_api_policer_bind_v2_t *mp)
   REPLY_MACRO (VL_API_POLICER_BIND_V2_REPLY);
 }
 
+static void
+vl_api_policer_shard_t_handler (vl_api_policer_shard_t *mp)
+{
+  vl_api_policer_shard_reply_t *rmp;
+  int rv;
+
+  rv = policer_shard (ntohl (mp->policer_index), mp->enable);
+
+  REPLY_MACRO (VL_API_POLICER_SHARD_REPLY);
+}
+
 static void
 vl_api_policer_input_t_handler (vl_api_policer_input_t *mp)
 {
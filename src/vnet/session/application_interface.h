@@ -653,6 +653,32 @@ app_send_io_evt_to_vpp (svm_msg_q_t * mq, u32 session_index, u8 evt_type,
   app_send_dgram_raw_gso (f, at, vpp_evt_q, data, len, 0, evt_type, do_evt,   \
 			  noblock)
 
+/**
+ * Send io events for multiple sessions to vpp under one mq lock
+ *
+ * Vpp is signaled at most once per batch, i.e., if the mq was empty.
+ */
+always_inline void
+app_send_io_evts_to_vpp (svm_msg_q_t *mq, session_event_t *evts, u32 n_evts)
+{
+  session_event_t *evt;
+  svm_msg_q_msg_t msg;
+  u32 i;
+
+  svm_msg_q_lock (mq);
+  for (i = 0; i < n_evts; i++)
+    {
+      while (svm_msg_q_or_ring_is_full (mq, SESSION_MQ_IO_EVT_RING))
+	svm_msg_q_or_ring_wait_prod (mq, SESSION_MQ_IO_EVT_RING);
+      msg = svm_msg_q_alloc_msg_w_ring (mq, SESSION_MQ_IO_EVT_RING);
+      evt = (session_event_t *) svm_msg_q_msg_data (mq, &msg);
+      evt->session_index = evts[i].session_index;
+      evt->event_type = evts[i].event_type;
+      svm_msg_q_add_raw (mq, &msg);
+    }
+  svm_msg_q_unlock (mq);
+}
+
 always_inline int
 app_send_dgram_raw_gso (svm_fifo_t *f, app_session_transport_t *at,
 			svm_msg_q_t *vpp_evt_q, u8 *data, u32 len,
@@ -727,6 +753,38 @@ app_send (app_session_t * s, u8 * data, u32 len, u8 noblock)
   return app_send_stream (s, data, len, noblock);
 }
 
+/**
+ * Move up to len bytes from src_f to dst_f without copying, if possible
+ *
+ * Intended for apps that relay data between sessions, like proxies. Caller
+ * must be the consumer of src_f and the producer of dst_f.
+ */
+always_inline int
+app_splice_stream_raw (svm_fifo_t *dst_f, svm_fifo_t *src_f,
+		       svm_msg_q_t *vpp_evt_q, u32 len, u8 evt_type, u8 do_evt,
+		       u8 noblock)
+{
+  int rv;
+
+  rv = svm_fifo_splice (dst_f, src_f, len);
+  if (do_evt)
+    {
+      if (rv > 0 && svm_fifo_set_event (dst_f))
+	app_send_io_evt_to_vpp (vpp_evt_q, dst_f->shr->master_session_index,
+				evt_type, noblock);
+    }
+  return rv;
+}
+
+always_inline int
+app_splice_stream (app_session_t *dst, app_session_t *src, u32 len,
+		   u8 noblock)
+{
+  return app_splice_stream_raw (dst->tx_fifo, src->rx_fifo, dst->vpp_evt_q,
+				len, SESSION_IO_EVT_TX, 1 /* do_evt */,
+				noblock);
+}
+
 always_inline int
 app_recv_dgram_raw (svm_fifo_t * f, u8 * buf, u32 len,
 		    app_session_transport_t * at, u8 clear_evt, u8 peek)
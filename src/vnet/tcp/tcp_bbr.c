@@ -0,0 +1,600 @@
+/*
+ * Copyright (c) 2024 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * BBR congestion control (draft-cardwell-iccrg-bbr-congestion-control)
+ *
+ * Model based congestion control that estimates bottleneck bandwidth and
+ * round trip propagation delay from delivery rate samples provided by the
+ * byte tracker (tcp_bt.c) and uses them to drive the tx pacer and to bound
+ * cwnd. As in BBRv2, excessive loss bounds the amount of data in flight
+ * instead of being ignored.
+ */
+
+#include <vnet/tcp/tcp.h>
+#include <vnet/tcp/tcp_inlines.h>
+
+/** Gains are fixed point numbers with BBR_UNIT as 1 */
+#define BBR_UNIT		256
+#define BBR_HIGH_GAIN		739	/**< 2/ln(2) */
+#define BBR_DRAIN_GAIN		88	/**< 1/high_gain */
+#define BBR_CWND_GAIN		512
+#define BBR_FULL_BW_THRESH	320	/**< 1.25, bw growth to stay in startup */
+#define BBR_FULL_BW_CNT		3	/**< rounds without growth to exit startup */
+#define BBR_BW_RTTS		10	/**< max bw filter window in rounds */
+#define BBR_CYCLE_LEN		8
+#define BBR_MIN_CWND_SEGS	4
+#define BBR_BETA		179	/**< 0.7, inflight_hi reduction on loss */
+
+typedef enum bbr_mode_
+{
+  BBR_MODE_STARTUP,
+  BBR_MODE_DRAIN,
+  BBR_MODE_PROBE_BW,
+  BBR_MODE_PROBE_RTT,
+} bbr_mode_e;
+
+typedef enum bbr_flags_
+{
+  BBR_F_ROUND_START = 1 << 0,
+  BBR_F_FILLED_PIPE = 1 << 1,
+  BBR_F_IDLE_RESTART = 1 << 2,
+  BBR_F_PROBE_RTT_ROUND_DONE = 1 << 3,
+  BBR_F_CYCLE_LOSS = 1 << 4,
+} bbr_flags_e;
+
+typedef struct bbr_cfg_
+{
+  u32 min_rtt_win_ms;	/**< Validity of min rtt estimate */
+  u32 probe_rtt_ms;	/**< Time spent with minimal cwnd in probe rtt */
+  u32 loss_thresh;	/**< Loss rate (%) that bounds inflight */
+} bbr_cfg_t;
+
+static bbr_cfg_t bbr_cfg = {
+  .min_rtt_win_ms = 10000,
+  .probe_rtt_ms = 200,
+  .loss_thresh = 2,
+};
+
+typedef struct bbr_bw_sample_
+{
+  u32 round;
+  u32 bw;
+} bbr_bw_sample_t;
+
+typedef struct bbr_data_
+{
+  /** delivered bytes that mark the end of current round */
+  u64 next_round_delivered;
+
+  /** windowed max filter of delivery rate (bytes per ms) */
+  bbr_bw_sample_t max_bw[3];
+
+  u32 round_count;		/**< Packet timed round trips */
+  u32 min_rtt_us;		/**< Min rtt over min_rtt_win_ms */
+  u32 min_rtt_stamp;		/**< Time (ms) min rtt was measured */
+  u32 probe_rtt_done_stamp;	/**< Time (ms) probe rtt can end */
+  u32 cycle_stamp;		/**< Time (ms) current gain cycle started */
+  u32 full_bw;			/**< Bw used to detect full pipe */
+  u32 prior_cwnd;		/**< Cwnd before recovery or probe rtt */
+  u32 inflight_hi;		/**< Upper bound on inflight due to loss */
+  u8 mode;			/**< Current state, see bbr_mode_e */
+  u8 cycle_idx;			/**< Index into probe bw gain cycle */
+  u8 full_bw_cnt;		/**< Rounds without significant bw growth */
+  u8 flags;			/**< See bbr_flags_e */
+} __clib_packed bbr_data_t;
+
+STATIC_ASSERT (sizeof (bbr_data_t) <= TCP_CC_DATA_SZ, "bbr data len");
+
+static const u16 bbr_pacing_gain_cycle[BBR_CYCLE_LEN] = {
+  320, 192, 256, 256, 256, 256, 256, 256
+};
+
+static inline u32
+bbr_time_ms (tcp_connection_t * tc)
+{
+  return (u32) (tcp_time_now_us (tc->c_thread_index) * 1e3);
+}
+
+static inline u32
+bbr_max_bw (bbr_data_t * bd)
+{
+  return bd->max_bw[0].bw;
+}
+
+/**
+ * Windowed max filter (Kathleen Nichols), keeps best, second best and
+ * third best estimates over the last BBR_BW_RTTS rounds.
+ */
+static void
+bbr_max_bw_update (bbr_data_t * bd, u32 bw)
+{
+  bbr_bw_sample_t *s = bd->max_bw, val = {.round = bd->round_count,.bw = bw };
+  u32 dt;
+
+  if (bw >= s[0].bw || val.round - s[2].round > BBR_BW_RTTS)
+    {
+      s[0] = s[1] = s[2] = val;
+      return;
+    }
+
+  if (bw >= s[1].bw)
+    s[2] = s[1] = val;
+  else if (bw >= s[2].bw)
+    s[2] = val;
+
+  /* Age out best estimates that fell out of the window */
+  dt = val.round - s[0].round;
+  if (dt > BBR_BW_RTTS)
+    {
+      s[0] = s[1];
+      s[1] = s[2];
+      s[2] = val;
+      if (val.round - s[0].round > BBR_BW_RTTS)
+	{
+	  s[0] = s[1];
+	  s[1] = s[2];
+	  s[2] = val;
+	}
+    }
+  else if (s[1].round == s[0].round && dt > BBR_BW_RTTS / 4)
+    s[2] = s[1] = val;
+  else if (s[2].round == s[1].round && dt > BBR_BW_RTTS / 2)
+    s[2] = val;
+}
+
+/**
+ * Estimated bandwidth-delay product scaled by gain, i.e., amount of data
+ * that should be in flight.
+ */
+static u32
+bbr_inflight (tcp_connection_t * tc, bbr_data_t * bd, u32 gain)
+{
+  u64 bdp;
+
+  if (!bd->min_rtt_us || !bbr_max_bw (bd))
+    return tcp_initial_cwnd (tc);
+
+  bdp = (u64) bbr_max_bw (bd) * bd->min_rtt_us / 1000;
+  return clib_min ((bdp * gain) / BBR_UNIT, (u64) 0x7FFFFFFFU);
+}
+
+static u32
+bbr_pacing_gain (bbr_data_t * bd)
+{
+  switch (bd->mode)
+    {
+    case BBR_MODE_STARTUP:
+      return BBR_HIGH_GAIN;
+    case BBR_MODE_DRAIN:
+      return BBR_DRAIN_GAIN;
+    case BBR_MODE_PROBE_BW:
+      return bbr_pacing_gain_cycle[bd->cycle_idx];
+    default:
+      return BBR_UNIT;
+    }
+}
+
+static void
+bbr_enter_startup (bbr_data_t * bd)
+{
+  bd->mode = BBR_MODE_STARTUP;
+}
+
+static void
+bbr_enter_probe_bw (tcp_connection_t * tc, bbr_data_t * bd)
+{
+  bd->mode = BBR_MODE_PROBE_BW;
+  /* Start in random phase, except drain, to avoid synchronization with
+   * other flows. Initial sequence number is random as per RFC6528 */
+  bd->cycle_idx = BBR_CYCLE_LEN - 1 - (tc->iss % (BBR_CYCLE_LEN - 1));
+  bd->cycle_stamp = bbr_time_ms (tc);
+}
+
+static void
+bbr_update_round (tcp_connection_t * tc, bbr_data_t * bd,
+		  tcp_rate_sample_t * rs)
+{
+  bd->flags &= ~BBR_F_ROUND_START;
+  if (rs->delivered && rs->prior_delivered >= bd->next_round_delivered)
+    {
+      bd->next_round_delivered = tc->delivered;
+      bd->round_count++;
+      bd->flags |= BBR_F_ROUND_START;
+    }
+}
+
+static void
+bbr_update_bw (tcp_connection_t * tc, bbr_data_t * bd,
+	       tcp_rate_sample_t * rs)
+{
+  u32 bw;
+
+  if (!rs->delivered || rs->interval_time <= 0)
+    return;
+
+  /* Samples over less than min rtt are not reliable */
+  if (bd->min_rtt_us && rs->interval_time * 1e6 < bd->min_rtt_us)
+    return;
+
+  bw = clib_max ((f64) rs->delivered / (rs->interval_time * 1e3), 1.0);
+
+  /* App limited samples underestimate bw, use them only if they increase
+   * the estimate */
+  if (!(rs->flags & TCP_BTS_IS_APP_LIMITED) || bw >= bbr_max_bw (bd))
+    bbr_max_bw_update (bd, bw);
+}
+
+/**
+ * BBRv2 style loss response. If loss rate over the sample is above
+ * threshold, bound inflight and stop probing for more bandwidth.
+ */
+static void
+bbr_check_loss (tcp_connection_t * tc, bbr_data_t * bd,
+		tcp_rate_sample_t * rs)
+{
+  u32 inflight_hi;
+
+  if (!rs->lost || !rs->tx_in_flight
+      || (u64) rs->lost * 100 <= (u64) rs->tx_in_flight * bbr_cfg.loss_thresh)
+    return;
+
+  bd->flags |= BBR_F_CYCLE_LOSS;
+  inflight_hi = clib_max ((rs->tx_in_flight * BBR_BETA) / BBR_UNIT,
+			  bbr_inflight (tc, bd, BBR_UNIT));
+  inflight_hi = clib_max (inflight_hi, BBR_MIN_CWND_SEGS * tc->snd_mss);
+  if (!bd->inflight_hi || inflight_hi < bd->inflight_hi)
+    bd->inflight_hi = inflight_hi;
+
+  if (bd->mode == BBR_MODE_STARTUP)
+    bd->flags |= BBR_F_FILLED_PIPE;
+  else if (bd->mode == BBR_MODE_PROBE_BW
+	   && bbr_pacing_gain_cycle[bd->cycle_idx] > BBR_UNIT)
+    {
+      /* Move to drain phase of the cycle */
+      bd->cycle_idx = 1;
+      bd->cycle_stamp = bbr_time_ms (tc);
+    }
+}
+
+static void
+bbr_check_full_pipe (bbr_data_t * bd, tcp_rate_sample_t * rs)
+{
+  if ((bd->flags & BBR_F_FILLED_PIPE) || !(bd->flags & BBR_F_ROUND_START)
+      || (rs->flags & TCP_BTS_IS_APP_LIMITED))
+    return;
+
+  /* Still growing? */
+  if ((u64) bbr_max_bw (bd) * BBR_UNIT >=
+      (u64) bd->full_bw * BBR_FULL_BW_THRESH)
+    {
+      bd->full_bw = bbr_max_bw (bd);
+      bd->full_bw_cnt = 0;
+      return;
+    }
+
+  if (++bd->full_bw_cnt >= BBR_FULL_BW_CNT)
+    bd->flags |= BBR_F_FILLED_PIPE;
+}
+
+static void
+bbr_update_gain_cycle (tcp_connection_t * tc, bbr_data_t * bd,
+		       tcp_rate_sample_t * rs, u32 now)
+{
+  u32 gain = bbr_pacing_gain_cycle[bd->cycle_idx];
+  u32 flight = tcp_flight_size (tc);
+  int full_length;
+
+  full_length = now - bd->cycle_stamp > bd->min_rtt_us / 1000;
+
+  if (gain > BBR_UNIT)
+    {
+      /* Probe until we fill the pipe at the higher rate or see losses */
+      if (!(full_length && (rs->lost || flight >= bbr_inflight (tc, bd,
+								 gain))))
+	return;
+    }
+  else if (gain < BBR_UNIT)
+    {
+      /* Drain until queue is gone */
+      if (!full_length && flight > bbr_inflight (tc, bd, BBR_UNIT))
+	return;
+    }
+  else if (!full_length)
+    return;
+
+  bd->cycle_idx = (bd->cycle_idx + 1) % BBR_CYCLE_LEN;
+  bd->cycle_stamp = now;
+
+  /* New probing phase. If no loss in last cycle, allow inflight to grow */
+  if (bd->cycle_idx == 0)
+    {
+      if (!(bd->flags & BBR_F_CYCLE_LOSS) && bd->inflight_hi)
+	{
+	  bd->inflight_hi += bd->inflight_hi / 4;
+	  if (bd->inflight_hi > bbr_inflight (tc, bd, BBR_CWND_GAIN))
+	    bd->inflight_hi = 0;
+	}
+      bd->flags &= ~BBR_F_CYCLE_LOSS;
+    }
+}
+
+static void
+bbr_update_probe_rtt (tcp_connection_t * tc, bbr_data_t * bd, u32 now)
+{
+  if (!bd->probe_rtt_done_stamp
+      && tcp_flight_size (tc) <= BBR_MIN_CWND_SEGS * tc->snd_mss)
+    {
+      bd->probe_rtt_done_stamp = clib_max (now + bbr_cfg.probe_rtt_ms, 1);
+      bd->flags &= ~BBR_F_PROBE_RTT_ROUND_DONE;
+      bd->next_round_delivered = tc->delivered;
+      return;
+    }
+
+  if (!bd->probe_rtt_done_stamp)
+    return;
+
+  if (bd->flags & BBR_F_ROUND_START)
+    bd->flags |= BBR_F_PROBE_RTT_ROUND_DONE;
+
+  if ((bd->flags & BBR_F_PROBE_RTT_ROUND_DONE)
+      && (i32) (now - bd->probe_rtt_done_stamp) > 0)
+    {
+      bd->min_rtt_stamp = now;
+      tc->cwnd = clib_max (tc->cwnd, bd->prior_cwnd);
+      if (bd->flags & BBR_F_FILLED_PIPE)
+	bbr_enter_probe_bw (tc, bd);
+      else
+	bbr_enter_startup (bd);
+    }
+}
+
+static void
+bbr_update_min_rtt (tcp_connection_t * tc, bbr_data_t * bd,
+		    tcp_rate_sample_t * rs, u32 now)
+{
+  u32 rtt_us = rs->rtt_time * 1e6;
+  int expired;
+
+  expired = now - bd->min_rtt_stamp > bbr_cfg.min_rtt_win_ms;
+  if (rtt_us && (!bd->min_rtt_us || rtt_us < bd->min_rtt_us || expired))
+    {
+      bd->min_rtt_us = rtt_us;
+      bd->min_rtt_stamp = now;
+    }
+
+  if (expired && bd->mode != BBR_MODE_PROBE_RTT
+      && !(bd->flags & BBR_F_IDLE_RESTART))
+    {
+      bd->mode = BBR_MODE_PROBE_RTT;
+      bd->prior_cwnd = clib_max (bd->prior_cwnd, tc->cwnd);
+      bd->probe_rtt_done_stamp = 0;
+    }
+
+  if (bd->mode == BBR_MODE_PROBE_RTT)
+    bbr_update_probe_rtt (tc, bd, now);
+
+  if (rs->delivered)
+    bd->flags &= ~BBR_F_IDLE_RESTART;
+}
+
+static void
+bbr_update_model (tcp_connection_t * tc, bbr_data_t * bd,
+		  tcp_rate_sample_t * rs)
+{
+  u32 now = bbr_time_ms (tc);
+
+  bbr_update_round (tc, bd, rs);
+  bbr_update_bw (tc, bd, rs);
+  bbr_check_loss (tc, bd, rs);
+  bbr_check_full_pipe (bd, rs);
+
+  if (bd->mode == BBR_MODE_STARTUP && (bd->flags & BBR_F_FILLED_PIPE))
+    bd->mode = BBR_MODE_DRAIN;
+  if (bd->mode == BBR_MODE_DRAIN
+      && tcp_flight_size (tc) <= bbr_inflight (tc, bd, BBR_UNIT))
+    bbr_enter_probe_bw (tc, bd);
+  if (bd->mode == BBR_MODE_PROBE_BW)
+    bbr_update_gain_cycle (tc, bd, rs, now);
+
+  bbr_update_min_rtt (tc, bd, rs, now);
+}
+
+static void
+bbr_set_cwnd (tcp_connection_t * tc, bbr_data_t * bd, u32 delivered)
+{
+  u32 target, min_cwnd = BBR_MIN_CWND_SEGS * tc->snd_mss;
+
+  target = bbr_inflight (tc, bd, BBR_CWND_GAIN) + 3 * tc->snd_mss;
+
+  if (bd->flags & BBR_F_FILLED_PIPE)
+    tc->cwnd = clib_min (tc->cwnd + delivered, target);
+  else if (tc->cwnd < target || tc->delivered < tcp_initial_cwnd (tc))
+    tc->cwnd += delivered;
+
+  if (bd->inflight_hi)
+    tc->cwnd = clib_min (tc->cwnd, bd->inflight_hi);
+
+  tc->cwnd = clib_max (tc->cwnd, min_cwnd);
+
+  if (bd->mode == BBR_MODE_PROBE_RTT)
+    tc->cwnd = clib_min (tc->cwnd, min_cwnd);
+
+  /* Constrained by tx fifo, can't grow further */
+  tc->cwnd = clib_min (tc->cwnd, clib_max (tc->tx_fifo_size, min_cwnd));
+}
+
+static void
+bbr_congestion (tcp_connection_t * tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+  u32 bdp = bbr_inflight (tc, bd, BBR_UNIT);
+
+  bd->prior_cwnd = tc->cwnd;
+
+  /* Recovery is paced by prr towards ssthresh. Do not drop below the
+   * estimated bdp as loss is not necessarily a congestion signal */
+  tc->ssthresh = clib_max ((u64) tc->cwnd * BBR_BETA / BBR_UNIT, bdp);
+  tc->ssthresh = clib_max (tc->ssthresh, BBR_MIN_CWND_SEGS * tc->snd_mss);
+  tc->ssthresh = clib_min (tc->ssthresh, tc->cwnd);
+  tc->cwnd = tc->ssthresh;
+}
+
+static void
+bbr_loss (tcp_connection_t * tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  bd->prior_cwnd = clib_max (bd->prior_cwnd, tc->cwnd);
+  tc->cwnd = tcp_loss_wnd (tc);
+  bd->full_bw = 0;
+  bd->full_bw_cnt = 0;
+}
+
+static void
+bbr_recovered (tcp_connection_t * tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  tc->cwnd = clib_max (tc->cwnd, bd->prior_cwnd);
+  if (bd->inflight_hi)
+    tc->cwnd = clib_min (tc->cwnd, clib_max (bd->inflight_hi, tc->ssthresh));
+  bd->prior_cwnd = 0;
+}
+
+static void
+bbr_rcv_ack (tcp_connection_t * tc, tcp_rate_sample_t * rs)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  bbr_update_model (tc, bd, rs);
+  bbr_set_cwnd (tc, bd, rs->delivered);
+}
+
+static void
+bbr_rcv_cong_ack (tcp_connection_t * tc, tcp_cc_ack_t ack_type,
+		  tcp_rate_sample_t * rs)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  /* Keep the model up to date. Data in flight is controlled by prr */
+  bbr_update_model (tc, bd, rs);
+  newreno_rcv_cong_ack (tc, ack_type, rs);
+}
+
+static u64
+bbr_get_pacing_rate (tcp_connection_t * tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+  u32 gain = bbr_pacing_gain (bd);
+  f64 srtt;
+
+  if (bbr_max_bw (bd))
+    return clib_max ((u64) bbr_max_bw (bd) * 1000 * gain / BBR_UNIT, 1);
+
+  /* No bw estimate yet, scale cwnd based estimate */
+  srtt = clib_min ((f64) tc->srtt * TCP_TICK, tc->mrtt_us);
+  return ((f64) tc->cwnd / srtt) * gain / BBR_UNIT;
+}
+
+static void
+bbr_event (tcp_connection_t * tc, tcp_cc_event_t evt)
+{
+  bbr_data_t *bd;
+
+  if (evt != TCP_CC_EVT_START_TX)
+    return;
+
+  /* App was idle. Restart at estimated bw and do not mistake lack of
+   * rtt samples for an expired min rtt */
+  bd = (bbr_data_t *) tcp_cc_data (tc);
+  bd->flags |= BBR_F_IDLE_RESTART;
+  if (bd->mode == BBR_MODE_PROBE_BW)
+    bd->cycle_stamp = bbr_time_ms (tc);
+}
+
+static void
+bbr_conn_init (tcp_connection_t * tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  clib_memset (bd, 0, sizeof (*bd));
+  tc->ssthresh = 0x7FFFFFFFU;
+  tc->cwnd = tcp_initial_cwnd (tc);
+
+  bd->next_round_delivered = tc->delivered;
+  bd->min_rtt_stamp = bbr_time_ms (tc);
+  bbr_enter_startup (bd);
+
+  /* Model is built out of delivery rate samples */
+  tc->cfg_flags |= TCP_CFG_F_RATE_SAMPLE;
+}
+
+static uword
+bbr_unformat_config (unformat_input_t * input)
+{
+  u32 tmp;
+
+  if (!input)
+    return 0;
+
+  unformat_skip_white_space (input);
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "min-rtt-window %u", &tmp))
+	bbr_cfg.min_rtt_win_ms = tmp;
+      else if (unformat (input, "probe-rtt-time %u", &tmp))
+	bbr_cfg.probe_rtt_ms = tmp;
+      else if (unformat (input, "loss-thresh %u", &tmp) && tmp <= 100)
+	bbr_cfg.loss_thresh = tmp;
+      else
+	return 0;
+    }
+  return 1;
+}
+
+const static tcp_cc_algorithm_t tcp_bbr = {
+  .name = "bbr",
+  .unformat_cfg = bbr_unformat_config,
+  .congestion = bbr_congestion,
+  .loss = bbr_loss,
+  .recovered = bbr_recovered,
+  .rcv_ack = bbr_rcv_ack,
+  .rcv_cong_ack = bbr_rcv_cong_ack,
+  .event = bbr_event,
+  .get_pacing_rate = bbr_get_pacing_rate,
+  .init = bbr_conn_init,
+};
+
+clib_error_t *
+bbr_init (vlib_main_t * vm)
+{
+  clib_error_t *error = 0;
+
+  tcp_cc_algo_register (TCP_CC_BBR, &tcp_bbr);
+
+  return error;
+}
+
+VLIB_INIT_FUNCTION (bbr_init);
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,255 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2024 Cisco Systems, Inc.
+ */
+
+#ifndef __crypto_chacha20_h__
+#define __crypto_chacha20_h__
+
+#include <vppinfra/clib.h>
+#include <vppinfra/vector.h>
+#include <vppinfra/cache.h>
+#include <vppinfra/string.h>
+
+/* implementation of DJB's ChaCha20 as specified in RFC8439
+ *
+ * state is kept in "lane per block" layout - each vector register holds
+ * the same state word of N_CHACHA20_LANES independent blocks, so blocks
+ * can belong to the same stream (consecutive counters) or to different
+ * streams (different key / nonce per lane) */
+
+#define N_CHACHA20_BLOCK_BYTES 64
+
+#if defined(CLIB_HAVE_VEC512)
+#define N_CHACHA20_LANES 16
+typedef u32x16 chacha20_lanes_t;
+#define chacha20_lanes_splat(x) u32x16_splat (x)
+#define CHACHA20_LANE_INDEX                                                   \
+  (u32x16)                                                                    \
+  {                                                                           \
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15                      \
+  }
+#elif defined(CLIB_HAVE_VEC256)
+#define N_CHACHA20_LANES 8
+typedef u32x8 chacha20_lanes_t;
+#define chacha20_lanes_splat(x) u32x8_splat (x)
+#define CHACHA20_LANE_INDEX                                                   \
+  (u32x8)                                                                     \
+  {                                                                           \
+    0, 1, 2, 3, 4, 5, 6, 7                                                    \
+  }
+#else
+#define N_CHACHA20_LANES 4
+typedef u32x4 chacha20_lanes_t;
+#define chacha20_lanes_splat(x) u32x4_splat (x)
+#define CHACHA20_LANE_INDEX                                                   \
+  (u32x4)                                                                     \
+  {                                                                           \
+    0, 1, 2, 3                                                                \
+  }
+#endif
+
+#define N_CHACHA20_PARALLEL_BYTES (N_CHACHA20_LANES * N_CHACHA20_BLOCK_BYTES)
+
+typedef struct
+{
+  /* constants, key, block counter, nonce */
+  u32 state[16];
+  u8 keystream_bytes[N_CHACHA20_BLOCK_BYTES]; /* keystream leftovers */
+  u32 n_keystream_bytes; /* number of keystream leftovers */
+} clib_chacha20_ctx_t;
+
+static const u32 chacha20_sigma[4] = { 0x61707865, 0x3320646e, 0x79622d32,
+				       0x6b206574 };
+
+static_always_inline chacha20_lanes_t
+chacha20_rotl (chacha20_lanes_t v, const int n)
+{
+  return (v << n) | (v >> (32 - n));
+}
+
+#define CHACHA20_QR(a, b, c, d)                                               \
+  do                                                                          \
+    {                                                                         \
+      x[a] += x[b];                                                           \
+      x[d] = chacha20_rotl (x[d] ^ x[a], 16);                                 \
+      x[c] += x[d];                                                           \
+      x[b] = chacha20_rotl (x[b] ^ x[c], 12);                                 \
+      x[a] += x[b];                                                           \
+      x[d] = chacha20_rotl (x[d] ^ x[a], 8);                                  \
+      x[c] += x[d];                                                           \
+      x[b] = chacha20_rotl (x[b] ^ x[c], 7);                                  \
+    }                                                                         \
+  while (0)
+
+/* run 20 rounds on N_CHACHA20_LANES blocks and store keystream in block
+ * order (block 0 first) */
+static_always_inline void
+chacha20_lanes_keystream (const chacha20_lanes_t s[16], u8 *out)
+{
+  chacha20_lanes_t x[16];
+
+  for (int i = 0; i < 16; i++)
+    x[i] = s[i];
+
+  for (int i = 0; i < 10; i++)
+    {
+      /* column rounds */
+      CHACHA20_QR (0, 4, 8, 12);
+      CHACHA20_QR (1, 5, 9, 13);
+      CHACHA20_QR (2, 6, 10, 14);
+      CHACHA20_QR (3, 7, 11, 15);
+      /* diagonal rounds */
+      CHACHA20_QR (0, 5, 10, 15);
+      CHACHA20_QR (1, 6, 11, 12);
+      CHACHA20_QR (2, 7, 8, 13);
+      CHACHA20_QR (3, 4, 9, 14);
+    }
+
+  for (int i = 0; i < 16; i++)
+    x[i] += s[i];
+
+  /* transpose from lane per block to block per row */
+#if N_CHACHA20_LANES == 16
+  u32x16_transpose (x);
+  for (int i = 0; i < 16; i++)
+    ((u32x16u *) out)[i] = x[i];
+#elif N_CHACHA20_LANES == 8
+  u32x8_transpose (x);
+  u32x8_transpose (x + 8);
+  for (int i = 0; i < 8; i++)
+    {
+      ((u32x8u *) out)[2 * i] = x[i];
+      ((u32x8u *) out)[2 * i + 1] = x[i + 8];
+    }
+#else
+  for (int b = 0; b < N_CHACHA20_LANES; b++)
+    for (int i = 0; i < 16; i++)
+      ((u32u *) out)[b * 16 + i] = x[i][b];
+#endif
+}
+
+#undef CHACHA20_QR
+
+static_always_inline void
+clib_chacha20_init (clib_chacha20_ctx_t *ctx, const u8 *key, const u8 *nonce,
+		    u32 counter)
+{
+  for (int i = 0; i < 4; i++)
+    ctx->state[i] = chacha20_sigma[i];
+  for (int i = 0; i < 8; i++)
+    ctx->state[4 + i] = clib_host_to_little_u32 (((u32u *) key)[i]);
+  ctx->state[12] = counter;
+  for (int i = 0; i < 3; i++)
+    ctx->state[13 + i] = clib_host_to_little_u32 (((u32u *) nonce)[i]);
+  ctx->n_keystream_bytes = 0;
+}
+
+static_always_inline void
+chacha20_xor (const u8 *src, u8 *dst, const u8 *ks, u32 n_bytes)
+{
+  for (; n_bytes >= 8; n_bytes -= 8, src += 8, dst += 8, ks += 8)
+    *(u64u *) dst = *(u64u *) src ^ *(u64u *) ks;
+  for (int i = 0; i < n_bytes; i++)
+    dst[i] = src[i] ^ ks[i];
+}
+
+static_always_inline void
+clib_chacha20_transform (clib_chacha20_ctx_t *ctx, const u8 *src, u8 *dst,
+			 u32 n_bytes)
+{
+  u8 ks[N_CHACHA20_PARALLEL_BYTES] __clib_aligned (64);
+  chacha20_lanes_t s[16];
+
+  if (ctx->n_keystream_bytes)
+    {
+      u8 *k = ctx->keystream_bytes + N_CHACHA20_BLOCK_BYTES -
+	      ctx->n_keystream_bytes;
+      u32 n = clib_min (n_bytes, ctx->n_keystream_bytes);
+
+      chacha20_xor (src, dst, k, n);
+      ctx->n_keystream_bytes -= n;
+      n_bytes -= n;
+      src += n;
+      dst += n;
+    }
+
+  if (n_bytes == 0)
+    return;
+
+  for (int i = 0; i < 16; i++)
+    s[i] = chacha20_lanes_splat (ctx->state[i]);
+  s[12] += CHACHA20_LANE_INDEX;
+
+  for (; n_bytes >= N_CHACHA20_PARALLEL_BYTES;
+       n_bytes -= N_CHACHA20_PARALLEL_BYTES)
+    {
+      chacha20_lanes_keystream (s, ks);
+      chacha20_xor (src, dst, ks, N_CHACHA20_PARALLEL_BYTES);
+      s[12] += N_CHACHA20_LANES;
+      ctx->state[12] += N_CHACHA20_LANES;
+      src += N_CHACHA20_PARALLEL_BYTES;
+      dst += N_CHACHA20_PARALLEL_BYTES;
+    }
+
+  if (n_bytes)
+    {
+      u32 n_blocks = round_pow2 (n_bytes, N_CHACHA20_BLOCK_BYTES) /
+		     N_CHACHA20_BLOCK_BYTES;
+      u32 last = (n_blocks - 1) * N_CHACHA20_BLOCK_BYTES;
+
+      chacha20_lanes_keystream (s, ks);
+      chacha20_xor (src, dst, ks, n_bytes);
+      ctx->state[12] += n_blocks;
+
+      /* keep leftovers of last block for next call */
+      ctx->n_keystream_bytes = last + N_CHACHA20_BLOCK_BYTES - n_bytes;
+      clib_memcpy_fast (ctx->keystream_bytes, ks + last,
+			N_CHACHA20_BLOCK_BYTES);
+    }
+}
+
+/* compute first keystream block of up to N_CHACHA20_LANES independent
+ * streams in parallel, each with own key and nonce */
+static_always_inline void
+clib_chacha20_block_multi (const u8 *key[], const u8 *nonce[], u32 counter,
+			   u8 *out[], u32 n_streams)
+{
+  u8 ks[N_CHACHA20_PARALLEL_BYTES] __clib_aligned (64);
+  u32 w[16][N_CHACHA20_LANES] __clib_aligned (64);
+  chacha20_lanes_t s[16];
+
+  ASSERT (n_streams <= N_CHACHA20_LANES);
+
+  for (int l = 0; l < N_CHACHA20_LANES; l++)
+    {
+      /* unused lanes are filled with copy of lane 0 */
+      u32 j = l < n_streams ? l : 0;
+      for (int i = 0; i < 8; i++)
+	w[4 + i][l] = clib_host_to_little_u32 (((u32u *) key[j])[i]);
+      for (int i = 0; i < 3; i++)
+	w[13 + i][l] = clib_host_to_little_u32 (((u32u *) nonce[j])[i]);
+    }
+
+  for (int i = 0; i < 4; i++)
+    s[i] = chacha20_lanes_splat (chacha20_sigma[i]);
+  for (int i = 4; i < 16; i++)
+    s[i] = *(chacha20_lanes_t *) w[i];
+  s[12] = chacha20_lanes_splat (counter);
+
+  chacha20_lanes_keystream (s, ks);
+
+  for (int l = 0; l < n_streams; l++)
+    clib_memcpy_fast (out[l], ks + l * N_CHACHA20_BLOCK_BYTES,
+		      N_CHACHA20_BLOCK_BYTES);
+}
+
+static_always_inline void
+clib_chacha20 (const u8 *key, const u8 *nonce, u32 counter, const u8 *src,
+	       u8 *dst, u32 n_bytes)
+{
+  clib_chacha20_ctx_t ctx;
+  clib_chacha20_init (&ctx, key, nonce, counter);
+  clib_chacha20_transform (&ctx, src, dst, n_bytes);
+}
+
+#endif /* __crypto_chacha20_h__ */
@@ -160,7 +160,7 @@ clib_poly1305_update (clib_poly1305_ctx *ctx, const u8 *msg, uword len)
 
   if (ctx->n_partial_bytes)
     {
-      u16 missing_bytes = 16 - ctx->n_partial_bytes;
+      u16 missing_bytes = 16 - (ctx->n_partial_bytes & 15);
       if (PREDICT_FALSE (n_left < missing_bytes))
 	{
 	  clib_memcpy_fast (ctx->partial.as_u8 + ctx->n_partial_bytes, msg,
@@ -17,6 +17,8 @@
 #define included_sha2_h
 
 #include <vppinfra/clib.h>
+#include <vppinfra/vector.h>
+#include <vppinfra/string.h>
 
 #define SHA224_DIGEST_SIZE 28
 #define SHA224_BLOCK_SIZE  64
@@ -27,9 +29,9 @@
 #define SHA256_CH(a, b, c)  ((a & b) ^ (~a & c))
 #define SHA256_MAJ(a, b, c) ((a & b) ^ (a & c) ^ (b & c))
 #define SHA256_CSIGMA0(x)                                                     \
-  (SHA256_ROTR (x, 2) ^ SHA256_ROTR (x, 13) ^ SHA256_ROTR (x, 22));
+  (SHA256_ROTR (x, 2) ^ SHA256_ROTR (x, 13) ^ SHA256_ROTR (x, 22))
 #define SHA256_CSIGMA1(x)                                                     \
-  (SHA256_ROTR (x, 6) ^ SHA256_ROTR (x, 11) ^ SHA256_ROTR (x, 25));
+  (SHA256_ROTR (x, 6) ^ SHA256_ROTR (x, 11) ^ SHA256_ROTR (x, 25))
 #define SHA256_SSIGMA0(x) (SHA256_ROTR (x, 7) ^ SHA256_ROTR (x, 18) ^ (x >> 3))
 #define SHA256_SSIGMA1(x)                                                     \
   (SHA256_ROTR (x, 17) ^ SHA256_ROTR (x, 19) ^ (x >> 10))
@@ -362,7 +364,7 @@ clib_sha256_block (clib_sha2_ctx_t *ctx, const u8 *msg, uword n_blocks)
 
       for (i = 0; i < 16; i++)
 	{
-	  w[i] = clib_net_to_host_u32 (*((u32 *) msg + i));
+	  w[i] = clib_net_to_host_u32 (*((u32u *) msg + i));
 	  SHA256_TRANSFORM (s, w, i, sha256_k[i]);
 	}
 
@@ -394,7 +396,7 @@ clib_sha512_block (clib_sha2_ctx_t *ctx, const u8 *msg, uword n_blocks)
 
       for (i = 0; i < 16; i++)
 	{
-	  w[i] = clib_net_to_host_u64 (*((u64 *) msg + i));
+	  w[i] = clib_net_to_host_u64 (*((u64u *) msg + i));
 	  SHA512_TRANSFORM (s, w, i, sha512_k[i]);
 	}
 
@@ -521,17 +523,44 @@ clib_sha2 (clib_sha2_type_t type, const u8 *msg, uword len, u8 *digest)
 #define clib_sha512_224(...) clib_sha2 (CLIB_SHA2_512_224, __VA_ARGS__)
 #define clib_sha512_256(...) clib_sha2 (CLIB_SHA2_512_256, __VA_ARGS__)
 
+typedef struct
+{
+  u8 block_size;
+  u8 digest_size;
+  /* hash state after processing (key ^ ipad) and (key ^ opad) blocks */
+  union
+  {
+    u32 h32[8];
+    u64 h64[8];
+  } ipad_h, opad_h;
+} clib_sha2_hmac_key_data_t;
+
+typedef struct
+{
+  clib_sha2_ctx_t ctx;
+  const clib_sha2_hmac_key_data_t *kd;
+} clib_sha2_hmac_ctx_t;
+
 static_always_inline void
-clib_hmac_sha2 (clib_sha2_type_t type, const u8 *key, uword key_len,
-		const u8 *msg, uword len, u8 *digest)
+clib_sha2_hmac_copy_h (void *dst, const void *src, u8 block_size)
+{
+  clib_memcpy_fast (dst, src,
+		    block_size == SHA512_BLOCK_SIZE ? 8 * sizeof (u64) :
+							    8 * sizeof (u32));
+}
+
+static_always_inline void
+clib_sha2_hmac_key_data (clib_sha2_hmac_key_data_t *kd, clib_sha2_type_t type,
+			 const u8 *key, uword key_len)
 {
   clib_sha2_ctx_t _ctx, *ctx = &_ctx;
   uword key_data[SHA2_MAX_BLOCK_SIZE / sizeof (uword)];
-  u8 i_digest[SHA2_MAX_DIGEST_SIZE];
   int i, n_words;
 
   clib_sha2_init (ctx, type);
   n_words = ctx->block_size / sizeof (uword);
+  kd->block_size = ctx->block_size;
+  kd->digest_size = ctx->digest_size;
 
   /* key */
   if (key_len > ctx->block_size)
@@ -557,11 +586,7 @@ clib_hmac_sha2 (clib_sha2_type_t type, const u8 *key, uword key_len,
     clib_sha512_block (ctx, ctx->pending.as_u8, 1);
   else
     clib_sha256_block (ctx, ctx->pending.as_u8, 1);
-  ctx->total_bytes += ctx->block_size;
-
-  /* message */
-  clib_sha2_update (ctx, msg, len);
-  clib_sha2_final (ctx, i_digest);
+  clib_sha2_hmac_copy_h (&kd->ipad_h, ctx->h64, ctx->block_size);
 
   /* opad */
   clib_sha2_init (ctx, type);
@@ -571,13 +596,61 @@ clib_hmac_sha2 (clib_sha2_type_t type, const u8 *key, uword key_len,
     clib_sha512_block (ctx, ctx->pending.as_u8, 1);
   else
     clib_sha256_block (ctx, ctx->pending.as_u8, 1);
-  ctx->total_bytes += ctx->block_size;
+  clib_sha2_hmac_copy_h (&kd->opad_h, ctx->h64, ctx->block_size);
+}
+
+static_always_inline void
+clib_sha2_hmac_init (clib_sha2_hmac_ctx_t *hctx,
+		     const clib_sha2_hmac_key_data_t *kd)
+{
+  clib_sha2_ctx_t *ctx = &hctx->ctx;
+
+  hctx->kd = kd;
+  ctx->block_size = kd->block_size;
+  ctx->digest_size = kd->digest_size;
+  ctx->n_pending = 0;
+  /* ipad block is already accounted */
+  ctx->total_bytes = kd->block_size;
+  clib_sha2_hmac_copy_h (ctx->h64, &kd->ipad_h, kd->block_size);
+}
+
+static_always_inline void
+clib_sha2_hmac_update (clib_sha2_hmac_ctx_t *hctx, const u8 *msg, uword len)
+{
+  clib_sha2_update (&hctx->ctx, msg, len);
+}
+
+static_always_inline void
+clib_sha2_hmac_final (clib_sha2_hmac_ctx_t *hctx, u8 *digest)
+{
+  const clib_sha2_hmac_key_data_t *kd = hctx->kd;
+  clib_sha2_ctx_t *ctx = &hctx->ctx;
+  u8 i_digest[SHA2_MAX_DIGEST_SIZE];
+
+  clib_sha2_final (ctx, i_digest);
+
+  ctx->n_pending = 0;
+  ctx->total_bytes = kd->block_size;
+  clib_sha2_hmac_copy_h (ctx->h64, &kd->opad_h, kd->block_size);
 
   /* digest */
   clib_sha2_update (ctx, i_digest, ctx->digest_size);
   clib_sha2_final (ctx, digest);
 }
 
+static_always_inline void
+clib_hmac_sha2 (clib_sha2_type_t type, const u8 *key, uword key_len,
+		const u8 *msg, uword len, u8 *digest)
+{
+  clib_sha2_hmac_key_data_t kd;
+  clib_sha2_hmac_ctx_t hctx;
+
+  clib_sha2_hmac_key_data (&kd, type, key, key_len);
+  clib_sha2_hmac_init (&hctx, &kd);
+  clib_sha2_hmac_update (&hctx, msg, len);
+  clib_sha2_hmac_final (&hctx, digest);
+}
+
 #define clib_hmac_sha224(...) clib_hmac_sha2 (CLIB_SHA2_224, __VA_ARGS__)
 #define clib_hmac_sha256(...) clib_hmac_sha2 (CLIB_SHA2_256, __VA_ARGS__)
 #define clib_hmac_sha384(...) clib_hmac_sha2 (CLIB_SHA2_384, __VA_ARGS__)
@@ -587,4 +660,170 @@ clib_hmac_sha2 (clib_sha2_type_t type, const u8 *key, uword key_len,
 #define clib_hmac_sha512_256(...)                                             \
   clib_hmac_sha2 (CLIB_SHA2_512_256, __VA_ARGS__)
 
+#if defined(CLIB_HAVE_VEC512) || defined(CLIB_HAVE_VEC256)
+
+/* multi-lane HMAC-SHA224/256 - each vector lane processes one independent
+ * message, used on CPUs without SHA extensions */
+
+#if defined(CLIB_HAVE_VEC512)
+#define N_SHA256_LANES 16
+typedef u32x16 sha256_lanes_t;
+#define sha256_lanes_splat(x)	  u32x16_splat (x)
+#define sha256_lanes_byte_swap(x) u32x16_byte_swap (x)
+#else
+#define N_SHA256_LANES 8
+typedef u32x8 sha256_lanes_t;
+#define sha256_lanes_splat(x)	  u32x8_splat (x)
+#define sha256_lanes_byte_swap(x) u32x8_byte_swap (x)
+#endif
+
+static_always_inline void
+sha256_lanes_load_w (sha256_lanes_t w[16], const u8 *msg[N_SHA256_LANES])
+{
+#if N_SHA256_LANES == 16
+  for (int l = 0; l < 16; l++)
+    w[l] = *(u32x16u *) msg[l];
+  u32x16_transpose (w);
+  for (int i = 0; i < 16; i++)
+    w[i] = u32x16_byte_swap (w[i]);
+#else
+  for (int l = 0; l < 8; l++)
+    {
+      w[l] = *(u32x8u *) msg[l];
+      w[l + 8] = *(u32x8u *) (msg[l] + 32);
+    }
+  u32x8_transpose (w);
+  u32x8_transpose (w + 8);
+  for (int i = 0; i < 16; i++)
+    w[i] = u32x8_byte_swap (w[i]);
+#endif
+}
+
+static_always_inline void
+sha256_lanes_compress (sha256_lanes_t h[8], sha256_lanes_t w[16],
+		       sha256_lanes_t mask)
+{
+  sha256_lanes_t s[8], t1, t2, ws[64];
+
+  for (int i = 0; i < 8; i++)
+    s[i] = h[i];
+
+  for (int i = 0; i < 16; i++)
+    ws[i] = w[i];
+
+  for (int i = 16; i < 64; i++)
+    ws[i] = SHA256_SSIGMA1 (ws[i - 2]) + ws[i - 7] +
+	    SHA256_SSIGMA0 (ws[i - 15]) + ws[i - 16];
+
+  for (int i = 0; i < 64; i++)
+    {
+      t1 = s[7] + SHA256_CSIGMA1 (s[4]) + SHA256_CH (s[4], s[5], s[6]) +
+	   sha256_k[i] + ws[i];
+      t2 = SHA256_CSIGMA0 (s[0]) + SHA256_MAJ (s[0], s[1], s[2]);
+      s[7] = s[6];
+      s[6] = s[5];
+      s[5] = s[4];
+      s[4] = s[3] + t1;
+      s[3] = s[2];
+      s[2] = s[1];
+      s[1] = s[0];
+      s[0] = t1 + t2;
+    }
+
+  /* lanes with mask cleared keep their state */
+  for (int i = 0; i < 8; i++)
+    h[i] += s[i] & mask;
+}
+
+/* HMAC-SHA224/256 of up to N_SHA256_LANES messages in parallel, all key data
+ * must be of the same type */
+static_always_inline void
+clib_sha256_hmac_multi (const clib_sha2_hmac_key_data_t *kd[],
+			const u8 *msg[], const u32 len[], u8 *digest[],
+			u32 n_msgs)
+{
+  u8 tail[N_SHA256_LANES][2 * SHA256_BLOCK_SIZE] __clib_aligned (64);
+  u32 n_full[N_SHA256_LANES], n_blocks[N_SHA256_LANES], max_blocks = 0;
+  sha256_lanes_t h[8], w[16], n_blocks_v;
+  const u8 *ptr[N_SHA256_LANES];
+  u32 digest_size = kd[0]->digest_size;
+
+  ASSERT (n_msgs > 0 && n_msgs <= N_SHA256_LANES);
+
+  for (int l = 0; l < N_SHA256_LANES; l++)
+    {
+      u32 n_left, n_tail;
+      u64 n_bits;
+
+      clib_memset_u8 (tail[l], 0, sizeof (tail[l]));
+
+      if (l >= n_msgs)
+	{
+	  /* unused lane, state is never updated */
+	  for (int i = 0; i < 8; i++)
+	    h[i][l] = 0;
+	  n_full[l] = n_blocks[l] = 0;
+	  n_blocks_v[l] = 0;
+	  continue;
+	}
+
+      for (int i = 0; i < 8; i++)
+	h[i][l] = kd[l]->ipad_h.h32[i];
+
+      /* last one or two blocks with padding and length */
+      n_left = len[l] % SHA256_BLOCK_SIZE;
+      n_tail = n_left + 1 + sizeof (u64) > SHA256_BLOCK_SIZE ? 2 : 1;
+      n_bits = ((u64) len[l] + SHA256_BLOCK_SIZE) * 8;
+      n_full[l] = len[l] / SHA256_BLOCK_SIZE;
+      clib_memcpy_fast (tail[l], msg[l] + n_full[l] * SHA256_BLOCK_SIZE,
+			n_left);
+      tail[l][n_left] = 0x80;
+      *(u64u *) (tail[l] + n_tail * SHA256_BLOCK_SIZE - sizeof (u64)) =
+	clib_host_to_net_u64 (n_bits);
+
+      n_blocks[l] = n_full[l] + n_tail;
+      n_blocks_v[l] = n_blocks[l];
+      max_blocks = clib_max (max_blocks, n_blocks[l]);
+    }
+
+  /* inner hash */
+  for (u32 b = 0; b < max_blocks; b++)
+    {
+      for (int l = 0; l < N_SHA256_LANES; l++)
+	if (b < n_full[l])
+	  ptr[l] = msg[l] + b * SHA256_BLOCK_SIZE;
+	else if (b < n_blocks[l])
+	  ptr[l] = tail[l] + (b - n_full[l]) * SHA256_BLOCK_SIZE;
+	else
+	  ptr[l] = tail[l];
+
+      sha256_lanes_load_w (w, ptr);
+      sha256_lanes_compress (h, w,
+			     (sha256_lanes_t) (sha256_lanes_splat (b) <
+					       n_blocks_v));
+    }
+
+  /* outer hash - inner digest followed by padding fits into single block */
+  for (int i = 0; i < 8; i++)
+    w[i] = h[i];
+  for (int i = 8; i < 16; i++)
+    w[i] = sha256_lanes_splat (0);
+  w[digest_size / 4] = sha256_lanes_splat (0x80000000);
+  w[15] = sha256_lanes_splat ((SHA256_BLOCK_SIZE + digest_size) * 8);
+
+  for (int i = 0; i < 8; i++)
+    for (int l = 0; l < n_msgs; l++)
+      h[i][l] = kd[l]->opad_h.h32[i];
+
+  sha256_lanes_compress (h, w, sha256_lanes_splat (~0));
+
+  for (int i = 0; i < 8; i++)
+    h[i] = sha256_lanes_byte_swap (h[i]);
+
+  for (int l = 0; l < n_msgs; l++)
+    for (int i = 0; i < digest_size / 4; i++)
+      ((u32u *) digest[l])[i] = h[i][l];
+}
+#endif
+
 #endif /* included_sha2_h */
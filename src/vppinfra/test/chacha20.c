@@ -0,0 +1,135 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2024 Cisco Systems, Inc.
+ */
+
+#include <vppinfra/format.h>
+#include <vppinfra/test/test.h>
+#include <vppinfra/crypto/chacha20.h>
+
+#define INC_TEST_BYTES (256 * 16 + 1)
+
+static const u8 key1[32] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+  0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15,
+  0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+
+static const u8 nonce1[12] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			       0x00, 0x4a, 0x00, 0x00, 0x00, 0x00 };
+
+static const u8 pt1[114] = {
+  0x4c, 0x61, 0x64, 0x69, 0x65, 0x73, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x47,
+  0x65, 0x6e, 0x74, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x20, 0x6f, 0x66, 0x20,
+  0x74, 0x68, 0x65, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x20, 0x6f, 0x66,
+  0x20, 0x27, 0x39, 0x39, 0x3a, 0x20, 0x49, 0x66, 0x20, 0x49, 0x20, 0x63,
+  0x6f, 0x75, 0x6c, 0x64, 0x20, 0x6f, 0x66, 0x66, 0x65, 0x72, 0x20, 0x79,
+  0x6f, 0x75, 0x20, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x6f, 0x6e, 0x65, 0x20,
+  0x74, 0x69, 0x70, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x74, 0x68, 0x65, 0x20,
+  0x66, 0x75, 0x74, 0x75, 0x72, 0x65, 0x2c, 0x20, 0x73, 0x75, 0x6e, 0x73,
+  0x63, 0x72, 0x65, 0x65, 0x6e, 0x20, 0x77, 0x6f, 0x75, 0x6c, 0x64, 0x20,
+  0x62, 0x65, 0x20, 0x69, 0x74, 0x2e
+};
+
+static const u8 ct1[114] = {
+  0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80, 0x41, 0xba, 0x07, 0x28,
+  0xdd, 0x0d, 0x69, 0x81, 0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2,
+  0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b, 0xf9, 0x1b, 0x65, 0xc5,
+  0x52, 0x47, 0x33, 0xab, 0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57,
+  0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab, 0x8f, 0x53, 0x0c, 0x35,
+  0x9f, 0x08, 0x61, 0xd8, 0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61,
+  0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e, 0x52, 0xbc, 0x51, 0x4d,
+  0x16, 0xcc, 0xf8, 0x06, 0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36,
+  0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6, 0xb4, 0x0b, 0x8e, 0xed,
+  0xf2, 0x78, 0x5e, 0x42, 0x87, 0x4d
+};
+
+static clib_error_t *
+test_clib_chacha20 (clib_error_t *err)
+{
+  clib_chacha20_ctx_t ctx;
+  u8 pt[INC_TEST_BYTES];
+  u8 ct[INC_TEST_BYTES];
+  u8 ref[INC_TEST_BYTES];
+  u8 blocks[N_CHACHA20_LANES][N_CHACHA20_BLOCK_BYTES];
+  const u8 *keys[N_CHACHA20_LANES], *nonces[N_CHACHA20_LANES];
+  u8 *out[N_CHACHA20_LANES];
+
+  /* RFC8439 2.4.2 */
+  clib_chacha20 (key1, nonce1, 1, pt1, ct, sizeof (pt1));
+  if (memcmp (ct, ct1, sizeof (ct1)) != 0)
+    err = clib_error_return (err,
+			     "\ntest:     RFC8439 2.4.2"
+			     "\nexp ct:   %U"
+			     "\ncalc ct:  %U\n",
+			     format_hexdump, ct1, sizeof (ct1), format_hexdump,
+			     ct, sizeof (ct1));
+
+  for (int i = 0; i < sizeof (pt); i++)
+    pt[i] = i;
+
+  clib_chacha20 (key1, nonce1, 1, pt, ref, sizeof (pt));
+
+  /* feeding data in variable sized chunks must produce same result */
+  for (int step = 1; step < 256; step++)
+    {
+      clib_chacha20_init (&ctx, key1, nonce1, 1);
+      for (int off = 0; off < sizeof (pt); off += step)
+	clib_chacha20_transform (&ctx, pt + off, ct + off,
+				 clib_min (step, sizeof (pt) - off));
+
+      if (memcmp (ct, ref, sizeof (ref)) != 0)
+	err = clib_error_return (err, "chunked transform, step %u failed",
+				 step);
+    }
+
+  /* parallel first block of independent streams, stream i uses counter
+   * i + 1 of the reference stream */
+  for (int i = 0; i < N_CHACHA20_LANES; i++)
+    {
+      keys[i] = key1;
+      nonces[i] = nonce1;
+      out[i] = blocks[i];
+    }
+
+  for (int n = 1; n <= N_CHACHA20_LANES; n++)
+    {
+      clib_memset (blocks, 0, sizeof (blocks));
+      clib_chacha20_block_multi (keys, nonces, 1, out, n);
+      for (int i = 0; i < n; i++)
+	{
+	  for (int j = 0; j < N_CHACHA20_BLOCK_BYTES; j++)
+	    blocks[i][j] ^= pt[j];
+	  if (memcmp (blocks[i], ref, N_CHACHA20_BLOCK_BYTES) != 0)
+	    err = clib_error_return (err, "multi-stream block %u/%u failed", i,
+				     n);
+	}
+    }
+
+  return err;
+}
+
+void __test_perf_fn
+perftest_var_sz (test_perf_t *tp)
+{
+  u32 n = tp->n_ops;
+  u8 *dst = test_mem_alloc (n + 64);
+  u8 *src = test_mem_alloc_and_fill_inc_u8 (n + 64, 0, 0);
+  clib_chacha20_ctx_t ctx;
+
+  clib_chacha20_init (&ctx, key1, nonce1, 1);
+
+  test_perf_event_enable (tp);
+  clib_chacha20_transform (&ctx, src, dst, n);
+  test_perf_event_disable (tp);
+}
+
+REGISTER_TEST (clib_chacha20) = {
+  .name = "clib_chacha20",
+  .fn = test_clib_chacha20,
+  .perf_tests = PERF_TESTS ({ .name = "variable size (per byte)",
+			      .n_ops = 1424,
+			      .fn = perftest_var_sz },
+			    { .name = "variable size (per byte)",
+			      .n_ops = 1 << 20,
+			      .fn = perftest_var_sz }),
+};
@@ -503,7 +503,8 @@ __clib_export void TW (tw_timer_wheel_free) (TWT (tw_timer_wheel) * tw)
 static inline
   u32 * TW (tw_timer_expire_timers_internal) (TWT (tw_timer_wheel) * tw,
 					      f64 now,
-					      u32 * callback_vector_arg)
+					      u32 * callback_vector_arg,
+					      int check_next_run_time)
 {
   u32 nticks, i;
   tw_timer_wheel_slot_t *ts;
@@ -515,7 +516,7 @@ static inline
   u32 glacier_wheel_index __attribute__ ((unused));
 
   /* Called too soon to process new timer expirations? */
-  if (PREDICT_FALSE (now < tw->next_run_time))
+  if (check_next_run_time && PREDICT_FALSE (now < tw->next_run_time))
     return callback_vector_arg;
 
   /* Number of ticks which have occurred */
@@ -814,13 +815,32 @@ static inline
 __clib_export u32 *TW (tw_timer_expire_timers) (TWT (tw_timer_wheel) * tw,
 						f64 now)
 {
-  return TW (tw_timer_expire_timers_internal) (tw, now, 0 /* no vector */ );
+  return TW (tw_timer_expire_timers_internal) (tw, now, 0 /* no vector */ ,
+					       1 /* check next run time */ );
 }
 
 __clib_export u32 *TW (tw_timer_expire_timers_vec) (TWT (tw_timer_wheel) * tw,
 						    f64 now, u32 * vec)
 {
-  return TW (tw_timer_expire_timers_internal) (tw, now, vec);
+  return TW (tw_timer_expire_timers_internal) (tw, now, vec,
+					       1 /* check next run time */ );
+}
+
+/**
+ * @brief Advance a tw timer wheel by the whole ticks elapsed since its last
+ * run, even if it ran less than a timer interval ago. For callers which run
+ * the wheel on demand, e.g. to finish a run cut short by max_expirations.
+ * @param tw_timer_wheel_t * tw timer wheel template instance pointer
+ * @param f64 now the current time, e.g. from vlib_time_now(vm)
+ * @param u32 * vec vector the expired user handles are appended to
+ * @returns u32 * vector of expired user handles
+ */
+__clib_export u32 *TW (tw_timer_expire_timers_vec_elapsed) (TWT (tw_timer_wheel)
+							     * tw, f64 now,
+							     u32 * vec)
+{
+  return TW (tw_timer_expire_timers_internal) (tw, now, vec,
+					       0 /* check next run time */ );
 }
 
 #if TW_FAST_WHEEL_BITMAP
@@ -248,6 +248,8 @@ void TW (tw_timer_wheel_free) (TWT (tw_timer_wheel) * tw);
 u32 *TW (tw_timer_expire_timers) (TWT (tw_timer_wheel) * tw, f64 now);
 u32 *TW (tw_timer_expire_timers_vec) (TWT (tw_timer_wheel) * tw, f64 now,
 				      u32 * vec);
+u32 *TW (tw_timer_expire_timers_vec_elapsed) (TWT (tw_timer_wheel) * tw,
+					      f64 now, u32 * vec);
 #if TW_FAST_WHEEL_BITMAP
 u32 TW (tw_timer_first_expires_in_ticks) (TWT (tw_timer_wheel) * tw);
 #endif
@@ -61,10 +61,10 @@ clib_ip_csum_inline (clib_ip_csum_t *c, u8 *dst, u8 *src, u16 count,
     {
       c->odd = 0;
       c->sum += (u16) src[0] << 8;
-      count--;
-      src++;
       if (is_copy)
 	dst++[0] = src[0];
+      count--;
+      src++;
     }
 
 #if defined(CLIB_HAVE_VEC512)
@@ -77,7 +77,7 @@ clib_ip_csum_inline (clib_ip_csum_t *c, u8 *dst, u8 *src, u16 count,
       sum8 += clib_ip_csum_cvt_and_add_16 (s[1]);
       sum8 += clib_ip_csum_cvt_and_add_16 (s[2]);
       sum8 += clib_ip_csum_cvt_and_add_16 (s[3]);
-      sum8 += clib_ip_csum_cvt_and_add_16 (s[8]);
+      sum8 += clib_ip_csum_cvt_and_add_16 (s[4]);
       sum8 += clib_ip_csum_cvt_and_add_16 (s[5]);
       sum8 += clib_ip_csum_cvt_and_add_16 (s[6]);
       sum8 += clib_ip_csum_cvt_and_add_16 (s[7]);
@@ -108,7 +108,7 @@ clib_ip_csum_inline (clib_ip_csum_t *c, u8 *dst, u8 *src, u16 count,
 	{
 	  u32x16u *d = (u32x16u *) dst;
 	  d[0] = s[0];
-	  dst += 512;
+	  dst += 64;
 	}
     }
 
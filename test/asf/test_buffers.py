@@ -27,3 +27,11 @@ class TestBuffers(VppAsfTestCase):
         if error:
             self.logger.critical(error)
             self.assertNotIn("failed", error)
+
+    def test_pool_cache(self):
+        """Buffer Pool Per-Thread Cache Sizing"""
+        error = self.vapi.cli("test buffer-pool cache")
+
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
@@ -24,6 +24,15 @@ class TestCrypto(VppAsfTestCase):
             self.logger.critical(error)
         self.assertNotIn("FAIL", error)
 
+    def test_crypto_hmac_mixed(self):
+        """Crypto mixed chained and non-chained HMAC ops"""
+        for engine in ["native", "openssl"]:
+            self.vapi.cli("set crypto handler hmac-sha-224 %s" % engine)
+            self.vapi.cli("set crypto handler hmac-sha-256 %s" % engine)
+            reply = self.vapi.cli("test crypto hmac-mixed")
+            self.logger.info(reply)
+            self.assertIn("OK", reply, "engine %s" % engine)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -43,6 +43,18 @@ class TestFIB(VppAsfTestCase):
             self.logger.critical(error)
         self.assertNotIn("Failed", error)
 
+    def test_ip4_lpm(self):
+        """IP4 mtrie and poptrie lookups"""
+        reply = self.vapi.cli("test ip4-lpm routes 20000 lookups 65536")
+        self.logger.info(reply)
+        self.assertNotIn("failed", reply)
+
+    def test_ip6_lpm(self):
+        """IP6 linear and binary search lookups"""
+        reply = self.vapi.cli("test ip6-lpm routes 10000 lookups 65536")
+        self.logger.info(reply)
+        self.assertNotIn("failed", reply)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -27,7 +27,16 @@ class TestPolicer(VppAsfTestCase):
     """Policer Test Case"""
 
     def run_policer_test(
-        self, type, cir, cb, eir, eb, rate=8000, burst=10000, colour=0
+        self,
+        type,
+        cir,
+        cb,
+        eir,
+        eb,
+        rate=8000,
+        burst=10000,
+        colour=0,
+        sharded=False,
     ):
         """
         Configure a Policer and push traffic through it.
@@ -54,7 +63,7 @@ class TestPolicer(VppAsfTestCase):
 
         error = self.vapi.cli(
             f"test policing index {policer.policer_index} rate {rate} "
-            f"burst {burst} colour {colour}"
+            f"burst {burst} colour {colour}" + (" sharded" if sharded else "")
         )
 
         stats = policer.get_stats()
@@ -121,6 +130,30 @@ class TestPolicer(VppAsfTestCase):
         stats = self.run_policer_test("2R3C", CIR_LOW, CBURST, EIR_OK, EBURST, colour=2)
         self.assertEqual(stats["violate_packets"], NUM_PKTS)
 
+    def test_policer_sharded(self):
+        """Sharded policer"""
+        stats = self.run_policer_test("1R2C", CIR_OK, CBURST, 0, 0, sharded=True)
+        self.assertEqual(stats["conform_packets"], NUM_PKTS)
+
+        stats = self.run_policer_test("1R2C", CIR_LOW, CBURST, 0, 0, sharded=True)
+        self.assertLess(stats["conform_packets"], NUM_PKTS)
+        self.assertEqual(stats["exceed_packets"], 0)
+        self.assertGreater(stats["violate_packets"], 0)
+
+        stats = self.run_policer_test(
+            "2R3C", CIR_LOW, CBURST, EIR_OK, EBURST, sharded=True
+        )
+        self.assertLess(stats["conform_packets"], NUM_PKTS)
+        self.assertGreater(stats["exceed_packets"], 0)
+        self.assertEqual(stats["violate_packets"], 0)
+
+        stats = self.run_policer_test(
+            "2R3C", CIR_LOW, CBURST, EIR_LOW, EBURST, sharded=True
+        )
+        self.assertLess(stats["conform_packets"], NUM_PKTS)
+        self.assertGreater(stats["exceed_packets"], 0)
+        self.assertGreater(stats["violate_packets"], 0)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
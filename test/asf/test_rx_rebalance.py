@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+
+import re
+import unittest
+
+from asfframework import VppAsfTestCase, VppTestRunner
+
+
+class TestRxRebalance(VppAsfTestCase):
+    """RX queue rebalance Test Case"""
+
+    vpp_worker_count = 2
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestRxRebalance, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestRxRebalance, cls).tearDownClass()
+
+    def tearDown(self):
+        self.vapi.cli("set interface rx-rebalance disable")
+        self.vapi.cli("set vhost-user rebalance disable")
+        super(TestRxRebalance, self).tearDown()
+
+    def test_rx_rebalance_plan(self):
+        """RX rebalance plan unit tests"""
+        reply = self.vapi.cli("test interface rx-rebalance")
+        self.logger.info(reply)
+        self.assertNotIn("failed", reply)
+
+    def test_rx_rebalance_dry_run(self):
+        """RX rebalance dry-run never moves a queue"""
+        self.vapi.cli("set vhost-user rebalance interval 1")
+        self.vapi.cli("set interface rx-rebalance interval 0.5 dry-run")
+        self.sleep(2)
+
+        reply = self.vapi.cli("show interface rx-rebalance")
+        self.logger.info(reply)
+        self.assertIn("dry-run", reply)
+        passes = re.search(r"(\d+) passes, (\d+) queues moved", reply)
+        self.assertIsNotNone(passes)
+        self.assertGreater(int(passes.group(1)), 0)
+        self.assertEqual(int(passes.group(2)), 0)
+        self.assertNotIn("moved:", reply)
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
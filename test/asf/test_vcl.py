@@ -466,6 +466,16 @@ class VCLCutThruTestCase(VCLTestCase):
             self.client_echo_test_args,
         )
 
+    def test_vcl_cut_thru_ring(self):
+        """run VCL cut thru submission/completion ring test"""
+
+        self.cut_thru_test(
+            "vcl_test_ring",
+            ["-s", self.server_port],
+            "vcl_test_ring",
+            [self.server_addr, self.server_port],
+        )
+
     def test_vcl_cut_thru_uni_dir_nsock(self):
         """run VCL cut thru uni-directional (multiple sockets) test"""
 
@@ -537,6 +547,16 @@ class VCLThruHostStackEcho(VCLTestCase):
             self.client_echo_test_args,
         )
 
+    def test_vcl_thru_host_stack_ring(self):
+        """run VCL IPv4 thru host stack submission/completion ring test"""
+
+        self.thru_host_stack_test(
+            "vcl_test_ring",
+            ["-s", self.server_port],
+            "vcl_test_ring",
+            [self.loop0.local_ip4, self.server_port],
+        )
+
     def show_commands_at_teardown(self):
         self.logger.debug(self.vapi.cli("show app server"))
         self.logger.debug(self.vapi.cli("show session verbose"))
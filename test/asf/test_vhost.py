@@ -1,5 +1,11 @@
 #!/usr/bin/env python3
 
+import array
+import mmap
+import os
+import socket
+import struct
+import time
 import unittest
 
 from asfframework import VppAsfTestCase, VppTestRunner
@@ -7,6 +13,113 @@ from asfframework import VppAsfTestCase, VppTestRunner
 from vpp_vhost_interface import VppVhostInterface
 
 
+class VhostUserDriver:
+    """Minimal vhost-user driver, feeds packets to the device rx path
+
+    Guest memory is a memfd shared with vpp. Each vring takes 3 pages
+    (descriptors, avail, used) at the start of it, packet buffers follow.
+    """
+
+    GET_FEATURES = 1
+    SET_FEATURES = 2
+    SET_OWNER = 3
+    SET_MEM_TABLE = 5
+    SET_VRING_NUM = 8
+    SET_VRING_ADDR = 9
+    SET_VRING_BASE = 10
+    SET_VRING_KICK = 12
+    VRING_NOFD_MASK = 0x100
+    F_VERSION_1 = 1 << 32
+    F_IN_ORDER = 1 << 35
+    GUEST_PHYS_ADDR = 0x40000000
+    USERSPACE_ADDR = 0x7F0000000000
+    BUF_OFFSET = 0x10000
+    BUF_SIZE = 0x10000
+    MEM_SIZE = 8 << 20
+    NET_HDR_SZ = 12
+
+    def __init__(self, sock_filename, queue_size=256):
+        self.queue_size = queue_size
+        self.fd = os.memfd_create("vhost-user-driver")
+        os.ftruncate(self.fd, self.MEM_SIZE)
+        self.mem = mmap.mmap(self.fd, self.MEM_SIZE)
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(sock_filename)
+
+    def close(self):
+        self.sock.close()
+        self.mem.close()
+        os.close(self.fd)
+
+    def send(self, request, payload=b"", fds=[]):
+        msg = struct.pack("<III", request, 1, len(payload)) + payload
+        anc = []
+        if fds:
+            anc = [(socket.SOL_SOCKET, socket.SCM_RIGHTS, array.array("i", fds))]
+        self.sock.sendmsg([msg], anc)
+
+    def recv_u64(self):
+        request, flags, size = struct.unpack("<III", self.sock.recv(12))
+        return struct.unpack("<Q", self.sock.recv(size))[0]
+
+    def vring_offset(self, q):
+        return q * 0x3000
+
+    def setup(self, features):
+        """negotiate features and bring up the rx and tx vrings"""
+        self.send(self.SET_OWNER)
+        self.send(self.GET_FEATURES)
+        offered = self.recv_u64()
+        self.send(self.SET_FEATURES, struct.pack("<Q", offered & features))
+        region = struct.pack(
+            "<QQQQ", self.GUEST_PHYS_ADDR, self.MEM_SIZE, self.USERSPACE_ADDR, 0
+        )
+        self.send(self.SET_MEM_TABLE, struct.pack("<II", 1, 0) + region, [self.fd])
+        for q in range(2):
+            off = self.USERSPACE_ADDR + self.vring_offset(q)
+            self.send(self.SET_VRING_NUM, struct.pack("<II", q, self.queue_size))
+            self.send(self.SET_VRING_BASE, struct.pack("<II", q, 0))
+            self.send(
+                self.SET_VRING_ADDR,
+                struct.pack("<IIQQQQ", q, 0, off, off + 0x2000, off + 0x1000, 0),
+            )
+            # no kick fd, the vring is started right away
+            self.send(self.SET_VRING_KICK, struct.pack("<Q", q | self.VRING_NOFD_MASK))
+        return offered & features
+
+    def used_idx(self, q):
+        off = self.vring_offset(q) + 0x2000
+        return struct.unpack_from("<H", self.mem, off + 2)[0]
+
+    def used_id(self, q, slot):
+        off = self.vring_offset(q) + 0x2000 + 4 + 8 * slot
+        return struct.unpack_from("<I", self.mem, off)[0]
+
+    def fill_used(self, q, id):
+        off = self.vring_offset(q) + 0x2000 + 4
+        for slot in range(self.queue_size):
+            struct.pack_into("<II", self.mem, off + 8 * slot, id, 0)
+
+    def tx(self, heads, pkt_len):
+        """queue one single descriptor packet per head on the tx vring"""
+        desc = self.vring_offset(1)
+        avail = desc + 0x1000
+        for i, head in enumerate(heads):
+            addr = self.BUF_OFFSET + head * self.BUF_SIZE
+            self.mem[addr : addr + self.NET_HDR_SZ] = bytes(self.NET_HDR_SZ)
+            struct.pack_into(
+                "<QIHH",
+                self.mem,
+                desc + 16 * head,
+                self.GUEST_PHYS_ADDR + addr,
+                self.NET_HDR_SZ + pkt_len,
+                0,
+                0,
+            )
+            struct.pack_into("<H", self.mem, avail + 4 + 2 * i, head)
+        struct.pack_into("<H", self.mem, avail + 2, len(heads))
+
+
 class TesVhostInterface(VppAsfTestCase):
     """Vhost User Test Case"""
 
@@ -140,6 +253,41 @@ class TesVhostInterface(VppAsfTestCase):
         self.logger.info("Deleting VirtualEthernet")
         vhost_if.remove_vpp_config()
 
+    def test_vhost_in_order_rx(self):
+        """Vhost User in-order rx used ring test"""
+
+        sock_filename = "%s/vhost-in-order.sock" % self.tempdir
+        self.vapi.cli("create vhost-user socket %s server in-order" % sock_filename)
+        self.vapi.cli("set interface state VirtualEthernet0/0/0 up")
+
+        driver = VhostUserDriver(sock_filename)
+        features = driver.setup(driver.F_VERSION_1 | driver.F_IN_ORDER)
+        self.assertEqual(features & driver.F_IN_ORDER, driver.F_IN_ORDER)
+
+        # 64k packets span tens of vlib buffers, the device runs out of
+        # them in the middle of a packet and has to rewind it
+        n_pkts = 64
+        heads = [n_pkts - 1 - i for i in range(n_pkts)]
+        driver.fill_used(1, 0xFFFF)
+        driver.tx(heads, 65000)
+
+        for i in range(50):
+            if driver.used_idx(1) == n_pkts:
+                break
+            time.sleep(0.1)
+        self.assertEqual(driver.used_idx(1), n_pkts)
+
+        # only the last used entry of a batch is written, and it must
+        # describe the last packet consumed
+        for slot in range(n_pkts):
+            id = driver.used_id(1, slot)
+            if id != 0xFFFF:
+                self.assertEqual(id, heads[slot], "used ring slot %d" % slot)
+        self.assertEqual(driver.used_id(1, n_pkts - 1), heads[-1])
+
+        driver.close()
+        self.vapi.cli("delete vhost-user VirtualEthernet0/0/0")
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
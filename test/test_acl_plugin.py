@@ -1622,6 +1622,54 @@ class TestACLplugin(VppTestCase):
 
         self.logger.info("ACLP_TEST_FINISH_0315")
 
+    def test_0320_tcp_permit_v4_dtree(self):
+        """permit TCPv4 with decision tree matching"""
+        self.logger.info("ACLP_TEST_START_0320")
+
+        self.vapi.cli("set acl-plugin use-decision-tree-matching 1")
+
+        # Add an ACL
+        rules = []
+        rules.append(
+            self.create_rule(
+                self.IPV4, self.DENY, self.PORTS_RANGE_2, self.proto[self.IP][self.TCP]
+            )
+        )
+        rules.append(
+            self.create_rule(
+                self.IPV4, self.PERMIT, self.PORTS_RANGE, self.proto[self.IP][self.TCP]
+            )
+        )
+        # deny ip any any in the end
+        rules.append(self.create_rule(self.IPV4, self.DENY, self.PORTS_ALL, 0))
+
+        # Apply rules
+        self.apply_rules(rules, "permit ipv4 tcp")
+
+        # the trees are compiled in the background
+        self.sleep(0.1)
+        self.assertIn("built in", self.vapi.cli("show acl-plugin tables dtree"))
+
+        # Traffic should still pass
+        self.run_verify_test(self.IP, self.IPV4, self.proto[self.IP][self.TCP])
+
+        self.vapi.cli("set acl-plugin use-decision-tree-matching 0")
+
+        self.logger.info("ACLP_TEST_FINISH_0320")
+
+    def test_0321_lookup_bench(self):
+        """linear, hash and decision tree matching agree"""
+        self.logger.info("ACLP_TEST_START_0321")
+
+        for af in ["", "ip6"]:
+            reply = self.vapi.cli(
+                "test acl-plugin lookup-bench rules 500 acls 3 lookups 5000 %s" % af
+            )
+            self.logger.info(reply)
+            self.assertEqual(reply.count(" 0 mismatches"), 3)
+
+        self.logger.info("ACLP_TEST_FINISH_0321")
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -1001,5 +1001,28 @@ class TestClassifierPunt(TestClassifier):
         self.assertEqual(r.ip6_table_index, 0xFFFFFFFF)
 
 
+class TestClassifierLookupN(TestClassifier):
+    """Classifier Batch Lookup Test Case"""
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestClassifierLookupN, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestClassifierLookupN, cls).tearDownClass()
+
+    def test_lookup_n(self):
+        """Batch lookup matches single packet lookup
+
+        A frame mixing hits and misses across chained tables gets the
+        same table, entry, next index and hit counters either way.
+        """
+        for seed in [0xDEADBEEF, 1, 12345]:
+            reply = self.vapi.cli("test classify lookup-n seed %d" % seed)
+            self.logger.info(reply)
+            self.assertNotIn("failed", reply)
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -592,6 +592,56 @@ class Flowprobe(MethodHolder):
         # cleanup
         ipfix.remove_vpp_config()
 
+    def test_flow_cache_many_flows(self):
+        """Verify one record per flow for flows sharing a frame"""
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pkts = []
+
+        ipfix = VppCFLOW(
+            test=self,
+            active=2,
+            passive=10,
+            intf="pg3",
+            layer="l3 l4",
+            datapath="ip4",
+            direction="rx",
+            mtu=1450,
+        )
+        ipfix.add_vpp_config()
+
+        ipfix_decoder = IPFIXDecoder()
+        templates = ipfix.verify_templates(ipfix_decoder, count=1)
+
+        # more flows than a lookup batch, each seen twice in the same frame
+        n_flows = 100
+        for sport in range(1000, 1000 + n_flows):
+            p = (
+                Ether(src=self.pg3.remote_mac, dst=self.pg4.local_mac)
+                / IP(src=self.pg3.remote_ip4, dst=self.pg4.remote_ip4)
+                / UDP(sport=sport, dport=4321)
+                / Raw(b"\xa5" * 50)
+            )
+            self.pkts += [p, p]
+        self.send_packets(src_if=self.pg3, dst_if=self.pg4)
+
+        # the active timer reports every flow once
+        self.sleep(3)
+        self.vapi.cli("ipfix flush")
+        flows = {}
+        for cflow in self.collector.get_capture(timeout=6):
+            if not cflow.haslayer(Set) or cflow[Set].setID != templates[0]:
+                continue
+            for record in ipfix_decoder.decode_data_set(cflow.getlayer(Set)):
+                sport = int(binascii.hexlify(record[IPFIX_SRC_TRANS_PORT_ID]), 16)
+                self.assertNotIn(sport, flows)
+                flows[sport] = int(binascii.hexlify(record[2]), 16)
+        self.assertEqual(len(flows), n_flows)
+        for packets in flows.values():
+            self.assertEqual(packets, 2)
+
+        # cleanup
+        ipfix.remove_vpp_config()
+
     def test_interface_dump(self):
         """Dump interfaces with IPFIX flow record generation enabled"""
         self.logger.info("FFP_TEST_START_0003")
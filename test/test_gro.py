@@ -254,6 +254,52 @@ class TestGRO(VppTestCase):
             self.assertEqual(rx[TCP].ack, (2 * i + 1))
             i += 1
 
+    def test_gro_input(self):
+        """GRO input feature test"""
+
+        self.vapi.feature_gro_enable_disable(
+            sw_if_index=self.pg0.sw_if_index, enable_disable=1
+        )
+
+        #
+        # Send 1500 bytes frames with gro-input enabled on the input
+        # interface, the packets are coalesced on the receive side
+        #
+        n_packets = 124
+        p = []
+        s = 0
+        for n in range(0, n_packets):
+            p.append(
+                (
+                    Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+                    / IP(src=self.pg0.remote_ip4, dst=self.pg2.remote_ip4, flags="DF")
+                    / TCP(sport=1234, dport=4321, seq=s, ack=n, flags="A")
+                    / Raw(b"\xa5" * 1460)
+                )
+            )
+            s += 1460
+
+        rxs = self.send_and_expect(self.pg0, p, self.pg2, n_rx=3)
+
+        lengths = [64280, 64280, 52600]  # 1460 * 44 + 40, 1460 * 36 + 40
+        acks = [43, 87, 123]
+        for rx, length, ack in zip(rxs, lengths, acks):
+            self.assertEqual(rx[Ether].src, self.pg2.local_mac)
+            self.assertEqual(rx[Ether].dst, self.pg2.remote_mac)
+            self.assertEqual(rx[IP].src, self.pg0.remote_ip4)
+            self.assertEqual(rx[IP].dst, self.pg2.remote_ip4)
+            self.assertEqual(rx[IP].len, length)
+            self.assertEqual(rx[TCP].sport, 1234)
+            self.assertEqual(rx[TCP].dport, 4321)
+            self.assertEqual(rx[TCP].ack, ack)
+
+        stats = self.vapi.cli("show gro")
+        self.assertIn("merged 121", stats)
+
+        self.vapi.feature_gro_enable_disable(
+            sw_if_index=self.pg0.sw_if_index, enable_disable=0
+        )
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -15,16 +15,16 @@ from scapy.layers.inet6 import IPv6, Ether, IP, ICMPv6PacketTooBig
 from scapy.layers.inet6 import ipv6nh, IPerror6
 from scapy.layers.inet import TCP, ICMP
 from scapy.layers.vxlan import VXLAN
-from scapy.layers.ipsec import ESP
+from scapy.layers.ipsec import ESP, SecurityAssociation
 
 from vpp_papi import VppEnum
 from framework import VppTestCase
 from asfframework import VppTestRunner
-from vpp_ip_route import VppIpRoute, VppRoutePath, FibPathProto
+from vpp_ip_route import VppIpRoute, VppRoutePath, FibPathProto, VppMplsLabel
 from vpp_ipip_tun_interface import VppIpIpTunInterface
 from vpp_vxlan_tunnel import VppVxlanTunnel
 
-from vpp_ipsec import VppIpsecSA, VppIpsecTunProtect
+from vpp_ipsec import VppIpsecSA, VppIpsecTunProtect, VppIpsecInterface
 from template_ipsec import (
     IPsecIPv4Params,
     IPsecIPv6Params,
@@ -1086,6 +1086,110 @@ class TestGSO(VppTestCase):
 
         self.vapi.feature_gso_enable_disable(self.pg0.sw_if_index, enable_disable=0)
 
+    def test_gso_ipsec_itf(self):
+        """GSO IPSEC interface test"""
+        #
+        # The ipsec interface advertises GSO, esp-encrypt segments the
+        # jumbo frame as it encrypts it, no gso feature on the tunnel.
+        #
+        p = IPsecIPv4Params()
+        ipsec_itf = VppIpsecInterface(self)
+        ipsec_itf.add_vpp_config()
+
+        sa_out = VppIpsecSA(
+            self,
+            p.vpp_tun_sa_id,
+            p.vpp_tun_spi,
+            p.auth_algo_vpp_id,
+            p.auth_key,
+            p.crypt_algo_vpp_id,
+            p.crypt_key,
+            VppEnum.vl_api_ipsec_proto_t.IPSEC_API_PROTO_ESP,
+            self.pg0.local_ip4,
+            self.pg0.remote_ip4,
+        )
+        sa_out.add_vpp_config()
+        sa_in = VppIpsecSA(
+            self,
+            p.scapy_tun_sa_id,
+            p.scapy_tun_spi,
+            p.auth_algo_vpp_id,
+            p.auth_key,
+            p.crypt_algo_vpp_id,
+            p.crypt_key,
+            VppEnum.vl_api_ipsec_proto_t.IPSEC_API_PROTO_ESP,
+            self.pg0.remote_ip4,
+            self.pg0.local_ip4,
+        )
+        sa_in.add_vpp_config()
+
+        protect = VppIpsecTunProtect(self, ipsec_itf, sa_out, [sa_in])
+        protect.add_vpp_config()
+
+        ipsec_itf.admin_up()
+        ipsec_itf.set_unnumbered(self.pg0.sw_if_index)
+
+        route = VppIpRoute(
+            self,
+            "172.16.10.0",
+            24,
+            [VppRoutePath("0.0.0.0", ipsec_itf.sw_if_index)],
+        )
+        route.add_vpp_config()
+
+        vpp_sa = SecurityAssociation(
+            ESP,
+            spi=p.vpp_tun_spi,
+            crypt_algo=p.crypt_algo,
+            crypt_key=p.crypt_key,
+            auth_algo=p.auth_algo,
+            auth_key=p.auth_key,
+            tunnel_header=IP(src=self.pg0.local_ip4, dst=self.pg0.remote_ip4),
+        )
+
+        ipsec44 = (
+            Ether(src=self.pg2.remote_mac, dst="02:fe:60:1e:a2:79")
+            / IP(src=self.pg2.remote_ip4, dst="172.16.10.3", flags="DF")
+            / TCP(sport=1234, dport=1234)
+            / Raw(b"\xa5" * 65200)
+        )
+
+        rxs = self.send_and_expect(self.pg2, [ipsec44], self.pg0, 45)
+        size = 0
+        for rx in rxs:
+            self.assertEqual(rx[IP].src, self.pg0.local_ip4)
+            self.assertEqual(rx[IP].dst, self.pg0.remote_ip4)
+            self.assertEqual(rx[ESP].spi, p.vpp_tun_spi)
+            inner = vpp_sa.decrypt(rx[IP])
+            self.assertEqual(inner[IP].src, self.pg2.remote_ip4)
+            self.assertEqual(inner[IP].dst, "172.16.10.3")
+            size += inner[IP].len - 20 - 20
+        self.assertEqual(size, 65200)
+        self.assertEqual(
+            45, self.statistics.get_err_counter("/err/esp4-encrypt-tun/gso_segments")
+        )
+
+        #
+        # under a label stack the jumbo frame cannot be segmented, it is
+        # dropped rather than encrypted whole
+        #
+        route.modify(
+            [VppRoutePath("0.0.0.0", ipsec_itf.sw_if_index, labels=[VppMplsLabel(44)])]
+        )
+        self.send_and_assert_no_replies(self.pg2, [ipsec44])
+        self.assertEqual(
+            1,
+            self.statistics.get_err_counter(
+                "/err/esp-mpls-encrypt-tun/gso_unhandled_type"
+            ),
+        )
+
+        route.remove_vpp_config()
+        protect.remove_vpp_config()
+        sa_in.remove_vpp_config()
+        sa_out.remove_vpp_config()
+        ipsec_itf.remove_vpp_config()
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -317,6 +317,39 @@ class TestIPv4RouteLookup(VppTestCase):
 
         # Can't seem to delete the default route so no negative LPM test.
 
+    def test_bulk_add_del(self):
+        """IPv4 Bulk Route Add/Del"""
+        drop_nh = VppRoutePath(
+            "127.0.0.1", 0xFFFFFFFF, type=FibPathType.FIB_PATH_TYPE_DROP
+        )
+        routes = [
+            {"prefix": "2.2.%d.0/24" % i, "path": drop_nh.encode()} for i in range(256)
+        ]
+
+        rv = self.vapi.api(
+            self.vapi.papi.ip_route_add_del_bulk,
+            {"is_add": True, "table_id": 0, "n_routes": len(routes), "routes": routes},
+        )
+        self.assertEqual(rv.n_routes, len(routes))
+        for prefix in ("2.2.0.0/24", "2.2.255.0/24"):
+            result = self.route_lookup(prefix, True)
+            self.assertEqual(prefix, str(result.route.prefix))
+
+        # an unknown table fails the whole batch before anything is programmed
+        with self.vapi.assert_negative_api_retval():
+            self.vapi.api(
+                self.vapi.papi.ip_route_add_del_bulk,
+                {"is_add": True, "table_id": 42, "n_routes": 1, "routes": routes[:1]},
+            )
+
+        rv = self.vapi.api(
+            self.vapi.papi.ip_route_add_del_bulk,
+            {"is_add": False, "table_id": 0, "n_routes": len(routes), "routes": routes},
+        )
+        self.assertEqual(rv.n_routes, len(routes))
+        with self.vapi.assert_negative_api_retval():
+            self.route_lookup("2.2.0.0/24", True)
+
 
 class TestIPv4IfAddrRoute(VppTestCase):
     """IPv4 Interface Addr Route Test Case"""
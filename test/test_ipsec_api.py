@@ -154,6 +154,68 @@ class IpsecApiTestCase(VppTestCase):
 
         sa.remove_vpp_config()
 
+    def test_sa_any_worker_bind(self):
+        """Bind an SA to any worker"""
+        saf = VppEnum.vl_api_ipsec_sad_flags_t
+        sa = VppIpsecSA(
+            self,
+            self.ipv4_params.scapy_tun_sa_id,
+            self.ipv4_params.scapy_tun_spi,
+            self.ipv4_params.auth_algo_vpp_id,
+            self.ipv4_params.auth_key,
+            self.ipv4_params.crypt_algo_vpp_id,
+            self.ipv4_params.crypt_key,
+            VppEnum.vl_api_ipsec_proto_t.IPSEC_API_PROTO_ESP,
+            flags=saf.IPSEC_API_SAD_FLAG_USE_ANTI_REPLAY,
+        )
+        sa.add_vpp_config()
+
+        self.vapi.ipsec_sad_bind(sa_id=sa.id, worker=0xFFFFFFFF)
+        self.__check_sa_binding(sa.id, 0xFFFE)
+
+        self.vapi.ipsec_sad_unbind(sa_id=sa.id)
+        self.__check_sa_binding(sa.id, 0xFFFF)
+
+        sa.remove_vpp_config()
+
+        # without ESN or anti-replay the sequence number may wrap
+        sa = VppIpsecSA(
+            self,
+            self.ipv4_params.scapy_tun_sa_id,
+            self.ipv4_params.scapy_tun_spi,
+            self.ipv4_params.auth_algo_vpp_id,
+            self.ipv4_params.auth_key,
+            self.ipv4_params.crypt_algo_vpp_id,
+            self.ipv4_params.crypt_key,
+            VppEnum.vl_api_ipsec_proto_t.IPSEC_API_PROTO_ESP,
+        )
+        sa.add_vpp_config()
+
+        with self.vapi.assert_negative_api_retval():
+            self.vapi.ipsec_sad_bind(sa_id=sa.id, worker=0xFFFFFFFF)
+        self.__check_sa_binding(sa.id, 0xFFFF)
+
+        sa.remove_vpp_config()
+
+        # AH SAs are always processed by a single worker
+        sa = VppIpsecSA(
+            self,
+            self.ipv4_params.scapy_tun_sa_id,
+            self.ipv4_params.scapy_tun_spi,
+            self.ipv4_params.auth_algo_vpp_id,
+            self.ipv4_params.auth_key,
+            self.ipv4_params.crypt_algo_vpp_id,
+            self.ipv4_params.crypt_key,
+            VppEnum.vl_api_ipsec_proto_t.IPSEC_API_PROTO_AH,
+        )
+        sa.add_vpp_config()
+
+        with self.vapi.assert_negative_api_retval():
+            self.vapi.ipsec_sad_bind(sa_id=sa.id, worker=0xFFFFFFFF)
+        self.__check_sa_binding(sa.id, 0xFFFF)
+
+        sa.remove_vpp_config()
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
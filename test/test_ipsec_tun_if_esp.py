@@ -934,6 +934,73 @@ class TestIpsec4TunIfEspHandoff(TemplateIpsec4TunIfEsp, IpsecTun4HandoffTests):
         policer.remove_vpp_config()
 
 
+class TestIpsec4TunIfEspAnyWorker(TemplateIpsec4TunIfEsp, IpsecTun4):
+    """Ipsec ESP 4 SA on any worker tests"""
+
+    vpp_worker_count = 2
+
+    def config_sa_tra(self, p):
+        # a shared SA needs ESN or anti-replay
+        saf = VppEnum.vl_api_ipsec_sad_flags_t
+        p.flags = saf.IPSEC_API_SAD_FLAG_USE_ANTI_REPLAY
+        super(TestIpsec4TunIfEspAnyWorker, self).config_sa_tra(p)
+
+    def test_tun_any_worker_44(self):
+        """ESP 4o4 tunnel with the SAs on any worker"""
+        self.vapi.cli("clear errors")
+        self.vapi.cli("clear ipsec sa")
+
+        N_PKTS = 15
+        p = self.params[socket.AF_INET]
+
+        for sa in [p.tun_sa_in, p.tun_sa_out]:
+            self.vapi.ipsec_sad_bind(sa_id=sa.id, worker=0xFFFFFFFF)
+
+        seqs = []
+        for worker in [0, 1, 0, 1]:
+            send_pkts = self.gen_encrypt_pkts(
+                p,
+                p.scapy_tun_sa,
+                self.tun_if,
+                src=p.remote_tun_if_host,
+                dst=self.pg1.remote_ip4,
+                count=N_PKTS,
+            )
+            recv_pkts = self.send_and_expect(
+                self.tun_if, send_pkts, self.pg1, worker=worker
+            )
+            self.verify_decrypted(p, recv_pkts)
+
+            # the other worker sees the same packets as replays
+            self.pg_send(self.tun_if, send_pkts, worker=1 - worker)
+            self.pg1.assert_nothing_captured(remark="replayed packets")
+
+            send_pkts = self.gen_pkts(
+                self.pg1,
+                src=self.pg1.remote_ip4,
+                dst=p.remote_tun_if_host,
+                count=N_PKTS,
+            )
+            recv_pkts = self.send_and_expect(
+                self.pg1, send_pkts, self.tun_if, worker=worker
+            )
+            self.verify_encrypted(p, p.vpp_tun_sa, recv_pkts)
+            seqs += [rx[ESP].seq for rx in recv_pkts]
+
+        # no handoff, each worker counts what it received
+        for worker in [0, 1]:
+            self.assertEqual(p.tun_sa_in.get_stats(worker)["packets"], 2 * N_PKTS)
+            self.assertEqual(p.tun_sa_out.get_stats(worker)["packets"], 2 * N_PKTS)
+        self.assertEqual(p.tun_sa_in.get_err("replay"), 4 * N_PKTS)
+
+        # the workers never send the same sequence number twice
+        self.assertEqual(len(seqs), 4 * N_PKTS)
+        self.assertEqual(len(set(seqs)), len(seqs))
+
+        for sa in [p.tun_sa_in, p.tun_sa_out]:
+            self.vapi.ipsec_sad_unbind(sa_id=sa.id)
+
+
 @tag_fixme_vpp_workers
 class TestIpsec4MultiTunIfEsp(TemplateIpsec4TunProtect, TemplateIpsec, IpsecTun4):
     """IPsec IPv4 Multi Tunnel interface"""
@@ -16,6 +16,7 @@ from vpp_ip import INVALID_INDEX
 
  TestLB class defines Load Balancer test cases for:
   - IP4 to GRE4 encap on per-port vip case
+  - IP4 to GRE4 encap on maglev vip case
   - IP4 to GRE6 encap on per-port vip case
   - IP6 to GRE4 encap on per-port vip case
   - IP6 to GRE6 encap on per-port vip case
@@ -241,6 +242,67 @@ class TestLB(VppTestCase):
             self.vapi.cli("lb vip 90.0.0.0/8 encap gre4 del")
             self.vapi.cli("test lb flowtable flush")
 
+    def test_lb_ip4_gre4_maglev(self):
+        """Load Balancer IP4 GRE4 on maglev vip case"""
+        try:
+            self.vapi.cli("lb vip 90.0.0.0/8 encap gre4 maglev")
+            for asid in self.ass:
+                self.vapi.cli("lb as 90.0.0.0/8 10.0.0.%u" % (asid))
+
+            self.pg0.add_stream(self.generatePackets(self.pg0, isv4=True))
+            self.pg_enable_capture(self.pg_interfaces)
+            self.pg_start()
+            self.checkCapture(encap="gre4", isv4=True)
+
+        finally:
+            for asid in self.ass:
+                self.vapi.cli("lb as 90.0.0.0/8 10.0.0.%u del" % (asid))
+            self.vapi.cli("lb vip 90.0.0.0/8 encap gre4 del")
+            self.vapi.cli("test lb flowtable flush")
+
+    def getFlowAs(self):
+        """Map each flow's inner source to the AS it was sent to"""
+        out = self.pg1.get_capture(len(self.packets))
+        flow_as = {}
+        for p in out:
+            inner = IP(scapy.compat.raw(p[GRE].payload))
+            flow_as[inner.src] = p[IP].dst
+        return flow_as
+
+    def test_lb_ip4_gre4_sticky_resize(self):
+        """Load Balancer IP4 GRE4 sticky table resize keeps affinity"""
+        try:
+            self.vapi.cli("lb conf buckets 1024 max-buckets 4096")
+            self.vapi.cli("lb vip 90.0.0.0/8 encap gre4")
+            for asid in self.ass:
+                self.vapi.cli("lb as 90.0.0.0/8 10.0.0.%u" % (asid))
+
+            self.pg0.add_stream(self.generatePackets(self.pg0, isv4=True))
+            self.pg_enable_capture(self.pg_interfaces)
+            self.pg_start()
+            before = self.getFlowAs()
+            self.assertEqual(len(before), len(self.packets))
+
+            # grow the sticky table, and add an AS so that new flows
+            # would hash differently: the flows must stay where they were
+            self.vapi.cli("lb conf buckets 4096")
+            self.vapi.cli("lb as 90.0.0.0/8 10.0.0.%u" % len(self.ass))
+
+            self.pg0.add_stream(self.generatePackets(self.pg0, isv4=True))
+            self.pg_enable_capture(self.pg_interfaces)
+            self.pg_start()
+            self.assertEqual(before, self.getFlowAs())
+
+            reply = self.vapi.cli("show lb")
+            self.assertIn("usage: %u / %u" % (len(self.packets), 4096 * 4), reply)
+
+        finally:
+            for asid in range(len(self.ass) + 1):
+                self.vapi.cli("lb as 90.0.0.0/8 10.0.0.%u del" % (asid))
+            self.vapi.cli("lb vip 90.0.0.0/8 encap gre4 del")
+            self.vapi.cli("test lb flowtable flush")
+            self.vapi.cli("lb conf buckets 1024 max-buckets 1024")
+
     def test_lb_ip6_gre4(self):
         """Load Balancer IP6 GRE4 on vip case"""
 
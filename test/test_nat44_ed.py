@@ -2975,8 +2975,8 @@ class TestNAT44EDMW(TestNAT44ED):
         config = self.vapi.nat44_show_running_config()
         self.assertEqual(self.max_sessions, config.sessions)
 
-    def test_lru_cleanup(self):
-        """NAT44ED LRU cleanup algorithm"""
+    def test_expire_cleanup(self):
+        """NAT44ED timer wheel session expiry"""
 
         self.nat_add_address(self.nat_addr)
         self.nat_add_inside_interface(self.pg0)
@@ -3000,7 +3000,8 @@ class TestNAT44EDMW(TestNAT44ED):
         self.pg_enable_capture(self.pg_interfaces)
         self.pg_start()
         self.pg1.get_capture(len(pkts))
-        self.virtual_sleep(1.5, "wait for timeouts")
+        expired = self.statistics["/nat44-ed/expired-sessions"]
+        self.virtual_sleep(2.5, "wait for timeouts")
 
         pkts = []
         for i in range(0, self.max_sessions - 1):
@@ -3015,6 +3016,11 @@ class TestNAT44EDMW(TestNAT44ED):
         self.pg_enable_capture(self.pg_interfaces)
         self.pg_start()
         self.pg1.get_capture(len(pkts))
+        self.assertEqual(
+            self.statistics["/nat44-ed/expired-sessions"][:, 0].sum()
+            - expired[:, 0].sum(),
+            self.max_sessions - 1,
+        )
 
     def test_session_rst_timeout(self):
         """NAT44ED session RST timeouts"""
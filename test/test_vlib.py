@@ -107,6 +107,9 @@ class TestVlib(VppTestCase):
             "set node function ethernet-input default",
             "set node function ethernet-input bozo",
             "set node function ethernet-input",
+            "set node adaptive-mode polling-threshold 16 idle-time 0.5",
+            "set node adaptive-mode interrupt-threshold 32",
+            "show node adaptive-mode",
             "show \t",
         ]
 
@@ -146,6 +149,10 @@ class TestVlib(VppTestCase):
             "clear interfaces",
             "test vlib",
             "test vlib2",
+            "test node adaptive-mode",
+            "test rcu",
+            "show rcu verbose",
+            "clear rcu",
             "show memory api-segment stats-segment main-heap verbose",
             "leak-check { show memory }",
             "show cpu",
@@ -161,6 +168,7 @@ class TestVlib(VppTestCase):
             "test heap-validate",
             "memory-trace main-heap disable",
             "show buffers",
+            "show buffers verbose",
             "show eve",
             "show help",
             "show ip ",
@@ -223,6 +231,30 @@ class TestVlib(VppTestCase):
                     self.logger.info(cmd + " FAIL retval " + str(r.retval))
 
 
+class TestVlibRcu(VppTestCase):
+    """Vlib RCU Test Cases"""
+
+    vpp_worker_count = 2
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestVlibRcu, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestVlibRcu, cls).tearDownClass()
+
+    def test_vlib_rcu_workers(self):
+        """Vlib RCU grace period with workers"""
+        for _ in range(10):
+            reply = self.vapi.cli("test rcu")
+            self.logger.info(reply)
+            self.assertIn("rcu: 2 workers, PASS", reply)
+
+        reply = self.vapi.cli("show rcu")
+        self.assertIn("pending 0", reply)
+
+
 class TestVlibFrameLeak(VppTestCase):
     """Vlib Frame Leak Test Cases"""
 